@@ -39,6 +39,10 @@
   level directory), drawing the "Ruhrgebiet":
 
   src/PerformanceTest ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13
+
+  If a number of prepare threads is given, every tile is additionally drawn
+  with areas and ways prepared by the given number of threads, to compare
+  against drawing with serial preparation.
 */
 
 // See http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames for details about
@@ -77,8 +81,9 @@ int main(int argc, char* argv[])
   unsigned long tileWidth;
   unsigned long tileHeight;
   std::string   driver;
+  unsigned long prepareThreads=1;
 
-  if (argc!=12) {
+  if (argc!=12 && argc!=13) {
     std::cerr << "DrawMap ";
     std::cerr << "<map directory> <style-file> ";
     std::cerr << "<lat_top> <lon_left> <lat_bottom> <lon_right> ";
@@ -87,6 +92,7 @@ int main(int argc, char* argv[])
     std::cerr << "<tile width>" << std::endl;
     std::cerr << "<tile height>" << std::endl;
     std::cerr << "<driver>" << std::endl;
+    std::cerr << "[<prepare threads>]" << std::endl;
     return 1;
   }
 
@@ -135,6 +141,13 @@ int main(int argc, char* argv[])
 
   driver=argv[11];
 
+  if (argc==13) {
+    if (sscanf(argv[12],"%lu",&prepareThreads)!=1) {
+      std::cerr << "prepare threads is not numeric!" << std::endl;
+      return 1;
+    }
+  }
+
 #if defined(HAVE_LIB_OSMSCOUTMAPCAIRO)
   cairo_surface_t *surface=NULL;
   cairo_t         *cairo=NULL;
@@ -186,8 +199,11 @@ int main(int argc, char* argv[])
 
   osmscout::MercatorProjection  projection;
   osmscout::MapParameter        drawParameter;
+  osmscout::MapParameter        parallelDrawParameter;
   osmscout::AreaSearchParameter searchParameter;
 
+  parallelDrawParameter.SetPrepareThreads(prepareThreads);
+
   for (size_t zoom=std::min(startZoom,endZoom);
        zoom<=std::max(startZoom,endZoom);
        zoom++) {
@@ -219,6 +235,10 @@ int main(int argc, char* argv[])
     double drawMaxTime=0.0;
     double drawTotalTime=0.0;
 
+    double parallelDrawMinTime=std::numeric_limits<double>::max();
+    double parallelDrawMaxTime=0.0;
+    double parallelDrawTotalTime=0.0;
+
     for (size_t y=yTileStart; y<=yTileEnd; y++) {
       for (size_t x=xTileStart; x<=xTileEnd; x++) {
         double                         lat,lon;
@@ -291,6 +311,27 @@ int main(int argc, char* argv[])
         drawMinTime=std::min(drawMinTime,drawTime);
         drawMaxTime=std::max(drawMaxTime,drawTime);
         drawTotalTime+=drawTime;
+
+        if (prepareThreads>1) {
+          osmscout::StopClock parallelDrawTimer;
+
+#if defined(HAVE_LIB_OSMSCOUTMAPCAIRO)
+          if (driver=="cairo") {
+            cairoPainter.DrawMap(projection,
+                                 parallelDrawParameter,
+                                 data,
+                                 cairo);
+          }
+#endif
+
+          parallelDrawTimer.Stop();
+
+          double parallelDrawTime=parallelDrawTimer.GetMilliseconds();
+
+          parallelDrawMinTime=std::min(parallelDrawMinTime,parallelDrawTime);
+          parallelDrawMaxTime=std::max(parallelDrawMaxTime,parallelDrawTime);
+          parallelDrawTotalTime+=parallelDrawTime;
+        }
       }
     }
 
@@ -305,6 +346,14 @@ int main(int argc, char* argv[])
     std::cout << "min: " << drawMinTime << " msec ";
     std::cout << "avg: " << drawTotalTime/(xTileCount*yTileCount) << " msec ";
     std::cout << "max: " << drawMaxTime << " msec" << std::endl;
+
+    if (prepareThreads>1) {
+      std::cout << "DrawMap (" << prepareThreads << " prepare threads): ";
+      std::cout << "total: " << parallelDrawTotalTime << " msec ";
+      std::cout << "min: " << parallelDrawMinTime << " msec ";
+      std::cout << "avg: " << parallelDrawTotalTime/(xTileCount*yTileCount) << " msec ";
+      std::cout << "max: " << parallelDrawMaxTime << " msec" << std::endl;
+    }
   }
 
   database->Close();
@@ -395,6 +395,49 @@ static void DumpNameChangedDescription(size_t& lineCount,
   std::cout << "'" << std::endl;
 }
 
+/**
+ * Search the routable node closest to the given location. Uses the index of
+ * routable segments if available, else the closest node of all routable
+ * objects in the area.
+ */
+static bool GetRoutableNode(const osmscout::RoutingService& router,
+                            double lat,
+                            double lon,
+                            osmscout::Vehicle vehicle,
+                            const std::string& name,
+                            osmscout::ObjectFileRef& object,
+                            size_t& nodeIndex)
+{
+  std::vector<osmscout::RouteSegmentIndex::Match> matches;
+
+  if (!router.GetClosestRoutableSegments(osmscout::GeoCoord(lat,lon),
+                                         1,
+                                         1000,
+                                         matches)) {
+    return router.GetClosestRoutableNode(lat,
+                                         lon,
+                                         vehicle,
+                                         1000,
+                                         object,
+                                         nodeIndex);
+  }
+
+  if (matches.empty()) {
+    object.Invalidate();
+    return true;
+  }
+
+  object=matches.front().object;
+  nodeIndex=matches.front().nodeIndex;
+
+  std::cout << "Snapped " << name << " location to ";
+  std::cout << std::fixed << std::setprecision(6) << matches.front().projection.GetLat() << "," << matches.front().projection.GetLon();
+  std::cout << " (" << std::setprecision(1) << matches.front().distance << "m), ";
+  std::cout << object.GetName() << "[" << nodeIndex << "]" << std::endl;
+
+  return true;
+}
+
 int main(int argc, char* argv[])
 {
   osmscout::Vehicle                         vehicle=osmscout::vehicleCar;
@@ -521,12 +564,13 @@ int main(int argc, char* argv[])
     break;
   }
 
-  if (!router->GetClosestRoutableNode(startLat,
-                                      startLon,
-                                      vehicle,
-                                      1000,
-                                      startObject,
-                                      startNodeIndex)) {
+  if (!GetRoutableNode(*router,
+                       startLat,
+                       startLon,
+                       vehicle,
+                       "start",
+                       startObject,
+                       startNodeIndex)) {
     std::cerr << "Error while searching for routing node near start location!" << std::endl;
     return 1;
   }
@@ -535,12 +579,13 @@ int main(int argc, char* argv[])
     std::cerr << "Cannot find start node for start location!" << std::endl;
   }
 
-  if (!router->GetClosestRoutableNode(targetLat,
-                                      targetLon,
-                                      vehicle,
-                                      1000,
-                                      targetObject,
-                                      targetNodeIndex)) {
+  if (!GetRoutableNode(*router,
+                       targetLat,
+                       targetLon,
+                       vehicle,
+                       "target",
+                       targetObject,
+                       targetNodeIndex)) {
     std::cerr << "Error while searching for routing node near target location!" << std::endl;
     return 1;
   }
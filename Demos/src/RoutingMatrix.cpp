@@ -0,0 +1,371 @@
+/*
+  RoutingMatrix - a demo program for libosmscout
+  Copyright (C) 2014  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <list>
+
+#include <osmscout/Database.h>
+#include <osmscout/RoutingService.h>
+
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/StopClock.h>
+
+/*
+  Calculates the matrix of distances and travel times between all given
+  locations using RoutingService::CalculateRouteMatrix().
+
+  With --compare each route is calculated individually using
+  RoutingService::CalculateRoute(), too. The time needed by both variants
+  and the maximum difference of the results are reported.
+*/
+
+static void GetCarSpeedTable(std::map<std::string,double>& map)
+{
+  map["highway_motorway"]=110.0;
+  map["highway_motorway_trunk"]=100.0;
+  map["highway_motorway_primary"]=70.0;
+  map["highway_motorway_link"]=60.0;
+  map["highway_motorway_junction"]=60.0;
+  map["highway_trunk"]=100.0;
+  map["highway_trunk_link"]=60.0;
+  map["highway_primary"]=70.0;
+  map["highway_primary_link"]=60.0;
+  map["highway_secondary"]=60.0;
+  map["highway_secondary_link"]=50.0;
+  map["highway_tertiary_link"]=55.0;
+  map["highway_tertiary"]=55.0;
+  map["highway_unclassified"]=50.0;
+  map["highway_road"]=50.0;
+  map["highway_residential"]=40.0;
+  map["highway_roundabout"]=40.0;
+  map["highway_living_street"]=10.0;
+  map["highway_service"]=30.0;
+}
+
+/**
+ * Sum up length (km) and travel time (hours) of the given route
+ */
+static bool GetRouteDistanceAndTime(const osmscout::DatabaseRef& database,
+                                    const osmscout::RoutingProfile& routingProfile,
+                                    const osmscout::RouteData& data,
+                                    double& distance,
+                                    double& time)
+{
+  osmscout::WayRef way;
+
+  distance=0.0;
+  time=0.0;
+
+  for (std::list<osmscout::RouteData::RouteEntry>::const_iterator entry=data.Entries().begin();
+       entry!=data.Entries().end();
+       ++entry) {
+    if (!entry->GetPathObject().Valid() ||
+        entry->GetPathObject().GetType()!=osmscout::refWay) {
+      continue;
+    }
+
+    if (way.Invalid() ||
+        way->GetFileOffset()!=entry->GetPathObject().GetFileOffset()) {
+      if (!database->GetWayByOffset(entry->GetPathObject().GetFileOffset(),
+                                    way)) {
+        return false;
+      }
+    }
+
+    size_t from=std::min(entry->GetCurrentNodeIndex(),entry->GetTargetNodeIndex());
+    size_t to=std::max(entry->GetCurrentNodeIndex(),entry->GetTargetNodeIndex());
+    double wayDistance=0.0;
+
+    for (size_t i=from; i<to; i++) {
+      wayDistance+=osmscout::GetSphericalDistance(way->nodes[i].GetLon(),
+                                                  way->nodes[i].GetLat(),
+                                                  way->nodes[i+1].GetLon(),
+                                                  way->nodes[i+1].GetLat());
+    }
+
+    distance+=wayDistance;
+    time+=routingProfile.GetTime(*way,
+                                 wayDistance);
+  }
+
+  return true;
+}
+
+/**
+ * Calculate each route of the matrix individually and return the maximum
+ * difference in distance (km) and time (hours) compared to the matrix
+ */
+static bool CompareWithRoutes(osmscout::RoutingService& router,
+                              const osmscout::DatabaseRef& database,
+                              const osmscout::RoutingProfile& routingProfile,
+                              const std::vector<osmscout::RouteMatrix::Position>& positions,
+                              const osmscout::RouteMatrix& matrix,
+                              double& maxDistanceDiff,
+                              double& maxTimeDiff,
+                              size_t& mismatchCount)
+{
+  maxDistanceDiff=0.0;
+  maxTimeDiff=0.0;
+  mismatchCount=0;
+
+  for (size_t s=0; s<positions.size(); s++) {
+    for (size_t t=0; t<positions.size(); t++) {
+      const osmscout::RouteMatrix::Entry& entry=matrix.Get(s,t);
+      osmscout::RouteData                 data;
+      double                              distance;
+      double                              time;
+
+      if (!positions[s].object.Valid() ||
+          !positions[t].object.Valid() ||
+          s==t) {
+        continue;
+      }
+
+      if (!router.CalculateRoute(routingProfile,
+                                 positions[s].object,
+                                 positions[s].nodeIndex,
+                                 positions[t].object,
+                                 positions[t].nodeIndex,
+                                 data)) {
+        return false;
+      }
+
+      if (data.IsEmpty()) {
+        if (entry.found) {
+          mismatchCount++;
+        }
+
+        continue;
+      }
+
+      if (!entry.found) {
+        mismatchCount++;
+        continue;
+      }
+
+      if (!GetRouteDistanceAndTime(database,
+                                   routingProfile,
+                                   data,
+                                   distance,
+                                   time)) {
+        return false;
+      }
+
+      maxDistanceDiff=std::max(maxDistanceDiff,fabs(distance-entry.distance));
+      maxTimeDiff=std::max(maxTimeDiff,fabs(time-entry.time));
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  osmscout::Vehicle     vehicle=osmscout::vehicleCar;
+  size_t                threadCount=1;
+  bool                  compare=false;
+  std::string           map;
+  std::vector<osmscout::GeoCoord> coords;
+
+  int currentArg=1;
+  while (currentArg<argc) {
+    if (strcmp(argv[currentArg],"--foot")==0) {
+      vehicle=osmscout::vehicleFoot;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--bicycle")==0) {
+      vehicle=osmscout::vehicleBicycle;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--car")==0) {
+      vehicle=osmscout::vehicleCar;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--threads")==0 &&
+             currentArg+1<argc) {
+      threadCount=atoi(argv[currentArg+1]);
+      currentArg+=2;
+    }
+    else if (strcmp(argv[currentArg],"--compare")==0) {
+      compare=true;
+      currentArg++;
+    }
+    else {
+      // No more "special" arguments
+      break;
+    }
+  }
+
+  if (argc-currentArg<5 ||
+      (argc-currentArg-1)%2!=0) {
+    std::cout << "RoutingMatrix [--foot|--bicycle|--car] [--threads <count>] [--compare]" << std::endl;
+    std::cout << "              <map directory>" << std::endl;
+    std::cout << "              <lat> <lon> <lat> <lon> [<lat> <lon>...]" << std::endl;
+    return 1;
+  }
+
+  map=argv[currentArg];
+  currentArg++;
+
+  while (currentArg<argc) {
+    double lat;
+    double lon;
+
+    if (sscanf(argv[currentArg],"%lf",&lat)!=1 ||
+        sscanf(argv[currentArg+1],"%lf",&lon)!=1) {
+      std::cerr << "lat or lon is not numeric!" << std::endl;
+      return 1;
+    }
+
+    coords.push_back(osmscout::GeoCoord(lat,lon));
+    currentArg+=2;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(map.c_str())) {
+    std::cerr << "Cannot open database" << std::endl;
+
+    return 1;
+  }
+
+  osmscout::RouterParameter routerParameter;
+
+  routerParameter.SetMatrixThreadCount(threadCount);
+
+  osmscout::RoutingServiceRef router(new osmscout::RoutingService(database,
+                                                                  routerParameter,
+                                                                  vehicle));
+
+  if (!router->Open()) {
+    std::cerr << "Cannot open routing database" << std::endl;
+
+    return 1;
+  }
+
+  osmscout::TypeConfigRef             typeConfig=database->GetTypeConfig();
+  osmscout::FastestPathRoutingProfile routingProfile(typeConfig);
+  std::map<std::string,double>        carSpeedTable;
+
+  switch (vehicle) {
+  case osmscout::vehicleFoot:
+    routingProfile.ParametrizeForFoot(*typeConfig,
+                                      5.0);
+    break;
+  case osmscout::vehicleBicycle:
+    routingProfile.ParametrizeForBicycle(*typeConfig,
+                                         20.0);
+    break;
+  case osmscout::vehicleCar:
+    GetCarSpeedTable(carSpeedTable);
+    routingProfile.ParametrizeForCar(*typeConfig,
+                                     carSpeedTable,
+                                     160.0);
+    break;
+  }
+
+  std::vector<osmscout::RouteMatrix::Position> positions(coords.size());
+
+  for (size_t i=0; i<coords.size(); i++) {
+    if (!router->GetClosestRoutableNode(coords[i].GetLat(),
+                                        coords[i].GetLon(),
+                                        vehicle,
+                                        1000,
+                                        positions[i].object,
+                                        positions[i].nodeIndex)) {
+      std::cerr << "Error while searching for routing node near location " << i << "!" << std::endl;
+      return 1;
+    }
+
+    if (positions[i].object.Invalid()) {
+      std::cerr << "Cannot find routing node near location " << i << "!" << std::endl;
+    }
+  }
+
+  osmscout::RouteMatrix matrix;
+  osmscout::StopClock   matrixClock;
+
+  if (!router->CalculateRouteMatrix(routingProfile,
+                                    positions,
+                                    positions,
+                                    matrix)) {
+    std::cerr << "There was an error while calculating the route matrix!" << std::endl;
+    router->Close();
+    return 1;
+  }
+
+  matrixClock.Stop();
+
+  std::cout << "Distance [km] / time [min]:" << std::endl;
+
+  for (size_t s=0; s<matrix.GetSourceCount(); s++) {
+    for (size_t t=0; t<matrix.GetTargetCount(); t++) {
+      const osmscout::RouteMatrix::Entry& entry=matrix.Get(s,t);
+
+      if (entry.found) {
+        std::cout << std::setw(7) << std::fixed << std::setprecision(2) << entry.distance;
+        std::cout << "/" << std::setw(5) << std::setprecision(1) << entry.time*60.0 << " ";
+      }
+      else {
+        std::cout << std::setw(14) << "-" << " ";
+      }
+    }
+
+    std::cout << std::endl;
+  }
+
+  std::cout << "Matrix of " << matrix.GetSourceCount() << "x" << matrix.GetTargetCount();
+  std::cout << " calculated in " << matrixClock << std::endl;
+
+  if (compare) {
+    osmscout::StopClock routesClock;
+    double              maxDistanceDiff;
+    double              maxTimeDiff;
+    size_t              mismatchCount;
+
+    if (!CompareWithRoutes(*router,
+                           database,
+                           routingProfile,
+                           positions,
+                           matrix,
+                           maxDistanceDiff,
+                           maxTimeDiff,
+                           mismatchCount)) {
+      std::cerr << "There was an error while calculating the routes!" << std::endl;
+      router->Close();
+      return 1;
+    }
+
+    routesClock.Stop();
+
+    std::cout << "Individual routes calculated in " << routesClock << std::endl;
+    std::cout << "Maximum difference: " << std::setprecision(3) << maxDistanceDiff << "km, ";
+    std::cout << maxTimeDiff*3600.0 << "s, " << mismatchCount << " routes found by only one variant" << std::endl;
+  }
+
+  router->Close();
+
+  return 0;
+}
@@ -0,0 +1,395 @@
+/*
+  RoutingPerformance - a demo program for libosmscout
+  Copyright (C) 2014  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+
+#include <osmscout/Database.h>
+#include <osmscout/RoutingService.h>
+
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
+
+/*
+  Calculates the same route a number of times using the indexed heap and
+  the std::set based open list of the routing service and reports the
+  time per route and the number of route nodes settled per second for both.
+  Both variants must deliver the same route.
+
+  The route is also calculated on the routing graph held in memory, the
+  memory used by the graph is reported.
+
+  For cars the route is also calculated using the contraction hierarchy,
+  if it has been generated during import (see option --routeCH).
+*/
+
+enum Search
+{
+  searchIndexedHeap,
+  searchSet,
+  searchInMemoryGraph,
+  searchContractionHierarchy
+};
+
+static void GetCarSpeedTable(std::map<std::string,double>& map)
+{
+  map["highway_motorway"]=110.0;
+  map["highway_motorway_trunk"]=100.0;
+  map["highway_motorway_primary"]=70.0;
+  map["highway_motorway_link"]=60.0;
+  map["highway_motorway_junction"]=60.0;
+  map["highway_trunk"]=100.0;
+  map["highway_trunk_link"]=60.0;
+  map["highway_primary"]=70.0;
+  map["highway_primary_link"]=60.0;
+  map["highway_secondary"]=60.0;
+  map["highway_secondary_link"]=50.0;
+  map["highway_tertiary_link"]=55.0;
+  map["highway_tertiary"]=55.0;
+  map["highway_unclassified"]=50.0;
+  map["highway_road"]=50.0;
+  map["highway_residential"]=40.0;
+  map["highway_roundabout"]=40.0;
+  map["highway_living_street"]=10.0;
+  map["highway_service"]=30.0;
+}
+
+static bool CalculateRoutes(const osmscout::DatabaseRef& database,
+                            const osmscout::RoutingProfile& routingProfile,
+                            osmscout::Vehicle vehicle,
+                            Search search,
+                            double startLat,
+                            double startLon,
+                            double targetLat,
+                            double targetLon,
+                            size_t rounds,
+                            std::list<osmscout::Id>& nodeIds,
+                            bool& searched)
+{
+  osmscout::RouterParameter routerParameter;
+
+  routerParameter.SetUseIndexedHeap(search!=searchSet);
+  routerParameter.SetUseContractionHierarchy(search==searchContractionHierarchy);
+  routerParameter.SetUseInMemoryGraph(search==searchInMemoryGraph);
+
+  osmscout::RoutingServiceRef router(new osmscout::RoutingService(database,
+                                                                  routerParameter,
+                                                                  vehicle));
+
+  if (!router->Open()) {
+    std::cerr << "Cannot open routing database" << std::endl;
+    return false;
+  }
+
+  osmscout::ObjectFileRef startObject;
+  size_t                  startNodeIndex;
+  osmscout::ObjectFileRef targetObject;
+  size_t                  targetNodeIndex;
+
+  if (!router->GetClosestRoutableNode(startLat,
+                                      startLon,
+                                      vehicle,
+                                      1000,
+                                      startObject,
+                                      startNodeIndex) ||
+      startObject.Invalid()) {
+    std::cerr << "Cannot find start node for start location!" << std::endl;
+    router->Close();
+    return false;
+  }
+
+  if (!router->GetClosestRoutableNode(targetLat,
+                                      targetLon,
+                                      vehicle,
+                                      1000,
+                                      targetObject,
+                                      targetNodeIndex) ||
+      targetObject.Invalid()) {
+    std::cerr << "Cannot find target node for target location!" << std::endl;
+    router->Close();
+    return false;
+  }
+
+  osmscout::RouteData data;
+  double              searchTime=0.0;
+  size_t              nodesSettled=0;
+  size_t              maxOpenList=0;
+
+  searched=true;
+
+  osmscout::StopClock clock;
+
+  for (size_t round=0; round<rounds; round++) {
+    if (!router->CalculateRoute(routingProfile,
+                                startObject,
+                                startNodeIndex,
+                                targetObject,
+                                targetNodeIndex,
+                                data)) {
+      std::cerr << "There was an error while calculating the route!" << std::endl;
+      router->Close();
+      return false;
+    }
+
+    if (search==searchContractionHierarchy &&
+        !router->GetStatistics().contractionHierarchy) {
+      router->Close();
+      searched=false;
+      return true;
+    }
+
+    searchTime+=router->GetStatistics().searchTime;
+    nodesSettled+=router->GetStatistics().nodesLoaded;
+    maxOpenList=std::max(maxOpenList,router->GetStatistics().maxOpenList);
+  }
+
+  clock.Stop();
+
+  nodeIds.clear();
+
+  for (std::list<osmscout::RouteData::RouteEntry>::const_iterator entry=data.Entries().begin();
+       entry!=data.Entries().end();
+       ++entry) {
+    nodeIds.push_back(entry->GetCurrentNodeId());
+  }
+
+  switch (search) {
+  case searchIndexedHeap:
+    std::cout << "Indexed heap: ";
+    break;
+  case searchSet:
+    std::cout << "std::set:     ";
+    break;
+  case searchInMemoryGraph:
+    std::cout << "In memory:    ";
+    break;
+  case searchContractionHierarchy:
+    std::cout << "CH:           ";
+    break;
+  }
+
+  std::cout << clock.GetMilliseconds()/rounds << " ms/route, ";
+  std::cout << searchTime/rounds << " ms/search, ";
+  std::cout << nodesSettled/rounds << " nodes settled, ";
+
+  if (searchTime>0.0) {
+    std::cout << (size_t)(nodesSettled/(searchTime/1000.0)) << " nodes/s, ";
+  }
+
+  std::cout << "max. open list " << maxOpenList << ", ";
+  std::cout << nodeIds.size() << " route entries" << std::endl;
+
+  if (router->GetRoutingGraph().Valid()) {
+    osmscout::RoutingGraphRef graph=router->GetRoutingGraph();
+
+    std::cout << "              graph " << graph->GetNodeCount() << " nodes, ";
+    std::cout << graph->GetEdgeCount() << " edges, ";
+    std::cout << osmscout::ByteSizeToString(graph->GetMemoryUsage()) << std::endl;
+  }
+
+  router->Close();
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  osmscout::Vehicle vehicle=osmscout::vehicleCar;
+  std::string       map;
+  double            startLat;
+  double            startLon;
+  double            targetLat;
+  double            targetLon;
+  size_t            rounds=10;
+
+  int currentArg=1;
+  while (currentArg<argc) {
+    if (strcmp(argv[currentArg],"--foot")==0) {
+      vehicle=osmscout::vehicleFoot;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--bicycle")==0) {
+      vehicle=osmscout::vehicleBicycle;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--car")==0) {
+      vehicle=osmscout::vehicleCar;
+      currentArg++;
+    }
+    else {
+      // No more "special" arguments
+      break;
+    }
+  }
+
+  if (argc-currentArg!=5 && argc-currentArg!=6) {
+    std::cout << "RoutingPerformance [--foot|--bicycle|--car] <map directory>" <<std::endl;
+    std::cout << "                   <start lat> <start lon>" << std::endl;
+    std::cout << "                   <target lat> <target lon>" << std::endl;
+    std::cout << "                   [rounds]" << std::endl;
+    return 1;
+  }
+
+  map=argv[currentArg];
+  currentArg++;
+
+  if (sscanf(argv[currentArg],"%lf",&startLat)!=1) {
+    std::cerr << "lat is not numeric!" << std::endl;
+    return 1;
+  }
+  currentArg++;
+
+  if (sscanf(argv[currentArg],"%lf",&startLon)!=1) {
+    std::cerr << "lon is not numeric!" << std::endl;
+    return 1;
+  }
+  currentArg++;
+
+  if (sscanf(argv[currentArg],"%lf",&targetLat)!=1) {
+    std::cerr << "lat is not numeric!" << std::endl;
+    return 1;
+  }
+  currentArg++;
+
+  if (sscanf(argv[currentArg],"%lf",&targetLon)!=1) {
+    std::cerr << "lon is not numeric!" << std::endl;
+    return 1;
+  }
+  currentArg++;
+
+  if (currentArg<argc) {
+    rounds=atoi(argv[currentArg]);
+
+    if (rounds==0) {
+      std::cerr << "rounds must be a positive number!" << std::endl;
+      return 1;
+    }
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(map.c_str())) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef             typeConfig=database->GetTypeConfig();
+  osmscout::FastestPathRoutingProfile routingProfile(typeConfig);
+  std::map<std::string,double>        carSpeedTable;
+
+  switch (vehicle) {
+  case osmscout::vehicleFoot:
+    routingProfile.ParametrizeForFoot(*typeConfig,
+                                      5.0);
+    break;
+  case osmscout::vehicleBicycle:
+    routingProfile.ParametrizeForBicycle(*typeConfig,
+                                         20.0);
+    break;
+  case osmscout::vehicleCar:
+    GetCarSpeedTable(carSpeedTable);
+    routingProfile.ParametrizeForCar(*typeConfig,
+                                     carSpeedTable,
+                                     160.0);
+    break;
+  }
+
+  std::list<osmscout::Id> heapRoute;
+  std::list<osmscout::Id> setRoute;
+  std::list<osmscout::Id> graphRoute;
+  std::list<osmscout::Id> chRoute;
+  bool                    searched;
+  bool                    chSearched=false;
+
+  if (!CalculateRoutes(database,
+                       routingProfile,
+                       vehicle,
+                       searchIndexedHeap,
+                       startLat,
+                       startLon,
+                       targetLat,
+                       targetLon,
+                       rounds,
+                       heapRoute,
+                       searched) ||
+      !CalculateRoutes(database,
+                       routingProfile,
+                       vehicle,
+                       searchSet,
+                       startLat,
+                       startLon,
+                       targetLat,
+                       targetLon,
+                       rounds,
+                       setRoute,
+                       searched) ||
+      !CalculateRoutes(database,
+                       routingProfile,
+                       vehicle,
+                       searchInMemoryGraph,
+                       startLat,
+                       startLon,
+                       targetLat,
+                       targetLon,
+                       rounds,
+                       graphRoute,
+                       searched)) {
+    database->Close();
+    return 1;
+  }
+
+  if (vehicle==osmscout::vehicleCar &&
+      !CalculateRoutes(database,
+                       routingProfile,
+                       vehicle,
+                       searchContractionHierarchy,
+                       startLat,
+                       startLon,
+                       targetLat,
+                       targetLon,
+                       rounds,
+                       chRoute,
+                       chSearched)) {
+    database->Close();
+    return 1;
+  }
+
+  database->Close();
+
+  if (heapRoute!=setRoute ||
+      heapRoute!=graphRoute) {
+    std::cerr << "Routes differ!" << std::endl;
+    return 1;
+  }
+
+  if (chSearched &&
+      chRoute!=heapRoute) {
+    std::cerr << "Contraction hierarchy route differs!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
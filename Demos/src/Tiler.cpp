@@ -17,6 +17,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <limits>
@@ -25,14 +26,18 @@
 #include <osmscout/MapService.h>
 
 #include <osmscout/MapPainterAgg.h>
-
-#include <osmscout/util/StopClock.h>
+#include <osmscout/TileRenderer.h>
 
 /*
   Example for the nordrhein-westfalen.osm (to be executed in the Demos top
   level directory), drawing the "Ruhrgebiet":
 
   src/Tiler ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13
+
+  Optionally the size of the metatiles (in tiles) and the number of threads
+  can be passed:
+
+  src/Tiler ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13 4 2
 */
 
 static unsigned long tileWidth=256;
@@ -51,18 +56,6 @@ size_t lat2tiley(double lat, double z)
   return (size_t)(floor((1.0 - log( tan(lat * M_PI/180.0) + 1.0 / cos(lat * M_PI/180.0)) / M_PI) / 2.0 * pow(2.0,z)));
 }
 
-double tilex2long(int x, double z)
-{
-  return x / pow(2.0,z) * 360.0 - 180;
-}
-
-double tiley2lat(int y, double z)
-{
-  double n = M_PI - 2.0 * M_PI * y / pow(2.0,z);
-
-  return 180.0 / M_PI * atan(0.5 * (exp(n) - exp(-n)));
-}
-
 bool write_ppm(const agg::rendering_buffer& buffer,
                const char* file_name)
 {
@@ -85,6 +78,141 @@ bool write_ppm(const agg::rendering_buffer& buffer,
   return false;
 }
 
+/**
+ * Draws metatiles using the agg backend, writes each tile to a ppm file
+ * and copies it into the bitmap of the full map.
+ */
+class AggMetaTilePainter : public osmscout::MetaTilePainter
+{
+private:
+  osmscout::MapPainterAgg painter;
+  size_t                  width;
+  size_t                  height;
+  unsigned char*          buffer;
+  unsigned char*          mapBuffer;
+  size_t                  mapXTileStart;
+  size_t                  mapYTileStart;
+  size_t                  mapStride;
+
+public:
+  AggMetaTilePainter(const osmscout::StyleConfigRef& styleConfig,
+                     size_t width,
+                     size_t height,
+                     unsigned char* mapBuffer,
+                     size_t mapXTileStart,
+                     size_t mapYTileStart,
+                     size_t mapStride)
+  : painter(styleConfig),
+    width(width),
+    height(height),
+    buffer(new unsigned char[width*height*3]),
+    mapBuffer(mapBuffer),
+    mapXTileStart(mapXTileStart),
+    mapYTileStart(mapYTileStart),
+    mapStride(mapStride)
+  {
+    // no code
+  }
+
+  ~AggMetaTilePainter()
+  {
+    delete [] buffer;
+  }
+
+  bool DrawMetaTile(const osmscout::MetaTile& /*metaTile*/,
+                    const osmscout::Projection& projection,
+                    const osmscout::MapParameter& parameter,
+                    const osmscout::MapData& data)
+  {
+    memset(buffer,0,width*height*3);
+
+    agg::rendering_buffer rbuf(buffer,
+                               projection.GetWidth(),
+                               projection.GetHeight(),
+                               width*3);
+    agg::pixfmt_rgb24     pf(rbuf);
+
+    return painter.DrawMap(projection,
+                           parameter,
+                           data,
+                           &pf);
+  }
+
+  bool StoreTile(size_t zoom,
+                 size_t x,
+                 size_t y,
+                 size_t pixelX,
+                 size_t pixelY,
+                 size_t tileSize)
+  {
+    agg::rendering_buffer rbuf(buffer+pixelY*width*3+pixelX*3,
+                               tileSize,
+                               tileSize,
+                               width*3);
+
+    std::string output=osmscout::NumberToString(zoom)+"_"+osmscout::NumberToString(x)+"_"+osmscout::NumberToString(y)+".ppm";
+
+    if (!write_ppm(rbuf,output.c_str())) {
+      return false;
+    }
+
+    // Tiles never overlap, so threads can write into the map without locking
+    for (size_t row=0; row<tileSize; row++) {
+      memcpy(mapBuffer+((y-mapYTileStart)*tileSize+row)*mapStride+(x-mapXTileStart)*tileSize*3,
+             rbuf.row_ptr(row),
+             tileSize*3);
+    }
+
+    return true;
+  }
+};
+
+class AggMetaTilePainterFactory : public osmscout::MetaTilePainterFactory
+{
+private:
+  osmscout::StyleConfigRef styleConfig;
+  unsigned char*           mapBuffer;
+  size_t                   mapXTileStart;
+  size_t                   mapYTileStart;
+  size_t                   mapStride;
+
+public:
+  AggMetaTilePainterFactory(const osmscout::StyleConfigRef& styleConfig,
+                            unsigned char* mapBuffer,
+                            size_t mapXTileStart,
+                            size_t mapYTileStart,
+                            size_t mapStride)
+  : styleConfig(styleConfig),
+    mapBuffer(mapBuffer),
+    mapXTileStart(mapXTileStart),
+    mapYTileStart(mapYTileStart),
+    mapStride(mapStride)
+  {
+    // no code
+  }
+
+  osmscout::MetaTilePainterRef CreatePainter(size_t width,
+                                             size_t height)
+  {
+    return new AggMetaTilePainter(styleConfig,
+                                  width,
+                                  height,
+                                  mapBuffer,
+                                  mapXTileStart,
+                                  mapYTileStart,
+                                  mapStride);
+  }
+};
+
+void DumpStageStatistics(const std::string& stage,
+                         const osmscout::TileRenderer::StageStatistics& statistics)
+{
+  std::cout << "   " << stage << ": ";
+  std::cout << "min: " << statistics.minTime << " msec ";
+  std::cout << "avg: " << statistics.GetAverageTime() << " msec ";
+  std::cout << "max: " << statistics.maxTime << " msec" << std::endl;
+}
+
 int main(int argc, char* argv[])
 {
   std::string   map;
@@ -93,13 +221,15 @@ int main(int argc, char* argv[])
   unsigned long xTileStart,xTileEnd,xTileCount,yTileStart,yTileEnd,yTileCount;
   unsigned long startZoom;
   unsigned long endZoom;
+  unsigned long metaTileSize=4;
+  unsigned long threadCount=1;
 
-  if (argc!=9) {
-    std::cerr << "DrawMap ";
+  if (argc!=9 && argc!=10 && argc!=11) {
+    std::cerr << "Tiler ";
     std::cerr << "<map directory> <style-file> ";
     std::cerr << "<lat_top> <lon_left> <lat_bottom> <lon_right> ";
-    std::cerr << "<start_zoom>" << std::endl;
-    std::cerr << "<end_zoom>" << std::endl;
+    std::cerr << "<start_zoom> <end_zoom> ";
+    std::cerr << "[<metatile size> [<threads>]]" << std::endl;
     return 1;
   }
 
@@ -136,6 +266,22 @@ int main(int argc, char* argv[])
     return 1;
   }
 
+  if (argc>=10) {
+    if (sscanf(argv[9],"%lu",&metaTileSize)!=1 ||
+        metaTileSize==0) {
+      std::cerr << "metatile size is not numeric!" << std::endl;
+      return 1;
+    }
+  }
+
+  if (argc>=11) {
+    if (sscanf(argv[10],"%lu",&threadCount)!=1 ||
+        threadCount==0) {
+      std::cerr << "thread count is not numeric!" << std::endl;
+      return 1;
+    }
+  }
+
   osmscout::DatabaseParameter databaseParameter;
   osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
   osmscout::MapServiceRef     mapService(new osmscout::MapService(database));
@@ -152,10 +298,8 @@ int main(int argc, char* argv[])
     std::cerr << "Cannot open style" << std::endl;
   }
 
-  osmscout::MercatorProjection  projection;
   osmscout::MapParameter        drawParameter;
   osmscout::AreaSearchParameter searchParameter;
-  osmscout::MapData             data;
 
   // Change this, to match your system
   drawParameter.SetFontName("/usr/share/fonts/truetype/msttcorefonts/Verdana.ttf");
@@ -173,8 +317,12 @@ int main(int argc, char* argv[])
   searchParameter.SetMaximumWays(std::numeric_limits<unsigned long>::max());
   searchParameter.SetMaximumAreas(std::numeric_limits<unsigned long>::max());
 
-  osmscout::MapPainterAgg painter(styleConfig);
-  osmscout::Magnification magnification;
+  osmscout::TileRenderer renderer(mapService,
+                                  styleConfig);
+
+  renderer.SetTileSize(tileWidth);
+  renderer.SetMetaTileSize(metaTileSize);
+  renderer.SetThreadCount(threadCount);
 
   for (size_t zoom=std::min(startZoom,endZoom);
        zoom<=std::max(startZoom,endZoom);
@@ -192,125 +340,45 @@ int main(int argc, char* argv[])
     unsigned long bitmapSize=tileWidth*tileHeight*3*xTileCount*yTileCount;
     unsigned char *buffer=new unsigned char[bitmapSize];
 
-    magnification.SetLevel(zoom);
-
     memset(buffer,0,bitmapSize);
 
+    AggMetaTilePainterFactory          factory(styleConfig,
+                                               buffer,
+                                               xTileStart,
+                                               yTileStart,
+                                               tileWidth*xTileCount*3);
+    osmscout::TileRenderer::Statistics statistics;
+
+    if (!renderer.Render(factory,
+                         drawParameter,
+                         searchParameter,
+                         zoom,
+                         xTileStart,
+                         yTileStart,
+                         xTileEnd,
+                         yTileEnd,
+                         statistics)) {
+      std::cerr << "Error while rendering zoom level " << zoom << std::endl;
+    }
+
     agg::rendering_buffer rbuf(buffer,
                                tileWidth*xTileCount,
                                tileHeight*yTileCount,
                                tileWidth*xTileCount*3);
 
-    double minTime=std::numeric_limits<double>::max();
-    double maxTime=0.0;
-    double totalTime=0.0;
-
-    osmscout::TypeSet              nodeTypes;
-    std::vector<osmscout::TypeSet> wayTypes;
-    osmscout::TypeSet              areaTypes;
-
-    styleConfig->GetNodeTypesWithMaxMag(magnification,
-                                        nodeTypes);
-
-    styleConfig->GetWayTypesByPrioWithMaxMag(magnification,
-                                             wayTypes);
-
-    styleConfig->GetAreaTypesWithMaxMag(magnification,
-                                        areaTypes);
-
-    for (size_t y=yTileStart; y<=yTileEnd; y++) {
-      for (size_t x=xTileStart; x<=xTileEnd; x++) {
-        double              minLat2,minLat,lat,maxLat,maxLat2;
-        double              minLon2,minLon,lon,maxLon,maxLon2;
-        agg::pixfmt_rgb24   pf(rbuf);
-        osmscout::StopClock timer;
-
-        minLat2=tiley2lat(y+2,zoom);
-        minLat=tiley2lat(y+1,zoom);
-        maxLat=tiley2lat(y,zoom);
-        maxLat2=tiley2lat(y-1,zoom);
-
-        minLon2=tilex2long(x-1,zoom);
-        minLon=tilex2long(x,zoom);
-        maxLon=tilex2long(x+1,zoom);
-        maxLon2=tilex2long(x+2,zoom);
-
-        lat=(minLat+maxLat)/2;
-        lon=(minLon+maxLon)/2;
-
-        std::cout << "Drawing tile [" << minLat << "," << lat << "," << maxLat << "]x[" << minLon << "," << lon << "," << maxLon << "]" << std::endl;
-        //std::cout << x << "," << y << "/";
-        //std::cout << x-xTileStart << "," << y-yTileStart << std::endl;
-
-        projection.Set(lon,lat,
-                       magnification,
-                       tileWidth,
-                       tileHeight);
-
-
-        mapService->GetObjects(searchParameter,
-                               projection.GetMagnification(),
-                               nodeTypes,
-                               minLon2,
-                               minLat2,
-                               maxLon2,
-                               maxLat2,
-                               data.nodes,
-                               wayTypes,
-                               minLon,
-                               minLat,
-                               maxLon,
-                               maxLat,
-                               data.ways,
-                               areaTypes,
-                               minLon2,
-                               minLat2,
-                               maxLon2,
-                               maxLat2,
-                               data.areas);
-
-        size_t bufferOffset=xTileCount*tileWidth*3*(y-yTileStart)*tileHeight+
-                            (x-xTileStart)*tileWidth*3;
-
-        rbuf.attach(buffer+bufferOffset,
-                    tileWidth,tileHeight,
-                    tileWidth*xTileCount*3);
-
-        painter.DrawMap(projection,
-                        drawParameter,
-                        data,
-                        &pf);
-
-        timer.Stop();
-
-        double time=timer.GetMilliseconds();
-
-        minTime=std::min(minTime,time);
-        maxTime=std::max(maxTime,time);
-        totalTime+=time;
-
-        std::string output=osmscout::NumberToString(zoom)+"_"+osmscout::NumberToString(x)+"_"+osmscout::NumberToString(y)+".ppm";
-
-        write_ppm(rbuf,output.c_str());
-      }
-    }
-
-    rbuf.attach(buffer,
-                tileWidth*xTileCount,
-                tileHeight*yTileCount,
-                tileWidth*xTileCount*3);
-
     std::string output=osmscout::NumberToString(zoom)+"_full_map.ppm";
 
     write_ppm(rbuf,output.c_str());
 
     delete[] buffer;
 
-    std::cout << "=> Time: ";
-    std::cout << "total: " << totalTime << " msec ";
-    std::cout << "min: " << minTime << " msec ";
-    std::cout << "avg: " << totalTime/(xTileCount*yTileCount) << " msec ";
-    std::cout << "max: " << maxTime << " msec" << std::endl;
+    std::cout << "=> " << statistics.tileCount << " tiles in " << statistics.metaTileCount << " metatiles, ";
+    std::cout << "total: " << statistics.time << " msec, ";
+    std::cout << statistics.GetTilesPerSecond() << " tiles/s" << std::endl;
+
+    DumpStageStatistics("Data",statistics.dataStage);
+    DumpStageStatistics("Draw",statistics.drawStage);
+    DumpStageStatistics("Store",statistics.storeStage);
   }
 
   database->Close();
@@ -62,12 +62,15 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " -s <end step>                        set final step" << std::endl;
   std::cout << " --typefile <path>                    path and name of the map.ost file (default: " << parameter.GetTypefile() << ")" << std::endl;
   std::cout << " --destinationDirectory <path>        destination for generated map files (default: " << parameter.GetDestinationDirectory() << ")" << std::endl;
+  std::cout << " --numberOfThreads <number>           number of threads used inside of a step (default: " << parameter.GetNumberOfThreads() << ")" << std::endl;
+  std::cout << " --parallelSteps <number>             number of independent steps executed in parallel (default: " << parameter.GetParallelSteps() << ")" << std::endl;
 
   std::cout << " --strictAreas true|false             assure that areas are simple (default: " << BoolToString(parameter.GetStrictAreas()) << ")" << std::endl;
 
   std::cout << " --numericIndexPageSize <number>      size of an numeric index page in bytes (default: " << parameter.GetNumericIndexPageSize() << ")" << std::endl;
 
   std::cout << " --coordDataMemoryMaped true|false    memory maped coord data file access (default: " << BoolToString(parameter.GetCoordDataMemoryMaped()) << ")" << std::endl;
+  std::cout << " --coordDataDense true|false          store coords as dense array indexed by node id (default: " << BoolToString(parameter.GetCoordDataDense()) << ")" << std::endl;
 
   std::cout << " --rawNodeDataMemoryMaped true|false  memory maped raw node data file access (default: " << BoolToString(parameter.GetRawNodeDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --rawNodeDataCacheSize <number>      raw node data cache size (default: " << parameter.GetRawNodeDataCacheSize() << ")" << std::endl;
@@ -80,6 +83,7 @@ void DumpHelp(osmscout::ImportParameter& parameter)
 
   std::cout << " --noSort                             do not sort objects" << std::endl;
   std::cout << " --sortBlockSize <number>             size of one data block during sorting (default: " << parameter.GetSortBlockSize() << ")" << std::endl;
+  std::cout << " --sortExternal true|false            sort using an external merge sort (default: " << BoolToString(parameter.GetSortExternal()) << ")" << std::endl;
 
   std::cout << " --areaDataMemoryMaped true|false     memory maped area data file access (default: " << BoolToString(parameter.GetAreaDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --areaDataCacheSize <number>         area data cache size (default: " << parameter.GetAreaDataCacheSize() << ")" << std::endl;
@@ -88,6 +92,7 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --wayDataCacheSize <number>          way data cache size (default: " << parameter.GetWayDataCacheSize() << ")" << std::endl;
 
   std::cout << " --routeNodeBlockSize <number>        number of route nodes resolved in block (default: " << BoolToString(parameter.GetRouteNodeBlockSize()) << ")" << std::endl;
+  std::cout << " --routeCH true|false                 generate contraction hierarchy for car routing (default: " << BoolToString(parameter.GetRouteCH()) << ")" << std::endl;
 }
 
 bool ParseBoolArgument(int argc,
@@ -206,6 +211,9 @@ bool CountDataSize(osmscout::Progress& progress,
   files.push_back("routebicycle.idx");
   files.push_back("routecar.dat");
   files.push_back("routecar.idx");
+  files.push_back("routefootseg.idx");
+  files.push_back("routebicycleseg.idx");
+  files.push_back("routecarseg.idx");
 
   dataSize=0;
 
@@ -240,14 +248,18 @@ int main(int argc, char* argv[])
 
   size_t                    startStep=parameter.GetStartStep();
   size_t                    endStep=parameter.GetEndStep();
+  size_t                    numberOfThreads=parameter.GetNumberOfThreads();
+  size_t                    parallelSteps=parameter.GetParallelSteps();
 
   bool                      strictAreas=parameter.GetStrictAreas();
 
   size_t                    numericIndexPageSize=parameter.GetNumericIndexPageSize();
 
   size_t                    sortBlockSize=parameter.GetSortBlockSize();
+  bool                      sortExternal=parameter.GetSortExternal();
 
   bool                      coordDataMemoryMaped=parameter.GetCoordDataMemoryMaped();
+  bool                      coordDataDense=parameter.GetCoordDataDense();
 
   bool                      rawNodeDataMemoryMaped=parameter.GetRawNodeDataMemoryMaped();
   size_t                    rawNodeDataCacheSize=parameter.GetRawNodeDataCacheSize();
@@ -265,6 +277,7 @@ int main(int argc, char* argv[])
   size_t                    wayDataCacheSize=parameter.GetWayDataCacheSize();
 
   size_t                    routeNodeBlockSize=parameter.GetRouteNodeBlockSize();
+  bool                      routeCH=parameter.GetRouteCH();
 
   // Simple way to analyse command line parameters, but enough for now...
   int i=1;
@@ -281,6 +294,18 @@ int main(int argc, char* argv[])
                                          i,
                                          endStep);
     }
+    else if (strcmp(argv[i],"--numberOfThreads")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         numberOfThreads);
+    }
+    else if (strcmp(argv[i],"--parallelSteps")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         parallelSteps);
+    }
     else if (strcmp(argv[i],"-d")==0) {
       progress.SetOutputDebug(true);
 
@@ -326,6 +351,12 @@ int main(int argc, char* argv[])
                                         i,
                                         coordDataMemoryMaped);
     }
+    else if (strcmp(argv[i],"--coordDataDense")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        coordDataDense);
+    }
     else if (strcmp(argv[i],"--rawNodeDataMemoryMaped")==0) {
       parameterError=!ParseBoolArgument(argc,
                                         argv,
@@ -379,6 +410,12 @@ int main(int argc, char* argv[])
                                          i,
                                          sortBlockSize);
     }
+    else if (strcmp(argv[i],"--sortExternal")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        sortExternal);
+    }
     else if (strcmp(argv[i],"--areaDataMemoryMaped")==0) {
       parameterError=!ParseBoolArgument(argc,
                                         argv,
@@ -409,6 +446,12 @@ int main(int argc, char* argv[])
                                          i,
                                          routeNodeBlockSize);
     }
+    else if (strcmp(argv[i],"--routeCH")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        routeCH);
+    }
     else if (mapfile.empty()) {
       mapfile=argv[i];
 
@@ -436,14 +479,18 @@ int main(int argc, char* argv[])
   parameter.SetTypefile(typefile);
   parameter.SetDestinationDirectory(destinationDirectory);
   parameter.SetSteps(startStep,endStep);
+  parameter.SetNumberOfThreads(numberOfThreads);
+  parameter.SetParallelSteps(parallelSteps);
 
   parameter.SetStrictAreas(strictAreas);
 
   parameter.SetNumericIndexPageSize(numericIndexPageSize);
 
   parameter.SetSortBlockSize(sortBlockSize);
+  parameter.SetSortExternal(sortExternal);
 
   parameter.SetCoordDataMemoryMaped(coordDataMemoryMaped);
+  parameter.SetCoordDataDense(coordDataDense);
 
   parameter.SetRawNodeDataMemoryMaped(rawNodeDataMemoryMaped);
   parameter.SetRawNodeDataCacheSize(rawNodeDataCacheSize);
@@ -461,6 +508,7 @@ int main(int argc, char* argv[])
   parameter.SetWayDataCacheSize(wayDataCacheSize);
 
   parameter.SetRouteNodeBlockSize(routeNodeBlockSize);
+  parameter.SetRouteCH(routeCH);
 
   parameter.SetOptimizationWayMethod(osmscout::TransPolygon::quality);
 
@@ -472,6 +520,10 @@ int main(int argc, char* argv[])
                 osmscout::NumberToString(parameter.GetStartStep())+
                 " - "+
                 osmscout::NumberToString(parameter.GetEndStep()));
+  progress.Info(std::string("NumberOfThreads: ")+
+                osmscout::NumberToString(parameter.GetNumberOfThreads()));
+  progress.Info(std::string("ParallelSteps: ")+
+                osmscout::NumberToString(parameter.GetParallelSteps()));
 
   progress.Info(std::string("StrictAreas: ")+
                 (parameter.GetStrictAreas() ? "true" : "false"));
@@ -481,6 +533,8 @@ int main(int argc, char* argv[])
 
   progress.Info(std::string("CoordDataMemoryMaped: ")+
                 (parameter.GetCoordDataMemoryMaped() ? "true" : "false"));
+  progress.Info(std::string("CoordDataDense: ")+
+                (parameter.GetCoordDataDense() ? "true" : "false"));
 
   progress.Info(std::string("RawNodeDataMemoryMaped: ")+
                 (parameter.GetRawNodeDataMemoryMaped() ? "true" : "false"));
@@ -503,6 +557,8 @@ int main(int argc, char* argv[])
                 (parameter.GetSortObjects() ? "true" : "false"));
   progress.Info(std::string("SortBlockSize: ")+
                 osmscout::NumberToString(parameter.GetSortBlockSize()));
+  progress.Info(std::string("SortExternal: ")+
+                (parameter.GetSortExternal() ? "true" : "false"));
 
   progress.Info(std::string("AreaDataMemoryMaped: ")+
                 (parameter.GetAreaDataMemoryMaped() ? "true" : "false"));
@@ -516,6 +572,8 @@ int main(int argc, char* argv[])
 
   progress.Info(std::string("RouteNodeBlockSize: ")+
                 osmscout::NumberToString(parameter.GetRouteNodeBlockSize()));
+  progress.Info(std::string("RouteCH: ")+
+                (parameter.GetRouteCH() ? "true" : "false"));
 
   bool result=osmscout::Import(parameter,
                                progress);
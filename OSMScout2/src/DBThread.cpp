@@ -71,7 +71,8 @@ DBThread::DBThread()
    currentRenderRequest(),
    doRender(false),
    renderBreaker(new QBreaker()),
-   renderBreakerRef(renderBreaker)
+   renderBreakerRef(renderBreaker),
+   mapQueryCache(new osmscout::MapQueryCache())
 {
     QScreen *srn = QApplication::screens().at(0);
 
@@ -255,6 +256,7 @@ void DBThread::TriggerMapRendering()
     osmscout::AreaSearchParameter searchParameter;
 
     searchParameter.SetBreaker(renderBreakerRef);
+    searchParameter.SetQueryCache(mapQueryCache);
     searchParameter.SetMaximumAreaLevel(4);
     searchParameter.SetUseMultithreading(currentMagnification.GetMagnification()<=osmscout::Magnification::magCity);
 
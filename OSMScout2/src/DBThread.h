@@ -118,6 +118,7 @@ private:
   bool                         doRender;
   QBreaker*                    renderBreaker;
   osmscout::BreakerRef         renderBreakerRef;
+  osmscout::MapQueryCacheRef   mapQueryCache;
 
 private:
   DBThread();
@@ -19,11 +19,20 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
+#include <osmscout/util/ShardedCache.h>
 #include <osmscout/util/StopClock.h>
 
 /**
@@ -31,6 +40,10 @@
   * cache insertion
   * cache hit
   * cache miss
+
+  Called with "compare" as argument, the list based Cache and the ShardedCache
+  are compared for a workload mixing lookups of a hot set with scans and for
+  concurrent lookups from multiple threads.
 */
 
 /**
@@ -67,8 +80,9 @@ typedef osmscout::LazyRef<Data2> Data2Ref;
 
 static const size_t cacheSize=2000000;
 
-typedef osmscout::Cache<osmscout::Id,Data>     DataCache;
-typedef osmscout::Cache<osmscout::Id,Data2Ref> Data2Cache;
+typedef osmscout::Cache<osmscout::Id,Data>            DataCache;
+typedef osmscout::Cache<osmscout::Id,Data2Ref>        Data2Cache;
+typedef osmscout::ShardedCache<osmscout::Id,Data2Ref> ShardedData2Cache;
 
 void TestData()
 {
@@ -278,10 +292,253 @@ void TestData2()
   std::cout << "Copy time: "  << copyTimer << std::endl;
 }
 
+void TestShardedData2()
+{
+  std::cout << "*** Caching of Reference<struct> in ShardedCache ***" << std::endl;
+
+  // Single shard, so that the cache holds exactly cacheSize entries
+  ShardedData2Cache cache(cacheSize,0,1);
+
+  std::cout << "Inserting values into cache..." << std::endl;
+
+  osmscout::StopClock insertTimer;
+
+  for (size_t i=cacheSize; i<2*cacheSize; i++) {
+    Data2Ref data;
+    data->value=i;
+    data->value2.resize(10,i);
+
+    cache.SetEntry(i,data,sizeof(Data2));
+  }
+
+  insertTimer.Stop();
+
+  assert(cache.GetSize()==cacheSize);
+
+  std::cout << "Updating values in cache..." << std::endl;
+
+  osmscout::StopClock updateTimer;
+
+  for (size_t i=cacheSize; i<2*cacheSize; i++) {
+    Data2Ref data;
+
+    data->value=i;
+    data->value2.resize(10,i);
+
+    cache.SetEntry(i,data,sizeof(Data2));
+  }
+
+  updateTimer.Stop();
+
+  assert(cache.GetSize()==cacheSize);
+
+  std::cout << "Searching for entries not in cache..." << std::endl;
+
+  osmscout::StopClock missTimer;
+
+  for (size_t i=0; i<cacheSize; i++) {
+    Data2Ref entry;
+
+    if (cache.GetEntry(i,entry)) {
+      assert(false);
+    }
+  }
+
+  for (size_t i=2*cacheSize; i<3*cacheSize; i++) {
+    Data2Ref entry;
+
+    if (cache.GetEntry(i,entry)) {
+      assert(false);
+    }
+  }
+
+  missTimer.Stop();
+
+  std::cout << "Searching for entries in cache..." << std::endl;
+
+  osmscout::StopClock hitTimer;
+
+  for (size_t t=1; t<=2; t++) {
+    for (size_t i=cacheSize; i<2*cacheSize; i++) {
+      Data2Ref entry;
+
+      if (!cache.GetEntry(i,entry)) {
+        assert(false);
+      }
+    }
+  }
+
+  hitTimer.Stop();
+
+  std::cout << "Insert time: "  << insertTimer << std::endl;
+  std::cout << "Update time: "  << updateTimer << std::endl;
+  std::cout << "Miss time: "  << missTimer << std::endl;
+  std::cout << "Hit time: "  << hitTimer << std::endl;
+
+  cache.DumpStatistics("ShardedCache");
+}
+
+/**
+  Mixed workload: Repeated lookups of a hot set that fits into the cache,
+  interrupted by scans over entries that are accessed only once. On a miss
+  the entry is inserted into the cache.
+  */
+void CompareCaches()
+{
+  std::cout << "*** Comparing Cache and ShardedCache ***" << std::endl;
+
+  const size_t compareCacheSize=100000;
+  const size_t hotSetSize=compareCacheSize*3/4;
+  const size_t scanSize=compareCacheSize;
+  const size_t rounds=10;
+
+  Data2Cache        listCache(compareCacheSize);
+  ShardedData2Cache shardedCache(compareCacheSize);
+  size_t            listHits=0;
+  size_t            shardedHits=0;
+  size_t            lookups=0;
+  Data2Ref          data;
+
+  osmscout::StopClock listTimer;
+
+  for (size_t r=0; r<rounds; r++) {
+    for (size_t t=0; t<2; t++) {
+      for (size_t i=0; i<hotSetSize; i++) {
+        Data2Cache::CacheRef entry;
+
+        if (listCache.GetEntry(i,entry)) {
+          listHits++;
+        }
+        else {
+          listCache.SetEntry(Data2Cache::CacheEntry(i,data));
+        }
+      }
+    }
+
+    for (size_t i=0; i<scanSize; i++) {
+      osmscout::Id         id=(r+1)*compareCacheSize*10+i;
+      Data2Cache::CacheRef entry;
+
+      if (listCache.GetEntry(id,entry)) {
+        listHits++;
+      }
+      else {
+        listCache.SetEntry(Data2Cache::CacheEntry(id,data));
+      }
+    }
+  }
+
+  listTimer.Stop();
+
+  osmscout::StopClock shardedTimer;
+
+  for (size_t r=0; r<rounds; r++) {
+    for (size_t t=0; t<2; t++) {
+      for (size_t i=0; i<hotSetSize; i++) {
+        Data2Ref entry;
+
+        if (shardedCache.GetEntry(i,entry)) {
+          shardedHits++;
+        }
+        else {
+          shardedCache.SetEntry(i,data,sizeof(Data2));
+        }
+
+        lookups++;
+      }
+    }
+
+    for (size_t i=0; i<scanSize; i++) {
+      osmscout::Id id=(r+1)*compareCacheSize*10+i;
+      Data2Ref     entry;
+
+      if (shardedCache.GetEntry(id,entry)) {
+        shardedHits++;
+      }
+      else {
+        shardedCache.SetEntry(id,data,sizeof(Data2));
+      }
+
+      lookups++;
+    }
+  }
+
+  shardedTimer.Stop();
+
+  std::cout << "Cache:        " << listTimer << ", hits " << listHits << "/" << lookups << " (" << listHits*100/lookups << "%)" << std::endl;
+  std::cout << "ShardedCache: " << shardedTimer << ", hits " << shardedHits << "/" << lookups << " (" << shardedHits*100/lookups << "%)" << std::endl;
+
+  shardedCache.DumpStatistics("ShardedCache");
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  const size_t threadCount=4;
+
+  std::cout << "Concurrent lookups from " << threadCount << " threads..." << std::endl;
+
+  osmscout::Mutex          listMutex;
+  std::vector<std::thread> threads;
+
+  osmscout::StopClock listThreadTimer;
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads.push_back(std::thread([&]() {
+      for (size_t r=0; r<rounds; r++) {
+        for (size_t i=0; i<hotSetSize; i++) {
+          osmscout::MutexLocker locker(listMutex);
+          Data2Cache::CacheRef  entry;
+
+          if (listCache.GetEntry(i,entry)) {
+            Data2Ref value=entry->value;
+          }
+        }
+      }
+    }));
+  }
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads[t].join();
+  }
+
+  listThreadTimer.Stop();
+
+  threads.clear();
+
+  osmscout::StopClock shardedThreadTimer;
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads.push_back(std::thread([&]() {
+      for (size_t r=0; r<rounds; r++) {
+        for (size_t i=0; i<hotSetSize; i++) {
+          Data2Ref value;
+
+          shardedCache.GetEntry(i,value);
+        }
+      }
+    }));
+  }
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads[t].join();
+  }
+
+  shardedThreadTimer.Stop();
+
+  std::cout << "Cache (locked): " << listThreadTimer << std::endl;
+  std::cout << "ShardedCache:   " << shardedThreadTimer << std::endl;
+#endif
+}
+
 int main(int argc, char* argv[])
 {
+  if (argc==2 && std::string(argv[1])=="compare") {
+    CompareCaches();
+
+    return 0;
+  }
+
   TestData();
   TestData2();
+  TestShardedData2();
 
   return 0;
 }
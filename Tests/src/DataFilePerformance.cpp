@@ -0,0 +1,277 @@
+/*
+  DataFilePerformance - a test program for libosmscout
+  Copyright (C) 2014  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <osmscout/Database.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/StopClock.h>
+
+/**
+  Measures loading the ways and areas of all tiles of a given zoom level
+  covering the database with a cold file system cache:
+  * Entry by entry in index order (one positioning and read per entry).
+  * Batched per tile (sorted, deduplicated, with prefetch advice).
+  Both variants are measured with and without memory mapped data files.
+
+  The file system cache of the data files is dropped before each run using
+  posix_fadvise(POSIX_FADV_DONTNEED), which does not require special rights
+  but only drops pages not in use otherwise.
+*/
+
+struct Tile
+{
+  double                            lonMin;
+  double                            latMin;
+  double                            lonMax;
+  double                            latMax;
+  std::vector<osmscout::FileOffset> wayOffsets;
+  std::vector<osmscout::FileOffset> areaOffsets;
+};
+
+static double TileXToLon(size_t x, size_t zoom)
+{
+  return x/pow(2.0,(double)zoom)*360.0-180.0;
+}
+
+static double TileYToLat(size_t y, size_t zoom)
+{
+  double n=M_PI-2.0*M_PI*y/pow(2.0,(double)zoom);
+
+  return 180.0/M_PI*atan(0.5*(exp(n)-exp(-n)));
+}
+
+static size_t LonToTileX(double lon, size_t zoom)
+{
+  return (size_t)(floor((lon+180.0)/360.0*pow(2.0,(double)zoom)));
+}
+
+static size_t LatToTileY(double lat, size_t zoom)
+{
+  return (size_t)(floor((1.0-log(tan(lat*M_PI/180.0)+1.0/cos(lat*M_PI/180.0))/M_PI)/2.0*pow(2.0,(double)zoom)));
+}
+
+static void DropFileCache(const std::string& filename)
+{
+#if defined(POSIX_FADV_DONTNEED)
+  int fd=open(filename.c_str(),O_RDONLY);
+
+  if (fd<0) {
+    return;
+  }
+
+  if (posix_fadvise(fd,0,0,POSIX_FADV_DONTNEED)!=0) {
+    std::cerr << "Cannot drop file cache of " << filename << std::endl;
+  }
+
+  close(fd);
+#endif
+}
+
+static bool LoadTiles(const osmscout::TypeConfigRef& typeConfig,
+                      const std::string& map,
+                      const std::vector<Tile>& tiles,
+                      bool memoryMaped,
+                      bool batch,
+                      size_t& objectCount)
+{
+  osmscout::WayDataFile  wayDataFile("ways.dat",0);
+  osmscout::AreaDataFile areaDataFile("areas.dat",0);
+
+  DropFileCache(osmscout::AppendFileToDir(map,"ways.dat"));
+  DropFileCache(osmscout::AppendFileToDir(map,"areas.dat"));
+
+  if (!wayDataFile.Open(typeConfig,map,osmscout::FileScanner::LowMemRandom,memoryMaped) ||
+      !areaDataFile.Open(typeConfig,map,osmscout::FileScanner::LowMemRandom,memoryMaped)) {
+    std::cerr << "Cannot open data files" << std::endl;
+    return false;
+  }
+
+  objectCount=0;
+
+  for (std::vector<Tile>::const_iterator tile=tiles.begin();
+       tile!=tiles.end();
+       ++tile) {
+    std::vector<osmscout::WayRef>  ways;
+    std::vector<osmscout::AreaRef> areas;
+
+    if (batch) {
+      if (!wayDataFile.GetByOffset(tile->wayOffsets,ways) ||
+          !areaDataFile.GetByOffset(tile->areaOffsets,areas)) {
+        return false;
+      }
+    }
+    else {
+      for (std::vector<osmscout::FileOffset>::const_iterator offset=tile->wayOffsets.begin();
+           offset!=tile->wayOffsets.end();
+           ++offset) {
+        osmscout::WayRef way;
+
+        if (!wayDataFile.GetByOffset(*offset,way)) {
+          return false;
+        }
+
+        ways.push_back(way);
+      }
+
+      for (std::vector<osmscout::FileOffset>::const_iterator offset=tile->areaOffsets.begin();
+           offset!=tile->areaOffsets.end();
+           ++offset) {
+        osmscout::AreaRef area;
+
+        if (!areaDataFile.GetByOffset(*offset,area)) {
+          return false;
+        }
+
+        areas.push_back(area);
+      }
+    }
+
+    objectCount+=ways.size()+areas.size();
+  }
+
+  wayDataFile.Close();
+  areaDataFile.Close();
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  std::string map;
+  size_t      zoom=14;
+
+  if (argc!=2 && argc!=3) {
+    std::cerr << "DataFilePerformance <map directory> [zoom]" << std::endl;
+    return 1;
+  }
+
+  map=argv[1];
+
+  if (argc==3) {
+    zoom=atoi(argv[2]);
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(map.c_str())) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  double minLat,minLon,maxLat,maxLon;
+
+  if (!database->GetBoundingBox(minLat,minLon,maxLat,maxLon)) {
+    std::cerr << "Cannot read bounding box" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef typeConfig=database->GetTypeConfig();
+  osmscout::TypeSet       wayTypes(*typeConfig);
+  osmscout::TypeSet       areaTypes(*typeConfig);
+
+  for (std::vector<osmscout::TypeInfoRef>::const_iterator type=typeConfig->GetTypes().begin();
+       type!=typeConfig->GetTypes().end();
+       ++type) {
+    if ((*type)->GetIgnore()) {
+      continue;
+    }
+
+    if ((*type)->CanBeWay()) {
+      wayTypes.SetType((*type)->GetId());
+    }
+
+    if ((*type)->CanBeArea()) {
+      areaTypes.SetType((*type)->GetId());
+    }
+  }
+
+  std::vector<osmscout::TypeSet> wayTypeSets;
+  std::vector<Tile>              tiles;
+  size_t                         offsetCount=0;
+
+  wayTypeSets.push_back(wayTypes);
+
+  for (size_t y=LatToTileY(maxLat,zoom); y<=LatToTileY(minLat,zoom); y++) {
+    for (size_t x=LonToTileX(minLon,zoom); x<=LonToTileX(maxLon,zoom); x++) {
+      Tile tile;
+
+      tile.lonMin=TileXToLon(x,zoom);
+      tile.lonMax=TileXToLon(x+1,zoom);
+      tile.latMin=TileYToLat(y+1,zoom);
+      tile.latMax=TileYToLat(y,zoom);
+
+      if (!database->GetAreaWayIndex()->GetOffsets(tile.lonMin,tile.latMin,tile.lonMax,tile.latMax,
+                                                   wayTypeSets,
+                                                   std::numeric_limits<size_t>::max(),
+                                                   tile.wayOffsets)) {
+        std::cerr << "Cannot read way offsets" << std::endl;
+        return 1;
+      }
+
+      if (!database->GetAreaAreaIndex()->GetOffsets(tile.lonMin,tile.latMin,tile.lonMax,tile.latMax,
+                                                    std::numeric_limits<size_t>::max(),
+                                                    areaTypes,
+                                                    std::numeric_limits<size_t>::max(),
+                                                    tile.areaOffsets)) {
+        std::cerr << "Cannot read area offsets" << std::endl;
+        return 1;
+      }
+
+      offsetCount+=tile.wayOffsets.size()+tile.areaOffsets.size();
+
+      tiles.push_back(tile);
+    }
+  }
+
+  database->Close();
+
+  std::cout << "Zoom " << zoom << ": " << tiles.size() << " tiles, " << offsetCount << " offsets" << std::endl;
+
+  for (size_t run=0; run<4; run++) {
+    bool   memoryMaped=run/2==1;
+    bool   batch=run%2==1;
+    size_t objectCount;
+
+    osmscout::StopClock timer;
+
+    if (!LoadTiles(typeConfig,map,tiles,memoryMaped,batch,objectCount)) {
+      std::cerr << "Cannot load tiles" << std::endl;
+      return 1;
+    }
+
+    timer.Stop();
+
+    std::cout << (memoryMaped ? "mmap  " : "file  ") << (batch ? "batch  " : "single ");
+    std::cout << timer << " (" << objectCount << " objects, ";
+    std::cout << timer.GetMilliseconds()/tiles.size() << " ms/tile)" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,359 @@
+/*
+  DatabaseConcurrency - a test program for libosmscout
+  Copyright (C) 2014  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <atomic>
+#include <thread>
+#endif
+
+#include <osmscout/Database.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Stress test for concurrent read access to one shared Database instance:
+  * A number of threads load the same ways and areas by offset in different
+    order using small caches, so that cache eviction and file access happen
+    concurrently.
+  * The loaded objects are compared against a single threaded reference run.
+*/
+
+static const size_t chunkSize=50;
+static const size_t rounds=20;
+
+/**
+ * Simple summary of an object, used to compare the objects loaded by the threads
+ * with the objects loaded during the reference run.
+ */
+struct Signature
+{
+  osmscout::FileOffset offset;
+  osmscout::TypeId     type;
+  size_t               nodeCount;
+  double               lat;
+  double               lon;
+
+  bool operator==(const Signature& other) const
+  {
+    return offset==other.offset &&
+           type==other.type &&
+           nodeCount==other.nodeCount &&
+           lat==other.lat &&
+           lon==other.lon;
+  }
+};
+
+static Signature GetSignature(const osmscout::WayRef& way)
+{
+  Signature signature;
+
+  signature.offset=way->GetFileOffset();
+  signature.type=way->GetType()->GetId();
+  signature.nodeCount=way->nodes.size();
+  signature.lat=way->nodes.empty() ? 0.0 : way->nodes.front().GetLat();
+  signature.lon=way->nodes.empty() ? 0.0 : way->nodes.front().GetLon();
+
+  return signature;
+}
+
+static Signature GetSignature(const osmscout::AreaRef& area)
+{
+  Signature signature;
+
+  signature.offset=area->GetFileOffset();
+  signature.type=area->GetType()->GetId();
+  signature.nodeCount=0;
+
+  for (std::vector<osmscout::Area::Ring>::const_iterator ring=area->rings.begin();
+       ring!=area->rings.end();
+       ++ring) {
+    signature.nodeCount+=ring->nodes.size();
+  }
+
+  signature.lat=area->rings.front().nodes.empty() ? 0.0 : area->rings.front().nodes.front().GetLat();
+  signature.lon=area->rings.front().nodes.empty() ? 0.0 : area->rings.front().nodes.front().GetLon();
+
+  return signature;
+}
+
+static bool LoadWays(const osmscout::Database& database,
+                     const std::vector<osmscout::FileOffset>& offsets,
+                     std::vector<Signature>& signatures)
+{
+  std::vector<osmscout::WayRef> ways;
+
+  if (!database.GetWaysByOffset(offsets,ways)) {
+    return false;
+  }
+
+  signatures.clear();
+  signatures.reserve(ways.size());
+
+  for (std::vector<osmscout::WayRef>::const_iterator way=ways.begin();
+       way!=ways.end();
+       ++way) {
+    signatures.push_back(GetSignature(*way));
+  }
+
+  return true;
+}
+
+static bool LoadAreas(const osmscout::Database& database,
+                      const std::vector<osmscout::FileOffset>& offsets,
+                      std::vector<Signature>& signatures)
+{
+  std::vector<osmscout::AreaRef> areas;
+
+  if (!database.GetAreasByOffset(offsets,areas)) {
+    return false;
+  }
+
+  signatures.clear();
+  signatures.reserve(areas.size());
+
+  for (std::vector<osmscout::AreaRef>::const_iterator area=areas.begin();
+       area!=areas.end();
+       ++area) {
+    signatures.push_back(GetSignature(*area));
+  }
+
+  return true;
+}
+
+/**
+ * Load all offsets in chunks, starting at a thread specific chunk, and compare the
+ * result against the reference. Returns the number of errors.
+ */
+static size_t CheckChunks(const osmscout::Database& database,
+                          const std::vector<osmscout::FileOffset>& wayOffsets,
+                          const std::vector<Signature>& waySignatures,
+                          const std::vector<osmscout::FileOffset>& areaOffsets,
+                          const std::vector<Signature>& areaSignatures,
+                          size_t start)
+{
+  size_t errors=0;
+
+  for (size_t round=0; round<rounds; round++) {
+    size_t chunks=std::max(wayOffsets.size(),areaOffsets.size())/chunkSize+1;
+
+    for (size_t c=0; c<chunks; c++) {
+      size_t chunk=(c+start+round)%chunks;
+      size_t begin=chunk*chunkSize;
+
+      if (begin<wayOffsets.size()) {
+        size_t                            end=std::min(begin+chunkSize,wayOffsets.size());
+        std::vector<osmscout::FileOffset> offsets(wayOffsets.begin()+begin,wayOffsets.begin()+end);
+        std::vector<Signature>            signatures;
+
+        if (!LoadWays(database,offsets,signatures)) {
+          errors++;
+        }
+        else {
+          for (size_t i=0; i<signatures.size(); i++) {
+            if (!(signatures[i]==waySignatures[begin+i])) {
+              errors++;
+            }
+          }
+        }
+      }
+
+      if (begin<areaOffsets.size()) {
+        size_t                            end=std::min(begin+chunkSize,areaOffsets.size());
+        std::vector<osmscout::FileOffset> offsets(areaOffsets.begin()+begin,areaOffsets.begin()+end);
+        std::vector<Signature>            signatures;
+
+        if (!LoadAreas(database,offsets,signatures)) {
+          errors++;
+        }
+        else {
+          for (size_t i=0; i<signatures.size(); i++) {
+            if (!(signatures[i]==areaSignatures[begin+i])) {
+              errors++;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return errors;
+}
+
+int main(int argc, char* argv[])
+{
+  std::string map;
+  size_t      threadCount=4;
+
+  if (argc!=2 && argc!=3) {
+    std::cerr << "DatabaseConcurrency <map directory> [threads]" << std::endl;
+    return 1;
+  }
+
+  map=argv[1];
+
+  if (argc==3) {
+    threadCount=atoi(argv[2]);
+
+    if (threadCount==0) {
+      std::cerr << "Thread count must be greater than 0" << std::endl;
+      return 1;
+    }
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+
+  // Small caches, to force eviction while other threads are reading
+  databaseParameter.SetAreaAreaIndexCacheSize(10);
+  databaseParameter.SetWayCacheSize(chunkSize);
+  databaseParameter.SetAreaCacheSize(chunkSize);
+
+  osmscout::DatabaseRef database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(map.c_str())) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  double minLat,minLon,maxLat,maxLon;
+
+  if (!database->GetBoundingBox(minLat,minLon,maxLat,maxLon)) {
+    std::cerr << "Cannot read bounding box" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef typeConfig=database->GetTypeConfig();
+  osmscout::TypeSet       wayTypes(*typeConfig);
+  osmscout::TypeSet       areaTypes(*typeConfig);
+
+  for (std::vector<osmscout::TypeInfoRef>::const_iterator type=typeConfig->GetTypes().begin();
+       type!=typeConfig->GetTypes().end();
+       ++type) {
+    if ((*type)->GetIgnore()) {
+      continue;
+    }
+
+    if ((*type)->CanBeWay()) {
+      wayTypes.SetType((*type)->GetId());
+    }
+
+    if ((*type)->CanBeArea()) {
+      areaTypes.SetType((*type)->GetId());
+    }
+  }
+
+  std::vector<osmscout::TypeSet>    wayTypeSets;
+  std::vector<osmscout::FileOffset> wayOffsets;
+  std::vector<osmscout::FileOffset> areaOffsets;
+
+  wayTypeSets.push_back(wayTypes);
+
+  if (!database->GetAreaWayIndex()->GetOffsets(minLon,minLat,maxLon,maxLat,
+                                               wayTypeSets,
+                                               std::numeric_limits<size_t>::max(),
+                                               wayOffsets)) {
+    std::cerr << "Cannot read way offsets" << std::endl;
+    return 1;
+  }
+
+  if (!database->GetAreaAreaIndex()->GetOffsets(minLon,minLat,maxLon,maxLat,
+                                                std::numeric_limits<size_t>::max(),
+                                                areaTypes,
+                                                std::numeric_limits<size_t>::max(),
+                                                areaOffsets)) {
+    std::cerr << "Cannot read area offsets" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Ways: " << wayOffsets.size() << ", areas: " << areaOffsets.size() << std::endl;
+
+  std::vector<Signature> waySignatures;
+  std::vector<Signature> areaSignatures;
+
+  if (!LoadWays(*database,wayOffsets,waySignatures) ||
+      !LoadAreas(*database,areaOffsets,areaSignatures)) {
+    std::cerr << "Cannot load reference data" << std::endl;
+    return 1;
+  }
+
+  database->FlushCache();
+
+  osmscout::StopClock singleTimer;
+
+  size_t errors=CheckChunks(*database,
+                            wayOffsets,waySignatures,
+                            areaOffsets,areaSignatures,
+                            0);
+
+  singleTimer.Stop();
+
+  std::cout << "1 thread: " << singleTimer << std::endl;
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  std::vector<std::thread> threads;
+  std::atomic<size_t>      threadErrors(0);
+
+  database->FlushCache();
+
+  osmscout::StopClock threadTimer;
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads.push_back(std::thread([&,t]() {
+      threadErrors+=CheckChunks(*database,
+                                wayOffsets,waySignatures,
+                                areaOffsets,areaSignatures,
+                                t*7);
+    }));
+  }
+
+  for (std::vector<std::thread>::iterator thread=threads.begin();
+       thread!=threads.end();
+       ++thread) {
+    thread->join();
+  }
+
+  threadTimer.Stop();
+
+  errors+=threadErrors;
+
+  std::cout << threadCount << " threads: " << threadTimer << " (" << threadCount << " times the work)" << std::endl;
+#else
+  std::cout << "No thread support, skipping concurrent run" << std::endl;
+#endif
+
+  database->DumpStatistics();
+
+  database->Close();
+
+  if (errors>0) {
+    std::cerr << "Errors: " << errors << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,288 @@
+/*
+  ObjectViewPerformance - a test program for libosmscout
+  Copyright (C) 2014  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/ObjectView.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Compares loading all ways and areas of a database as objects and as
+  read-only views:
+  * Loads everything as Ref<Way>/Ref<Area>, iterating all coordinates.
+  * Loads everything as WayView/AreaView, iterating all coordinates.
+  * Checks, that both variants deliver the same types and coordinates.
+*/
+
+static const size_t rounds=5;
+
+static double Sum(const std::vector<osmscout::GeoCoord>& nodes)
+{
+  double sum=0.0;
+
+  for (std::vector<osmscout::GeoCoord>::const_iterator node=nodes.begin();
+       node!=nodes.end();
+       ++node) {
+    sum+=node->GetLat()+node->GetLon();
+  }
+
+  return sum;
+}
+
+static double Sum(const osmscout::GeoCoordView& nodes)
+{
+  double sum=0.0;
+
+  for (osmscout::GeoCoordView::const_iterator node=nodes.begin();
+       node!=nodes.end();
+       ++node) {
+    sum+=node->GetLat()+node->GetLon();
+  }
+
+  return sum;
+}
+
+static bool Equals(const std::vector<osmscout::ObjectCoord>& nodes,
+                   const osmscout::GeoCoordView& view)
+{
+  if (nodes.size()!=view.size()) {
+    return false;
+  }
+
+  std::vector<osmscout::ObjectCoord>::const_iterator node=nodes.begin();
+
+  for (osmscout::GeoCoordView::const_iterator viewNode=view.begin();
+       viewNode!=view.end();
+       ++viewNode) {
+    if (node->GetLat()!=viewNode->GetLat() ||
+        node->GetLon()!=viewNode->GetLon()) {
+      return false;
+    }
+
+    ++node;
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "ObjectViewPerformance <map directory>" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+
+  // No caching, we want to measure reading from the data files
+  databaseParameter.SetWayCacheSize(0);
+  databaseParameter.SetAreaCacheSize(0);
+
+  osmscout::DatabaseRef database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(argv[1])) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  double minLat,minLon,maxLat,maxLon;
+
+  if (!database->GetBoundingBox(minLat,minLon,maxLat,maxLon)) {
+    std::cerr << "Cannot read bounding box" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef typeConfig=database->GetTypeConfig();
+  osmscout::TypeSet       wayTypes(*typeConfig);
+  osmscout::TypeSet       areaTypes(*typeConfig);
+
+  for (std::vector<osmscout::TypeInfoRef>::const_iterator type=typeConfig->GetTypes().begin();
+       type!=typeConfig->GetTypes().end();
+       ++type) {
+    if ((*type)->GetIgnore()) {
+      continue;
+    }
+
+    if ((*type)->CanBeWay()) {
+      wayTypes.SetType((*type)->GetId());
+    }
+
+    if ((*type)->CanBeArea()) {
+      areaTypes.SetType((*type)->GetId());
+    }
+  }
+
+  std::vector<osmscout::TypeSet>    wayTypeSets;
+  std::vector<osmscout::FileOffset> wayOffsets;
+  std::vector<osmscout::FileOffset> areaOffsets;
+
+  wayTypeSets.push_back(wayTypes);
+
+  if (!database->GetAreaWayIndex()->GetOffsets(minLon,minLat,maxLon,maxLat,
+                                               wayTypeSets,
+                                               std::numeric_limits<size_t>::max(),
+                                               wayOffsets)) {
+    std::cerr << "Cannot read way offsets" << std::endl;
+    return 1;
+  }
+
+  if (!database->GetAreaAreaIndex()->GetOffsets(minLon,minLat,maxLon,maxLat,
+                                                std::numeric_limits<size_t>::max(),
+                                                areaTypes,
+                                                std::numeric_limits<size_t>::max(),
+                                                areaOffsets)) {
+    std::cerr << "Cannot read area offsets" << std::endl;
+    return 1;
+  }
+
+  std::sort(wayOffsets.begin(),wayOffsets.end());
+  std::sort(areaOffsets.begin(),areaOffsets.end());
+
+  std::cout << "Ways: " << wayOffsets.size() << ", areas: " << areaOffsets.size() << std::endl;
+
+  std::vector<osmscout::WayRef>   ways;
+  std::vector<osmscout::AreaRef>  areas;
+  std::vector<osmscout::WayView>  wayViews;
+  std::vector<osmscout::AreaView> areaViews;
+  double                          refSum=0.0;
+  double                          viewSum=0.0;
+
+  osmscout::StopClock refTimer;
+
+  for (size_t round=0; round<rounds; round++) {
+    ways.clear();
+    areas.clear();
+
+    if (!database->GetWaysByOffset(wayOffsets,ways) ||
+        !database->GetAreasByOffset(areaOffsets,areas)) {
+      std::cerr << "Cannot load objects" << std::endl;
+      return 1;
+    }
+
+    for (std::vector<osmscout::WayRef>::const_iterator way=ways.begin();
+         way!=ways.end();
+         ++way) {
+      refSum+=Sum((*way)->nodes);
+    }
+
+    for (std::vector<osmscout::AreaRef>::const_iterator area=areas.begin();
+         area!=areas.end();
+         ++area) {
+      for (std::vector<osmscout::Area::Ring>::const_iterator ring=(*area)->rings.begin();
+           ring!=(*area)->rings.end();
+           ++ring) {
+        refSum+=Sum(ring->nodes);
+      }
+    }
+  }
+
+  refTimer.Stop();
+
+  osmscout::StopClock viewTimer;
+
+  for (size_t round=0; round<rounds; round++) {
+    wayViews.clear();
+    areaViews.clear();
+
+    if (!database->GetWayViewsByOffset(wayOffsets,wayViews) ||
+        !database->GetAreaViewsByOffset(areaOffsets,areaViews)) {
+      std::cerr << "Cannot load object views" << std::endl;
+      return 1;
+    }
+
+    for (std::vector<osmscout::WayView>::const_iterator way=wayViews.begin();
+         way!=wayViews.end();
+         ++way) {
+      viewSum+=Sum(way->GetNodes());
+    }
+
+    for (std::vector<osmscout::AreaView>::const_iterator area=areaViews.begin();
+         area!=areaViews.end();
+         ++area) {
+      for (std::vector<osmscout::AreaView::Ring>::const_iterator ring=area->GetRings().begin();
+           ring!=area->GetRings().end();
+           ++ring) {
+        viewSum+=Sum(ring->GetNodes());
+      }
+    }
+  }
+
+  viewTimer.Stop();
+
+  std::cout << "Objects: " << refTimer << " (" << refSum << ")" << std::endl;
+  std::cout << "Views:   " << viewTimer << " (" << viewSum << ")" << std::endl;
+
+  size_t errors=0;
+
+  if (ways.size()!=wayViews.size() ||
+      areas.size()!=areaViews.size()) {
+    std::cerr << "Number of objects and views differ" << std::endl;
+    errors++;
+  }
+  else {
+    for (size_t i=0; i<ways.size(); i++) {
+      if (ways[i]->GetFileOffset()!=wayViews[i].GetFileOffset() ||
+          ways[i]->GetType()->GetId()!=wayViews[i].GetType()->GetId() ||
+          !Equals(ways[i]->nodes,wayViews[i].GetNodes())) {
+        std::cerr << "Way " << ways[i]->GetFileOffset() << " differs" << std::endl;
+        errors++;
+      }
+    }
+
+    for (size_t i=0; i<areas.size(); i++) {
+      const std::vector<osmscout::Area::Ring>     &rings=areas[i]->rings;
+      const std::vector<osmscout::AreaView::Ring> &viewRings=areaViews[i].GetRings();
+
+      if (areas[i]->GetFileOffset()!=areaViews[i].GetFileOffset() ||
+          rings.size()!=viewRings.size()) {
+        std::cerr << "Area " << areas[i]->GetFileOffset() << " differs" << std::endl;
+        errors++;
+        continue;
+      }
+
+      for (size_t r=0; r<rings.size(); r++) {
+        if (rings[r].GetType()->GetId()!=viewRings[r].GetType()->GetId() ||
+            rings[r].ring!=viewRings[r].GetRing() ||
+            !Equals(rings[r].nodes,viewRings[r].GetNodes())) {
+          std::cerr << "Area " << areas[i]->GetFileOffset() << " ring " << r << " differs" << std::endl;
+          errors++;
+        }
+      }
+    }
+  }
+
+  wayViews.clear();
+  areaViews.clear();
+
+  database->Close();
+
+  if (errors>0) {
+    std::cerr << "Errors: " << errors << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,405 @@
+/*
+  TypeClassifierPerformance - a test program for libosmscout
+  Copyright (C) 2014  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Compare the performance of the compiled tag conditions used by
+  TypeConfig::GetNodeType(), TypeConfig::GetWayAreaType() and
+  TypeConfig::GetRelationType() with evaluating the conditions of all
+  types one after another, and check that both variants assign the same
+  types.
+
+  The tags of the objects are recorded from an OSM XML file (*.osm). The
+  file is scanned line by line, so it must have one element per line, as
+  written by the usual tools.
+*/
+
+#define DEFAULT_REPETITIONS 10
+
+enum ObjectKind {
+  objectNode,
+  objectWay,
+  objectRelation
+};
+
+struct Object
+{
+  ObjectKind                                           kind;
+  std::vector<std::pair<osmscout::TagId,std::string> > tags;
+};
+
+static std::string DecodeXML(const std::string& value)
+{
+  std::string result;
+
+  result.reserve(value.length());
+
+  for (size_t i=0; i<value.length(); i++) {
+    if (value[i]=='&') {
+      size_t end=value.find(';',i);
+
+      if (end!=std::string::npos) {
+        std::string entity=value.substr(i+1,end-i-1);
+
+        if (entity=="amp") {
+          result.append(1,'&');
+        }
+        else if (entity=="lt") {
+          result.append(1,'<');
+        }
+        else if (entity=="gt") {
+          result.append(1,'>');
+        }
+        else if (entity=="quot") {
+          result.append(1,'"');
+        }
+        else if (entity=="apos") {
+          result.append(1,'\'');
+        }
+        else {
+          result.append(value,i,end-i+1);
+        }
+
+        i=end;
+        continue;
+      }
+    }
+
+    result.append(1,value[i]);
+  }
+
+  return result;
+}
+
+static bool GetAttribute(const std::string& line,
+                         const std::string& name,
+                         std::string& value)
+{
+  std::string::size_type start=line.find(" "+name+"=");
+
+  if (start==std::string::npos) {
+    return false;
+  }
+
+  start+=name.length()+2;
+
+  if (start>=line.length()) {
+    return false;
+  }
+
+  char                   quote=line[start];
+  std::string::size_type end=line.find(quote,start+1);
+
+  if (end==std::string::npos) {
+    return false;
+  }
+
+  value=DecodeXML(line.substr(start+1,end-start-1));
+
+  return true;
+}
+
+static bool ReadObjects(const osmscout::TypeConfig& typeConfig,
+                        const std::string& filename,
+                        std::vector<Object>& objects)
+{
+  std::ifstream file(filename.c_str());
+  std::string   line;
+  Object*       current=NULL;
+
+  if (!file) {
+    return false;
+  }
+
+  while (std::getline(file,line)) {
+    std::string::size_type start=line.find_first_not_of(" \t");
+
+    if (start==std::string::npos) {
+      continue;
+    }
+
+    if (line.compare(start,5,"<node")==0) {
+      objects.push_back(Object());
+      objects.back().kind=objectNode;
+      current=&objects.back();
+    }
+    else if (line.compare(start,4,"<way")==0) {
+      objects.push_back(Object());
+      objects.back().kind=objectWay;
+      current=&objects.back();
+    }
+    else if (line.compare(start,9,"<relation")==0) {
+      objects.push_back(Object());
+      objects.back().kind=objectRelation;
+      current=&objects.back();
+    }
+    else if (line.compare(start,4,"<tag")==0 &&
+             current!=NULL) {
+      std::string key;
+      std::string value;
+
+      if (GetAttribute(line,"k",key) &&
+          GetAttribute(line,"v",value)) {
+        osmscout::TagId id=typeConfig.GetTagId(key.c_str());
+
+        if (id!=osmscout::tagIgnore) {
+          current->tags.push_back(std::make_pair(id,value));
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+static void GetTagMap(const Object& object,
+                      osmscout::TagMap& tagMap)
+{
+  tagMap.Clear();
+
+  for (size_t i=0; i<object.tags.size(); i++) {
+    tagMap.Reference(object.tags[i].first,
+                     object.tags[i].second);
+  }
+}
+
+/**
+ * Evaluates the conditions of all types one after another, returns the index of
+ * the matching type or 0 (typeInfoIgnore)
+ */
+static size_t GetTypeByScan(const osmscout::TypeConfig& typeConfig,
+                            const Object& object,
+                            const osmscout::TagMap& tagMap,
+                            size_t& areaIndex)
+{
+  const std::vector<osmscout::TypeInfoRef>& types=typeConfig.GetTypes();
+  size_t                                    wayIndex=0;
+  unsigned char                             typeMask;
+
+  areaIndex=0;
+
+  if (tagMap.empty()) {
+    return 0;
+  }
+
+  switch (object.kind) {
+  case objectNode:
+    typeMask=osmscout::TypeInfo::typeNode;
+    break;
+  case objectWay:
+    typeMask=osmscout::TypeInfo::typeWay | osmscout::TypeInfo::typeArea;
+    break;
+  default:
+    {
+      osmscout::TagMap::const_iterator type=tagMap.find(typeConfig.tagType);
+
+      if (type!=tagMap.end() &&
+          type->second=="multipolygon") {
+        typeMask=osmscout::TypeInfo::typeArea;
+      }
+      else {
+        typeMask=osmscout::TypeInfo::typeRelation;
+      }
+    }
+    break;
+  }
+
+  for (size_t i=0; i<types.size(); i++) {
+    const osmscout::TypeInfoRef& type=types[i];
+
+    if (!type->HasConditions()) {
+      continue;
+    }
+
+    if (object.kind==objectNode && !type->CanBeNode()) {
+      continue;
+    }
+
+    if (object.kind==objectWay && !(type->CanBeWay() || type->CanBeArea())) {
+      continue;
+    }
+
+    if (object.kind==objectRelation &&
+        typeMask==osmscout::TypeInfo::typeArea &&
+        !type->CanBeArea()) {
+      continue;
+    }
+
+    if (object.kind==objectRelation &&
+        typeMask==osmscout::TypeInfo::typeRelation &&
+        !type->CanBeRelation()) {
+      continue;
+    }
+
+    for (std::list<osmscout::TypeInfo::TypeCondition>::const_iterator cond=type->GetConditions().begin();
+         cond!=type->GetConditions().end();
+         ++cond) {
+      if ((cond->types & typeMask)==0) {
+        continue;
+      }
+
+      if (cond->condition->Evaluate(tagMap)) {
+        if (object.kind!=objectWay) {
+          return i;
+        }
+
+        if (cond->types & osmscout::TypeInfo::typeWay) {
+          wayIndex=i;
+        }
+
+        if (cond->types & osmscout::TypeInfo::typeArea) {
+          areaIndex=i;
+        }
+
+        return wayIndex;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static size_t GetTypeByTypeConfig(const osmscout::TypeConfig& typeConfig,
+                                  const Object& object,
+                                  const osmscout::TagMap& tagMap,
+                                  size_t& areaIndex)
+{
+  osmscout::TypeInfoRef wayType;
+  osmscout::TypeInfoRef areaType;
+
+  areaIndex=0;
+
+  switch (object.kind) {
+  case objectNode:
+    return typeConfig.GetNodeType(tagMap)->GetIndex();
+  case objectWay:
+    typeConfig.GetWayAreaType(tagMap,
+                              wayType,
+                              areaType);
+
+    areaIndex=areaType->GetIndex();
+
+    return wayType->GetIndex();
+  default:
+    return typeConfig.GetRelationType(tagMap)->GetIndex();
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc<3 || argc>4) {
+    std::cerr << "TypeClassifierPerformance <typefile> <osm file> [<repetitions>]" << std::endl;
+    return 1;
+  }
+
+  size_t repetitions=DEFAULT_REPETITIONS;
+
+  if (argc==4) {
+    repetitions=atoi(argv[3]);
+  }
+
+  osmscout::TypeConfig typeConfig;
+
+  if (!typeConfig.LoadFromOSTFile(argv[1])) {
+    std::cerr << "Cannot load type file '" << argv[1] << "'" << std::endl;
+    return 1;
+  }
+
+  std::vector<Object> objects;
+
+  if (!ReadObjects(typeConfig,
+                   argv[2],
+                   objects)) {
+    std::cerr << "Cannot read OSM file '" << argv[2] << "'" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Classifying " << objects.size() << " objects " << repetitions << " times" << std::endl;
+
+  std::vector<size_t> scanTypes(2*objects.size());
+  std::vector<size_t> compiledTypes(2*objects.size());
+  osmscout::TagMap    tagMap;
+
+  osmscout::StopClock scanTimer;
+
+  for (size_t r=0; r<repetitions; r++) {
+    for (size_t i=0; i<objects.size(); i++) {
+      GetTagMap(objects[i],
+                tagMap);
+
+      scanTypes[2*i]=GetTypeByScan(typeConfig,
+                                   objects[i],
+                                   tagMap,
+                                   scanTypes[2*i+1]);
+    }
+  }
+
+  scanTimer.Stop();
+
+  osmscout::StopClock compiledTimer;
+
+  for (size_t r=0; r<repetitions; r++) {
+    for (size_t i=0; i<objects.size(); i++) {
+      GetTagMap(objects[i],
+                tagMap);
+
+      compiledTypes[2*i]=GetTypeByTypeConfig(typeConfig,
+                                             objects[i],
+                                             tagMap,
+                                             compiledTypes[2*i+1]);
+    }
+  }
+
+  compiledTimer.Stop();
+
+  size_t differences=0;
+  size_t typed=0;
+
+  for (size_t i=0; i<objects.size(); i++) {
+    if (scanTypes[2*i]!=compiledTypes[2*i] ||
+        scanTypes[2*i+1]!=compiledTypes[2*i+1]) {
+      differences++;
+    }
+
+    if (compiledTypes[2*i]!=0 ||
+        compiledTypes[2*i+1]!=0) {
+      typed++;
+    }
+  }
+
+  double objectCount=(double)objects.size()*repetitions;
+
+  std::cout << "Evaluating conditions one by one took " << scanTimer;
+  std::cout << " (" << (size_t)(objectCount/scanTimer.GetMilliseconds()*1000.0) << " objects/s)" << std::endl;
+  std::cout << "Compiled conditions took " << compiledTimer;
+  std::cout << " (" << (size_t)(objectCount/compiledTimer.GetMilliseconds()*1000.0) << " objects/s, ";
+  std::cout << scanTimer.GetMilliseconds()/compiledTimer.GetMilliseconds() << "x)" << std::endl;
+  std::cout << typed << " objects got a type, " << differences << " objects got a different type" << std::endl;
+
+  return differences==0 ? 0 : 1;
+}
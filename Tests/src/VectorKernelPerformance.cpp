@@ -0,0 +1,192 @@
+/*
+  VectorKernelPerformance - a test program for libosmscout
+  Copyright (C) 2014  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+
+#include <osmscout/system/VectorKernels.h>
+
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/StopClock.h>
+
+/**
+  Compare the performance of the scalar, SSE2 and AVX2 variants of the
+  vector kernels (projection of coordinate arrays and decoding of
+  coordinates) and check that all variants calculate exactly the same
+  results as the scalar code.
+*/
+
+#define COORD_COUNT  1000000
+#define REPETITIONS  10
+
+static bool IsIdentical(const std::vector<double>& a,
+                        const std::vector<double>& b)
+{
+  return a.size()==b.size() &&
+         memcmp(&a[0],&b[0],a.size()*sizeof(double))==0;
+}
+
+static bool IsIdentical(const std::vector<osmscout::GeoCoord>& a,
+                        const std::vector<osmscout::GeoCoord>& b)
+{
+  if (a.size()!=b.size()) {
+    return false;
+  }
+
+  for (size_t i=0; i<a.size(); i++) {
+    if (memcmp(&a[i].lat,&b[i].lat,sizeof(double))!=0 ||
+        memcmp(&a[i].lon,&b[i].lon,sizeof(double))!=0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  osmscout::VectorExtension supported=osmscout::GetSupportedVectorExtension();
+
+  std::cout << "Supported vector extension: " << osmscout::GetVectorExtensionName(supported) << std::endl;
+
+  std::vector<osmscout::GeoCoord> coords(COORD_COUNT);
+
+  for (size_t i=0; i<coords.size(); i++) {
+    coords[i].Set(-80.0+160.0*rand()/(RAND_MAX+1.0),
+                  -180.0+360.0*rand()/(RAND_MAX+1.0));
+  }
+
+  osmscout::MercatorProjection projection;
+
+  projection.Set(7.4,51.5,
+                 osmscout::Magnification(osmscout::Magnification::magCity),
+                 1024,768);
+
+  bool success=true;
+
+  //
+  // Projection
+  //
+
+  std::vector<double> reference(2*coords.size());
+
+  osmscout::StopClock pointTimer;
+
+  for (size_t r=0; r<REPETITIONS; r++) {
+    for (size_t i=0; i<coords.size(); i++) {
+      projection.GeoToPixel(coords[i].GetLon(),
+                            coords[i].GetLat(),
+                            reference[2*i],
+                            reference[2*i+1]);
+    }
+  }
+
+  pointTimer.Stop();
+
+  std::cout << "Projecting " << COORD_COUNT << " coordinates point by point took " << pointTimer << std::endl;
+
+  for (int e=osmscout::vectorExtensionNone; e<=supported; e++) {
+    osmscout::VectorExtension extension=(osmscout::VectorExtension)e;
+    std::vector<double>       pixels(2*coords.size());
+
+    osmscout::SetVectorExtension(extension);
+
+    osmscout::StopClock timer;
+
+    for (size_t r=0; r<REPETITIONS; r++) {
+      projection.GeoToPixel(&coords[0],
+                            coords.size(),
+                            &pixels[0],
+                            2);
+    }
+
+    timer.Stop();
+
+    bool identical=IsIdentical(reference,pixels);
+
+    std::cout << "Projecting " << COORD_COUNT << " coordinates using " << osmscout::GetVectorExtensionName(extension) << " took " << timer;
+    std::cout << " (" << pointTimer.GetMilliseconds()/timer.GetMilliseconds() << "x)";
+    std::cout << (identical ? "" : " RESULTS DIFFER!") << std::endl;
+
+    success=success && identical;
+  }
+
+  //
+  // Decoding
+  //
+
+  osmscout::GeoCoord    minCoord(-80.0,-180.0);
+  std::vector<uint32_t> values(2*coords.size());
+
+  for (size_t i=0; i<values.size(); i++) {
+    // Some values with the highest bit set, to check unsigned conversion
+    values[i]=i%1000==0 ? 0xffffffff-rand() : (uint32_t)(134217727.0*rand()/(RAND_MAX+1.0));
+  }
+
+  std::vector<osmscout::GeoCoord> decodedReference(coords.size());
+
+  osmscout::StopClock decodeTimer;
+
+  for (size_t r=0; r<REPETITIONS; r++) {
+    for (size_t i=0; i<coords.size(); i++) {
+      decodedReference[i].Set(minCoord.GetLat()+values[2*i]/osmscout::latConversionFactor,
+                              minCoord.GetLon()+values[2*i+1]/osmscout::lonConversionFactor);
+    }
+  }
+
+  decodeTimer.Stop();
+
+  std::cout << "Decoding " << COORD_COUNT << " coordinates point by point took " << decodeTimer << std::endl;
+
+  for (int e=osmscout::vectorExtensionNone; e<=supported; e++) {
+    osmscout::VectorExtension       extension=(osmscout::VectorExtension)e;
+    std::vector<osmscout::GeoCoord> decoded(coords.size());
+
+    osmscout::SetVectorExtension(extension);
+
+    osmscout::StopClock timer;
+
+    for (size_t r=0; r<REPETITIONS; r++) {
+      osmscout::DecodeCoords(minCoord,
+                             osmscout::latConversionFactor,
+                             osmscout::lonConversionFactor,
+                             &values[0],
+                             coords.size(),
+                             &decoded[0]);
+    }
+
+    timer.Stop();
+
+    bool identical=IsIdentical(decodedReference,decoded);
+
+    std::cout << "Decoding " << COORD_COUNT << " coordinates using " << osmscout::GetVectorExtensionName(extension) << " took " << timer;
+    std::cout << " (" << decodeTimer.GetMilliseconds()/timer.GetMilliseconds() << "x)";
+    std::cout << (identical ? "" : " RESULTS DIFFER!") << std::endl;
+
+    success=success && identical;
+  }
+
+  osmscout::SetVectorExtension(supported);
+
+  return success ? 0 : 1;
+}
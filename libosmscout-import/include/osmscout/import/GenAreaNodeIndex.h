@@ -53,6 +53,9 @@ namespace osmscout {
 
   public:
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -226,7 +226,7 @@ namespace osmscout {
 
     bool AddLocationAreaToRegion(Region& region,
                                  const Area& area,
-                                 const std::vector<GeoCoord>& nodes,
+                                 const std::vector<ObjectCoord>& nodes,
                                  const std::string& name,
                                  double minlon,
                                  double minlat,
@@ -356,6 +356,9 @@ namespace osmscout {
 
   public:
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
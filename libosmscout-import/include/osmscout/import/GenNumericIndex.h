@@ -54,6 +54,9 @@ namespace osmscout {
     virtual ~NumericIndexGenerator();
 
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -91,6 +94,17 @@ namespace osmscout {
     return description;
   }
 
+  template <class N,class T>
+  bool NumericIndexGenerator<N,T>::GetFiles(const ImportParameter& /*parameter*/,
+                                            std::list<std::string>& inputFiles,
+                                            std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(datafile);
+    outputFiles.push_back(indexfile);
+
+    return true;
+  }
+
   template <class N,class T>
   bool NumericIndexGenerator<N,T>::Import(const TypeConfigRef& typeConfig,
                                           const ImportParameter& parameter,
@@ -22,8 +22,8 @@
 
 #include <osmscout/import/Import.h>
 
-#include <map>
-
+#include <list>
+#include <vector>
 
 #include <osmscout/Area.h>
 
@@ -39,6 +39,8 @@
 
 #include <osmscout/util/HashMap.h>
 #include <osmscout/util/HashSet.h>
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/Progress.h>
 
 namespace osmscout {
 
@@ -49,46 +51,32 @@ namespace osmscout {
 
     typedef OSMSCOUT_HASHMAP<OSMId,RawWayRef> IdRawWayMap;
 
+    typedef OSMSCOUT_HASHMAP<OSMId,RawRelationRef> IdRawRelationMap;
+
   private:
+    /**
+      Bookkeeping for grouping rings into outer and inner rings. For every ring the rings
+      including it and the rings included by it are stored, each sorted by ring index.
+      */
     class GroupingState
     {
     private:
-      size_t rings;
-      bool   *used;
-      bool   *includes;
-      bool   *hasIncludes;
+      std::vector<bool>                 used;
+      std::vector<std::vector<size_t> > includers;
+      std::vector<std::vector<size_t> > includeds;
 
     public:
       GroupingState(size_t rings)
+      : used(rings,false),
+        includers(rings),
+        includeds(rings)
       {
-        this->rings=rings;
-
-        used=new bool[rings];
-        for (size_t i=0; i<rings; i++) {
-          used[i]=false;
-        }
-
-        includes=new bool[rings*rings];
-        for (size_t i=0; i<rings*rings; i++) {
-          includes[i]=false;
-        }
-
-        hasIncludes=new bool[rings];
-        for (size_t i=0; i<rings; i++) {
-          hasIncludes[i]=false;
-        }
-      }
-
-      ~GroupingState()
-      {
-        delete [] hasIncludes;
-        delete [] includes;
-        delete [] used;
+        // no code
       }
 
       inline size_t GetRingCount() const
       {
-        return rings;
+        return used.size();
       }
 
       inline void SetUsed(size_t used)
@@ -101,20 +89,29 @@ namespace osmscout {
         return this->used[used];
       }
 
+      /**
+        Rings must be added in ascending order of includer for each included ring and
+        in ascending order of included for each includer.
+        */
       inline void SetIncluded(size_t includer, size_t included)
       {
-        hasIncludes[includer]=true;
-        includes[included*rings+includer]=true;
+        includers[included].push_back(includer);
+        includeds[includer].push_back(included);
       }
 
       inline bool HasIncludes(size_t includer) const
       {
-        return hasIncludes[includer];
+        return !includeds[includer].empty();
+      }
+
+      inline const std::vector<size_t>& GetIncluders(size_t included) const
+      {
+        return includers[included];
       }
 
-      inline bool Includes(size_t included, size_t includer) const
+      inline const std::vector<size_t>& GetIncludeds(size_t includer) const
       {
-        return includes[included*rings+includer];
+        return includeds[includer];
       }
     };
 
@@ -135,35 +132,51 @@ namespace osmscout {
       }
     };
 
+    /**
+      A relation read from the raw relation file together with the result of its
+      processing. Relations are processed in batches (possibly in parallel) and
+      written in file order afterwards.
+      */
+    struct RelationJob
+    {
+      RawRelation        rawRelation;
+      std::string        name;
+      Area               relation;
+      std::vector<OSMId> blacklist;   //! Area ways to add to the way area index blacklist
+      bool               success;     //! The relation was successfully converted
+      BufferedProgress   progress;    //! Messages to pass on after processing
+    };
+
   private:
-    std::list<MultipolygonPart>::const_iterator FindTopLevel(const std::list<MultipolygonPart>& rings,
-                                                             const GroupingState& state,
-                                                             size_t& topIndex);
+    bool FindTopLevel(const GroupingState& state,
+                      size_t& topIndex) const;
 
-    std::list<MultipolygonPart>::const_iterator FindSub(const std::list<MultipolygonPart>& rings,
-                                                        size_t topIndex,
-                                                        const GroupingState& state,
-                                                        size_t& subIndex);
+    bool FindSub(size_t topIndex,
+                 const GroupingState& state,
+                 size_t& subIndex) const;
 
-    void ConsumeSubs(const std::list<MultipolygonPart>& rings,
+    void ConsumeSubs(const std::vector<MultipolygonPart>& rings,
                      std::list<MultipolygonPart>& groups,
                      GroupingState& state,
                      size_t topIndex,
-                     size_t id);
+                     size_t id) const;
 
     bool BuildRings(const TypeConfig& typeConfig,
                     const ImportParameter& parameter,
                     Progress& progress,
                     Id id,
                     const std::string& name,
-                    std::list<MultipolygonPart>& parts);
+                    std::list<MultipolygonPart>& parts) const;
+
+    void CalculateRingInclusion(const std::vector<MultipolygonPart>& rings,
+                                GroupingState& state) const;
 
     bool ResolveMultipolygon(const TypeConfig& typeConfig,
                              const ImportParameter& parameter,
                              Progress& progress,
                              Id id,
                              const std::string& name,
-                             std::list<MultipolygonPart>& parts);
+                             std::list<MultipolygonPart>& parts) const;
 
     bool ComposeAreaMembers(const TypeConfig& typeConfig,
                             Progress& progress,
@@ -171,18 +184,18 @@ namespace osmscout {
                             const IdRawWayMap& wayMap,
                             const std::string& name,
                             const RawRelation& rawRelation,
-                            std::list<MultipolygonPart>& parts);
+                            std::list<MultipolygonPart>& parts) const;
 
     bool ComposeBoundaryMembers(const TypeConfig& typeConfig,
                                 Progress& progress,
                                 const CoordDataFile::CoordResultMap& coordMap,
                                 const IdRawWayMap& wayMap,
-                                const std::map<OSMId,RawRelationRef>& relationMap,
+                                const IdRawRelationMap& relationMap,
                                 const Area& relation,
                                 const std::string& name,
                                 const RawRelation& rawRelation,
                                 IdSet& resolvedRelations,
-                                std::list<MultipolygonPart>& parts);
+                                std::list<MultipolygonPart>& parts) const;
 
   bool ResolveMultipolygonMembers(Progress& progress,
                                   const TypeConfig& typeConfig,
@@ -193,24 +206,45 @@ namespace osmscout {
                                   const Area& relation,
                                   const std::string& name,
                                   const RawRelation& rawRelation,
-                                  std::list<MultipolygonPart>& parts);
+                                  std::list<MultipolygonPart>& parts) const;
 
     bool HandleMultipolygonRelation(const ImportParameter& parameter,
                                     Progress& progress,
                                     const TypeConfig& typeConfig,
-                                    IdSet& wayAreaIndexBlacklist,
+                                    std::vector<OSMId>& wayAreaIndexBlacklist,
                                     CoordDataFile& coordDataFile,
                                     RawWayIndexedDataFile& wayDataFile,
                                     RawRelationIndexedDataFile& relDataFile,
+                                    Mutex& dataFileMutex,
                                     RawRelation& rawRelation,
                                     const std::string& name,
-                                    Area& relation);
+                                    Area& relation) const;
+
+    void HandleRelationJobs(const ImportParameter& parameter,
+                            const TypeConfig& typeConfig,
+                            CoordDataFile& coordDataFile,
+                            RawWayIndexedDataFile& wayDataFile,
+                            RawRelationIndexedDataFile& relDataFile,
+                            Mutex& dataFileMutex,
+                            std::vector<RelationJob>& jobs,
+                            size_t& nextJob,
+                            Mutex& jobMutex) const;
+
+    void ProcessRelationJobs(const ImportParameter& parameter,
+                             const TypeConfig& typeConfig,
+                             CoordDataFile& coordDataFile,
+                             RawWayIndexedDataFile& wayDataFile,
+                             RawRelationIndexedDataFile& relDataFile,
+                             std::vector<RelationJob>& jobs) const;
 
     std::string ResolveRelationName(const FeatureRef& featureName,
                                     const RawRelation& rawRelation) const;
 
   public:
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
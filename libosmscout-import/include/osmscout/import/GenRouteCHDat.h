@@ -0,0 +1,141 @@
+#ifndef OSMSCOUT_IMPORT_GENROUTECHDAT_H
+#define OSMSCOUT_IMPORT_GENROUTECHDAT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osmscout/ContractionHierarchy.h>
+#include <osmscout/RouteNode.h>
+#include <osmscout/RoutingProfile.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Generates a contraction hierarchy for the car routing graph (see
+   * ContractionHierarchy). Nodes are contracted in the order of their
+   * edge difference (number of shortcuts added minus number of edges
+   * removed) plus their number of already contracted neighbours, priorities
+   * are updated lazily. Route nodes with turn restrictions are not
+   * contracted and form the core of the hierarchy.
+   */
+  class RouteCHDataGenerator : public ImportModule
+  {
+  private:
+    typedef ContractionHierarchy::Edge Edge;
+
+    /**
+     * A node of the routing graph during contraction
+     */
+    struct Node
+    {
+      std::vector<uint32_t> inEdges;              //! Edges from not yet contracted nodes ending at this node
+      std::vector<uint32_t> outEdges;             //! Edges starting at this node to not yet contracted nodes
+      bool                  core;                 //! The node has turn restrictions and will not be contracted
+      bool                  contracted;           //! The node has already been contracted
+      uint32_t              contractedNeighbours; //! Number of neighbours already contracted
+    };
+
+    /**
+     * A shortcut to be added for a pair of edges via the contracted node
+     */
+    struct Shortcut
+    {
+      uint32_t firstEdge;
+      uint32_t secondEdge;
+      uint32_t costs;
+    };
+
+    struct WitnessEntry
+    {
+      uint32_t costs;
+      uint32_t node;
+
+      inline bool operator<(const WitnessEntry& other) const
+      {
+        return costs>other.costs;
+      }
+    };
+
+    struct PriorityCompare
+    {
+      const std::vector<int>* priorities;
+
+      inline PriorityCompare(const std::vector<int>* priorities)
+      : priorities(priorities)
+      {
+        // no code
+      }
+
+      inline bool operator()(size_t a, size_t b) const
+      {
+        if ((*priorities)[a]==(*priorities)[b]) {
+          return a<b;
+        }
+        else {
+          return (*priorities)[a]<(*priorities)[b];
+        }
+      }
+    };
+
+    std::vector<Node>     nodes;          //! The nodes of the routing graph
+    std::vector<Edge>     edges;          //! All original and shortcut edges
+    std::vector<uint32_t> witnessCosts;   //! Costs of the current witness search per node
+    std::vector<uint32_t> witnessTouched; //! Nodes touched by the current witness search
+
+  private:
+    bool ReadRouteGraph(const TypeConfig& typeConfig,
+                        const ImportParameter& parameter,
+                        Progress& progress,
+                        const AbstractRoutingProfile& profile,
+                        std::vector<FileOffset>& nodeOffsets,
+                        std::vector<std::vector<RouteNode::Exclude> >& excludes);
+
+    void WitnessSearch(uint32_t source,
+                       uint32_t excludedNode,
+                       uint32_t maxCosts);
+
+    void FindShortcuts(uint32_t node,
+                       std::vector<Shortcut>& shortcuts);
+
+    int CalculatePriority(uint32_t node);
+
+    void ContractNode(uint32_t node,
+                      std::vector<uint32_t>& neighbours);
+
+  public:
+    static void GetDefaultCarSpeedTable(std::map<std::string,double>& map);
+
+    RouteCHDataGenerator();
+    std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
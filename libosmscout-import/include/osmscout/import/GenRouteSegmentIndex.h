@@ -0,0 +1,142 @@
+#ifndef OSMSCOUT_IMPORT_GENROUTESEGMENTINDEX_H
+#define OSMSCOUT_IMPORT_GENROUTESEGMENTINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <osmscout/RouteSegmentIndex.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/import/Import.h>
+
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  /**
+   * Generates the RouteSegmentIndex for each vehicle, a packed R-tree of the
+   * segments of all ways routable for the vehicle. The tree is packed
+   * using sort-tile-recursive (STR) bulk loading.
+   */
+  class RouteSegmentIndexGenerator : public ImportModule
+  {
+  private:
+    /**
+     * A segment of a routable way
+     */
+    struct Segment
+    {
+      FileOffset wayOffset;    //! Offset of the way
+      uint32_t   segmentIndex; //! Index of the first node of the segment
+      uint32_t   fromLat;      //! Coordinates of the first node
+      uint32_t   fromLon;
+      uint32_t   toLat;        //! Coordinates of the second node
+      uint32_t   toLon;
+
+      inline uint32_t GetMinLat() const
+      {
+        return std::min(fromLat,toLat);
+      }
+
+      inline uint32_t GetMinLon() const
+      {
+        return std::min(fromLon,toLon);
+      }
+
+      inline uint32_t GetMaxLat() const
+      {
+        return std::max(fromLat,toLat);
+      }
+
+      inline uint32_t GetMaxLon() const
+      {
+        return std::max(fromLon,toLon);
+      }
+    };
+
+    /**
+     * An already written node of the tree
+     */
+    struct NodeEntry
+    {
+      FileOffset offset; //! Offset of the node
+      uint32_t   minLat; //! Bounding box of all entries of the node
+      uint32_t   minLon;
+      uint32_t   maxLat;
+      uint32_t   maxLon;
+
+      inline uint32_t GetMinLat() const
+      {
+        return minLat;
+      }
+
+      inline uint32_t GetMinLon() const
+      {
+        return minLon;
+      }
+
+      inline uint32_t GetMaxLat() const
+      {
+        return maxLat;
+      }
+
+      inline uint32_t GetMaxLon() const
+      {
+        return maxLon;
+      }
+    };
+
+  private:
+    std::string GetFilename(Vehicle vehicle) const;
+
+    bool ReadSegments(const TypeConfigRef& typeConfig,
+                      const ImportParameter& parameter,
+                      Progress& progress,
+                      Vehicle vehicle,
+                      std::vector<Segment>& segments);
+
+    bool WriteLeaves(FileWriter& writer,
+                     std::vector<Segment>& segments,
+                     std::vector<NodeEntry>& nodes);
+
+    bool WriteInnerNodes(FileWriter& writer,
+                         std::vector<NodeEntry>& children,
+                         std::vector<NodeEntry>& nodes);
+
+    bool WriteIndex(const ImportParameter& parameter,
+                    Progress& progress,
+                    Vehicle vehicle,
+                    std::vector<Segment>& segments);
+
+  public:
+    std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
@@ -208,6 +208,10 @@ namespace osmscout {
                   const std::vector<GeoCoord>& points,
                   std::set<Pixel>& cellIntersections);
 
+    void GetCells(const Level& level,
+                  const std::vector<CompactGeoCoord>& points,
+                  std::set<Pixel>& cellIntersections);
+
     void GetCellIntersections(const Level& level,
                               const std::vector<GeoCoord>& points,
                               size_t coastline,
@@ -272,6 +276,9 @@ namespace osmscout {
 
   public:
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -32,6 +32,7 @@
 
 #include <osmscout/util/HashMap.h>
 #include <osmscout/util/HashSet.h>
+#include <osmscout/util/Mutex.h>
 
 #include <osmscout/import/Import.h>
 #include <osmscout/import/RawWay.h>
@@ -41,10 +42,7 @@ namespace osmscout {
   class WayWayDataGenerator : public ImportModule
   {
   private:
-    typedef std::list<RawWayRef>                   WayList;
-    typedef WayList::iterator                      WayListPtr;
-    typedef std::list<WayListPtr>                  WayListPtrList;
-    typedef OSMSCOUT_HASHMAP<OSMId,WayListPtrList> WaysByNodeMap;
+    typedef OSMSCOUT_HASHMAP<OSMId,std::vector<size_t> > WaysByNodeMap;
 
     bool ReadTurnRestrictions(const ImportParameter& parameter,
                               Progress& progress,
@@ -69,9 +67,24 @@ namespace osmscout {
                       OSMId wayId,
                       OSMId nodeId) const;
 
-    bool MergeWays(Progress& progress,
+    void MergeWays(Progress& progress,
                    std::list<RawWayRef>& ways,
-                   std::multimap<OSMId,TurnRestrictionRef>& restrictions);
+                   const std::multimap<OSMId,TurnRestrictionRef>& restrictions) const;
+
+    void MergeWaysOfTypes(Progress& wayProgress,
+                          Progress& typeProgress,
+                          std::vector<std::list<RawWayRef> >& waysByType,
+                          const std::vector<size_t>& types,
+                          size_t& nextType,
+                          size_t& mergedTypes,
+                          Mutex& mutex,
+                          const std::multimap<OSMId,TurnRestrictionRef>& restrictions) const;
+
+    void MergeWaysByType(const ImportParameter& parameter,
+                         Progress& progress,
+                         std::vector<std::list<RawWayRef> >& waysByType,
+                         const std::vector<size_t>& wayCounts,
+                         const std::multimap<OSMId,TurnRestrictionRef>& restrictions) const;
 
     bool WriteWay(Progress& progress,
                   const TypeConfig& typeConfig,
@@ -82,6 +95,9 @@ namespace osmscout {
 
   public:
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -20,6 +20,8 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <list>
+#include <map>
 #include <string>
 
 #include <osmscout/ImportFeatures.h>
@@ -49,16 +51,20 @@ namespace osmscout {
     std::string                  destinationDirectory;     //! Name of the destination directory
     size_t                       startStep;                //! Starting step for import
     size_t                       endStep;                  //! End step for import
+    size_t                       numberOfThreads;          //! Number of threads used inside of a step (PBF decoding, sorting, merging)
+    size_t                       parallelSteps;            //! Maximum number of independent import steps executed in parallel
 
     bool                         strictAreas;              //! Assure that areas conform to "simple" definition
 
     bool                         sortObjects;              //! Sort all objects
     size_t                       sortBlockSize;            //! Number of entries loaded in one sort iteration
+    bool                         sortExternal;             //! Sort using an external merge sort with temporary run files
     size_t                       sortTileMag;              //! Zoom level for individual sorting cells
 
     size_t                       numericIndexPageSize;     //! Size of an numeric index page in bytes
 
     bool                         coordDataMemoryMaped;     //! Use memory mapping for coord data file access
+    bool                         coordDataDense;           //! Store coords in a dense array indexed by node id
 
     bool                         rawNodeDataMemoryMaped;   //! Use memory mapping for raw node data file access
     size_t                       rawNodeDataCacheSize;     //! Size of the raw node data cache
@@ -98,6 +104,9 @@ namespace osmscout {
     TransPolygon::OptimizeMethod optimizationWayMethod;    //! what method to use to optimize ways
 
     size_t                       routeNodeBlockSize;       //! Number of route nodes loaded during import until ways get resolved
+    bool                         routeCH;                  //! Generate a contraction hierarchy for the car routing graph
+    std::map<std::string,double> routeCHCarSpeeds;         //! Speeds per type used for the contraction hierarchy (empty: defaults)
+    double                       routeCHCarMaxSpeed;       //! Maximum car speed used for the contraction hierarchy
 
     bool                         assumeLand;               //! During sea/land detection,we either trust coastlines only or make some
                                                            //! assumptions which tiles are sea and which are land.
@@ -111,16 +120,20 @@ namespace osmscout {
 
     size_t GetStartStep() const;
     size_t GetEndStep() const;
+    size_t GetNumberOfThreads() const;
+    size_t GetParallelSteps() const;
 
     bool GetStrictAreas() const;
 
     bool GetSortObjects() const;
     size_t GetSortBlockSize() const;
+    bool GetSortExternal() const;
     size_t GetSortTileMag() const;
 
     size_t GetNumericIndexPageSize() const;
 
     bool GetCoordDataMemoryMaped() const;
+    bool GetCoordDataDense() const;
 
     bool GetRawNodeDataMemoryMaped() const;
     size_t GetRawNodeDataCacheSize() const;
@@ -160,6 +173,9 @@ namespace osmscout {
     TransPolygon::OptimizeMethod GetOptimizationWayMethod() const;
 
     size_t GetRouteNodeBlockSize() const;
+    bool GetRouteCH() const;
+    const std::map<std::string,double>& GetRouteCHCarSpeeds() const;
+    double GetRouteCHCarMaxSpeed() const;
 
     bool GetAssumeLand() const;
 
@@ -169,16 +185,20 @@ namespace osmscout {
 
     void SetStartStep(size_t startStep);
     void SetSteps(size_t startStep, size_t endStep);
+    void SetNumberOfThreads(size_t numberOfThreads);
+    void SetParallelSteps(size_t parallelSteps);
 
     void SetStrictAreas(bool strictAreas);
 
     void SetSortObjects(bool sortObjects);
     void SetSortBlockSize(size_t sortBlockSize);
+    void SetSortExternal(bool sortExternal);
     void SetSortTileMag(size_t sortTileMag);
 
     void SetNumericIndexPageSize(size_t numericIndexPageSize);
 
     void SetCoordDataMemoryMaped(bool memoryMaped);
+    void SetCoordDataDense(bool dense);
 
     void SetRawNodeDataMemoryMaped(bool memoryMaped);
     void SetRawNodeDataCacheSize(size_t nodeDataCacheSize);
@@ -218,6 +238,9 @@ namespace osmscout {
     void SetOptimizationWayMethod(TransPolygon::OptimizeMethod optimizationWayMethod);
 
     void SetRouteNodeBlockSize(size_t blockSize);
+    void SetRouteCH(bool routeCH);
+    void SetRouteCHCarSpeeds(const std::map<std::string,double>& speeds);
+    void SetRouteCHCarMaxSpeed(double maxSpeed);
 
     void SetAssumeLand(bool assumeLand);
   };
@@ -228,12 +251,19 @@ namespace osmscout {
     An import consists of a number of sequentially executed steps. A step normally
     works on one object type and generates one output file (though this is just
     an suggestion). Such a step is realized by a ImportModule.
+
+    If more than one thread is configured, steps that do not depend on each other
+    are executed in parallel. Dependencies are derived from the files a module
+    declares to read and write (see GetFiles()).
     */
   class OSMSCOUT_IMPORT_API ImportModule
   {
   public:
     virtual ~ImportModule();
     virtual std::string GetDescription() const = 0;
+    virtual bool GetFiles(const ImportParameter& parameter,
+                          std::list<std::string>& inputFiles,
+                          std::list<std::string>& outputFiles) const;
     virtual bool Import(const TypeConfigRef& typeConfig,
                         const ImportParameter& parameter,
                         Progress& progress) = 0;
@@ -68,6 +68,13 @@ namespace osmscout {
     std::vector<GeoCoord> coords;
     std::vector<bool>     isSet;
 
+    bool                  coordDataDense;       //! Store coords as dense array indexed by node id
+    FileOffset            denseCoordOffset;     //! Offset of the first entry of the dense array
+    FileOffset            denseCoordPos;        //! Current write position in the dense array
+    FileOffset            denseCoordEnd;        //! End of the data written to the dense array so far
+    FileOffset            denseCoordCount;      //! Number of entries in the dense array
+    size_t                denseCoordIdErrors;   //! Number of nodes that could not be stored in the dense array
+
     GeoCoord              minCoord;
     GeoCoord              maxCoord;
 
@@ -79,26 +86,31 @@ namespace osmscout {
     bool StoreCurrentPage();
     bool StoreCoord(OSMId id,
                     const GeoCoord& coord);
+    bool StoreDenseCoord(OSMId id,
+                         const GeoCoord& coord);
 
     bool IsTurnRestriction(const TypeConfig& typeConfig,
-                           const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                           const TagMap& tags,
                            TurnRestriction::Type& type) const;
 
     void ProcessTurnRestriction(const std::vector<RawRelation::Member>& members,
                                 TurnRestriction::Type type);
 
     bool IsMultipolygon(const TypeConfig& typeConfig,
-                        const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                        const TagMap& tags,
                         TypeInfoRef& type);
 
     void ProcessMultipolygon(const TypeConfig& typeConfig,
-                             const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                             const TagMap& tags,
                              const std::vector<RawRelation::Member>& members,
                              OSMId id,
                              const TypeInfoRef& type);
 
   public:
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -110,15 +122,15 @@ namespace osmscout {
     void ProcessNode(const TypeConfig& typeConfig,
                      const OSMId& id,
                      const double& lon, const double& lat,
-                     const OSMSCOUT_HASHMAP<TagId,std::string>& tags);
+                     const TagMap& tags);
     void ProcessWay(const TypeConfig& typeConfig,
                     const OSMId& id,
                     std::vector<OSMId>& nodes,
-                    const OSMSCOUT_HASHMAP<TagId,std::string>& tags);
+                    const TagMap& tags);
     void ProcessRelation(const TypeConfig& typeConfig,
                          const OSMId& id,
                          const std::vector<RawRelation::Member>& members,
-                         const OSMSCOUT_HASHMAP<TagId,std::string>& tags);
+                         const TagMap& tags);
 
     bool Cleanup(const TypeConfigRef& typeConfig,
                  const ImportParameter& parameter,
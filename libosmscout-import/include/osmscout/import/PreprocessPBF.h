@@ -38,9 +38,9 @@ namespace osmscout {
   class PreprocessPBF : public Preprocess
   {
   private:
-    OSMSCOUT_HASHMAP<TagId,std::string> tagMap;
-    std::vector<OSMId>                  nodes;
-    std::vector<RawRelation::Member>    members;
+    TagMap                           tagMap;
+    std::vector<OSMId>               nodes;
+    std::vector<RawRelation::Member> members;
 
   private:
     void ReadNodes(const TypeConfig& typeConfig,
@@ -59,6 +59,9 @@ namespace osmscout {
                        const PBF::PrimitiveBlock& block,
                        const PBF::PrimitiveGroup &group);
 
+    void ReadBlock(const TypeConfig& typeConfig,
+                   const PBF::PrimitiveBlock& block);
+
   public:
     std::string GetDescription() const;
     bool Import(const TypeConfigRef& typeConfig,
@@ -47,6 +47,7 @@ namespace osmscout {
      *    The original node to copy from
      */
     inline RawNode(const RawNode& /*other*/)
+    : Referencable()
     {
       // no code
     }
@@ -129,7 +130,7 @@ namespace osmscout {
 
     void Parse(Progress& progress,
                const TypeConfig& typeConfig,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags);
+               const TagMap& tags);
     bool Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
     bool Write(const TypeConfig& typeConfig,
@@ -121,7 +121,7 @@ namespace osmscout {
 
     void Parse(Progress& progress,
                const TypeConfig& typeConfig,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags);
+               const TagMap& tags);
     bool Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
     bool Write(const TypeConfig& typeConfig,
@@ -39,6 +39,9 @@ namespace osmscout {
     SortAreaDataGenerator();
 
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
   };
 }
 
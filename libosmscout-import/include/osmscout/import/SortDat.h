@@ -20,14 +20,25 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <cmath>
 #include <list>
+#include <queue>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  #include <thread>
+#endif
 
 #include <osmscout/import/Import.h>
 
 #include <osmscout/DataFile.h>
 #include <osmscout/ObjectRef.h>
 
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
 #include <osmscout/util/FileWriter.h>
 #include <osmscout/util/HashMap.h>
 
@@ -79,6 +90,65 @@ namespace osmscout {
       }
     };
 
+    /**
+      Sort key of an object used by the external merge sort. Objects are
+      ordered by cell, in the cell in the same way as CellEntry and finally
+      by their position in the source files, so the result is identical
+      to the result of Renumber().
+      */
+    struct SortRecord
+    {
+      size_t     cellIndex;  //! Index of the cell
+      double     lon;        //! Longitude of the top left coordinate
+      double     lat;        //! Latitude of the top left coordinate
+      Id         id;         //! Id of the object
+      FileOffset fileOffset; //! Offset of the object in its source file
+      size_t     source;     //! Index of the source file
+
+      inline bool operator<(const SortRecord& other) const
+      {
+        if (cellIndex!=other.cellIndex) {
+          return cellIndex<other.cellIndex;
+        }
+
+        if (lon!=other.lon) {
+          return lon<other.lon;
+        }
+
+        if (lat!=other.lat) {
+          return lat>other.lat;
+        }
+
+        if (source!=other.source) {
+          return source<other.source;
+        }
+
+        return fileOffset<other.fileOffset;
+      }
+    };
+
+    /**
+      A sorted run file during merging
+      */
+    struct SortRun
+    {
+      FileScanner scanner;   //! Scanner for the run file
+      size_t      remaining; //! Number of records not yet read
+      SortRecord  current;   //! The current record of the run
+    };
+
+    /**
+      Orders runs by their current record, smallest first
+      */
+    struct SortRunGreater
+    {
+      inline bool operator()(const SortRun* a,
+                             const SortRun* b) const
+      {
+        return b->current<a->current;
+      }
+    };
+
   public:
     class ProcessingFilter : public Referencable
     {
@@ -107,6 +177,9 @@ namespace osmscout {
 
     typedef Ref<ProcessingFilter> ProcessingFilterRef;
 
+  private:
+    static const size_t maxMergeRuns=64; //! Maximum number of runs merged (and open) at the same time
+
   private:
     std::list<Source>              sources;
     std::string                    dataFilename;
@@ -118,6 +191,46 @@ namespace osmscout {
                   const ImportParameter& parameter,
                   Progress& progress);
 
+    bool CopyData(const TypeConfig& typeConfig,
+                  Progress& progress,
+                  Source& source,
+                  Id id,
+                  FileOffset fileOffset,
+                  FileWriter& dataWriter,
+                  FileWriter& mapWriter,
+                  bool& saved);
+
+    static void SortRecords(typename std::vector<SortRecord>::iterator begin,
+                            typename std::vector<SortRecord>::iterator end);
+
+    std::string GetRunFilename(const ImportParameter& parameter,
+                               size_t pass,
+                               size_t index) const;
+
+    bool WriteRuns(const ImportParameter& parameter,
+                   Progress& progress,
+                   std::vector<SortRecord>& records,
+                   std::list<std::string>& runFilenames);
+
+    bool OpenRuns(Progress& progress,
+                  const std::list<std::string>& runFilenames,
+                  std::vector<SortRun>& runs,
+                  std::priority_queue<SortRun*,std::vector<SortRun*>,SortRunGreater>& queue);
+
+    bool NextRecord(Progress& progress,
+                    SortRun* run,
+                    std::priority_queue<SortRun*,std::vector<SortRun*>,SortRunGreater>& queue);
+
+    void CloseRuns(std::vector<SortRun>& runs);
+
+    bool MergeRuns(const ImportParameter& parameter,
+                   Progress& progress,
+                   std::list<std::string>& runFilenames);
+
+    bool SortExternal(const TypeConfig& typeConfig,
+                      const ImportParameter& parameter,
+                      Progress& progress);
+
     bool Copy(const TypeConfig& typeConfig,
               const ImportParameter& parameter,
               Progress& progress);
@@ -350,65 +463,23 @@ namespace osmscout {
             ++entry) {
           progress.SetProgress(copyCount,currentEntries);
 
-          N data;
-
-          if (!entry->source->scanner.SetPos(entry->fileOffset)) {
-            progress.Error(std::string("Error while setting current position in file '")+
-                           entry->source->scanner.GetFilename()+"'");
+          bool saved;
 
+          if (!CopyData(typeConfig,
+                        progress,
+                        *entry->source,
+                        entry->id,
+                        entry->fileOffset,
+                        dataWriter,
+                        mapWriter,
+                        saved)) {
             return false;
           }
 
-          if (!data.Read(typeConfig,
-                         entry->source->scanner))  {
-            progress.Error(std::string("Error while reading data entry at offset ")+
-                           NumberToString(entry->fileOffset)+
-                           " in file '"+
-                           entry->source->scanner.GetFilename()+"'");
-
-            return false;
-          }
-
-          FileOffset fileOffset;
-          bool       save=true;
-
-          if (!dataWriter.GetPos(fileOffset)) {
-            progress.Error(std::string("Error while reading current fileOffset in file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
-
-          for (typename std::list<ProcessingFilterRef>::iterator f=filters.begin();
-              f!=filters.end();
-              ++f) {
-            ProcessingFilterRef filter(*f);
-
-            if (!filter->Process(progress,
-                                 fileOffset,
-                                 data,
-                                 save)) {
-              progress.Error(std::string("Error while processing data entry to file '")+
-                             dataWriter.GetFilename()+"'");
-
-              return false;
-            }
-          }
-
-          if (!save) {
+          if (!saved) {
             continue;
           }
 
-          if (!data.Write(typeConfig,
-                          dataWriter)) {
-            progress.Error(std::string("Error while writing data entry to file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
-
-          mapWriter.Write(entry->id);
-          mapWriter.Write((uint8_t)entry->source->type);
-          mapWriter.WriteFileOffset(fileOffset);
-
           copyCount++;
           dataCopyiedCount++;
         }
@@ -449,6 +520,596 @@ namespace osmscout {
            mapWriter.Close();
   }
 
+  /**
+    Reads the object at the given offset of the given source, passes it to the
+    filters and - if not dropped by a filter - writes it to the data file and
+    its id map entry to the map file.
+    */
+  template <class N>
+  bool SortDataGenerator<N>::CopyData(const TypeConfig& typeConfig,
+                                      Progress& progress,
+                                      Source& source,
+                                      Id id,
+                                      FileOffset fileOffset,
+                                      FileWriter& dataWriter,
+                                      FileWriter& mapWriter,
+                                      bool& saved)
+  {
+    N data;
+
+    saved=false;
+
+    if (!source.scanner.SetPos(fileOffset)) {
+      progress.Error(std::string("Error while setting current position in file '")+
+                     source.scanner.GetFilename()+"'");
+
+      return false;
+    }
+
+    if (!data.Read(typeConfig,
+                   source.scanner))  {
+      progress.Error(std::string("Error while reading data entry at offset ")+
+                     NumberToString(fileOffset)+
+                     " in file '"+
+                     source.scanner.GetFilename()+"'");
+
+      return false;
+    }
+
+    FileOffset newFileOffset;
+    bool       save=true;
+
+    if (!dataWriter.GetPos(newFileOffset)) {
+      progress.Error(std::string("Error while reading current fileOffset in file '")+
+                     dataWriter.GetFilename()+"'");
+      return false;
+    }
+
+    for (typename std::list<ProcessingFilterRef>::iterator f=filters.begin();
+        f!=filters.end();
+        ++f) {
+      ProcessingFilterRef filter(*f);
+
+      if (!filter->Process(progress,
+                           newFileOffset,
+                           data,
+                           save)) {
+        progress.Error(std::string("Error while processing data entry to file '")+
+                       dataWriter.GetFilename()+"'");
+
+        return false;
+      }
+    }
+
+    if (!save) {
+      return true;
+    }
+
+    if (!data.Write(typeConfig,
+                    dataWriter)) {
+      progress.Error(std::string("Error while writing data entry to file '")+
+                     dataWriter.GetFilename()+"'");
+      return false;
+    }
+
+    mapWriter.Write(id);
+    mapWriter.Write((uint8_t)source.type);
+    mapWriter.WriteFileOffset(newFileOffset);
+
+    saved=true;
+
+    return true;
+  }
+
+  template <class N>
+  void SortDataGenerator<N>::SortRecords(typename std::vector<SortRecord>::iterator begin,
+                                         typename std::vector<SortRecord>::iterator end)
+  {
+    std::sort(begin,end);
+  }
+
+  template <class N>
+  std::string SortDataGenerator<N>::GetRunFilename(const ImportParameter& parameter,
+                                                   size_t pass,
+                                                   size_t index) const
+  {
+    return AppendFileToDir(parameter.GetDestinationDirectory(),
+                           dataFilename+"."+NumberToString(pass)+"."+NumberToString(index)+".run");
+  }
+
+  /**
+    Sorts the given records and writes them to temporary run files. The records
+    are split into one run per thread, which are sorted in parallel.
+    */
+  template <class N>
+  bool SortDataGenerator<N>::WriteRuns(const ImportParameter& parameter,
+                                       Progress& progress,
+                                       std::vector<SortRecord>& records,
+                                       std::list<std::string>& runFilenames)
+  {
+    size_t runCount=std::max((size_t)1,
+                             std::min(parameter.GetNumberOfThreads(),
+                                      records.size()));
+    size_t runSize=(records.size()+runCount-1)/runCount;
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::vector<std::thread> threads;
+
+    for (size_t start=0; start<records.size(); start+=runSize) {
+      threads.push_back(std::thread(SortRecords,
+                                    records.begin()+start,
+                                    records.begin()+std::min(start+runSize,records.size())));
+    }
+
+    for (std::vector<std::thread>::iterator thread=threads.begin();
+         thread!=threads.end();
+         ++thread) {
+      thread->join();
+    }
+#else
+    for (size_t start=0; start<records.size(); start+=runSize) {
+      SortRecords(records.begin()+start,
+                  records.begin()+std::min(start+runSize,records.size()));
+    }
+#endif
+
+    for (size_t start=0; start<records.size(); start+=runSize) {
+      FileWriter writer;
+      size_t     count=std::min(start+runSize,records.size())-start;
+
+      runFilenames.push_back(GetRunFilename(parameter,
+                                            0,
+                                            runFilenames.size()));
+
+      if (!writer.Open(runFilenames.back())) {
+        progress.Error(std::string("Cannot create '")+writer.GetFilename()+"'");
+        return false;
+      }
+
+      writer.Write((uint64_t)count);
+      writer.Write((const char*)&records[start],
+                   count*sizeof(SortRecord));
+
+      if (writer.HasError()) {
+        progress.Error(std::string("Error while writing '")+writer.GetFilename()+"'");
+        return false;
+      }
+
+      if (!writer.Close()) {
+        progress.Error(std::string("Cannot close '")+writer.GetFilename()+"'");
+        return false;
+      }
+    }
+
+    progress.Debug("Written "+NumberToString(records.size())+" entries to "+NumberToString(runFilenames.size())+" run(s)");
+
+    records.clear();
+
+    return true;
+  }
+
+  /**
+    Opens the given run files, reads the first record of each run and adds the
+    runs to the queue.
+    */
+  template <class N>
+  bool SortDataGenerator<N>::OpenRuns(Progress& progress,
+                                      const std::list<std::string>& runFilenames,
+                                      std::vector<SortRun>& runs,
+                                      std::priority_queue<SortRun*,std::vector<SortRun*>,SortRunGreater>& queue)
+  {
+    size_t runIndex=0;
+
+    runs.resize(runFilenames.size());
+
+    for (std::list<std::string>::const_iterator runFilename=runFilenames.begin();
+         runFilename!=runFilenames.end();
+         ++runFilename) {
+      SortRun& run=runs[runIndex];
+      uint64_t count;
+
+      if (!run.scanner.Open(*runFilename,
+                            FileScanner::Sequential,
+                            false) ||
+          !run.scanner.Read(count)) {
+        progress.Error(std::string("Cannot open '")+*runFilename+"'");
+        return false;
+      }
+
+      run.remaining=(size_t)count;
+
+      if (!NextRecord(progress,
+                      &run,
+                      queue)) {
+        return false;
+      }
+
+      runIndex++;
+    }
+
+    return true;
+  }
+
+  /**
+    Reads the next record of the given run and adds the run to the queue
+    again. Nothing is done if the run is already completely read.
+    */
+  template <class N>
+  bool SortDataGenerator<N>::NextRecord(Progress& progress,
+                                        SortRun* run,
+                                        std::priority_queue<SortRun*,std::vector<SortRun*>,SortRunGreater>& queue)
+  {
+    if (run->remaining==0) {
+      return true;
+    }
+
+    if (!run->scanner.Read((char*)&run->current,
+                           sizeof(SortRecord))) {
+      progress.Error(std::string("Error while reading '")+run->scanner.GetFilename()+"'");
+      return false;
+    }
+
+    run->remaining--;
+    queue.push(run);
+
+    return true;
+  }
+
+  template <class N>
+  void SortDataGenerator<N>::CloseRuns(std::vector<SortRun>& runs)
+  {
+    for (size_t r=0; r<runs.size(); r++) {
+      if (runs[r].scanner.IsOpen()) {
+        runs[r].scanner.Close();
+      }
+    }
+  }
+
+  /**
+    Merges groups of at most maxMergeRuns runs into new, longer runs until
+    not more than maxMergeRuns runs are left, so that the number of files open
+    at the same time stays bounded. Merged runs are deleted, runFilenames
+    always holds the names of all existing run files, also in case of an
+    error.
+    */
+  template <class N>
+  bool SortDataGenerator<N>::MergeRuns(const ImportParameter& parameter,
+                                       Progress& progress,
+                                       std::list<std::string>& runFilenames)
+  {
+    size_t pass=1;
+
+    while (runFilenames.size()>maxMergeRuns) {
+      std::list<std::string> mergedFilenames;
+
+      progress.Info("Merging "+NumberToString(runFilenames.size())+" runs, pass "+NumberToString(pass));
+
+      while (!runFilenames.empty()) {
+        std::list<std::string> groupFilenames;
+
+        while (!runFilenames.empty() &&
+               groupFilenames.size()<maxMergeRuns) {
+          groupFilenames.splice(groupFilenames.end(),
+                                runFilenames,
+                                runFilenames.begin());
+        }
+
+        if (groupFilenames.size()==1) {
+          mergedFilenames.splice(mergedFilenames.end(),
+                                 groupFilenames);
+          continue;
+        }
+
+        std::vector<SortRun>                                               runs;
+        std::priority_queue<SortRun*,std::vector<SortRun*>,SortRunGreater> queue;
+        FileWriter                                                         writer;
+        uint64_t                                                           count=0;
+        bool                                                               success=true;
+
+        mergedFilenames.push_back(GetRunFilename(parameter,
+                                                 pass,
+                                                 mergedFilenames.size()));
+
+        if (!OpenRuns(progress,
+                      groupFilenames,
+                      runs,
+                      queue)) {
+          success=false;
+        }
+        else if (!writer.Open(mergedFilenames.back())) {
+          progress.Error(std::string("Cannot create '")+writer.GetFilename()+"'");
+          success=false;
+        }
+        else {
+          writer.Write(count);
+
+          while (success &&
+                 !queue.empty()) {
+            SortRun* run=queue.top();
+
+            queue.pop();
+
+            writer.Write((const char*)&run->current,
+                         sizeof(SortRecord));
+            count++;
+
+            success=NextRecord(progress,
+                               run,
+                               queue);
+          }
+
+          writer.SetPos(0);
+          writer.Write(count);
+
+          if (writer.HasError()) {
+            progress.Error(std::string("Error while writing '")+writer.GetFilename()+"'");
+            success=false;
+          }
+
+          if (!writer.Close()) {
+            progress.Error(std::string("Cannot close '")+writer.GetFilename()+"'");
+            success=false;
+          }
+        }
+
+        CloseRuns(runs);
+
+        if (!success) {
+          runFilenames.splice(runFilenames.begin(),
+                              groupFilenames);
+          runFilenames.splice(runFilenames.begin(),
+                              mergedFilenames);
+          return false;
+        }
+
+        for (std::list<std::string>::const_iterator runFilename=groupFilenames.begin();
+             runFilename!=groupFilenames.end();
+             ++runFilename) {
+          if (!RemoveFile(*runFilename)) {
+            progress.Warning(std::string("Cannot delete '")+*runFilename+"'");
+          }
+        }
+      }
+
+      runFilenames.swap(mergedFilenames);
+      pass++;
+    }
+
+    return true;
+  }
+
+  /**
+    Sorts the data using an external merge sort: The sort keys of all objects
+    are read in blocks of at most sortBlockSize entries. Each block is sorted
+    (in parallel, if more than one thread is configured) and written to
+    temporary run files. If there are more than maxMergeRuns runs, they are
+    first merged into fewer, longer runs. Finally the remaining runs are merged
+    and the objects are copied in sort order to the data file.
+
+    The source files are read sequentially once to collect the sort keys.
+    Copying reads every object a second time, now at its file offset in sort
+    order. In contrast to Renumber() the number of passes over the source files
+    does not depend on the number of objects and peak memory is bounded by
+    sortBlockSize. The result is identical to the result of Renumber().
+    */
+  template <class N>
+  bool SortDataGenerator<N>::SortExternal(const TypeConfig& typeConfig,
+                                          const ImportParameter& parameter,
+                                          Progress& progress)
+  {
+    FileWriter              dataWriter;
+    FileWriter              mapWriter;
+    uint32_t                overallDataCount=0;
+    uint32_t                dataCopyiedCount=0;
+    double                  zoomLevel=pow(2.0,(double)parameter.GetSortTileMag());
+    std::vector<Source*>    sourceList;
+    std::vector<SortRecord> records;
+    std::list<std::string>  runFilenames;
+    bool                    success=true;
+
+    progress.SetAction("Sorting data (external merge sort)");
+
+    for (typename std::list<Source>::iterator source=sources.begin();
+            source!=sources.end();
+            ++source) {
+      uint32_t dataCount;
+
+      if (!source->scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                source->filename),
+                                FileScanner::Sequential,
+                                parameter.GetWayDataMemoryMaped())) {
+        progress.Error(std::string("Cannot open '")+source->scanner.GetFilename()+"'");
+        return false;
+      }
+
+      if (!source->scanner.Read(dataCount)) {
+        progress.Error("Error while reading number of data entries in file");
+        return false;
+      }
+
+      progress.Info(NumberToString(dataCount)+" entries in file '"+source->scanner.GetFilename()+"'");
+
+      overallDataCount+=dataCount;
+      sourceList.push_back(&*source);
+    }
+
+    records.reserve(std::min((size_t)overallDataCount,
+                             std::max((size_t)1,parameter.GetSortBlockSize())));
+
+    for (size_t s=0; s<sourceList.size() && success; s++) {
+      Source&  source=*sourceList[s];
+      uint32_t dataCount;
+
+      progress.Info("Reading data from file '"+source.scanner.GetFilename()+"'");
+
+      if (!source.scanner.GotoBegin() ||
+          !source.scanner.Read(dataCount)) {
+        progress.Error("Error while reading number of data entries in file'"+
+                       source.scanner.GetFilename()+"'");
+        success=false;
+        break;
+      }
+
+      for (uint32_t current=1; current<=dataCount; current++) {
+        SortRecord record;
+        N          data;
+
+        progress.SetProgress(current,dataCount);
+
+        if (!source.scanner.Read(record.id) ||
+            !data.Read(typeConfig,
+                       source.scanner)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(current)+" of "+
+                         NumberToString(dataCount)+
+                         " in file '"+
+                         source.scanner.GetFilename()+"'");
+          success=false;
+          break;
+        }
+
+        GetTopLeftCoordinate(data,record.lat,record.lon);
+
+        size_t cellY=(size_t)((record.lat+90.0)/zoomLevel);
+        size_t cellX=(size_t)((record.lon+180.0)/zoomLevel);
+
+        record.cellIndex=cellY*zoomLevel+cellX;
+        record.fileOffset=data.GetFileOffset();
+        record.source=s;
+
+        records.push_back(record);
+
+        if (records.size()>=parameter.GetSortBlockSize()) {
+          if (!WriteRuns(parameter,
+                         progress,
+                         records,
+                         runFilenames)) {
+            success=false;
+            break;
+          }
+        }
+      }
+    }
+
+    if (success &&
+        !records.empty()) {
+      success=WriteRuns(parameter,
+                        progress,
+                        records,
+                        runFilenames);
+    }
+
+    std::vector<SortRecord>().swap(records);
+
+    if (success) {
+      success=MergeRuns(parameter,
+                        progress,
+                        runFilenames);
+    }
+
+    if (success) {
+      progress.Info("Merging "+NumberToString(runFilenames.size())+" run(s)");
+    }
+
+    std::vector<SortRun>                                               runs;
+    std::priority_queue<SortRun*,std::vector<SortRun*>,SortRunGreater> queue;
+
+    if (success) {
+      success=OpenRuns(progress,
+                       runFilenames,
+                       runs,
+                       queue);
+    }
+
+    if (success) {
+      if (!dataWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          dataFilename))) {
+        progress.Error(std::string("Cannot create '")+dataWriter.GetFilename()+"'");
+        success=false;
+      }
+      else if (!mapWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                               mapFilename))) {
+        progress.Error(std::string("Cannot create '")+mapWriter.GetFilename()+"'");
+        success=false;
+      }
+      else {
+        dataWriter.Write(overallDataCount);
+        mapWriter.Write(overallDataCount);
+      }
+    }
+
+    if (success) {
+      size_t current=0;
+
+      while (success &&
+             !queue.empty()) {
+        SortRun* run=queue.top();
+        bool     saved;
+
+        queue.pop();
+
+        progress.SetProgress(current,overallDataCount);
+
+        if (!CopyData(typeConfig,
+                      progress,
+                      *sourceList[run->current.source],
+                      run->current.id,
+                      run->current.fileOffset,
+                      dataWriter,
+                      mapWriter,
+                      saved)) {
+          success=false;
+          break;
+        }
+
+        if (saved) {
+          dataCopyiedCount++;
+        }
+
+        current++;
+
+        success=NextRecord(progress,
+                           run,
+                           queue);
+      }
+    }
+
+    CloseRuns(runs);
+
+    for (std::list<std::string>::const_iterator runFilename=runFilenames.begin();
+         runFilename!=runFilenames.end();
+         ++runFilename) {
+      if (!RemoveFile(*runFilename)) {
+        progress.Warning(std::string("Cannot delete '")+*runFilename+"'");
+      }
+    }
+
+    for (typename std::list<Source>::iterator source=sources.begin();
+            source!=sources.end();
+            ++source) {
+      if (source->scanner.IsOpen() &&
+          !source->scanner.Close()) {
+        progress.Error(std::string("Error while  closing '")+source->scanner.GetFilename()+"'");
+        success=false;
+      }
+    }
+
+    if (!success) {
+      return false;
+    }
+
+    assert(overallDataCount>=dataCopyiedCount);
+
+    dataWriter.SetPos(0);
+    dataWriter.Write(dataCopyiedCount);
+
+    mapWriter.SetPos(0);
+    mapWriter.Write(dataCopyiedCount);
+
+    return dataWriter.Close() &&
+           mapWriter.Close();
+  }
+
   template <class N>
   bool SortDataGenerator<N>::Copy(const TypeConfig& typeConfig,
                                   const ImportParameter& parameter,
@@ -608,7 +1269,15 @@ namespace osmscout {
     }
 
     if (!error) {
-      if (parameter.GetSortObjects()) {
+      if (parameter.GetSortObjects() &&
+          parameter.GetSortExternal()) {
+        if (!SortExternal(typeConfig,
+                          parameter,
+                          progress)) {
+          error=true;
+        }
+      }
+      else if (parameter.GetSortObjects()) {
         if (!Renumber(typeConfig,
                       parameter,
                       progress)) {
@@ -37,6 +37,9 @@ namespace osmscout {
     SortWayDataGenerator();
 
     std::string GetDescription() const;
+    bool GetFiles(const ImportParameter& parameter,
+                  std::list<std::string>& inputFiles,
+                  std::list<std::string>& outputFiles) const;
   };
 }
 
@@ -38,6 +38,19 @@ namespace osmscout {
     return "Generate 'areaarea.idx'";
   }
 
+  bool AreaAreaIndexGenerator::GetFiles(const ImportParameter& parameter,
+                                        std::list<std::string>& inputFiles,
+                                        std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "areas.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areaarea.idx"));
+
+    return true;
+  }
+
   void AreaAreaIndexGenerator::SetOffsetOfChildren(const std::map<Pixel,AreaLeaf>& leafs,
                                                    std::map<Pixel,AreaLeaf>& newAreaLeafs)
   {
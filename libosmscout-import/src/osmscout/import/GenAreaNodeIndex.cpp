@@ -55,6 +55,19 @@ namespace osmscout {
     return "Generate 'areanode.idx'";
   }
 
+  bool AreaNodeIndexGenerator::GetFiles(const ImportParameter& parameter,
+                                        std::list<std::string>& inputFiles,
+                                        std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "nodes.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areanode.idx"));
+
+    return true;
+  }
+
   bool AreaNodeIndexGenerator::Import(const TypeConfigRef& typeConfig,
                                       const ImportParameter& parameter,
                                       Progress& progress)
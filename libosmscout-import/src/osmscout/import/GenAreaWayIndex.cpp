@@ -54,6 +54,19 @@ namespace osmscout {
     return "Generate 'areaway.idx'";
   }
 
+  bool AreaWayIndexGenerator::GetFiles(const ImportParameter& parameter,
+                                       std::list<std::string>& inputFiles,
+                                       std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areaway.idx"));
+
+    return true;
+  }
+
   void AreaWayIndexGenerator::CalculateStatistics(size_t level,
                                                   TypeData& typeData,
                                                   const CoordCountMap& cellFillCount)
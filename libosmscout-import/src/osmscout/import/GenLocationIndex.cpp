@@ -279,7 +279,8 @@ namespace osmscout {
              ring!=area.rings.end();
              ++ring) {
           if (ring->ring==Area::outerRingId) {
-            boundary.areas.push_back(ring->nodes);
+            boundary.areas.push_back(std::vector<GeoCoord>(ring->nodes.begin(),
+                                                           ring->nodes.end()));
           }
         }
 
@@ -393,7 +394,8 @@ namespace osmscout {
            ring!=area.rings.end();
            ++ring) {
         if (ring->ring==Area::outerRingId) {
-          region->areas.push_back(ring->nodes);
+          region->areas.push_back(std::vector<GeoCoord>(ring->nodes.begin(),
+                                                        ring->nodes.end()));
         }
       }
 
@@ -569,7 +571,7 @@ namespace osmscout {
 
   bool LocationIndexGenerator::AddLocationAreaToRegion(Region& region,
                                                        const Area& area,
-                                                       const std::vector<GeoCoord>& nodes,
+                                                       const std::vector<ObjectCoord>& nodes,
                                                        const std::string& name,
                                                        double minlon,
                                                        double minlat,
@@ -1770,6 +1772,31 @@ namespace osmscout {
     return "Generate 'location.idx'";
   }
 
+  bool LocationIndexGenerator::GetFiles(const ImportParameter& parameter,
+                                        std::list<std::string>& inputFiles,
+                                        std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "nodes.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "areas.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "nodeaddress.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "wayaddress.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "areaaddress.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          LocationIndex::FILENAME_LOCATION_IDX));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "location.txt"));
+
+    return true;
+  }
+
   bool LocationIndexGenerator::Import(const TypeConfigRef& typeConfig,
                                       const ImportParameter& parameter,
                                       Progress& progress)
@@ -41,6 +41,19 @@ namespace osmscout {
     return "Generate 'nodes.tmp'";
   }
 
+  bool NodeDataGenerator::GetFiles(const ImportParameter& parameter,
+                                   std::list<std::string>& inputFiles,
+                                   std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawnodes.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "nodes.tmp"));
+
+    return true;
+  }
+
   bool NodeDataGenerator::Import(const TypeConfigRef& typeConfig,
                                  const ImportParameter& parameter,
                                  Progress& progress)
@@ -31,6 +31,27 @@ namespace osmscout {
     return "Optimize ids for areas and ways";
   }
 
+  bool OptimizeAreaWayIdsGenerator::GetFiles(const ImportParameter& parameter,
+                                             std::list<std::string>& inputFiles,
+                                             std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "relarea.tmp"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "wayarea.tmp"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "wayway.tmp"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "relarea.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "wayarea.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "wayway.dat"));
+
+    return true;
+  }
+
   bool OptimizeAreaWayIdsGenerator::ScanWayAreaIds(const ImportParameter& parameter,
                                                    Progress& progress,
                                                    const TypeConfig& typeConfig,
@@ -58,6 +58,19 @@ namespace osmscout
     return "Generate '"+std::string(FILE_AREASOPT_DAT)+"'";
   }
 
+  bool OptimizeAreasLowZoomGenerator::GetFiles(const ImportParameter& parameter,
+                                               std::list<std::string>& inputFiles,
+                                               std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "areas.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areasopt.dat"));
+
+    return true;
+  }
+
   void OptimizeAreasLowZoomGenerator::GetAreaTypesToOptimize(const TypeConfig& typeConfig,
                                                              std::set<TypeInfoRef>& types)
   {
@@ -63,6 +63,19 @@ namespace osmscout
     return "Generate '"+std::string(FILE_WAYSOPT_DAT)+"'";
   }
 
+  bool OptimizeWaysLowZoomGenerator::GetFiles(const ImportParameter& parameter,
+                                              std::list<std::string>& inputFiles,
+                                              std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "waysopt.dat"));
+
+    return true;
+  }
+
   void OptimizeWaysLowZoomGenerator::GetWayTypesToOptimize(const TypeConfig& typeConfig,
                                                            std::set<TypeInfoRef>& types)
   {
@@ -262,8 +275,8 @@ namespace osmscout
             }
 
             if (otherWay!=match->second.end()) {
-              std::vector<Id>       newIds;
-              std::vector<GeoCoord> newNodes;
+              std::vector<Id>          newIds;
+              std::vector<ObjectCoord> newNodes;
 
               newIds.reserve(way->ids.size()+(*otherWay)->ids.size()-1);
               newNodes.reserve(way->nodes.size()+(*otherWay)->nodes.size()-1);
@@ -472,12 +485,12 @@ namespace osmscout
     projection.Set(0,0,magnification,width,height);
 
     for (auto &way :ways) {
-      TransPolygon          polygon;
-      std::vector<GeoCoord> newNodes;
-      double                xmin;
-      double                xmax;
-      double                ymin;
-      double                ymax;
+      TransPolygon             polygon;
+      std::vector<ObjectCoord> newNodes;
+      double                   xmin;
+      double                   xmax;
+      double                   ymin;
+      double                   ymax;
 
       polygon.TransformWay(projection,
                            optimizeWayMethod,
@@ -21,6 +21,12 @@
 
 #include <algorithm>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  #include <thread>
+#endif
+
 #include <osmscout/TypeFeatures.h>
 
 #include <osmscout/system/Assert.h>
@@ -30,15 +36,9 @@
 namespace osmscout {
 
   /**
-    Returns true, if area a is in area b
+    Number of relations read and processed at once
    */
-  inline bool IsAreaInArea(const std::vector<bool>& includes,
-                           size_t count,
-                           size_t a,
-                           size_t b)
-  {
-    return includes[a*count+b];
-  }
+  static const size_t relationBatchSize=256;
 
   /**
     Find a top level role.
@@ -46,20 +46,16 @@ namespace osmscout {
     A top level role is a role that is not included by any other unused role ("top level tree
     element").
    */
-  std::list<RelAreaDataGenerator::MultipolygonPart>::const_iterator RelAreaDataGenerator::FindTopLevel(const std::list<MultipolygonPart>& rings,
-                                                                                                       const GroupingState& state,
-                                                                                                       size_t& topIndex)
+  bool RelAreaDataGenerator::FindTopLevel(const GroupingState& state,
+                                          size_t& topIndex) const
   {
-    size_t i=0;
-    for (std::list<MultipolygonPart>::const_iterator r=rings.begin();
-         r!=rings.end();
-         r++) {
+    for (size_t i=0; i<state.GetRingCount(); i++) {
       if (!state.IsUsed(i)) {
-        bool included=false;
+        const std::vector<size_t>& includers=state.GetIncluders(i);
+        bool                       included=false;
 
-        for (size_t x=0; x<state.GetRingCount(); x++) {
-          if (!state.IsUsed(x) &&
-              state.Includes(i,x)) {
+        for (size_t x=0; x<includers.size(); x++) {
+          if (!state.IsUsed(includers[x])) {
             included=true;
             break;
           }
@@ -67,14 +63,12 @@ namespace osmscout {
 
         if (!included) {
           topIndex=i;
-          return r;
+          return true;
         }
       }
-
-      ++i;
     }
 
-    return rings.end();
+    return false;
   }
 
   /**
@@ -83,77 +77,92 @@ namespace osmscout {
     A sub role is a role that is included by the given top role but is not included
     by any other role ("direct child tree element").
    */
-  std::list<RelAreaDataGenerator::MultipolygonPart>::const_iterator RelAreaDataGenerator::FindSub(const std::list<MultipolygonPart>& rings,
-                                                                                                  size_t topIndex,
-                                                                                                  const GroupingState& state,
-                                                                                                  size_t& subIndex)
+  bool RelAreaDataGenerator::FindSub(size_t topIndex,
+                                     const GroupingState& state,
+                                     size_t& subIndex) const
   {
-    size_t i=0;
-    for (std::list<MultipolygonPart>::const_iterator r=rings.begin();
-         r!=rings.end(); r++) {
-      if (!state.IsUsed(i) &&
-          state.Includes(i,topIndex)) {
-        bool included=false;
-
-        for (size_t x=0; x<state.GetRingCount(); x++) {
-          if (x!=i && !state.IsUsed(x)) {
-            included=state.Includes(i,x);
-
-            if (included) {
-              break;
-            }
+    const std::vector<size_t>& includeds=state.GetIncludeds(topIndex);
+
+    for (size_t s=0; s<includeds.size(); s++) {
+      size_t i=includeds[s];
+
+      if (!state.IsUsed(i)) {
+        const std::vector<size_t>& includers=state.GetIncluders(i);
+        bool                       included=false;
+
+        for (size_t x=0; x<includers.size(); x++) {
+          if (!state.IsUsed(includers[x])) {
+            included=true;
+            break;
           }
         }
 
         if (!included) {
           subIndex=i;
-          return r;
+          return true;
         }
       }
-
-      ++i;
     }
 
-    return rings.end();
+    return false;
   }
 
   /**
     Recursivly consume all direct children and all direct children of that children)
     of the given role.
    */
-  void RelAreaDataGenerator::ConsumeSubs(const std::list<MultipolygonPart>& rings,
+  void RelAreaDataGenerator::ConsumeSubs(const std::vector<MultipolygonPart>& rings,
                                          std::list<MultipolygonPart>& groups,
                                          GroupingState& state,
                                          size_t topIndex,
-                                         size_t id)
+                                         size_t id) const
   {
-    std::list<MultipolygonPart>::const_iterator sub;
-    size_t                                      subIndex;
+    size_t subIndex;
 
-    sub=FindSub(rings,topIndex,state,subIndex);
-    while (sub!=rings.end()) {
+    while (FindSub(topIndex,state,subIndex)) {
       state.SetUsed(subIndex);
-      groups.push_back(*sub);
+      groups.push_back(rings[subIndex]);
       groups.back().role.ring=id;
 
       ConsumeSubs(rings,groups,state,subIndex,id+1);
-
-      sub=FindSub(rings,topIndex,state,subIndex);
     }
   }
 
+  /**
+    Merge all parts, that are not already closed areas, to rings by joining them
+    at their end nodes.
+
+    The end nodes of all parts are held in one array sorted by node id (and in
+    order of the parts for the same node id) together with a hash index
+    from the node id to its range in the array. Starting with the lowest node id
+    unused parts are extended at their back until no unused part with the same end
+    node is left.
+   */
   bool RelAreaDataGenerator::BuildRings(const TypeConfig& typeConfig,
                                         const ImportParameter& parameter,
                                         Progress& progress,
                                         Id id,
                                         const std::string& name,
-                                        std::list<MultipolygonPart>& parts)
+                                        std::list<MultipolygonPart>& parts) const
   {
-    std::list<MultipolygonPart>                 rings;
-    bool                                        allArea=true;
-
-    std::map<Id, std::list<MultipolygonPart*> > partsByEnd;
-    std::set<MultipolygonPart*>                 usedParts;
+    /**
+      The parts ending at a given node (a range in the array of all ends)
+      */
+    struct EndGroup
+    {
+      Id     id;
+      size_t begin; //! Index of the first end of the group
+      size_t end;   //! Index after the last end of the group
+      size_t next;  //! Index of the first end that might still reference an unused part
+    };
+
+    std::list<MultipolygonPart>        rings;
+    std::vector<MultipolygonPart*>     ringParts;
+    std::vector<std::pair<Id,size_t> > ends;
+    std::vector<EndGroup>              groups;
+    OSMSCOUT_HASHMAP<Id,size_t>        groupByEnd;
+    std::vector<bool>                  usedParts;
+    bool                               allArea=true;
 
     // First check, if relation only consists of closed areas
     // In this case nothing is to do
@@ -178,123 +187,154 @@ namespace osmscout {
         rings.push_back(*part);
       }
       else {
-        partsByEnd[part->role.ids.front()].push_back(&(*part));
-        partsByEnd[part->role.ids.back()].push_back(&(*part));
+        // The second value is the (unique) position of the end in the order of
+        // the parts, which gives the part index when divided by 2
+        ends.push_back(std::make_pair(part->role.ids.front(),2*ringParts.size()));
+        ends.push_back(std::make_pair(part->role.ids.back(),2*ringParts.size()+1));
+        ringParts.push_back(&(*part));
+      }
+    }
+
+    std::sort(ends.begin(),
+              ends.end());
+
+    for (size_t e=0; e<ends.size(); e++) {
+      if (groups.empty() ||
+          groups.back().id!=ends[e].first) {
+        EndGroup group;
+
+        group.id=ends[e].first;
+        group.begin=e;
+        group.end=e;
+        group.next=e;
+
+        groups.push_back(group);
       }
+
+      groups.back().end=e+1;
     }
 
-    for (std::map<Id, std::list<MultipolygonPart*> >::iterator entry=partsByEnd.begin();
-         entry!=partsByEnd.end();
-         ++entry) {
-      if (entry->second.size()<2) {
-        progress.Error("Node "+NumberToString(entry->first)+
-                       " of way "+NumberToString(entry->second.front()->ways.front()->GetId())+
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    groupByEnd.reserve(groups.size());
+#endif
+
+    for (size_t g=0; g<groups.size(); g++) {
+      size_t count=groups[g].end-groups[g].begin;
+
+      if (count<2) {
+        progress.Error("Node "+NumberToString(groups[g].id)+
+                       " of way "+NumberToString(ringParts[ends[groups[g].begin].second/2]->ways.front()->GetId())+
                        " cannot be joined with any other way of the relation "+
                        NumberToString(id)+" "+name);
         return false;
       }
 
-      if (entry->second.size()%2!=0) {
-        progress.Error("Node "+NumberToString(entry->first)+
-                       " of way "+NumberToString(entry->second.front()->ways.front()->GetId())+
+      if (count%2!=0) {
+        progress.Error("Node "+NumberToString(groups[g].id)+
+                       " of way "+NumberToString(ringParts[ends[groups[g].begin].second/2]->ways.front()->GetId())+
                        " can be joined with uneven number of ways of the relation "+
                        NumberToString(id)+" "+name);
         return false;
       }
+
+      groupByEnd[groups[g].id]=g;
     }
 
-    for (std::map<Id, std::list<MultipolygonPart*> >::iterator entry=partsByEnd.begin();
-         entry!=partsByEnd.end();
-         ++entry) {
-      while (!entry->second.empty()) {
+    usedParts.resize(ringParts.size(),false);
 
-        MultipolygonPart* part=entry->second.front();
+    std::vector<size_t> ringPartIndexes;
 
-        entry->second.pop_front();
+    for (size_t g=0; g<groups.size(); g++) {
+      for (size_t e=groups[g].begin; e<groups[g].end; e++) {
+        size_t partIndex=ends[e].second/2;
 
-        if (usedParts.find(part)!=usedParts.end()) {
+        if (usedParts[partIndex]) {
           continue;
         }
 
-        usedParts.insert(part);
+        usedParts[partIndex]=true;
 
-        MultipolygonPart             ring;
-        std::list<MultipolygonPart*> ringParts;
-        size_t                       nodeCount;
-        Id                           backId;
+        MultipolygonPart* part=ringParts[partIndex];
+        MultipolygonPart  ring;
+        size_t            nodeCount;
+        Id                backId;
 
         ring.role.SetType(typeConfig.typeInfoIgnore);
         ring.role.ring=Area::outerRingId;
         ring.ways=part->ways;
 
-        ringParts.push_back(part);
+        ringPartIndexes.clear();
+        ringPartIndexes.push_back(partIndex);
         nodeCount=part->role.nodes.size();
         backId=part->role.ids.back();
 
         while (true) {
-          std::map<Id, std::list<MultipolygonPart*> >::iterator match=partsByEnd.find(backId);
+          OSMSCOUT_HASHMAP<Id,size_t>::const_iterator match=groupByEnd.find(backId);
 
-          if (match!=partsByEnd.end()) {
-            std::list<MultipolygonPart*>::iterator otherPart;
-
-            // Search for matching part that has the same endpoint (and is not the part itself)
-            otherPart=match->second.begin();
-            while (otherPart!=match->second.end() &&
-                   usedParts.find(*otherPart)!=usedParts.end()) {
-              otherPart++;
-            }
+          if (match==groupByEnd.end()) {
+            break;
+          }
 
-            if (otherPart!=match->second.end()) {
-              if (backId==(*otherPart)->role.ids.front()) {
-                backId=(*otherPart)->role.ids.back();
-              }
-              else {
-                backId=(*otherPart)->role.ids.front();
-              }
+          EndGroup& group=groups[match->second];
 
-              ring.ways.push_back((*otherPart)->ways.front());
+          // Search for matching part that has the same endpoint (and is not the part itself)
+          while (group.next<group.end &&
+                 usedParts[ends[group.next].second/2]) {
+            group.next++;
+          }
 
-              ringParts.push_back(*otherPart);
-              nodeCount+=(*otherPart)->role.nodes.size()-1;
+          if (group.next>=group.end) {
+            // We have found no match
+            break;
+          }
 
-              usedParts.insert(*otherPart);
-              match->second.erase(otherPart);
+          size_t            otherPartIndex=ends[group.next].second/2;
+          MultipolygonPart* otherPart=ringParts[otherPartIndex];
 
-              continue;
-            }
+          if (backId==otherPart->role.ids.front()) {
+            backId=otherPart->role.ids.back();
           }
+          else {
+            backId=otherPart->role.ids.front();
+          }
+
+          ring.ways.push_back(otherPart->ways.front());
 
-          // We have found no match
-          break;
+          ringPartIndexes.push_back(otherPartIndex);
+          nodeCount+=otherPart->role.nodes.size()-1;
+
+          usedParts[otherPartIndex]=true;
         }
 
         ring.role.ids.reserve(nodeCount);
         ring.role.nodes.reserve(nodeCount);
 
-        for (std::list<MultipolygonPart*>::const_iterator p=ringParts.begin();
-             p!=ringParts.end();
-             ++p) {
-          MultipolygonPart* part=*p;
+        for (size_t p=0; p<ringPartIndexes.size(); p++) {
+          MultipolygonPart* part=ringParts[ringPartIndexes[p]];
 
-          if (p==ringParts.begin()) {
-            for (size_t i=0; i<part->role.nodes.size(); i++) {
-              ring.role.ids.push_back(part->role.ids[i]);
-              ring.role.nodes.push_back(part->role.nodes[i]);
-            }
+          if (p==0) {
+            ring.role.ids.insert(ring.role.ids.end(),
+                                 part->role.ids.begin(),
+                                 part->role.ids.end());
+            ring.role.nodes.insert(ring.role.nodes.end(),
+                                   part->role.nodes.begin(),
+                                   part->role.nodes.end());
           }
           else if (ring.role.ids.back()==part->role.ids.front()) {
-            for (size_t i=1; i<part->role.nodes.size(); i++) {
-              ring.role.ids.push_back(part->role.ids[i]);
-              ring.role.nodes.push_back(part->role.nodes[i]);
-            }
+            ring.role.ids.insert(ring.role.ids.end(),
+                                 part->role.ids.begin()+1,
+                                 part->role.ids.end());
+            ring.role.nodes.insert(ring.role.nodes.end(),
+                                   part->role.nodes.begin()+1,
+                                   part->role.nodes.end());
           }
           else {
-            for (size_t i=1; i<part->role.nodes.size(); i++) {
-              size_t idx=part->role.nodes.size()-1-i;
-
-              ring.role.ids.push_back(part->role.ids[idx]);
-              ring.role.nodes.push_back(part->role.nodes[idx]);
-            }
+            ring.role.ids.insert(ring.role.ids.end(),
+                                 part->role.ids.rbegin()+1,
+                                 part->role.ids.rend());
+            ring.role.nodes.insert(ring.role.nodes.end(),
+                                   part->role.nodes.rbegin()+1,
+                                   part->role.nodes.rend());
           }
         }
 
@@ -323,6 +363,83 @@ namespace osmscout {
     return true;
   }
 
+  /**
+    Calculate which ring is included in which other ring.
+
+    A ring a can only be part of ring b (see IsAreaSubOfArea()), if the first
+    node of a is within the bounding box of b, because else the first node
+    already decides that a is outside of b. Rings are thus indexed by the
+    latitude of their first node and only the rings with a first node within the
+    bounding box of a ring are checked in detail.
+   */
+  void RelAreaDataGenerator::CalculateRingInclusion(const std::vector<MultipolygonPart>& rings,
+                                                    GroupingState& state) const
+  {
+    // Margin for the longitude check, to be on the safe side regarding rounding errors
+    // in the point in polygon check
+    const double                           lonMargin=0.000001;
+    std::vector<std::pair<double,size_t> > ringsByLat;
+    std::vector<size_t>                    candidates;
+
+    ringsByLat.reserve(rings.size());
+
+    for (size_t r=0; r<rings.size(); r++) {
+      if (!rings[r].role.nodes.empty()) {
+        ringsByLat.push_back(std::make_pair(rings[r].role.nodes.front().GetLat(),r));
+      }
+    }
+
+    std::sort(ringsByLat.begin(),
+              ringsByLat.end());
+
+    for (size_t b=0; b<rings.size(); b++) {
+      const std::vector<ObjectCoord>& nodes=rings[b].role.nodes;
+
+      if (nodes.empty()) {
+        continue;
+      }
+
+      double minLon,maxLon,minLat,maxLat;
+
+      GetBoundingBox(nodes,
+                     minLon,
+                     maxLon,
+                     minLat,
+                     maxLat);
+
+      std::vector<std::pair<double,size_t> >::const_iterator candidate;
+
+      candidate=std::lower_bound(ringsByLat.begin(),
+                                 ringsByLat.end(),
+                                 std::make_pair(minLat,(size_t)0));
+
+      candidates.clear();
+
+      while (candidate!=ringsByLat.end() &&
+             candidate->first<=maxLat) {
+        size_t a=candidate->second;
+        double lon=rings[a].role.nodes.front().GetLon();
+
+        if (a!=b &&
+            lon>=minLon-lonMargin &&
+            lon<=maxLon+lonMargin) {
+          candidates.push_back(a);
+        }
+
+        ++candidate;
+      }
+
+      std::sort(candidates.begin(),
+                candidates.end());
+
+      for (size_t c=0; c<candidates.size(); c++) {
+        if (IsAreaSubOfArea(rings[candidates[c]].role.nodes,nodes)) {
+          state.SetIncluded(b,candidates[c]);
+        }
+      }
+    }
+  }
+
   /**
     Try to resolve a multipolygon relation.
 
@@ -333,7 +450,7 @@ namespace osmscout {
                                                  Progress& progress,
                                                  Id id,
                                                  const std::string& name,
-                                                 std::list<MultipolygonPart>& parts)
+                                                 std::list<MultipolygonPart>& parts) const
   {
     std::list<MultipolygonPart> groups;
 
@@ -354,40 +471,21 @@ namespace osmscout {
     // Ring grouping
     //
 
-    GroupingState state(parts.size());
-
-    size_t ix=0;
-    for (std::list<MultipolygonPart>::const_iterator r1=parts.begin();
-         r1!=parts.end();
-         ++r1) {
-      size_t jx=0;
-      for (std::list<MultipolygonPart>::const_iterator r2=parts.begin();
-           r2!=parts.end();
-           ++r2) {
-        if (ix!=jx) {
-          if (IsAreaSubOfArea(r2->role.nodes,r1->role.nodes)) {
-            state.SetIncluded(ix,jx);
-          }
-        }
-
-        jx++;
-      }
+    std::vector<MultipolygonPart> rings(parts.begin(),parts.end());
+    GroupingState                 state(rings.size());
 
-      ix++;
-    }
+    CalculateRingInclusion(rings,
+                           state);
 
     //
     // Multipolygon creation
     //
 
     while (groups.size()<state.GetRingCount()) {
-      std::list<MultipolygonPart>::const_iterator top;
-      size_t                                      topIndex=0;
+      size_t topIndex=0;
 
       // Find a ring that is not yet used and that is not contained by another unused ring
-      top=FindTopLevel(parts,state,topIndex);
-
-      if (top==parts.end()) {
+      if (!FindTopLevel(state,topIndex)) {
         progress.Warning("Error during ring grouping for multipolygon relation "+
                          NumberToString(id)+" "+
                          name);
@@ -396,11 +494,11 @@ namespace osmscout {
 
       state.SetUsed(topIndex);
 
-      groups.push_back(*top);
+      groups.push_back(rings[topIndex]);
       groups.back().role.ring=Area::outerRingId;
 
       if (state.HasIncludes(topIndex)) {
-        ConsumeSubs(parts,groups,state,topIndex,Area::outerRingId+1);
+        ConsumeSubs(rings,groups,state,topIndex,Area::outerRingId+1);
       }
     }
 
@@ -425,7 +523,7 @@ namespace osmscout {
                                                 const IdRawWayMap& wayMap,
                                                 const std::string& name,
                                                 const RawRelation& rawRelation,
-                                                std::list<MultipolygonPart>& parts)
+                                                std::list<MultipolygonPart>& parts) const
   {
     for (std::vector<RawRelation::Member>::const_iterator member=rawRelation.members.begin();
          member!=rawRelation.members.end();
@@ -495,12 +593,12 @@ namespace osmscout {
                                                     Progress& progress,
                                                     const CoordDataFile::CoordResultMap& coordMap,
                                                     const IdRawWayMap& wayMap,
-                                                    const std::map<OSMId,RawRelationRef>& relationMap,
+                                                    const IdRawRelationMap& relationMap,
                                                     const Area& relation,
                                                     const std::string& name,
                                                     const RawRelation& rawRelation,
                                                     IdSet& resolvedRelations,
-                                                    std::list<MultipolygonPart>& parts)
+                                                    std::list<MultipolygonPart>& parts) const
   {
     for (std::vector<RawRelation::Member>::const_iterator member=rawRelation.members.begin();
          member!=rawRelation.members.end();
@@ -508,7 +606,7 @@ namespace osmscout {
       if (member->type==RawRelation::memberRelation) {
         if (member->role=="inner" ||
             member->role=="outer") {
-          std::map<OSMId,RawRelationRef>::const_iterator relationEntry=relationMap.find(member->id);
+          IdRawRelationMap::const_iterator relationEntry=relationMap.find(member->id);
 
           if (relationEntry==relationMap.end()) {
             progress.Error("Cannot resolve relation member "+
@@ -609,17 +707,17 @@ namespace osmscout {
                                                         const Area& relation,
                                                         const std::string& name,
                                                         const RawRelation& rawRelation,
-                                                        std::list<MultipolygonPart>& parts)
+                                                        std::list<MultipolygonPart>& parts) const
   {
-    TypeId                         boundaryId=typeConfig.GetAreaTypeId("boundary_administrative");
-    std::set<OSMId>                nodeIds;
-    std::set<OSMId>                wayIds;
-    std::set<OSMId>                pendingRelationIds;
-    std::set<OSMId>                visitedRelationIds;
+    TypeId                        boundaryId=typeConfig.GetAreaTypeId("boundary_administrative");
+    std::vector<OSMId>            nodeIds;
+    std::set<OSMId>               wayIds;
+    std::set<OSMId>               pendingRelationIds;
+    IdSet                         visitedRelationIds;
 
-    CoordDataFile::CoordResultMap  coordMap;
-    IdRawWayMap                    wayMap;
-    std::map<OSMId,RawRelationRef> relationMap;
+    CoordDataFile::CoordResultMap coordMap;
+    IdRawWayMap                   wayMap;
+    IdRawRelationMap              relationMap;
 
     visitedRelationIds.insert(rawRelation.GetId());
 
@@ -761,11 +859,9 @@ namespace osmscout {
          ++w) {
       RawWayRef way(*w);
 
-      for (std::vector<OSMId>::const_iterator id=way->GetNodes().begin();
-           id!=way->GetNodes().end();
-           ++id) {
-        nodeIds.insert(*id);
-      }
+      nodeIds.insert(nodeIds.end(),
+                     way->GetNodes().begin(),
+                     way->GetNodes().end());
 
       wayMap[way->GetId()]=way;
     }
@@ -815,29 +911,35 @@ namespace osmscout {
   bool RelAreaDataGenerator::HandleMultipolygonRelation(const ImportParameter& parameter,
                                                         Progress& progress,
                                                         const TypeConfig& typeConfig,
-                                                        IdSet& wayAreaIndexBlacklist,
+                                                        std::vector<OSMId>& wayAreaIndexBlacklist,
                                                         CoordDataFile& coordDataFile,
                                                         RawWayIndexedDataFile& wayDataFile,
                                                         RawRelationIndexedDataFile& relDataFile,
+                                                        Mutex& dataFileMutex,
                                                         RawRelation& rawRelation,
                                                         const std::string& name,
-                                                        Area& relation)
+                                                        Area& relation) const
   {
     IdSet resolvedRelations;
 
     std::list<MultipolygonPart> parts;
 
-    if (!ResolveMultipolygonMembers(progress,
-                                    typeConfig,
-                                    coordDataFile,
-                                    wayDataFile,
-                                    relDataFile,
-                                    resolvedRelations,
-                                    relation,
-                                    name,
-                                    rawRelation,
-                                    parts)) {
-      return false;
+    {
+      // The data files cannot be accessed in parallel
+      MutexLocker locker(dataFileMutex);
+
+      if (!ResolveMultipolygonMembers(progress,
+                                      typeConfig,
+                                      coordDataFile,
+                                      wayDataFile,
+                                      relDataFile,
+                                      resolvedRelations,
+                                      relation,
+                                      name,
+                                      rawRelation,
+                                      parts)) {
+        return false;
+      }
     }
 
     // Reconstruct multipolygon relation by applying the multipolygon resolving
@@ -968,7 +1070,7 @@ namespace osmscout {
         // However because we change the type of area rings to typeIgnore above we need some bookkeeping for this
         // to work here.
         // On the other hand do not fill the blacklist until you are sure that the relation will not be rejected.
-        wayAreaIndexBlacklist.insert(ring->ways.front()->GetId());
+        wayAreaIndexBlacklist.push_back(ring->ways.front()->GetId());
       }
     }
 
@@ -990,6 +1092,109 @@ namespace osmscout {
     return true;
   }
 
+  /**
+    Worker for ProcessRelationJobs(), takes the next unprocessed job until all jobs
+    are processed.
+   */
+  void RelAreaDataGenerator::HandleRelationJobs(const ImportParameter& parameter,
+                                                const TypeConfig& typeConfig,
+                                                CoordDataFile& coordDataFile,
+                                                RawWayIndexedDataFile& wayDataFile,
+                                                RawRelationIndexedDataFile& relDataFile,
+                                                Mutex& dataFileMutex,
+                                                std::vector<RelationJob>& jobs,
+                                                size_t& nextJob,
+                                                Mutex& jobMutex) const
+  {
+    while (true) {
+      size_t j;
+
+      {
+        MutexLocker locker(jobMutex);
+
+        if (nextJob>=jobs.size()) {
+          return;
+        }
+
+        j=nextJob;
+        nextJob++;
+      }
+
+      RelationJob& job=jobs[j];
+
+      job.success=HandleMultipolygonRelation(parameter,
+                                             job.progress,
+                                             typeConfig,
+                                             job.blacklist,
+                                             coordDataFile,
+                                             wayDataFile,
+                                             relDataFile,
+                                             dataFileMutex,
+                                             job.rawRelation,
+                                             job.name,
+                                             job.relation);
+    }
+  }
+
+  /**
+    Convert the relations of the given jobs. If more than one thread is configured,
+    the relations are processed in parallel. Loading of the members is serialized,
+    the (expensive) ring assembly and grouping of huge relations runs in parallel.
+    Messages are buffered in the job, so that they can be passed on in file order.
+   */
+  void RelAreaDataGenerator::ProcessRelationJobs(const ImportParameter& parameter,
+                                                 const TypeConfig& typeConfig,
+                                                 CoordDataFile& coordDataFile,
+                                                 RawWayIndexedDataFile& wayDataFile,
+                                                 RawRelationIndexedDataFile& relDataFile,
+                                                 std::vector<RelationJob>& jobs) const
+  {
+    Mutex  dataFileMutex;
+    Mutex  jobMutex;
+    size_t nextJob=0;
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    size_t threadCount=std::min(parameter.GetNumberOfThreads(),
+                                jobs.size());
+
+    if (threadCount>1) {
+      std::vector<std::thread> threads;
+
+      for (size_t t=0; t<threadCount; t++) {
+        threads.push_back(std::thread(&RelAreaDataGenerator::HandleRelationJobs,
+                                      this,
+                                      std::cref(parameter),
+                                      std::cref(typeConfig),
+                                      std::ref(coordDataFile),
+                                      std::ref(wayDataFile),
+                                      std::ref(relDataFile),
+                                      std::ref(dataFileMutex),
+                                      std::ref(jobs),
+                                      std::ref(nextJob),
+                                      std::ref(jobMutex)));
+      }
+
+      for (std::vector<std::thread>::iterator thread=threads.begin();
+           thread!=threads.end();
+           ++thread) {
+        thread->join();
+      }
+
+      return;
+    }
+#endif
+
+    HandleRelationJobs(parameter,
+                       typeConfig,
+                       coordDataFile,
+                       wayDataFile,
+                       relDataFile,
+                       dataFileMutex,
+                       jobs,
+                       nextJob,
+                       jobMutex);
+  }
+
   std::string RelAreaDataGenerator::ResolveRelationName(const FeatureRef& featureName,
                                                         const RawRelation& rawRelation) const
   {
@@ -1011,6 +1216,29 @@ namespace osmscout {
     return "Generate 'relarea.tmp'";
   }
 
+  bool RelAreaDataGenerator::GetFiles(const ImportParameter& parameter,
+                                      std::list<std::string>& inputFiles,
+                                      std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "coord.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawways.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawway.idx"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawrels.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawrel.idx"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "relarea.tmp"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "wayareablack.dat"));
+
+    return true;
+  }
+
   bool RelAreaDataGenerator::Import(const TypeConfigRef& typeConfig,
                                     const ImportParameter& parameter,
                                     Progress& progress)
@@ -1088,71 +1316,92 @@ namespace osmscout {
 
     writer.Write(writtenRelationCount);
 
-    for (uint32_t r=1; r<=rawRelationCount; r++) {
-      progress.SetProgress(r,rawRelationCount);
+    std::vector<RelationJob> jobs;
+    uint32_t                 r=1;
 
-      RawRelation rawRel;
+    while (r<=rawRelationCount) {
+      jobs.clear();
+      jobs.resize(std::min((size_t)(rawRelationCount-r+1),
+                           relationBatchSize));
 
-      if (!rawRel.Read(typeConfig,
-                       scanner)) {
-        progress.Error(std::string("Error while reading data entry ")+
-                       NumberToString(r)+" of "+
-                       NumberToString(rawRelationCount)+
-                       " in file '"+
-                       scanner.GetFilename()+"'");
-        return false;
-      }
+      for (size_t j=0; j<jobs.size(); j++) {
+        progress.SetProgress(r,rawRelationCount);
 
-      // Normally we now also skip an object because of its missing type, but
-      // in case of relations things are a little bit more difficult,
-      // type might be placed at the outer ring and not on the relation
-      // itself, we thus still need to parse the complete relation for
-      // type analysis before we can skip it.
+        RelationJob& job=jobs[j];
 
-      std::string name=ResolveRelationName(featureName,
-                                           rawRel);
-      Area        rel;
+        if (!job.rawRelation.Read(typeConfig,
+                                  scanner)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(r)+" of "+
+                         NumberToString(rawRelationCount)+
+                         " in file '"+
+                         scanner.GetFilename()+"'");
+          return false;
+        }
 
-      if (!HandleMultipolygonRelation(parameter,
-                                      progress,
-                                      typeConfig,
-                                      wayAreaIndexBlacklist,
-                                      coordDataFile,
-                                      wayDataFile,
-                                      relDataFile,
-                                      rawRel,
-                                      name,
-                                      rel)) {
-        continue;
-      }
+        // Normally we now also skip an object because of its missing type, but
+        // in case of relations things are a little bit more difficult,
+        // type might be placed at the outer ring and not on the relation
+        // itself, we thus still need to parse the complete relation for
+        // type analysis before we can skip it.
 
-      if (progress.OutputDebug()) {
-        progress.Debug("Storing relation "+
-                       NumberToString(rawRel.GetId())+" "+
-                       rel.GetType()->GetName()+" "+
-                       name);
+        job.name=ResolveRelationName(featureName,
+                                     job.rawRelation);
+        job.success=false;
+        job.progress.SetOutputDebug(progress.OutputDebug());
+
+        r++;
       }
 
-      areaTypeCount[rel.GetType()->GetIndex()]++;
-      for (size_t i=0; i<rel.rings.size(); i++) {
-        if (rel.rings[i].ring==Area::outerRingId) {
-          areaNodeTypeCount[rel.GetType()->GetIndex()]+=rel.rings[i].nodes.size();
+      ProcessRelationJobs(parameter,
+                          typeConfig,
+                          coordDataFile,
+                          wayDataFile,
+                          relDataFile,
+                          jobs);
+
+      for (std::vector<RelationJob>::iterator job=jobs.begin();
+           job!=jobs.end();
+           ++job) {
+        job->progress.Replay(progress);
+
+        if (!job->success) {
+          continue;
         }
-      }
 
-      FileOffset fileOffset;
+        wayAreaIndexBlacklist.insert(job->blacklist.begin(),
+                                     job->blacklist.end());
 
-      if (!writer.GetPos(fileOffset)) {
-        progress.Error(std::string("Error while reading current fileOffset in file '")+
-                       writer.GetFilename()+"'");
-        return false;
-      }
+        const Area& rel=job->relation;
 
-      writer.Write(rawRel.GetId());
-      rel.Write(typeConfig,
-                writer);
+        if (progress.OutputDebug()) {
+          progress.Debug("Storing relation "+
+                         NumberToString(job->rawRelation.GetId())+" "+
+                         rel.GetType()->GetName()+" "+
+                         job->name);
+        }
+
+        areaTypeCount[rel.GetType()->GetIndex()]++;
+        for (size_t i=0; i<rel.rings.size(); i++) {
+          if (rel.rings[i].ring==Area::outerRingId) {
+            areaNodeTypeCount[rel.GetType()->GetIndex()]+=rel.rings[i].nodes.size();
+          }
+        }
+
+        FileOffset fileOffset;
 
-      writtenRelationCount++;
+        if (!writer.GetPos(fileOffset)) {
+          progress.Error(std::string("Error while reading current fileOffset in file '")+
+                         writer.GetFilename()+"'");
+          return false;
+        }
+
+        writer.Write(job->rawRelation.GetId());
+        rel.Write(typeConfig,
+                  writer);
+
+        writtenRelationCount++;
+      }
     }
 
     progress.Info(NumberToString(rawRelationCount)+" relations read"+
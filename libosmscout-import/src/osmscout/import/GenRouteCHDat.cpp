@@ -0,0 +1,595 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenRouteCHDat.h>
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+#include <osmscout/RoutingService.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/IndexedHeap.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  /**
+   * Maximum number of nodes settled by a witness search. If no witness is
+   * found within this limit, a (possibly superfluous) shortcut is added.
+   */
+  static const size_t maxWitnessSettledNodes=500;
+
+  RouteCHDataGenerator::RouteCHDataGenerator()
+  {
+    // no code
+  }
+
+  std::string RouteCHDataGenerator::GetDescription() const
+  {
+    return "Generate contraction hierarchy for car routing graph";
+  }
+
+  bool RouteCHDataGenerator::GetFiles(const ImportParameter& parameter,
+                                      std::list<std::string>& inputFiles,
+                                      std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         RoutingService::FILENAME_CAR_DAT));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_CAR_CH_DAT));
+
+    return true;
+  }
+
+  /**
+   * Return the speed table used for the contraction hierarchy, if no speeds
+   * are given by the import parameter. The table matches the table used by
+   * the routing demos.
+   */
+  void RouteCHDataGenerator::GetDefaultCarSpeedTable(std::map<std::string,double>& map)
+  {
+    map["highway_motorway"]=110.0;
+    map["highway_motorway_trunk"]=100.0;
+    map["highway_motorway_primary"]=70.0;
+    map["highway_motorway_link"]=60.0;
+    map["highway_motorway_junction"]=60.0;
+    map["highway_trunk"]=100.0;
+    map["highway_trunk_link"]=60.0;
+    map["highway_primary"]=70.0;
+    map["highway_primary_link"]=60.0;
+    map["highway_secondary"]=60.0;
+    map["highway_secondary_link"]=50.0;
+    map["highway_tertiary_link"]=55.0;
+    map["highway_tertiary"]=55.0;
+    map["highway_unclassified"]=50.0;
+    map["highway_road"]=50.0;
+    map["highway_residential"]=40.0;
+    map["highway_roundabout"]=40.0;
+    map["highway_living_street"]=10.0;
+    map["highway_service"]=30.0;
+  }
+
+  /**
+   * Read the car routing graph. All paths usable by the given profile
+   * become edges with their costs in milliseconds.
+   */
+  bool RouteCHDataGenerator::ReadRouteGraph(const TypeConfig& typeConfig,
+                                            const ImportParameter& parameter,
+                                            Progress& progress,
+                                            const AbstractRoutingProfile& profile,
+                                            std::vector<FileOffset>& nodeOffsets,
+                                            std::vector<std::vector<RouteNode::Exclude> >& excludes)
+  {
+    FileScanner             scanner;
+    uint32_t                nodeCount;
+    std::vector<FileOffset> targetOffsets;
+
+    progress.Info("Reading routing graph");
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      RoutingService::FILENAME_CAR_DAT),
+                      FileScanner::Sequential,
+                      true)) {
+      progress.Error("Cannot open '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    nodes.resize(nodeCount);
+    nodeOffsets.resize(nodeCount);
+    excludes.resize(nodeCount);
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      progress.SetProgress(n,nodeCount);
+
+      RouteNode routeNode;
+
+      if (!routeNode.Read(typeConfig,
+                          scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(nodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      nodeOffsets[n]=routeNode.GetFileOffset();
+      excludes[n]=routeNode.excludes;
+
+      nodes[n].core=!routeNode.excludes.empty();
+      nodes[n].contracted=false;
+      nodes[n].contractedNeighbours=0;
+
+      for (size_t i=0; i<routeNode.paths.size(); i++) {
+        const RouteNode::Path& path=routeNode.paths[i];
+
+        if (!path.HasAccess() ||
+            !profile.CanUse(routeNode,i) ||
+            path.offset==routeNode.GetFileOffset()) {
+          continue;
+        }
+
+        Edge edge;
+
+        edge.source=n;
+        edge.target=ContractionHierarchy::noNode;
+        edge.costs=(uint32_t)floor(profile.GetCosts(routeNode,i)*3600000.0+0.5);
+        edge.firstEdge=ContractionHierarchy::noEdge;
+        edge.secondEdge=ContractionHierarchy::noEdge;
+        edge.pathIndex=(uint32_t)i;
+        edge.object=routeNode.objects[path.objectIndex];
+
+        edges.push_back(edge);
+        targetOffsets.push_back(path.offset);
+      }
+    }
+
+    if (!scanner.Close()) {
+      progress.Error(std::string("Cannot close file '")+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    // Route nodes are written in the order of their file offset
+    for (size_t e=0; e<edges.size(); e++) {
+      std::vector<FileOffset>::const_iterator target=std::lower_bound(nodeOffsets.begin(),
+                                                                      nodeOffsets.end(),
+                                                                      targetOffsets[e]);
+
+      if (target==nodeOffsets.end() ||
+          *target!=targetOffsets[e]) {
+        progress.Error(std::string("Cannot resolve route node at offset ")+
+                       NumberToString(targetOffsets[e]));
+        return false;
+      }
+
+      edges[e].target=(uint32_t)(target-nodeOffsets.begin());
+
+      nodes[edges[e].source].outEdges.push_back((uint32_t)e);
+      nodes[edges[e].target].inEdges.push_back((uint32_t)e);
+    }
+
+    return true;
+  }
+
+  /**
+   * Dijkstra search from the given source over the not yet contracted nodes,
+   * ignoring the given node. The search stops at maxCosts or after a limited
+   * number of settled nodes. Paths through core nodes are not followed,
+   * since they could be forbidden by turn restrictions. The costs found
+   * are stored in witnessCosts.
+   */
+  void RouteCHDataGenerator::WitnessSearch(uint32_t source,
+                                           uint32_t excludedNode,
+                                           uint32_t maxCosts)
+  {
+    for (std::vector<uint32_t>::const_iterator node=witnessTouched.begin();
+         node!=witnessTouched.end();
+         ++node) {
+      witnessCosts[*node]=std::numeric_limits<uint32_t>::max();
+    }
+
+    witnessTouched.clear();
+
+    std::priority_queue<WitnessEntry> openList;
+    WitnessEntry                      entry;
+    size_t                            settled=0;
+
+    witnessCosts[source]=0;
+    witnessTouched.push_back(source);
+
+    entry.costs=0;
+    entry.node=source;
+
+    openList.push(entry);
+
+    while (!openList.empty() &&
+           settled<maxWitnessSettledNodes) {
+      WitnessEntry current=openList.top();
+
+      openList.pop();
+
+      if (current.costs>witnessCosts[current.node]) {
+        // Outdated entry
+        continue;
+      }
+
+      if (current.costs>maxCosts) {
+        break;
+      }
+
+      settled++;
+
+      if (current.node!=source &&
+          nodes[current.node].core) {
+        continue;
+      }
+
+      const std::vector<uint32_t>& outEdges=nodes[current.node].outEdges;
+
+      for (std::vector<uint32_t>::const_iterator e=outEdges.begin();
+           e!=outEdges.end();
+           ++e) {
+        const Edge& edge=edges[*e];
+
+        if (edge.target==excludedNode) {
+          continue;
+        }
+
+        uint32_t costs=current.costs+edge.costs;
+
+        if (costs<witnessCosts[edge.target]) {
+          if (witnessCosts[edge.target]==std::numeric_limits<uint32_t>::max()) {
+            witnessTouched.push_back(edge.target);
+          }
+
+          witnessCosts[edge.target]=costs;
+
+          entry.costs=costs;
+          entry.node=edge.target;
+
+          openList.push(entry);
+        }
+      }
+    }
+  }
+
+  /**
+   * Return the shortcuts needed, if the given node gets contracted. For
+   * each pair of incoming and outgoing edge a shortcut is needed, if there
+   * is no witness path of the same or lower costs not using the node.
+   * Shortcuts starting or ending at a core node are always kept per
+   * outgoing path and incoming object, since turn restrictions are checked
+   * against them.
+   */
+  void RouteCHDataGenerator::FindShortcuts(uint32_t node,
+                                           std::vector<Shortcut>& shortcuts)
+  {
+    const std::vector<uint32_t>& inEdges=nodes[node].inEdges;
+    const std::vector<uint32_t>& outEdges=nodes[node].outEdges;
+
+    shortcuts.clear();
+
+    for (std::vector<uint32_t>::const_iterator in=inEdges.begin();
+         in!=inEdges.end();
+         ++in) {
+      uint32_t source=edges[*in].source;
+      uint32_t maxCosts=0;
+      bool     searchWitness=!nodes[source].core;
+
+      for (std::vector<uint32_t>::const_iterator out=outEdges.begin();
+           out!=outEdges.end();
+           ++out) {
+        if (edges[*out].target!=source) {
+          maxCosts=std::max(maxCosts,edges[*in].costs+edges[*out].costs);
+        }
+      }
+
+      if (searchWitness) {
+        WitnessSearch(source,
+                      node,
+                      maxCosts);
+      }
+
+      for (std::vector<uint32_t>::const_iterator out=outEdges.begin();
+           out!=outEdges.end();
+           ++out) {
+        uint32_t target=edges[*out].target;
+
+        if (target==source) {
+          continue;
+        }
+
+        uint32_t costs=edges[*in].costs+edges[*out].costs;
+
+        if (searchWitness &&
+            !nodes[target].core &&
+            witnessCosts[target]<=costs) {
+          continue;
+        }
+
+        bool merged=false;
+
+        for (std::vector<Shortcut>::iterator shortcut=shortcuts.begin();
+             shortcut!=shortcuts.end();
+             ++shortcut) {
+          if (edges[shortcut->firstEdge].source!=source ||
+              edges[shortcut->secondEdge].target!=target) {
+            continue;
+          }
+
+          if (nodes[source].core &&
+              edges[shortcut->firstEdge].pathIndex!=edges[*in].pathIndex) {
+            continue;
+          }
+
+          if (nodes[target].core &&
+              edges[shortcut->secondEdge].object!=edges[*out].object) {
+            continue;
+          }
+
+          if (costs<shortcut->costs) {
+            shortcut->firstEdge=*in;
+            shortcut->secondEdge=*out;
+            shortcut->costs=costs;
+          }
+
+          merged=true;
+          break;
+        }
+
+        if (!merged) {
+          Shortcut shortcut;
+
+          shortcut.firstEdge=*in;
+          shortcut.secondEdge=*out;
+          shortcut.costs=costs;
+
+          shortcuts.push_back(shortcut);
+        }
+      }
+    }
+  }
+
+  int RouteCHDataGenerator::CalculatePriority(uint32_t node)
+  {
+    std::vector<Shortcut> shortcuts;
+
+    FindShortcuts(node,
+                  shortcuts);
+
+    return (int)shortcuts.size()-
+           (int)(nodes[node].inEdges.size()+nodes[node].outEdges.size())+
+           (int)nodes[node].contractedNeighbours;
+  }
+
+  /**
+   * Contract the given node: Add the required shortcuts and remove the
+   * edges of the node from its neighbours. The neighbours of the node
+   * are returned.
+   */
+  void RouteCHDataGenerator::ContractNode(uint32_t node,
+                                          std::vector<uint32_t>& neighbours)
+  {
+    std::vector<Shortcut> shortcuts;
+
+    FindShortcuts(node,
+                  shortcuts);
+
+    for (std::vector<Shortcut>::const_iterator shortcut=shortcuts.begin();
+         shortcut!=shortcuts.end();
+         ++shortcut) {
+      Edge edge;
+
+      edge.source=edges[shortcut->firstEdge].source;
+      edge.target=edges[shortcut->secondEdge].target;
+      edge.costs=shortcut->costs;
+      edge.firstEdge=shortcut->firstEdge;
+      edge.secondEdge=shortcut->secondEdge;
+      edge.pathIndex=edges[shortcut->firstEdge].pathIndex;
+      edge.object=edges[shortcut->secondEdge].object;
+
+      edges.push_back(edge);
+
+      nodes[edge.source].outEdges.push_back((uint32_t)(edges.size()-1));
+      nodes[edge.target].inEdges.push_back((uint32_t)(edges.size()-1));
+    }
+
+    neighbours.clear();
+
+    for (std::vector<uint32_t>::const_iterator in=nodes[node].inEdges.begin();
+         in!=nodes[node].inEdges.end();
+         ++in) {
+      std::vector<uint32_t>& outEdges=nodes[edges[*in].source].outEdges;
+
+      outEdges.erase(std::remove(outEdges.begin(),outEdges.end(),*in),
+                     outEdges.end());
+
+      neighbours.push_back(edges[*in].source);
+    }
+
+    for (std::vector<uint32_t>::const_iterator out=nodes[node].outEdges.begin();
+         out!=nodes[node].outEdges.end();
+         ++out) {
+      std::vector<uint32_t>& inEdges=nodes[edges[*out].target].inEdges;
+
+      inEdges.erase(std::remove(inEdges.begin(),inEdges.end(),*out),
+                    inEdges.end());
+
+      neighbours.push_back(edges[*out].target);
+    }
+
+    std::sort(neighbours.begin(),neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(),neighbours.end()),
+                     neighbours.end());
+
+    nodes[node].inEdges.clear();
+    nodes[node].outEdges.clear();
+    nodes[node].contracted=true;
+  }
+
+  bool RouteCHDataGenerator::Import(const TypeConfigRef& typeConfig,
+                                    const ImportParameter& parameter,
+                                    Progress& progress)
+  {
+    if (!parameter.GetRouteCH()) {
+      progress.Info("Generation of contraction hierarchy is disabled, skipped");
+      return true;
+    }
+
+    std::map<std::string,double> speedMap(parameter.GetRouteCHCarSpeeds());
+    FastestPathRoutingProfile    profile(typeConfig);
+
+    if (speedMap.empty()) {
+      GetDefaultCarSpeedTable(speedMap);
+    }
+
+    profile.ParametrizeForCar(*typeConfig,
+                              speedMap,
+                              parameter.GetRouteCHCarMaxSpeed());
+
+    std::vector<FileOffset>                        nodeOffsets;
+    std::vector<std::vector<RouteNode::Exclude> > excludes;
+
+    nodes.clear();
+    edges.clear();
+
+    if (!ReadRouteGraph(*typeConfig,
+                        parameter,
+                        progress,
+                        profile,
+                        nodeOffsets,
+                        excludes)) {
+      return false;
+    }
+
+    size_t originalEdgeCount=edges.size();
+    size_t coreNodeCount=0;
+
+    witnessCosts.assign(nodes.size(),std::numeric_limits<uint32_t>::max());
+    witnessTouched.clear();
+
+    progress.SetAction("Calculating initial node priorities");
+
+    std::vector<int>                             priorities(nodes.size(),0);
+    IndexedHeap<PriorityCompare,4> queue((PriorityCompare(&priorities)));
+
+    queue.Reserve(nodes.size());
+
+    for (uint32_t n=0; n<nodes.size(); n++) {
+      progress.SetProgress(n,nodes.size());
+
+      if (nodes[n].core) {
+        coreNodeCount++;
+        continue;
+      }
+
+      priorities[n]=CalculatePriority(n);
+      queue.Push(n);
+    }
+
+    progress.SetAction("Contracting nodes");
+
+    std::vector<uint32_t> ranks(nodes.size(),0);
+    std::vector<uint32_t> neighbours;
+    uint32_t              rank=0;
+
+    while (!queue.empty()) {
+      progress.SetProgress(rank,nodes.size()-coreNodeCount);
+
+      uint32_t node=(uint32_t)queue.Top();
+
+      // Priorities of other nodes are only updated lazily, check if the
+      // node is still the one with the highest priority
+      int priority=CalculatePriority(node);
+
+      if (priority>priorities[node]) {
+        priorities[node]=priority;
+        queue.Update(node);
+
+        if (queue.Top()!=node) {
+          continue;
+        }
+      }
+
+      queue.Pop();
+
+      ContractNode(node,
+                   neighbours);
+
+      ranks[node]=rank;
+      rank++;
+
+      for (std::vector<uint32_t>::const_iterator neighbour=neighbours.begin();
+           neighbour!=neighbours.end();
+           ++neighbour) {
+        nodes[*neighbour].contractedNeighbours++;
+
+        if (queue.Contains(*neighbour)) {
+          priorities[*neighbour]++;
+          queue.Update(*neighbour);
+        }
+      }
+    }
+
+    // All core nodes share the highest rank
+    for (uint32_t n=0; n<nodes.size(); n++) {
+      if (nodes[n].core) {
+        ranks[n]=rank;
+      }
+    }
+
+    progress.Info(NumberToString(nodes.size())+" nodes, "+
+                  NumberToString(coreNodeCount)+" core nodes, "+
+                  NumberToString(originalEdgeCount)+" edges, "+
+                  NumberToString(edges.size()-originalEdgeCount)+" shortcuts");
+
+    progress.SetAction("Writing contraction hierarchy");
+
+    ContractionHierarchy hierarchy;
+
+    hierarchy.Set(profile,
+                  nodeOffsets,
+                  ranks,
+                  edges,
+                  excludes);
+
+    nodes.clear();
+    edges.clear();
+    witnessCosts.clear();
+    witnessTouched.clear();
+
+    if (!hierarchy.Store(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         RoutingService::FILENAME_CAR_CH_DAT))) {
+      progress.Error(std::string("Cannot write file '")+RoutingService::FILENAME_CAR_CH_DAT+"'");
+      return false;
+    }
+
+    return true;
+  }
+}
@@ -44,6 +44,31 @@ namespace osmscout {
     return "Generate routing graphs";
   }
 
+  bool RouteDataGenerator::GetFiles(const ImportParameter& parameter,
+                                    std::list<std::string>& inputFiles,
+                                    std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "areas.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "turnrestr.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.idmap"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_INTERSECTIONS_DAT));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_FOOT_DAT));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_BICYCLE_DAT));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_CAR_DAT));
+
+    return true;
+  }
+
   AccessFeatureValue RouteDataGenerator::GetAccess(const FeatureValueBuffer& buffer) const
   {
     AccessFeatureValue *accessValue=accessReader->GetValue(buffer);
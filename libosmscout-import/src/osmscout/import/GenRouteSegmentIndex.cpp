@@ -0,0 +1,368 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenRouteSegmentIndex.h>
+
+#include <osmscout/RoutingService.h>
+#include <osmscout/TypeFeatures.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  /**
+   * Sorts entries by the longitude of the center of their bounding box
+   */
+  template<class T>
+  struct RouteSegmentCenterLonLess
+  {
+    inline bool operator()(const T& a, const T& b) const
+    {
+      return (uint64_t)a.GetMinLon()+a.GetMaxLon()<(uint64_t)b.GetMinLon()+b.GetMaxLon();
+    }
+  };
+
+  /**
+   * Sorts entries by the latitude of the center of their bounding box
+   */
+  template<class T>
+  struct RouteSegmentCenterLatLess
+  {
+    inline bool operator()(const T& a, const T& b) const
+    {
+      return (uint64_t)a.GetMinLat()+a.GetMaxLat()<(uint64_t)b.GetMinLat()+b.GetMaxLat();
+    }
+  };
+
+  /**
+   * Sort the entries for sort-tile-recursive packing: The entries are
+   * sorted by longitude and split into vertical slices of (about) the
+   * same size. Each slice is then sorted by latitude. Afterwards each run
+   * of RouteSegmentIndex::maxNodeEntries entries forms one node.
+   */
+  template<class T>
+  static void SortTileRecursive(std::vector<T>& entries)
+  {
+    size_t nodeCount=(entries.size()+RouteSegmentIndex::maxNodeEntries-1)/RouteSegmentIndex::maxNodeEntries;
+    size_t sliceCount=(size_t)ceil(sqrt((double)nodeCount));
+    size_t sliceSize=sliceCount*RouteSegmentIndex::maxNodeEntries;
+
+    std::sort(entries.begin(),
+              entries.end(),
+              RouteSegmentCenterLonLess<T>());
+
+    for (size_t start=0; start<entries.size(); start+=sliceSize) {
+      std::sort(entries.begin()+start,
+                entries.begin()+std::min(start+sliceSize,entries.size()),
+                RouteSegmentCenterLatLess<T>());
+    }
+  }
+
+  /**
+   * Calculate the bounding box of the given entries in the format of
+   * an index node entry
+   */
+  template<class T>
+  static void GetBoundingBox(typename std::vector<T>::const_iterator begin,
+                             typename std::vector<T>::const_iterator end,
+                             uint32_t& minLat,
+                             uint32_t& minLon,
+                             uint32_t& maxLat,
+                             uint32_t& maxLon)
+  {
+    minLat=begin->GetMinLat();
+    minLon=begin->GetMinLon();
+    maxLat=begin->GetMaxLat();
+    maxLon=begin->GetMaxLon();
+
+    for (typename std::vector<T>::const_iterator entry=begin+1;
+         entry!=end;
+         ++entry) {
+      minLat=std::min(minLat,entry->GetMinLat());
+      minLon=std::min(minLon,entry->GetMinLon());
+      maxLat=std::max(maxLat,entry->GetMaxLat());
+      maxLon=std::max(maxLon,entry->GetMaxLon());
+    }
+  }
+
+  std::string RouteSegmentIndexGenerator::GetDescription() const
+  {
+    return "Generate index of routable segments";
+  }
+
+  bool RouteSegmentIndexGenerator::GetFiles(const ImportParameter& parameter,
+                                            std::list<std::string>& inputFiles,
+                                            std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_FOOT_SEGMENTS_IDX));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_BICYCLE_SEGMENTS_IDX));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          RoutingService::FILENAME_CAR_SEGMENTS_IDX));
+
+    return true;
+  }
+
+  /**
+   * Read the segments of all ways routable for the given vehicle
+   */
+  bool RouteSegmentIndexGenerator::ReadSegments(const TypeConfigRef& typeConfig,
+                                                const ImportParameter& parameter,
+                                                Progress& progress,
+                                                Vehicle vehicle,
+                                                std::vector<Segment>& segments)
+  {
+    FileScanner              scanner;
+    AccessFeatureValueReader accessReader(*typeConfig);
+    uint32_t                 wayCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "ways.dat"),
+                      FileScanner::Sequential,
+                      parameter.GetWayDataMemoryMaped())) {
+      progress.Error("Cannot open 'ways.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(wayCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    Way way;
+
+    for (uint32_t w=1; w<=wayCount; w++) {
+      progress.SetProgress(w,wayCount);
+
+      if (!way.Read(typeConfig,
+                    scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(w)+" of "+
+                       NumberToString(wayCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      AccessFeatureValue *accessValue=accessReader.GetValue(way.GetFeatureValueBuffer());
+      AccessFeatureValue access=accessValue!=NULL ? *accessValue : AccessFeatureValue(way.GetType()->GetDefaultAccess());
+
+      if (!access.CanRoute(vehicle)) {
+        continue;
+      }
+
+      for (size_t n=1; n<way.nodes.size(); n++) {
+        Segment segment;
+
+        segment.wayOffset=way.GetFileOffset();
+        segment.segmentIndex=(uint32_t)(n-1);
+        segment.fromLat=(uint32_t)floor((way.nodes[n-1].GetLat()+90.0)*latConversionFactor+0.5);
+        segment.fromLon=(uint32_t)floor((way.nodes[n-1].GetLon()+180.0)*lonConversionFactor+0.5);
+        segment.toLat=(uint32_t)floor((way.nodes[n].GetLat()+90.0)*latConversionFactor+0.5);
+        segment.toLon=(uint32_t)floor((way.nodes[n].GetLon()+180.0)*lonConversionFactor+0.5);
+
+        segments.push_back(segment);
+      }
+    }
+
+    return scanner.Close();
+  }
+
+  /**
+   * Write the leaf nodes holding the segments and return the written nodes
+   */
+  bool RouteSegmentIndexGenerator::WriteLeaves(FileWriter& writer,
+                                               std::vector<Segment>& segments,
+                                               std::vector<NodeEntry>& nodes)
+  {
+    SortTileRecursive(segments);
+
+    for (size_t start=0; start<segments.size(); start+=RouteSegmentIndex::maxNodeEntries) {
+      size_t    end=std::min(start+RouteSegmentIndex::maxNodeEntries,segments.size());
+      NodeEntry node;
+
+      if (!writer.GetPos(node.offset)) {
+        return false;
+      }
+
+      GetBoundingBox<Segment>(segments.begin()+start,
+                              segments.begin()+end,
+                              node.minLat,
+                              node.minLon,
+                              node.maxLat,
+                              node.maxLon);
+
+      writer.Write((uint8_t)1);
+      writer.Write((uint8_t)(end-start));
+
+      for (size_t s=start; s<end; s++) {
+        writer.WriteFileOffset(segments[s].wayOffset);
+        writer.WriteNumber(segments[s].segmentIndex);
+        writer.Write(segments[s].fromLat);
+        writer.Write(segments[s].fromLon);
+        writer.Write(segments[s].toLat);
+        writer.Write(segments[s].toLon);
+      }
+
+      nodes.push_back(node);
+    }
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Write the next level of inner nodes for the given children and return
+   * the written nodes
+   */
+  bool RouteSegmentIndexGenerator::WriteInnerNodes(FileWriter& writer,
+                                                   std::vector<NodeEntry>& children,
+                                                   std::vector<NodeEntry>& nodes)
+  {
+    SortTileRecursive(children);
+
+    for (size_t start=0; start<children.size(); start+=RouteSegmentIndex::maxNodeEntries) {
+      size_t    end=std::min(start+RouteSegmentIndex::maxNodeEntries,children.size());
+      NodeEntry node;
+
+      if (!writer.GetPos(node.offset)) {
+        return false;
+      }
+
+      GetBoundingBox<NodeEntry>(children.begin()+start,
+                                children.begin()+end,
+                                node.minLat,
+                                node.minLon,
+                                node.maxLat,
+                                node.maxLon);
+
+      writer.Write((uint8_t)0);
+      writer.Write((uint8_t)(end-start));
+
+      for (size_t c=start; c<end; c++) {
+        writer.Write(children[c].minLat);
+        writer.Write(children[c].minLon);
+        writer.Write(children[c].maxLat);
+        writer.Write(children[c].maxLon);
+        writer.WriteFileOffset(children[c].offset);
+      }
+
+      nodes.push_back(node);
+    }
+
+    return !writer.HasError();
+  }
+
+  bool RouteSegmentIndexGenerator::WriteIndex(const ImportParameter& parameter,
+                                              Progress& progress,
+                                              Vehicle vehicle,
+                                              std::vector<Segment>& segments)
+  {
+    std::string            filename=RoutingService::GetSegmentIndexFilename(vehicle);
+    FileWriter             writer;
+    std::vector<NodeEntry> nodes;
+    FileOffset             rootOffset;
+
+    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     filename))) {
+      progress.Error("Cannot create '"+filename+"'");
+      return false;
+    }
+
+    writer.WriteFileOffset(0);
+    writer.Write((uint32_t)segments.size());
+
+    if (segments.empty()) {
+      // Empty root node
+      writer.GetPos(rootOffset);
+      writer.Write((uint8_t)1);
+      writer.Write((uint8_t)0);
+    }
+    else {
+      if (!WriteLeaves(writer,
+                       segments,
+                       nodes)) {
+        progress.Error("Error while writing '"+filename+"'");
+        return false;
+      }
+
+      while (nodes.size()>1) {
+        std::vector<NodeEntry> parents;
+
+        if (!WriteInnerNodes(writer,
+                             nodes,
+                             parents)) {
+          progress.Error("Error while writing '"+filename+"'");
+          return false;
+        }
+
+        nodes.swap(parents);
+      }
+
+      rootOffset=nodes.front().offset;
+    }
+
+    writer.SetPos(0);
+    writer.WriteFileOffset(rootOffset);
+
+    return !writer.HasError() && writer.Close();
+  }
+
+  bool RouteSegmentIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                          const ImportParameter& parameter,
+                                          Progress& progress)
+  {
+    Vehicle vehicles[]={vehicleFoot,vehicleBicycle,vehicleCar};
+
+    for (size_t v=0; v<sizeof(vehicles)/sizeof(vehicles[0]); v++) {
+      std::vector<Segment> segments;
+      std::string          filename=RoutingService::GetSegmentIndexFilename(vehicles[v]);
+
+      progress.SetAction("Generating '"+filename+"'");
+
+      if (!ReadSegments(typeConfig,
+                        parameter,
+                        progress,
+                        vehicles[v],
+                        segments)) {
+        return false;
+      }
+
+      progress.Info(NumberToString(segments.size())+" segments");
+
+      if (!WriteIndex(parameter,
+                      progress,
+                      vehicles[v],
+                      segments)) {
+        progress.Error("Cannot write file '"+filename+"'");
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
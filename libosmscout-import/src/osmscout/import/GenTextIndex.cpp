@@ -47,6 +47,29 @@ namespace osmscout
     return "Generate text data files 'text(poi,loc,region,other).dat'";
   }
 
+  bool TextIndexGenerator::GetFiles(const ImportParameter& parameter,
+                                    std::list<std::string>& inputFiles,
+                                    std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "nodes.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "areas.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "textpoi.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "textloc.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "textregion.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "textother.dat"));
+
+    return true;
+  }
+
 
   bool TextIndexGenerator::Import(const TypeConfigRef& typeConfig,
                                   const ImportParameter &parameter,
@@ -19,6 +19,7 @@
 
 #include <osmscout/import/GenTypeDat.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/String.h>
 
 namespace osmscout {
@@ -28,6 +29,16 @@ namespace osmscout {
     return "Generate 'types.dat'";
   }
 
+  bool TypeDataGenerator::GetFiles(const ImportParameter& parameter,
+                                   std::list<std::string>& /*inputFiles*/,
+                                   std::list<std::string>& outputFiles) const
+  {
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "types.dat"));
+
+    return true;
+  }
+
   bool TypeDataGenerator::Import(const TypeConfigRef& typeConfig,
                                  const ImportParameter& parameter,
                                  Progress& progress)
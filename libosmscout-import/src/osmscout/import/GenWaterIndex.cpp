@@ -170,7 +170,7 @@ namespace osmscout {
       return false;
     }
 
-    std::set<OSMId> nodeIds;
+    std::vector<OSMId> nodeIds;
 
     for (std::list<RawCoastlineRef>::const_iterator c=rawCoastlines.begin();
          c!=rawCoastlines.end();
@@ -178,7 +178,7 @@ namespace osmscout {
       RawCoastlineRef coastline(*c);
 
       for (size_t n=0; n<coastline->GetNodeCount(); n++) {
-        nodeIds.insert(coastline->GetNodeId(n));
+        nodeIds.push_back(coastline->GetNodeId(n));
       }
     }
 
@@ -936,6 +936,15 @@ namespace osmscout {
     }
   }
 
+  void WaterIndexGenerator::GetCells(const Level& level,
+                                     const std::vector<CompactGeoCoord>& points,
+                                     std::set<Pixel>& cellIntersections)
+  {
+    for (size_t p=0; p<points.size()-1; p++) {
+      GetCells(level,points[p].GetCoord(),points[p+1].GetCoord(),cellIntersections);
+    }
+  }
+
   void WaterIndexGenerator::GetCellIntersections(const Level& level,
                                                  const std::vector<GeoCoord>& points,
                                                  size_t coastline,
@@ -1635,6 +1644,25 @@ namespace osmscout {
     return "Generate 'water.idx'";
   }
 
+  bool WaterIndexGenerator::GetFiles(const ImportParameter& parameter,
+                                     std::list<std::string>& inputFiles,
+                                     std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "bounding.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "coord.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawcoastline.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "water.idx"));
+
+    return true;
+  }
+
   bool WaterIndexGenerator::Import(const TypeConfigRef& typeConfig,
                                    const ImportParameter& parameter,
                                    Progress& progress)
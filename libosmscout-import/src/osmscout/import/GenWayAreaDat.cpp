@@ -40,6 +40,23 @@ namespace osmscout {
     return "Generate 'wayarea.tmp'";
   }
 
+  bool WayAreaDataGenerator::GetFiles(const ImportParameter& parameter,
+                                      std::list<std::string>& inputFiles,
+                                      std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "coord.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawways.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "wayareablack.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "wayarea.tmp"));
+
+    return true;
+  }
+
   bool WayAreaDataGenerator::ReadWayBlacklist(const ImportParameter& parameter,
                                               Progress& progress,
                                               BlacklistSet& wayBlacklist)
@@ -316,13 +333,9 @@ namespace osmscout {
 
       collectedWaysCount++;
 
-      std::set<OSMId>               nodeIds;
+      std::vector<OSMId>            nodeIds(way->GetNodes());
       CoordDataFile::CoordResultMap coordsMap;
 
-      for (size_t n=0; n<way->GetNodeCount(); n++) {
-        nodeIds.insert(way->GetNodeId(n));
-      }
-
       if (!coordDataFile.Get(nodeIds,coordsMap)) {
         std::cerr << "Cannot read nodes!" << std::endl;
         return false;
@@ -429,19 +442,19 @@ namespace osmscout {
 
       progress.SetAction("Collecting node ids");
 
-      std::set<OSMId>               nodeIds;
+      std::vector<OSMId>            nodeIds;
       CoordDataFile::CoordResultMap coordsMap;
 
       for (size_t type=0; type<areasByType.size(); type++) {
         for (const auto &rawWay : areasByType[type]) {
-          for (size_t n=0; n<rawWay->GetNodeCount(); n++) {
-            nodeIds.insert(rawWay->GetNodeId(n));
-          }
+          nodeIds.insert(nodeIds.end(),
+                         rawWay->GetNodes().begin(),
+                         rawWay->GetNodes().end());
         }
       }
 
       if (!nodeIds.empty()) {
-        progress.SetAction("Loading "+NumberToString(nodeIds.size())+" nodes");
+        progress.SetAction("Loading nodes");
         if (!coordDataFile.Get(nodeIds,coordsMap)) {
           std::cerr << "Cannot read nodes!" << std::endl;
           return false;
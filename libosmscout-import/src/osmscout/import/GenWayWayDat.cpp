@@ -20,6 +20,13 @@
 #include <osmscout/import/GenWayWayDat.h>
 
 #include <algorithm>
+#include <functional>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  #include <thread>
+#endif
 
 #include <osmscout/DataFile.h>
 
@@ -46,6 +53,25 @@ namespace osmscout {
     return "Generate 'wayway.tmp'";
   }
 
+  bool WayWayDataGenerator::GetFiles(const ImportParameter& parameter,
+                                     std::list<std::string>& inputFiles,
+                                     std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "coord.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawways.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "rawturnrestr.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "wayway.tmp"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "turnrestr.dat"));
+
+    return true;
+  }
+
   bool WayWayDataGenerator::ReadTurnRestrictions(const ImportParameter& parameter,
                                                  Progress& progress,
                                                  std::multimap<OSMId,TurnRestrictionRef>& restrictions)
@@ -263,41 +289,48 @@ namespace osmscout {
     return false;
   }
 
-  bool WayWayDataGenerator::MergeWays(Progress& progress,
+  /**
+   * Merge ways of the same type that share an end node and have the same
+   * attributes. The result (ways and their order) only depends on the given
+   * ways, not on the thread the merge is executed in.
+   */
+  void WayWayDataGenerator::MergeWays(Progress& progress,
                                       std::list<RawWayRef>& ways,
-                                      std::multimap<OSMId,TurnRestrictionRef>& restrictions)
+                                      const std::multimap<OSMId,TurnRestrictionRef>& restrictions) const
   {
-    WaysByNodeMap waysByNode;
+    std::vector<RawWayRef> sortedWays(ways.begin(),ways.end());
+    std::vector<bool>      merged(sortedWays.size(),false);
+    WaysByNodeMap          waysByNode;
 
     // Sort by decreasing node count to assure that we merge longest ways first
-    ways.sort(WayByNodeCountSorter);
+    std::stable_sort(sortedWays.begin(),
+                     sortedWays.end(),
+                     WayByNodeCountSorter);
+
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    waysByNode.reserve(sortedWays.size());
+#endif
 
     // Index by first node id (if way is not circular)
-    for (WayListPtr w=ways.begin();
-        w!=ways.end();
-        ++w) {
-      RawWayRef way(*w);
-      OSMId     firstNodeId=way->GetFirstNodeId();
-      OSMId     lastNodeId=way->GetLastNodeId();
+    for (size_t w=0; w<sortedWays.size(); w++) {
+      OSMId firstNodeId=sortedWays[w]->GetFirstNodeId();
+      OSMId lastNodeId=sortedWays[w]->GetLastNodeId();
 
       if (firstNodeId!=lastNodeId) {
         waysByNode[firstNodeId].push_back(w);
       }
     }
 
-    // Variables for monitoring progress
-    SilentProgress silentProgress;
-    size_t         currentWay;
-    size_t         wayCount=ways.size();
+    for (size_t w=0; w<sortedWays.size(); w++) {
+      progress.SetProgress(w+1,sortedWays.size());
 
-    currentWay=1;
-    for (auto &way : ways) {
-      OSMId lastNodeId=way->GetLastNodeId();
-
-      progress.SetProgress(currentWay,wayCount);
-
-      currentWay++;
+      // Way was already appended to another way
+      if (merged[w]) {
+        continue;
+      }
 
+      RawWayRef               way(sortedWays[w]);
+      OSMId                   lastNodeId=way->GetLastNodeId();
       WaysByNodeMap::iterator lastNodeCandidate=waysByNode.find(lastNodeId);
 
       // Way is circular (see above) and/or already closed
@@ -313,13 +346,16 @@ namespace osmscout {
         continue;
       }
 
+      // Nodes of the way including all appended candidates
+      std::vector<OSMId> nodes;
+
       while (lastNodeCandidate!=waysByNode.end()) {
         bool hasMerged=false;
 
-        for (WayListPtrList::iterator c=lastNodeCandidate->second.begin();
+        for (std::vector<size_t>::iterator c=lastNodeCandidate->second.begin();
              c!=lastNodeCandidate->second.end();
              ++c) {
-          RawWayRef candidate(*(*c));
+          const RawWayRef& candidate=sortedWays[*c];
 
           // Can happen if we would close a way (something like A => B => A)
           if (candidate->GetId()==way->GetId()) {
@@ -344,24 +380,20 @@ namespace osmscout {
           // Append candidate nodes
           //
 
-          std::vector<OSMId> nodes(way->GetNodes());
-
-          nodes.reserve(nodes.size()+candidate->GetNodeCount()-1);
-
-          for (size_t i=1; i<candidate->GetNodeCount(); i++) {
-            nodes.push_back(candidate->GetNodeId(i));
+          if (nodes.empty()) {
+            nodes=way->GetNodes();
           }
 
-          way->SetNodes(nodes);
+          nodes.insert(nodes.end(),
+                       candidate->GetNodes().begin()+1,
+                       candidate->GetNodes().end());
 
           //
           // Cleanup
           //
 
-          WaysByNodeMap::iterator otherEntry;
-
-          // Erase the matched way from the list of ways to process
-          ways.erase(*c);
+          // Mark the matched way, so that it is not processed and written
+          merged[*c]=true;
 
           // Erase the matched way from the map of ways (entry via the matched node)
           lastNodeCandidate->second.erase(c);
@@ -377,7 +409,7 @@ namespace osmscout {
 
         // If we have merged a way search for the new candidates
         if (hasMerged) {
-          lastNodeId=way->GetLastNodeId();
+          lastNodeId=nodes.back();
 
           lastNodeCandidate=waysByNode.find(lastNodeId);
         }
@@ -385,9 +417,139 @@ namespace osmscout {
           lastNodeCandidate=waysByNode.end();
         }
       }
+
+      // The way must be complete before it can get appended to a following way
+      if (!nodes.empty()) {
+        way->SetNodes(nodes);
+      }
     }
 
-    return true;
+    ways.clear();
+
+    for (size_t w=0; w<sortedWays.size(); w++) {
+      if (!merged[w]) {
+        ways.push_back(sortedWays[w]);
+      }
+    }
+  }
+
+  /**
+   * Worker for MergeWaysByType(): Take the next type not yet merged until all
+   * types are processed. The progress of merging the ways of a type is reported
+   * to wayProgress, the number of types merged so far to typeProgress.
+   */
+  void WayWayDataGenerator::MergeWaysOfTypes(Progress& wayProgress,
+                                             Progress& typeProgress,
+                                             std::vector<std::list<RawWayRef> >& waysByType,
+                                             const std::vector<size_t>& types,
+                                             size_t& nextType,
+                                             size_t& mergedTypes,
+                                             Mutex& mutex,
+                                             const std::multimap<OSMId,TurnRestrictionRef>& restrictions) const
+  {
+    while (true) {
+      size_t type;
+
+      {
+        MutexLocker locker(mutex);
+
+        if (nextType>=types.size()) {
+          return;
+        }
+
+        type=types[nextType];
+        nextType++;
+      }
+
+      MergeWays(wayProgress,
+                waysByType[type],
+                restrictions);
+
+      MutexLocker locker(mutex);
+
+      mergedTypes++;
+      typeProgress.SetProgress(mergedTypes,types.size());
+    }
+  }
+
+  /**
+   * Merge the ways of all types. Types are independent of each other, so if more
+   * than one thread is configured, they are merged in parallel. Every thread takes
+   * the next type not yet merged, starting with the types with the most ways,
+   * so that the small types fill the gaps at the end. In this case progress is
+   * reported per merged type instead of per way.
+   */
+  void WayWayDataGenerator::MergeWaysByType(const ImportParameter& parameter,
+                                            Progress& progress,
+                                            std::vector<std::list<RawWayRef> >& waysByType,
+                                            const std::vector<size_t>& wayCounts,
+                                            const std::multimap<OSMId,TurnRestrictionRef>& restrictions) const
+  {
+    std::vector<std::pair<size_t,size_t> > typesByWayCount;
+
+    for (size_t type=0; type<waysByType.size(); type++) {
+      if (wayCounts[type]>0) {
+        typesByWayCount.push_back(std::make_pair(wayCounts[type],type));
+      }
+    }
+
+    std::sort(typesByWayCount.begin(),
+              typesByWayCount.end(),
+              std::greater<std::pair<size_t,size_t> >());
+
+    std::vector<size_t> types;
+    size_t              nextType=0;
+    size_t              mergedTypes=0;
+    Mutex               mutex;
+    SilentProgress      silentProgress;
+
+    types.reserve(typesByWayCount.size());
+
+    for (size_t i=0; i<typesByWayCount.size(); i++) {
+      types.push_back(typesByWayCount[i].second);
+    }
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    size_t threadCount=std::min(parameter.GetNumberOfThreads(),
+                                types.size());
+
+    if (threadCount>1) {
+      std::vector<std::thread> threads;
+
+      for (size_t t=0; t<threadCount; t++) {
+        threads.push_back(std::thread(&WayWayDataGenerator::MergeWaysOfTypes,
+                                      this,
+                                      std::ref(silentProgress),
+                                      std::ref(progress),
+                                      std::ref(waysByType),
+                                      std::cref(types),
+                                      std::ref(nextType),
+                                      std::ref(mergedTypes),
+                                      std::ref(mutex),
+                                      std::cref(restrictions)));
+      }
+
+      for (std::vector<std::thread>::iterator thread=threads.begin();
+           thread!=threads.end();
+           ++thread) {
+        thread->join();
+      }
+
+      progress.Info("Merged ways of "+NumberToString(mergedTypes)+" types using "+
+                    NumberToString(threadCount)+" threads");
+
+      return;
+    }
+#endif
+
+    MergeWaysOfTypes(progress,
+                     silentProgress,
+                     waysByType,
+                     types,
+                     nextType,
+                     mergedTypes,
+                     mutex,
+                     restrictions);
   }
 
   bool WayWayDataGenerator::WriteWay(Progress& progress,
@@ -525,21 +687,23 @@ namespace osmscout {
       // TODO: only print it, if there is something to merge at all
       progress.SetAction("Merging ways");
 
-#pragma omp parallel for
-      for (size_t typeIdx=0; typeIdx<typeConfig->GetTypeCount(); typeIdx++) {
-        size_t originalWayCount=waysByType[typeIdx].size();
+      std::vector<size_t> wayCounts(waysByType.size());
 
-        if (originalWayCount>0) {
-          MergeWays(progress,
-                    waysByType[typeIdx],
-                    restrictions);
+      for (size_t type=0; type<waysByType.size(); type++) {
+        wayCounts[type]=waysByType[type].size();
+      }
 
-#pragma omp critical
-          if (waysByType[typeIdx].size()<originalWayCount) {
-            progress.Info("Reduced ways of '"+typeConfig->GetTypeInfo(typeIdx)->GetName()+"' from "+
-                          NumberToString(originalWayCount)+" to "+NumberToString(waysByType[typeIdx].size())+ " way(s)");
-            mergeCount+=originalWayCount-waysByType[typeIdx].size();
-          }
+      MergeWaysByType(parameter,
+                      progress,
+                      waysByType,
+                      wayCounts,
+                      restrictions);
+
+      for (size_t type=0; type<waysByType.size(); type++) {
+        if (waysByType[type].size()<wayCounts[type]) {
+          progress.Info("Reduced ways of '"+typeConfig->GetTypeInfo(type)->GetName()+"' from "+
+                        NumberToString(wayCounts[type])+" to "+NumberToString(waysByType[type].size())+ " way(s)");
+          mergeCount+=wayCounts[type]-waysByType[type].size();
         }
       }
 
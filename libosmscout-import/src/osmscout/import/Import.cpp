@@ -20,6 +20,16 @@
 #include <osmscout/import/Import.h>
 
 #include <iostream>
+#include <set>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 #include <osmscout/Types.h>
 
@@ -65,6 +75,8 @@
 
 // Routing
 #include <osmscout/import/GenRouteDat.h>
+#include <osmscout/import/GenRouteCHDat.h>
+#include <osmscout/import/GenRouteSegmentIndex.h>
 
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
 #include <osmscout/import/GenTextIndex.h>
@@ -77,21 +89,25 @@ namespace osmscout {
 
   static const size_t defaultStartStep=1;
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-  static const size_t defaultEndStep=27;
+  static const size_t defaultEndStep=28;
 #else
-  static const size_t defaultEndStep=26;
+  static const size_t defaultEndStep=27;
 #endif
 
   ImportParameter::ImportParameter()
    : typefile("map.ost"),
      startStep(defaultStartStep),
      endStep(defaultEndStep),
+     numberOfThreads(1),
+     parallelSteps(1),
      strictAreas(false),
      sortObjects(true),
      sortBlockSize(40000000),
+     sortExternal(false),
      sortTileMag(13),
      numericIndexPageSize(4096),
      coordDataMemoryMaped(false),
+     coordDataDense(false),
      rawNodeDataMemoryMaped(false),
      rawNodeDataCacheSize(10000),
      rawWayIndexMemoryMaped(true),
@@ -121,6 +137,8 @@ namespace osmscout {
      optimizationCellSizeMax(255),
      optimizationWayMethod(TransPolygon::quality),
      routeNodeBlockSize(500000),
+     routeCH(false),
+     routeCHCarMaxSpeed(160.0),
      assumeLand(true)
   {
     // no code
@@ -151,6 +169,16 @@ namespace osmscout {
     return endStep;
   }
 
+  size_t ImportParameter::GetNumberOfThreads() const
+  {
+    return numberOfThreads;
+  }
+
+  size_t ImportParameter::GetParallelSteps() const
+  {
+    return parallelSteps;
+  }
+
   bool ImportParameter::GetStrictAreas() const
   {
     return strictAreas;
@@ -166,6 +194,11 @@ namespace osmscout {
     return sortBlockSize;
   }
 
+  bool ImportParameter::GetSortExternal() const
+  {
+    return sortExternal;
+  }
+
   size_t ImportParameter::GetSortTileMag() const
   {
     return sortTileMag;
@@ -181,6 +214,11 @@ namespace osmscout {
     return coordDataMemoryMaped;
   }
 
+  bool ImportParameter::GetCoordDataDense() const
+  {
+    return coordDataDense;
+  }
+
   bool ImportParameter::GetRawNodeDataMemoryMaped() const
   {
     return rawNodeDataMemoryMaped;
@@ -326,6 +364,21 @@ namespace osmscout {
     return routeNodeBlockSize;
   }
 
+  bool ImportParameter::GetRouteCH() const
+  {
+    return routeCH;
+  }
+
+  const std::map<std::string,double>& ImportParameter::GetRouteCHCarSpeeds() const
+  {
+    return routeCHCarSpeeds;
+  }
+
+  double ImportParameter::GetRouteCHCarMaxSpeed() const
+  {
+    return routeCHCarMaxSpeed;
+  }
+
   bool ImportParameter::GetAssumeLand() const
   {
     return assumeLand;
@@ -358,6 +411,16 @@ namespace osmscout {
     this->endStep=endStep;
   }
 
+  void ImportParameter::SetNumberOfThreads(size_t numberOfThreads)
+  {
+    this->numberOfThreads=numberOfThreads;
+  }
+
+  void ImportParameter::SetParallelSteps(size_t parallelSteps)
+  {
+    this->parallelSteps=parallelSteps;
+  }
+
   void ImportParameter::SetStrictAreas(bool strictAreas)
   {
     this->strictAreas=strictAreas;
@@ -373,6 +436,11 @@ namespace osmscout {
     this->sortBlockSize=sortBlockSize;
   }
 
+  void ImportParameter::SetSortExternal(bool sortExternal)
+  {
+    this->sortExternal=sortExternal;
+  }
+
   void ImportParameter::SetSortTileMag(size_t sortTileMag)
   {
     this->sortTileMag=sortTileMag;
@@ -388,6 +456,11 @@ namespace osmscout {
     this->coordDataMemoryMaped=memoryMaped;
   }
 
+  void ImportParameter::SetCoordDataDense(bool dense)
+  {
+    this->coordDataDense=dense;
+  }
+
   void ImportParameter::SetRawNodeDataMemoryMaped(bool memoryMaped)
   {
     this->rawNodeDataMemoryMaped=memoryMaped;
@@ -536,6 +609,28 @@ namespace osmscout {
     this->routeNodeBlockSize=blockSize;
   }
 
+  void ImportParameter::SetRouteCH(bool routeCH)
+  {
+    this->routeCH=routeCH;
+  }
+
+  /**
+   * Set the speed (km/h) per type name used for the costs of the
+   * contraction hierarchy. The hierarchy is only used by the router for a
+   * FastestPathRoutingProfile parametrized with the same speeds and maximum
+   * speed. If no speeds are set, RouteCHDataGenerator::GetDefaultCarSpeedTable()
+   * is used.
+   */
+  void ImportParameter::SetRouteCHCarSpeeds(const std::map<std::string,double>& speeds)
+  {
+    this->routeCHCarSpeeds=speeds;
+  }
+
+  void ImportParameter::SetRouteCHCarMaxSpeed(double maxSpeed)
+  {
+    this->routeCHCarMaxSpeed=maxSpeed;
+  }
+
   void ImportParameter::SetAssumeLand(bool assumeLand)
   {
     this->assumeLand=assumeLand;
@@ -546,13 +641,26 @@ namespace osmscout {
     // no code
   }
 
-  static bool ExecuteModules(std::list<ImportModule*>& modules,
-                            const ImportParameter& parameter,
-                            Progress& progress,
-                            const TypeConfigRef& typeConfig)
+  /**
+    Returns the files (with full path) the module reads and writes, so that the
+    import can derive which modules can be executed in parallel.
+
+    Returns false, if the module does not declare its files. Such a module
+    is executed after all previous and before all following modules.
+    */
+  bool ImportModule::GetFiles(const ImportParameter& /*parameter*/,
+                              std::list<std::string>& /*inputFiles*/,
+                              std::list<std::string>& /*outputFiles*/) const
   {
-    StopClock overAllTimer;
-    size_t    currentStep=1;
+    return false;
+  }
+
+  static bool ExecuteModulesSequential(std::list<ImportModule*>& modules,
+                                       const ImportParameter& parameter,
+                                       Progress& progress,
+                                       const TypeConfigRef& typeConfig)
+  {
+    size_t currentStep=1;
 
     for (std::list<ImportModule*>::const_iterator module=modules.begin();
          module!=modules.end();
@@ -584,6 +692,259 @@ namespace osmscout {
       currentStep++;
     }
 
+    return true;
+  }
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  /**
+    A module scheduled for parallel execution
+    */
+  struct ImportJob
+  {
+    ImportModule*         module;       //! The module to execute
+    size_t                step;         //! The step number of the module
+    bool                  declared;     //! The module declares its files
+    std::set<std::string> inputFiles;   //! Files read by the module
+    std::set<std::string> outputFiles;  //! Files written by the module
+    std::list<size_t>     dependents;   //! Jobs that have to wait for this job
+    size_t                dependencies; //! Number of unfinished jobs this job waits for
+    bool                  started;      //! The job has been started
+    bool                  success;      //! The module finished successfully
+    std::string           time;         //! Execution time of the module
+    BufferedProgress*     progress;     //! Progress of the module
+    std::thread           thread;       //! Thread executing the job
+  };
+
+  /**
+    State shared between the scheduler and the worker threads
+    */
+  struct ImportJobQueue
+  {
+    std::mutex              mutex;      //! Guards the list of finished jobs
+    std::condition_variable condition;  //! Signaled, if a job has finished
+    std::list<size_t>       finished;   //! Jobs finished, but not yet handled by the scheduler
+  };
+
+  static bool Intersects(const std::set<std::string>& a,
+                         const std::set<std::string>& b)
+  {
+    for (std::set<std::string>::const_iterator file=a.begin();
+         file!=a.end();
+         ++file) {
+      if (b.find(*file)!=b.end()) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+    Returns true, if the given job must wait for the given previous job, because
+    it reads a file written by the previous job, writes a file read or written
+    by the previous job or because one of both does not declare its files.
+    */
+  static bool DependsOn(const ImportJob& job,
+                        const ImportJob& previous)
+  {
+    if (!job.declared ||
+        !previous.declared) {
+      return true;
+    }
+
+    return Intersects(job.inputFiles,previous.outputFiles) ||
+           Intersects(job.outputFiles,previous.inputFiles) ||
+           Intersects(job.outputFiles,previous.outputFiles);
+  }
+
+  static void ExecuteJob(ImportJob* job,
+                         size_t index,
+                         ImportJobQueue* queue,
+                         const ImportParameter* parameter,
+                         const TypeConfigRef* typeConfig)
+  {
+    StopClock timer;
+
+    job->success=job->module->Import(*typeConfig,
+                                     *parameter,
+                                     *job->progress);
+
+    timer.Stop();
+
+    job->time=timer.ResultString();
+
+    std::lock_guard<std::mutex> lock(queue->mutex);
+
+    queue->finished.push_back(index);
+    queue->condition.notify_one();
+  }
+
+  /**
+    Executes the modules of the selected steps in parallel, as far as the files
+    declared by the modules allow. Steps are started in the order of their step
+    number as soon as all steps they depend on have finished. The output of a
+    step is passed to the given progress after the step has finished.
+
+    At most parallelSteps steps are executed at the same time. Each step may
+    itself use up to numberOfThreads threads, so up to parallelSteps times
+    numberOfThreads threads and parallelSteps sort buffers of sortBlockSize
+    entries may exist at the same time.
+    */
+  static bool ExecuteModulesParallel(std::list<ImportModule*>& modules,
+                                     const ImportParameter& parameter,
+                                     Progress& progress,
+                                     const TypeConfigRef& typeConfig)
+  {
+    std::vector<ImportJob> jobs;
+    ImportJobQueue         queue;
+    size_t                 currentStep=1;
+    size_t                 running=0;
+    size_t                 done=0;
+    bool                   success=true;
+
+    for (std::list<ImportModule*>::const_iterator module=modules.begin();
+         module!=modules.end();
+         ++module) {
+      if (currentStep>=parameter.GetStartStep() &&
+          currentStep<=parameter.GetEndStep()) {
+        std::list<std::string> inputFiles;
+        std::list<std::string> outputFiles;
+
+        jobs.push_back(ImportJob());
+
+        ImportJob& job=jobs.back();
+
+        job.module=*module;
+        job.step=currentStep;
+        job.declared=(*module)->GetFiles(parameter,
+                                         inputFiles,
+                                         outputFiles);
+        job.inputFiles.insert(inputFiles.begin(),inputFiles.end());
+        job.outputFiles.insert(outputFiles.begin(),outputFiles.end());
+        job.dependencies=0;
+        job.started=false;
+        job.success=false;
+        job.progress=NULL;
+      }
+
+      currentStep++;
+    }
+
+    for (size_t j=0; j<jobs.size(); j++) {
+      for (size_t p=0; p<j; p++) {
+        if (DependsOn(jobs[j],jobs[p])) {
+          jobs[p].dependents.push_back(j);
+          jobs[j].dependencies++;
+        }
+      }
+    }
+
+    progress.Info("Executing up to "+NumberToString(parameter.GetParallelSteps())+" steps in parallel");
+
+    while (done<jobs.size()) {
+      if (success) {
+        for (size_t j=0; j<jobs.size() && running<parameter.GetParallelSteps(); j++) {
+          if (jobs[j].started ||
+              jobs[j].dependencies>0) {
+            continue;
+          }
+
+          jobs[j].started=true;
+          jobs[j].progress=new BufferedProgress(progress.OutputDebug());
+          jobs[j].thread=std::thread(ExecuteJob,
+                                     &jobs[j],
+                                     j,
+                                     &queue,
+                                     &parameter,
+                                     &typeConfig);
+          running++;
+        }
+      }
+
+      if (running==0) {
+        break;
+      }
+
+      size_t index;
+
+      {
+        std::unique_lock<std::mutex> lock(queue.mutex);
+
+        while (queue.finished.empty()) {
+          queue.condition.wait(lock);
+        }
+
+        index=queue.finished.front();
+        queue.finished.pop_front();
+      }
+
+      ImportJob& job=jobs[index];
+
+      job.thread.join();
+      running--;
+      done++;
+
+      progress.SetStep(std::string("Step #")+
+                       NumberToString(job.step)+
+                       " - "+
+                       job.module->GetDescription());
+
+      job.progress->Replay(progress);
+
+      delete job.progress;
+      job.progress=NULL;
+
+      progress.Info(std::string("=> ")+job.time+" second(s)");
+
+      if (!job.success) {
+        progress.Error(std::string("Error while executing step '")+job.module->GetDescription()+"'!");
+        success=false;
+        continue;
+      }
+
+      for (std::list<size_t>::const_iterator dependent=job.dependents.begin();
+           dependent!=job.dependents.end();
+           ++dependent) {
+        jobs[*dependent].dependencies--;
+      }
+    }
+
+    return success;
+  }
+#endif
+
+  static bool ExecuteModules(std::list<ImportModule*>& modules,
+                             const ImportParameter& parameter,
+                             Progress& progress,
+                             const TypeConfigRef& typeConfig)
+  {
+    StopClock overAllTimer;
+    bool      success;
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    if (parameter.GetParallelSteps()>1) {
+      success=ExecuteModulesParallel(modules,
+                                     parameter,
+                                     progress,
+                                     typeConfig);
+    }
+    else {
+      success=ExecuteModulesSequential(modules,
+                                       parameter,
+                                       progress,
+                                       typeConfig);
+    }
+#else
+    success=ExecuteModulesSequential(modules,
+                                     parameter,
+                                     progress,
+                                     typeConfig);
+#endif
+
+    if (!success) {
+      return false;
+    }
+
     overAllTimer.Stop();
     progress.Info(std::string("=> ")+overAllTimer.ResultString()+" second(s)");
 
@@ -731,8 +1092,14 @@ namespace osmscout {
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_CAR_IDX)));
 
-#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
     /* 26 */
+    modules.push_back(new RouteCHDataGenerator());
+
+    /* 27 */
+    modules.push_back(new RouteSegmentIndexGenerator());
+
+#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
+    /* 28 */
     modules.push_back(new TextIndexGenerator());
 #endif
 
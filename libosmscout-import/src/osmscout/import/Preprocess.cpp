@@ -21,6 +21,8 @@
 
 #include <limits>
 
+#include <osmscout/CoordDataFile.h>
+
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/File.h>
@@ -44,6 +46,13 @@ namespace osmscout {
 
   static uint32_t coordPageSize=64;
 
+  /**
+   * Gaps in the dense coord array up to this size (in bytes) are filled with
+   * zeros instead of repositioning the writer, larger gaps become holes
+   * in the (sparse) file
+   */
+  static const FileOffset denseCoordMaxGap=4096;
+
   bool Preprocess::StoreCurrentPage()
   {
     if (!coordWriter.SetPos(currentPageOffset)) {
@@ -113,8 +122,66 @@ namespace osmscout {
     return coordWriter.WriteCoord(coord);
   }
 
+  /**
+   * Store the coord at the offset given by the node id. Values are stored
+   * incremented by one, so that unset entries (and holes in the file) are zero.
+   *
+   * Node ids normally arrive in ascending order, so small gaps after the end of
+   * the data written so far are filled with zeros, to keep writing sequential.
+   * Larger gaps are skipped (leaving a hole in the file), entries before the
+   * end are updated in place.
+   */
+  bool Preprocess::StoreDenseCoord(OSMId id,
+                                   const GeoCoord& coord)
+  {
+    if (id<0) {
+      if (denseCoordIdErrors==0) {
+        progress->Error("Negative node id "+NumberToString(id)+" cannot be stored in dense coord data");
+      }
+
+      denseCoordIdErrors++;
+
+      return false;
+    }
+
+    FileOffset offset=denseCoordOffset+id*CoordDataFile::denseCoordByteSize;
+
+    if (offset>=denseCoordEnd &&
+        offset-denseCoordEnd<=denseCoordMaxGap) {
+      if (denseCoordPos!=denseCoordEnd) {
+        if (!coordWriter.SetPos(denseCoordEnd)) {
+          return false;
+        }
+
+        denseCoordPos=denseCoordEnd;
+      }
+
+      while (denseCoordPos<offset) {
+        coordWriter.Write((uint32_t)0);
+        denseCoordPos+=sizeof(uint32_t);
+      }
+    }
+    else if (offset!=denseCoordPos) {
+      if (!coordWriter.SetPos(offset)) {
+        return false;
+      }
+    }
+
+    uint32_t latValue=(uint32_t)round((coord.GetLat()+90.0)*latConversionFactor);
+    uint32_t lonValue=(uint32_t)round((coord.GetLon()+180.0)*lonConversionFactor);
+
+    coordWriter.Write(latValue+1);
+    coordWriter.Write(lonValue+1);
+
+    denseCoordPos=offset+CoordDataFile::denseCoordByteSize;
+    denseCoordEnd=std::max(denseCoordEnd,denseCoordPos);
+    denseCoordCount=std::max(denseCoordCount,(FileOffset)id+1);
+
+    return !coordWriter.HasError();
+  }
+
   bool Preprocess::IsTurnRestriction(const TypeConfig& typeConfig,
-                                     const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                                     const TagMap& tags,
                                      TurnRestriction::Type& type) const
   {
     auto typeValue=tags.find(typeConfig.tagType);
@@ -199,7 +266,7 @@ namespace osmscout {
   }
 
   bool Preprocess::IsMultipolygon(const TypeConfig& typeConfig,
-                                  const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                                  const TagMap& tags,
                                   TypeInfoRef& type)
   {
     type=typeConfig.GetRelationType(tags);
@@ -222,7 +289,7 @@ namespace osmscout {
   }
 
   void Preprocess::ProcessMultipolygon(const TypeConfig& typeConfig,
-                                       const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                                       const TagMap& tags,
                                        const std::vector<RawRelation::Member>& members,
                                        OSMId id,
                                        const TypeInfoRef& type)
@@ -257,6 +324,30 @@ namespace osmscout {
     return "Preprocess";
   }
 
+  bool Preprocess::GetFiles(const ImportParameter& parameter,
+                            std::list<std::string>& inputFiles,
+                            std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(parameter.GetMapfile());
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "bounding.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "coord.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "rawcoastline.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "rawnodes.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "rawrels.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "rawturnrestr.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "rawways.dat"));
+
+    return true;
+  }
+
   bool Preprocess::Import(const TypeConfigRef& typeConfig,
                           const ImportParameter& parameter,
                           Progress& progress)
@@ -350,16 +441,32 @@ namespace osmscout {
     coordWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                      "coord.dat"));
 
-    FileOffset offset=0;
+    coordDataDense=parameter.GetCoordDataDense();
+    denseCoordIdErrors=0;
 
-    coordWriter.Write(coordPageSize);
-    coordWriter.Write(offset);
-    coordWriter.FlushCurrentBlockWithZeros(coordPageSize*coordByteSize);
+    if (coordDataDense) {
+      // A page size of 0 marks the dense variant, followed by the number of entries
+      denseCoordCount=0;
 
-    coordPageCount++;
+      coordWriter.Write((uint32_t)0);
+      coordWriter.Write(denseCoordCount);
+      coordWriter.GetPos(denseCoordOffset);
+
+      denseCoordPos=denseCoordOffset;
+      denseCoordEnd=denseCoordOffset;
+    }
+    else {
+      FileOffset offset=0;
+
+      coordWriter.Write(coordPageSize);
+      coordWriter.Write(offset);
+      coordWriter.FlushCurrentBlockWithZeros(coordPageSize*coordByteSize);
+
+      coordPageCount++;
 
-    coords.resize(coordPageSize);
-    isSet.resize(coordPageSize);
+      coords.resize(coordPageSize);
+      isSet.resize(coordPageSize);
+    }
 
     return !nodeWriter.HasError() &&
            !wayWriter.HasError() &&
@@ -373,7 +480,7 @@ namespace osmscout {
                                const OSMId& id,
                                const double& lon,
                                const double& lat,
-                               const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap)
+                               const TagMap& tagMap)
   {
     RawNode      node;
     ObjectOSMRef object(id,
@@ -389,9 +496,16 @@ namespace osmscout {
     maxCoord.Set(std::max(maxCoord.GetLat(),lat),
                  std::max(maxCoord.GetLon(),lon));
 
-    StoreCoord(id,
-               GeoCoord(lat,
-                        lon));
+    if (coordDataDense) {
+      StoreDenseCoord(id,
+                      GeoCoord(lat,
+                               lon));
+    }
+    else {
+      StoreCoord(id,
+                 GeoCoord(lat,
+                          lon));
+    }
 
     TypeInfoRef type=typeConfig.GetNodeType(tagMap);
 
@@ -418,7 +532,7 @@ namespace osmscout {
   void Preprocess::ProcessWay(const TypeConfig& typeConfig,
                               const OSMId& id,
                               std::vector<OSMId>& nodes,
-                              const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap)
+                              const TagMap& tagMap)
   {
     TypeInfoRef areaType;
     TypeInfoRef wayType;
@@ -583,7 +697,7 @@ namespace osmscout {
   void Preprocess::ProcessRelation(const TypeConfig& typeConfig,
                                    const OSMId& id,
                                    const std::vector<RawRelation::Member>& members,
-                                   const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap)
+                                   const TagMap& tagMap)
   {
     if (id<lastRelationId) {
       relationSortingError=true;
@@ -643,7 +757,8 @@ namespace osmscout {
     // I at least try to assure, that we do not misuse it.
     this->progress=NULL;
 
-    if (currentPageId!=0) {
+    if (!coordDataDense &&
+        currentPageId!=0) {
       StoreCurrentPage();
     }
 
@@ -664,20 +779,26 @@ namespace osmscout {
 
     coordWriter.SetPos(0);
 
-    coordWriter.Write(coordPageSize);
+    if (coordDataDense) {
+      coordWriter.Write((uint32_t)0);
+      coordWriter.Write(denseCoordCount);
+    }
+    else {
+      coordWriter.Write(coordPageSize);
 
-    FileOffset coordIndexOffset=coordPageCount*coordPageSize*2*sizeof(uint32_t);
+      FileOffset coordIndexOffset=coordPageCount*coordPageSize*2*sizeof(uint32_t);
 
-    coordWriter.Write(coordIndexOffset);
+      coordWriter.Write(coordIndexOffset);
 
-    coordWriter.SetPos(coordIndexOffset);
-    coordWriter.Write((uint32_t)coordIndex.size());
+      coordWriter.SetPos(coordIndexOffset);
+      coordWriter.Write((uint32_t)coordIndex.size());
 
-    for (CoordPageOffsetMap::const_iterator entry=coordIndex.begin();
-         entry!=coordIndex.end();
-         ++entry) {
-      coordWriter.Write(entry->first);
-      coordWriter.Write(entry->second);
+      for (CoordPageOffsetMap::const_iterator entry=coordIndex.begin();
+           entry!=coordIndex.end();
+           ++entry) {
+        coordWriter.Write(entry->first);
+        coordWriter.Write(entry->second);
+      }
     }
 
     nodeWriter.Close();
@@ -695,7 +816,16 @@ namespace osmscout {
     progress.Info(std::string("Coastlines:       ")+NumberToString(coastlineCount));
     progress.Info(std::string("Turnrestrictions: ")+NumberToString(turnRestrictionCount));
     progress.Info(std::string("Multipolygons:    ")+NumberToString(multipolygonCount));
-    progress.Info(std::string("Coord pages:      ")+NumberToString(coordIndex.size()));
+    if (coordDataDense) {
+      progress.Info(std::string("Coord entries:    ")+NumberToString(denseCoordCount));
+
+      if (denseCoordIdErrors>0) {
+        progress.Error(NumberToString(denseCoordIdErrors)+" nodes with negative ids were not stored in dense coord data");
+      }
+    }
+    else {
+      progress.Info(std::string("Coord pages:      ")+NumberToString(coordIndex.size()));
+    }
 
     for (const auto &type : typeConfig->GetTypes()) {
       size_t      i=type->GetIndex();
@@ -48,14 +48,14 @@ namespace osmscout {
     };
 
   private:
-    Context                             context;
-    PreprocessOSM&                      pp;
-    const TypeConfig&                   typeConfig;
-    OSMId                               id;
-    double                              lon,lat;
-    OSMSCOUT_HASHMAP<TagId,std::string> tags;
-    std::vector<OSMId>                  nodes;
-    std::vector<RawRelation::Member>    members;
+    Context                          context;
+    PreprocessOSM&                   pp;
+    const TypeConfig&                typeConfig;
+    OSMId                            id;
+    double                           lon,lat;
+    TagMap                           tags;
+    std::vector<OSMId>               nodes;
+    std::vector<RawRelation::Member> members;
 
   public:
     Parser(PreprocessOSM& pp,
@@ -74,7 +74,7 @@ namespace osmscout {
         const xmlChar *lonValue=NULL;
 
         context=contextNode;
-        tags.clear();
+        tags.Clear();
 
         for (size_t i=0; atts[i]!=NULL && atts[i+1]!=NULL; i+=2) {
           if (strcmp((const char*)atts[i],"id")==0) {
@@ -111,7 +111,7 @@ namespace osmscout {
         context=contextWay;
         nodes.clear();
         members.clear();
-        tags.clear();
+        tags.Clear();
 
         for (size_t i=0; atts[i]!=NULL && atts[i+1]!=NULL; i+=2) {
           if (strcmp((const char*)atts[i],"id")==0) {
@@ -128,7 +128,7 @@ namespace osmscout {
         const xmlChar *idValue=NULL;
 
         context=contextRelation;
-        tags.clear();
+        tags.Clear();
         nodes.clear();
         members.clear();
 
@@ -168,7 +168,9 @@ namespace osmscout {
         TagId id=typeConfig.GetTagId((const char*)keyValue);
 
         if (id!=tagIgnore) {
-          tags[id]=(const char*)valueValue;
+          // The attribute values are only valid during this call
+          tags.Copy(id,
+                    (const char*)valueValue);
         }
       }
       else if (strcmp((const char*)name,"nd")==0) {
@@ -263,7 +265,7 @@ namespace osmscout {
                        lon,
                        lat,
                        tags);
-        tags.clear();
+        tags.Clear();
         context=contextUnknown;
       }
       else if (strcmp((const char*)name,"way")==0) {
@@ -272,7 +274,7 @@ namespace osmscout {
                       nodes,
                       tags);
         nodes.clear();
-        tags.clear();
+        tags.Clear();
         context=contextUnknown;
       }
       else if (strcmp((const char*)name,"relation")==0) {
@@ -281,7 +283,7 @@ namespace osmscout {
                            members,
                            tags);
         members.clear();
-        tags.clear();
+        tags.Clear();
         context=contextUnknown;
       }
     }
@@ -22,6 +22,9 @@
 #include <osmscout/import/PreprocessPBF.h>
 
 #include <cstdio>
+#include <list>
+#include <map>
+#include <vector>
 
 // We should try to get rid of this!
 #if defined(__WIN32__) || defined(WIN32)
@@ -34,6 +37,14 @@
   #include <zlib.h>
 #endif
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+  #include <condition_variable>
+  #include <mutex>
+  #include <thread>
+#endif
+
 #include <osmscout/util/File.h>
 #include <osmscout/util/String.h>
 
@@ -45,16 +56,20 @@
 
 namespace osmscout {
 
-  bool ReadBlockHeader(Progress& progress,
-                       FILE* file,
-                       PBF::BlockHeader& blockHeader,
-                       bool silent)
+  /**
+    Reads the next block header. If silent is true, a missing block header
+    (end of file) is not reported as an error.
+    */
+  static bool ReadBlockHeader(FILE* file,
+                              PBF::BlockHeader& blockHeader,
+                              bool silent,
+                              std::string& error)
   {
     char blockHeaderLength[4];
 
     if (fread(blockHeaderLength,sizeof(char),4,file)!=4) {
       if (!silent) {
-        progress.Error("Cannot read block header length!");
+        error="Cannot read block header length!";
       }
       return false;
     }
@@ -63,20 +78,20 @@ namespace osmscout {
     uint32_t length=ntohl(*((uint32_t*)&blockHeaderLength));
 
     if (length==0 || length>MAX_BLOCK_HEADER_SIZE) {
-      progress.Error("Block header size invalid!");
+      error="Block header size invalid!";
       return false;
     }
 
     char *buffer=new char[length];
 
     if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read block header!");
+      error="Cannot read block header!";
       delete[] buffer;
       return false;
     }
 
     if (!blockHeader.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse block header!");
+      error="Cannot parse block header!";
       delete[] buffer;
       return false;
     }
@@ -86,189 +101,404 @@ namespace osmscout {
     return true;
   }
 
-  bool ReadHeaderBlock(Progress& progress,
-                       FILE* file,
+  /**
+    Reads the still encoded blob following the given block header.
+    */
+  static bool ReadBlob(FILE* file,
                        const PBF::BlockHeader& blockHeader,
-                       PBF::HeaderBlock& headerBlock)
+                       std::string& data,
+                       std::string& error)
   {
-    PBF::Blob blob;
-
     uint32_t length = blockHeader.datasize();
 
     if (length==0 || length>MAX_BLOB_SIZE) {
-      progress.Error("Blob size invalid!");
+      error="Blob size invalid!";
       return false;
     }
 
-    char *buffer=new char[length];
+    data.resize(length);
 
-    if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read blob!");
-      delete[] buffer;
+    if (fread(&data[0],sizeof(char),length,file)!=length) {
+      error="Cannot read blob!";
       return false;
     }
 
-    if (!blob.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse blob!");
-      delete[] buffer;
+    return true;
+  }
+
+  /**
+    Parses the given blob and returns its uncompressed content. Does not
+    access any shared state and thus can be called in parallel.
+    */
+  static bool DecodeBlob(const std::string& data,
+                         std::string& content,
+                         std::string& error)
+  {
+    PBF::Blob blob;
+
+    if (!blob.ParseFromString(data)) {
+      error="Cannot parse blob!";
       return false;
     }
 
-    delete [] buffer;
-
     if (blob.has_raw()) {
-      length=(uint32_t)blob.raw().length();
-      buffer = new char[length];
-      memcpy(buffer,blob.raw().data(),length);
+      content=blob.raw();
     }
     else if (blob.has_zlib_data()){
 #if defined(HAVE_LIB_ZLIB)
-      length=blob.raw_size();
-      buffer=new char[length];
+      uint32_t length=blob.raw_size();
+
+      content.resize(length);
 
       z_stream compressedStream;
 
       compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
       compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
-      compressedStream.next_out=(Bytef*)buffer;
+      compressedStream.next_out=(Bytef*)&content[0];
       compressedStream.avail_out=length;
       compressedStream.zalloc=Z_NULL;
       compressedStream.zfree=Z_NULL;
       compressedStream.opaque=Z_NULL;
 
       if (inflateInit( &compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 
       if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
+        error="Cannot decode zlib compressed blob data!";
+        inflateEnd(&compressedStream);
         return false;
       }
 
       if (inflateEnd(&compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 #else
-      progress.Error("Data is zlib encoded but zlib support is not enabled!");
+      error="Data is zlib encoded but zlib support is not enabled!";
       return false;
 #endif
     }
     else if (blob.has_bzip2_data()){
-      progress.Error("Data is bzip2 encoded but bzip2 support is not enabled!");
+      error="Data is bzip2 encoded but bzip2 support is not enabled!";
       return false;
     }
     else if (blob.has_lzma_data()){
-      progress.Error("Data is lzma encoded but lzma support is not enabled!");
+      error="Data is lzma encoded but lzma support is not enabled!";
       return false;
     }
 
-    if (!headerBlock.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse header block!");
-      delete[] buffer;
-      return false;
-    }
-
-    delete[] buffer;
-
     return true;
   }
 
-  bool ReadPrimitiveBlock(Progress& progress,
-                          FILE* file,
-                          const PBF::BlockHeader& blockHeader,
-                          PBF::PrimitiveBlock& primitiveBlock)
+  static bool DecodePrimitiveBlock(const std::string& data,
+                                   PBF::PrimitiveBlock& primitiveBlock,
+                                   std::string& error)
   {
-    PBF::Blob blob;
+    std::string content;
 
-    uint32_t length = blockHeader.datasize();
+    if (!DecodeBlob(data,
+                    content,
+                    error)) {
+      return false;
+    }
 
-    if (length==0 || length>MAX_BLOB_SIZE) {
-      progress.Error("Blob size invalid!");
+    if (!primitiveBlock.ParseFromString(content)) {
+      error="Cannot parse primitive block!";
       return false;
     }
 
-    char *buffer=new char[length];
+    return true;
+  }
 
-    if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read blob!");
-      delete[] buffer;
+  static bool ReadHeaderBlock(Progress& progress,
+                              FILE* file,
+                              const PBF::BlockHeader& blockHeader,
+                              PBF::HeaderBlock& headerBlock)
+  {
+    std::string data;
+    std::string content;
+    std::string error;
+
+    if (!ReadBlob(file,
+                  blockHeader,
+                  data,
+                  error) ||
+        !DecodeBlob(data,
+                    content,
+                    error)) {
+      progress.Error(error);
       return false;
     }
 
-    if (!blob.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse blob!");
-      delete[] buffer;
+    if (!headerBlock.ParseFromString(content)) {
+      progress.Error("Cannot parse header block!");
       return false;
     }
 
-    delete [] buffer;
+    return true;
+  }
 
-    if (blob.has_raw()) {
-      length=(uint32_t)blob.raw().length();
-      buffer = new char[length];
-      memcpy(buffer,blob.raw().data(),length);
+#if defined(OSMSCOUT_HAVE_THREAD)
+  /**
+    Reads the data blocks of a PBF file in a pipeline: One thread reads the
+    encoded blobs from the file, a number of threads decode them in parallel
+    and GetNextBlock() returns the decoded blocks in file order. The number
+    of blocks read but not yet returned is limited to bound memory usage.
+    */
+  class PBFBlockReader
+  {
+  private:
+    struct Blob
+    {
+      size_t      index; //! Index of the blob in the file
+      std::string data;  //! Encoded blob data
+    };
+
+  private:
+    FILE*                                 file;
+    size_t                                maxPendingBlocks;
+    std::vector<std::thread>              threads;
+
+    std::mutex                            mutex;
+    std::condition_variable               condition;     //! Signaled on every state change
+    std::list<Blob*>                      blobs;         //! Blobs read, but not yet decoded
+    std::map<size_t,PBF::PrimitiveBlock*> blocks;        //! Blocks decoded, but not yet returned
+    size_t                                readCount;     //! Number of blobs read
+    size_t                                returnedCount; //! Number of blocks returned
+    bool                                  finished;      //! All blobs of the file have been read
+    bool                                  aborted;       //! All threads should stop
+    bool                                  failed;        //! A blob could not be read or decoded
+    std::string                           error;         //! Error message, if any
+
+  private:
+    void Fail(const std::string& error)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      if (!failed) {
+        failed=true;
+        this->error=error;
+      }
+
+      aborted=true;
+      condition.notify_all();
     }
-    else if (blob.has_zlib_data()){
-#if defined(HAVE_LIB_ZLIB)
-      length=blob.raw_size();
-      buffer=new char[length];
 
-      z_stream compressedStream;
+    void ReadBlobs()
+    {
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
 
-      compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
-      compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
-      compressedStream.next_out=(Bytef*)buffer;
-      compressedStream.avail_out=length;
-      compressedStream.zalloc=Z_NULL;
-      compressedStream.zfree=Z_NULL;
-      compressedStream.opaque=Z_NULL;
+          while (!aborted &&
+                 readCount-returnedCount>=maxPendingBlocks) {
+            condition.wait(lock);
+          }
 
-      if (inflateInit( &compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
-        return false;
+          if (aborted) {
+            return;
+          }
+        }
+
+        PBF::BlockHeader blockHeader;
+        std::string      error;
+
+        if (!ReadBlockHeader(file,
+                             blockHeader,
+                             true,
+                             error)) {
+          std::lock_guard<std::mutex> lock(mutex);
+
+          this->error=error;
+          finished=true;
+          condition.notify_all();
+
+          return;
+        }
+
+        if (blockHeader.type()!="OSMData") {
+          Fail("File is not an OSM PBF file!");
+          return;
+        }
+
+        Blob* blob=new Blob();
+
+        if (!ReadBlob(file,
+                      blockHeader,
+                      blob->data,
+                      error)) {
+          delete blob;
+          Fail(error);
+          return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        blob->index=readCount;
+        readCount++;
+
+        blobs.push_back(blob);
+        condition.notify_all();
       }
+    }
 
-      if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
-        return false;
+    void DecodeBlobs()
+    {
+      while (true) {
+        Blob* blob;
+
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+
+          while (!aborted &&
+                 !finished &&
+                 blobs.empty()) {
+            condition.wait(lock);
+          }
+
+          if (aborted ||
+              blobs.empty()) {
+            return;
+          }
+
+          blob=blobs.front();
+          blobs.pop_front();
+        }
+
+        PBF::PrimitiveBlock* block=new PBF::PrimitiveBlock();
+        std::string          error;
+
+        if (!DecodePrimitiveBlock(blob->data,
+                                  *block,
+                                  error)) {
+          delete block;
+          delete blob;
+          Fail(error);
+          return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        blocks[blob->index]=block;
+        delete blob;
+
+        condition.notify_all();
       }
+    }
 
-      if (inflateEnd(&compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        delete[] buffer;
-        return false;
+  public:
+    PBFBlockReader(FILE* file,
+                   size_t decoderCount)
+    : file(file),
+      maxPendingBlocks(4*decoderCount),
+      readCount(0),
+      returnedCount(0),
+      finished(false),
+      aborted(false),
+      failed(false)
+    {
+      threads.push_back(std::thread(&PBFBlockReader::ReadBlobs,this));
+
+      for (size_t t=0; t<decoderCount; t++) {
+        threads.push_back(std::thread(&PBFBlockReader::DecodeBlobs,this));
       }
-#else
-      progress.Error("Data is zlib encoded but zlib support is not enabled!");
-      return false;
-#endif
     }
-    else if (blob.has_bzip2_data()){
-      progress.Error("Data is bzip2 encoded but bzip2 support is not enabled!");
-      return false;
+
+    ~PBFBlockReader()
+    {
+      Stop();
     }
-    else if (blob.has_lzma_data()){
-      progress.Error("Data is lzma encoded but lzma support is not enabled!");
-      return false;
+
+    /**
+      Returns the next block in file order or NULL, if there are no more blocks
+      or an error occurred. The caller takes ownership of the block.
+      */
+    PBF::PrimitiveBlock* GetNextBlock()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+
+      while (!aborted) {
+        std::map<size_t,PBF::PrimitiveBlock*>::iterator block=blocks.find(returnedCount);
+
+        if (block!=blocks.end()) {
+          PBF::PrimitiveBlock* result=block->second;
+
+          blocks.erase(block);
+          returnedCount++;
+          condition.notify_all();
+
+          return result;
+        }
+
+        if (finished &&
+            returnedCount==readCount) {
+          return NULL;
+        }
+
+        condition.wait(lock);
+      }
+
+      return NULL;
     }
 
-    if (!primitiveBlock.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse primitive block!");
-      delete[] buffer;
-      return false;
+    /**
+      Stops and joins all threads and frees all blocks not yet returned.
+      */
+    void Stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        aborted=true;
+        condition.notify_all();
+      }
+
+      for (std::vector<std::thread>::iterator thread=threads.begin();
+           thread!=threads.end();
+           ++thread) {
+        thread->join();
+      }
+
+      threads.clear();
+
+      for (std::list<Blob*>::iterator blob=blobs.begin();
+           blob!=blobs.end();
+           ++blob) {
+        delete *blob;
+      }
+
+      blobs.clear();
+
+      for (std::map<size_t,PBF::PrimitiveBlock*>::iterator block=blocks.begin();
+           block!=blocks.end();
+           ++block) {
+        delete block->second;
+      }
+
+      blocks.clear();
     }
 
-    delete[] buffer;
+    /**
+      Returns true, if the file could not be read or a block could not be decoded.
+      Only valid after Stop() has been called.
+      */
+    bool HasFailed() const
+    {
+      return failed;
+    }
 
-    return true;
-  }
+    /**
+      Returns the error that stopped reading, if any. Only valid after Stop() has
+      been called.
+      */
+    std::string GetError() const
+    {
+      return error;
+    }
+  };
+#endif
 
   std::string PreprocessPBF::GetDescription() const
   {
@@ -282,13 +512,14 @@ namespace osmscout {
     for (int n=0; n<group.nodes_size(); n++) {
       const PBF::Node &inputNode=group.nodes(n);
 
-      tagMap.clear();
+      tagMap.Clear();
 
       for (int t=0; t<inputNode.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputNode.keys(t)).c_str());
+        TagId id=typeConfig.GetTagId(block.stringtable().s(inputNode.keys(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputNode.vals(t));
+          tagMap.Reference(id,
+                           block.stringtable().s(inputNode.vals(t)));
         }
       }
 
@@ -315,7 +546,7 @@ namespace osmscout {
       dLat+=dense.lat(d);
       dLon+=dense.lon(d);
 
-      tagMap.clear();
+      tagMap.Clear();
 
       while (true) {
         if (t>=dense.keys_vals_size()) {
@@ -327,10 +558,11 @@ namespace osmscout {
           break;
         }
 
-        TagId id=typeConfig.GetTagId(block.stringtable().s(dense.keys_vals(t)).c_str());
+        TagId id=typeConfig.GetTagId(block.stringtable().s(dense.keys_vals(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(dense.keys_vals(t+1));
+          tagMap.Reference(id,
+                           block.stringtable().s(dense.keys_vals(t+1)));
         }
 
         t+=2;
@@ -352,13 +584,14 @@ namespace osmscout {
       const PBF::Way &inputWay=group.ways(w);
 
       nodes.clear();
-      tagMap.clear();
+      tagMap.Clear();
 
       for (int t=0; t<inputWay.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputWay.keys(t)).c_str());
+        TagId id=typeConfig.GetTagId(block.stringtable().s(inputWay.keys(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputWay.vals(t));
+          tagMap.Reference(id,
+                           block.stringtable().s(inputWay.vals(t)));
         }
       }
 
@@ -384,13 +617,14 @@ namespace osmscout {
       const PBF::Relation &inputRelation=group.relations(r);
 
       members.clear();
-      tagMap.clear();
+      tagMap.Clear();
 
       for (int t=0; t<inputRelation.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputRelation.keys(t)).c_str());
+        TagId id=typeConfig.GetTagId(block.stringtable().s(inputRelation.keys(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputRelation.vals(t));
+          tagMap.Reference(id,
+                           block.stringtable().s(inputRelation.vals(t)));
         }
       }
 
@@ -425,6 +659,37 @@ namespace osmscout {
     }
   }
 
+  void PreprocessPBF::ReadBlock(const TypeConfig& typeConfig,
+                                const PBF::PrimitiveBlock& block)
+  {
+    for (int currentGroup=0;
+         currentGroup<block.primitivegroup_size();
+         currentGroup++) {
+      const PBF::PrimitiveGroup &group=block.primitivegroup(currentGroup);
+
+      if (group.nodes_size()>0) {
+        ReadNodes(typeConfig,
+                  block,
+                  group);
+      }
+      else if (group.ways_size()>0) {
+        ReadWays(typeConfig,
+                 block,
+                 group);
+      }
+      else if (group.relations_size()>0) {
+        ReadRelations(typeConfig,
+                      block,
+                      group);
+      }
+      else if (group.has_dense()) {
+        ReadDenseNodes(typeConfig,
+                       block,
+                       group);
+      }
+    }
+  }
+
   bool PreprocessPBF::Import(const TypeConfigRef& typeConfig,
                              const ImportParameter& parameter,
                              Progress& progress)
@@ -449,8 +714,10 @@ namespace osmscout {
     // BlockHeader
 
     PBF::BlockHeader blockHeader;
+    std::string      error;
 
-    if (!ReadBlockHeader(progress,file,blockHeader,false)) {
+    if (!ReadBlockHeader(file,blockHeader,false,error)) {
+      progress.Error(error);
       fclose(file);
       return false;
     }
@@ -484,60 +751,76 @@ namespace osmscout {
     nodes.reserve(20000);
     members.reserve(2000);
 
-    while (true) {
-      PBF::BlockHeader blockHeader;
+#if defined(OSMSCOUT_HAVE_THREAD)
+    if (parameter.GetNumberOfThreads()>1) {
+      PBFBlockReader       reader(file,
+                                  parameter.GetNumberOfThreads());
+      PBF::PrimitiveBlock* block;
 
-      if (!ReadBlockHeader(progress,
-                           file,
-                           blockHeader,
-                           true)) {
-        fclose(file);
-        break;
-      }
+      // Blocks are processed in file order, so the result is identical
+      // to the sequential import
+      while ((block=reader.GetNextBlock())!=NULL) {
+        ReadBlock(*typeConfig,
+                  *block);
 
-      if (blockHeader.type()!="OSMData") {
-        progress.Error("File is not an OSM PBF file!");
-        fclose(file);
-        return false;
+        delete block;
       }
 
-      PBF::PrimitiveBlock block;
+      reader.Stop();
+      fclose(file);
 
-      if (!ReadPrimitiveBlock(progress,
-                              file,
-                              blockHeader,
-                              block)) {
-        fclose(file);
-        return false;
+      if (!reader.GetError().empty()) {
+        progress.Error(reader.GetError());
       }
 
-      for (int currentGroup=0;
-           currentGroup<block.primitivegroup_size();
-           currentGroup++) {
-        const PBF::PrimitiveGroup &group=block.primitivegroup(currentGroup);
-
-        if (group.nodes_size()>0) {
-          ReadNodes(typeConfig,
-                    block,
-                    group);
-        }
-        else if (group.ways_size()>0) {
-          ReadWays(typeConfig,
-                   block,
-                   group);
+      if (reader.HasFailed()) {
+        return false;
+      }
+    }
+    else {
+#endif
+      while (true) {
+        PBF::BlockHeader    blockHeader;
+        PBF::PrimitiveBlock block;
+        std::string         data;
+        std::string         error;
+
+        if (!ReadBlockHeader(file,
+                             blockHeader,
+                             true,
+                             error)) {
+          if (!error.empty()) {
+            progress.Error(error);
+          }
+          break;
         }
-        else if (group.relations_size()>0) {
-          ReadRelations(typeConfig,
-                        block,
-                        group);
+
+        if (blockHeader.type()!="OSMData") {
+          progress.Error("File is not an OSM PBF file!");
+          fclose(file);
+          return false;
         }
-        else if (group.has_dense()) {
-          ReadDenseNodes(typeConfig,
-                         block,
-                         group);
+
+        if (!ReadBlob(file,
+                      blockHeader,
+                      data,
+                      error) ||
+            !DecodePrimitiveBlock(data,
+                                  block,
+                                  error)) {
+          progress.Error(error);
+          fclose(file);
+          return false;
         }
+
+        ReadBlock(*typeConfig,
+                  block);
       }
+
+      fclose(file);
+#if defined(OSMSCOUT_HAVE_THREAD)
     }
+#endif
 
     return Cleanup(typeConfig,
                    parameter,
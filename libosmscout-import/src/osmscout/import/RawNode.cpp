@@ -59,7 +59,7 @@ namespace osmscout {
 
   void RawNode::Parse(Progress& progress,
                       const TypeConfig& typeConfig,
-                      const OSMSCOUT_HASHMAP<TagId,std::string>& tags)
+                      const TagMap& tags)
   {
     ObjectOSMRef object(id,
                         osmRefNode);
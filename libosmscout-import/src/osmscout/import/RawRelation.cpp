@@ -35,7 +35,7 @@ namespace osmscout {
 
   void RawRelation::Parse(Progress& progress,
                           const TypeConfig& typeConfig,
-                          const OSMSCOUT_HASHMAP<TagId,std::string>& tags)
+                          const TagMap& tags)
   {
     ObjectOSMRef object(id,
                         osmRefRelation);
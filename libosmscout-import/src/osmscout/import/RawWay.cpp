@@ -62,7 +62,7 @@ namespace osmscout {
 
   void RawWay::Parse(Progress& progress,
                      const TypeConfig& typeConfig,
-                     const OSMSCOUT_HASHMAP<TagId,std::string>& tags)
+                     const TagMap& tags)
   {
     ObjectOSMRef object(id,
                         osmRefWay);
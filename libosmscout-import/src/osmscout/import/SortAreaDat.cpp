@@ -204,11 +204,11 @@ namespace osmscout {
   class AreaNodeReductionProcessorFilter : public SortDataGenerator<Area>::ProcessingFilter
   {
   private:
-    std::vector<GeoCoord> nodeBuffer;
-    std::vector<Id>       idBuffer;
-    size_t                duplicateCount;
-    size_t                redundantCount;
-    size_t                overallCount;
+    std::vector<ObjectCoord> nodeBuffer;
+    std::vector<Id>          idBuffer;
+    size_t                   duplicateCount;
+    size_t                   redundantCount;
+    size_t                   overallCount;
 
   private:
     bool IsEqual(const unsigned char buffer1[],
@@ -483,4 +483,23 @@ namespace osmscout {
   {
     return "Sort/copy areas";
   }
+
+  bool SortAreaDataGenerator::GetFiles(const ImportParameter& parameter,
+                                       std::list<std::string>& inputFiles,
+                                       std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "relarea.dat"));
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "wayarea.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areas.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areas.idmap"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areaaddress.dat"));
+
+    return true;
+  }
 }
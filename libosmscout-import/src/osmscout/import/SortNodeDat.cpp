@@ -177,4 +177,21 @@ namespace osmscout {
   {
     return "Sort/copy nodes";
   }
+
+  bool SortNodeDataGenerator::GetFiles(const ImportParameter& parameter,
+                                       std::list<std::string>& inputFiles,
+                                       std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "nodes.tmp"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "nodes.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "nodes.idmap"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "nodeaddress.dat"));
+
+    return true;
+  }
 }
@@ -137,11 +137,11 @@ namespace osmscout {
   class WayNodeReductionProcessorFilter : public SortDataGenerator<Way>::ProcessingFilter
   {
   private:
-    std::vector<GeoCoord> nodeBuffer;
-    std::vector<Id>       idBuffer;
-    size_t                duplicateCount;
-    size_t                redundantCount;
-    size_t                overallCount;
+    std::vector<ObjectCoord> nodeBuffer;
+    std::vector<Id>          idBuffer;
+    size_t                   duplicateCount;
+    size_t                   redundantCount;
+    size_t                   overallCount;
 
   private:
     bool IsEqual(const unsigned char buffer1[],
@@ -391,4 +391,21 @@ namespace osmscout {
     return "Sort/copy ways";
   }
 
+  bool SortWayDataGenerator::GetFiles(const ImportParameter& parameter,
+                                      std::list<std::string>& inputFiles,
+                                      std::list<std::string>& outputFiles) const
+  {
+    inputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "wayway.dat"));
+
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "ways.dat"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "ways.idmap"));
+    outputFiles.push_back(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "wayaddress.dat"));
+
+    return true;
+  }
+
 }
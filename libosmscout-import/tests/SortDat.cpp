@@ -0,0 +1,179 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <osmscout/Node.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileWriter.h>
+
+#include <osmscout/import/SortDat.h>
+
+static const char*  sortDataFilename="sortdat.dat";
+static const char*  sortMapFilename="sortdat.idmap";
+static const size_t nodeCount=2000;
+
+int errors=0;
+
+/**
+ * Sorts the nodes of two source files
+ */
+class SortTestDataGenerator : public osmscout::SortDataGenerator<osmscout::Node>
+{
+protected:
+  void GetTopLeftCoordinate(const osmscout::Node& data,
+                            double& maxLat,
+                            double& minLon)
+  {
+    maxLat=data.GetLat();
+    minLon=data.GetLon();
+  }
+
+public:
+  SortTestDataGenerator()
+  : osmscout::SortDataGenerator<osmscout::Node>(sortDataFilename,sortMapFilename)
+  {
+    AddSource(osmscout::osmRefNode,"sortdat1.tmp");
+    AddSource(osmscout::osmRefWay,"sortdat2.tmp");
+  }
+
+  std::string GetDescription() const
+  {
+    return "Sort test data";
+  }
+};
+
+/**
+ * Writes random nodes to the given file. Coordinates are taken from a small
+ * grid spanning four sort cells, so that there are many nodes with the same
+ * coordinate in and between the source files
+ */
+static bool WriteNodes(const osmscout::TypeConfig& typeConfig,
+                       const osmscout::TypeInfoRef& type,
+                       const std::string& filename)
+{
+  osmscout::FileWriter writer;
+
+  if (!writer.Open(filename)) {
+    std::cerr << "Cannot create '" << filename << "'" << std::endl;
+    return false;
+  }
+
+  writer.Write((uint32_t)nodeCount);
+
+  for (size_t n=0; n<nodeCount; n++) {
+    osmscout::Node node;
+
+    node.SetType(type);
+    node.SetCoords(osmscout::GeoCoord(-10.0+(rand()%40)*0.5,
+                                      -10.0+(rand()%40)*0.5));
+
+    writer.Write((osmscout::Id)(rand()%100000));
+    node.Write(typeConfig,writer);
+  }
+
+  return writer.Close();
+}
+
+static std::string ReadFile(const std::string& filename)
+{
+  std::ifstream file(filename.c_str(),std::ios::in | std::ios::binary);
+
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+static bool Sort(const osmscout::TypeConfigRef& typeConfig,
+                 const osmscout::ImportParameter& parameter,
+                 std::string& data,
+                 std::string& map)
+{
+  osmscout::SilentProgress progress;
+  SortTestDataGenerator    generator;
+
+  if (!generator.Import(typeConfig,
+                        parameter,
+                        progress)) {
+    return false;
+  }
+
+  data=ReadFile(sortDataFilename);
+  map=ReadFile(sortMapFilename);
+
+  return !data.empty() && !map.empty();
+}
+
+/**
+ * The external merge sort must result in the same order as Renumber(),
+ * objects with the same coordinate are ordered by their source file and
+ * then by their offset in the source file. A small block size results in
+ * enough runs to require more than one merge pass.
+ */
+int main()
+{
+  osmscout::TypeConfigRef typeConfig(new osmscout::TypeConfig());
+  osmscout::TypeInfoRef   type(new osmscout::TypeInfo());
+
+  type->SetType("test")
+       .CanBeNode(true);
+
+  typeConfig->RegisterType(type);
+
+  srand(42);
+
+  if (!WriteNodes(*typeConfig,type,"sortdat1.tmp") ||
+      !WriteNodes(*typeConfig,type,"sortdat2.tmp")) {
+    return 1;
+  }
+
+  osmscout::ImportParameter parameter;
+  std::string               renumberData;
+  std::string               renumberMap;
+  std::string               externalData;
+  std::string               externalMap;
+
+  parameter.SetDestinationDirectory(".");
+  parameter.SetSortTileMag(4);
+
+  if (!Sort(typeConfig,parameter,renumberData,renumberMap)) {
+    std::cerr << "Renumber failed" << std::endl;
+    return 1;
+  }
+
+  parameter.SetSortExternal(true);
+  parameter.SetSortBlockSize(20);
+  parameter.SetNumberOfThreads(2);
+
+  if (!Sort(typeConfig,parameter,externalData,externalMap)) {
+    std::cerr << "External sort failed" << std::endl;
+    return 1;
+  }
+
+  if (externalData!=renumberData) {
+    std::cerr << "Data file of external sort differs" << std::endl;
+    errors++;
+  }
+
+  if (externalMap!=renumberMap) {
+    std::cerr << "Id map of external sort differs" << std::endl;
+    errors++;
+  }
+
+  osmscout::FileOffset size;
+
+  if (osmscout::GetFileSize(std::string(sortDataFilename)+".0.0.run",size) ||
+      osmscout::GetFileSize(std::string(sortDataFilename)+".1.0.run",size)) {
+    std::cerr << "Run files were not deleted" << std::endl;
+    errors++;
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef OSMSCOUT_MAP_TILECACHEPAINTERCAIRO_H
+#define OSMSCOUT_MAP_TILECACHEPAINTERCAIRO_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/private/MapCairoImportExport.h>
+
+#include <osmscout/MapPainterCairo.h>
+#include <osmscout/TileCache.h>
+
+namespace osmscout {
+
+  /**
+   * Draws metatiles using MapPainterCairo and stores the tiles as PNG
+   * in a TileCache.
+   */
+  class OSMSCOUT_MAP_CAIRO_API TileCachePainterCairo : public TileCachePainter
+  {
+  private:
+    MapPainterCairo  painter;
+    cairo_surface_t* surface;
+
+  protected:
+    bool EncodeTile(size_t pixelX,
+                    size_t pixelY,
+                    size_t tileSize,
+                    std::vector<char>& data);
+
+  public:
+    TileCachePainterCairo(const StyleConfigRef& styleConfig,
+                          TileCache& cache,
+                          size_t width,
+                          size_t height);
+    virtual ~TileCachePainterCairo();
+
+    bool DrawMetaTile(const MetaTile& metaTile,
+                      const Projection& projection,
+                      const MapParameter& parameter,
+                      const MapData& data);
+  };
+
+  /**
+   * Creates TileCachePainterCairo instances, for example to seed a TileCache
+   * using TileCache::Seed().
+   */
+  class OSMSCOUT_MAP_CAIRO_API TileCachePainterCairoFactory : public MetaTilePainterFactory
+  {
+  private:
+    StyleConfigRef styleConfig;
+    TileCache&     cache;
+
+  public:
+    TileCachePainterCairoFactory(const StyleConfigRef& styleConfig,
+                                 TileCache& cache);
+    virtual ~TileCachePainterCairoFactory();
+
+    MetaTilePainterRef CreatePainter(size_t width,
+                                     size_t height);
+  };
+}
+
+#endif
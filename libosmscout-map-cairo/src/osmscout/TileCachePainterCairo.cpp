@@ -0,0 +1,140 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TileCachePainterCairo.h>
+
+#include <iostream>
+
+namespace osmscout {
+
+#if defined(CAIRO_HAS_PNG_FUNCTIONS)
+  static cairo_status_t AppendToVector(void* closure,
+                                       const unsigned char* data,
+                                       unsigned int length)
+  {
+    std::vector<char>* buffer=static_cast<std::vector<char>*>(closure);
+
+    buffer->insert(buffer->end(),
+                   data,
+                   data+length);
+
+    return CAIRO_STATUS_SUCCESS;
+  }
+#endif
+
+  TileCachePainterCairo::TileCachePainterCairo(const StyleConfigRef& styleConfig,
+                                               TileCache& cache,
+                                               size_t width,
+                                               size_t height)
+  : TileCachePainter(cache),
+    painter(styleConfig),
+    surface(cairo_image_surface_create(CAIRO_FORMAT_RGB24,
+                                       (int)width,
+                                       (int)height))
+  {
+    // no code
+  }
+
+  TileCachePainterCairo::~TileCachePainterCairo()
+  {
+    cairo_surface_destroy(surface);
+  }
+
+  bool TileCachePainterCairo::DrawMetaTile(const MetaTile& /*metaTile*/,
+                                           const Projection& projection,
+                                           const MapParameter& parameter,
+                                           const MapData& data)
+  {
+    if (cairo_surface_status(surface)!=CAIRO_STATUS_SUCCESS) {
+      std::cerr << "Cannot create cairo surface" << std::endl;
+      return false;
+    }
+
+    cairo_t* draw=cairo_create(surface);
+    bool     success;
+
+    success=painter.DrawMap(projection,
+                            parameter,
+                            data,
+                            draw);
+
+    cairo_destroy(draw);
+
+    cairo_surface_flush(surface);
+
+    return success;
+  }
+
+  /**
+   * Encode the given part of the surface as PNG, using a surface sharing
+   * the pixel data of the metatile surface.
+   */
+  bool TileCachePainterCairo::EncodeTile(size_t pixelX,
+                                         size_t pixelY,
+                                         size_t tileSize,
+                                         std::vector<char>& data)
+  {
+#if defined(CAIRO_HAS_PNG_FUNCTIONS)
+    int              stride=cairo_image_surface_get_stride(surface);
+    unsigned char*   pixels=cairo_image_surface_get_data(surface)+pixelY*stride+pixelX*4;
+    cairo_surface_t* tile=cairo_image_surface_create_for_data(pixels,
+                                                              CAIRO_FORMAT_RGB24,
+                                                              (int)tileSize,
+                                                              (int)tileSize,
+                                                              stride);
+    cairo_status_t   status=cairo_surface_write_to_png_stream(tile,
+                                                              AppendToVector,
+                                                              &data);
+
+    cairo_surface_destroy(tile);
+
+    if (status!=CAIRO_STATUS_SUCCESS) {
+      std::cerr << "Cannot encode tile: " << cairo_status_to_string(status) << std::endl;
+      return false;
+    }
+
+    return true;
+#else
+    std::cerr << "Cairo has been built without PNG support" << std::endl;
+    return false;
+#endif
+  }
+
+  TileCachePainterCairoFactory::TileCachePainterCairoFactory(const StyleConfigRef& styleConfig,
+                                                             TileCache& cache)
+  : styleConfig(styleConfig),
+    cache(cache)
+  {
+    // no code
+  }
+
+  TileCachePainterCairoFactory::~TileCachePainterCairoFactory()
+  {
+    // no code
+  }
+
+  MetaTilePainterRef TileCachePainterCairoFactory::CreatePainter(size_t width,
+                                                                 size_t height)
+  {
+    return new TileCachePainterCairo(styleConfig,
+                                     cache,
+                                     width,
+                                     height);
+  }
+}
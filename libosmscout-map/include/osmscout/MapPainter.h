@@ -21,7 +21,9 @@
 */
 
 #include <list>
+#include <map>
 #include <string>
+#include <vector>
 
 #include <osmscout/private/MapImportExport.h>
 
@@ -75,6 +77,8 @@ namespace osmscout {
 
     bool                         renderSeaLand;      //! Rendering of sea/land tiles
 
+    size_t                       prepareThreads;     //! Number of threads preparing areas and ways for drawing (default 1)
+
     bool                         debugPerformance;   //! Print out some performance information
 
     BreakerRef                   breaker;            //! Breaker to abort processing on external request
@@ -107,6 +111,8 @@ namespace osmscout {
 
     void SetRenderSeaLand(bool render);
 
+    void SetPrepareThreads(size_t threads);
+
     void SetDebugPerformance(bool debug);
 
     void SetBreaker(const BreakerRef& breaker);
@@ -196,6 +202,11 @@ namespace osmscout {
       return renderSeaLand;
     }
 
+    inline size_t GetPrepareThreads() const
+    {
+      return prepareThreads;
+    }
+
     inline bool IsDebugPerformance() const
     {
       return debugPerformance;
@@ -310,6 +321,87 @@ namespace osmscout {
       std::string              text;     //! The label text
     };
 
+  private:
+    /**
+      Draw data and transformed coordinates of a range of areas or ways
+      prepared by one thread
+      */
+    struct PrepareState
+    {
+      TransBuffer               *transBuffer;    //! Buffer for the transformed coordinates
+      std::vector<LineStyleRef> lineStyles;      //! Temporary storage for StyleConfig return value
+      std::list<AreaData>       areaData;
+      std::list<WayData>        wayData;
+      std::list<WayPathData>    wayPathData;
+      size_t                    areasSegments;
+      size_t                    waysSegments;
+
+      PrepareState(TransBuffer* transBuffer)
+      : transBuffer(transBuffer),
+        areasSegments(0),
+        waysSegments(0)
+      {
+        // no code
+      }
+    };
+
+    typedef void (MapPainter::*PrepareFunction)(const StyleConfig& styleConfig,
+                                                const Projection& projection,
+                                                const MapParameter& parameter,
+                                                const MapData& data,
+                                                size_t start,
+                                                size_t end,
+                                                PrepareState& state);
+
+    typedef std::list<LabelData>::iterator LabelRef;
+
+    /**
+      Uniform grid over the drawing area, referencing all labels whose
+      bounding box touches a cell, plus an index of labels by their text.
+      Used to only check the labels near to a new label for collisions
+      instead of all labels registered so far.
+
+      Labels outside the drawing area are stored in the border cells.
+      A label may be returned more than once by GetLabels().
+      */
+    class LabelIndex
+    {
+    private:
+      double                                cellSize;    //! Width and height of a cell in pixel
+      size_t                                xCellCount;  //! Number of cells in horizontal direction
+      size_t                                yCellCount;  //! Number of cells in vertical direction
+      std::vector<std::vector<LabelRef> >   cells;       //! Labels touching the cell
+      std::multimap<std::string,LabelRef>   texts;       //! Labels by text
+
+    private:
+      void GetCellRange(double bx1,
+                        double bx2,
+                        double by1,
+                        double by2,
+                        size_t& cx1,
+                        size_t& cx2,
+                        size_t& cy1,
+                        size_t& cy2) const;
+
+    public:
+      LabelIndex();
+
+      void Initialize(double width,
+                      double height,
+                      double cellSize);
+
+      void Add(const LabelRef& label);
+      void Remove(const LabelRef& label);
+
+      void GetLabels(double bx1,
+                     double bx2,
+                     double by1,
+                     double by2,
+                     std::vector<LabelRef>& result) const;
+      void GetLabels(const std::string& text,
+                     std::vector<LabelRef>& result) const;
+    };
+
   private:
     CoordBuffer               *coordBuffer;
 
@@ -351,10 +443,14 @@ namespace osmscout {
     //@{
     std::list<LabelData>      labels;
     std::list<LabelData>      overlayLabels;
+    LabelIndex                labelIndex;        //! Spatial index of labels
+    LabelIndex                overlayLabelIndex; //! Spatial index of overlayLabels
+    std::vector<LabelRef>     labelCandidates;   //! Labels returned by the index for the current check
+    std::vector<LabelRef>     markedLabels;      //! Labels marked by the current check
     std::vector<ScanCell>     wayScanlines;
     //@}
 
-    std::vector<LineStyleRef> lineStyles;     //! Temporary storage for StyleConfig return value
+    std::vector<TransBuffer*> prepareBuffers; //! Transformation buffers of the preparation threads
     /**
       Statistics counter
      */
@@ -370,6 +466,11 @@ namespace osmscout {
     size_t                    nodesDrawn;
 
     size_t                    labelsDrawn;
+
+    size_t                    labelsPlaced;      //! Point labels registered
+    size_t                    labelsRejected;    //! Point labels rejected because of collisions
+    size_t                    labelsDisplaced;   //! Point labels removed by labels of higher priority
+    double                    labelPlacementTime; //! Time spend in point label placement in milliseconds
     //@}
 
     /**
@@ -412,21 +513,28 @@ namespace osmscout {
      Label placement routines
      */
     //@{
-    void ClearLabelMarks(std::list<LabelData>& labels);
-    void RemoveMarkedLabels(std::list<LabelData>& labels);
+    void ClearLabelMarks();
+    void RemoveMarkedLabels(std::list<LabelData>& labels,
+                            LabelIndex& index);
     bool MarkAllInBoundingBox(double bx1,
                               double bx2,
                               double by1,
                               double by2,
                               const LabelStyle& style,
-                              std::list<LabelData>& labels);
+                              const LabelIndex& index);
     bool MarkCloseLabelsWithSameText(double bx1,
                                      double bx2,
                                      double by1,
                                      double by2,
                                      const LabelStyle& style,
                                      const std::string& text,
-                                     std::list<LabelData>& labels);
+                                     const LabelIndex& index);
+    bool PlacePointLabel(const Projection& projection,
+                         const MapParameter& parameter,
+                         const LabelStyleRef& style,
+                         const std::string& text,
+                         double x,
+                         double y);
     //@}
 
     /**
@@ -441,6 +549,27 @@ namespace osmscout {
                             const AreaAttributes& attributes,
                             const std::vector<GeoCoord>& nodes);*/
 
+    void Prepare(const StyleConfig& styleConfig,
+                 const Projection& projection,
+                 const MapParameter& parameter,
+                 const MapData& data,
+                 size_t count,
+                 PrepareFunction function);
+    void MergePrepareState(PrepareState& state);
+
+    void PrepareArea(const StyleConfig& styleConfig,
+                     const Projection& projection,
+                     const MapParameter& parameter,
+                     const AreaRef& area,
+                     PrepareState& state);
+    void PrepareAreaRange(const StyleConfig& styleConfig,
+                          const Projection& projection,
+                          const MapParameter& parameter,
+                          const MapData& data,
+                          size_t start,
+                          size_t end,
+                          PrepareState& state);
+
     void PrepareAreas(const StyleConfig& styleConfig,
                       const Projection& projection,
                       const MapParameter& parameter,
@@ -451,8 +580,16 @@ namespace osmscout {
                            const MapParameter& parameter,
                            const ObjectFileRef& ref,
                            const FeatureValueBuffer& buffer,
-                           const std::vector<GeoCoord>& nodes,
-                           const std::vector<Id>& ids);
+                           const std::vector<ObjectCoord>& nodes,
+                           const std::vector<Id>& ids,
+                           PrepareState& state);
+    void PrepareWayRange(const StyleConfig& styleConfig,
+                         const Projection& projection,
+                         const MapParameter& parameter,
+                         const MapData& data,
+                         size_t start,
+                         size_t end,
+                         PrepareState& state);
 
     void PrepareWays(const StyleConfig& styleConfig,
                      const Projection& projection,
@@ -516,7 +653,7 @@ namespace osmscout {
      */
     //@{
     bool IsVisible(const Projection& projection,
-                   const std::vector<GeoCoord>& nodes,
+                   const std::vector<ObjectCoord>& nodes,
                    double pixelOffset) const;
 
     void Transform(const Projection& projection,
@@ -526,11 +663,11 @@ namespace osmscout {
                    double& x,
                    double& y);
 
-    bool GetBoundingBox(const std::vector<GeoCoord>& nodes,
+    bool GetBoundingBox(const std::vector<ObjectCoord>& nodes,
                         double& xmin, double& ymin,
                         double& xmax, double& ymax) const;
     bool GetCenterPixel(const Projection& projection,
-                        const std::vector<GeoCoord>& nodes,
+                        const std::vector<ObjectCoord>& nodes,
                         double& cx,
                         double& cy) const;
 
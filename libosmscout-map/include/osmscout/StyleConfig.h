@@ -21,6 +21,7 @@
 */
 
 #include <limits>
+#include <map>
 #include <vector>
 
 #include <osmscout/private/MapImportExport.h>
@@ -37,6 +38,7 @@
 #include <osmscout/Way.h>
 
 #include <osmscout/util/Color.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
 #include <osmscout/util/Transformation.h>
 
@@ -1184,6 +1186,103 @@ namespace osmscout {
   typedef std::list<PathSymbolStyleSelector>                           PathSymbolStyleSelectorList; //! List of selectors
   typedef std::vector<std::vector<PathSymbolStyleSelectorList> >       PathSymbolStyleLookupTable;  //!Index selectors by type and level
 
+  /**
+   * Key of a composed style: The list of style selectors for the type and
+   * magnification level of the object together with the bitmask of the
+   * selectors in the list matching the object.
+   */
+  struct OSMSCOUT_MAP_API StyleCacheKey
+  {
+    const void* selectors; //! The list of selectors
+    uint64_t    matches;   //! Bit n is set, if the n-th selector matches
+
+    inline bool operator<(const StyleCacheKey& other) const
+    {
+      if (selectors!=other.selectors) {
+        return selectors<other.selectors;
+      }
+
+      return matches<other.matches;
+    }
+  };
+
+  /**
+   * Thread safe cache of the styles composed from more than one matching
+   * selector, so that objects resolving to the same set of selectors share
+   * one style instance instead of allocating and composing their own.
+   */
+  template<class S>
+  class StyleCache
+  {
+  private:
+    mutable Mutex                       mutex;
+    std::map<StyleCacheKey,Ref<S> >     styles;
+    size_t                              hits;
+    size_t                              misses;
+
+  public:
+    StyleCache()
+    : hits(0),
+      misses(0)
+    {
+      // no code
+    }
+
+    /**
+     * Return the cached style for the given key in style. Returns false,
+     * if there is no style for the key in the cache.
+     */
+    bool Get(const StyleCacheKey& key,
+             Ref<S>& style)
+    {
+      MutexLocker locker(mutex);
+
+      typename std::map<StyleCacheKey,Ref<S> >::const_iterator entry=styles.find(key);
+
+      if (entry==styles.end()) {
+        misses++;
+        return false;
+      }
+
+      hits++;
+      style=entry->second;
+
+      return true;
+    }
+
+    /**
+     * Store the style for the given key. If another thread stored a style
+     * for the key in the meantime, style is replaced by the cached instance.
+     */
+    void Set(const StyleCacheKey& key,
+             Ref<S>& style)
+    {
+      MutexLocker locker(mutex);
+
+      style=styles.insert(std::make_pair(key,style)).first->second;
+    }
+
+    void Clear()
+    {
+      MutexLocker locker(mutex);
+
+      styles.clear();
+      hits=0;
+      misses=0;
+    }
+
+    void AddStatistics(size_t& hits,
+                       size_t& misses,
+                       size_t& entries) const
+    {
+      MutexLocker locker(mutex);
+
+      hits+=this->hits;
+      misses+=this->misses;
+      entries+=styles.size();
+    }
+  };
+
   /**
    * A complete style definition
    *
@@ -1191,6 +1290,8 @@ namespace osmscout {
    * * Fastpath: Fastpath means, that we can directly return the style definition from the style sheet. This is normally
    * the case, if there is excactly one match in the style sheet. If there are multiple matches a new style has to be
    * allocated and composed from all matches.
+   * * Composed styles are cached by the set of matching selectors, so repeated lookups for objects with the same
+   * relevant features at the same magnification return the same style instance. Style lookup is thread safe.
    */
   class OSMSCOUT_MAP_API StyleConfig : public Referencable
   {
@@ -1248,6 +1349,15 @@ namespace osmscout {
 
     OSMSCOUT_HASHMAP<std::string,StyleVariableRef> variables;
 
+    // Composed styles
+
+    mutable StyleCache<LineStyle>              lineStyleCache;
+    mutable StyleCache<FillStyle>              fillStyleCache;
+    mutable StyleCache<TextStyle>              textStyleCache;
+    mutable StyleCache<IconStyle>              iconStyleCache;
+    mutable StyleCache<PathTextStyle>          pathTextStyleCache;
+    mutable StyleCache<PathSymbolStyle>        pathSymbolStyleCache;
+    mutable StyleCache<PathShieldStyle>        pathShieldStyleCache;
 
   private:
     void GetAllNodeTypes(std::list<TypeId>& types);
@@ -1273,6 +1383,10 @@ namespace osmscout {
 
     void Postprocess();
 
+    void GetStyleCacheStatistics(size_t& hits,
+                                 size_t& misses,
+                                 size_t& entries) const;
+
     TypeConfigRef GetTypeConfig() const;
 
     StyleConfig& SetWayPrio(TypeId type, size_t prio);
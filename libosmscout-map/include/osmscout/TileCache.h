@@ -0,0 +1,201 @@
+#ifndef OSMSCOUT_TILECACHE_H
+#define OSMSCOUT_TILECACHE_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osmscout/private/MapImportExport.h>
+
+#include <osmscout/Types.h>
+
+#include <osmscout/TileRenderer.h>
+
+#include <osmscout/util/Mutex.h>
+
+namespace osmscout {
+
+  /**
+   * Persistent cache for rendered tiles on disk.
+   *
+   * Tiles are stored as opaque, already encoded data (for example PNG or SVG)
+   * in one file per tile. The file name contains a version hash calculated
+   * from the database (path, sizes and modification times of its files),
+   * the content of the style sheet and the DPI. Changing any of these results
+   * in a different version, so tiles of an outdated version are never
+   * returned and are dropped from the cache over time.
+   *
+   * The total size of all tiles is limited, if the limit is exceeded the
+   * least recently used tiles are removed. The cache index (including the
+   * order of usage) is stored in the cache directory on Close(). On Open()
+   * the index is checked against the tile files in the directory, so that
+   * tiles stored after the index was last written (for example because the
+   * application crashed) are still accounted for. Where the directory cannot
+   * be listed, the index is instead written regularly while tiles are stored.
+   *
+   * Tiles are written to a temporary file first, which then replaces the
+   * tile file, so readers never see a partially written tile.
+   *
+   * All methods accessing tiles are thread safe. A cache directory must only
+   * be used by one TileCache instance at a time.
+   */
+  class OSMSCOUT_MAP_API TileCache
+  {
+  private:
+    struct TileKey
+    {
+      uint32_t version;
+      uint32_t zoom;
+      uint32_t x;
+      uint32_t y;
+
+      bool operator<(const TileKey& other) const;
+    };
+
+    struct Entry
+    {
+      TileKey    key;
+      FileOffset size;
+    };
+
+    typedef std::list<Entry>                      EntryList;
+    typedef std::map<TileKey,EntryList::iterator> EntryIndex;
+
+  private:
+    mutable Mutex mutex;
+    bool          isOpen;
+    std::string   directory;     //! Directory holding the tiles and the index
+    uint32_t      version;       //! Version of the current database, style and DPI
+    FileOffset    maxSize;       //! Maximum size of all tiles in bytes
+    FileOffset    size;          //! Current size of all tiles in bytes
+    EntryList     entries;       //! All tiles, most recently used first
+    EntryIndex    index;         //! Lookup of tiles in entries
+    size_t        hits;          //! Number of tiles found in the cache
+    size_t        misses;        //! Number of tiles not found in the cache
+    size_t        tempCount;     //! Number of temporary files created, for unique names
+    size_t        unsavedCount;  //! Number of tiles stored since the index was last written
+
+  private:
+    TileKey GetTileKey(size_t zoom,
+                       size_t x,
+                       size_t y) const;
+    std::string GetTileFilename(const TileKey& key) const;
+
+    void DropEntry(const TileKey& key);
+    void RemoveEntry(EntryList::iterator entry);
+    void RemoveLeastRecentlyUsed();
+
+    bool ReadIndex();
+    bool WriteIndex() const;
+    void SyncIndexWithDirectory();
+
+  public:
+    TileCache();
+    virtual ~TileCache();
+
+    static bool CalculateVersion(const std::string& databaseDirectory,
+                                 const std::string& styleFile,
+                                 double dpi,
+                                 uint32_t& version);
+
+    bool Open(const std::string& directory,
+              const std::string& databaseDirectory,
+              const std::string& styleFile,
+              double dpi,
+              FileOffset maxSize);
+    bool Close();
+
+    inline bool IsOpen() const
+    {
+      return isOpen;
+    }
+
+    inline uint32_t GetVersion() const
+    {
+      return version;
+    }
+
+    bool HasTile(size_t zoom,
+                 size_t x,
+                 size_t y) const;
+    bool GetTile(size_t zoom,
+                 size_t x,
+                 size_t y,
+                 std::vector<char>& data);
+    bool StoreTile(size_t zoom,
+                   size_t x,
+                   size_t y,
+                   const std::vector<char>& data);
+
+    bool Seed(const TileRenderer& renderer,
+              MetaTilePainterFactory& factory,
+              const MapParameter& parameter,
+              const AreaSearchParameter& searchParameter,
+              double lonMin,
+              double latMin,
+              double lonMax,
+              double latMax,
+              size_t startZoom,
+              size_t endZoom,
+              TileRenderer::Statistics& statistics);
+
+    FileOffset GetSize() const;
+    size_t GetTileCount() const;
+    void GetStatistics(size_t& hits,
+                       size_t& misses) const;
+  };
+
+  /**
+   * Base class for MetaTilePainter implementations storing their tiles in a
+   * TileCache. Implementations only have to draw the metatile and to encode
+   * a tile of the drawing.
+   */
+  class OSMSCOUT_MAP_API TileCachePainter : public MetaTilePainter
+  {
+  private:
+    TileCache& cache;
+
+  protected:
+    /**
+     * Encode the tile starting at the given pixel offset in the drawing of
+     * the last metatile.
+     */
+    virtual bool EncodeTile(size_t pixelX,
+                            size_t pixelY,
+                            size_t tileSize,
+                            std::vector<char>& data) = 0;
+
+  public:
+    TileCachePainter(TileCache& cache);
+    virtual ~TileCachePainter();
+
+    bool StoreTile(size_t zoom,
+                   size_t x,
+                   size_t y,
+                   size_t pixelX,
+                   size_t pixelY,
+                   size_t tileSize);
+  };
+}
+
+#endif
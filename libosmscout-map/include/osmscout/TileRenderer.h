@@ -0,0 +1,230 @@
+#ifndef OSMSCOUT_TILERENDERER_H
+#define OSMSCOUT_TILERENDERER_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/private/MapImportExport.h>
+
+#include <osmscout/MapService.h>
+
+#include <osmscout/MapPainter.h>
+#include <osmscout/StyleConfig.h>
+
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/Reference.h>
+
+namespace osmscout {
+
+  /**
+   * A metatile: A square of metaTileSize x metaTileSize slippy map tiles
+   * (see http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames) drawn
+   * at once.
+   */
+  struct OSMSCOUT_MAP_API MetaTile
+  {
+    size_t zoom;     //! Zoom level
+    size_t x;        //! X coordinate of the top left tile
+    size_t y;        //! Y coordinate of the top left tile
+    size_t width;    //! Width of the metatile in tiles
+    size_t height;   //! Height of the metatile in tiles
+  };
+
+  /**
+   * Backend specific part of tile rendering: Drawing a metatile and
+   * storing the tiles cut out of the drawing.
+   *
+   * TileRenderer uses one instance per worker thread, so an instance is
+   * only used by one thread at a time. Instances must not share state
+   * without synchronization.
+   */
+  class OSMSCOUT_MAP_API MetaTilePainter : public Referencable
+  {
+  public:
+    virtual ~MetaTilePainter();
+
+    /**
+     * Draw the given data. The projection covers the metatile plus the
+     * border. Width and height of the projection are never larger than the
+     * size passed to MetaTilePainterFactory::CreatePainter().
+     */
+    virtual bool DrawMetaTile(const MetaTile& metaTile,
+                              const Projection& projection,
+                              const MapParameter& parameter,
+                              const MapData& data) = 0;
+
+    /**
+     * Store the tile with the given coordinates, that starts at the given
+     * pixel offset in the drawing of the last metatile.
+     */
+    virtual bool StoreTile(size_t zoom,
+                           size_t x,
+                           size_t y,
+                           size_t pixelX,
+                           size_t pixelY,
+                           size_t tileSize) = 0;
+  };
+
+  typedef Ref<MetaTilePainter> MetaTilePainterRef;
+
+  /**
+   * Creates the MetaTilePainter instances for the worker threads.
+   * CreatePainter() is only called from the thread calling
+   * TileRenderer::Render().
+   */
+  class OSMSCOUT_MAP_API MetaTilePainterFactory
+  {
+  public:
+    virtual ~MetaTilePainterFactory();
+
+    /**
+     * Create a painter drawing images of the given size in pixel.
+     */
+    virtual MetaTilePainterRef CreatePainter(size_t width,
+                                             size_t height) = 0;
+  };
+
+  /**
+   * Renders all slippy map tiles in a given range: The tiles are grouped into
+   * metatiles, the data for all tiles of a metatile is loaded and drawn at once
+   * and the resulting drawing is split into tiles afterwards. Metatiles are
+   * distributed over a number of worker threads, each thread using its own
+   * painter.
+   *
+   * Database, MapService and StyleConfig are shared between all threads.
+   */
+  class OSMSCOUT_MAP_API TileRenderer
+  {
+  public:
+    /**
+     * Time spent in one stage of rendering a metatile
+     */
+    struct OSMSCOUT_MAP_API StageStatistics
+    {
+      size_t count;     //! Number of metatiles
+      double minTime;   //! Minimum time in milliseconds
+      double maxTime;   //! Maximum time in milliseconds
+      double totalTime; //! Sum of all times in milliseconds
+
+      StageStatistics();
+
+      void Add(double time);
+      void Add(const StageStatistics& other);
+
+      inline double GetAverageTime() const
+      {
+        return count>0 ? totalTime/count : 0.0;
+      }
+    };
+
+    struct OSMSCOUT_MAP_API Statistics
+    {
+      size_t          metaTileCount; //! Number of metatiles rendered
+      size_t          tileCount;     //! Number of tiles stored
+      double          time;          //! Wall clock time in milliseconds
+      StageStatistics dataStage;     //! Loading the data of a metatile
+      StageStatistics drawStage;     //! Drawing a metatile
+      StageStatistics storeStage;    //! Splitting a metatile into tiles and storing them
+
+      Statistics();
+
+      inline double GetTilesPerSecond() const
+      {
+        return time>0.0 ? tileCount*1000.0/time : 0.0;
+      }
+    };
+
+  private:
+    MapServiceRef       mapService;
+    StyleConfigRef      styleConfig;
+    size_t              tileSize;      //! Width and height of a tile in pixel (default 256)
+    size_t              metaTileSize;  //! Width and height of a metatile in tiles (default 8)
+    size_t              border;        //! Additional border around metatiles in pixel (default 0)
+    size_t              threadCount;   //! Number of worker threads (default 1)
+
+  private:
+    bool RenderMetaTile(const MapParameter& parameter,
+                        const AreaSearchParameter& searchParameter,
+                        MetaTilePainter& painter,
+                        const MetaTile& metaTile,
+                        size_t xStart,
+                        size_t yStart,
+                        size_t xEnd,
+                        size_t yEnd,
+                        Statistics& statistics) const;
+
+    void RenderMetaTiles(const MapParameter& parameter,
+                         const AreaSearchParameter& searchParameter,
+                         MetaTilePainterRef painter,
+                         const std::vector<MetaTile>& metaTiles,
+                         Mutex* mutex,
+                         size_t* nextMetaTile,
+                         bool* success,
+                         size_t xStart,
+                         size_t yStart,
+                         size_t xEnd,
+                         size_t yEnd,
+                         Statistics* statistics) const;
+
+  public:
+    TileRenderer(const MapServiceRef& mapService,
+                 const StyleConfigRef& styleConfig);
+    virtual ~TileRenderer();
+
+    void SetTileSize(size_t tileSize);
+    void SetMetaTileSize(size_t metaTileSize);
+    void SetBorder(size_t border);
+    void SetThreadCount(size_t threadCount);
+
+    inline size_t GetTileSize() const
+    {
+      return tileSize;
+    }
+
+    inline size_t GetMetaTileSize() const
+    {
+      return metaTileSize;
+    }
+
+    inline size_t GetBorder() const
+    {
+      return border;
+    }
+
+    inline size_t GetThreadCount() const
+    {
+      return threadCount;
+    }
+
+    bool Render(MetaTilePainterFactory& factory,
+                const MapParameter& parameter,
+                const AreaSearchParameter& searchParameter,
+                size_t zoom,
+                size_t xStart,
+                size_t yStart,
+                size_t xEnd,
+                size_t yEnd,
+                Statistics& statistics) const;
+  };
+}
+
+#endif
@@ -19,9 +19,18 @@
 
 #include <osmscout/MapPainter.h>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <limits>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <functional>
+#include <thread>
+#endif
+
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/HashSet.h>
@@ -77,6 +86,7 @@ namespace osmscout {
     sameLabelSpace(40.0),
     dropNotVisiblePointLabels(true),
     renderSeaLand(false),
+    prepareThreads(1),
     debugPerformance(false)
   {
     // no code
@@ -168,6 +178,11 @@ namespace osmscout {
     this->renderSeaLand=render;
   }
 
+  void MapParameter::SetPrepareThreads(size_t threads)
+  {
+    this->prepareThreads=threads;
+  }
+
   void MapParameter::SetDebugPerformance(bool debug)
   {
     debugPerformance=debug;
@@ -214,11 +229,15 @@ namespace osmscout {
 
   MapPainter::~MapPainter()
   {
-    // no code
+    for (std::vector<TransBuffer*>::iterator buffer=prepareBuffers.begin();
+         buffer!=prepareBuffers.end();
+         ++buffer) {
+      delete *buffer;
+    }
   }
 
   bool MapPainter::IsVisible(const Projection& projection,
-                             const std::vector<GeoCoord>& nodes,
+                             const std::vector<ObjectCoord>& nodes,
                              double pixelOffset) const
   {
     if (nodes.empty()) {
@@ -297,40 +316,211 @@ namespace osmscout {
     }
   }
 
-  void MapPainter::ClearLabelMarks(std::list<LabelData>& labels)
+  /**
+   * Return the index of the cell the given coordinate is in, coordinates
+   * outside the grid are clipped to the border cells.
+   */
+  static inline size_t GetLabelCell(double value,
+                                    double cellSize,
+                                    size_t cellCount)
   {
-    for (std::list<LabelData>::iterator label=labels.begin();
-         label!=labels.end();
-         ++label) {
-      label->mark=false;
+    if (!(value>0.0)) {
+      return 0;
+    }
+
+    double cell=value/cellSize;
+
+    if (cell>=cellCount-1) {
+      return cellCount-1;
     }
+
+    return (size_t)cell;
   }
 
-  void MapPainter::RemoveMarkedLabels(std::list<LabelData>& labels)
+  MapPainter::LabelIndex::LabelIndex()
+  : cellSize(1.0),
+    xCellCount(1),
+    yCellCount(1)
   {
-    std::list<LabelData>::iterator label=labels.begin();
+    cells.resize(1);
+  }
 
-    while (label!=labels.end()) {
-      if (label->mark) {
-        label=labels.erase(label);
+  /**
+   * Remove all labels and set up a grid with cells of the given size (in pixel)
+   * covering a drawing area of the given dimension.
+   */
+  void MapPainter::LabelIndex::Initialize(double width,
+                                          double height,
+                                          double cellSize)
+  {
+    this->cellSize=cellSize;
+
+    xCellCount=std::max((size_t)1,(size_t)ceil(width/cellSize));
+    yCellCount=std::max((size_t)1,(size_t)ceil(height/cellSize));
+
+    for (std::vector<std::vector<LabelRef> >::iterator cell=cells.begin();
+         cell!=cells.end();
+         ++cell) {
+      cell->clear();
+    }
+
+    cells.resize(xCellCount*yCellCount);
+    texts.clear();
+  }
+
+  void MapPainter::LabelIndex::GetCellRange(double bx1,
+                                            double bx2,
+                                            double by1,
+                                            double by2,
+                                            size_t& cx1,
+                                            size_t& cx2,
+                                            size_t& cy1,
+                                            size_t& cy2) const
+  {
+    cx1=GetLabelCell(bx1,cellSize,xCellCount);
+    cx2=GetLabelCell(bx2,cellSize,xCellCount);
+    cy1=GetLabelCell(by1,cellSize,yCellCount);
+    cy2=GetLabelCell(by2,cellSize,yCellCount);
+  }
+
+  void MapPainter::LabelIndex::Add(const LabelRef& label)
+  {
+    size_t cx1,cx2,cy1,cy2;
+
+    GetCellRange(label->bx1,label->bx2,label->by1,label->by2,
+                 cx1,cx2,cy1,cy2);
+
+    for (size_t y=cy1; y<=cy2; y++) {
+      for (size_t x=cx1; x<=cx2; x++) {
+        cells[y*xCellCount+x].push_back(label);
       }
-      else {
-        ++label;
+    }
+
+    texts.insert(std::make_pair(label->text,label));
+  }
+
+  void MapPainter::LabelIndex::Remove(const LabelRef& label)
+  {
+    size_t cx1,cx2,cy1,cy2;
+
+    GetCellRange(label->bx1,label->bx2,label->by1,label->by2,
+                 cx1,cx2,cy1,cy2);
+
+    for (size_t y=cy1; y<=cy2; y++) {
+      for (size_t x=cx1; x<=cx2; x++) {
+        std::vector<LabelRef>&          cell=cells[y*xCellCount+x];
+        std::vector<LabelRef>::iterator entry=std::find(cell.begin(),
+                                                        cell.end(),
+                                                        label);
+
+        if (entry!=cell.end()) {
+          cell.erase(entry);
+        }
+      }
+    }
+
+    std::pair<std::multimap<std::string,LabelRef>::iterator,
+              std::multimap<std::string,LabelRef>::iterator> range=texts.equal_range(label->text);
+
+    for (std::multimap<std::string,LabelRef>::iterator entry=range.first;
+         entry!=range.second;
+         ++entry) {
+      if (entry->second==label) {
+        texts.erase(entry);
+        break;
+      }
+    }
+  }
+
+  /**
+   * Append all labels, that possibly intersect the given bounding box, to result.
+   */
+  void MapPainter::LabelIndex::GetLabels(double bx1,
+                                         double bx2,
+                                         double by1,
+                                         double by2,
+                                         std::vector<LabelRef>& result) const
+  {
+    size_t cx1,cx2,cy1,cy2;
+
+    GetCellRange(bx1,bx2,by1,by2,
+                 cx1,cx2,cy1,cy2);
+
+    for (size_t y=cy1; y<=cy2; y++) {
+      for (size_t x=cx1; x<=cx2; x++) {
+        const std::vector<LabelRef>& cell=cells[y*xCellCount+x];
+
+        result.insert(result.end(),
+                      cell.begin(),
+                      cell.end());
       }
     }
   }
 
+  /**
+   * Append all labels with the given text to result.
+   */
+  void MapPainter::LabelIndex::GetLabels(const std::string& text,
+                                         std::vector<LabelRef>& result) const
+  {
+    std::pair<std::multimap<std::string,LabelRef>::const_iterator,
+              std::multimap<std::string,LabelRef>::const_iterator> range=texts.equal_range(text);
+
+    for (std::multimap<std::string,LabelRef>::const_iterator entry=range.first;
+         entry!=range.second;
+         ++entry) {
+      result.push_back(entry->second);
+    }
+  }
+
+  void MapPainter::ClearLabelMarks()
+  {
+    for (std::vector<LabelRef>::const_iterator label=markedLabels.begin();
+         label!=markedLabels.end();
+         ++label) {
+      (*label)->mark=false;
+    }
+
+    markedLabels.clear();
+  }
+
+  void MapPainter::RemoveMarkedLabels(std::list<LabelData>& labels,
+                                      LabelIndex& index)
+  {
+    for (std::vector<LabelRef>::const_iterator label=markedLabels.begin();
+         label!=markedLabels.end();
+         ++label) {
+      index.Remove(*label);
+      labels.erase(*label);
+    }
+
+    labelsDisplaced+=markedLabels.size();
+
+    markedLabels.clear();
+  }
+
   bool MapPainter::MarkAllInBoundingBox(double bx1,
                                         double bx2,
                                         double by1,
                                         double by2,
                                         const LabelStyle& style,
-                                        std::list<LabelData>& labels)
+                                        const LabelIndex& index)
   {
-    for (std::list<LabelData>::iterator l=labels.begin();
-        l!=labels.end();
+    // GetLabelSpace() returns one of both values
+    double maxLabelSpace=std::max(labelSpace,shieldLabelSpace);
+
+    labelCandidates.clear();
+
+    index.GetLabels(bx1-maxLabelSpace,
+                    bx2+maxLabelSpace,
+                    by1-maxLabelSpace,
+                    by2+maxLabelSpace,
+                    labelCandidates);
+
+    for (std::vector<LabelRef>::const_iterator l=labelCandidates.begin();
+        l!=labelCandidates.end();
         ++l) {
-      LabelData& label=*l;
+      LabelData& label=**l;
 
       // We only look at labels, that are not already marked.
       if (label.mark) {
@@ -366,6 +556,7 @@ namespace osmscout {
         }
 
         label.mark=true;
+        markedLabels.push_back(*l);
       }
     }
 
@@ -378,19 +569,27 @@ namespace osmscout {
                                                double by2,
                                                const LabelStyle& style,
                                                const std::string& text,
-                                               std::list<LabelData>& labels)
+                                               const LabelIndex& index)
   {
-    for (std::list<LabelData>::iterator l=labels.begin();
-        l!=labels.end();
+    if (dynamic_cast<const ShieldStyle*>(&style)==NULL) {
+      return true;
+    }
+
+    labelCandidates.clear();
+
+    index.GetLabels(text,
+                    labelCandidates);
+
+    for (std::vector<LabelRef>::const_iterator l=labelCandidates.begin();
+        l!=labelCandidates.end();
         ++l) {
-      LabelData& label=*l;
+      const LabelData& label=**l;
 
       if (label.mark) {
         continue;
       }
 
-      if (dynamic_cast<const ShieldStyle*>(&style)!=NULL &&
-          dynamic_cast<const ShieldStyle*>(label.style.Get())!=NULL) {
+      if (dynamic_cast<const ShieldStyle*>(label.style.Get())!=NULL) {
         double hx1=bx1-sameLabelSpace;
         double hx2=bx2+sameLabelSpace;
         double hy1=by1-sameLabelSpace;
@@ -400,13 +599,11 @@ namespace osmscout {
               hx2<label.bx1 ||
               hy1>label.by2 ||
               hy2<label.by1)) {
-          if (text==label.text) {
-            // TODO: It may be possible that the labels belong to the same "thing".
-            // perhaps we should not just draw one or the other, but also change
-            // final position of the label (but this would require more complex
-            // collision handling and perhaps processing labels in different order)?
-            return false;
-          }
+          // TODO: It may be possible that the labels belong to the same "thing".
+          // perhaps we should not just draw one or the other, but also change
+          // final position of the label (but this would require more complex
+          // collision handling and perhaps processing labels in different order)?
+          return false;
         }
       }
     }
@@ -425,7 +622,7 @@ namespace osmscout {
                           x,y);
   }
 
-  bool MapPainter::GetBoundingBox(const std::vector<GeoCoord>& nodes,
+  bool MapPainter::GetBoundingBox(const std::vector<ObjectCoord>& nodes,
                                   double& xmin, double& ymin,
                                   double& xmax, double& ymax) const
   {
@@ -449,7 +646,7 @@ namespace osmscout {
   }
 
   bool MapPainter::GetCenterPixel(const Projection& projection,
-                                  const std::vector<GeoCoord>& nodes,
+                                  const std::vector<ObjectCoord>& nodes,
                                   double& cx,
                                   double& cy) const
   {
@@ -758,9 +955,11 @@ namespace osmscout {
       labelData.alpha=0.5;
       labelData.fontSize=1.2;
       labelData.style=debugLabel;
+      labelData.mark=false;
       labelData.text=label;
 
-      labels.push_back(labelData);
+      labelIndex.Add(labels.insert(labels.end(),
+                                   labelData));
 
       drawnLabels.insert(Coord(x,y));
 #endif
@@ -794,12 +993,12 @@ namespace osmscout {
     }
   }
 
-  bool MapPainter::RegisterPointLabel(const Projection& projection,
-                                      const MapParameter& parameter,
-                                      const LabelStyleRef& style,
-                                      const std::string& text,
-                                      double x,
-                                      double y)
+  bool MapPainter::PlacePointLabel(const Projection& projection,
+                                   const MapParameter& parameter,
+                                   const LabelStyleRef& style,
+                                   const std::string& text,
+                                   double x,
+                                   double y)
   {
     double fontSize=style->GetSize();
     double a=style->GetAlpha();
@@ -811,16 +1010,9 @@ namespace osmscout {
                                  a);
 
     // Something is an overlay, if its alpha is <0.8
-    bool overlay=a<0.8;
-
-    // Reset all marks on labels, because we needs marks
-    // for our internal collision handling
-    if (overlay) {
-      ClearLabelMarks(overlayLabels);
-    }
-    else {
-      ClearLabelMarks(labels);
-    }
+    bool                  overlay=a<0.8;
+    std::list<LabelData>& layerLabels=overlay ? overlayLabels : labels;
+    LabelIndex&           layerIndex=overlay ? overlayLabelIndex : labelIndex;
 
     // First rough minimum bounding box, estimated without calculating text dimensions (since this is expensive).
     double bx1;
@@ -840,19 +1032,10 @@ namespace osmscout {
     by1=y-fontSize/2-frameVert;
     by2=y+fontSize/2+frameVert;
 
-    if (overlay) {
-      if (!MarkAllInBoundingBox(bx1,bx2,by1,by2,
-                                *style,
-                                overlayLabels)) {
-        return false;
-      }
-    }
-    else {
-      if (!MarkAllInBoundingBox(bx1,bx2,by1,by2,
-                                *style,
-                                labels)) {
-        return false;
-      }
+    if (!MarkAllInBoundingBox(bx1,bx2,by1,by2,
+                              *style,
+                              layerIndex)) {
+      return false;
     }
 
     // We passed the first intersection test, we now calculate the real bounding box
@@ -880,62 +1063,36 @@ namespace osmscout {
       }
     }
 
-    if (overlay) {
-      if (!MarkAllInBoundingBox(bx1,bx2,by1,by2,
-                                *style,
-                                overlayLabels)) {
-        return false;
-      }
-
-      // As an optional final processing step, we check if labels
-      // with the same value (text) have at least sameLabelSpace distance.
-      if (sameLabelSpace>shieldLabelSpace) {
-        if (!MarkCloseLabelsWithSameText(bx1,
-                                         bx2,
-                                         by1,
-                                         by2,
-                                         *style,
-                                         text,
-                                         overlayLabels)) {
-          return false;
-        }
-      }
-
-      // Remove every marked (aka "in conflict" or "intersecting but of lower
-      // priority") label.
-      RemoveMarkedLabels(overlayLabels);
+    if (!MarkAllInBoundingBox(bx1,bx2,by1,by2,
+                              *style,
+                              layerIndex)) {
+      return false;
     }
-    else {
-      if (!MarkAllInBoundingBox(bx1,bx2,by1,by2,
-                                *style,
-                                labels)) {
-        return false;
-      }
 
-      // As an optional final processing step, we check if labels
-      // with the same value (text) have at least sameLabelSpace distance.
-      if (sameLabelSpace>shieldLabelSpace) {
-        if (!MarkCloseLabelsWithSameText(bx1,
-                                         bx2,
-                                         by1,
-                                         by2,
-                                         *style,
-                                         text,
-                                         labels)) {
-          return false;
-        }
+    // As an optional final processing step, we check if labels
+    // with the same value (text) have at least sameLabelSpace distance.
+    if (sameLabelSpace>shieldLabelSpace) {
+      if (!MarkCloseLabelsWithSameText(bx1,
+                                       bx2,
+                                       by1,
+                                       by2,
+                                       *style,
+                                       text,
+                                       layerIndex)) {
+        return false;
       }
-
-      // Remove every marked (aka "in conflict" or "intersecting but of lower
-      // priority") label.
-      RemoveMarkedLabels(labels);
     }
 
+    // Remove every marked (aka "in conflict" or "intersecting but of lower
+    // priority") label.
+    RemoveMarkedLabels(layerLabels,
+                       layerIndex);
 
     // We passed the test, lets put ourself into the "draw label" job list
 
     LabelData label;
 
+    label.mark=false;
     label.x=x-width/2;
     label.y=y-height/2;
     label.bx1=bx1;
@@ -947,14 +1104,53 @@ namespace osmscout {
     label.style=style;
     label.text=text;
 
-    if (overlay) {
-      overlayLabels.push_back(label);
+    layerIndex.Add(layerLabels.insert(layerLabels.end(),
+                                      label));
+
+    return true;
+  }
+
+  bool MapPainter::RegisterPointLabel(const Projection& projection,
+                                      const MapParameter& parameter,
+                                      const LabelStyleRef& style,
+                                      const std::string& text,
+                                      double x,
+                                      double y)
+  {
+    bool placed;
+
+    if (parameter.IsDebugPerformance()) {
+      StopClock placementTimer;
+
+      placed=PlacePointLabel(projection,
+                             parameter,
+                             style,
+                             text,
+                             x,y);
+
+      placementTimer.Stop();
+
+      labelPlacementTime+=placementTimer.GetMilliseconds();
     }
     else {
-      labels.push_back(label);
+      placed=PlacePointLabel(projection,
+                             parameter,
+                             style,
+                             text,
+                             x,y);
     }
 
-    return true;
+    // Labels marked by a failed check stay in place
+    ClearLabelMarks();
+
+    if (placed) {
+      labelsPlaced++;
+    }
+    else {
+      labelsRejected++;
+    }
+
+    return placed;
   }
 
   void MapPainter::DrawNodes(const StyleConfig& styleConfig,
@@ -1450,117 +1646,274 @@ namespace osmscout {
     }
   }
 
-  void MapPainter::PrepareAreas(const StyleConfig& styleConfig,
-                                const Projection& projection,
-                                const MapParameter& parameter,
-                                const MapData& data)
+  /**
+   * Prepare the given number of objects by calling the given function for
+   * ranges of objects. If more than one thread is configured, the objects are
+   * split into consecutive ranges, each range prepared by its own thread into
+   * its own transformation buffer. The results are merged in the order of the
+   * ranges afterwards, so the result is identical to the serial preparation.
+   */
+  void MapPainter::Prepare(const StyleConfig& styleConfig,
+                           const Projection& projection,
+                           const MapParameter& parameter,
+                           const MapData& data,
+                           size_t count,
+                           PrepareFunction function)
   {
-    areaData.clear();
+    // Do not start threads for only a few objects
+    size_t threadCount=std::min(parameter.GetPrepareThreads(),
+                                count/64);
 
-    //Areas
-    for (std::vector<AreaRef>::const_iterator a=data.areas.begin();
-         a!=data.areas.end();
-         ++a) {
-      const AreaRef& area=*a;
+#if defined(OSMSCOUT_HAVE_THREAD)
+    if (threadCount>1) {
+      std::vector<PrepareState> states;
+      std::vector<std::thread>  threads(threadCount-1);
 
-      std::vector<PolyData> data(area->rings.size());
+      while (prepareBuffers.size()<threadCount) {
+        prepareBuffers.push_back(new TransBuffer(new CoordBufferImpl<Vertex2D>()));
+      }
 
-      for (size_t i=0; i<area->rings.size(); i++) {
-        if (area->rings[i].ring==Area::masterRingId) {
-          continue;
+      states.reserve(threadCount);
+
+      for (size_t t=0; t<threadCount; t++) {
+        prepareBuffers[t]->Reset();
+        states.push_back(PrepareState(prepareBuffers[t]));
+      }
+
+      // The first range is prepared by the current thread
+      for (size_t t=1; t<threadCount; t++) {
+        threads[t-1]=std::thread(function,
+                                 this,
+                                 std::cref(styleConfig),
+                                 std::cref(projection),
+                                 std::cref(parameter),
+                                 std::cref(data),
+                                 t*count/threadCount,
+                                 (t+1)*count/threadCount,
+                                 std::ref(states[t]));
+      }
+
+      (this->*function)(styleConfig,
+                        projection,
+                        parameter,
+                        data,
+                        0,
+                        count/threadCount,
+                        states[0]);
+
+      for (size_t t=0; t<threads.size(); t++) {
+        threads[t].join();
+      }
+
+      for (size_t t=0; t<threadCount; t++) {
+        MergePrepareState(states[t]);
+      }
+
+      return;
+    }
+#endif
+
+    PrepareState state(&transBuffer);
+
+    (this->*function)(styleConfig,
+                      projection,
+                      parameter,
+                      data,
+                      0,
+                      count,
+                      state);
+
+    MergePrepareState(state);
+  }
+
+  /**
+   * Append the result of a preparation step to the draw data. Coordinates
+   * from another transformation buffer are appended to the transformation
+   * buffer of the painter, and the references to them are moved accordingly.
+   */
+  void MapPainter::MergePrepareState(PrepareState& state)
+  {
+    if (state.transBuffer!=&transBuffer) {
+      CoordBufferImpl<Vertex2D>* buffer=(CoordBufferImpl<Vertex2D>*)state.transBuffer->buffer;
+      size_t                     offset=transBuffer.buffer->GetLength();
+
+      for (size_t i=0; i<buffer->GetLength(); i++) {
+        transBuffer.buffer->PushCoord(buffer->buffer[i].GetX(),
+                                      buffer->buffer[i].GetY());
+      }
+
+      for (std::list<AreaData>::iterator area=state.areaData.begin();
+           area!=state.areaData.end();
+           ++area) {
+        area->transStart+=offset;
+        area->transEnd+=offset;
+
+        for (std::list<PolyData>::iterator clipping=area->clippings.begin();
+             clipping!=area->clippings.end();
+             ++clipping) {
+          clipping->transStart+=offset;
+          clipping->transEnd+=offset;
         }
+      }
 
-        transBuffer.TransformArea(projection,
-                                  parameter.GetOptimizeAreaNodes(),
-                                  area->rings[i].nodes,
-                                  data[i].transStart,data[i].transEnd,
-                                  parameter.GetOptimizeErrorToleranceDots());
+      for (std::list<WayData>::iterator way=state.wayData.begin();
+           way!=state.wayData.end();
+           ++way) {
+        way->transStart+=offset;
+        way->transEnd+=offset;
       }
 
-      size_t ringId=Area::outerRingId;
-      bool foundRing=true;
+      for (std::list<WayPathData>::iterator path=state.wayPathData.begin();
+           path!=state.wayPathData.end();
+           ++path) {
+        path->transStart+=offset;
+        path->transEnd+=offset;
+      }
+    }
 
-      while (foundRing) {
-        foundRing=false;
+    areaData.splice(areaData.end(),state.areaData);
+    wayData.splice(wayData.end(),state.wayData);
+    wayPathData.splice(wayPathData.end(),state.wayPathData);
 
-        for (size_t i=0; i<area->rings.size(); i++) {
-          const Area::Ring& ring=area->rings[i];
+    areasSegments+=state.areasSegments;
+    waysSegments+=state.waysSegments;
+  }
 
-          if (ring.ring==ringId) {
-            FillStyleRef fillStyle;
+  void MapPainter::PrepareArea(const StyleConfig& styleConfig,
+                               const Projection& projection,
+                               const MapParameter& parameter,
+                               const AreaRef& area,
+                               PrepareState& state)
+  {
+    std::vector<PolyData> data(area->rings.size());
 
-            if (ring.ring==Area::outerRingId) {
-              styleConfig.GetAreaFillStyle(area->GetType(),
-                                           ring.GetFeatureValueBuffer(),
-                                           projection,
-                                           parameter.GetDPI(),
-                                           fillStyle);
-            }
-            else if (ring.GetType()->GetId()!=typeIgnore) {
-              styleConfig.GetAreaFillStyle(ring.GetType(),
-                                           ring.GetFeatureValueBuffer(),
-                                           projection,
-                                           parameter.GetDPI(),
-                                           fillStyle);
-            }
+    for (size_t i=0; i<area->rings.size(); i++) {
+      if (area->rings[i].ring==Area::masterRingId) {
+        continue;
+      }
 
-            if (fillStyle.Invalid())
-            {
-              continue;
-            }
+      state.transBuffer->TransformArea(projection,
+                                       parameter.GetOptimizeAreaNodes(),
+                                       area->rings[i].nodes,
+                                       data[i].transStart,data[i].transEnd,
+                                       parameter.GetOptimizeErrorToleranceDots());
+    }
 
-            foundRing=true;
+    size_t ringId=Area::outerRingId;
+    bool foundRing=true;
 
-            if (!IsVisible(projection,
-                           ring.nodes,
-                           fillStyle->GetBorderWidth()/2)) {
-              continue;
-            }
+    while (foundRing) {
+      foundRing=false;
 
-            AreaData a;
-
-            // Collect possible clippings. We only take into account, inner rings of the next level
-            // that do not have a type and thus act as a clipping region. If a inner ring has a type,
-            // we currently assume that it does not have alpha and paints over its region and clipping is
-            // not required.
-            // Since we know that rings a created deep first, we only take into account direct followers
-            // in the list with ring+1.
-            size_t j=i+1;
-            while (j<area->rings.size() &&
-                   area->rings[j].ring==ringId+1 &&
-                   area->rings[j].GetType()->GetId()==typeIgnore) {
-              a.clippings.push_back(data[j]);
-
-              j++;
-            }
+      for (size_t i=0; i<area->rings.size(); i++) {
+        const Area::Ring& ring=area->rings[i];
 
-            a.ref=ObjectFileRef(area->GetFileOffset(),refArea);
-            a.buffer=&ring.GetFeatureValueBuffer();
-            a.fillStyle=fillStyle;
-            a.transStart=data[i].transStart;
-            a.transEnd=data[i].transEnd;
-
-            a.minLat=ring.nodes[0].GetLat();
-            a.maxLat=ring.nodes[0].GetLat();
-            a.maxLon=ring.nodes[0].GetLon();
-            a.minLon=ring.nodes[0].GetLon();
-
-            for (size_t i=1; i<ring.nodes.size(); i++) {
-              a.minLat=std::min(a.minLat,ring.nodes[i].GetLat());
-              a.maxLat=std::min(a.maxLat,ring.nodes[i].GetLat());
-              a.minLon=std::min(a.minLon,ring.nodes[i].GetLon());
-              a.maxLon=std::min(a.maxLon,ring.nodes[i].GetLon());
-            }
+        if (ring.ring==ringId) {
+          FillStyleRef fillStyle;
 
-            areaData.push_back(a);
+          if (ring.ring==Area::outerRingId) {
+            styleConfig.GetAreaFillStyle(area->GetType(),
+                                         ring.GetFeatureValueBuffer(),
+                                         projection,
+                                         parameter.GetDPI(),
+                                         fillStyle);
+          }
+          else if (ring.GetType()->GetId()!=typeIgnore) {
+            styleConfig.GetAreaFillStyle(ring.GetType(),
+                                         ring.GetFeatureValueBuffer(),
+                                         projection,
+                                         parameter.GetDPI(),
+                                         fillStyle);
+          }
 
-            areasSegments++;
+          if (fillStyle.Invalid())
+          {
+            continue;
           }
-        }
 
-        ringId++;
+          foundRing=true;
+
+          if (!IsVisible(projection,
+                         ring.nodes,
+                         fillStyle->GetBorderWidth()/2)) {
+            continue;
+          }
+
+          AreaData a;
+
+          // Collect possible clippings. We only take into account, inner rings of the next level
+          // that do not have a type and thus act as a clipping region. If a inner ring has a type,
+          // we currently assume that it does not have alpha and paints over its region and clipping is
+          // not required.
+          // Since we know that rings a created deep first, we only take into account direct followers
+          // in the list with ring+1.
+          size_t j=i+1;
+          while (j<area->rings.size() &&
+                 area->rings[j].ring==ringId+1 &&
+                 area->rings[j].GetType()->GetId()==typeIgnore) {
+            a.clippings.push_back(data[j]);
+
+            j++;
+          }
+
+          a.ref=ObjectFileRef(area->GetFileOffset(),refArea);
+          a.buffer=&ring.GetFeatureValueBuffer();
+          a.fillStyle=fillStyle;
+          a.transStart=data[i].transStart;
+          a.transEnd=data[i].transEnd;
+
+          a.minLat=ring.nodes[0].GetLat();
+          a.maxLat=ring.nodes[0].GetLat();
+          a.maxLon=ring.nodes[0].GetLon();
+          a.minLon=ring.nodes[0].GetLon();
+
+          for (size_t i=1; i<ring.nodes.size(); i++) {
+            a.minLat=std::min(a.minLat,ring.nodes[i].GetLat());
+            a.maxLat=std::min(a.maxLat,ring.nodes[i].GetLat());
+            a.minLon=std::min(a.minLon,ring.nodes[i].GetLon());
+            a.maxLon=std::min(a.maxLon,ring.nodes[i].GetLon());
+          }
+
+          state.areaData.push_back(a);
+
+          state.areasSegments++;
+        }
       }
+
+      ringId++;
     }
+  }
+
+  void MapPainter::PrepareAreaRange(const StyleConfig& styleConfig,
+                                    const Projection& projection,
+                                    const MapParameter& parameter,
+                                    const MapData& data,
+                                    size_t start,
+                                    size_t end,
+                                    PrepareState& state)
+  {
+    for (size_t a=start; a<end; a++) {
+      PrepareArea(styleConfig,
+                  projection,
+                  parameter,
+                  data.areas[a],
+                  state);
+    }
+  }
+
+  void MapPainter::PrepareAreas(const StyleConfig& styleConfig,
+                                const Projection& projection,
+                                const MapParameter& parameter,
+                                const MapData& data)
+  {
+    areaData.clear();
+
+    Prepare(styleConfig,
+            projection,
+            parameter,
+            data,
+            data.areas.size(),
+            &MapPainter::PrepareAreaRange);
 
     areaData.sort(AreaSorter);
   }
@@ -1570,15 +1923,16 @@ namespace osmscout {
                                      const MapParameter& parameter,
                                      const ObjectFileRef& ref,
                                      const FeatureValueBuffer& buffer,
-                                     const std::vector<GeoCoord>& nodes,
-                                     const std::vector<Id>& ids)
+                                     const std::vector<ObjectCoord>& nodes,
+                                     const std::vector<Id>& ids,
+                                     PrepareState& state)
   {
     styleConfig.GetWayLineStyles(buffer,
                                  projection,
                                  parameter.GetDPI(),
-                                 lineStyles);
+                                 state.lineStyles);
 
-    if (lineStyles.empty()) {
+    if (state.lineStyles.empty()) {
       return;
     }
 
@@ -1586,8 +1940,8 @@ namespace osmscout {
     size_t transStart=0; // Make the compiler happy
     size_t transEnd=0;   // Make the compiler happy
 
-    for (std::vector<LineStyleRef>::const_iterator ls=lineStyles.begin();
-         ls!=lineStyles.end();
+    for (std::vector<LineStyleRef>::const_iterator ls=state.lineStyles.begin();
+         ls!=state.lineStyles.end();
          ++ls) {
       LineStyleRef lineStyle(*ls);
       double       lineWidth=0.0;
@@ -1638,12 +1992,12 @@ namespace osmscout {
       }
 
       if (!transformed) {
-        transBuffer.TransformWay(projection,
-                                 parameter.GetOptimizeWayNodes(),
-                                 nodes,
-                                 transStart,
-                                 transEnd,
-                                 parameter.GetOptimizeErrorToleranceDots());
+        state.transBuffer->TransformWay(projection,
+                                        parameter.GetOptimizeWayNodes(),
+                                        nodes,
+                                        transStart,
+                                        transEnd,
+                                        parameter.GetOptimizeErrorToleranceDots());
 
         WayPathData pathData;
 
@@ -1652,7 +2006,7 @@ namespace osmscout {
         pathData.transStart=transStart;
         pathData.transEnd=transEnd;
 
-        wayPathData.push_back(pathData);
+        state.wayPathData.push_back(pathData);
 
         transformed=true;
       }
@@ -1671,33 +2025,37 @@ namespace osmscout {
       }
 
       if (lineOffset!=0.0) {
-        coordBuffer->GenerateParallelWay(transStart,transEnd,
-                                         lineOffset,
-                                         data.transStart,
-                                         data.transEnd);
+        state.transBuffer->buffer->GenerateParallelWay(transStart,transEnd,
+                                                       lineOffset,
+                                                       data.transStart,
+                                                       data.transEnd);
       }
       else {
         data.transStart=transStart;
         data.transEnd=transEnd;
       }
 
-      waysSegments++;
-      wayData.push_back(data);
+      state.waysSegments++;
+      state.wayData.push_back(data);
     }
   }
 
-  void MapPainter::PrepareWays(const StyleConfig& styleConfig,
-                               const Projection& projection,
-                               const MapParameter& parameter,
-                               const MapData& data)
+  /**
+   * Prepare the ways with the given index, ways are numbered
+   * in the order of data.ways followed by data.poiWays.
+   */
+  void MapPainter::PrepareWayRange(const StyleConfig& styleConfig,
+                                   const Projection& projection,
+                                   const MapParameter& parameter,
+                                   const MapData& data,
+                                   size_t start,
+                                   size_t end,
+                                   PrepareState& state)
   {
-    wayData.clear();
-    wayPathData.clear();
+    size_t w=start;
 
-    for (std::vector<WayRef>::const_iterator w=data.ways.begin();
-         w!=data.ways.end();
-         ++w) {
-      const WayRef& way=*w;
+    for (; w<end && w<data.ways.size(); w++) {
+      const WayRef& way=data.ways[w];
 
       PrepareWaySegment(styleConfig,
                         projection,
@@ -1705,12 +2063,19 @@ namespace osmscout {
                         ObjectFileRef(way->GetFileOffset(),refWay),
                         way->GetFeatureValueBuffer(),
                         way->nodes,
-                        way->ids);
+                        way->ids,
+                        state);
+    }
+
+    if (w==end) {
+      return;
     }
 
-    for (std::list<WayRef>::const_iterator p=data.poiWays.begin();
-         p!=data.poiWays.end();
-         ++p) {
+    std::list<WayRef>::const_iterator p=data.poiWays.begin();
+
+    std::advance(p,w-data.ways.size());
+
+    for (; w<end; w++, ++p) {
       const WayRef& way=*p;
 
       PrepareWaySegment(styleConfig,
@@ -1719,8 +2084,25 @@ namespace osmscout {
                         ObjectFileRef(way->GetFileOffset(),refWay),
                         way->GetFeatureValueBuffer(),
                         way->nodes,
-                        way->ids);
+                        way->ids,
+                        state);
     }
+  }
+
+  void MapPainter::PrepareWays(const StyleConfig& styleConfig,
+                               const Projection& projection,
+                               const MapParameter& parameter,
+                               const MapData& data)
+  {
+    wayData.clear();
+    wayPathData.clear();
+
+    Prepare(styleConfig,
+            projection,
+            parameter,
+            data,
+            data.ways.size()+data.poiWays.size(),
+            &MapPainter::PrepareWayRange);
 
     wayData.sort();
   }
@@ -1770,6 +2152,11 @@ namespace osmscout {
 
     labelsDrawn=0;
 
+    labelsPlaced=0;
+    labelsRejected=0;
+    labelsDisplaced=0;
+    labelPlacementTime=0.0;
+
     labels.clear();
     overlayLabels.clear();
 
@@ -1779,6 +2166,16 @@ namespace osmscout {
     shieldLabelSpace=ConvertWidthToPixel(parameter,parameter.GetPlateLabelSpace());
     sameLabelSpace=ConvertWidthToPixel(parameter,parameter.GetSameLabelSpace());
 
+    // Label collision grid with cells of about 1cm
+    double labelCellSize=std::max(16.0,ConvertWidthToPixel(parameter,10.0));
+
+    labelIndex.Initialize(projection.GetWidth(),
+                          projection.GetHeight(),
+                          labelCellSize);
+    overlayLabelIndex.Initialize(projection.GetWidth(),
+                                 projection.GetHeight(),
+                                 labelCellSize);
+
     if (parameter.IsAborted()) {
       return false;
     }
@@ -1998,6 +2395,19 @@ namespace osmscout {
 
       std::cout << "Labels: " << labels.size() << "/" << overlayLabels.size() << "/" << labelsDrawn << " (pcs) ";
       std::cout << labelsTimer << " (sec)" << std::endl;
+
+      std::cout << "Label placement: " << labelsPlaced << "/" << labelsRejected << "/" << labelsDisplaced << " (pcs) ";
+      std::cout << labelPlacementTime << " (msec)" << std::endl;
+
+      size_t styleCacheHits;
+      size_t styleCacheMisses;
+      size_t styleCacheEntries;
+
+      styleConfig->GetStyleCacheStatistics(styleCacheHits,
+                                           styleCacheMisses,
+                                           styleCacheEntries);
+
+      std::cout << "Style cache: " << styleCacheHits << "/" << styleCacheMisses << "/" << styleCacheEntries << " (pcs)" << std::endl;
     }
 
     return true;
@@ -21,6 +21,7 @@
 
 #include <string.h>
 
+#include <iterator>
 #include <set>
 
 #include <iostream>
@@ -200,7 +201,8 @@ namespace osmscout {
   }
 
   LineStyle::LineStyle(const LineStyle& style)
-  : slot(style.slot),
+  : Referencable(),
+    slot(style.slot),
     lineColor(style.lineColor),
     gapColor(style.gapColor),
     displayWidth(style.displayWidth),
@@ -439,6 +441,7 @@ namespace osmscout {
   }
 
   FillStyle::FillStyle(const FillStyle& style)
+  : Referencable()
   {
     this->fillColor=style.fillColor;
     this->pattern=style.pattern;
@@ -589,6 +592,7 @@ namespace osmscout {
   }
 
   LabelStyle::LabelStyle(const LabelStyle& style)
+  : Referencable()
   {
     this->priority=style.priority;
     this->size=style.size;
@@ -801,7 +805,8 @@ namespace osmscout {
   }
 
   PathShieldStyle::PathShieldStyle(const PathShieldStyle& style)
-   : shieldStyle(new ShieldStyle(*style.GetShieldStyle().Get())),
+   : Referencable(),
+     shieldStyle(new ShieldStyle(*style.GetShieldStyle().Get())),
      shieldSpace(style.shieldSpace)
   {
     // no code
@@ -897,6 +902,7 @@ namespace osmscout {
   }
 
   PathTextStyle::PathTextStyle(const PathTextStyle& style)
+  : Referencable()
   {
     this->label=style.label;
     this->size=style.size;
@@ -1068,6 +1074,7 @@ namespace osmscout {
   }
 
   IconStyle::IconStyle(const IconStyle& style)
+  : Referencable()
   {
     this->iconName=style.iconName;
     this->iconId=style.iconId;
@@ -1119,7 +1126,8 @@ namespace osmscout {
   }
 
   PathSymbolStyle::PathSymbolStyle(const PathSymbolStyle& style)
-  : symbol(style.symbol),
+  : Referencable(),
+    symbol(style.symbol),
     symbolSpace(style.symbolSpace)
   {
     // no code
@@ -1818,6 +1826,36 @@ namespace osmscout {
 
     PostprocessIconId();
     PostprocessPatternId();
+
+    lineStyleCache.Clear();
+    fillStyleCache.Clear();
+    textStyleCache.Clear();
+    iconStyleCache.Clear();
+    pathTextStyleCache.Clear();
+    pathSymbolStyleCache.Clear();
+    pathShieldStyleCache.Clear();
+  }
+
+  /**
+   * Return the number of lookups of composed styles answered from the
+   * style cache (hits) or requiring composition (misses), and the
+   * number of composed styles in the cache.
+   */
+  void StyleConfig::GetStyleCacheStatistics(size_t& hits,
+                                            size_t& misses,
+                                            size_t& entries) const
+  {
+    hits=0;
+    misses=0;
+    entries=0;
+
+    lineStyleCache.AddStatistics(hits,misses,entries);
+    fillStyleCache.AddStatistics(hits,misses,entries);
+    textStyleCache.AddStatistics(hits,misses,entries);
+    iconStyleCache.AddStatistics(hits,misses,entries);
+    pathTextStyleCache.AddStatistics(hits,misses,entries);
+    pathSymbolStyleCache.AddStatistics(hits,misses,entries);
+    pathShieldStyleCache.AddStatistics(hits,misses,entries);
   }
 
   TypeConfigRef StyleConfig::GetTypeConfig() const
@@ -1979,6 +2017,12 @@ namespace osmscout {
   /**
    * Get the style data based on the given features of an object,
    * a given style (S) and its style attributes (A).
+   *
+   * If more than one selector matches, the composed style is taken from
+   * (or stored in) the given cache. The result only depends on the list
+   * of selectors and which of them match, so the bitmask of matching
+   * selectors is used as cache key. Lists with more than 64 selectors are
+   * not cached.
    */
   template <class S, class A>
   void GetFeatureStyle(const StyleResolveContext& context,
@@ -1986,10 +2030,9 @@ namespace osmscout {
                        const FeatureValueBuffer& buffer,
                        const Projection& projection,
                        double dpi,
+                       StyleCache<S>& cache,
                        Ref<S>& style)
   {
-    bool   fastpath=false;
-    bool   composed=false;
     size_t level=projection.GetMagnification().GetLevel();
     double meterInPixel=1/projection.GetPixelSize();
     double meterInMM=meterInPixel*25.4/dpi;
@@ -1998,40 +2041,86 @@ namespace osmscout {
       level=styleSelectors.size()-1;
     }
 
-    style=NULL;
+    const std::list<StyleSelector<S,A> >&                   selectors=styleSelectors[level];
+    typename std::list<StyleSelector<S,A> >::const_iterator first=selectors.end();
+    StyleCacheKey                                           key;
+    size_t                                                  matchCount=0;
+    size_t                                                  bit=0;
 
-    for (typename std::list<StyleSelector<S,A> >::const_iterator s=styleSelectors[level].begin();
-         s!=styleSelectors[level].end();
-         ++s) {
-      const StyleSelector<S,A>& selector=*s;
+    key.selectors=&selectors;
+    key.matches=0;
 
-      if (!selector.criteria.Matches(context,
-                                     buffer,
-                                     meterInPixel,
-                                     meterInMM)) {
+    for (typename std::list<StyleSelector<S,A> >::const_iterator s=selectors.begin();
+         s!=selectors.end();
+         ++s, ++bit) {
+      if (!s->criteria.Matches(context,
+                               buffer,
+                               meterInPixel,
+                               meterInMM)) {
         continue;
       }
 
-      if (style.Invalid()) {
-        style=selector.style;
-        fastpath=true;
+      if (matchCount==0) {
+        first=s;
+      }
 
-        continue;
+      if (bit<64) {
+        key.matches|=((uint64_t)1) << bit;
       }
-      else if (fastpath) {
-        style=new S(style);
-        fastpath=false;
+
+      matchCount++;
+    }
+
+    if (matchCount==0) {
+      style=NULL;
+      return;
+    }
+
+    // Fastpath
+    if (matchCount==1) {
+      style=first->style;
+      return;
+    }
+
+    bool cacheable=bit<=64;
+
+    if (cacheable &&
+        cache.Get(key,style)) {
+      return;
+    }
+
+    style=new S(first->style);
+
+    bit=std::distance(selectors.begin(),first);
+
+    for (typename std::list<StyleSelector<S,A> >::const_iterator s=++first;
+         s!=selectors.end();
+         ++s) {
+      bit++;
+
+      if (cacheable) {
+        if ((key.matches & (((uint64_t)1) << bit))==0) {
+          continue;
+        }
+      }
+      else if (!s->criteria.Matches(context,
+                                    buffer,
+                                    meterInPixel,
+                                    meterInMM)) {
+        continue;
       }
 
-      style->CopyAttributes(*selector.style,
-                            selector.attributes);
-      composed=true;
+      style->CopyAttributes(*s->style,
+                            s->attributes);
     }
 
-    if (composed &&
-        !style->IsVisible()) {
+    if (!style->IsVisible()) {
       style=NULL;
     }
+
+    if (cacheable) {
+      cache.Set(key,style);
+    }
   }
 
   void StyleConfig::GetNodeTextStyle(const FeatureValueBuffer& buffer,
@@ -2044,6 +2133,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    textStyleCache,
                     textStyle);
   }
 
@@ -2057,6 +2147,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    iconStyleCache,
                     iconStyle);
   }
 
@@ -2078,6 +2169,7 @@ namespace osmscout {
                       buffer,
                       projection,
                       dpi,
+                      lineStyleCache,
                       style);
 
       if (style.Valid()) {
@@ -2096,6 +2188,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    pathTextStyleCache,
                     pathTextStyle);
   }
 
@@ -2109,6 +2202,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    pathSymbolStyleCache,
                     pathSymbolStyle);
   }
 
@@ -2122,6 +2216,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    pathShieldStyleCache,
                     pathShieldStyle);
   }
 
@@ -2136,6 +2231,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    fillStyleCache,
                     fillStyle);
   }
 
@@ -2150,6 +2246,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    textStyleCache,
                     textStyle);
   }
 
@@ -2164,6 +2261,7 @@ namespace osmscout {
                     buffer,
                     projection,
                     dpi,
+                    iconStyleCache,
                     iconStyle);
   }
 
@@ -2176,6 +2274,7 @@ namespace osmscout {
                     tileLandBuffer,
                     projection,
                     dpi,
+                    fillStyleCache,
                     fillStyle);
   }
 
@@ -2188,6 +2287,7 @@ namespace osmscout {
                     tileSeaBuffer,
                     projection,
                     dpi,
+                    fillStyleCache,
                     fillStyle);
   }
 
@@ -2200,6 +2300,7 @@ namespace osmscout {
                     tileCoastBuffer,
                     projection,
                     dpi,
+                    fillStyleCache,
                     fillStyle);
   }
 
@@ -2212,6 +2313,7 @@ namespace osmscout {
                     tileUnknownBuffer,
                     projection,
                     dpi,
+                    fillStyleCache,
                     fillStyle);
   }
 
@@ -2225,6 +2327,7 @@ namespace osmscout {
                       tileCoastlineBuffer,
                       projection,
                       dpi,
+                      lineStyleCache,
                       lineStyle);
     }
   }
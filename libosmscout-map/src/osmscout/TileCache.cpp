@@ -0,0 +1,856 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TileCache.h>
+
+#include <osmscout/private/Config.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(HAVE_SYS_STAT_H)
+#include <sys/stat.h>
+#endif
+
+#if defined(HAVE_DIRENT_H)
+#include <dirent.h>
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  static const char* indexFilename="tiles.idx";
+
+  static const char* tileSuffix=".tile";
+  static const char* tempSuffix=".tmp";
+
+  /**
+   * If the directory cannot be scanned on Open(), the index is written each
+   * time this number of tiles has been stored
+   */
+  static const size_t indexWriteInterval=256;
+
+  /**
+   * Database files that influence the rendering result
+   */
+  static const char* databaseFiles[] = {
+    "types.dat",
+    "bounding.dat",
+    "nodes.dat",
+    "ways.dat",
+    "areas.dat",
+    "areasopt.dat",
+    "waysopt.dat",
+    "areaarea.idx",
+    "areanode.idx",
+    "areaway.idx",
+    "water.idx",
+    NULL
+  };
+
+  /**
+   * FNV-1a hash of the given data, continuing the given hash
+   */
+  static uint32_t Hash(uint32_t hash,
+                       const char* data,
+                       size_t length)
+  {
+    for (size_t i=0; i<length; i++) {
+      hash^=(unsigned char)data[i];
+      hash*=16777619u;
+    }
+
+    return hash;
+  }
+
+  static uint32_t Hash(uint32_t hash,
+                       const std::string& data)
+  {
+    // Include the terminating zero, so that concatenations of strings differ
+    return Hash(hash,
+                data.c_str(),
+                data.length()+1);
+  }
+
+  static bool ReadFile(const std::string& filename,
+                       std::vector<char>& content)
+  {
+    FileOffset fileSize;
+    FILE*      file;
+
+    if (!GetFileSize(filename,fileSize)) {
+      return false;
+    }
+
+    file=fopen(filename.c_str(),"rb");
+
+    if (file==NULL) {
+      return false;
+    }
+
+    content.resize((size_t)fileSize);
+
+    if (fileSize>0 &&
+        fread(&content[0],1,(size_t)fileSize,file)!=(size_t)fileSize) {
+      fclose(file);
+
+      return false;
+    }
+
+    fclose(file);
+
+    return true;
+  }
+
+  static bool WriteFile(const std::string& filename,
+                        const std::vector<char>& content)
+  {
+    FILE* file;
+
+    file=fopen(filename.c_str(),"wb");
+
+    if (file==NULL) {
+      return false;
+    }
+
+    if (!content.empty() &&
+        fwrite(&content[0],1,content.size(),file)!=content.size()) {
+      fclose(file);
+
+      return false;
+    }
+
+    return fclose(file)==0;
+  }
+
+  static size_t LonToTileX(double lon,
+                           size_t zoom)
+  {
+    size_t tileCount=(size_t)1 << zoom;
+    double x=floor((lon+180.0)/360.0*tileCount);
+
+    return (size_t)std::max(0.0,std::min((double)(tileCount-1),x));
+  }
+
+  static size_t LatToTileY(double lat,
+                           size_t zoom)
+  {
+    size_t tileCount=(size_t)1 << zoom;
+    double latRad=std::max(-85.0511,std::min(85.0511,lat))*M_PI/180.0;
+    double y=floor((1.0-log(tan(latRad)+1.0/cos(latRad))/M_PI)/2.0*tileCount);
+
+    return (size_t)std::max(0.0,std::min((double)(tileCount-1),y));
+  }
+
+  bool TileCache::TileKey::operator<(const TileKey& other) const
+  {
+    if (version!=other.version) {
+      return version<other.version;
+    }
+
+    if (zoom!=other.zoom) {
+      return zoom<other.zoom;
+    }
+
+    if (y!=other.y) {
+      return y<other.y;
+    }
+
+    return x<other.x;
+  }
+
+  TileCache::TileCache()
+  : isOpen(false),
+    version(0),
+    maxSize(0),
+    size(0),
+    hits(0),
+    misses(0),
+    tempCount(0),
+    unsavedCount(0)
+  {
+    // no code
+  }
+
+  TileCache::~TileCache()
+  {
+    if (isOpen) {
+      Close();
+    }
+  }
+
+  TileCache::TileKey TileCache::GetTileKey(size_t zoom,
+                                           size_t x,
+                                           size_t y) const
+  {
+    TileKey key;
+
+    key.version=version;
+    key.zoom=(uint32_t)zoom;
+    key.x=(uint32_t)x;
+    key.y=(uint32_t)y;
+
+    return key;
+  }
+
+  std::string TileCache::GetTileFilename(const TileKey& key) const
+  {
+    std::ostringstream name;
+
+    name << std::hex << std::setw(8) << std::setfill('0') << key.version;
+    name << std::dec << "_" << key.zoom << "_" << key.x << "_" << key.y << tileSuffix;
+
+    return AppendFileToDir(directory,
+                           name.str());
+  }
+
+  /**
+   * Remove the entry of the given tile from the cache without touching its
+   * file. The mutex must be locked.
+   */
+  void TileCache::DropEntry(const TileKey& key)
+  {
+    EntryIndex::iterator entry=index.find(key);
+
+    if (entry==index.end()) {
+      return;
+    }
+
+    size-=entry->second->size;
+    entries.erase(entry->second);
+    index.erase(entry);
+  }
+
+  /**
+   * Remove the given entry from the cache and its file from disk.
+   * The mutex must be locked.
+   */
+  void TileCache::RemoveEntry(EntryList::iterator entry)
+  {
+    RemoveFile(GetTileFilename(entry->key));
+
+    size-=entry->size;
+    index.erase(entry->key);
+    entries.erase(entry);
+  }
+
+  /**
+   * Remove least recently used tiles until the size limit is met.
+   * The mutex must be locked.
+   */
+  void TileCache::RemoveLeastRecentlyUsed()
+  {
+    while (size>maxSize &&
+           !entries.empty()) {
+      EntryList::iterator last=entries.end();
+
+      --last;
+
+      RemoveEntry(last);
+    }
+  }
+
+  bool TileCache::ReadIndex()
+  {
+    FileScanner scanner;
+    std::string filename=AppendFileToDir(directory,
+                                         indexFilename);
+    uint32_t    entryCount;
+
+    if (!scanner.Open(filename,
+                      FileScanner::Sequential,
+                      true)) {
+      // An empty cache
+      return true;
+    }
+
+    if (!scanner.Read(entryCount)) {
+      std::cerr << "Error while reading number of entries from '" << filename << "'" << std::endl;
+      scanner.Close();
+      return false;
+    }
+
+    for (uint32_t i=0; i<entryCount; i++) {
+      Entry entry;
+
+      scanner.Read(entry.key.version);
+      scanner.Read(entry.key.zoom);
+      scanner.Read(entry.key.x);
+      scanner.Read(entry.key.y);
+      scanner.ReadFileOffset(entry.size);
+
+      if (scanner.HasError()) {
+        std::cerr << "Error while reading entry " << i << " from '" << filename << "'" << std::endl;
+        scanner.Close();
+        return false;
+      }
+
+      if (index.find(entry.key)!=index.end()) {
+        continue;
+      }
+
+      index[entry.key]=entries.insert(entries.end(),
+                                      entry);
+      size+=entry.size;
+    }
+
+    return scanner.Close();
+  }
+
+  bool TileCache::WriteIndex() const
+  {
+    FileWriter  writer;
+    std::string filename=AppendFileToDir(directory,
+                                         indexFilename);
+
+    if (!writer.Open(filename)) {
+      std::cerr << "Cannot create '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    writer.Write((uint32_t)entries.size());
+
+    for (EntryList::const_iterator entry=entries.begin();
+         entry!=entries.end();
+         ++entry) {
+      writer.Write(entry->key.version);
+      writer.Write(entry->key.zoom);
+      writer.Write(entry->key.x);
+      writer.Write(entry->key.y);
+      writer.WriteFileOffset(entry->size);
+    }
+
+    if (writer.HasError()) {
+      std::cerr << "Error while writing '" << filename << "'" << std::endl;
+      writer.Close();
+      return false;
+    }
+
+    return writer.Close();
+  }
+
+  /**
+   * Make the index match the tile files in the cache directory: Tiles without
+   * an index entry (stored after the index was written the last time) are
+   * added as least recently used, entries without a file are dropped and
+   * left over temporary files are removed. The mutex must be locked.
+   */
+  void TileCache::SyncIndexWithDirectory()
+  {
+#if defined(HAVE_DIRENT_H)
+    DIR* dir=opendir(directory.c_str());
+
+    if (dir==NULL) {
+      return;
+    }
+
+    std::set<TileKey>      foundKeys;
+    std::list<std::string> tempFiles;
+    struct dirent*         dirEntry;
+
+    while ((dirEntry=readdir(dir))!=NULL) {
+      std::string name(dirEntry->d_name);
+      size_t      tempPos=name.find(std::string(tileSuffix)+".");
+
+      if (tempPos!=std::string::npos &&
+          name.length()>strlen(tempSuffix) &&
+          name.compare(name.length()-strlen(tempSuffix),strlen(tempSuffix),tempSuffix)==0) {
+        tempFiles.push_back(name);
+        continue;
+      }
+
+      TileKey key;
+      char    suffix[8];
+
+      if (sscanf(dirEntry->d_name,
+                 "%8x_%u_%u_%u%7s",
+                 &key.version,
+                 &key.zoom,
+                 &key.x,
+                 &key.y,
+                 suffix)!=5 ||
+          strcmp(suffix,tileSuffix)!=0) {
+        continue;
+      }
+
+      foundKeys.insert(key);
+
+      if (index.find(key)!=index.end()) {
+        continue;
+      }
+
+      Entry entry;
+
+      entry.key=key;
+
+      if (!GetFileSize(AppendFileToDir(directory,
+                                       name),
+                       entry.size)) {
+        continue;
+      }
+
+      index[entry.key]=entries.insert(entries.end(),
+                                      entry);
+      size+=entry.size;
+    }
+
+    closedir(dir);
+
+    for (std::list<std::string>::const_iterator name=tempFiles.begin();
+         name!=tempFiles.end();
+         ++name) {
+      RemoveFile(AppendFileToDir(directory,
+                                 *name));
+    }
+
+    EntryList::iterator entry=entries.begin();
+
+    while (entry!=entries.end()) {
+      if (foundKeys.find(entry->key)==foundKeys.end()) {
+        size-=entry->size;
+        index.erase(entry->key);
+        entry=entries.erase(entry);
+      }
+      else {
+        ++entry;
+      }
+    }
+#endif
+  }
+
+  /**
+   * Calculate the version of tiles rendered from the given database using the
+   * given style sheet and DPI.
+   */
+  bool TileCache::CalculateVersion(const std::string& databaseDirectory,
+                                   const std::string& styleFile,
+                                   double dpi,
+                                   uint32_t& version)
+  {
+    std::vector<char>  style;
+    std::ostringstream stream;
+
+    version=2166136261u;
+
+    version=Hash(version,
+                 databaseDirectory);
+
+    for (size_t i=0; databaseFiles[i]!=NULL; i++) {
+      std::string filename=AppendFileToDir(databaseDirectory,
+                                           databaseFiles[i]);
+      FileOffset  fileSize;
+
+      if (!GetFileSize(filename,fileSize)) {
+        continue;
+      }
+
+      stream << databaseFiles[i] << " " << fileSize;
+
+#if defined(HAVE_SYS_STAT_H)
+      struct stat fileStat;
+
+      if (stat(filename.c_str(),&fileStat)==0) {
+        stream << " " << fileStat.st_mtime;
+      }
+#endif
+
+      stream << std::endl;
+    }
+
+    if (!ReadFile(styleFile,
+                  style)) {
+      std::cerr << "Cannot read style sheet '" << styleFile << "'" << std::endl;
+      return false;
+    }
+
+    stream << dpi;
+
+    version=Hash(version,
+                 stream.str());
+
+    if (!style.empty()) {
+      version=Hash(version,
+                   &style[0],
+                   style.size());
+    }
+
+    return true;
+  }
+
+  /**
+   * Open the cache in the given (existing) directory for tiles of the
+   * given database, style sheet and DPI. If the tiles in the cache exceed
+   * the given maximum size in bytes, the least recently used tiles are
+   * removed.
+   */
+  bool TileCache::Open(const std::string& directory,
+                       const std::string& databaseDirectory,
+                       const std::string& styleFile,
+                       double dpi,
+                       FileOffset maxSize)
+  {
+    MutexLocker locker(mutex);
+
+    if (isOpen) {
+      std::cerr << "Tile cache is already open" << std::endl;
+      return false;
+    }
+
+    if (!CalculateVersion(databaseDirectory,
+                          styleFile,
+                          dpi,
+                          version)) {
+      return false;
+    }
+
+    this->directory=directory;
+    this->maxSize=maxSize;
+
+    size=0;
+    hits=0;
+    misses=0;
+    tempCount=0;
+    unsavedCount=0;
+    entries.clear();
+    index.clear();
+
+    if (!ReadIndex()) {
+      entries.clear();
+      index.clear();
+      size=0;
+    }
+
+    SyncIndexWithDirectory();
+
+    RemoveLeastRecentlyUsed();
+
+    isOpen=true;
+
+    return true;
+  }
+
+  /**
+   * Close the cache, storing the index
+   */
+  bool TileCache::Close()
+  {
+    MutexLocker locker(mutex);
+
+    if (!isOpen) {
+      return true;
+    }
+
+    isOpen=false;
+
+    bool success=WriteIndex();
+
+    entries.clear();
+    index.clear();
+    size=0;
+
+    return success;
+  }
+
+  bool TileCache::HasTile(size_t zoom,
+                          size_t x,
+                          size_t y) const
+  {
+    MutexLocker locker(mutex);
+
+    return index.find(GetTileKey(zoom,x,y))!=index.end();
+  }
+
+  /**
+   * Return the data of the given tile. Returns false, if the tile is not in
+   * the cache.
+   */
+  bool TileCache::GetTile(size_t zoom,
+                          size_t x,
+                          size_t y,
+                          std::vector<char>& data)
+  {
+    TileKey     key=GetTileKey(zoom,x,y);
+    std::string filename;
+
+    {
+      MutexLocker          locker(mutex);
+      EntryIndex::iterator entry=index.find(key);
+
+      if (entry==index.end()) {
+        misses++;
+        return false;
+      }
+
+      // Mark as most recently used
+      entries.splice(entries.begin(),
+                     entries,
+                     entry->second);
+
+      filename=GetTileFilename(key);
+    }
+
+    // Read outside of the lock, so that tiles can be read in parallel
+    if (ReadFile(filename,
+                 data)) {
+      MutexLocker locker(mutex);
+
+      hits++;
+
+      return true;
+    }
+
+    MutexLocker locker(mutex);
+
+    // The file vanished, drop it from the cache
+    DropEntry(key);
+
+    misses++;
+
+    return false;
+  }
+
+  /**
+   * Store the given tile data, replacing existing data of the tile.
+   */
+  bool TileCache::StoreTile(size_t zoom,
+                            size_t x,
+                            size_t y,
+                            const std::vector<char>& data)
+  {
+    TileKey     key;
+    std::string filename;
+    std::string tempFilename;
+
+    {
+      MutexLocker locker(mutex);
+
+      if (!isOpen) {
+        std::cerr << "Tile cache is not open" << std::endl;
+        return false;
+      }
+
+      key=GetTileKey(zoom,x,y);
+      filename=GetTileFilename(key);
+      tempFilename=filename+"."+NumberToString(tempCount)+tempSuffix;
+
+      tempCount++;
+    }
+
+    // Write to a temporary file and replace the tile file afterwards, so that
+    // GetTile() never reads a partially written file
+    if (!WriteFile(tempFilename,
+                   data)) {
+      std::cerr << "Cannot write tile file '" << tempFilename << "'" << std::endl;
+      RemoveFile(tempFilename);
+
+      return false;
+    }
+
+    if (!RenameFile(tempFilename,
+                    filename)) {
+      // Some platforms do not replace existing files on rename
+      RemoveFile(filename);
+
+      if (!RenameFile(tempFilename,
+                      filename)) {
+        std::cerr << "Cannot rename '" << tempFilename << "' to '" << filename << "'" << std::endl;
+        RemoveFile(tempFilename);
+
+        MutexLocker locker(mutex);
+
+        DropEntry(key);
+
+        return false;
+      }
+    }
+
+    MutexLocker locker(mutex);
+
+    DropEntry(key);
+
+    Entry newEntry;
+
+    newEntry.key=key;
+    newEntry.size=data.size();
+
+    index[key]=entries.insert(entries.begin(),
+                              newEntry);
+    size+=newEntry.size;
+
+    RemoveLeastRecentlyUsed();
+
+#if !defined(HAVE_DIRENT_H)
+    // Without scanning the directory on Open(), tiles missing in the index
+    // would never be removed, so make sure the index does not get too old
+    unsavedCount++;
+
+    if (unsavedCount>=indexWriteInterval) {
+      unsavedCount=0;
+
+      WriteIndex();
+    }
+#endif
+
+    return true;
+  }
+
+  /**
+   * Render all tiles in the given area and zoom range, that are not already
+   * in the cache. The factory must create painters storing the tiles in this
+   * cache (see TileCachePainter), using the same DPI the cache was opened
+   * with.
+   *
+   * For each zoom level only the tiles within the bounding box of the tiles
+   * missing in the cache are rendered.
+   */
+  bool TileCache::Seed(const TileRenderer& renderer,
+                       MetaTilePainterFactory& factory,
+                       const MapParameter& parameter,
+                       const AreaSearchParameter& searchParameter,
+                       double lonMin,
+                       double latMin,
+                       double lonMax,
+                       double latMax,
+                       size_t startZoom,
+                       size_t endZoom,
+                       TileRenderer::Statistics& statistics)
+  {
+    statistics=TileRenderer::Statistics();
+
+    for (size_t zoom=std::min(startZoom,endZoom);
+         zoom<=std::max(startZoom,endZoom);
+         zoom++) {
+      size_t xStart=LonToTileX(std::min(lonMin,lonMax),zoom);
+      size_t xEnd=LonToTileX(std::max(lonMin,lonMax),zoom);
+      size_t yStart=LatToTileY(std::max(latMin,latMax),zoom);
+      size_t yEnd=LatToTileY(std::min(latMin,latMax),zoom);
+      size_t missingXStart=xEnd+1;
+      size_t missingXEnd=0;
+      size_t missingYStart=yEnd+1;
+      size_t missingYEnd=0;
+
+      for (size_t y=yStart; y<=yEnd; y++) {
+        for (size_t x=xStart; x<=xEnd; x++) {
+          if (!HasTile(zoom,x,y)) {
+            missingXStart=std::min(missingXStart,x);
+            missingXEnd=std::max(missingXEnd,x);
+            missingYStart=std::min(missingYStart,y);
+            missingYEnd=std::max(missingYEnd,y);
+          }
+        }
+      }
+
+      if (missingXStart>missingXEnd) {
+        continue;
+      }
+
+      TileRenderer::Statistics zoomStatistics;
+
+      if (!renderer.Render(factory,
+                           parameter,
+                           searchParameter,
+                           zoom,
+                           missingXStart,
+                           missingYStart,
+                           missingXEnd,
+                           missingYEnd,
+                           zoomStatistics)) {
+        std::cerr << "Cannot seed tiles of zoom level " << zoom << std::endl;
+        return false;
+      }
+
+      statistics.metaTileCount+=zoomStatistics.metaTileCount;
+      statistics.tileCount+=zoomStatistics.tileCount;
+      statistics.time+=zoomStatistics.time;
+      statistics.dataStage.Add(zoomStatistics.dataStage);
+      statistics.drawStage.Add(zoomStatistics.drawStage);
+      statistics.storeStage.Add(zoomStatistics.storeStage);
+    }
+
+    return true;
+  }
+
+  FileOffset TileCache::GetSize() const
+  {
+    MutexLocker locker(mutex);
+
+    return size;
+  }
+
+  size_t TileCache::GetTileCount() const
+  {
+    MutexLocker locker(mutex);
+
+    return entries.size();
+  }
+
+  void TileCache::GetStatistics(size_t& hits,
+                                size_t& misses) const
+  {
+    MutexLocker locker(mutex);
+
+    hits=this->hits;
+    misses=this->misses;
+  }
+
+  TileCachePainter::TileCachePainter(TileCache& cache)
+  : cache(cache)
+  {
+    // no code
+  }
+
+  TileCachePainter::~TileCachePainter()
+  {
+    // no code
+  }
+
+  bool TileCachePainter::StoreTile(size_t zoom,
+                                   size_t x,
+                                   size_t y,
+                                   size_t pixelX,
+                                   size_t pixelY,
+                                   size_t tileSize)
+  {
+    std::vector<char> data;
+
+    if (!EncodeTile(pixelX,
+                    pixelY,
+                    tileSize,
+                    data)) {
+      return false;
+    }
+
+    return cache.StoreTile(zoom,
+                           x,
+                           y,
+                           data);
+  }
+}
@@ -0,0 +1,461 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TileRenderer.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/StopClock.h>
+
+namespace osmscout {
+
+  /**
+   * Longitude of the left border of the tile with the given (fractional)
+   * x coordinate, see http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames
+   */
+  static double TileXToLon(double x,
+                           size_t zoom)
+  {
+    return x/pow(2.0,(double)zoom)*360.0-180.0;
+  }
+
+  /**
+   * Latitude of the top border of the tile with the given (fractional)
+   * y coordinate, see http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames
+   */
+  static double TileYToLat(double y,
+                           size_t zoom)
+  {
+    double n=M_PI-2.0*M_PI*y/pow(2.0,(double)zoom);
+
+    return 180.0/M_PI*atan(0.5*(exp(n)-exp(-n)));
+  }
+
+  MetaTilePainter::~MetaTilePainter()
+  {
+    // no code
+  }
+
+  MetaTilePainterFactory::~MetaTilePainterFactory()
+  {
+    // no code
+  }
+
+  TileRenderer::StageStatistics::StageStatistics()
+  : count(0),
+    minTime(0.0),
+    maxTime(0.0),
+    totalTime(0.0)
+  {
+    // no code
+  }
+
+  void TileRenderer::StageStatistics::Add(double time)
+  {
+    if (count==0) {
+      minTime=time;
+      maxTime=time;
+    }
+    else {
+      minTime=std::min(minTime,time);
+      maxTime=std::max(maxTime,time);
+    }
+
+    totalTime+=time;
+    count++;
+  }
+
+  void TileRenderer::StageStatistics::Add(const StageStatistics& other)
+  {
+    if (other.count==0) {
+      return;
+    }
+
+    if (count==0) {
+      minTime=other.minTime;
+      maxTime=other.maxTime;
+    }
+    else {
+      minTime=std::min(minTime,other.minTime);
+      maxTime=std::max(maxTime,other.maxTime);
+    }
+
+    totalTime+=other.totalTime;
+    count+=other.count;
+  }
+
+  TileRenderer::Statistics::Statistics()
+  : metaTileCount(0),
+    tileCount(0),
+    time(0.0)
+  {
+    // no code
+  }
+
+  TileRenderer::TileRenderer(const MapServiceRef& mapService,
+                             const StyleConfigRef& styleConfig)
+  : mapService(mapService),
+    styleConfig(styleConfig),
+    tileSize(256),
+    metaTileSize(8),
+    border(0),
+    threadCount(1)
+  {
+    // no code
+  }
+
+  TileRenderer::~TileRenderer()
+  {
+    // no code
+  }
+
+  void TileRenderer::SetTileSize(size_t tileSize)
+  {
+    this->tileSize=tileSize;
+  }
+
+  void TileRenderer::SetMetaTileSize(size_t metaTileSize)
+  {
+    this->metaTileSize=std::max((size_t)1,metaTileSize);
+  }
+
+  /**
+   * Set the number of pixels drawn around each metatile, so that
+   * labels and symbols crossing the border of the metatile are
+   * drawn consistently on both sides.
+   */
+  void TileRenderer::SetBorder(size_t border)
+  {
+    this->border=border;
+  }
+
+  void TileRenderer::SetThreadCount(size_t threadCount)
+  {
+    this->threadCount=std::max((size_t)1,threadCount);
+  }
+
+  /**
+   * Load the data of the given metatile, draw it and store all tiles of the
+   * metatile within the given tile range.
+   */
+  bool TileRenderer::RenderMetaTile(const MapParameter& parameter,
+                                    const AreaSearchParameter& searchParameter,
+                                    MetaTilePainter& painter,
+                                    const MetaTile& metaTile,
+                                    size_t xStart,
+                                    size_t yStart,
+                                    size_t xEnd,
+                                    size_t yEnd,
+                                    Statistics& statistics) const
+  {
+    MercatorProjection projection;
+    Magnification      magnification;
+    double             borderInTiles=border/(double)tileSize;
+
+    magnification.SetLevel(metaTile.zoom);
+
+    projection.Set(TileXToLon(metaTile.x-borderInTiles,metaTile.zoom),
+                   TileYToLat(metaTile.y+metaTile.height+borderInTiles,metaTile.zoom),
+                   TileXToLon(metaTile.x+metaTile.width+borderInTiles,metaTile.zoom),
+                   TileYToLat(metaTile.y-borderInTiles,metaTile.zoom),
+                   magnification,
+                   metaTile.width*tileSize+2*border);
+
+    StopClock dataTimer;
+
+    TypeSet              nodeTypes;
+    std::vector<TypeSet> wayTypes;
+    TypeSet              areaTypes;
+    MapData              data;
+
+    styleConfig->GetNodeTypesWithMaxMag(projection.GetMagnification(),
+                                        nodeTypes);
+
+    styleConfig->GetWayTypesByPrioWithMaxMag(projection.GetMagnification(),
+                                             wayTypes);
+
+    styleConfig->GetAreaTypesWithMaxMag(projection.GetMagnification(),
+                                        areaTypes);
+
+    if (!mapService->GetObjects(nodeTypes,
+                                wayTypes,
+                                areaTypes,
+                                projection.GetLonMin(),
+                                projection.GetLatMin(),
+                                projection.GetLonMax(),
+                                projection.GetLatMax(),
+                                projection.GetMagnification(),
+                                searchParameter,
+                                data.nodes,
+                                data.ways,
+                                data.areas)) {
+      std::cerr << "Cannot load data of metatile " << metaTile.zoom << "/" << metaTile.x << "/" << metaTile.y << std::endl;
+      return false;
+    }
+
+    if (parameter.GetRenderSeaLand()) {
+      if (!mapService->GetGroundTiles(projection.GetLonMin(),
+                                      projection.GetLatMin(),
+                                      projection.GetLonMax(),
+                                      projection.GetLatMax(),
+                                      projection.GetMagnification(),
+                                      data.groundTiles)) {
+        std::cerr << "Cannot load ground tiles of metatile " << metaTile.zoom << "/" << metaTile.x << "/" << metaTile.y << std::endl;
+        return false;
+      }
+    }
+
+    dataTimer.Stop();
+
+    StopClock drawTimer;
+
+    if (!painter.DrawMetaTile(metaTile,
+                              projection,
+                              parameter,
+                              data)) {
+      std::cerr << "Cannot draw metatile " << metaTile.zoom << "/" << metaTile.x << "/" << metaTile.y << std::endl;
+      return false;
+    }
+
+    drawTimer.Stop();
+
+    StopClock storeTimer;
+
+    for (size_t y=std::max(metaTile.y,yStart);
+         y<std::min(metaTile.y+metaTile.height,yEnd+1);
+         y++) {
+      for (size_t x=std::max(metaTile.x,xStart);
+           x<std::min(metaTile.x+metaTile.width,xEnd+1);
+           x++) {
+        if (!painter.StoreTile(metaTile.zoom,
+                               x,
+                               y,
+                               border+(x-metaTile.x)*tileSize,
+                               border+(y-metaTile.y)*tileSize,
+                               tileSize)) {
+          std::cerr << "Cannot store tile " << metaTile.zoom << "/" << x << "/" << y << std::endl;
+          return false;
+        }
+
+        statistics.tileCount++;
+      }
+    }
+
+    storeTimer.Stop();
+
+    statistics.metaTileCount++;
+    statistics.dataStage.Add(dataTimer.GetMilliseconds());
+    statistics.drawStage.Add(drawTimer.GetMilliseconds());
+    statistics.storeStage.Add(storeTimer.GetMilliseconds());
+
+    return true;
+  }
+
+  /**
+   * Worker: Renders metatiles from the given list until all metatiles are
+   * taken or rendering of a metatile failed.
+   */
+  void TileRenderer::RenderMetaTiles(const MapParameter& parameter,
+                                     const AreaSearchParameter& searchParameter,
+                                     MetaTilePainterRef painter,
+                                     const std::vector<MetaTile>& metaTiles,
+                                     Mutex* mutex,
+                                     size_t* nextMetaTile,
+                                     bool* success,
+                                     size_t xStart,
+                                     size_t yStart,
+                                     size_t xEnd,
+                                     size_t yEnd,
+                                     Statistics* statistics) const
+  {
+    while (true) {
+      size_t current;
+
+      {
+        MutexLocker locker(*mutex);
+
+        if (!*success ||
+            *nextMetaTile>=metaTiles.size()) {
+          return;
+        }
+
+        current=*nextMetaTile;
+        (*nextMetaTile)++;
+      }
+
+      if (!RenderMetaTile(parameter,
+                          searchParameter,
+                          *painter,
+                          metaTiles[current],
+                          xStart,
+                          yStart,
+                          xEnd,
+                          yEnd,
+                          *statistics)) {
+        MutexLocker locker(*mutex);
+
+        *success=false;
+
+        return;
+      }
+    }
+  }
+
+  /**
+   * Render all tiles of the given zoom level in the given range (inclusive).
+   * Metatiles are aligned to multiples of the metatile size, tiles of
+   * metatiles outside the given range are not stored.
+   *
+   * A MapQueryCache set in the search parameter is only used by the first
+   * worker, all other workers get their own cache.
+   */
+  bool TileRenderer::Render(MetaTilePainterFactory& factory,
+                            const MapParameter& parameter,
+                            const AreaSearchParameter& searchParameter,
+                            size_t zoom,
+                            size_t xStart,
+                            size_t yStart,
+                            size_t xEnd,
+                            size_t yEnd,
+                            Statistics& statistics) const
+  {
+    StopClock             timer;
+    size_t                tileCount=(size_t)1 << zoom;
+    std::vector<MetaTile> metaTiles;
+
+    statistics=Statistics();
+
+    xEnd=std::min(xEnd,tileCount-1);
+    yEnd=std::min(yEnd,tileCount-1);
+
+    if (xStart>xEnd ||
+        yStart>yEnd) {
+      return true;
+    }
+
+    for (size_t y=yStart/metaTileSize*metaTileSize; y<=yEnd; y+=metaTileSize) {
+      for (size_t x=xStart/metaTileSize*metaTileSize; x<=xEnd; x+=metaTileSize) {
+        MetaTile metaTile;
+
+        metaTile.zoom=zoom;
+        metaTile.x=x;
+        metaTile.y=y;
+        metaTile.width=std::min(metaTileSize,tileCount-x);
+        metaTile.height=std::min(metaTileSize,tileCount-y);
+
+        metaTiles.push_back(metaTile);
+      }
+    }
+
+    // The calculated height of the projection never exceeds the height of the
+    // metatile, so painters for the largest possible metatile fit all metatiles
+    size_t painterSize=std::min(metaTileSize,tileCount)*tileSize+2*border;
+    size_t workerCount=std::min(threadCount,metaTiles.size());
+
+    std::vector<MetaTilePainterRef>  painters;
+    std::vector<AreaSearchParameter> searchParameters(workerCount,searchParameter);
+    std::vector<Statistics>          workerStatistics(workerCount);
+    Mutex                            mutex;
+    size_t                           nextMetaTile=0;
+    bool                             success=true;
+
+    for (size_t w=0; w<workerCount; w++) {
+      MetaTilePainterRef painter=factory.CreatePainter(painterSize,
+                                                       painterSize);
+
+      if (painter.Invalid()) {
+        std::cerr << "Cannot create painter" << std::endl;
+        return false;
+      }
+
+      painters.push_back(painter);
+
+      // A query cache must not be shared by queries running in parallel
+      if (w>0 &&
+          searchParameter.GetQueryCache().Valid()) {
+        searchParameters[w].SetQueryCache(new MapQueryCache());
+      }
+    }
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::vector<std::thread> threads;
+
+    // The first worker runs in the current thread
+    for (size_t w=1; w<workerCount; w++) {
+      threads.push_back(std::thread(&TileRenderer::RenderMetaTiles,
+                                    this,
+                                    std::cref(parameter),
+                                    std::cref(searchParameters[w]),
+                                    painters[w],
+                                    std::cref(metaTiles),
+                                    &mutex,
+                                    &nextMetaTile,
+                                    &success,
+                                    xStart,
+                                    yStart,
+                                    xEnd,
+                                    yEnd,
+                                    &workerStatistics[w]));
+    }
+#endif
+
+    RenderMetaTiles(parameter,
+                    searchParameters[0],
+                    painters[0],
+                    metaTiles,
+                    &mutex,
+                    &nextMetaTile,
+                    &success,
+                    xStart,
+                    yStart,
+                    xEnd,
+                    yEnd,
+                    &workerStatistics[0]);
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    for (size_t t=0; t<threads.size(); t++) {
+      threads[t].join();
+    }
+#endif
+
+    for (size_t w=0; w<workerCount; w++) {
+      statistics.metaTileCount+=workerStatistics[w].metaTileCount;
+      statistics.tileCount+=workerStatistics[w].tileCount;
+      statistics.dataStage.Add(workerStatistics[w].dataStage);
+      statistics.drawStage.Add(workerStatistics[w].drawStage);
+      statistics.storeStage.Add(workerStatistics[w].storeStage);
+    }
+
+    timer.Stop();
+
+    statistics.time=timer.GetMilliseconds();
+
+    return success;
+  }
+}
@@ -43,10 +43,10 @@ namespace osmscout {
     class Ring
     {
     public:
-      FeatureValueBuffer    featureValueBuffer; //! List of features
-      uint8_t               ring;               //! The ring hierarchy number (0...n)
-      std::vector<Id>       ids;                //! The array of ids for a coordinate
-      std::vector<GeoCoord> nodes;              //! The array of coordinates
+      FeatureValueBuffer       featureValueBuffer; //! List of features
+      uint8_t                  ring;               //! The ring hierarchy number (0...n)
+      std::vector<Id>          ids;                //! The array of ids for a coordinate
+      std::vector<ObjectCoord> nodes;              //! The array of coordinates
 
     public:
       inline Ring()
@@ -152,6 +152,8 @@ namespace osmscout {
                         double& minLat,
                         double& maxLat) const;
 
+    size_t GetMemoryUsage() const;
+
     bool Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
     bool ReadOptimized(const TypeConfig& typeConfig,
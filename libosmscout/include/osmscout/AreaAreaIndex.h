@@ -24,9 +24,10 @@
 
 #include <osmscout/TypeSet.h>
 
-#include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
+#include <osmscout/util/ShardedCache.h>
 
 namespace osmscout {
 
@@ -43,6 +44,9 @@ namespace osmscout {
 
     Internally the index is implemented as quadtree. As a result each index entry
     has 4 children (besides entries in the lowest level).
+
+    Index cells are shared read-only between the cache and all callers, so
+    lookups can be done from multiple threads at the same time.
     */
   class OSMSCOUT_API AreaAreaIndex : public Referencable
   {
@@ -59,24 +63,26 @@ namespace osmscout {
     /**
       Datastructure for every index cell of our index.
       */
-    struct IndexCell
+    struct IndexCell : public Referencable
     {
       FileOffset              children[4]; //! File index of each of the four children, or 0 if there is no child
       std::vector<IndexEntry> areas;
     };
 
-    typedef Cache<FileOffset,IndexCell> IndexCache;
+    typedef Ref<IndexCell> IndexCellRef;
+
+    typedef ShardedCache<FileOffset,IndexCellRef> IndexCache;
 
-    struct IndexCacheValueSizer : public IndexCache::ValueSizer
+    struct IndexCacheValueSizer
     {
-      unsigned long GetSize(const IndexCell& value) const
+      unsigned long GetSize(const IndexCellRef& value) const
       {
         unsigned long memory=0;
 
-        memory+=sizeof(value);
+        memory+=sizeof(value)+sizeof(IndexCell);
 
         // Areas
-        memory+=value.areas.size()*sizeof(IndexEntry);
+        memory+=value->areas.size()*sizeof(IndexEntry);
 
         return memory;
       }
@@ -110,11 +116,12 @@ namespace osmscout {
     FileOffset                      topLevelOffset; //! File offset of the top level index entry
 
     mutable IndexCache              indexCache;     //! Cached map of all index entries by file offset
+    mutable Mutex                   accessMutex;    //! Mutex guarding the scanner
 
   private:
     bool GetIndexCell(uint32_t level,
                       FileOffset offset,
-                      IndexCache::CacheRef& cacheRef) const;
+                      IndexCellRef& cell) const;
 
   public:
     AreaAreaIndex(size_t cacheSize);
@@ -24,6 +24,16 @@
 #include <osmscout/DataFile.h>
 
 namespace osmscout {
+  /**
+    \ingroup Database
+    Cache cost of an area, see GetDataCacheCost().
+    */
+  inline unsigned long GetDataCacheCost(const Area& area,
+                                        unsigned long /*dataSize*/)
+  {
+    return (unsigned long)area.GetMemoryUsage();
+  }
+
   /**
     \ingroup Database
     Abstraction for getting cached access to the 'ways.dat' file.
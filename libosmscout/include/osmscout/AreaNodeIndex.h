@@ -22,9 +22,11 @@
 
 #include <vector>
 
+#include <osmscout/IndexCellCache.h>
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
 
 namespace osmscout {
@@ -69,6 +71,7 @@ namespace osmscout {
     std::string           filepart;       //! name of the data file
     std::string           datafilename;   //! Full path and name of the data file
     mutable FileScanner   scanner;        //! Scanner instance for reading this file
+    mutable Mutex         accessMutex;    //! Mutex guarding the scanner
 
     std::vector<TypeData> nodeTypeData;
 
@@ -83,6 +86,18 @@ namespace osmscout {
                     size_t currentSize,
                     bool& sizeExceeded) const;
 
+    bool GetCachedOffsets(const TypeData& typeData,
+                          TypeId type,
+                          double minlon,
+                          double minlat,
+                          double maxlon,
+                          double maxlat,
+                          size_t maxNodeCount,
+                          std::vector<FileOffset>& offsets,
+                          size_t currentSize,
+                          bool& sizeExceeded,
+                          IndexCellCache& cellCache) const;
+
   public:
     AreaNodeIndex();
 
@@ -97,6 +112,15 @@ namespace osmscout {
                     size_t maxNodeCount,
                     std::vector<FileOffset>& nodeOffsets) const;
 
+    bool GetOffsets(double minlon,
+                    double minlat,
+                    double maxlon,
+                    double maxlat,
+                    const TypeSet& nodeTypes,
+                    size_t maxNodeCount,
+                    std::vector<FileOffset>& nodeOffsets,
+                    IndexCellCache* cellCache) const;
+
     void DumpStatistics();
   };
 
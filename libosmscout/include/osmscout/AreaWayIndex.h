@@ -22,9 +22,11 @@
 
 #include <vector>
 
+#include <osmscout/IndexCellCache.h>
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/HashSet.h>
 #include <osmscout/util/Reference.h>
 
@@ -70,6 +72,7 @@ namespace osmscout {
     std::string           filepart;       //! name of the data file
     std::string           datafilename;   //! Full path and name of the data file
     mutable FileScanner   scanner;        //! Scanner instance for reading this file
+    mutable Mutex         accessMutex;    //! Mutex guarding the scanner
 
     std::vector<TypeData> wayTypeData;
 
@@ -84,6 +87,18 @@ namespace osmscout {
                     size_t currentSize,
                     bool& sizeExceeded) const;
 
+    bool GetCachedOffsets(const TypeData& typeData,
+                          TypeId type,
+                          double minlon,
+                          double minlat,
+                          double maxlon,
+                          double maxlat,
+                          size_t maxWayCount,
+                          OSMSCOUT_HASHSET<FileOffset>& offsets,
+                          size_t currentSize,
+                          bool& sizeExceeded,
+                          IndexCellCache& cellCache) const;
+
   public:
     AreaWayIndex();
 
@@ -98,6 +113,15 @@ namespace osmscout {
                     size_t maxWayCount,
                     std::vector<FileOffset>& offsets) const;
 
+    bool GetOffsets(double minlon,
+                    double minlat,
+                    double maxlon,
+                    double maxlat,
+                    const std::vector<TypeSet>& wayTypes,
+                    size_t maxWayCount,
+                    std::vector<FileOffset>& offsets,
+                    IndexCellCache* cellCache) const;
+
     void DumpStatistics();
   };
 
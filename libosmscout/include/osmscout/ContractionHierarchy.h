@@ -0,0 +1,199 @@
+#ifndef OSMSCOUT_CONTRACTIONHIERARCHY_H
+#define OSMSCOUT_CONTRACTIONHIERARCHY_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/ObjectRef.h>
+#include <osmscout/RouteNode.h>
+#include <osmscout/RoutingProfile.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Reference.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Routing
+   * A contraction hierarchy for a routing graph as generated by the import.
+   *
+   * Every route node gets a rank. Nodes are contracted in the order of their
+   * rank. Contracting a node adds shortcut edges between its neighbours of
+   * higher rank, where the path via the contracted node is the only
+   * shortest path. A route can then be found by a bidirectional search
+   * that only follows edges to nodes of higher rank.
+   *
+   * Route nodes with turn restrictions (excludes) are not contracted. They
+   * form the "core" of the hierarchy, all having the same (highest) rank.
+   * Edges between core nodes are followed in both directions and turn
+   * restrictions are evaluated while searching the core. Since no shortcut
+   * bypasses a core node, each edge knows the path index at its source
+   * node and the object of its last path, which is all that is required to
+   * evaluate the excludes.
+   *
+   * Costs are calculated during import using a FastestPathRoutingProfile
+   * and are stored in milliseconds. The hierarchy is only valid for
+   * profiles with the same parametrization, see IsCompatible().
+   */
+  class OSMSCOUT_API ContractionHierarchy : public Referencable
+  {
+  public:
+    static const uint32_t noEdge=0xffffffff;
+    static const uint32_t noNode=0xffffffff;
+
+    /**
+     * An original or shortcut edge of the hierarchy.
+     */
+    struct OSMSCOUT_API Edge
+    {
+      uint32_t      source;     //! Index of the source node
+      uint32_t      target;     //! Index of the target node
+      uint32_t      costs;      //! Costs of the edge in milliseconds
+      uint32_t      firstEdge;  //! First edge of a shortcut or noEdge for an original edge
+      uint32_t      secondEdge; //! Second edge of a shortcut or noEdge for an original edge
+      uint32_t      pathIndex;  //! Index of the first path in the paths of the source route node
+      ObjectFileRef object;     //! Object of the last path
+
+      inline bool IsShortcut() const
+      {
+        return firstEdge!=noEdge;
+      }
+    };
+
+    /**
+     * A node of the hierarchy, references a route node.
+     */
+    struct OSMSCOUT_API Node
+    {
+      FileOffset offset;        //! File offset of the route node
+      uint32_t   rank;          //! Rank of the node, core nodes share the highest rank
+      uint32_t   forwardStart;  //! Index of the first upward edge in forwardEdges
+      uint32_t   backwardStart; //! Index of the first upward edge in backwardEdges
+      uint32_t   excludeStart;  //! Index of the first exclude in excludes
+    };
+
+  private:
+    Vehicle                         vehicle;         //! Vehicle of the routing graph
+    uint32_t                        vehicleMaxSpeed; //! Encoded maximum speed of the vehicle used for cost calculation
+    std::vector<uint32_t>           speeds;          //! Encoded speeds per type used for cost calculation
+    std::vector<Node>               nodes;           //! All nodes, sorted by file offset, plus a sentinel
+    std::vector<Edge>               edges;           //! All original and shortcut edges
+    std::vector<uint32_t>           forwardEdges;    //! Per node: Edges starting at the node leading upwards
+    std::vector<uint32_t>           backwardEdges;   //! Per node: Edges ending at the node coming from upwards
+    std::vector<RouteNode::Exclude> excludes;        //! Per node: Turn restrictions of core nodes
+
+  private:
+    void BuildAdjacency();
+
+  public:
+    static uint32_t EncodeSpeed(double speed);
+
+    ContractionHierarchy();
+    virtual ~ContractionHierarchy();
+
+    void Set(const AbstractRoutingProfile& profile,
+             const std::vector<FileOffset>& nodeOffsets,
+             const std::vector<uint32_t>& ranks,
+             const std::vector<Edge>& edges,
+             const std::vector<std::vector<RouteNode::Exclude> >& excludes);
+
+    bool IsCompatible(const RoutingProfile& profile) const;
+
+    uint32_t GetNodeIndex(FileOffset offset) const;
+
+    inline size_t GetNodeCount() const
+    {
+      return nodes.empty() ? 0 : nodes.size()-1;
+    }
+
+    inline size_t GetEdgeCount() const
+    {
+      return edges.size();
+    }
+
+    inline const Node& GetNode(uint32_t index) const
+    {
+      return nodes[index];
+    }
+
+    inline const Edge& GetEdge(uint32_t index) const
+    {
+      return edges[index];
+    }
+
+    inline uint32_t GetForwardEdgesBegin(uint32_t node) const
+    {
+      return nodes[node].forwardStart;
+    }
+
+    inline uint32_t GetForwardEdgesEnd(uint32_t node) const
+    {
+      return nodes[node+1].forwardStart;
+    }
+
+    inline uint32_t GetForwardEdge(uint32_t index) const
+    {
+      return forwardEdges[index];
+    }
+
+    inline uint32_t GetBackwardEdgesBegin(uint32_t node) const
+    {
+      return nodes[node].backwardStart;
+    }
+
+    inline uint32_t GetBackwardEdgesEnd(uint32_t node) const
+    {
+      return nodes[node+1].backwardStart;
+    }
+
+    inline uint32_t GetBackwardEdge(uint32_t index) const
+    {
+      return backwardEdges[index];
+    }
+
+    inline bool HasExcludes(uint32_t node) const
+    {
+      return nodes[node].excludeStart!=nodes[node+1].excludeStart;
+    }
+
+    bool IsExcluded(uint32_t node,
+                    const ObjectFileRef& source,
+                    uint32_t pathIndex) const;
+
+    void UnpackEdge(uint32_t edge,
+                    std::vector<uint32_t>& originalEdges) const;
+
+    bool Read(FileScanner& scanner);
+    bool Write(FileWriter& writer) const;
+
+    bool Load(const std::string& filename);
+    bool Store(const std::string& filename) const;
+  };
+
+  typedef Ref<ContractionHierarchy> ContractionHierarchyRef;
+}
+
+#endif
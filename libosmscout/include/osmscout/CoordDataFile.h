@@ -35,6 +35,14 @@ namespace osmscout {
 
   /**
    * \ingroup Database
+   *
+   * Access to the coordinates of OSM nodes as written during preprocessing.
+   *
+   * The file either stores the coordinates in pages of fixed size, that are
+   * referenced by an index of page offsets at the end of the file, or (if
+   * the page size in the header is 0) as a dense array of fixed-point
+   * coordinates indexed by the OSM node id. The dense variant is a sparse
+   * file where unset entries are zero.
    */
   class OSMSCOUT_API CoordDataFile
   {
@@ -42,6 +50,9 @@ namespace osmscout {
     typedef OSMSCOUT_HASHMAP<PageId,FileOffset> CoordPageOffsetMap;
 
   public:
+    //! Size of one entry in the dense variant of the file
+    static const size_t denseCoordByteSize=2*sizeof(uint32_t);
+
     struct CoordEntry
     {
       Point point;
@@ -62,8 +73,17 @@ namespace osmscout {
     std::string         datafile;           //! Basename part of the data file name
     std::string         datafilename;       //! complete filename for data file
     mutable FileScanner scanner;            //! File stream to the data file
-    uint32_t            coordPageSize;
+    uint32_t            coordPageSize;      //! Number of coords in a page, 0 for the dense variant
     CoordPageOffsetMap  coordPageOffsetMap;
+    FileOffset          denseCoordOffset;   //! Offset of the first entry of the dense variant
+    FileOffset          denseCoordCount;    //! Number of entries of the dense variant
+
+  private:
+    bool GetOffset(OSMId id,
+                   FileOffset& offset,
+                   Id& substituteId) const;
+    bool ReadCoord(GeoCoord& coord,
+                   bool& isSet) const;
 
   public:
     CoordDataFile(const std::string& datafile);
@@ -78,6 +98,8 @@ namespace osmscout {
 
     bool Get(std::set<OSMId>& ids,
              CoordResultMap& coordsMap) const;
+    bool Get(std::vector<OSMId>& ids,
+             CoordResultMap& coordsMap) const;
   };
 }
 
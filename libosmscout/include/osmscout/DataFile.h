@@ -20,23 +20,54 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <set>
 #include <vector>
 
 #include <osmscout/NumericIndex.h>
 
-#include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
+#include <osmscout/util/ShardedCache.h>
 
 namespace osmscout {
 
+  /**
+   * \ingroup Database
+   *
+   * Return the cost of a data object in the cache of a DataFile. The size of
+   * the data on disk is a cheap estimate for the variable part of the in-memory
+   * size of the object. Overloaded for objects that can calculate their memory
+   * usage.
+   */
+  template <class N>
+  inline unsigned long GetDataCacheCost(const N& /*data*/,
+                                        unsigned long dataSize)
+  {
+    return sizeof(N)+dataSize;
+  }
+
   /**
    * \ingroup Database
    *
    * Access to standard format data files.
    *
    * Allows to load data objects by offset using various standard library data structures.
+   *
+   * A DataFile can be used by multiple threads at the same time. Each reading
+   * thread gets its own FileScanner from an internal pool, so decoding of data
+   * happens in parallel. The cache is sharded and locks each shard individually.
+   *
+   * Loading a number of objects at once reads the objects missing in the cache
+   * in file order and advises the operating system to prefetch neighbouring
+   * objects as one range, so that cold reads result in few large reads instead
+   * of one random read per object. The result is returned in the order of
+   * the offsets passed.
+   *
+   * If the data file is memory mapped, objects can also be loaded as read-only
+   * views (see ObjectView.h) that point into the mapped file content instead
+   * of being copied into newly allocated objects.
    */
   template <class N>
   class DataFile : public Referencable
@@ -45,36 +76,49 @@ namespace osmscout {
     typedef Ref<N> ValueType;
 
   private:
-    typedef Cache<FileOffset,ValueType> DataCache;
-
-    struct DataCacheValueSizer : public DataCache::ValueSizer
-    {
-      unsigned long GetSize(const ValueType& value) const
-      {
-        return sizeof(value);
-      }
-    };
+    typedef ShardedCache<FileOffset,ValueType> DataCache;
 
   private:
-    std::string         datafile;        //! Basename part fo the data file name
-    std::string         datafilename;    //! complete filename for data file
-    FileScanner::Mode   modeData;        //! Type of file access
-    bool                memoryMapedData; //! Use memory mapped files for data access
-    mutable DataCache   cache;           //! Entry cache
-    mutable FileScanner scanner;         //! File stream to the data file
+    std::string                       datafile;        //! Basename part fo the data file name
+    std::string                       datafilename;    //! complete filename for data file
+    FileScanner::Mode                 modeData;        //! Type of file access
+    bool                              memoryMapedData; //! Use memory mapped files for data access
+    mutable DataCache                 cache;           //! Entry cache
+    mutable std::vector<FileScanner*> scanners;        //! Pool of currently unused scanners for the data file
+    mutable Mutex                     accessMutex;     //! Mutex guarding the scanner pool
+    FileScanner                       mappedScanner;   //! Scanner holding the memory mapping views point into
 
   protected:
-    bool                isOpen;          //! If true,the data file is opened
-    TypeConfigRef       typeConfig;
+    bool                              isOpen;          //! If true,the data file is opened
+    TypeConfigRef                     typeConfig;
 
   private:
     bool ReadData(const TypeConfig& typeConfig,
                   FileScanner& scanner,
                   N& data) const;
 
+    FileScanner* AcquireScanner() const;
+    void ReleaseScanner(FileScanner* scanner) const;
+    void DiscardScanner(FileScanner* scanner) const;
+
+    bool LoadEntry(FileScanner& scanner,
+                   const FileOffset& offset,
+                   ValueType& entry) const;
+    bool ReadEntry(FileScanner& scanner,
+                   const FileOffset& offset,
+                   ValueType& entry) const;
+
+    void Prefetch(FileScanner& scanner,
+                  const std::vector<std::pair<FileOffset,size_t> >& requests) const;
+
+    template<typename IteratorIn>
+    bool GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
+                     std::vector<ValueType>& data) const;
+
   public:
     DataFile(const std::string& datafile,
-                 unsigned long dataCacheSize);
+             unsigned long dataCacheSize,
+             unsigned long dataCacheMemory=0);
 
     virtual ~DataFile();
 
@@ -98,17 +142,23 @@ namespace osmscout {
     bool GetByOffset(const FileOffset& offset,
                      ValueType& entry) const;
 
+    template<class V>
+    bool GetViewsByOffset(const std::vector<FileOffset>& offsets,
+                          std::vector<V>& views) const;
+
     void FlushCache();
     void DumpStatistics() const;
   };
 
   template <class N>
   DataFile<N>::DataFile(const std::string& datafile,
-                        unsigned long dataCacheSize)
+                        unsigned long dataCacheSize,
+                        unsigned long dataCacheMemory)
   : datafile(datafile),
     modeData(FileScanner::LowMemRandom),
     memoryMapedData(false),
-    cache(dataCacheSize),
+    cache(dataCacheSize,
+          dataCacheMemory),
     isOpen(false)
 
   {
@@ -132,247 +182,331 @@ namespace osmscout {
                      scanner);
   }
 
+  /**
+   * Return an opened scanner for exclusive use by the calling thread. Either an
+   * unused scanner from the pool is returned or a new scanner is opened. Returns
+   * NULL if the data file cannot be opened.
+   */
   template <class N>
-  bool DataFile<N>::Open(const TypeConfigRef& typeConfig,
-                         const std::string& path,
-                         FileScanner::Mode modeData,
-                         bool memoryMapedData)
+  FileScanner* DataFile<N>::AcquireScanner() const
   {
-    this->typeConfig=typeConfig;
+    {
+      MutexLocker locker(accessMutex);
 
-    datafilename=AppendFileToDir(path,datafile);
+      if (!scanners.empty()) {
+        FileScanner *scanner=scanners.back();
 
-    this->memoryMapedData=memoryMapedData;
-    this->modeData=modeData;
+        scanners.pop_back();
 
-    isOpen=scanner.Open(datafilename,modeData,memoryMapedData);
+        return scanner;
+      }
+    }
 
-    return isOpen;
+    FileScanner *scanner=new FileScanner();
+
+    if (!scanner->Open(datafilename,modeData,memoryMapedData)) {
+      std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
+      delete scanner;
+
+      return NULL;
+    }
+
+    return scanner;
   }
 
+  /**
+   * Return a scanner to the pool after use.
+   */
   template <class N>
-  bool DataFile<N>::IsOpen() const
+  void DataFile<N>::ReleaseScanner(FileScanner* scanner) const
   {
-    return isOpen;
+    MutexLocker locker(accessMutex);
+
+    scanners.push_back(scanner);
   }
 
+  /**
+   * Close and delete a scanner that had an error, so the next request opens
+   * the file again.
+   */
   template <class N>
-  bool DataFile<N>::Close()
+  void DataFile<N>::DiscardScanner(FileScanner* scanner) const
   {
-    bool success=true;
+    if (scanner->IsOpen()) {
+      scanner->Close();
+    }
 
-    typeConfig=NULL;
+    delete scanner;
+  }
 
-    if (scanner.IsOpen()) {
-      if (!scanner.Close()) {
-        success=false;
+  /**
+   * Read the entry at the given offset using the given scanner and place it
+   * into the cache.
+   */
+  template <class N>
+  bool DataFile<N>::LoadEntry(FileScanner& scanner,
+                              const FileOffset& offset,
+                              ValueType& entry) const
+  {
+    ValueType value=new N();
+
+    scanner.SetPos(offset);
+
+    if (!ReadData(typeConfig,
+                  scanner,
+                  *value)) {
+      std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
+      return false;
+    }
+
+    if (cache.IsActive()) {
+      FileOffset endOffset;
+
+      if (!scanner.GetPos(endOffset)) {
+        endOffset=offset;
       }
+
+      cache.SetEntry(offset,
+                     value,
+                     GetDataCacheCost(*value,
+                                      (unsigned long)(endOffset-offset)));
     }
 
-    isOpen=false;
-    cache.Flush();
+    entry=value;
 
-    return success;
+    return true;
   }
 
+  /**
+   * Return the entry at the given offset, either from the cache or by reading
+   * it using the given scanner (and then placing it into the cache).
+   */
   template <class N>
-  bool DataFile<N>::GetByOffset(const std::vector<FileOffset>& offsets,
-                                std::vector<ValueType>& data) const
+  bool DataFile<N>::ReadEntry(FileScanner& scanner,
+                              const FileOffset& offset,
+                              ValueType& entry) const
   {
-    assert(isOpen);
+    if (cache.GetEntry(offset,entry)) {
+      return true;
+    }
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
+    return LoadEntry(scanner,
+                     offset,
+                     entry);
+  }
+
+  /**
+   * Advise the operating system to prefetch the data of the given requests,
+   * which must be sorted by offset. Requests near to each other are joined
+   * into one range.
+   */
+  template <class N>
+  void DataFile<N>::Prefetch(FileScanner& scanner,
+                             const std::vector<std::pair<FileOffset,size_t> >& requests) const
+  {
+    // Requests with less distance get joined into one range
+    const FileOffset maxGap=64*1024;
+    // Estimated maximum size of one entry, the size of an entry is not
+    // known before reading it
+    const FileOffset entrySize=4*1024;
+
+    FileOffset rangeStart=requests.front().first;
+    FileOffset rangeEnd=rangeStart+entrySize;
+
+    for (std::vector<std::pair<FileOffset,size_t> >::const_iterator request=requests.begin()+1;
+         request!=requests.end();
+         ++request) {
+      if (request->first>rangeEnd+maxGap) {
+        scanner.Prefetch(rangeStart,
+                         rangeEnd-rangeStart);
+
+        rangeStart=request->first;
       }
+
+      rangeEnd=request->first+entrySize;
     }
 
-    data.reserve(data.size()+offsets.size());
+    scanner.Prefetch(rangeStart,
+                     rangeEnd-rangeStart);
+  }
+
+  template <class N>
+  bool DataFile<N>::Open(const TypeConfigRef& typeConfig,
+                         const std::string& path,
+                         FileScanner::Mode modeData,
+                         bool memoryMapedData)
+  {
+    this->typeConfig=typeConfig;
+
+    datafilename=AppendFileToDir(path,datafile);
 
-    if (!cache.IsActive()) {
-      for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        N *value=new N();
+    this->memoryMapedData=memoryMapedData;
+    this->modeData=modeData;
 
-        scanner.SetPos(*offset);
+    FileScanner *scanner=new FileScanner();
 
-        if (!ReadData(typeConfig,
-                      scanner,
-                      *value)) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
+    isOpen=scanner->Open(datafilename,modeData,memoryMapedData);
 
-        data.push_back(value);
-      }
+    if (isOpen) {
+      ReleaseScanner(scanner);
     }
     else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=new N();
-
-          if (!ReadData(typeConfig,
-                        scanner,
-                        *cacheRef->value)) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
+      delete scanner;
+    }
 
-        data.push_back(cacheRef->value);
+    if (isOpen &&
+        memoryMapedData &&
+        !mappedScanner.IsOpen()) {
+      // Not being able to map the file is not an error, views then get
+      // created from regularly loaded objects
+      if (!mappedScanner.Open(datafilename,modeData,true)) {
+        std::cerr << "Cannot map " << datafilename << " for views" << std::endl;
       }
     }
 
-    return true;
+    return isOpen;
   }
 
   template <class N>
-  bool DataFile<N>::GetByOffset(const std::list<FileOffset>& offsets,
-                                std::vector<ValueType>& data) const
+  bool DataFile<N>::IsOpen() const
   {
-    assert(isOpen);
-
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
-    }
-
-    data.reserve(data.size()+offsets.size());
+    return isOpen;
+  }
 
-    if (!cache.IsActive()) {
-      for (std::list<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        N *value=new N();
+  /**
+   * Close the data file. Must not be called while other threads are
+   * still reading data.
+   */
+  template <class N>
+  bool DataFile<N>::Close()
+  {
+    MutexLocker locker(accessMutex);
+    bool        success=true;
 
-        scanner.SetPos(*offset);
+    typeConfig=NULL;
 
-        if (!ReadData(typeConfig,
-                      scanner,
-                      *value)) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
+    for (std::vector<FileScanner*>::iterator scanner=scanners.begin();
+         scanner!=scanners.end();
+         ++scanner) {
+      if ((*scanner)->IsOpen()) {
+        if (!(*scanner)->Close()) {
+          success=false;
         }
-
-        data.push_back(value);
       }
+
+      delete *scanner;
     }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::list<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=new N();
-
-          if (!ReadData(typeConfig,
-                        scanner,
-                        *cacheRef->value)) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
 
-        data.push_back(cacheRef->value);
+    scanners.clear();
+
+    if (mappedScanner.IsOpen()) {
+      if (!mappedScanner.Close()) {
+        success=false;
       }
     }
 
-    return true;
+    isOpen=false;
+    cache.Flush();
+
+    return success;
   }
 
+  /**
+   * Load the entries at the given offsets and append them to data in the
+   * order of the offsets. Entries not found in the cache are read in file
+   * order, each distinct offset only once.
+   */
   template <class N>
-  bool DataFile<N>::GetByOffset(const std::set<FileOffset>& offsets,
+  template<typename IteratorIn>
+  bool DataFile<N>::GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
                                 std::vector<ValueType>& data) const
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
+    // Offset and index in data of each entry not found in the cache
+    std::vector<std::pair<FileOffset,size_t> > requests;
+    size_t                                     start=data.size();
+    size_t                                     index=start;
+
+    data.resize(start+size);
+
+    for (IteratorIn offset=begin; offset!=end; ++offset) {
+      if (!cache.GetEntry(*offset,data[index])) {
+        requests.push_back(std::make_pair(*offset,index));
       }
+
+      index++;
     }
 
-    data.reserve(data.size()+offsets.size());
+    if (requests.empty()) {
+      return true;
+    }
 
-    if (!cache.IsActive()) {
-      for (std::set<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        N *value=new N();
+    std::sort(requests.begin(),requests.end());
 
-        scanner.SetPos(*offset);
+    FileScanner *scanner=AcquireScanner();
 
-        if (!ReadData(typeConfig,
-                      scanner,
-                      *value)) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
+    if (scanner==NULL) {
+      data.resize(start);
+      return false;
+    }
 
-        data.push_back(value);
-      }
+    if (requests.size()>1) {
+      Prefetch(*scanner,
+               requests);
     }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::set<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=new N();
-
-          if (!ReadData(typeConfig,
-                        scanner,
-                        *cacheRef->value)) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
 
-        data.push_back(cacheRef->value);
+    for (size_t r=0; r<requests.size(); r++) {
+      if (r>0 &&
+          requests[r].first==requests[r-1].first) {
+        data[requests[r].second]=data[requests[r-1].second];
+        continue;
+      }
+
+      if (!LoadEntry(*scanner,
+                     requests[r].first,
+                     data[requests[r].second])) {
+        data.resize(start);
+        DiscardScanner(scanner);
+        return false;
       }
     }
 
+    ReleaseScanner(scanner);
+
     return true;
   }
 
+  template <class N>
+  bool DataFile<N>::GetByOffset(const std::vector<FileOffset>& offsets,
+                                std::vector<ValueType>& data) const
+  {
+    return GetByOffset(offsets.begin(),
+                       offsets.end(),
+                       offsets.size(),
+                       data);
+  }
+
+  template <class N>
+  bool DataFile<N>::GetByOffset(const std::list<FileOffset>& offsets,
+                                std::vector<ValueType>& data) const
+  {
+    return GetByOffset(offsets.begin(),
+                       offsets.end(),
+                       offsets.size(),
+                       data);
+  }
+
+  template <class N>
+  bool DataFile<N>::GetByOffset(const std::set<FileOffset>& offsets,
+                                std::vector<ValueType>& data) const
+  {
+    return GetByOffset(offsets.begin(),
+                       offsets.end(),
+                       offsets.size(),
+                       data);
+  }
+
   template <class N>
   bool DataFile<N>::GetByOffset(const std::set<FileOffset>& offsets,
                                 OSMSCOUT_HASHMAP<FileOffset,ValueType>& dataMap) const
@@ -398,53 +532,85 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    FileScanner *scanner=AcquireScanner();
+
+    if (scanner==NULL) {
+      return false;
     }
 
-    if (!cache.IsActive()) {
-      N *value=new N();
+    if (!ReadEntry(*scanner,
+                   offset,
+                   entry)) {
+      DiscardScanner(scanner);
+      return false;
+    }
 
-      scanner.SetPos(offset);
+    ReleaseScanner(scanner);
 
-      if (!ReadData(typeConfig,
-                    scanner,
-                    *value)) {
-        std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
-        // TODO: Remove broken entry from cache
-        scanner.Close();
-        return false;
-      }
+    return true;
+  }
+
+  /**
+   * Return read-only views of the objects at the given offsets in the order
+   * of the offsets. The views are appended to the given vector.
+   *
+   * Views of objects not found in the cache are read directly from the memory
+   * mapped data file without allocating an object. They are only valid as
+   * long as the data file is open. Objects found in the cache (or all objects,
+   * if the data file is not memory mapped) are returned as views wrapping the
+   * loaded object. Views are not placed into the cache.
+   */
+  template <class N>
+  template<class V>
+  bool DataFile<N>::GetViewsByOffset(const std::vector<FileOffset>& offsets,
+                                     std::vector<V>& views) const
+  {
+    assert(isOpen);
+
+    const char  *mappedData=mappedScanner.GetMappedData();
+    FileScanner *scanner=AcquireScanner();
 
-      entry=value;
+    if (scanner==NULL) {
+      return false;
     }
-    else {
-      typename DataCache::CacheRef cacheRef;
 
-      if (!cache.GetEntry(offset,cacheRef)) {
-        typename DataCache::CacheEntry cacheEntry(offset);
+    size_t start=views.size();
 
-        cacheRef=cache.SetEntry(cacheEntry);
+    views.resize(start+offsets.size());
 
-        scanner.SetPos(offset);
-        cacheRef->value=new N();
+    for (size_t i=0; i<offsets.size(); i++) {
+      ValueType value;
 
-        if (!ReadData(typeConfig,
-                      scanner,
-                      *cacheRef->value)) {
-          std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
+      if (mappedData==NULL ||
+          cache.GetEntry(offsets[i],value)) {
+        if (value.Invalid() &&
+            !ReadEntry(*scanner,
+                       offsets[i],
+                       value)) {
+          views.resize(start);
+          DiscardScanner(scanner);
           return false;
         }
+
+        views[start+i]=V(value);
+
+        continue;
       }
 
-      entry=cacheRef->value;
+      scanner->SetPos(offsets[i]);
+
+      if (!views[start+i].Read(*typeConfig,
+                               *scanner,
+                               mappedData)) {
+        std::cerr << "Error while reading data from offset " << offsets[i] << " of file " << datafilename << "!" << std::endl;
+        views.resize(start);
+        DiscardScanner(scanner);
+        return false;
+      }
     }
 
+    ReleaseScanner(scanner);
+
     return true;
   }
 
@@ -457,10 +623,9 @@ namespace osmscout {
   template <class N>
   void DataFile<N>::DumpStatistics() const
   {
-    cache.DumpStatistics(datafile.c_str(),DataCacheValueSizer());
+    cache.DumpStatistics(datafile.c_str());
   }
 
-
   /**
    * \ingroup Database
    *
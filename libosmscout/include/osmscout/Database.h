@@ -32,6 +32,8 @@
 #include <osmscout/NodeDataFile.h>
 #include <osmscout/WayDataFile.h>
 
+#include <osmscout/ObjectView.h>
+
 #include <osmscout/OptimizeAreasLowZoom.h>
 #include <osmscout/OptimizeWaysLowZoom.h>
 
@@ -50,6 +52,7 @@
 
 #include <osmscout/util/Breaker.h>
 #include <osmscout/util/HashMap.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/Reference.h>
 
@@ -67,7 +70,8 @@ namespace osmscout {
     instance.
 
     The following attributes are currently available:
-    * cache sizes.
+    * cache sizes (in number of entries).
+    * cache memory limits (in bytes, 0 means no limit).
     */
   class OSMSCOUT_API DatabaseParameter
   {
@@ -76,10 +80,13 @@ namespace osmscout {
     unsigned long areaNodeIndexCacheSize;
 
     unsigned long nodeCacheSize;
+    unsigned long nodeCacheMemory;
 
     unsigned long wayCacheSize;
+    unsigned long wayCacheMemory;
 
     unsigned long areaCacheSize;
+    unsigned long areaCacheMemory;
 
     bool          debugPerformance;
 
@@ -90,10 +97,13 @@ namespace osmscout {
     void SetAreaNodeIndexCacheSize(unsigned long areaNodeIndexCacheSize);
 
     void SetNodeCacheSize(unsigned long nodeCacheSize);
+    void SetNodeCacheMemory(unsigned long nodeCacheMemory);
 
     void SetWayCacheSize(unsigned long wayCacheSize);
+    void SetWayCacheMemory(unsigned long wayCacheMemory);
 
     void SetAreaCacheSize(unsigned long relationCacheSize);
+    void SetAreaCacheMemory(unsigned long areaCacheMemory);
 
     void SetDebugPerformance(bool debug);
 
@@ -101,10 +111,13 @@ namespace osmscout {
     unsigned long GetAreaNodeIndexCacheSize() const;
 
     unsigned long GetNodeCacheSize() const;
+    unsigned long GetNodeCacheMemory() const;
 
     unsigned long GetWayCacheSize() const;
+    unsigned long GetWayCacheMemory() const;
 
     unsigned long GetAreaCacheSize() const;
+    unsigned long GetAreaCacheMemory() const;
 
     bool IsDebugPerformance() const;
   };
@@ -119,6 +132,11 @@ namespace osmscout {
    *
    * The Database is opened by passing the directory that contains
    * all database files.
+   *
+   * After it has been opened a Database instance can be shared between
+   * threads for reading. Data files hand out one FileScanner per concurrent
+   * reader, indexes serialize access to their scanner. Open() and Close()
+   * must not be called while other threads access the database.
    */
   class OSMSCOUT_API Database : public Referencable
   {
@@ -148,6 +166,8 @@ namespace osmscout {
     mutable OptimizeAreasLowZoomRef optimizeAreasLowZoom; //! Optimized data for low zoom situations
     mutable OptimizeWaysLowZoomRef  optimizeWaysLowZoom;  //! Optimized data for low zoom situations
 
+    mutable Mutex                   accessMutex;          //! Mutex guarding lazy loading of files and indexes
+
   public:
     Database(const DatabaseParameter& parameter);
     virtual ~Database();
@@ -212,6 +232,13 @@ namespace osmscout {
     bool GetWaysByOffset(const std::set<FileOffset>& offsets,
                          OSMSCOUT_HASHMAP<FileOffset,WayRef>& dataMap) const;
 
+    bool GetNodeViewsByOffset(const std::vector<FileOffset>& offsets,
+                              std::vector<NodeView>& nodes) const;
+    bool GetAreaViewsByOffset(const std::vector<FileOffset>& offsets,
+                              std::vector<AreaView>& areas) const;
+    bool GetWayViewsByOffset(const std::vector<FileOffset>& offsets,
+                             std::vector<WayView>& ways) const;
+
     void DumpStatistics();
   };
 
@@ -209,6 +209,143 @@ namespace osmscout {
     static bool Parse(const std::string& text,
                       GeoCoord& coord);
   };
+
+  /**
+   * \ingroup Geometry
+   *
+   * Geographic coordinate in a compact fixed point representation (8 instead
+   * of 16 bytes). The coordinate has the resolution of the coordinates in the
+   * database files (see latConversionFactor and lonConversionFactor), so
+   * coordinates read from the database are stored without loss.
+   *
+   * The interface matches the one of GeoCoord, values are converted to
+   * double on access.
+   */
+  struct OSMSCOUT_API CompactGeoCoord
+  {
+    uint32_t latValue;
+    uint32_t lonValue;
+
+    /**
+     * The default constructor creates an uninitialized instance (for performance reasons).
+     */
+    inline CompactGeoCoord()
+    {
+      // no code
+    }
+
+    inline CompactGeoCoord(double lat,
+                           double lon)
+    {
+      Set(lat,lon);
+    }
+
+    inline CompactGeoCoord(const GeoCoord& coord)
+    {
+      Set(coord.GetLat(),coord.GetLon());
+    }
+
+    inline void Set(double lat,
+                    double lon)
+    {
+      latValue=(uint32_t)round((lat+90.0)*latConversionFactor);
+      lonValue=(uint32_t)round((lon+180.0)*lonConversionFactor);
+    }
+
+    inline void SetValues(uint32_t latValue,
+                          uint32_t lonValue)
+    {
+      this->latValue=latValue;
+      this->lonValue=lonValue;
+    }
+
+    inline double GetLat() const
+    {
+      return latValue/latConversionFactor-90.0;
+    }
+
+    inline double GetLon() const
+    {
+      return lonValue/lonConversionFactor-180.0;
+    }
+
+    inline GeoCoord GetCoord() const
+    {
+      return GeoCoord(GetLat(),GetLon());
+    }
+
+    inline operator GeoCoord() const
+    {
+      return GetCoord();
+    }
+
+    inline std::string GetDisplayText() const
+    {
+      return GetCoord().GetDisplayText();
+    }
+
+    /**
+     * Encode the coordinate value into a buffer (with at least a size of coordByteSize).
+     */
+    inline void EncodeToBuffer(unsigned char buffer[]) const
+    {
+      buffer[0]=((latValue >>  0) & 0xff);
+      buffer[1]=((latValue >>  8) & 0xff);
+      buffer[2]=((latValue >> 16) & 0xff);
+
+      buffer[3]=((lonValue >>  0) & 0xff);
+      buffer[4]=((lonValue >>  8) & 0xff);
+      buffer[5]=((lonValue >> 16) & 0xff);
+
+      buffer[6]=((latValue >> 24) & 0x07) | ((lonValue >> 20) & 0x70);
+    }
+
+    /**
+     * Decode the coordinate value from a buffer (with at least a size of coordByteSize).
+     */
+    inline void DecodeFromBuffer(const unsigned char buffer[])
+    {
+      latValue=  (buffer[0] <<  0)
+               | (buffer[1] <<  8)
+               | (buffer[2] << 16)
+               | ((buffer[6] & 0x0f) << 24);
+
+      lonValue=  (buffer[3] <<  0)
+               | (buffer[4] <<  8)
+               | (buffer[5] << 16)
+               | ((buffer[6] & 0xf0) << 20);
+    }
+
+    inline bool IsEqual(const CompactGeoCoord& other) const
+    {
+      return latValue==other.latValue && lonValue==other.lonValue;
+    }
+
+    inline bool operator==(const CompactGeoCoord& other) const
+    {
+      return latValue==other.latValue && lonValue==other.lonValue;
+    }
+
+    inline bool operator<(const CompactGeoCoord& other) const
+    {
+      return latValue<other.latValue ||
+             (latValue==other.latValue && lonValue<other.lonValue);
+    }
+  };
+
+  /**
+   * \ingroup Geometry
+   *
+   * Type of the coordinates stored in objects (Way, Area). This is GeoCoord,
+   * or CompactGeoCoord if the library was configured with
+   * --enable-compact-coords (halving the memory used by coordinates of
+   * cached objects).
+   */
+#if defined(OSMSCOUT_COMPACT_COORDS)
+  typedef CompactGeoCoord ObjectCoord;
+#else
+  typedef GeoCoord ObjectCoord;
+#endif
 }
 
 #endif
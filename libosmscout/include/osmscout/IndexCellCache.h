@@ -0,0 +1,104 @@
+#ifndef OSMSCOUT_INDEXCELLCACHE_H
+#define OSMSCOUT_INDEXCELLCACHE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <map>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Types.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   * Caches the content of the cells of an index with one grid per type
+   * (AreaNodeIndex, AreaWayIndex) between consecutive queries.
+   *
+   * Each query marks the cells it uses. At the end of a query all cells not
+   * used by the query are dropped, so the cache only holds the cells of the
+   * last queried area. Consecutive queries of overlapping areas (for example
+   * while panning the map) only read the cells that were not part of the
+   * last query.
+   *
+   * The cache is not thread safe, the index using it guards it by its own
+   * mutex.
+   */
+  class OSMSCOUT_API IndexCellCache
+  {
+  private:
+    struct CellKey
+    {
+      TypeId   type;
+      uint32_t x;
+      uint32_t y;
+
+      bool operator<(const CellKey& other) const;
+    };
+
+    struct Cell
+    {
+      std::vector<FileOffset> offsets;    //! Offsets of the objects in the cell
+      uint32_t                generation; //! Query that used the cell last
+    };
+
+    typedef std::map<CellKey,Cell> CellMap;
+
+  private:
+    CellMap  cells;
+    uint32_t generation; //! Number of the current query
+    size_t   hits;       //! Number of cells found in the cache
+    size_t   misses;     //! Number of cells read from disk
+
+  public:
+    IndexCellCache();
+
+    void StartQuery();
+    void FinishQuery();
+
+    const std::vector<FileOffset>* GetCell(TypeId type,
+                                           uint32_t x,
+                                           uint32_t y);
+    std::vector<FileOffset>& AddCell(TypeId type,
+                                     uint32_t x,
+                                     uint32_t y);
+
+    void Clear();
+
+    inline size_t GetCellCount() const
+    {
+      return cells.size();
+    }
+
+    inline size_t GetHits() const
+    {
+      return hits;
+    }
+
+    inline size_t GetMisses() const
+    {
+      return misses;
+    }
+  };
+}
+
+#endif
@@ -28,6 +28,7 @@
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/Database.h>
+#include <osmscout/IndexCellCache.h>
 
 #include <osmscout/util/Breaker.h>
 #include <osmscout/util/StopClock.h>
@@ -35,6 +36,42 @@
 
 namespace osmscout {
 
+  /**
+   * \ingroup Service
+   * State of incremental queries: The index cells read by the last query.
+   *
+   * Passing the same instance (via AreaSearchParameter::SetQueryCache()) to
+   * consecutive queries of overlapping areas (for example while panning the
+   * map) only reads the index cells not already read by the last query.
+   * Together with passing the result of the last query to
+   * MapService::GetObjects() (objects are reused by file offset) only the
+   * newly visible area has to be loaded from disk.
+   */
+  class OSMSCOUT_API MapQueryCache : public Referencable
+  {
+  private:
+    IndexCellCache nodeCells; //! Cells of the area node index
+    IndexCellCache wayCells;  //! Cells of the area way index
+
+  public:
+    MapQueryCache();
+    virtual ~MapQueryCache();
+
+    inline IndexCellCache& GetNodeCells()
+    {
+      return nodeCells;
+    }
+
+    inline IndexCellCache& GetWayCells()
+    {
+      return wayCells;
+    }
+
+    void Clear();
+  };
+
+  typedef Ref<MapQueryCache> MapQueryCacheRef;
+
   /**
     Parameter to influence the search result for searching for (drawable)
     objects in a given area.
@@ -42,13 +79,14 @@ namespace osmscout {
   class OSMSCOUT_API AreaSearchParameter
   {
   private:
-    unsigned long maxAreaLevel;
-    unsigned long maxNodes;
-    unsigned long maxWays;
-    unsigned long maxAreas;
-    bool          useLowZoomOptimization;
-    BreakerRef    breaker;
-    bool          useMultithreading;
+    unsigned long    maxAreaLevel;
+    unsigned long    maxNodes;
+    unsigned long    maxWays;
+    unsigned long    maxAreas;
+    bool             useLowZoomOptimization;
+    BreakerRef       breaker;
+    bool             useMultithreading;
+    MapQueryCacheRef queryCache;
 
   public:
     AreaSearchParameter();
@@ -65,6 +103,8 @@ namespace osmscout {
 
     void SetBreaker(const BreakerRef& breaker);
 
+    void SetQueryCache(const MapQueryCacheRef& queryCache);
+
     unsigned long GetMaximumAreaLevel() const;
 
     unsigned long GetMaximumNodes() const;
@@ -76,6 +116,8 @@ namespace osmscout {
     bool GetUseMultithreading() const;
 
     bool IsAborted() const;
+
+    MapQueryCacheRef GetQueryCache() const;
   };
 
   /**
@@ -94,6 +136,33 @@ namespace osmscout {
     DatabaseRef database;
 
   private:
+    bool GetNodeOffsets(const AreaSearchParameter& parameter,
+                        const TypeSet &nodeTypes,
+                        double lonMin, double latMin,
+                        double lonMax, double latMax,
+                        std::string& nodeIndexTime,
+                        std::vector<FileOffset>& offsets) const;
+
+    bool GetWayOffsets(const AreaSearchParameter& parameter,
+                       const std::vector<TypeSet>& wayTypes,
+                       const Magnification& magnification,
+                       double lonMin, double latMin,
+                       double lonMax, double latMax,
+                       std::string& wayOptimizedTime,
+                       std::string& wayIndexTime,
+                       std::vector<WayRef>& optimizedWays,
+                       std::vector<FileOffset>& offsets) const;
+
+    bool GetAreaOffsets(const AreaSearchParameter& parameter,
+                        const TypeSet& areaTypes,
+                        const Magnification& magnification,
+                        double lonMin, double latMin,
+                        double lonMax, double latMax,
+                        std::string& areaOptimizedTime,
+                        std::string& areaIndexTime,
+                        std::vector<AreaRef>& optimizedAreas,
+                        std::vector<FileOffset>& offsets) const;
+
     bool GetObjectsNodes(const AreaSearchParameter& parameter,
                          const TypeSet &nodeTypes,
                          double lonMin, double latMin,
@@ -122,6 +191,26 @@ namespace osmscout {
                                std::string& areasTime,
                                std::vector<AreaRef>& areas) const;
 
+    bool GetObjectsNodes(const AreaSearchParameter& parameter,
+                         const TypeSet &nodeTypes,
+                         double lonMin, double latMin,
+                         double lonMax, double latMax,
+                         std::vector<NodeView>& nodes) const;
+
+    bool GetObjectsWays(const AreaSearchParameter& parameter,
+                        const std::vector<TypeSet>& wayTypes,
+                        const Magnification& magnification,
+                        double lonMin, double latMin,
+                        double lonMax, double latMax,
+                        std::vector<WayView>& ways) const;
+
+    bool GetObjectsAreas(const AreaSearchParameter& parameter,
+                         const TypeSet& areaTypes,
+                         const Magnification& magnification,
+                         double lonMin, double latMin,
+                         double lonMax, double latMax,
+                         std::vector<AreaView>& areas) const;
+
   public:
     MapService(const DatabaseRef& database);
     virtual ~MapService();
@@ -152,6 +241,21 @@ namespace osmscout {
                     double areaLonMax, double areaLatMax,
                     std::vector<AreaRef>& areas) const;
 
+    bool GetObjects(const AreaSearchParameter& parameter,
+                    const Magnification& magnification,
+                    const TypeSet &nodeTypes,
+                    double nodeLonMin, double nodeLatMin,
+                    double nodeLonMax, double nodeLatMax,
+                    std::vector<NodeView>& nodes,
+                    const std::vector<TypeSet>& wayTypes,
+                    double wayLonMin, double wayLatMin,
+                    double wayLonMax, double wayLatMax,
+                    std::vector<WayView>& ways,
+                    const TypeSet& areaTypes,
+                    double areaLonMin, double areaLatMin,
+                    double areaLonMax, double areaLatMax,
+                    std::vector<AreaView>& areas) const;
+
     bool GetGroundTiles(double lonMin, double latMin,
                         double lonMax, double latMax,
                         const Magnification& magnification,
@@ -24,6 +24,16 @@
 #include <osmscout/DataFile.h>
 
 namespace osmscout {
+  /**
+    \ingroup Database
+    Cache cost of a node, see GetDataCacheCost().
+    */
+  inline unsigned long GetDataCacheCost(const Node& node,
+                                        unsigned long /*dataSize*/)
+  {
+    return (unsigned long)node.GetMemoryUsage();
+  }
+
   /**
     \ingroup Database
     Abstraction for getting cached access to the 'nodes.dat' file.
@@ -31,7 +41,8 @@ namespace osmscout {
   class NodeDataFile : public DataFile<Node>
   {
   public:
-    NodeDataFile(unsigned long dataCacheSize);
+    NodeDataFile(unsigned long dataCacheSize,
+                 unsigned long dataCacheMemory=0);
   };
 
   typedef Ref<NodeDataFile> NodeDataFileRef;
@@ -24,11 +24,12 @@
 
 #include <osmscout/TypeConfig.h>
 
-#include <osmscout/util/Cache.h>
 #include <osmscout/util/Number.h>
 #include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
+#include <osmscout/util/ShardedCache.h>
 #include <osmscout/util/String.h>
 
 namespace osmscout {
@@ -37,6 +38,9 @@ namespace osmscout {
     \ingroup Database
     Numeric index handles an index over instance of class <T> where the index criteria
     is of type <N>, where <N> has a numeric nature (usually Id).
+
+    Lookups are serialized by an internal mutex, so one index instance can be
+    shared between multiple threads.
     */
   template <class N>
   class NumericIndex
@@ -63,18 +67,15 @@ namespace osmscout {
 
     typedef LazyRef<Page> PageRef;
 
-    typedef Cache<N,PageRef> PageCache;
+    typedef ShardedCache<N,PageRef> PageCache;
 
     /**
       Returns the size of a individual cache entry
       */
-    struct NumericIndexCacheValueSizer : public PageCache::ValueSizer
+    static unsigned long GetPageMemory(const PageRef& value)
     {
-      unsigned long GetSize(const PageRef& value) const
-      {
-        return sizeof(value)+sizeof(Page)+sizeof(Entry)*value->entries.size();
-      }
-    };
+      return sizeof(value)+sizeof(Page)+sizeof(Entry)*value->entries.size();
+    }
 
   private:
     std::string                    filepart;
@@ -88,7 +89,8 @@ namespace osmscout {
     std::vector<uint32_t>          pageCounts;
     char                           *buffer;
     PageRef                        root;
-    mutable std::vector<PageCache> leafs;
+    std::vector<PageCache*>        leafs;
+    mutable Mutex                  accessMutex; //! Mutex guarding scanner, buffer and page caches
 
   private:
     size_t GetPageIndex(const PageRef& page, N id) const;
@@ -131,6 +133,10 @@ namespace osmscout {
   {
     Close();
 
+    for (size_t i=0; i<leafs.size(); i++) {
+      delete leafs[i];
+    }
+
     delete [] buffer;
   }
 
@@ -268,6 +274,12 @@ namespace osmscout {
     unsigned long currentCacheSize=cacheSize;
     unsigned long requiredCacheSize=0;
 
+    for (size_t i=0; i<leafs.size(); i++) {
+      delete leafs[i];
+    }
+
+    leafs.clear();
+
     for (size_t i=1; i<pageCounts.size(); i++) {
       unsigned long resultingCacheSize;
 
@@ -288,7 +300,7 @@ namespace osmscout {
 
       //std::cout << "Setting cache size for level " << i+1 << " with " << pageCounts[i] << " entries to " << resultingCacheSize << std::endl;
 
-      leafs.push_back(PageCache(resultingCacheSize));
+      leafs.push_back(new PageCache(resultingCacheSize));
     }
 
     return !scanner.HasError();
@@ -308,6 +320,8 @@ namespace osmscout {
   bool NumericIndex<N>::GetOffset(const N& id,
                                   FileOffset& offset) const
   {
+    MutexLocker locker(accessMutex);
+
     size_t r=GetPageIndex(root,id);
 
     if (!root->IndexIsValid(r)) {
@@ -319,25 +333,27 @@ namespace osmscout {
 
     N startId=root->entries[r].startId;
     for (size_t level=0; level+2<=levels; level++) {
-      typename PageCache::CacheRef cacheRef;
-
-      if (!leafs[level].GetEntry(startId,cacheRef)) {
-        typename PageCache::CacheEntry cacheEntry(startId);
+      PageRef page;
 
-        cacheRef=leafs[level].SetEntry(cacheEntry);
+      if (!leafs[level]->GetEntry(startId,page)) {
+        if (!ReadPage(offset,page)) {
+          return false;
+        }
 
-        ReadPage(offset,cacheRef->value);
+        leafs[level]->SetEntry(startId,
+                               page,
+                               GetPageMemory(page));
       }
 
-      size_t i=GetPageIndex(cacheRef->value,id);
+      size_t i=GetPageIndex(page,id);
 
-      if (!cacheRef->value->IndexIsValid(i)) {
+      if (!page->IndexIsValid(i)) {
         //std::cerr << "Id " << id << " not found in index level " << level+2 << "!" << std::endl;
         return false;
       }
 
-      startId=cacheRef->value->entries[i].startId;
-      offset=cacheRef->value->entries[i].fileOffset;
+      startId=page->entries[i].startId;
+      offset=page->entries[i].fileOffset;
     }
 
     /*
@@ -414,19 +430,29 @@ namespace osmscout {
   template <class N>
   void NumericIndex<N>::DumpStatistics() const
   {
-    size_t memory=0;
-    size_t pages=0;
+    MutexLocker locker(accessMutex);
+
+    size_t        memory=0;
+    size_t        pages=0;
+    unsigned long hits=0;
+    unsigned long misses=0;
+    unsigned long evictions=0;
 
     pages+=1;
     memory+=root->entries.size()*sizeof(Entry);
 
-
     for (size_t i=0; i<leafs.size(); i++) {
-      pages+=leafs[i].GetSize();
-      memory+=sizeof(leafs[i])+leafs[i].GetMemory(NumericIndexCacheValueSizer());
+      typename PageCache::Statistics statistics=leafs[i]->GetStatistics();
+
+      pages+=statistics.entries;
+      memory+=sizeof(PageCache)+statistics.memory;
+      hits+=statistics.hits;
+      misses+=statistics.misses;
+      evictions+=statistics.evictions;
     }
 
-    std::cout << "Index " << filepart << ": " << pages << " pages, memory " << memory << std::endl;
+    std::cout << "Index " << filepart << ": " << pages << " pages, memory " << memory;
+    std::cout << ", hits " << hits << ", misses " << misses << ", evictions " << evictions << std::endl;
   }
 }
 
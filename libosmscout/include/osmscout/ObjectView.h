@@ -0,0 +1,355 @@
+#ifndef OSMSCOUT_OBJECTVIEW_H
+#define OSMSCOUT_OBJECTVIEW_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <iterator>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Area.h>
+#include <osmscout/GeoCoord.h>
+#include <osmscout/Node.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Number.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   * Read-only sequence of coordinates. The coordinates are either decoded on
+   * the fly from the encoded representation in a memory mapped data file or
+   * are taken from an already decoded array of coordinates.
+   */
+  class OSMSCOUT_API GeoCoordView
+  {
+  public:
+    /**
+     * Forward iterator over the coordinates. Encoded coordinates are decoded
+     * while iterating.
+     */
+    class const_iterator : public std::iterator<std::forward_iterator_tag,GeoCoord>
+    {
+    private:
+      const char*        data;     //! Position of the current encoded coordinate
+      const ObjectCoord* coords;   //! Position of the current decoded coordinate
+      size_t             index;    //! Index of the current coordinate
+      size_t             count;    //! Number of coordinates
+      double             minLat;   //! Base latitude of the encoded coordinates
+      double             minLon;   //! Base longitude of the encoded coordinates
+      GeoCoord           current;  //! Current coordinate
+
+      inline void Decode()
+      {
+        if (index>=count) {
+          return;
+        }
+
+        if (coords!=NULL) {
+          current=coords[index];
+          return;
+        }
+
+        uint32_t latValue;
+        uint32_t lonValue;
+
+        data+=DecodeNumber(data,latValue);
+        data+=DecodeNumber(data,lonValue);
+
+        current.Set(minLat+latValue/latConversionFactor,
+                    minLon+lonValue/lonConversionFactor);
+      }
+
+    public:
+      inline const_iterator(const char* data,
+                            const ObjectCoord* coords,
+                            size_t index,
+                            size_t count,
+                            double minLat,
+                            double minLon)
+      : data(data),
+        coords(coords),
+        index(index),
+        count(count),
+        minLat(minLat),
+        minLon(minLon)
+      {
+        Decode();
+      }
+
+      inline const GeoCoord& operator*() const
+      {
+        return current;
+      }
+
+      inline const GeoCoord* operator->() const
+      {
+        return &current;
+      }
+
+      inline const_iterator& operator++()
+      {
+        index++;
+        Decode();
+
+        return *this;
+      }
+
+      inline const_iterator operator++(int)
+      {
+        const_iterator tmp(*this);
+
+        ++(*this);
+
+        return tmp;
+      }
+
+      inline bool operator==(const const_iterator& other) const
+      {
+        return index==other.index;
+      }
+
+      inline bool operator!=(const const_iterator& other) const
+      {
+        return index!=other.index;
+      }
+    };
+
+  private:
+    const char*        data;   //! Start of encoded coordinates (after the base coordinate), or NULL
+    const ObjectCoord* coords; //! Start of decoded coordinates, or NULL
+    size_t             count;  //! Number of coordinates
+    double             minLat; //! Base latitude of the encoded coordinates
+    double             minLon; //! Base longitude of the encoded coordinates
+
+  public:
+    GeoCoordView();
+    GeoCoordView(const std::vector<ObjectCoord>& coords);
+
+    bool Read(FileScanner& scanner,
+              const char* mappedData,
+              size_t count);
+
+    inline size_t size() const
+    {
+      return count;
+    }
+
+    inline bool empty() const
+    {
+      return count==0;
+    }
+
+    inline const_iterator begin() const
+    {
+      return const_iterator(data,coords,0,count,minLat,minLon);
+    }
+
+    inline const_iterator end() const
+    {
+      return const_iterator(NULL,NULL,count,count,minLat,minLon);
+    }
+
+    void CopyTo(std::vector<GeoCoord>& nodes) const;
+
+    void GetBoundingBox(double& minLon,
+                        double& maxLon,
+                        double& minLat,
+                        double& maxLat) const;
+  };
+
+  /**
+   * \ingroup Database
+   * Read-only view of a node. A view is either read directly from the memory
+   * mapped data file or wraps an already loaded Node.
+   */
+  class OSMSCOUT_API NodeView
+  {
+  private:
+    NodeRef            node;               //! Node the view is based on, if any
+    FileOffset         fileOffset;         //! File offset in the data file
+    GeoCoord           coords;             //! Coordinates of node
+    FeatureValueBuffer featureValueBuffer; //! List of features, if not based on a node
+
+  public:
+    NodeView();
+    NodeView(const NodeRef& node);
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return GetFeatureValueBuffer().GetType();
+    }
+
+    inline const GeoCoord& GetCoords() const
+    {
+      return coords;
+    }
+
+    inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+    {
+      return node.Valid() ? node->GetFeatureValueBuffer() : featureValueBuffer;
+    }
+
+    bool Read(const TypeConfig& typeConfig,
+              FileScanner& scanner,
+              const char* mappedData);
+  };
+
+  /**
+   * \ingroup Database
+   * Read-only view of a way. A view is either read directly from the memory
+   * mapped data file or wraps an already loaded Way. Coordinates of a view
+   * read from the data file are decoded lazily while iterating, node ids
+   * are not available.
+   */
+  class OSMSCOUT_API WayView
+  {
+  private:
+    WayRef             way;                //! Way the view is based on, if any
+    FileOffset         fileOffset;         //! File offset in the data file
+    FeatureValueBuffer featureValueBuffer; //! List of features, if not based on a way
+    GeoCoordView       nodes;              //! Coordinates of the way
+
+  public:
+    WayView();
+    WayView(const WayRef& way);
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return GetFeatureValueBuffer().GetType();
+    }
+
+    inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+    {
+      return way.Valid() ? way->GetFeatureValueBuffer() : featureValueBuffer;
+    }
+
+    inline const GeoCoordView& GetNodes() const
+    {
+      return nodes;
+    }
+
+    bool Read(const TypeConfig& typeConfig,
+              FileScanner& scanner,
+              const char* mappedData);
+  };
+
+  /**
+   * \ingroup Database
+   * Read-only view of an area. A view is either read directly from the memory
+   * mapped data file or wraps an already loaded Area. Coordinates of a view
+   * read from the data file are decoded lazily while iterating, node ids
+   * are not available.
+   */
+  class OSMSCOUT_API AreaView
+  {
+  public:
+    /**
+     * Read-only view of one ring of the area.
+     */
+    class OSMSCOUT_API Ring
+    {
+    private:
+      const Area::Ring   *ring;              //! Ring the view is based on, if any
+      FeatureValueBuffer featureValueBuffer; //! List of features, if not based on a ring
+      uint8_t            level;              //! The ring hierarchy number (0...n)
+      GeoCoordView       nodes;              //! Coordinates of the ring
+
+      friend class AreaView;
+
+    public:
+      Ring();
+      Ring(const Area::Ring& ring);
+
+      inline TypeInfoRef GetType() const
+      {
+        return GetFeatureValueBuffer().GetType();
+      }
+
+      inline const FeatureValueBuffer& GetFeatureValueBuffer() const
+      {
+        return ring!=NULL ? ring->GetFeatureValueBuffer() : featureValueBuffer;
+      }
+
+      inline uint8_t GetRing() const
+      {
+        return level;
+      }
+
+      inline const GeoCoordView& GetNodes() const
+      {
+        return nodes;
+      }
+    };
+
+  private:
+    AreaRef           area;       //! Area the view is based on, if any
+    FileOffset        fileOffset; //! File offset in the data file
+    std::vector<Ring> rings;      //! The rings of the area
+
+  private:
+    bool SkipIds(FileScanner& scanner,
+                 uint32_t nodesCount);
+
+  public:
+    AreaView();
+    AreaView(const AreaRef& area);
+
+    inline FileOffset GetFileOffset() const
+    {
+      return fileOffset;
+    }
+
+    inline TypeInfoRef GetType() const
+    {
+      return rings.front().GetType();
+    }
+
+    inline bool IsSimple() const
+    {
+      return rings.size()==1;
+    }
+
+    inline const std::vector<Ring>& GetRings() const
+    {
+      return rings;
+    }
+
+    bool Read(const TypeConfig& typeConfig,
+              FileScanner& scanner,
+              const char* mappedData);
+  };
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef OSMSCOUT_ROUTEMATRIX_H
+#define OSMSCOUT_ROUTEMATRIX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/ObjectRef.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Routing
+   * Costs, distances and travel times of the routes from a number of sources
+   * to a number of targets, as calculated by
+   * RoutingService::CalculateRouteMatrix().
+   */
+  class OSMSCOUT_API RouteMatrix
+  {
+  public:
+    /**
+     * A position in the routing network, a node of a way
+     */
+    struct OSMSCOUT_API Position
+    {
+      ObjectFileRef object;    //! The object
+      size_t        nodeIndex; //! Index of the node within the object
+
+      Position();
+      Position(const ObjectFileRef& object,
+               size_t nodeIndex);
+    };
+
+    /**
+     * The route from one source to one target
+     */
+    struct OSMSCOUT_API Entry
+    {
+      bool   found;    //! A route was found
+      double costs;    //! Costs of the route as calculated by the routing profile
+      double distance; //! Length of the route in km
+      double time;     //! Travel time in hours
+
+      Entry();
+    };
+
+  private:
+    size_t             sourceCount;
+    size_t             targetCount;
+    std::vector<Entry> entries;     //! Entries of all sources, source by source
+
+  public:
+    RouteMatrix();
+
+    void Initialize(size_t sourceCount,
+                    size_t targetCount);
+
+    inline size_t GetSourceCount() const
+    {
+      return sourceCount;
+    }
+
+    inline size_t GetTargetCount() const
+    {
+      return targetCount;
+    }
+
+    inline const Entry& Get(size_t source,
+                            size_t target) const
+    {
+      return entries[source*targetCount+target];
+    }
+
+    inline Entry& Get(size_t source,
+                      size_t target)
+    {
+      return entries[source*targetCount+target];
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef OSMSCOUT_ROUTESEGMENTINDEX_H
+#define OSMSCOUT_ROUTESEGMENTINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
+#include <osmscout/util/Reference.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup Routing
+    Spatial index of all segments (pairs of consecutive nodes) of the ways
+    routable for a given vehicle. The index is a packed R-tree generated by
+    the import (see RouteSegmentIndexGenerator) and allows to find the
+    segments closest to a given coordinate without loading any ways.
+
+    File format:
+    - rootOffset (FileOffset)
+    - segmentCount (uint32_t)
+    - nodes, each consisting of
+      - leaf flag (uint8_t)
+      - entry count (uint8_t)
+      - entries:
+        - inner node: minLat, minLon, maxLat, maxLon (uint32_t each, in the
+          fixed point format of coordinates) and the offset of the child node
+        - leaf node: way offset (FileOffset), index of the first node of the
+          segment in the way (uint32_t, number) and the coordinates of both
+          segment nodes (uint32_t each, in the fixed point format of
+          coordinates)
+    */
+  class OSMSCOUT_API RouteSegmentIndex : public Referencable
+  {
+  public:
+    static const size_t maxNodeEntries=16; //! Maximum number of entries of a node
+
+    /**
+     * A segment found by GetClosestSegments()
+     */
+    struct OSMSCOUT_API Match
+    {
+      ObjectFileRef object;       //! The way the segment belongs to
+      size_t        segmentIndex; //! Index of the first node of the segment in the way
+      size_t        nodeIndex;    //! Index of the node of the segment closest to the projection
+      GeoCoord      projection;   //! The point on the segment closest to the search coordinate
+      double        distance;     //! Distance between the search coordinate and the projection in meter
+    };
+
+  private:
+    std::string         filename;    //! Full path and name of the data file
+    mutable FileScanner scanner;     //! Scanner instance for reading this file
+    mutable Mutex       accessMutex; //! Mutex guarding the scanner
+
+    FileOffset          rootOffset;  //! Offset of the root node
+    uint32_t            segmentCount;//! Number of segments in the index
+
+  public:
+    RouteSegmentIndex();
+    virtual ~RouteSegmentIndex();
+
+    bool Load(const std::string& filename);
+    void Close();
+
+    inline bool IsOpen() const
+    {
+      return scanner.IsOpen();
+    }
+
+    inline uint32_t GetSegmentCount() const
+    {
+      return segmentCount;
+    }
+
+    bool GetClosestSegments(const GeoCoord& coord,
+                            size_t count,
+                            double maxDistance,
+                            std::vector<Match>& matches) const;
+  };
+
+  typedef Ref<RouteSegmentIndex> RouteSegmentIndexRef;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef OSMSCOUT_ROUTINGGRAPH_H
+#define OSMSCOUT_ROUTINGGRAPH_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+#include <osmscout/RouteNode.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/Reference.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Routing
+   * The complete routing graph of one vehicle held in memory in compressed
+   * sparse row format: Route nodes are numbered in the order of their file
+   * offset, the paths of all nodes are stored in one array, each node
+   * referencing the index of its first path.
+   *
+   * Compared to the route nodes read from the data file, paths store the
+   * index of their target node instead of its file offset and reference
+   * the objects in one global, deduplicated object table. Coordinates and
+   * distances are stored in the fixed point format of the data file: Like in
+   * the route node, the coordinate of the target of a path is the minimum
+   * coordinate of all paths of the node plus an offset per path. GetPath()
+   * thus returns exactly the coordinates RouteNode::Read() decodes for the
+   * path, so costs and estimates do not differ from routing using the
+   * route nodes directly.
+   */
+  class OSMSCOUT_API RoutingGraph : public Referencable
+  {
+  public:
+    static const uint32_t noNode=0xffffffff;
+
+    /**
+     * A path from one node to another
+     */
+    struct OSMSCOUT_API Edge
+    {
+      uint32_t target;      //! Index of the target node
+      uint32_t object;      //! Index of the object in the object table
+      uint32_t distance;    //! Distance in 1/100 meter
+      uint32_t latValue;    //! Fixed point latitude of the target relative to the minimum of the node
+      uint32_t lonValue;    //! Fixed point longitude of the target relative to the minimum of the node
+      TypeId   type;        //! Type of the object
+      uint8_t  maxSpeed;    //! Maximum speed allowed on the way
+      uint8_t  grade;       //! Quality of road/track 1 (good)...5 (bad)
+      uint8_t  flags;       //! Flags as defined by RouteNode
+    };
+
+  private:
+    std::vector<FileOffset>         nodeOffsets;   //! File offsets of the route nodes, sorted
+    std::vector<uint32_t>           nodeLats;      //! Fixed point minimum latitude of the paths of the nodes
+    std::vector<uint32_t>           nodeLons;      //! Fixed point minimum longitude of the paths of the nodes
+    std::vector<uint32_t>           edgeStart;     //! Per node: Index of the first edge, plus a sentinel
+    std::vector<Edge>               edges;         //! Edges of all nodes
+    std::vector<ObjectFileRef>      objects;       //! All objects referenced by edges
+    std::vector<uint32_t>           excludeStart;  //! Per node: Index of the first exclude, plus a sentinel
+    std::vector<RouteNode::Exclude> excludes;      //! Turn restrictions of all nodes
+
+  public:
+    RoutingGraph();
+    virtual ~RoutingGraph();
+
+    bool Load(const std::string& filename);
+
+    uint32_t GetNodeIndex(FileOffset offset) const;
+
+    inline size_t GetNodeCount() const
+    {
+      return nodeOffsets.size();
+    }
+
+    inline size_t GetEdgeCount() const
+    {
+      return edges.size();
+    }
+
+    inline size_t GetObjectCount() const
+    {
+      return objects.size();
+    }
+
+    inline FileOffset GetNodeOffset(uint32_t node) const
+    {
+      return nodeOffsets[node];
+    }
+
+    inline uint32_t GetEdgesBegin(uint32_t node) const
+    {
+      return edgeStart[node];
+    }
+
+    inline uint32_t GetEdgesEnd(uint32_t node) const
+    {
+      return edgeStart[node+1];
+    }
+
+    inline const Edge& GetEdge(uint32_t index) const
+    {
+      return edges[index];
+    }
+
+    inline const ObjectFileRef& GetObject(uint32_t index) const
+    {
+      return objects[index];
+    }
+
+    inline bool HasExcludes(uint32_t node) const
+    {
+      return excludeStart[node]!=excludeStart[node+1];
+    }
+
+    bool IsExcluded(uint32_t node,
+                    const ObjectFileRef& source,
+                    uint32_t pathIndex) const;
+
+    void GetPath(uint32_t node,
+                 uint32_t edge,
+                 RouteNode::Path& path) const;
+
+    size_t GetMemoryUsage() const;
+  };
+
+  typedef Ref<RoutingGraph> RoutingGraphRef;
+}
+
+#endif
@@ -49,6 +49,7 @@ namespace osmscout {
 
     virtual bool CanUse(const RouteNode& currentNode,
                         size_t pathIndex) const = 0;
+    virtual bool CanUse(const RouteNode::Path& path) const = 0;
     virtual bool CanUse(const Area& area) const = 0;
     virtual bool CanUse(const Way& way) const = 0;
     virtual bool CanUseForward(const Way& way) const = 0;
@@ -56,12 +57,14 @@ namespace osmscout {
 
     virtual double GetCosts(const RouteNode& currentNode,
                             size_t pathIndex) const = 0;
+    virtual double GetCosts(const RouteNode::Path& path) const = 0;
     virtual double GetCosts(const Area& area,
                             double distance) const = 0;
     virtual double GetCosts(const Way& way,
                             double distance) const = 0;
     virtual double GetCosts(double distance) const = 0;
 
+    virtual double GetTime(const RouteNode::Path& path) const = 0;
     virtual double GetTime(const Area& area,
                            double distance) const = 0;
     virtual double GetTime(const Way& way,
@@ -107,15 +110,45 @@ namespace osmscout {
       return vehicle;
     }
 
+    inline double GetVehicleMaxSpeed() const
+    {
+      return vehicleMaxSpeed;
+    }
+
+    /**
+     * Return the speed for each type id, 0.0 if the type cannot be used
+     */
+    inline const std::vector<double>& GetSpeeds() const
+    {
+      return speeds;
+    }
+
     void AddType(TypeId type, double speed);
 
     bool CanUse(const RouteNode& currentNode,
                 size_t pathIndex) const;
+    bool CanUse(const RouteNode::Path& path) const;
     bool CanUse(const Area& area) const;
     bool CanUse(const Way& way) const;
     bool CanUseForward(const Way& way) const;
     bool CanUseBackward(const Way& way) const;
 
+    inline double GetTime(const RouteNode::Path& path) const
+    {
+      double speed;
+
+      if (path.maxSpeed>0) {
+        speed=path.maxSpeed;
+      }
+      else {
+        speed=speeds[path.type];
+      }
+
+      speed=std::min(vehicleMaxSpeed,speed);
+
+      return path.distance/speed;
+    }
+
     inline double GetTime(const Area& area,
                           double distance) const
     {
@@ -159,7 +192,12 @@ namespace osmscout {
     inline double GetCosts(const RouteNode& currentNode,
                            size_t pathIndex) const
     {
-      return currentNode.paths[pathIndex].distance;
+      return GetCosts(currentNode.paths[pathIndex]);
+    }
+
+    inline double GetCosts(const RouteNode::Path& path) const
+    {
+      return path.distance;
     }
 
     inline double GetCosts(const Area& /*area*/,
@@ -194,19 +232,24 @@ namespace osmscout {
 
     inline double GetCosts(const RouteNode& currentNode,
                            size_t pathIndex) const
+    {
+      return GetCosts(currentNode.paths[pathIndex]);
+    }
+
+    inline double GetCosts(const RouteNode::Path& path) const
     {
       double speed;
 
-      if (currentNode.paths[pathIndex].maxSpeed>0) {
-        speed=currentNode.paths[pathIndex].maxSpeed;
+      if (path.maxSpeed>0) {
+        speed=path.maxSpeed;
       }
       else {
-        speed=speeds[currentNode.paths[pathIndex].type];
+        speed=speeds[path.type];
       }
 
       speed=std::min(vehicleMaxSpeed,speed);
 
-      return currentNode.paths[pathIndex].distance/speed;
+      return path.distance/speed;
     }
 
     inline double GetCosts(const Area& area,
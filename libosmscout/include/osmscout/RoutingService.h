@@ -29,7 +29,11 @@
 
 #include <osmscout/TypeConfig.h>
 
+#include <osmscout/ContractionHierarchy.h>
+#include <osmscout/RouteMatrix.h>
 #include <osmscout/RouteNode.h>
+#include <osmscout/RouteSegmentIndex.h>
+#include <osmscout/RoutingGraph.h>
 
 // Datafiles
 #include <osmscout/Database.h>
@@ -43,6 +47,8 @@
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/HashMap.h>
 #include <osmscout/util/HashSet.h>
+#include <osmscout/util/IndexedHeap.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Reference.h>
 
 namespace osmscout {
@@ -56,18 +62,34 @@ namespace osmscout {
    *
    * The following groups attributes are currently available:
    * - Switch for showing debug information
+   * - Switch for the search core used for route calculation
+   * - Switch for the use of a contraction hierarchy, if available
+   * - Switch for holding the complete routing graph in memory
+   * - Number of threads used for calculating route matrices
    */
   class OSMSCOUT_API RouterParameter
   {
   private:
     bool          debugPerformance;
+    bool          useIndexedHeap;
+    bool          useContractionHierarchy;
+    bool          useInMemoryGraph;
+    size_t        matrixThreadCount;
 
   public:
     RouterParameter();
 
     void SetDebugPerformance(bool debug);
+    void SetUseIndexedHeap(bool useIndexedHeap);
+    void SetUseContractionHierarchy(bool useContractionHierarchy);
+    void SetUseInMemoryGraph(bool useInMemoryGraph);
+    void SetMatrixThreadCount(size_t matrixThreadCount);
 
     bool IsDebugPerformance() const;
+    bool GetUseIndexedHeap() const;
+    bool GetUseContractionHierarchy() const;
+    bool GetUseInMemoryGraph() const;
+    size_t GetMatrixThreadCount() const;
   };
 
   /**
@@ -166,6 +188,152 @@ namespace osmscout {
     typedef OSMSCOUT_HASHMAP<FileOffset,OpenListRef>      OpenMap;
     typedef OSMSCOUT_HASHMAP<FileOffset,RNodeRef>         CloseMap;
 
+    /**
+     * Search state of a route node in the indexed heap based search. All
+     * nodes of one search are stored in one vector and reference their
+     * predecessor by index instead of being allocated individually.
+     */
+    struct HNode
+    {
+      FileOffset    nodeOffset;    //! The file offset of the current route node
+      FileOffset    prev;          //! The file offset of the previous route node
+      size_t        prevIndex;     //! The index of the previous node, or noPrevIndex
+      ObjectFileRef object;        //! The object (way/area) visited from the current route node
+
+      double        currentCost;   //! The cost of the current up to the current node
+      double        estimateCost;  //! The estimated cost from here to the target
+      double        overallCost;   //! The overall costs (currentCost+estimateCost)
+
+      bool          access;        //! Flags to signal, if we had access ("access restrictions") to this node
+      bool          closed;        //! The node was taken from the open list
+    };
+
+    static const size_t noPrevIndex=(size_t)-1;
+
+    struct HNodeCostCompare
+    {
+      const std::vector<HNode>* nodes;
+
+      inline HNodeCostCompare(const std::vector<HNode>* nodes)
+      : nodes(nodes)
+      {
+        // no code
+      }
+
+      inline bool operator()(size_t a, size_t b) const
+      {
+        const HNode& nodeA=(*nodes)[a];
+        const HNode& nodeB=(*nodes)[b];
+
+        if (nodeA.overallCost==nodeB.overallCost) {
+         return nodeA.nodeOffset<nodeB.nodeOffset;
+        }
+        else {
+          return nodeA.overallCost<nodeB.overallCost;
+        }
+      }
+    };
+
+    typedef IndexedHeap<HNodeCostCompare,4>               HeapOpenList;
+    typedef OSMSCOUT_HASHMAP<FileOffset,size_t>           HNodeMap;
+    typedef OSMSCOUT_HASHMAP<uint32_t,size_t>             HNodeIndexMap;
+
+    static const uint32_t noPathIndex=0xffffffff;
+
+    /**
+     * Search state of a node in one direction of the bidirectional
+     * contraction hierarchy search.
+     */
+    struct CNode
+    {
+      uint32_t      node;          //! The index of the node in the contraction hierarchy
+      uint32_t      edge;          //! The edge used to reach the node, or ContractionHierarchy::noEdge
+      size_t        prevIndex;     //! The index of the previous search node, or noPrevIndex
+      ObjectFileRef object;        //! Forward search: The object of the last path used to reach the node
+      uint32_t      pathIndex;     //! Backward search: The index of the path taken at the node, or noPathIndex
+      double        costs;         //! The costs from the start (forward) or to the target (backward)
+      bool          closed;        //! The node was taken from the open list
+    };
+
+    struct CNodeCostCompare
+    {
+      const std::vector<CNode>* nodes;
+
+      inline CNodeCostCompare(const std::vector<CNode>* nodes)
+      : nodes(nodes)
+      {
+        // no code
+      }
+
+      inline bool operator()(size_t a, size_t b) const
+      {
+        const CNode& nodeA=(*nodes)[a];
+        const CNode& nodeB=(*nodes)[b];
+
+        if (nodeA.costs==nodeB.costs) {
+         return nodeA.node<nodeB.node;
+        }
+        else {
+          return nodeA.costs<nodeB.costs;
+        }
+      }
+    };
+
+    typedef IndexedHeap<CNodeCostCompare,4>               CHOpenList;
+    typedef OSMSCOUT_HASHMAP<uint32_t,size_t>             CNodeMap;
+
+    /**
+     * A route node of the routing graph a route matrix search starts at (for
+     * a source) or ends at (for a target), together with the costs between
+     * the route node and the node of the way given as source or target.
+     */
+    struct MatrixNode
+    {
+      uint32_t      node;          //! Index of the route node in the routing graph
+      double        costs;         //! Costs between the route node and the position
+      double        distance;      //! Distance between the route node and the position in km
+      double        time;          //! Travel time between the route node and the position in hours
+    };
+
+    /**
+     * A source or target of a route matrix with the route nodes to start at
+     * or end at
+     */
+    struct MatrixPosition
+    {
+      ObjectFileRef           object;    //! The way
+      size_t                  nodeIndex; //! Index of the node in the way
+      WayRef                  way;       //! The way, if it is routable
+      std::vector<MatrixNode> nodes;     //! Route nodes to start or end at
+    };
+
+  public:
+    /**
+     * Statistics of the last route calculation
+     */
+    struct Statistics
+    {
+      size_t nodesLoaded;  //! Number of route nodes taken from the open list (settled)
+      size_t nodesIgnored; //! Number of paths ignored because of restrictions
+      size_t maxOpenList;  //! Maximum size of the open list
+      size_t maxCloseMap;  //! Maximum number of closed route nodes
+      double searchTime;   //! Time for searching the routing graph in milliseconds
+      bool   contractionHierarchy; //! The route was found using the contraction hierarchy
+      bool   inMemoryGraph;        //! The route was found searching the in-memory routing graph
+
+      Statistics()
+      : nodesLoaded(0),
+        nodesIgnored(0),
+        maxOpenList(0),
+        maxCloseMap(0),
+        searchTime(0.0),
+        contractionHierarchy(false),
+        inMemoryGraph(false)
+      {
+        // no code
+      }
+    };
+
   public:
     //! Relative filename of the intersection data file
     static const char* const FILENAME_INTERSECTIONS_DAT;
@@ -186,6 +354,17 @@ namespace osmscout {
     static const char* const FILENAME_CAR_DAT;
     //! Relative filename of the routing graph index file for car
     static const char* const FILENAME_CAR_IDX;
+    //! Relative filename of the contraction hierarchy for the car routing graph
+    static const char* const FILENAME_CAR_CH_DAT;
+
+    //! Relative filename of the index of routable segments for foot
+    static const char* const FILENAME_FOOT_SEGMENTS_IDX;
+    //! Relative filename of the index of routable segments for bicycle
+    static const char* const FILENAME_BICYCLE_SEGMENTS_IDX;
+    //! Relative filename of the index of routable segments for car
+    static const char* const FILENAME_CAR_SEGMENTS_IDX;
+
+    static std::string GetSegmentIndexFilename(Vehicle vehicle);
 
   private:
     DatabaseRef                          database;          //! Database object, holding all index and data files
@@ -193,16 +372,33 @@ namespace osmscout {
     AccessFeatureValueReader             accessReader;      //! Read access information from objects
     bool                                 isOpen;            //! true, if opened
     bool                                 debugPerformance;
+    bool                                 useIndexedHeap;    //! Use the indexed heap instead of the std::set based search
+    bool                                 useContractionHierarchy; //! Use the contraction hierarchy, if available
+    bool                                 useInMemoryGraph;  //! Load the routing graph into memory on Open()
+    size_t                               matrixThreadCount; //! Number of threads for calculating route matrices
+    Statistics                           statistics;        //! Statistics of the last route calculation
 
     std::string                          path;              //! Path to the directory containing all files
 
     IndexedDataFile<Id,RouteNode>        routeNodeDataFile; //! Cached access to the 'route.dat' file
     IndexedDataFile<Id,Intersection>     junctionDataFile;  //! Cached access to the 'junctions.dat' file
+    ContractionHierarchyRef              contractionHierarchy; //! The contraction hierarchy of the routing graph, if available
+    RoutingGraphRef                      routingGraph;      //! The routing graph held in memory, if requested
+    RouteSegmentIndexRef                 segmentIndex;      //! Index of the routable segments, if available
 
   private:
     std::string GetDataFilename(Vehicle vehicle) const;
     std::string GetIndexFilename(Vehicle vehicle) const;
 
+    bool LoadRoutingGraph();
+
+    bool GetClosestRoutableNodeByScan(double lat,
+                                      double lon,
+                                      const osmscout::Vehicle& vehicle,
+                                      double radius,
+                                      osmscout::ObjectFileRef& object,
+                                      size_t& nodeIndex) const;
+
     void GetStartForwardRouteNode(const RoutingProfile& profile,
                                   const WayRef& way,
                                   size_t nodeIndex,
@@ -245,6 +441,44 @@ namespace osmscout {
     void ResolveRNodeChainToList(const RNodeRef& end,
                                  const CloseMap& closeMap,
                                  std::list<RNodeRef>& nodes);
+    void ResolveHNodeChainToList(size_t end,
+                                 const std::vector<HNode>& hnodes,
+                                 std::list<RNodeRef>& nodes);
+
+    bool SearchRouteOpenList(const RoutingProfile& profile,
+                             double targetLon,
+                             double targetLat,
+                             const RNodeRef& startForwardNode,
+                             const RNodeRef& startBackwardNode,
+                             const RouteNodeRef& targetForwardRouteNode,
+                             const RouteNodeRef& targetBackwardRouteNode,
+                             std::list<RNodeRef>& nodes);
+    bool SearchRouteIndexedHeap(const RoutingProfile& profile,
+                                double targetLon,
+                                double targetLat,
+                                const RNodeRef& startForwardNode,
+                                const RNodeRef& startBackwardNode,
+                                const RouteNodeRef& targetForwardRouteNode,
+                                const RouteNodeRef& targetBackwardRouteNode,
+                                std::list<RNodeRef>& nodes);
+    bool SearchRouteInMemoryGraph(const RoutingProfile& profile,
+                                  double targetLon,
+                                  double targetLat,
+                                  const RNodeRef& startForwardNode,
+                                  const RNodeRef& startBackwardNode,
+                                  const RouteNodeRef& targetForwardRouteNode,
+                                  const RouteNodeRef& targetBackwardRouteNode,
+                                  std::list<RNodeRef>& nodes);
+    void ResolveCNodeChainsToList(size_t forwardEnd,
+                                  const std::vector<CNode>& forwardNodes,
+                                  size_t backwardEnd,
+                                  const std::vector<CNode>& backwardNodes,
+                                  std::list<RNodeRef>& nodes);
+    bool SearchRouteContractionHierarchy(const RNodeRef& startForwardNode,
+                                         const RNodeRef& startBackwardNode,
+                                         const RouteNodeRef& targetForwardRouteNode,
+                                         const RouteNodeRef& targetBackwardRouteNode,
+                                         std::list<RNodeRef>& nodes);
     bool ResolveRNodesToRouteData(const RoutingProfile& profile,
                                   const std::list<RNodeRef>& nodes,
                                   const ObjectFileRef& startObject,
@@ -255,6 +489,23 @@ namespace osmscout {
 
     bool ResolveRouteDataJunctions(RouteData& route);
 
+    bool GetMatrixPosition(const RoutingProfile& profile,
+                           const RouteMatrix::Position& position,
+                           bool isSource,
+                           MatrixPosition& matrixPosition);
+    void SearchRouteMatrixRow(const RoutingProfile& profile,
+                              const MatrixPosition& source,
+                              const std::vector<MatrixPosition>& targets,
+                              const OSMSCOUT_HASHSET<uint32_t>& targetNodes,
+                              RouteMatrix::Entry* entries) const;
+    void CalculateRouteMatrixRows(const RoutingProfile* profile,
+                                  const std::vector<MatrixPosition>* sources,
+                                  const std::vector<MatrixPosition>* targets,
+                                  const OSMSCOUT_HASHSET<uint32_t>* targetNodes,
+                                  Mutex* mutex,
+                                  size_t* nextSource,
+                                  RouteMatrix* matrix) const;
+
     void AddNodes(RouteData& route,
                   Id startNodeId,
                   size_t startNodeIndex,
@@ -292,6 +543,17 @@ namespace osmscout {
                         std::vector<osmscout::GeoCoord> via,
                         RouteData& route);
 
+    bool CalculateRouteMatrix(const RoutingProfile& profile,
+                              const std::vector<RouteMatrix::Position>& sources,
+                              const std::vector<RouteMatrix::Position>& targets,
+                              RouteMatrix& matrix);
+
+    bool CalculateRouteMatrix(const RoutingProfile& profile,
+                              double radius,
+                              const std::vector<GeoCoord>& sources,
+                              const std::vector<GeoCoord>& targets,
+                              RouteMatrix& matrix);
+
     bool TransformRouteDataToWay(const RouteData& data,
                                  Way& way);
 
@@ -308,6 +570,14 @@ namespace osmscout {
                                 osmscout::ObjectFileRef& object,
                                 size_t& nodeIndex) const;
 
+    bool GetClosestRoutableSegments(const GeoCoord& coord,
+                                    size_t count,
+                                    double radius,
+                                    std::vector<RouteSegmentIndex::Match>& matches) const;
+
+    const Statistics& GetStatistics() const;
+    RoutingGraphRef GetRoutingGraph() const;
+
     void DumpStatistics();
   };
 
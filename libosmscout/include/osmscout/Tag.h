@@ -26,6 +26,8 @@
 
 #include <osmscout/private/CoreImportExport.h>
 
+#include <osmscout/TagMap.h>
+
 #include <osmscout/util/HashMap.h>
 #include <osmscout/util/Parser.h>
 #include <osmscout/util/Reference.h>
@@ -34,8 +36,6 @@
 
 namespace osmscout {
 
-  typedef uint16_t TagId;
-
   /**
    * \ingroup type
    *
@@ -53,7 +53,7 @@ namespace osmscout {
   public:
     virtual ~TagCondition();
 
-    virtual bool Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const = 0;
+    virtual bool Evaluate(const TagMap& tagMap) const = 0;
   };
 
   /**
@@ -76,7 +76,12 @@ namespace osmscout {
   public:
     TagNotCondition(TagCondition* condition);
 
-    bool Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const;
+    inline const TagConditionRef& GetCondition() const
+    {
+      return condition;
+    }
+
+    bool Evaluate(const TagMap& tagMap) const;
   };
 
   /**
@@ -102,7 +107,17 @@ namespace osmscout {
 
     void AddCondition(TagCondition* condition);
 
-    bool Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const;
+    inline Type GetType() const
+    {
+      return type;
+    }
+
+    inline const std::list<TagConditionRef>& GetConditions() const
+    {
+      return conditions;
+    }
+
+    bool Evaluate(const TagMap& tagMap) const;
   };
 
   /**
@@ -118,7 +133,12 @@ namespace osmscout {
   public:
     TagExistsCondition(TagId tag);
 
-    bool Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const;
+    inline TagId GetTag() const
+    {
+      return tag;
+    }
+
+    bool Evaluate(const TagMap& tagMap) const;
   };
 
   /**
@@ -150,7 +170,36 @@ namespace osmscout {
                        BinaryOperator binaryOperator,
                        const size_t& tagValue);
 
-    bool Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const;
+    inline TagId GetTag() const
+    {
+      return tag;
+    }
+
+    inline BinaryOperator GetOperator() const
+    {
+      return binaryOperator;
+    }
+
+    /**
+     * Returns true, if the tag value is compared as number (see GetSizeValue()),
+     * else it is compared as string (see GetStringValue())
+     */
+    inline bool HasSizeValue() const
+    {
+      return valueType==sizet;
+    }
+
+    inline const std::string& GetStringValue() const
+    {
+      return tagStringValue;
+    }
+
+    inline size_t GetSizeValue() const
+    {
+      return tagSizeValue;
+    }
+
+    bool Evaluate(const TagMap& tagMap) const;
   };
 
   /**
@@ -170,7 +219,17 @@ namespace osmscout {
 
     void AddTagValue(const std::string& tagValue);
 
-    bool Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const;
+    inline TagId GetTag() const
+    {
+      return tag;
+    }
+
+    inline const std::set<std::string>& GetTagValues() const
+    {
+      return tagValues;
+    }
+
+    bool Evaluate(const TagMap& tagMap) const;
   };
 
   /**
@@ -0,0 +1,184 @@
+#ifndef OSMSCOUT_TAGCLASSIFIER_H
+#define OSMSCOUT_TAGCLASSIFIER_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Tag.h>
+#include <osmscout/TagMap.h>
+
+#include <osmscout/system/Types.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup type
+   *
+   * Compiled form of an ordered list of tag conditions ("rules"), as used
+   * by TypeConfig to assign a type to an OSM object based on its tags.
+   *
+   * Each rule is compiled into a flat list of instructions. Tag values
+   * compared for (in)equality are replaced by value ids, interned per tag,
+   * so that most comparisons are integer comparisons. Additionally for each
+   * rule a set of tags (or tag values) is calculated, one of which must be
+   * present for the rule to possibly match. Matching an object thus only
+   * evaluates the rules triggered by its tags (plus the few rules that
+   * cannot be indexed, like negations) in the order they were added.
+   *
+   * Match() returns the same result as evaluating the original conditions
+   * one after another and returning the first that matches.
+   */
+  class OSMSCOUT_API TagClassifier
+  {
+  private:
+    enum Operation {
+      opAnd,
+      opOr,
+      opNot,
+      opExists,
+      opEqual,         //! string equality, by value id
+      opNotEqual,      //! string inequality, by value id
+      opIsIn,          //! string set membership, by value id
+      opCompareString, //! string ordering
+      opCompareSize    //! numerical comparison
+    };
+
+    struct Instruction
+    {
+      Operation      operation;
+      BinaryOperator binaryOperator;
+      TagId          tag;
+      uint32_t       valueId;     //! Value id for opEqual and opNotEqual
+      size_t         sizeValue;   //! Value for opCompareSize
+      std::string    stringValue; //! Value for opCompareString
+      size_t         first;       //! First operand (child instruction or value id)
+      size_t         count;       //! Number of operands
+    };
+
+    struct Rule
+    {
+      size_t        instruction; //! Root instruction of the condition
+      unsigned char types;       //! Types this rule applies to
+      size_t        value;       //! The value returned on a match
+    };
+
+    /**
+     * An interned tag value
+     */
+    struct Value
+    {
+      std::string value;
+      uint32_t    id;
+    };
+
+    /**
+     * Sorts interned values and compares them with object tag values
+     */
+    struct ValueLess
+    {
+      inline bool operator()(const Value& a,
+                             const Value& b) const
+      {
+        return a.value<b.value;
+      }
+
+      inline bool operator()(const Value& a,
+                             const TagValue& b) const
+      {
+        return b.Compare(a.value)>0;
+      }
+    };
+
+    /**
+     * Index data of a tag referenced by at least one rule
+     */
+    struct Key
+    {
+      std::vector<size_t>               anyValueRules; //! Rules triggered by the tag, independent of the value
+      std::vector<Value>                values;        //! Interned values sorted by value, ids start with 1
+      std::vector<std::vector<size_t> > valueRules;    //! Rules triggered by the value with id-1
+    };
+
+    /**
+     * A tag that must be present for a rule to match, valueId 0 means
+     * that any value will do.
+     */
+    struct Trigger
+    {
+      TagId    tag;
+      uint32_t valueId;
+    };
+
+    /**
+     * A tag of an object to classify, as referenced by the rules
+     */
+    struct ObjectTag
+    {
+      TagId           tag;
+      uint32_t        valueId;
+      const TagValue* value;
+    };
+
+  private:
+    std::vector<Instruction> instructions;
+    std::vector<size_t>      operands;           //! Operands of opAnd, opOr, opNot and opIsIn
+    std::vector<Rule>        rules;
+    std::vector<Key>         keys;
+    std::vector<size_t>      keyIndex;           //! Index into keys+1 by TagId, 0 if the tag is not referenced
+    std::vector<uint64_t>    unconditionalRules; //! Bitset of rules that must be evaluated for every object
+
+  private:
+    Key& GetKey(TagId tag);
+    uint32_t GetValueId(TagId tag,
+                        const std::string& value);
+    size_t Compile(const TagCondition& condition);
+    bool GetTriggers(size_t instruction,
+                     std::vector<Trigger>& triggers) const;
+
+    bool Evaluate(size_t instruction,
+                  const ObjectTag* values,
+                  size_t valueCount) const;
+
+  public:
+    TagClassifier();
+
+    void Clear();
+
+    void AddRule(const TagCondition& condition,
+                 unsigned char types,
+                 size_t value);
+
+    bool Match(const TagMap& tagMap,
+               unsigned char types,
+               size_t& value,
+               unsigned char& ruleTypes) const;
+
+    inline size_t GetRuleCount() const
+    {
+      return rules.size();
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef OSMSCOUT_TAGMAP_H
+#define OSMSCOUT_TAGMAP_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/system/Types.h>
+
+namespace osmscout {
+
+  typedef uint16_t TagId;
+
+  /**
+   * \ingroup type
+   *
+   * The value of a tag. The value does not own the string it refers to,
+   * it is only valid as long as the string it was created from. The
+   * string is always zero terminated.
+   */
+  class OSMSCOUT_API TagValue
+  {
+  private:
+    const char* value;
+    size_t      length;
+
+  public:
+    inline TagValue()
+    : value(""),
+      length(0)
+    {
+      // no code
+    }
+
+    inline TagValue(const char* value,
+                    size_t length)
+    : value(value),
+      length(length)
+    {
+      // no code
+    }
+
+    inline explicit TagValue(const std::string& value)
+    : value(value.c_str()),
+      length(value.length())
+    {
+      // no code
+    }
+
+    inline const char* c_str() const
+    {
+      return value;
+    }
+
+    inline size_t GetLength() const
+    {
+      return length;
+    }
+
+    inline bool empty() const
+    {
+      return length==0;
+    }
+
+    /**
+     * Returns a copy of the value
+     */
+    inline std::string ToString() const
+    {
+      return std::string(value,length);
+    }
+
+    /**
+     * Compares the value with the given string, the result is like that
+     * of std::string::compare()
+     */
+    inline int Compare(const char* other,
+                       size_t otherLength) const
+    {
+      int result=memcmp(value,
+                        other,
+                        length<otherLength ? length : otherLength);
+
+      if (result!=0) {
+        return result;
+      }
+
+      return length<otherLength ? -1 : (length>otherLength ? 1 : 0);
+    }
+
+    inline int Compare(const std::string& other) const
+    {
+      return Compare(other.c_str(),
+                     other.length());
+    }
+
+    inline bool operator==(const char* other) const
+    {
+      return strcmp(value,other)==0;
+    }
+
+    inline bool operator!=(const char* other) const
+    {
+      return strcmp(value,other)!=0;
+    }
+
+    inline bool operator==(const std::string& other) const
+    {
+      return length==other.length() &&
+             memcmp(value,other.c_str(),length)==0;
+    }
+
+    inline bool operator!=(const std::string& other) const
+    {
+      return !(*this==other);
+    }
+  };
+
+  /**
+   * \ingroup type
+   *
+   * The tags of an OSM object, as passed to the type conditions and features
+   * during import.
+   *
+   * The tags are stored in a flat array. Tag values either refer to strings
+   * owned by the caller (Reference()) or to a copy held by the TagMap
+   * itself (Copy()). The memory for copies is kept on Clear(), so a TagMap
+   * reused for many objects does not allocate memory per tag.
+   *
+   * Entries have the same members (first, second) as the entries of a
+   * std::map<TagId,std::string>.
+   */
+  class OSMSCOUT_API TagMap
+  {
+  public:
+    struct Entry
+    {
+      TagId    first;  //! The tag
+      TagValue second; //! The value
+    };
+
+    typedef std::vector<Entry>::const_iterator const_iterator;
+
+  private:
+    std::vector<Entry>              entries;
+    std::vector<std::vector<char> > chunks;     //! Memory for copied values
+    size_t                          chunkIndex; //! The chunk currently filled
+    size_t                          chunkUsed;  //! Bytes used in the current chunk
+
+  private:
+    TagMap(const TagMap& other);
+    TagMap& operator=(const TagMap& other);
+
+    const char* Allocate(const char* value,
+                         size_t length);
+    void Set(TagId tag,
+             const TagValue& value);
+
+  public:
+    TagMap();
+
+    void Clear();
+
+    void Reference(TagId tag,
+                   const std::string& value);
+    void Copy(TagId tag,
+              const char* value);
+    void Copy(TagId tag,
+              const std::string& value);
+
+    inline const_iterator begin() const
+    {
+      return entries.begin();
+    }
+
+    inline const_iterator end() const
+    {
+      return entries.end();
+    }
+
+    inline bool empty() const
+    {
+      return entries.empty();
+    }
+
+    inline size_t size() const
+    {
+      return entries.size();
+    }
+
+    /**
+     * Returns the entry for the given tag or end(), if the object does not
+     * have the tag
+     */
+    inline const_iterator find(TagId tag) const
+    {
+      for (const_iterator entry=entries.begin();
+           entry!=entries.end();
+           ++entry) {
+        if (entry->first==tag) {
+          return entry;
+        }
+      }
+
+      return entries.end();
+    }
+  };
+}
+
+#endif
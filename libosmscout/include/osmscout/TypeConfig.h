@@ -29,6 +29,7 @@
 
 #include <osmscout/ObjectRef.h>
 #include <osmscout/Tag.h>
+#include <osmscout/TagClassifier.h>
 #include <osmscout/Types.h>
 
 #include <osmscout/util/FileScanner.h>
@@ -123,7 +124,7 @@ namespace osmscout {
                        const TypeConfig& typeConfig,
                        const FeatureInstance& feature,
                        const ObjectOSMRef& object,
-                       const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                       const TagMap& tags,
                        FeatureValueBuffer& buffer) const = 0;
   };
 
@@ -838,10 +839,12 @@ namespace osmscout {
     FeatureValue* AllocateValue(size_t idx);
     void FreeValue(size_t idx);
 
+    size_t GetAllocatedMemory() const;
+
     void Parse(Progress& progress,
                const TypeConfig& typeConfig,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags);
+               const TagMap& tags);
 
     bool Read(FileScanner& scanner);
     bool Write(FileWriter& writer) const;
@@ -859,6 +862,10 @@ namespace osmscout {
    */
   class OSMSCOUT_API TypeConfig : public Referencable
   {
+  private:
+    //! Rule type for the conditions of area types applied to multipolygon relations
+    static const unsigned char typeMultipolygon = 1 << 4;
+
   private:
     std::vector<TagInfo>                      tags;
     std::vector<TypeInfoRef>                  types;
@@ -892,6 +899,9 @@ namespace osmscout {
     FeatureRef                                featureTunnel;
     FeatureRef                                featureRoundabout;
 
+    TagClassifier                             tagClassifier;
+    bool                                      conditionsCompiled;
+
   public:
     TypeInfoRef                               typeInfoIgnore;
 
@@ -923,6 +933,7 @@ namespace osmscout {
                              uint32_t priority);
 
     TagId GetTagId(const char* name) const;
+    TagId GetTagId(const std::string& name) const;
 
     bool IsNameTag(TagId tag,
                    uint32_t& priority) const;
@@ -999,12 +1010,14 @@ namespace osmscout {
      */
     const TypeInfoRef GetTypeInfo(const std::string& name) const;
 
-    TypeInfoRef GetNodeType(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const;
+    TypeInfoRef GetNodeType(const TagMap& tagMap) const;
 
-    bool GetWayAreaType(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap,
+    bool GetWayAreaType(const TagMap& tagMap,
                         TypeInfoRef& wayType,
                         TypeInfoRef& areaType) const;
-    TypeInfoRef GetRelationType(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const;
+    TypeInfoRef GetRelationType(const TagMap& tagMap) const;
+
+    void CompileConditions();
 
     TypeId GetTypeId(const std::string& name) const;
     TypeId GetNodeTypeId(const std::string& name) const;
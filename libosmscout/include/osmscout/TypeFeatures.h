@@ -86,7 +86,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -152,7 +152,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -221,7 +221,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -281,7 +281,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -341,7 +341,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -546,7 +546,7 @@ namespace osmscout {
     static const char* const NAME;
 
   private:
-    inline void ParseAccessFlag(const std::string& value,
+    inline void ParseAccessFlag(const TagValue& value,
                                 uint8_t& access,
                                 uint8_t bit) const
     {
@@ -569,7 +569,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -629,7 +629,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -689,7 +689,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -749,7 +749,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -810,7 +810,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -870,7 +870,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -894,7 +894,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -918,7 +918,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
@@ -942,7 +942,7 @@ namespace osmscout {
                const TypeConfig& typeConfig,
                const FeatureInstance& feature,
                const ObjectOSMRef& object,
-               const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+               const TagMap& tags,
                FeatureValueBuffer& buffer) const;
   };
 
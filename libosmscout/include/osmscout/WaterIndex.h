@@ -28,6 +28,7 @@
 #include <osmscout/Types.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Mutex.h>
 #include <osmscout/util/Magnification.h>
 #include <osmscout/util/Reference.h>
 
@@ -58,6 +59,7 @@ namespace osmscout {
     std::string                filepart;       //! name of the data file
     std::string                datafilename;   //! Fullpath and name of the data file
     mutable FileScanner        scanner;        //! Scanner instance for reading this file
+    mutable Mutex              accessMutex;    //! Mutex guarding the scanner
 
     uint32_t                   waterIndexMinMag;
     uint32_t                   waterIndexMaxMag;
@@ -35,13 +35,13 @@ namespace osmscout {
   class OSMSCOUT_API Way : public Referencable
   {
   private:
-    FileOffset            fileOffset;
+    FileOffset               fileOffset;
 
-    FeatureValueBuffer    featureValueBuffer; //! List of features
+    FeatureValueBuffer       featureValueBuffer; //! List of features
 
   public:
-    std::vector<Id>       ids;
-    std::vector<GeoCoord> nodes;
+    std::vector<Id>          ids;
+    std::vector<ObjectCoord> nodes;
 
   public:
     inline Way()
@@ -128,6 +128,8 @@ namespace osmscout {
 
     void SetLayerToMax();
 
+    size_t GetMemoryUsage() const;
+
     bool Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
     bool ReadOptimized(const TypeConfig& typeConfig,
@@ -24,6 +24,16 @@
 #include <osmscout/Way.h>
 
 namespace osmscout {
+  /**
+    \ingroup Database
+    Cache cost of a way, see GetDataCacheCost().
+    */
+  inline unsigned long GetDataCacheCost(const Way& way,
+                                        unsigned long /*dataSize*/)
+  {
+    return (unsigned long)way.GetMemoryUsage();
+  }
+
   /**
     \ingroup Database
     Abstraction for getting cached access to the 'ways.dat' file.
@@ -0,0 +1,84 @@
+#ifndef OSMSCOUT_SYSTEM_VECTORKERNELS_H
+#define OSMSCOUT_SYSTEM_VECTORKERNELS_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <stddef.h>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/system/Types.h>
+
+#include <osmscout/GeoCoord.h>
+
+namespace osmscout {
+
+  /**
+   * Kernels working on whole arrays of coordinates instead of single
+   * coordinates. Depending on the processor the kernels use AVX2 (4 values
+   * at once), SSE2 (2 values at once) or plain scalar code. The extension is
+   * detected at runtime.
+   *
+   * All variants calculate exactly the same results as the scalar code of
+   * the library (MercatorProjection::GeoToPixel(), FileScanner::Read()),
+   * only faster. The vector variants are only available if the library was
+   * built with SSE2 support (the scalar projection code uses the SSE2 math
+   * approximations in this case, too).
+   */
+  enum VectorExtension
+  {
+    vectorExtensionNone = 0, //! Scalar code
+    vectorExtensionSSE2 = 1, //! SSE2, 2 doubles at once
+    vectorExtensionAVX2 = 2  //! AVX2, 4 doubles at once
+  };
+
+  /**
+   * Parameter of a mercator projection, see MercatorProjection
+   */
+  struct OSMSCOUT_API MercatorKernelParameter
+  {
+    double scale;          //! Scale of the projection
+    double scaleGradtorad; //! scale*Gradtorad
+    double lonOffset;      //! Pixel offset of the minimum longitude
+    double latOffset;      //! Pixel offset of the minimum latitude
+    double height;         //! Height of the image in pixel
+    bool   invertY;        //! y axis points downwards (y=height-...)
+  };
+
+  extern OSMSCOUT_API VectorExtension GetSupportedVectorExtension();
+  extern OSMSCOUT_API VectorExtension GetVectorExtension();
+  extern OSMSCOUT_API void SetVectorExtension(VectorExtension extension);
+  extern OSMSCOUT_API const char* GetVectorExtensionName(VectorExtension extension);
+
+  extern OSMSCOUT_API void TransformMercator(const MercatorKernelParameter& parameter,
+                                             const GeoCoord* coords,
+                                             size_t count,
+                                             double* pixels,
+                                             size_t stride);
+
+  extern OSMSCOUT_API void DecodeCoords(const GeoCoord& minCoord,
+                                        double latConversionFactor,
+                                        double lonConversionFactor,
+                                        const uint32_t* values,
+                                        size_t count,
+                                        GeoCoord* coords);
+}
+
+#endif
@@ -76,6 +76,14 @@ namespace osmscout {
 
   private:
     void FreeBuffer();
+    bool ReadCoordValues(uint32_t& latDat,
+                         uint32_t& lonDat);
+    bool ReadCoords(const GeoCoord& minCoord,
+                    size_t count,
+                    std::vector<GeoCoord>& nodes);
+    bool ReadCoords(const CompactGeoCoord& minCoord,
+                    size_t count,
+                    std::vector<CompactGeoCoord>& nodes);
 
   public:
     FileScanner();
@@ -98,12 +106,33 @@ namespace osmscout {
       return file==NULL || hasError;
     }
 
+    /**
+     * Return true, if the file content is memory mapped.
+     */
+    inline bool IsMapped() const
+    {
+      return buffer!=NULL;
+    }
+
+    /**
+     * Return the start of the memory mapped file content or NULL, if the file
+     * is not memory mapped. The returned data stays valid until the scanner
+     * is closed.
+     */
+    inline const char* GetMappedData() const
+    {
+      return buffer;
+    }
+
     std::string GetFilename() const;
 
     bool GotoBegin();
     bool SetPos(FileOffset pos);
     bool GetPos(FileOffset &pos) const;
 
+    bool Prefetch(FileOffset pos,
+                  FileOffset bytes);
+
     bool Read(char* buffer, size_t bytes);
 
     bool Read(std::string& value);
@@ -141,12 +170,16 @@ namespace osmscout {
 #endif
 
     bool ReadCoord(GeoCoord& coord);
+    bool ReadCoord(CompactGeoCoord& coord);
     bool ReadConditionalCoord(GeoCoord& coord,
                               bool& isSet);
 
     bool Read(std::vector<GeoCoord>& nodes);
     bool Read(std::vector<GeoCoord>& nodes,
               size_t count);
+    bool Read(std::vector<CompactGeoCoord>& nodes);
+    bool Read(std::vector<CompactGeoCoord>& nodes,
+              size_t count);
   };
 }
 
@@ -45,6 +45,10 @@ namespace osmscout {
     std::FILE   *file;
     bool        hasError;
 
+  private:
+    bool WriteCoordValues(uint32_t latValue,
+                          uint32_t lonValue);
+
   public:
     FileWriter();
     virtual ~FileWriter();
@@ -103,11 +107,15 @@ namespace osmscout {
 #endif
 
     bool WriteCoord(const GeoCoord& coord);
+    bool WriteCoord(const CompactGeoCoord& coord);
     bool WriteInvalidCoord();
 
     bool Write(const std::vector<GeoCoord>& nodes);
     bool Write(const std::vector<GeoCoord>& nodes,
                size_t count);
+    bool Write(const std::vector<CompactGeoCoord>& nodes);
+    bool Write(const std::vector<CompactGeoCoord>& nodes,
+               size_t count);
 
     bool Flush();
     bool FlushCurrentBlockWithZeros(size_t blockSize);
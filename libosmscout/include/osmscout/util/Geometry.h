@@ -280,14 +280,16 @@ namespace osmscout {
    * If -1 returned, the point is outside the area, if 0, the point is on the area boundary, 1
    * the point is within the area.
    */
-  inline int GetRelationOfPointToArea(const GeoCoord& point,
-                                      const std::vector<GeoCoord>& nodes)
+  template<typename N, typename M>
+  inline int GetRelationOfPointToArea(const N& point,
+                                      const std::vector<M>& nodes)
   {
     size_t i,j;
     bool   c=false;
 
     for (i=0, j=nodes.size()-1; i<nodes.size(); j=i++) {
-      if (point==nodes[i]) {
+      if (point.GetLat()==nodes[i].GetLat() &&
+          point.GetLon()==nodes[i].GetLon()) {
         return 0;
       }
 
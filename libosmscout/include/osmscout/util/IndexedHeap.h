@@ -0,0 +1,225 @@
+#ifndef OSMSCOUT_UTIL_INDEXEDHEAP_H
+#define OSMSCOUT_UTIL_INDEXEDHEAP_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * A d-ary min heap of integer handles (for example indexes into a vector
+   * holding the actual entries) that supports changing the priority of a
+   * handle already in the heap.
+   *
+   * The priority of the handles is defined by the given comparator:
+   * Compare(a,b) must return true, if handle a must be taken from the heap
+   * before handle b. If the priority of a handle in the heap changes,
+   * Update() must be called for it.
+   *
+   * Push(), Pop() and Update() are O(log n), Top() and Contains() are O(1).
+   * Handles should be dense, since a position table with an entry for the
+   * largest handle pushed is held.
+   */
+  template <class Compare, size_t Arity=4>
+  class IndexedHeap
+  {
+  private:
+    static const size_t notInHeap=(size_t)-1;
+
+  private:
+    Compare             compare;   //! Comparator for handles
+    std::vector<size_t> heap;      //! The heap of handles
+    std::vector<size_t> positions; //! Position of each handle in the heap, or notInHeap
+
+  private:
+    inline void Place(size_t pos,
+                      size_t handle)
+    {
+      heap[pos]=handle;
+      positions[handle]=pos;
+    }
+
+    void SiftUp(size_t pos)
+    {
+      size_t handle=heap[pos];
+
+      while (pos>0) {
+        size_t parent=(pos-1)/Arity;
+
+        if (!compare(handle,heap[parent])) {
+          break;
+        }
+
+        Place(pos,heap[parent]);
+        pos=parent;
+      }
+
+      Place(pos,handle);
+    }
+
+    void SiftDown(size_t pos)
+    {
+      size_t handle=heap[pos];
+
+      while (true) {
+        size_t first=pos*Arity+1;
+
+        if (first>=heap.size()) {
+          break;
+        }
+
+        size_t last=first+Arity;
+
+        if (last>heap.size()) {
+          last=heap.size();
+        }
+
+        size_t best=first;
+
+        for (size_t child=first+1; child<last; child++) {
+          if (compare(heap[child],heap[best])) {
+            best=child;
+          }
+        }
+
+        if (!compare(heap[best],handle)) {
+          break;
+        }
+
+        Place(pos,heap[best]);
+        pos=best;
+      }
+
+      Place(pos,handle);
+    }
+
+  public:
+    IndexedHeap(const Compare& compare=Compare())
+    : compare(compare)
+    {
+      // no code
+    }
+
+    inline bool empty() const
+    {
+      return heap.empty();
+    }
+
+    inline size_t size() const
+    {
+      return heap.size();
+    }
+
+    /**
+     * Reserve space for the given number of handles.
+     */
+    void Reserve(size_t count)
+    {
+      heap.reserve(count);
+      positions.reserve(count);
+    }
+
+    void Clear()
+    {
+      heap.clear();
+      positions.clear();
+    }
+
+    inline bool Contains(size_t handle) const
+    {
+      return handle<positions.size() &&
+             positions[handle]!=notInHeap;
+    }
+
+    /**
+     * Add the given handle, which must not already be in the heap.
+     */
+    void Push(size_t handle)
+    {
+      if (handle>=positions.size()) {
+        positions.resize(handle+1,notInHeap);
+      }
+
+      assert(positions[handle]==notInHeap);
+
+      heap.push_back(handle);
+      positions[handle]=heap.size()-1;
+
+      SiftUp(heap.size()-1);
+    }
+
+    /**
+     * Return the handle with the highest priority. The heap must not be empty.
+     */
+    inline size_t Top() const
+    {
+      assert(!heap.empty());
+
+      return heap.front();
+    }
+
+    /**
+     * Remove the handle with the highest priority. The heap must not be empty.
+     */
+    void Pop()
+    {
+      assert(!heap.empty());
+
+      size_t top=heap.front();
+      size_t last=heap.back();
+
+      heap.pop_back();
+      positions[top]=notInHeap;
+
+      if (!heap.empty()) {
+        Place(0,last);
+        SiftDown(0);
+      }
+    }
+
+    /**
+     * Restore the heap order after the priority of the given handle, which
+     * must be in the heap, has changed.
+     */
+    void Update(size_t handle)
+    {
+      assert(Contains(handle));
+
+      size_t pos=positions[handle];
+
+      if (pos>0 &&
+          compare(handle,heap[(pos-1)/Arity])) {
+        SiftUp(pos);
+      }
+      else {
+        SiftDown(pos);
+      }
+    }
+  };
+
+  template <class Compare, size_t Arity>
+  const size_t IndexedHeap<Compare,Arity>::notInHeap;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef OSMSCOUT_UTIL_MUTEX_H
+#define OSMSCOUT_UTIL_MUTEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <mutex>
+#endif
+
+#include <osmscout/private/CoreImportExport.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * Simple mutex. If libosmscout was build without thread support,
+   * locking and unlocking are no-ops.
+   */
+  class OSMSCOUT_API Mutex
+  {
+  private:
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::mutex mutex;
+#endif
+
+  private:
+    Mutex(const Mutex& other);
+    void operator=(const Mutex& other);
+
+  public:
+    Mutex();
+    ~Mutex();
+
+    inline void Lock()
+    {
+#if defined(OSMSCOUT_HAVE_THREAD)
+      mutex.lock();
+#endif
+    }
+
+    inline void Unlock()
+    {
+#if defined(OSMSCOUT_HAVE_THREAD)
+      mutex.unlock();
+#endif
+    }
+  };
+
+  /**
+   * \ingroup Util
+   * Locks the given mutex for the lifetime of the MutexLocker instance.
+   */
+  class OSMSCOUT_API MutexLocker
+  {
+  private:
+    Mutex& mutex;
+
+  private:
+    MutexLocker(const MutexLocker& other);
+    void operator=(const MutexLocker& other);
+
+  public:
+    inline MutexLocker(Mutex& mutex)
+    : mutex(mutex)
+    {
+      mutex.Lock();
+    }
+
+    inline ~MutexLocker()
+    {
+      mutex.Unlock();
+    }
+  };
+}
+
+#endif
@@ -21,6 +21,7 @@
 */
 
 #include <ctime>
+#include <list>
 #include <string>
 
 #include <osmscout/private/CoreImportExport.h>
@@ -70,6 +71,52 @@ namespace osmscout {
     void Warning(const std::string& text);
     void Error(const std::string& text);
   };
+
+  /**
+    Records all messages, so that they can be passed to another progress
+    instance later on (see Replay()). Useful for code executed in worker
+    threads, so that the output of parallel tasks does not interleave.
+    Progress information itself is dropped.
+    */
+  class OSMSCOUT_API BufferedProgress : public Progress
+  {
+  private:
+    enum MessageType
+    {
+      action,
+      debug,
+      info,
+      warning,
+      error
+    };
+
+    struct Message
+    {
+      MessageType type;
+      std::string text;
+    };
+
+  private:
+    std::list<Message> messages;
+
+  private:
+    void Add(MessageType type,
+             const std::string& text);
+
+  public:
+    BufferedProgress(bool outputDebug=false);
+
+    void SetAction(const std::string& action);
+    void SetProgress(double current, double total);
+
+    void Debug(const std::string& text);
+    void Info(const std::string& text);
+    void Warning(const std::string& text);
+    void Error(const std::string& text);
+
+    void Clear();
+    void Replay(Progress& progress) const;
+  };
 }
 
 #endif
@@ -23,6 +23,7 @@
 #include <osmscout/private/CoreImportExport.h>
 
 #include <osmscout/system/SSEMathPublic.h>
+#include <osmscout/system/VectorKernels.h>
 
 #include <osmscout/util/Magnification.h>
 
@@ -174,6 +175,16 @@ namespace osmscout {
     virtual bool GeoToPixel(double lon, double lat,
                             double& x, double& y) const = 0;
 
+    /**
+     * Converts count geo coordinates to pixel coordinates. The x and y
+     * coordinate of the first point are stored in pixels[0] and pixels[1],
+     * the following points start stride doubles (at least 2) later.
+     */
+    virtual bool GeoToPixel(const GeoCoord* coords,
+                            size_t count,
+                            double* pixels,
+                            size_t stride) const;
+
     /**
      * Returns the bounding box of the area covered
      */
@@ -294,6 +305,11 @@ namespace osmscout {
     bool GeoToPixel(double lon, double lat,
                     double& x, double& y) const;
 
+    bool GeoToPixel(const GeoCoord* coords,
+                    size_t count,
+                    double* pixels,
+                    size_t stride) const;
+
     bool GetDimensions(double& lonMin, double& latMin,
                        double& lonMax, double& latMax) const;
 
@@ -302,6 +318,8 @@ namespace osmscout {
   protected:
      bool GeoToPixel(const BatchTransformer& transformData) const;
 
+     void GetKernelParameter(MercatorKernelParameter& parameter) const;
+
   };
 
   /**
@@ -312,6 +330,7 @@ namespace osmscout {
   private:
     bool PixelToGeo(double x, double y, double& lon, double& lat) const;
     bool GeoToPixel(double lon, double lat, double& x, double& y) const;
+    bool GeoToPixel(const GeoCoord* coords, size_t count, double* pixels, size_t stride) const;
   protected:
     bool GeoToPixel(const BatchTransformer& transformData) const;
   };
@@ -20,6 +20,12 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <atomic>
+#endif
+
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Types.h>
 
@@ -30,6 +36,10 @@ namespace osmscout {
   /**
    * \ingroup Util
    * Baseclass for all classes that support reference counting.
+   *
+   * If libosmscout was build with thread support, the reference counter
+   * is atomic, so references to the same object can be copied and destroyed
+   * from different threads (e.g. for objects handed out by a shared cache).
    */
   class OSMSCOUT_API Referencable
   {
@@ -40,6 +50,25 @@ namespace osmscout {
       // no code
     }
 
+    /**
+      Copying an object does not copy its references, the new object
+      starts unreferenced.
+    */
+    Referencable(const Referencable& /*other*/)
+      : count(0)
+    {
+      // no code
+    }
+
+    /**
+      Assigning an object does not change the number of references
+      to the object assigned to.
+    */
+    Referencable& operator=(const Referencable& /*other*/)
+    {
+      return *this;
+    }
+
     /**
       Add a reference to this object.
 
@@ -57,9 +86,7 @@ namespace osmscout {
     */
     inline unsigned long RemoveReference()
     {
-      count--;
-
-      return count;
+      return --count;
     }
 
     /**
@@ -71,7 +98,11 @@ namespace osmscout {
     }
 
   private:
-    unsigned long count;
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::atomic<unsigned long> count;
+#else
+    unsigned long              count;
+#endif
   };
 
   /**
@@ -0,0 +1,572 @@
+#ifndef OSMSCOUT_SHARDEDCACHE_H
+#define OSMSCOUT_SHARDEDCACHE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CoreFeatures.h>
+
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Types.h>
+
+#include <osmscout/util/HashMap.h>
+#include <osmscout/util/Mutex.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * Thread safe, scan resistant cache.
+   *
+   * Template parameter class K holds the key value (must be a numerical value),
+   * parameter class V holds the data class that is to be cached. Values are
+   * copied in and out of the cache, so V should be cheap to copy (usually a Ref).
+   *
+   * * The cache is split into a number of shards, each with its own lock, so
+   *   that concurrent lookups of different keys usually do not block each other.
+   * * Each shard holds its entries in a vector of slots and a hash map from key
+   *   to slot. A hit only sets flags of the slot, there is no reordering of
+   *   a global list.
+   * * New entries are placed on probation. Entries on probation are evicted in
+   *   FIFO order. An entry that is hit while on probation becomes protected.
+   *   Protected entries are evicted using CLOCK (second chance) replacement, but
+   *   only if less than a quarter of the entries are on probation. As a result
+   *   a scan over many entries that are only accessed once can only replace
+   *   a part of the frequently used entries.
+   * * The size of the cache is limited by the number of entries and optionally
+   *   also by memory. The memory cost of an entry is passed on insertion.
+   * * Hits, misses, insertions and evictions are counted and can be dumped
+   *   via DumpStatistics().
+   */
+  template <class K, class V>
+  class ShardedCache
+  {
+  public:
+    /**
+     * Summary of the current state of the cache and its usage.
+     */
+    struct Statistics
+    {
+      unsigned long entries;    //! Number of entries in the cache
+      unsigned long memory;     //! Accumulated cost of all entries plus internal overhead
+      unsigned long hits;       //! Number of successful lookups
+      unsigned long misses;     //! Number of failed lookups
+      unsigned long insertions; //! Number of newly inserted entries
+      unsigned long evictions;  //! Number of entries evicted to make room for new entries
+
+      Statistics()
+      : entries(0),
+        memory(0),
+        hits(0),
+        misses(0),
+        insertions(0),
+        evictions(0)
+      {
+        // no code
+      }
+    };
+
+  private:
+    /**
+     * A slot in a shard holding one cache entry.
+     */
+    struct Slot
+    {
+      K             key;
+      V             value;
+      unsigned long cost;       //! Memory cost of the entry
+      unsigned long stamp;      //! Insertion stamp, to detect outdated entries in the probation queue
+      bool          used;       //! true, if the slot holds an entry
+      bool          hot;        //! true, if the entry is protected, false if it is on probation
+      bool          referenced; //! true, if the entry was hit since the clock hand passed it the last time
+    };
+
+    /**
+     * Reference to a slot in the probation queue
+     */
+    struct ProbationEntry
+    {
+      size_t        index;
+      unsigned long stamp;
+
+      ProbationEntry(size_t index,
+                     unsigned long stamp)
+      : index(index),
+        stamp(stamp)
+      {
+        // no code
+      }
+    };
+
+    typedef OSMSCOUT_HASHMAP<K,size_t> Map;
+
+    /**
+     * An independent part of the cache, holding all keys mapped to it.
+     */
+    struct Shard
+    {
+      Mutex                      mutex;
+      std::vector<Slot>          slots;
+      std::vector<size_t>        freeSlots;
+      std::deque<ProbationEntry> probation;
+      Map                        map;
+      size_t                     hand;
+      unsigned long              probationCount;
+      unsigned long              stamp;
+      unsigned long              maxSize;
+      unsigned long              maxMemory;
+      Statistics                 statistics;
+
+      Shard()
+      : hand(0),
+        probationCount(0),
+        stamp(0),
+        maxSize(0),
+        maxMemory(0)
+      {
+        // no code
+      }
+
+      inline bool IsOnProbation(const ProbationEntry& entry) const
+      {
+        const Slot& slot=slots[entry.index];
+
+        return slot.used && !slot.hot && slot.stamp==entry.stamp;
+      }
+
+      /**
+       * Called on a hit or an update of an existing entry
+       */
+      void Touch(Slot& slot)
+      {
+        if (!slot.hot) {
+          slot.hot=true;
+          probationCount--;
+
+          // Drop outdated probation references if the queue gets too long
+          if (probation.size()>2*slots.size()+16) {
+            std::deque<ProbationEntry> current;
+
+            for (typename std::deque<ProbationEntry>::const_iterator entry=probation.begin();
+                 entry!=probation.end();
+                 ++entry) {
+              if (IsOnProbation(*entry)) {
+                current.push_back(*entry);
+              }
+            }
+
+            probation.swap(current);
+          }
+        }
+
+        slot.referenced=true;
+      }
+
+      void Evict(size_t index)
+      {
+        Slot& slot=slots[index];
+
+        map.erase(slot.key);
+
+        if (!slot.hot) {
+          probationCount--;
+        }
+
+        slot.value=V();
+        slot.used=false;
+
+        freeSlots.push_back(index);
+
+        statistics.memory-=slot.cost;
+        statistics.entries--;
+        statistics.evictions++;
+      }
+
+      /**
+       * Evict the oldest entry on probation, or if only a few entries are on
+       * probation the next unreferenced protected entry, giving referenced
+       * entries a second chance.
+       */
+      void EvictOne()
+      {
+        assert(statistics.entries>0);
+
+        if (probationCount>0 &&
+            (probationCount*4>=statistics.entries ||
+             probationCount==statistics.entries)) {
+          while (!probation.empty()) {
+            ProbationEntry entry=probation.front();
+
+            probation.pop_front();
+
+            if (IsOnProbation(entry)) {
+              Evict(entry.index);
+              return;
+            }
+          }
+        }
+
+        while (true) {
+          if (hand>=slots.size()) {
+            hand=0;
+          }
+
+          Slot& slot=slots[hand];
+
+          hand++;
+
+          if (!slot.used ||
+              !slot.hot) {
+            continue;
+          }
+
+          if (slot.referenced) {
+            slot.referenced=false;
+            continue;
+          }
+
+          Evict(hand-1);
+
+          return;
+        }
+      }
+
+      bool IsFull(unsigned long cost) const
+      {
+        return statistics.entries>=maxSize ||
+               (maxMemory>0 && statistics.memory+cost>maxMemory);
+      }
+
+      void Clear()
+      {
+        slots.clear();
+        freeSlots.clear();
+        probation.clear();
+        map.clear();
+        hand=0;
+        probationCount=0;
+        statistics.entries=0;
+        statistics.memory=0;
+      }
+    };
+
+  private:
+    unsigned long       maxSize;
+    unsigned long       maxMemory;
+    unsigned int        shardShift;
+    std::vector<Shard*> shards;
+
+  private:
+    ShardedCache(const ShardedCache& other);
+    void operator=(const ShardedCache& other);
+
+    inline Shard& GetShard(const K& key) const
+    {
+      if (shards.size()==1) {
+        return *shards[0];
+      }
+
+      // Fibonacci hashing, the upper bits are the best distributed ones
+      uint64_t hash=(uint64_t)key*0x9E3779B97F4A7C15ULL;
+
+      return *shards[hash >> shardShift];
+    }
+
+    void SetupShards()
+    {
+      for (size_t s=0; s<shards.size(); s++) {
+        // Round up, so that the sum of all shards is at least the requested size
+        shards[s]->maxSize=(maxSize+shards.size()-1)/shards.size();
+        shards[s]->maxMemory=(maxMemory+shards.size()-1)/shards.size();
+
+        while (shards[s]->statistics.entries>0 &&
+               shards[s]->IsFull(0)) {
+          shards[s]->EvictOne();
+        }
+      }
+    }
+
+  public:
+    /**
+     * Create a new cache holding at most maxSize entries. If maxMemory is not 0,
+     * the accumulated cost of all entries is limited to maxMemory, too.
+     *
+     * If shardCount is 0, the number of shards is derived from the cache size.
+     * Else it is rounded down to the next power of 2.
+     */
+    ShardedCache(unsigned long maxSize,
+                 unsigned long maxMemory=0,
+                 size_t shardCount=0)
+    : maxSize(maxSize),
+      maxMemory(maxMemory)
+    {
+      if (shardCount==0) {
+        // Small caches are not split, else a single shard would hold only a few entries.
+        // Splitting costs some locality for sequential keys, so only use a few shards.
+        shardCount=maxSize/512;
+
+        if (shardCount>8) {
+          shardCount=8;
+        }
+      }
+
+      size_t count=1;
+
+      shardShift=64;
+
+      while (count*2<=shardCount) {
+        count*=2;
+        shardShift--;
+      }
+
+      shards.reserve(count);
+
+      for (size_t s=0; s<count; s++) {
+        shards.push_back(new Shard());
+      }
+
+      SetupShards();
+    }
+
+    ~ShardedCache()
+    {
+      for (size_t s=0; s<shards.size(); s++) {
+        delete shards[s];
+      }
+    }
+
+    /**
+     * Returns if the cache is active (maxSize > 0)
+     */
+    bool IsActive() const
+    {
+      return maxSize>0;
+    }
+
+    /**
+     * Getting the value with the given key from cache.
+     *
+     * If there is no value stored with the given key, false will be
+     * returned and the value will be untouched.
+     *
+     * If there is a value with the given key, it is copied to value and
+     * the entry is marked as referenced.
+     */
+    bool GetEntry(const K& key,
+                  V& value) const
+    {
+      if (!IsActive()) {
+        return false;
+      }
+
+      Shard&      shard=GetShard(key);
+      MutexLocker locker(shard.mutex);
+
+      typename Map::const_iterator iter=shard.map.find(key);
+
+      if (iter==shard.map.end()) {
+        shard.statistics.misses++;
+
+        return false;
+      }
+
+      Slot& slot=shard.slots[iter->second];
+
+      shard.Touch(slot);
+      value=slot.value;
+
+      shard.statistics.hits++;
+
+      return true;
+    }
+
+    /**
+     * Set or update the cache with the given value for the given key.
+     * cost is the memory cost of the entry, used for the optional memory limit
+     * and for statistics.
+     *
+     * If the cache is full, entries will be evicted until there is room
+     * for the new entry.
+     */
+    void SetEntry(const K& key,
+                  const V& value,
+                  unsigned long cost)
+    {
+      if (!IsActive()) {
+        return;
+      }
+
+      Shard&      shard=GetShard(key);
+      MutexLocker locker(shard.mutex);
+
+      typename Map::iterator iter=shard.map.find(key);
+
+      if (iter!=shard.map.end()) {
+        Slot& slot=shard.slots[iter->second];
+
+        shard.statistics.memory-=slot.cost;
+        shard.statistics.memory+=cost;
+
+        slot.value=value;
+        slot.cost=cost;
+
+        shard.Touch(slot);
+
+        return;
+      }
+
+      while (shard.statistics.entries>0 &&
+             shard.IsFull(cost)) {
+        shard.EvictOne();
+      }
+
+      size_t index;
+
+      if (!shard.freeSlots.empty()) {
+        index=shard.freeSlots.back();
+        shard.freeSlots.pop_back();
+      }
+      else {
+        index=shard.slots.size();
+        shard.slots.push_back(Slot());
+      }
+
+      Slot& slot=shard.slots[index];
+
+      slot.key=key;
+      slot.value=value;
+      slot.cost=cost;
+      slot.stamp=shard.stamp++;
+      slot.used=true;
+      slot.hot=false;
+      slot.referenced=false;
+
+      shard.map[key]=index;
+      shard.probation.push_back(ProbationEntry(index,slot.stamp));
+      shard.probationCount++;
+
+      shard.statistics.entries++;
+      shard.statistics.memory+=cost;
+      shard.statistics.insertions++;
+    }
+
+    /**
+     * Set a new cache max size, possibly evicting entries
+     * if the new size is smaller than the old one.
+     */
+    void SetMaxSize(unsigned long maxSize,
+                    unsigned long maxMemory=0)
+    {
+      for (size_t s=0; s<shards.size(); s++) {
+        shards[s]->mutex.Lock();
+      }
+
+      this->maxSize=maxSize;
+      this->maxMemory=maxMemory;
+
+      SetupShards();
+
+      for (size_t s=0; s<shards.size(); s++) {
+        shards[s]->mutex.Unlock();
+      }
+    }
+
+    /**
+     * Completely flush the cache removing all entries from it.
+     * Statistic counters are not reset.
+     */
+    void Flush()
+    {
+      for (size_t s=0; s<shards.size(); s++) {
+        MutexLocker locker(shards[s]->mutex);
+
+        shards[s]->Clear();
+      }
+    }
+
+    /**
+     * Return the current state of the cache, summed over all shards.
+     */
+    Statistics GetStatistics() const
+    {
+      Statistics statistics;
+
+      for (size_t s=0; s<shards.size(); s++) {
+        MutexLocker locker(shards[s]->mutex);
+
+        statistics.entries+=shards[s]->statistics.entries;
+        statistics.memory+=shards[s]->statistics.memory;
+        statistics.memory+=shards[s]->slots.capacity()*sizeof(Slot);
+        statistics.memory+=shards[s]->map.size()*(sizeof(K)+sizeof(size_t));
+        statistics.hits+=shards[s]->statistics.hits;
+        statistics.misses+=shards[s]->statistics.misses;
+        statistics.insertions+=shards[s]->statistics.insertions;
+        statistics.evictions+=shards[s]->statistics.evictions;
+      }
+
+      return statistics;
+    }
+
+    /**
+     * Returns the current number of entries in the cache.
+     */
+    unsigned long GetSize() const
+    {
+      return GetStatistics().entries;
+    }
+
+    /**
+     * Returns the memory used by the cache (the cost of all entries plus
+     * internal data structures).
+     */
+    unsigned long GetMemory() const
+    {
+      return GetStatistics().memory;
+    }
+
+    /**
+     * Dump some cache statistics to std::cout.
+     */
+    void DumpStatistics(const char* cacheName) const
+    {
+      Statistics    statistics=GetStatistics();
+      unsigned long lookups=statistics.hits+statistics.misses;
+
+      std::cout << cacheName << " entries: " << statistics.entries << ", memory " << statistics.memory;
+
+      if (statistics.entries>0) {
+        std::cout << " (" << statistics.memory/statistics.entries << " bytes/entry)";
+      }
+
+      std::cout << ", hits " << statistics.hits << ", misses " << statistics.misses;
+
+      if (lookups>0) {
+        std::cout << " (" << statistics.hits*100/lookups << "% hits)";
+      }
+
+      std::cout << ", evictions " << statistics.evictions << std::endl;
+    }
+  };
+}
+
+#endif
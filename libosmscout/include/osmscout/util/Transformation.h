@@ -71,6 +71,12 @@ namespace osmscout {
   private:
     void TransformGeoToPixel(const Projection& projection,
                              const std::vector<GeoCoord>& nodes);
+    void TransformGeoToPixel(const Projection& projection,
+                             const std::vector<CompactGeoCoord>& nodes);
+    void OptimizeArea(OptimizeMethod optimize,
+                      double optimizeErrorTolerance);
+    void OptimizeWay(OptimizeMethod optimize,
+                     double optimizeErrorTolerance);
     void DropSimilarPoints(double optimizeErrorTolerance);
     void DropRedundantPointsFast(double optimizeErrorTolerance);
     void DropRedundantPointsDouglasPeucker(double optimizeErrorTolerance, bool isArea);
@@ -109,6 +115,16 @@ namespace osmscout {
                       const std::vector<GeoCoord>& nodes,
                       double optimizeErrorTolerance);
 
+    void TransformArea(const Projection& projection,
+                       OptimizeMethod optimize,
+                       const std::vector<CompactGeoCoord>& nodes,
+                       double optimizeErrorTolerance);
+
+    void TransformWay(const Projection& projection,
+                      OptimizeMethod optimize,
+                      const std::vector<CompactGeoCoord>& nodes,
+                      double optimizeErrorTolerance);
+
     bool GetBoundingBox(double& xmin, double& ymin,
                         double& xmax, double& ymax) const;
 
@@ -365,6 +381,9 @@ namespace osmscout {
     TransPolygon transPolygon;
     CoordBuffer *buffer;
 
+  private:
+    void PushPolygon(size_t& start, size_t &end);
+
   public:
     TransBuffer(CoordBuffer* buffer);
     virtual ~TransBuffer();
@@ -381,6 +400,16 @@ namespace osmscout {
                       const std::vector<GeoCoord>& nodes,
                       size_t& start, size_t &end,
                       double optimizeErrorTolerance);
+    void TransformArea(const Projection& projection,
+                       TransPolygon::OptimizeMethod optimize,
+                       const std::vector<CompactGeoCoord>& nodes,
+                       size_t& start, size_t &end,
+                       double optimizeErrorTolerance);
+    bool TransformWay(const Projection& projection,
+                      TransPolygon::OptimizeMethod optimize,
+                      const std::vector<CompactGeoCoord>& nodes,
+                      size_t& start, size_t &end,
+                      double optimizeErrorTolerance);
   };
 }
 
@@ -167,6 +167,25 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Return the (approximate) number of bytes used by the area in memory.
+   */
+  size_t Area::GetMemoryUsage() const
+  {
+    size_t memory=sizeof(Area)+
+                  rings.capacity()*sizeof(Ring);
+
+    for (std::vector<Ring>::const_iterator ring=rings.begin();
+         ring!=rings.end();
+         ++ring) {
+      memory+=ring->GetFeatureValueBuffer().GetAllocatedMemory()+
+              ring->ids.capacity()*sizeof(Id)+
+              ring->nodes.capacity()*sizeof(ObjectCoord);
+    }
+
+    return memory;
+  }
+
   bool Area::ReadIds(FileScanner& scanner,
                      uint32_t nodesCount,
                      std::vector<Id>& ids)
@@ -36,6 +36,8 @@ namespace osmscout {
 
   void AreaAreaIndex::Close()
   {
+    MutexLocker locker(accessMutex);
+
     if (scanner.IsOpen()) {
       scanner.Close();
     }
@@ -43,69 +45,75 @@ namespace osmscout {
 
   bool AreaAreaIndex::GetIndexCell(uint32_t level,
                                    FileOffset offset,
-                                   IndexCache::CacheRef& cacheRef) const
+                                   IndexCellRef& cell) const
   {
-    if (!indexCache.GetEntry(offset,cacheRef)) {
-      IndexCache::CacheEntry cacheEntry(offset);
+    if (indexCache.GetEntry(offset,cell)) {
+      return true;
+    }
 
-      cacheRef=indexCache.SetEntry(cacheEntry);
+    MutexLocker locker(accessMutex);
 
-      if (!scanner.IsOpen()) {
-        if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-          std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-          return false;
-        }
+    if (!scanner.IsOpen()) {
+      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
+        return false;
       }
+    }
 
-      scanner.SetPos(offset);
+    scanner.SetPos(offset);
 
-      // Read offsets of children if not in the bottom level
+    cell=new IndexCell();
 
-      if (level<maxLevel) {
-        for (size_t c=0; c<4; c++) {
-          if (!scanner.ReadNumber(cacheRef->value.children[c])) {
-            std::cerr << "Cannot read index data at offset " << offset << std::endl;
-            return false;
-          }
+    // Read offsets of children if not in the bottom level
+
+    if (level<maxLevel) {
+      for (size_t c=0; c<4; c++) {
+        if (!scanner.ReadNumber(cell->children[c])) {
+          std::cerr << "Cannot read index data at offset " << offset << std::endl;
+          return false;
         }
       }
-      else {
-        for (size_t c=0; c<4; c++) {
-          cacheRef->value.children[c]=0;
-        }
+    }
+    else {
+      for (size_t c=0; c<4; c++) {
+        cell->children[c]=0;
       }
+    }
 
-      // Now read the way offsets by type in this index entry
+    // Now read the way offsets by type in this index entry
 
-      uint32_t offsetCount;
+    uint32_t offsetCount;
 
-      // Areas
+    // Areas
 
-      if (!scanner.ReadNumber(offsetCount)) {
-        std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
-        return false;
-      }
+    if (!scanner.ReadNumber(offsetCount)) {
+      std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
+      return false;
+    }
 
-      cacheRef->value.areas.resize(offsetCount);
+    cell->areas.resize(offsetCount);
 
-      FileOffset prevOffset=0;
+    FileOffset prevOffset=0;
 
-      for (size_t c=0; c<offsetCount; c++) {
-        if (!scanner.ReadNumber(cacheRef->value.areas[c].type)) {
-          std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
-          return false;
-        }
-        if (!scanner.ReadNumber(cacheRef->value.areas[c].offset)) {
-          std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
-          return false;
-        }
+    for (size_t c=0; c<offsetCount; c++) {
+      if (!scanner.ReadNumber(cell->areas[c].type)) {
+        std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
+        return false;
+      }
+      if (!scanner.ReadNumber(cell->areas[c].offset)) {
+        std::cerr << "Cannot read index data for level " << level << " at offset " << offset << std::endl;
+        return false;
+      }
 
-        cacheRef->value.areas[c].offset+=prevOffset;
+      cell->areas[c].offset+=prevOffset;
 
-        prevOffset=cacheRef->value.areas[c].offset;
-      }
+      prevOffset=cell->areas[c].offset;
     }
 
+    indexCache.SetEntry(offset,
+                        cell,
+                        IndexCacheValueSizer().GetSize(cell));
+
     return true;
   }
 
@@ -193,11 +201,11 @@ namespace osmscout {
       newOffsets.clear();
 
       for (size_t i=0; !stopArea && i<cellRefs.size(); i++) {
-        size_t               cx;
-        size_t               cy;
-        double               x;
-        double               y;
-        IndexCache::CacheRef cell;
+        size_t       cx;
+        size_t       cy;
+        double       x;
+        double       y;
+        IndexCellRef cell;
 
         if (!GetIndexCell(level,cellRefs[i].offset,cell)) {
           std::cerr << "Cannot find offset " << cellRefs[i].offset << " in level " << level << " => aborting!" << std::endl;
@@ -206,13 +214,13 @@ namespace osmscout {
 
         if (offsets.size()+
             newOffsets.size()+
-            cell->value.areas.size()>=maxCount) {
+            cell->areas.size()>=maxCount) {
           stopArea=true;
           continue;
         }
 
-        for (std::vector<IndexEntry>::const_iterator entry=cell->value.areas.begin();
-             entry!=cell->value.areas.end();
+        for (std::vector<IndexEntry>::const_iterator entry=cell->areas.begin();
+             entry!=cell->areas.end();
              ++entry) {
           if (types.IsTypeSet(entry->type)) {
             newOffsets.push_back(entry->offset);
@@ -222,7 +230,7 @@ namespace osmscout {
         cx=cellRefs[i].x*2;
         cy=cellRefs[i].y*2;
 
-        if (cell->value.children[0]!=0) {
+        if (cell->children[0]!=0) {
           // top left
 
           x=cx*cellWidth[level+1];
@@ -232,11 +240,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[0],cx,cy+1));
+            nextCellRefs.push_back(CellRef(cell->children[0],cx,cy+1));
           }
         }
 
-        if (cell->value.children[1]!=0) {
+        if (cell->children[1]!=0) {
           // top right
           x=(cx+1)*cellWidth[level+1];
           y=(cy+1)*cellHeight[level+1];
@@ -245,11 +253,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[1],cx+1,cy+1));
+            nextCellRefs.push_back(CellRef(cell->children[1],cx+1,cy+1));
           }
         }
 
-        if (cell->value.children[2]!=0) {
+        if (cell->children[2]!=0) {
           // bottom left
           x=cx*cellWidth[level+1];
           y=cy*cellHeight[level+1];
@@ -258,11 +266,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[2],cx,cy));
+            nextCellRefs.push_back(CellRef(cell->children[2],cx,cy));
           }
         }
 
-        if (cell->value.children[3]!=0) {
+        if (cell->children[3]!=0) {
           // bottom right
           x=(cx+1)*cellWidth[level+1];
           y=cy*cellHeight[level+1];
@@ -271,7 +279,7 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[3],cx+1,cy));
+            nextCellRefs.push_back(CellRef(cell->children[3],cx+1,cy));
           }
         }
       }
@@ -288,7 +296,7 @@ namespace osmscout {
 
   void AreaAreaIndex::DumpStatistics()
   {
-    indexCache.DumpStatistics(filepart.c_str(),IndexCacheValueSizer());
+    indexCache.DumpStatistics(filepart.c_str());
   }
 }
 
@@ -52,6 +52,8 @@ namespace osmscout {
 
   void AreaNodeIndex::Close()
   {
+    MutexLocker locker(accessMutex);
+
     if (scanner.IsOpen()) {
       scanner.Close();
     }
@@ -227,6 +229,144 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Variant of GetOffsets() that takes cells from the given cache and only
+   * reads cells from disk that are not in the cache.
+   */
+  bool AreaNodeIndex::GetCachedOffsets(const TypeData& typeData,
+                                       TypeId type,
+                                       double minlon,
+                                       double minlat,
+                                       double maxlon,
+                                       double maxlat,
+                                       size_t maxNodeCount,
+                                       std::vector<FileOffset>& offsets,
+                                       size_t currentSize,
+                                       bool& sizeExceeded,
+                                       IndexCellCache& cellCache) const
+  {
+    if (typeData.indexOffset==0) {
+      // No data for this type available
+      return true;
+    }
+
+    if (maxlon<typeData.minLon ||
+        minlon>=typeData.maxLon ||
+        maxlat<typeData.minLat ||
+        minlat>=typeData.maxLat) {
+      // No data available in given bounding box
+      return true;
+    }
+
+    OSMSCOUT_HASHSET<FileOffset> newOffsets;
+
+    uint32_t             minxc=(uint32_t)floor((minlon+180.0)/typeData.cellWidth);
+    uint32_t             maxxc=(uint32_t)floor((maxlon+180.0)/typeData.cellWidth);
+
+    uint32_t             minyc=(uint32_t)floor((minlat+90.0)/typeData.cellHeight);
+    uint32_t             maxyc=(uint32_t)floor((maxlat+90.0)/typeData.cellHeight);
+
+    minxc=std::max(minxc,typeData.cellXStart);
+    maxxc=std::min(maxxc,typeData.cellXEnd);
+
+    minyc=std::max(minyc,typeData.cellYStart);
+    maxyc=std::min(maxyc,typeData.cellYEnd);
+
+    FileOffset dataOffset=typeData.indexOffset+
+                          typeData.cellXCount*typeData.cellYCount*(FileOffset)typeData.dataOffsetBytes;
+
+    std::vector<FileOffset> cellDataOffsets(maxxc-minxc+1);
+    std::vector<FileOffset> cellOffsets;
+
+    // For each row
+    for (uint32_t y=minyc; y<=maxyc; y++) {
+      bool rowLoaded=false;
+
+      // For each column in row
+      for (uint32_t x=minxc; x<=maxxc; x++) {
+        const std::vector<FileOffset>* cell=cellCache.GetCell(type,x,y);
+
+        if (cell==NULL) {
+          // The index of the row is only read if there is a cell missing
+          if (!rowLoaded) {
+            FileOffset cellIndexOffset=typeData.indexOffset+
+                                       ((y-typeData.cellYStart)*typeData.cellXCount+
+                                        minxc-typeData.cellXStart)*typeData.dataOffsetBytes;
+
+            if (!scanner.SetPos(cellIndexOffset)) {
+              std::cerr << "Cannot go to type cell index position " << cellIndexOffset << std::endl;
+              return false;
+            }
+
+            for (size_t i=0; i<cellDataOffsets.size(); i++) {
+              if (!scanner.ReadFileOffset(cellDataOffsets[i],
+                                          typeData.dataOffsetBytes)) {
+                std::cerr << "Cannot read cell data position" << std::endl;
+                return false;
+              }
+            }
+
+            rowLoaded=true;
+          }
+
+          cellOffsets.clear();
+
+          if (cellDataOffsets[x-minxc]!=0) {
+            // We added +1 during import and now substract it again
+            FileOffset cellDataOffset=dataOffset+cellDataOffsets[x-minxc]-1;
+            uint32_t   dataCount;
+            FileOffset lastOffset=0;
+
+            if (!scanner.SetPos(cellDataOffset)) {
+              std::cerr << "Cannot go to cell data position " << cellDataOffset << std::endl;
+              return false;
+            }
+
+            if (!scanner.ReadNumber(dataCount)) {
+              std::cerr << "Cannot read cell data count" << std::endl;
+              return false;
+            }
+
+            cellOffsets.reserve(dataCount);
+
+            for (size_t d=0; d<dataCount; d++) {
+              FileOffset objectOffset;
+
+              scanner.ReadNumber(objectOffset);
+
+              objectOffset+=lastOffset;
+
+              cellOffsets.push_back(objectOffset);
+
+              lastOffset=objectOffset;
+            }
+          }
+
+          std::vector<FileOffset>& newCell=cellCache.AddCell(type,x,y);
+
+          newCell.swap(cellOffsets);
+
+          cell=&newCell;
+        }
+
+        if (cell->empty()) {
+          continue;
+        }
+
+        if (currentSize+newOffsets.size()+cell->size()>maxNodeCount) {
+          sizeExceeded=true;
+          return true;
+        }
+
+        newOffsets.insert(cell->begin(),cell->end());
+      }
+    }
+
+    offsets.insert(offsets.end(),newOffsets.begin(),newOffsets.end());
+
+    return true;
+  }
+
   bool AreaNodeIndex::GetOffsets(double minlon,
                                  double minlat,
                                  double maxlon,
@@ -235,6 +375,32 @@ namespace osmscout {
                                  size_t maxNodeCount,
                                  std::vector<FileOffset>& nodeOffsets) const
   {
+    return GetOffsets(minlon,
+                      minlat,
+                      maxlon,
+                      maxlat,
+                      nodeTypes,
+                      maxNodeCount,
+                      nodeOffsets,
+                      NULL);
+  }
+
+  /**
+   * Return the offsets of all nodes of the given types in the given area.
+   * If a cell cache is given, cells that have already been read by the
+   * last query using the same cache are not read again.
+   */
+  bool AreaNodeIndex::GetOffsets(double minlon,
+                                 double minlat,
+                                 double maxlon,
+                                 double maxlat,
+                                 const TypeSet& nodeTypes,
+                                 size_t maxNodeCount,
+                                 std::vector<FileOffset>& nodeOffsets,
+                                 IndexCellCache* cellCache) const
+  {
+    MutexLocker locker(accessMutex);
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
         std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
@@ -244,17 +410,40 @@ namespace osmscout {
 
     bool sizeExceeded=false;
 
+    if (cellCache!=NULL) {
+      cellCache->StartQuery();
+    }
+
     for (size_t i=0; i<nodeTypeData.size(); i++) {
       if (nodeTypes.IsTypeSet(i)) {
-        if (!GetOffsets(nodeTypeData[i],
-                        minlon,
-                        minlat,
-                        maxlon,
-                        maxlat,
-                        maxNodeCount,
-                        nodeOffsets,
-                        nodeOffsets.size(),
-                        sizeExceeded)) {
+        bool success;
+
+        if (cellCache!=NULL) {
+          success=GetCachedOffsets(nodeTypeData[i],
+                                   (TypeId)i,
+                                   minlon,
+                                   minlat,
+                                   maxlon,
+                                   maxlat,
+                                   maxNodeCount,
+                                   nodeOffsets,
+                                   nodeOffsets.size(),
+                                   sizeExceeded,
+                                   *cellCache);
+        }
+        else {
+          success=GetOffsets(nodeTypeData[i],
+                             minlon,
+                             minlat,
+                             maxlon,
+                             maxlat,
+                             maxNodeCount,
+                             nodeOffsets,
+                             nodeOffsets.size(),
+                             sizeExceeded);
+        }
+
+        if (!success) {
           return false;
         }
 
@@ -264,6 +453,10 @@ namespace osmscout {
       }
     }
 
+    if (cellCache!=NULL) {
+      cellCache->FinishQuery();
+    }
+
     return true;
   }
 
@@ -52,6 +52,8 @@ namespace osmscout {
 
   void AreaWayIndex::Close()
   {
+    MutexLocker locker(accessMutex);
+
     if (scanner.IsOpen()) {
       scanner.Close();
     }
@@ -230,6 +232,140 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Variant of GetOffsets() that takes cells from the given cache and only
+   * reads cells from disk that are not in the cache.
+   */
+  bool AreaWayIndex::GetCachedOffsets(const TypeData& typeData,
+                                      TypeId type,
+                                      double minlon,
+                                      double minlat,
+                                      double maxlon,
+                                      double maxlat,
+                                      size_t maxWayCount,
+                                      OSMSCOUT_HASHSET<FileOffset>& offsets,
+                                      size_t currentSize,
+                                      bool& sizeExceeded,
+                                      IndexCellCache& cellCache) const
+  {
+    if (typeData.bitmapOffset==0) {
+      // No data for this type available
+      return true;
+    }
+
+    if (maxlon<typeData.minLon ||
+        minlon>=typeData.maxLon ||
+        maxlat<typeData.minLat ||
+        minlat>=typeData.maxLat) {
+      // No data available in given bounding box
+      return true;
+    }
+
+    uint32_t minxc=(uint32_t)floor((minlon+180.0)/typeData.cellWidth);
+    uint32_t maxxc=(uint32_t)floor((maxlon+180.0)/typeData.cellWidth);
+
+    uint32_t minyc=(uint32_t)floor((minlat+90.0)/typeData.cellHeight);
+    uint32_t maxyc=(uint32_t)floor((maxlat+90.0)/typeData.cellHeight);
+
+    minxc=std::max(minxc,typeData.cellXStart);
+    maxxc=std::min(maxxc,typeData.cellXEnd);
+
+    minyc=std::max(minyc,typeData.cellYStart);
+    maxyc=std::min(maxyc,typeData.cellYEnd);
+
+    FileOffset dataOffset=typeData.bitmapOffset+
+                          typeData.cellXCount*typeData.cellYCount*(FileOffset)typeData.dataOffsetBytes;
+
+    std::vector<FileOffset> cellDataOffsets(maxxc-minxc+1);
+    std::vector<FileOffset> cellOffsets;
+
+    // For each row
+    for (uint32_t y=minyc; y<=maxyc; y++) {
+      bool rowLoaded=false;
+
+      // For each column in row
+      for (uint32_t x=minxc; x<=maxxc; x++) {
+        const std::vector<FileOffset>* cell=cellCache.GetCell(type,x,y);
+
+        if (cell==NULL) {
+          // The bitmap of the row is only read if there is a cell missing
+          if (!rowLoaded) {
+            FileOffset bitmapCellOffset=typeData.bitmapOffset+
+                                        ((y-typeData.cellYStart)*typeData.cellXCount+
+                                         minxc-typeData.cellXStart)*(FileOffset)typeData.dataOffsetBytes;
+
+            if (!scanner.SetPos(bitmapCellOffset)) {
+              std::cerr << "Cannot go to type cell index position " << bitmapCellOffset << std::endl;
+              return false;
+            }
+
+            for (size_t i=0; i<cellDataOffsets.size(); i++) {
+              if (!scanner.ReadFileOffset(cellDataOffsets[i],
+                                          typeData.dataOffsetBytes)) {
+                std::cerr << "Cannot read cell data position" << std::endl;
+                return false;
+              }
+            }
+
+            rowLoaded=true;
+          }
+
+          cellOffsets.clear();
+
+          if (cellDataOffsets[x-minxc]!=0) {
+            // We added +1 during import and now substract it again
+            FileOffset cellDataOffset=dataOffset+cellDataOffsets[x-minxc]-1;
+            uint32_t   dataCount;
+            FileOffset lastOffset=0;
+
+            if (!scanner.SetPos(cellDataOffset)) {
+              std::cerr << "Cannot go to cell data position " << cellDataOffset << std::endl;
+              return false;
+            }
+
+            if (!scanner.ReadNumber(dataCount)) {
+              std::cerr << "Cannot read cell data count" << std::endl;
+              return false;
+            }
+
+            cellOffsets.reserve(dataCount);
+
+            for (size_t d=0; d<dataCount; d++) {
+              FileOffset objectOffset;
+
+              scanner.ReadNumber(objectOffset);
+
+              objectOffset+=lastOffset;
+
+              cellOffsets.push_back(objectOffset);
+
+              lastOffset=objectOffset;
+            }
+          }
+
+          std::vector<FileOffset>& newCell=cellCache.AddCell(type,x,y);
+
+          newCell.swap(cellOffsets);
+
+          cell=&newCell;
+        }
+
+        if (cell->empty()) {
+          continue;
+        }
+
+        if (currentSize+offsets.size()+cell->size()>maxWayCount) {
+          sizeExceeded=true;
+          return true;
+        }
+
+        offsets.insert(cell->begin(),cell->end());
+      }
+    }
+
+    return true;
+  }
+
   bool AreaWayIndex::GetOffsets(double minlon,
                                 double minlat,
                                 double maxlon,
@@ -238,6 +374,32 @@ namespace osmscout {
                                 size_t maxWayCount,
                                 std::vector<FileOffset>& offsets) const
   {
+    return GetOffsets(minlon,
+                      minlat,
+                      maxlon,
+                      maxlat,
+                      wayTypes,
+                      maxWayCount,
+                      offsets,
+                      NULL);
+  }
+
+  /**
+   * Return the offsets of all ways of the given types in the given area.
+   * If a cell cache is given, cells that have already been read by the
+   * last query using the same cache are not read again.
+   */
+  bool AreaWayIndex::GetOffsets(double minlon,
+                                double minlat,
+                                double maxlon,
+                                double maxlat,
+                                const std::vector<TypeSet>& wayTypes,
+                                size_t maxWayCount,
+                                std::vector<FileOffset>& offsets,
+                                IndexCellCache* cellCache) const
+  {
+    MutexLocker locker(accessMutex);
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
         std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
@@ -254,34 +416,62 @@ namespace osmscout {
     newOffsets.reserve(std::min(100000u,(uint32_t)maxWayCount));
 #endif
 
-    for (size_t i=0; i<wayTypes.size(); i++) {
+    if (cellCache!=NULL) {
+      cellCache->StartQuery();
+    }
+
+    for (size_t i=0; !sizeExceeded && i<wayTypes.size(); i++) {
       newOffsets.clear();
 
       for (size_t type=0;
           type<wayTypeData.size();
           ++type) {
         if (wayTypes[i].IsTypeSet(type)) {
-          if (!GetOffsets(wayTypeData[type],
-                          minlon,
-                          minlat,
-                          maxlon,
-                          maxlat,
-                          maxWayCount,
-                          newOffsets,
-                          offsets.size(),
-                          sizeExceeded)) {
+          bool success;
+
+          if (cellCache!=NULL) {
+            success=GetCachedOffsets(wayTypeData[type],
+                                     (TypeId)type,
+                                     minlon,
+                                     minlat,
+                                     maxlon,
+                                     maxlat,
+                                     maxWayCount,
+                                     newOffsets,
+                                     offsets.size(),
+                                     sizeExceeded,
+                                     *cellCache);
+          }
+          else {
+            success=GetOffsets(wayTypeData[type],
+                               minlon,
+                               minlat,
+                               maxlon,
+                               maxlat,
+                               maxWayCount,
+                               newOffsets,
+                               offsets.size(),
+                               sizeExceeded);
+          }
+
+          if (!success) {
             return false;
           }
 
           if (sizeExceeded) {
-            return true;
+            break;
           }
         }
       }
 
       // Copy data from temporary set to final vector
+      if (!sizeExceeded) {
+        offsets.insert(offsets.end(),newOffsets.begin(),newOffsets.end());
+      }
+    }
 
-      offsets.insert(offsets.end(),newOffsets.begin(),newOffsets.end());
+    if (cellCache!=NULL) {
+      cellCache->FinishQuery();
     }
 
     //std::cout << "Found " << wayWayOffsets.size() << "+" << relationWayOffsets.size()<< " offsets in 'areaway.idx'" << std::endl;
@@ -0,0 +1,476 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ContractionHierarchy.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  const uint32_t ContractionHierarchy::noEdge;
+  const uint32_t ContractionHierarchy::noNode;
+
+  ContractionHierarchy::ContractionHierarchy()
+  : vehicle(vehicleCar),
+    vehicleMaxSpeed(0)
+  {
+    // no code
+  }
+
+  ContractionHierarchy::~ContractionHierarchy()
+  {
+    // no code
+  }
+
+  /**
+   * Speeds are stored and compared in units of 0.01 km/h. Unlimited speeds
+   * (the profile default) are mapped to the largest value.
+   */
+  uint32_t ContractionHierarchy::EncodeSpeed(double speed)
+  {
+    if (speed<=0.0) {
+      return 0;
+    }
+
+    if (speed>=4.0e7) {
+      return 0xffffffff;
+    }
+
+    return (uint32_t)floor(speed*100.0+0.5);
+  }
+
+  /**
+   * Build the per node lists of upward edges (and for core nodes the edges
+   * to other core nodes) from the ranks of the nodes.
+   */
+  void ContractionHierarchy::BuildAdjacency()
+  {
+    size_t nodeCount=GetNodeCount();
+
+    std::vector<uint32_t> forwardCount(nodeCount+1,0);
+    std::vector<uint32_t> backwardCount(nodeCount+1,0);
+
+    for (std::vector<Edge>::const_iterator edge=edges.begin();
+         edge!=edges.end();
+         ++edge) {
+      if (nodes[edge->target].rank>=nodes[edge->source].rank) {
+        forwardCount[edge->source]++;
+      }
+
+      if (nodes[edge->source].rank>=nodes[edge->target].rank) {
+        backwardCount[edge->target]++;
+      }
+    }
+
+    uint32_t forwardStart=0;
+    uint32_t backwardStart=0;
+
+    for (size_t n=0; n<=nodeCount; n++) {
+      nodes[n].forwardStart=forwardStart;
+      nodes[n].backwardStart=backwardStart;
+
+      forwardStart+=forwardCount[n];
+      backwardStart+=backwardCount[n];
+
+      forwardCount[n]=nodes[n].forwardStart;
+      backwardCount[n]=nodes[n].backwardStart;
+    }
+
+    forwardEdges.resize(forwardStart);
+    backwardEdges.resize(backwardStart);
+
+    for (size_t e=0; e<edges.size(); e++) {
+      const Edge& edge=edges[e];
+
+      if (nodes[edge.target].rank>=nodes[edge.source].rank) {
+        forwardEdges[forwardCount[edge.source]++]=(uint32_t)e;
+      }
+
+      if (nodes[edge.source].rank>=nodes[edge.target].rank) {
+        backwardEdges[backwardCount[edge.target]++]=(uint32_t)e;
+      }
+    }
+  }
+
+  /**
+   * Initialize the hierarchy with the result of the contraction.
+   *
+   * @param profile
+   *    The profile used for calculation of the edge costs
+   * @param nodeOffsets
+   *    The file offsets of all route nodes, sorted
+   * @param ranks
+   *    The rank of each node
+   * @param edges
+   *    All original and shortcut edges
+   * @param excludes
+   *    The excludes of each node, only allowed for core nodes
+   */
+  void ContractionHierarchy::Set(const AbstractRoutingProfile& profile,
+                                 const std::vector<FileOffset>& nodeOffsets,
+                                 const std::vector<uint32_t>& ranks,
+                                 const std::vector<Edge>& edges,
+                                 const std::vector<std::vector<RouteNode::Exclude> >& excludes)
+  {
+    assert(nodeOffsets.size()==ranks.size());
+    assert(nodeOffsets.size()==excludes.size());
+
+    vehicle=profile.GetVehicle();
+    vehicleMaxSpeed=EncodeSpeed(profile.GetVehicleMaxSpeed());
+
+    speeds.clear();
+    speeds.reserve(profile.GetSpeeds().size());
+
+    for (std::vector<double>::const_iterator speed=profile.GetSpeeds().begin();
+         speed!=profile.GetSpeeds().end();
+         ++speed) {
+      speeds.push_back(EncodeSpeed(*speed));
+    }
+
+    nodes.resize(nodeOffsets.size()+1);
+    this->excludes.clear();
+
+    for (size_t n=0; n<nodeOffsets.size(); n++) {
+      nodes[n].offset=nodeOffsets[n];
+      nodes[n].rank=ranks[n];
+      nodes[n].excludeStart=(uint32_t)this->excludes.size();
+
+      this->excludes.insert(this->excludes.end(),
+                            excludes[n].begin(),
+                            excludes[n].end());
+    }
+
+    nodes.back().offset=0;
+    nodes.back().rank=0;
+    nodes.back().excludeStart=(uint32_t)this->excludes.size();
+
+    this->edges=edges;
+
+    BuildAdjacency();
+  }
+
+  /**
+   * Return true, if the given profile calculates the same costs as the
+   * profile used during the generation of the hierarchy.
+   */
+  bool ContractionHierarchy::IsCompatible(const RoutingProfile& profile) const
+  {
+    const FastestPathRoutingProfile* fastestPathProfile=dynamic_cast<const FastestPathRoutingProfile*>(&profile);
+
+    if (fastestPathProfile==NULL) {
+      return false;
+    }
+
+    if (fastestPathProfile->GetVehicle()!=vehicle ||
+        EncodeSpeed(fastestPathProfile->GetVehicleMaxSpeed())!=vehicleMaxSpeed) {
+      return false;
+    }
+
+    const std::vector<double>& profileSpeeds=fastestPathProfile->GetSpeeds();
+
+    for (size_t type=0; type<std::max(speeds.size(),profileSpeeds.size()); type++) {
+      uint32_t speed=type<speeds.size() ? speeds[type] : 0;
+      uint32_t profileSpeed=type<profileSpeeds.size() ? EncodeSpeed(profileSpeeds[type]) : 0;
+
+      if (speed!=profileSpeed) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the index of the node for the route node with the given file
+   * offset or noNode, if the route node is not part of the hierarchy.
+   */
+  uint32_t ContractionHierarchy::GetNodeIndex(FileOffset offset) const
+  {
+    size_t begin=0;
+    size_t end=GetNodeCount();
+
+    while (begin<end) {
+      size_t middle=begin+(end-begin)/2;
+
+      if (nodes[middle].offset<offset) {
+        begin=middle+1;
+      }
+      else {
+        end=middle;
+      }
+    }
+
+    if (begin<GetNodeCount() &&
+        nodes[begin].offset==offset) {
+      return (uint32_t)begin;
+    }
+
+    return noNode;
+  }
+
+  /**
+   * Return true, if one cannot take the path with the given index at the
+   * given node coming from the given object.
+   */
+  bool ContractionHierarchy::IsExcluded(uint32_t node,
+                                        const ObjectFileRef& source,
+                                        uint32_t pathIndex) const
+  {
+    for (uint32_t e=nodes[node].excludeStart; e<nodes[node+1].excludeStart; e++) {
+      if (excludes[e].source==source &&
+          excludes[e].targetIndex==pathIndex) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Append the original edges represented by the given edge in travel order.
+   */
+  void ContractionHierarchy::UnpackEdge(uint32_t edge,
+                                        std::vector<uint32_t>& originalEdges) const
+  {
+    std::vector<uint32_t> stack;
+
+    stack.push_back(edge);
+
+    while (!stack.empty()) {
+      const Edge& current=edges[stack.back()];
+
+      if (!current.IsShortcut()) {
+        originalEdges.push_back(stack.back());
+        stack.pop_back();
+        continue;
+      }
+
+      stack.pop_back();
+      stack.push_back(current.secondEdge);
+      stack.push_back(current.firstEdge);
+    }
+  }
+
+  bool ContractionHierarchy::Read(FileScanner& scanner)
+  {
+    uint8_t  vehicleValue;
+    uint32_t speedCount;
+    uint32_t nodeCount;
+    uint32_t edgeCount;
+
+    scanner.Read(vehicleValue);
+    scanner.ReadNumber(vehicleMaxSpeed);
+    scanner.ReadNumber(speedCount);
+
+    if (scanner.HasError()) {
+      return false;
+    }
+
+    vehicle=(Vehicle)vehicleValue;
+
+    speeds.resize(speedCount);
+
+    for (size_t s=0; s<speedCount; s++) {
+      scanner.ReadNumber(speeds[s]);
+    }
+
+    if (!scanner.ReadNumber(nodeCount)) {
+      return false;
+    }
+
+    nodes.resize(nodeCount+1);
+    excludes.clear();
+
+    FileOffset previousOffset=0;
+
+    for (size_t n=0; n<nodeCount; n++) {
+      FileOffset offset;
+      uint32_t   excludeCount;
+
+      scanner.ReadNumber(offset);
+      scanner.ReadNumber(nodes[n].rank);
+      scanner.ReadNumber(excludeCount);
+
+      if (scanner.HasError()) {
+        return false;
+      }
+
+      nodes[n].offset=previousOffset+offset;
+      nodes[n].excludeStart=(uint32_t)excludes.size();
+
+      previousOffset=nodes[n].offset;
+
+      for (size_t e=0; e<excludeCount; e++) {
+        RouteNode::Exclude exclude;
+        uint8_t            type;
+        FileOffset         fileOffset;
+
+        scanner.Read(type);
+        scanner.ReadNumber(fileOffset);
+        scanner.ReadNumber(exclude.targetIndex);
+
+        exclude.source.Set(fileOffset,(RefType)type);
+
+        excludes.push_back(exclude);
+      }
+    }
+
+    nodes.back().offset=0;
+    nodes.back().rank=0;
+    nodes.back().excludeStart=(uint32_t)excludes.size();
+
+    if (!scanner.ReadNumber(edgeCount)) {
+      return false;
+    }
+
+    edges.resize(edgeCount);
+
+    for (size_t e=0; e<edgeCount; e++) {
+      Edge&      edge=edges[e];
+      uint32_t   firstEdge;
+      uint32_t   secondEdge;
+      uint8_t    type;
+      FileOffset fileOffset;
+
+      scanner.ReadNumber(edge.source);
+      scanner.ReadNumber(edge.target);
+      scanner.ReadNumber(edge.costs);
+      scanner.ReadNumber(firstEdge);
+      scanner.ReadNumber(secondEdge);
+      scanner.ReadNumber(edge.pathIndex);
+      scanner.Read(type);
+      scanner.ReadNumber(fileOffset);
+
+      if (scanner.HasError()) {
+        return false;
+      }
+
+      if (edge.source>=nodeCount ||
+          edge.target>=nodeCount) {
+        std::cerr << "Edge " << e << " references a non existing node" << std::endl;
+        return false;
+      }
+
+      // Edge indexes are stored incremented by one, 0 means "no edge".
+      // Shortcuts are always created after the edges they consist of, so
+      // requiring smaller indexes also assures that unpacking terminates.
+      if ((firstEdge==0)!=(secondEdge==0) ||
+          firstEdge>e ||
+          secondEdge>e) {
+        std::cerr << "Shortcut edge " << e << " references an invalid edge" << std::endl;
+        return false;
+      }
+
+      edge.firstEdge=firstEdge>0 ? firstEdge-1 : noEdge;
+      edge.secondEdge=secondEdge>0 ? secondEdge-1 : noEdge;
+      edge.object.Set(fileOffset,(RefType)type);
+    }
+
+    BuildAdjacency();
+
+    return !scanner.HasError();
+  }
+
+  bool ContractionHierarchy::Write(FileWriter& writer) const
+  {
+    writer.Write((uint8_t)vehicle);
+    writer.WriteNumber(vehicleMaxSpeed);
+    writer.WriteNumber((uint32_t)speeds.size());
+
+    for (std::vector<uint32_t>::const_iterator speed=speeds.begin();
+         speed!=speeds.end();
+         ++speed) {
+      writer.WriteNumber(*speed);
+    }
+
+    writer.WriteNumber((uint32_t)GetNodeCount());
+
+    FileOffset previousOffset=0;
+
+    for (size_t n=0; n<GetNodeCount(); n++) {
+      writer.WriteNumber(nodes[n].offset-previousOffset);
+      writer.WriteNumber(nodes[n].rank);
+      writer.WriteNumber(nodes[n+1].excludeStart-nodes[n].excludeStart);
+
+      for (uint32_t e=nodes[n].excludeStart; e<nodes[n+1].excludeStart; e++) {
+        writer.Write((uint8_t)excludes[e].source.GetType());
+        writer.WriteNumber(excludes[e].source.GetFileOffset());
+        writer.WriteNumber(excludes[e].targetIndex);
+      }
+
+      previousOffset=nodes[n].offset;
+    }
+
+    writer.WriteNumber((uint32_t)edges.size());
+
+    for (std::vector<Edge>::const_iterator edge=edges.begin();
+         edge!=edges.end();
+         ++edge) {
+      writer.WriteNumber(edge->source);
+      writer.WriteNumber(edge->target);
+      writer.WriteNumber(edge->costs);
+      writer.WriteNumber(edge->IsShortcut() ? edge->firstEdge+1 : 0);
+      writer.WriteNumber(edge->IsShortcut() ? edge->secondEdge+1 : 0);
+      writer.WriteNumber(edge->pathIndex);
+      writer.Write((uint8_t)edge->object.GetType());
+      writer.WriteNumber(edge->object.GetFileOffset());
+    }
+
+    return !writer.HasError();
+  }
+
+  bool ContractionHierarchy::Load(const std::string& filename)
+  {
+    FileScanner scanner;
+
+    if (!scanner.Open(filename,
+                      FileScanner::Sequential,
+                      true)) {
+      return false;
+    }
+
+    if (!Read(scanner)) {
+      std::cerr << "Error while reading contraction hierarchy from '" << filename << "'" << std::endl;
+      scanner.Close();
+      return false;
+    }
+
+    return scanner.Close();
+  }
+
+  bool ContractionHierarchy::Store(const std::string& filename) const
+  {
+    FileWriter writer;
+
+    if (!writer.Open(filename)) {
+      return false;
+    }
+
+    if (!Write(writer)) {
+      writer.Close();
+      return false;
+    }
+
+    return writer.Close();
+  }
+}
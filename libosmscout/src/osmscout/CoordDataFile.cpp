@@ -19,16 +19,22 @@
 
 #include "osmscout/CoordDataFile.h"
 
+#include <algorithm>
+
 #include <osmscout/system/Assert.h>
 
 #include <osmscout/util/File.h>
 
 namespace osmscout {
 
+  const size_t CoordDataFile::denseCoordByteSize;
+
   CoordDataFile::CoordDataFile(const std::string& datafile)
   : isOpen(false),
     datafile(datafile),
-    coordPageSize(0)
+    coordPageSize(0),
+    denseCoordOffset(0),
+    denseCoordCount(0)
   {
     // no code
   }
@@ -59,6 +65,19 @@ namespace osmscout {
         return false;
       }
 
+      if (coordPageSize==0) {
+        if (!scanner.Read(denseCoordCount) ||
+            !scanner.GetPos(denseCoordOffset)) {
+          Close();
+
+          return false;
+        }
+
+        isOpen=true;
+
+        return true;
+      }
+
       if (!scanner.Read(mapOffset)) {
         Close();
 
@@ -121,50 +140,147 @@ namespace osmscout {
     return datafilename;
   }
 
+  /**
+   * Return the offset of the coord of the given node in the file and the id
+   * the node gets in the database. Return false, if there is no entry for
+   * the given id.
+   */
+  bool CoordDataFile::GetOffset(OSMId id,
+                                FileOffset& offset,
+                                Id& substituteId) const
+  {
+    if (coordPageSize==0) {
+      if (id<0 ||
+          (FileOffset)id>=denseCoordCount) {
+        return false;
+      }
+
+      offset=denseCoordOffset+id*denseCoordByteSize;
+      substituteId=id;
+
+      return true;
+    }
+
+    PageId relatedId=id-std::numeric_limits<Id>::min();
+    PageId pageId=relatedId/coordPageSize;
+
+    CoordPageOffsetMap::const_iterator pageOffset=coordPageOffsetMap.find(pageId);
+
+    if (pageOffset==coordPageOffsetMap.end()) {
+      return false;
+    }
+
+    offset=pageOffset->second+(relatedId%coordPageSize)*coordByteSize;
+    // Number of entry in file (file starts with an empty page we skip)
+    substituteId=(offset-coordPageSize*coordByteSize)/coordByteSize;
+
+    return true;
+  }
+
+  /**
+   * Read the coord at the current position of the scanner
+   */
+  bool CoordDataFile::ReadCoord(GeoCoord& coord,
+                                bool& isSet) const
+  {
+    if (coordPageSize!=0) {
+      return scanner.ReadConditionalCoord(coord,
+                                          isSet);
+    }
+
+    uint32_t latValue;
+    uint32_t lonValue;
+
+    if (!scanner.Read(latValue) ||
+        !scanner.Read(lonValue)) {
+      return false;
+    }
+
+    // Values are stored incremented by one, so that holes in the file are unset
+    isSet=latValue!=0 && lonValue!=0;
+
+    if (isSet) {
+      coord.Set((latValue-1)/latConversionFactor-90.0,
+                (lonValue-1)/lonConversionFactor-180.0);
+    }
+
+    return true;
+  }
+
   bool CoordDataFile::Get(std::set<OSMId>& ids,
                           CoordResultMap& coordsMap) const
+  {
+    std::vector<OSMId> sortedIds(ids.begin(),
+                                 ids.end());
+
+    return Get(sortedIds,
+               coordsMap);
+  }
+
+  /**
+   * Load the coords of the given nodes. The ids get sorted (and duplicates
+   * removed), so that the file is read in ascending order and consecutive
+   * entries are read without repositioning.
+   */
+  bool CoordDataFile::Get(std::vector<OSMId>& ids,
+                          CoordResultMap& coordsMap) const
   {
     assert(isOpen);
 
+    std::sort(ids.begin(),ids.end());
+    ids.erase(std::unique(ids.begin(),ids.end()),
+              ids.end());
+
     coordsMap.clear();
 #if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
     coordsMap.reserve(ids.size());
 #endif
 
-    for (std::set<OSMId>::const_iterator id=ids.begin();
+    bool       hasPos=false;
+    FileOffset pos=0;
+
+    for (std::vector<OSMId>::const_iterator id=ids.begin();
          id!=ids.end();
          ++id) {
-      PageId relatedId=*id-std::numeric_limits<Id>::min();
-      PageId pageId=relatedId/coordPageSize;
-
-      CoordPageOffsetMap::const_iterator pageOffset=coordPageOffsetMap.find(pageId);
-
-      if (pageOffset!=coordPageOffsetMap.end()) {
-        FileOffset offset=pageOffset->second+(relatedId%coordPageSize)*coordByteSize;
-        // Number of entry in file (file starts with an empty page we skip)
-        PageId     substituteId=(offset-coordPageSize*coordByteSize)/coordByteSize;
+      FileOffset offset;
+      Id         substituteId;
 
-        scanner.SetPos(offset);
-
-        bool     isSet;
-        GeoCoord coord;
+      if (!GetOffset(*id,
+                     offset,
+                     substituteId)) {
+        continue;
+      }
 
-        if (!scanner.ReadConditionalCoord(coord,
-                                          isSet)) {
-          std::cerr << "Error while reading data from offset " << pageOffset->second << " of file " << datafilename << "!" << std::endl;
+      if (!hasPos ||
+          offset!=pos) {
+        if (!scanner.SetPos(offset)) {
+          std::cerr << "Error while positioning to offset " << offset << " of file " << datafilename << "!" << std::endl;
           scanner.Close();
           return false;
         }
+      }
 
-        if (!isSet) {
-          continue;
-        }
+      bool     isSet;
+      GeoCoord coord;
+
+      if (!ReadCoord(coord,
+                     isSet)) {
+        std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
+        scanner.Close();
+        return false;
+      }
+
+      pos=offset+(coordPageSize!=0 ? coordByteSize : denseCoordByteSize);
+      hasPos=true;
 
-        coordsMap.insert(std::make_pair(*id,
-                                        CoordEntry(substituteId,
-                                                   coord.GetLat(),
-                                                   coord.GetLon())));
+      if (!isSet) {
+        continue;
       }
+
+      coordsMap.insert(std::make_pair(*id,
+                                      CoordEntry(substituteId,
+                                                 coord.GetLat(),
+                                                 coord.GetLon())));
     }
 
     return true;
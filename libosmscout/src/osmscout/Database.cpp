@@ -37,8 +37,11 @@ namespace osmscout {
   : areaAreaIndexCacheSize(1000),
     areaNodeIndexCacheSize(1000),
     nodeCacheSize(1000),
+    nodeCacheMemory(0),
     wayCacheSize(4000),
+    wayCacheMemory(0),
     areaCacheSize(4000),
+    areaCacheMemory(0),
     debugPerformance(false)
   {
     // no code
@@ -59,16 +62,31 @@ namespace osmscout {
     this->nodeCacheSize=nodeCacheSize;
   }
 
+  void DatabaseParameter::SetNodeCacheMemory(unsigned long nodeCacheMemory)
+  {
+    this->nodeCacheMemory=nodeCacheMemory;
+  }
+
   void DatabaseParameter::SetWayCacheSize(unsigned long wayCacheSize)
   {
     this->wayCacheSize=wayCacheSize;
   }
 
+  void DatabaseParameter::SetWayCacheMemory(unsigned long wayCacheMemory)
+  {
+    this->wayCacheMemory=wayCacheMemory;
+  }
+
   void DatabaseParameter::SetAreaCacheSize(unsigned long areaCacheSize)
   {
     this->areaCacheSize=areaCacheSize;
   }
 
+  void DatabaseParameter::SetAreaCacheMemory(unsigned long areaCacheMemory)
+  {
+    this->areaCacheMemory=areaCacheMemory;
+  }
+
   void DatabaseParameter::SetDebugPerformance(bool debug)
   {
     debugPerformance=debug;
@@ -89,16 +107,31 @@ namespace osmscout {
     return nodeCacheSize;
   }
 
+  unsigned long DatabaseParameter::GetNodeCacheMemory() const
+  {
+    return nodeCacheMemory;
+  }
+
   unsigned long DatabaseParameter::GetWayCacheSize() const
   {
     return wayCacheSize;
   }
 
+  unsigned long DatabaseParameter::GetWayCacheMemory() const
+  {
+    return wayCacheMemory;
+  }
+
   unsigned long DatabaseParameter::GetAreaCacheSize() const
   {
     return areaCacheSize;
   }
 
+  unsigned long DatabaseParameter::GetAreaCacheMemory() const
+  {
+    return areaCacheMemory;
+  }
+
   bool DatabaseParameter::IsDebugPerformance() const
   {
     return debugPerformance;
@@ -161,6 +194,8 @@ namespace osmscout {
 
   void Database::Close()
   {
+    MutexLocker locker(accessMutex);
+
     if (nodeDataFile.Valid() &&
         nodeDataFile->IsOpen()) {
       nodeDataFile->Close();
@@ -209,6 +244,8 @@ namespace osmscout {
 
   void Database::FlushCache()
   {
+    MutexLocker locker(accessMutex);
+
     if (nodeDataFile.Valid()) {
       nodeDataFile->FlushCache();
     }
@@ -238,8 +275,11 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (nodeDataFile.Invalid()) {
-      nodeDataFile=new NodeDataFile(parameter.GetNodeCacheSize());
+      nodeDataFile=new NodeDataFile(parameter.GetNodeCacheSize(),
+                                    parameter.GetNodeCacheMemory());
     }
 
     if (!nodeDataFile->IsOpen()) {
@@ -261,9 +301,12 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (areaDataFile.Invalid()) {
       areaDataFile=new AreaDataFile("areas.dat",
-                                    parameter.GetAreaCacheSize());
+                                    parameter.GetAreaCacheSize(),
+                                    parameter.GetAreaCacheMemory());
     }
 
     if (!areaDataFile->IsOpen()) {
@@ -285,9 +328,12 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (wayDataFile.Invalid()) {
       wayDataFile=new WayDataFile("ways.dat",
-                                  parameter.GetWayCacheSize());
+                                  parameter.GetWayCacheSize(),
+                                  parameter.GetWayCacheMemory());
     }
 
     if (!wayDataFile->IsOpen()) {
@@ -309,6 +355,8 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (areaNodeIndex.Invalid()) {
       areaNodeIndex=new AreaNodeIndex(/*parameter.GetAreaNodeIndexCacheSize()*/);
 
@@ -329,6 +377,8 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (areaAreaIndex.Invalid()) {
       areaAreaIndex=new AreaAreaIndex(parameter.GetAreaAreaIndexCacheSize());
 
@@ -349,6 +399,8 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (areaWayIndex.Invalid()) {
       areaWayIndex=new AreaWayIndex();
 
@@ -369,6 +421,8 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (locationIndex.Invalid()) {
       locationIndex=new LocationIndex();
 
@@ -389,6 +443,8 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (waterIndex.Invalid()) {
       waterIndex=new WaterIndex();
 
@@ -409,6 +465,8 @@ namespace osmscout {
       return NULL;
     }
 
+    MutexLocker locker(accessMutex);
+
     if (optimizeAreasLowZoom.Invalid()) {
       optimizeAreasLowZoom=new OptimizeAreasLowZoom();
 
@@ -426,6 +484,8 @@ namespace osmscout {
 
   OptimizeWaysLowZoomRef Database::GetOptimizeWaysLowZoom() const
   {
+    MutexLocker locker(accessMutex);
+
     if (optimizeWaysLowZoom.Invalid()) {
       optimizeWaysLowZoom=new OptimizeWaysLowZoom();
 
@@ -648,8 +708,60 @@ namespace osmscout {
     return wayDataFile->GetByOffset(offsets,dataMap);
   }
 
+  /**
+   * Return read-only views of the nodes at the given offsets. The views
+   * stay valid as long as the database is open.
+   */
+  bool Database::GetNodeViewsByOffset(const std::vector<FileOffset>& offsets,
+                                      std::vector<NodeView>& nodes) const
+  {
+    NodeDataFileRef nodeDataFile=GetNodeDataFile();
+
+    if (nodeDataFile.Invalid()) {
+      return false;
+    }
+
+    return nodeDataFile->GetViewsByOffset(offsets,nodes);
+  }
+
+  /**
+   * Return read-only views of the areas at the given offsets. The views
+   * stay valid as long as the database is open.
+   */
+  bool Database::GetAreaViewsByOffset(const std::vector<FileOffset>& offsets,
+                                      std::vector<AreaView>& areas) const
+  {
+    AreaDataFileRef areaDataFile=GetAreaDataFile();
+
+    if (areaDataFile.Invalid()) {
+      return false;
+    }
+
+    return areaDataFile->GetViewsByOffset(offsets,areas);
+  }
+
+  /**
+   * Return read-only views of the ways at the given offsets. The views
+   * stay valid as long as the database is open.
+   */
+  bool Database::GetWayViewsByOffset(const std::vector<FileOffset>& offsets,
+                                     std::vector<WayView>& ways) const
+  {
+    WayDataFileRef wayDataFile=GetWayDataFile();
+
+    if (wayDataFile.Invalid()) {
+      return false;
+    }
+
+    return wayDataFile->GetViewsByOffset(offsets,ways);
+  }
+
   void Database::DumpStatistics()
   {
+    MutexLocker locker(accessMutex);
+
+    std::cout << "Object coordinates: " << sizeof(ObjectCoord) << " bytes/coordinate" << std::endl;
+
     if (nodeDataFile.Valid()) {
       nodeDataFile->DumpStatistics();
     }
@@ -0,0 +1,124 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/IndexCellCache.h>
+
+namespace osmscout {
+
+  bool IndexCellCache::CellKey::operator<(const CellKey& other) const
+  {
+    if (type!=other.type) {
+      return type<other.type;
+    }
+
+    if (y!=other.y) {
+      return y<other.y;
+    }
+
+    return x<other.x;
+  }
+
+  IndexCellCache::IndexCellCache()
+  : generation(0),
+    hits(0),
+    misses(0)
+  {
+    // no code
+  }
+
+  /**
+   * Start a new query. Cells used in the query must be requested using
+   * GetCell() or added using AddCell().
+   */
+  void IndexCellCache::StartQuery()
+  {
+    generation++;
+  }
+
+  /**
+   * Finish the current query, dropping all cells that were not used by it.
+   */
+  void IndexCellCache::FinishQuery()
+  {
+    CellMap::iterator cell=cells.begin();
+
+    while (cell!=cells.end()) {
+      if (cell->second.generation!=generation) {
+        cells.erase(cell++);
+      }
+      else {
+        ++cell;
+      }
+    }
+  }
+
+  /**
+   * Return the offsets of the given cell or NULL, if the cell is not
+   * cached.
+   */
+  const std::vector<FileOffset>* IndexCellCache::GetCell(TypeId type,
+                                                         uint32_t x,
+                                                         uint32_t y)
+  {
+    CellKey key;
+
+    key.type=type;
+    key.x=x;
+    key.y=y;
+
+    CellMap::iterator cell=cells.find(key);
+
+    if (cell==cells.end()) {
+      return NULL;
+    }
+
+    cell->second.generation=generation;
+    hits++;
+
+    return &cell->second.offsets;
+  }
+
+  /**
+   * Add a new (empty) cell for the current query and return its offsets
+   * for filling.
+   */
+  std::vector<FileOffset>& IndexCellCache::AddCell(TypeId type,
+                                                   uint32_t x,
+                                                   uint32_t y)
+  {
+    CellKey key;
+
+    key.type=type;
+    key.x=x;
+    key.y=y;
+
+    Cell& cell=cells[key];
+
+    cell.offsets.clear();
+    cell.generation=generation;
+    misses++;
+
+    return cell.offsets;
+  }
+
+  void IndexCellCache::Clear()
+  {
+    cells.clear();
+  }
+}
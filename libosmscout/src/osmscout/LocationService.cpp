@@ -1112,7 +1112,8 @@ namespace osmscout {
             AdminRegionReverseLookupVisitor::SearchEntry searchEntry;
 
             searchEntry.object=*object;
-            searchEntry.coords=area->rings[r].nodes;
+            searchEntry.coords.assign(area->rings[r].nodes.begin(),
+                                      area->rings[r].nodes.end());
 
             adminRegionVisitor.AddSearchEntry(searchEntry);
           }
@@ -1129,7 +1130,8 @@ namespace osmscout {
         AdminRegionReverseLookupVisitor::SearchEntry searchEntry;
 
         searchEntry.object=*object;
-        searchEntry.coords=way->nodes;
+        searchEntry.coords.assign(way->nodes.begin(),
+                                  way->nodes.end());
 
         adminRegionVisitor.AddSearchEntry(searchEntry);
       }
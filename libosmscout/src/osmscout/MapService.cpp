@@ -33,6 +33,22 @@
 
 namespace osmscout {
 
+  MapQueryCache::MapQueryCache()
+  {
+    // no code
+  }
+
+  MapQueryCache::~MapQueryCache()
+  {
+    // no code
+  }
+
+  void MapQueryCache::Clear()
+  {
+    nodeCells.Clear();
+    wayCells.Clear();
+  }
+
   AreaSearchParameter::AreaSearchParameter()
   : maxAreaLevel(4),
     maxNodes(2000),
@@ -79,6 +95,15 @@ namespace osmscout {
     this->breaker=breaker;
   }
 
+  /**
+   * Set the cache for incremental queries, see MapQueryCache. The cache
+   * must not be shared by queries running in parallel.
+   */
+  void AreaSearchParameter::SetQueryCache(const MapQueryCacheRef& queryCache)
+  {
+    this->queryCache=queryCache;
+  }
+
   unsigned long AreaSearchParameter::GetMaximumAreaLevel() const
   {
     return maxAreaLevel;
@@ -119,6 +144,11 @@ namespace osmscout {
     }
   }
 
+  MapQueryCacheRef AreaSearchParameter::GetQueryCache() const
+  {
+    return queryCache;
+  }
+
   MapService::MapService(const DatabaseRef& database)
    : database(database)
   {
@@ -130,13 +160,12 @@ namespace osmscout {
     // no code
   }
 
-  bool MapService::GetObjectsNodes(const AreaSearchParameter& parameter,
-                                   const TypeSet &nodeTypes,
-                                   double lonMin, double latMin,
-                                   double lonMax, double latMax,
-                                   std::string& nodeIndexTime,
-                                   std::string& nodesTime,
-                                   std::vector<NodeRef>& nodes) const
+  bool MapService::GetNodeOffsets(const AreaSearchParameter& parameter,
+                                  const TypeSet &nodeTypes,
+                                  double lonMin, double latMin,
+                                  double lonMax, double latMax,
+                                  std::string& nodeIndexTime,
+                                  std::vector<FileOffset>& offsets) const
   {
     AreaNodeIndexRef areaNodeIndex=database->GetAreaNodeIndex();
 
@@ -144,20 +173,19 @@ namespace osmscout {
       return false;
     }
 
-    nodes.clear();
-
     if (parameter.IsAborted()) {
       return false;
     }
 
-    std::vector<FileOffset> nodeOffsets;
-    StopClock               nodeIndexTimer;
+    MapQueryCacheRef queryCache=parameter.GetQueryCache();
+    StopClock        nodeIndexTimer;
 
     if (nodeTypes.HasTypes()) {
       if (!areaNodeIndex->GetOffsets(lonMin,latMin,lonMax,latMax,
                                      nodeTypes,
                                      parameter.GetMaximumNodes(),
-                                     nodeOffsets)) {
+                                     offsets,
+                                     queryCache.Valid() ? &queryCache->GetNodeCells() : NULL)) {
         std::cout << "Error getting nodes from area node index!" << std::endl;
         return false;
       }
@@ -170,39 +198,20 @@ namespace osmscout {
       return false;
     }
 
-    std::sort(nodeOffsets.begin(),nodeOffsets.end());
+    std::sort(offsets.begin(),offsets.end());
 
-    if (parameter.IsAborted()) {
-      return false;
-    }
-
-    StopClock nodesTimer;
-
-    if (!database->GetNodesByOffset(nodeOffsets,
-                                    nodes)) {
-      std::cout << "Error reading nodes in area!" << std::endl;
-      return false;
-    }
-
-    nodesTimer.Stop();
-    nodesTime=nodesTimer.ResultString();
-
-    if (parameter.IsAborted()) {
-      return false;
-    }
-
-    return true;
+    return !parameter.IsAborted();
   }
 
-  bool MapService::GetObjectsAreas(const AreaSearchParameter& parameter,
-                                   const TypeSet& areaTypes,
-                                   const Magnification& magnification,
-                                   double lonMin, double latMin,
-                                   double lonMax, double latMax,
-                                   std::string& areaOptimizedTime,
-                                   std::string& areaIndexTime,
-                                   std::string& areasTime,
-                                   std::vector<AreaRef>& areas) const
+  bool MapService::GetAreaOffsets(const AreaSearchParameter& parameter,
+                                  const TypeSet& areaTypes,
+                                  const Magnification& magnification,
+                                  double lonMin, double latMin,
+                                  double lonMax, double latMax,
+                                  std::string& areaOptimizedTime,
+                                  std::string& areaIndexTime,
+                                  std::vector<AreaRef>& optimizedAreas,
+                                  std::vector<FileOffset>& offsets) const
   {
     AreaAreaIndexRef        areaAreaIndex=database->GetAreaAreaIndex();
     OptimizeAreasLowZoomRef optimizeAreasLowZoom=database->GetOptimizeAreasLowZoom();
@@ -212,18 +221,6 @@ namespace osmscout {
       return false;
     }
 
-    OSMSCOUT_HASHMAP<FileOffset,AreaRef> cachedAreas;
-
-    for (std::vector<AreaRef>::const_iterator area=areas.begin();
-        area!=areas.end();
-        ++area) {
-      if ((*area)->GetFileOffset()!=0) {
-        cachedAreas[(*area)->GetFileOffset()]=*area;
-      }
-    }
-
-    areas.clear();
-
     TypeSet internalAreaTypes(areaTypes);
 
     if (parameter.IsAborted()) {
@@ -242,7 +239,7 @@ namespace osmscout {
                                        magnification,
                                        parameter.GetMaximumWays(),
                                        internalAreaTypes,
-                                       areas);
+                                       optimizedAreas);
       }
     }
 
@@ -253,8 +250,7 @@ namespace osmscout {
       return false;
     }
 
-    std::vector<FileOffset> offsets;
-    StopClock               areaIndexTimer;
+    StopClock areaIndexTimer;
 
     if (internalAreaTypes.HasTypes()) {
       if (!areaAreaIndex->GetOffsets(lonMin,
@@ -274,11 +270,195 @@ namespace osmscout {
     areaIndexTimer.Stop();
     areaIndexTime=areaIndexTimer.ResultString();
 
+    return !parameter.IsAborted();
+  }
+
+  bool MapService::GetWayOffsets(const AreaSearchParameter& parameter,
+                                 const std::vector<TypeSet>& wayTypes,
+                                 const Magnification& magnification,
+                                 double lonMin, double latMin,
+                                 double lonMax, double latMax,
+                                 std::string& wayOptimizedTime,
+                                 std::string& wayIndexTime,
+                                 std::vector<WayRef>& optimizedWays,
+                                 std::vector<FileOffset>& offsets) const
+  {
+    AreaWayIndexRef        areaWayIndex=database->GetAreaWayIndex();
+    OptimizeWaysLowZoomRef optimizeWaysLowZoom=database->GetOptimizeWaysLowZoom();
+
+    if (areaWayIndex.Invalid() ||
+        optimizeWaysLowZoom.Invalid()) {
+      return false;
+    }
+
+    std::vector<TypeSet> internalWayTypes(wayTypes);
+
+    if (parameter.IsAborted()) {
+      return false;
+    }
+
+    StopClock wayOptimizedTimer;
+
+    if (!internalWayTypes.empty()) {
+      if (parameter.GetUseLowZoomOptimization() &&
+          optimizeWaysLowZoom->HasOptimizations(magnification.GetMagnification())) {
+        optimizeWaysLowZoom->GetWays(lonMin,
+                                     latMin,
+                                     lonMax,
+                                     latMax,
+                                     magnification,
+                                     parameter.GetMaximumWays(),
+                                     internalWayTypes,
+                                     optimizedWays);
+      }
+    }
+
+    wayOptimizedTimer.Stop();
+    wayOptimizedTime=wayOptimizedTimer.ResultString();
+
     if (parameter.IsAborted()) {
       return false;
     }
 
-    areas.reserve(offsets.size());
+    MapQueryCacheRef queryCache=parameter.GetQueryCache();
+    StopClock        wayIndexTimer;
+
+    if (!internalWayTypes.empty()) {
+      if (!areaWayIndex->GetOffsets(lonMin,
+                                    latMin,
+                                    lonMax,
+                                    latMax,
+                                    internalWayTypes,
+                                    parameter.GetMaximumWays(),
+                                    offsets,
+                                    queryCache.Valid() ? &queryCache->GetWayCells() : NULL)) {
+        std::cout << "Error getting ways Glations from area way index!" << std::endl;
+        return false;
+      }
+    }
+
+    wayIndexTimer.Stop();
+    wayIndexTime=wayIndexTimer.ResultString();
+
+    return !parameter.IsAborted();
+  }
+
+  bool MapService::GetObjectsNodes(const AreaSearchParameter& parameter,
+                                   const TypeSet &nodeTypes,
+                                   double lonMin, double latMin,
+                                   double lonMax, double latMax,
+                                   std::string& nodeIndexTime,
+                                   std::string& nodesTime,
+                                   std::vector<NodeRef>& nodes) const
+  {
+    OSMSCOUT_HASHMAP<FileOffset,NodeRef> cachedNodes;
+
+    for (std::vector<NodeRef>::const_iterator node=nodes.begin();
+        node!=nodes.end();
+        ++node) {
+      cachedNodes[(*node)->GetFileOffset()]=*node;
+    }
+
+    nodes.clear();
+
+    std::vector<FileOffset> nodeOffsets;
+
+    if (!GetNodeOffsets(parameter,
+                        nodeTypes,
+                        lonMin,latMin,lonMax,latMax,
+                        nodeIndexTime,
+                        nodeOffsets)) {
+      return false;
+    }
+
+    std::vector<FileOffset> restOffsets;
+    std::vector<NodeRef>    restNodes;
+
+    restOffsets.reserve(nodeOffsets.size());
+
+    for (std::vector<FileOffset>::const_iterator offset=nodeOffsets.begin();
+        offset!=nodeOffsets.end();
+        ++offset) {
+      if (cachedNodes.find(*offset)==cachedNodes.end()) {
+        restOffsets.push_back(*offset);
+      }
+    }
+
+    StopClock nodesTimer;
+
+    if (!restOffsets.empty()) {
+      if (!database->GetNodesByOffset(restOffsets,
+                                      restNodes)) {
+        std::cout << "Error reading nodes in area!" << std::endl;
+        return false;
+      }
+    }
+
+    // Merge cached and loaded nodes, keeping the order of the offsets
+    std::vector<NodeRef>::const_iterator restNode=restNodes.begin();
+
+    nodes.reserve(nodeOffsets.size());
+
+    for (std::vector<FileOffset>::const_iterator offset=nodeOffsets.begin();
+        offset!=nodeOffsets.end();
+        ++offset) {
+      OSMSCOUT_HASHMAP<FileOffset,NodeRef>::const_iterator entry=cachedNodes.find(*offset);
+
+      if (entry!=cachedNodes.end()) {
+        nodes.push_back(entry->second);
+      }
+      else if (restNode!=restNodes.end()) {
+        nodes.push_back(*restNode);
+        ++restNode;
+      }
+    }
+
+    nodesTimer.Stop();
+    nodesTime=nodesTimer.ResultString();
+
+    if (parameter.IsAborted()) {
+      return false;
+    }
+
+    return true;
+  }
+
+  bool MapService::GetObjectsAreas(const AreaSearchParameter& parameter,
+                                   const TypeSet& areaTypes,
+                                   const Magnification& magnification,
+                                   double lonMin, double latMin,
+                                   double lonMax, double latMax,
+                                   std::string& areaOptimizedTime,
+                                   std::string& areaIndexTime,
+                                   std::string& areasTime,
+                                   std::vector<AreaRef>& areas) const
+  {
+    OSMSCOUT_HASHMAP<FileOffset,AreaRef> cachedAreas;
+
+    for (std::vector<AreaRef>::const_iterator area=areas.begin();
+        area!=areas.end();
+        ++area) {
+      if ((*area)->GetFileOffset()!=0) {
+        cachedAreas[(*area)->GetFileOffset()]=*area;
+      }
+    }
+
+    areas.clear();
+
+    std::vector<FileOffset> offsets;
+
+    if (!GetAreaOffsets(parameter,
+                        areaTypes,
+                        magnification,
+                        lonMin,latMin,lonMax,latMax,
+                        areaOptimizedTime,
+                        areaIndexTime,
+                        areas,
+                        offsets)) {
+      return false;
+    }
+
+    areas.reserve(areas.size()+offsets.size());
 
     std::vector<FileOffset> restOffsets;
 
@@ -329,14 +509,6 @@ namespace osmscout {
                                   std::string& waysTime,
                                   std::vector<WayRef>& ways) const
   {
-    AreaWayIndexRef        areaWayIndex=database->GetAreaWayIndex();
-    OptimizeWaysLowZoomRef optimizeWaysLowZoom=database->GetOptimizeWaysLowZoom();
-
-    if (areaWayIndex.Invalid() ||
-        optimizeWaysLowZoom.Invalid()) {
-      return false;
-    }
-
     OSMSCOUT_HASHMAP<FileOffset,WayRef> cachedWays;
 
     for (std::vector<WayRef>::const_iterator way=ways.begin();
@@ -349,59 +521,20 @@ namespace osmscout {
 
     ways.clear();
 
-    std::vector<TypeSet> internalWayTypes(wayTypes);
-
-    if (parameter.IsAborted()) {
-      return false;
-    }
-
-    StopClock wayOptimizedTimer;
-
-    if (!internalWayTypes.empty()) {
-      if (parameter.GetUseLowZoomOptimization() &&
-          optimizeWaysLowZoom->HasOptimizations(magnification.GetMagnification())) {
-        optimizeWaysLowZoom->GetWays(lonMin,
-                                     latMin,
-                                     lonMax,
-                                     latMax,
-                                     magnification,
-                                     parameter.GetMaximumWays(),
-                                     internalWayTypes,
-                                     ways);
-      }
-    }
-
-    wayOptimizedTimer.Stop();
-    wayOptimizedTime=wayOptimizedTimer.ResultString();
-
-    if (parameter.IsAborted()) {
-      return false;
-    }
-
     std::vector<FileOffset> offsets;
-    StopClock               wayIndexTimer;
 
-    if (!internalWayTypes.empty()) {
-      if (!areaWayIndex->GetOffsets(lonMin,
-                                    latMin,
-                                    lonMax,
-                                    latMax,
-                                    internalWayTypes,
-                                    parameter.GetMaximumWays(),
-                                    offsets)) {
-        std::cout << "Error getting ways Glations from area way index!" << std::endl;
-        return false;
-      }
-    }
-
-    wayIndexTimer.Stop();
-    wayIndexTime=wayIndexTimer.ResultString();
-
-    if (parameter.IsAborted()) {
+    if (!GetWayOffsets(parameter,
+                       wayTypes,
+                       magnification,
+                       lonMin,latMin,lonMax,latMax,
+                       wayOptimizedTime,
+                       wayIndexTime,
+                       ways,
+                       offsets)) {
       return false;
     }
 
-    ways.reserve(offsets.size());
+    ways.reserve(ways.size()+offsets.size());
 
     std::vector<FileOffset> restOffsets;
 
@@ -442,6 +575,122 @@ namespace osmscout {
     return !parameter.IsAborted();
   }
 
+  bool MapService::GetObjectsNodes(const AreaSearchParameter& parameter,
+                                   const TypeSet &nodeTypes,
+                                   double lonMin, double latMin,
+                                   double lonMax, double latMax,
+                                   std::vector<NodeView>& nodes) const
+  {
+    nodes.clear();
+
+    std::string             nodeIndexTime;
+    std::vector<FileOffset> offsets;
+
+    if (!GetNodeOffsets(parameter,
+                        nodeTypes,
+                        lonMin,latMin,lonMax,latMax,
+                        nodeIndexTime,
+                        offsets)) {
+      return false;
+    }
+
+    if (!database->GetNodeViewsByOffset(offsets,
+                                        nodes)) {
+      std::cout << "Error reading nodes in area!" << std::endl;
+      return false;
+    }
+
+    return !parameter.IsAborted();
+  }
+
+  bool MapService::GetObjectsAreas(const AreaSearchParameter& parameter,
+                                   const TypeSet& areaTypes,
+                                   const Magnification& magnification,
+                                   double lonMin, double latMin,
+                                   double lonMax, double latMax,
+                                   std::vector<AreaView>& areas) const
+  {
+    areas.clear();
+
+    std::string             areaOptimizedTime;
+    std::string             areaIndexTime;
+    std::vector<AreaRef>    optimizedAreas;
+    std::vector<FileOffset> offsets;
+
+    if (!GetAreaOffsets(parameter,
+                        areaTypes,
+                        magnification,
+                        lonMin,latMin,lonMax,latMax,
+                        areaOptimizedTime,
+                        areaIndexTime,
+                        optimizedAreas,
+                        offsets)) {
+      return false;
+    }
+
+    areas.reserve(optimizedAreas.size()+offsets.size());
+
+    for (std::vector<AreaRef>::const_iterator area=optimizedAreas.begin();
+        area!=optimizedAreas.end();
+        ++area) {
+      areas.push_back(AreaView(*area));
+    }
+
+    std::sort(offsets.begin(),offsets.end());
+
+    if (!database->GetAreaViewsByOffset(offsets,
+                                        areas)) {
+      std::cout << "Error reading areas in area!" << std::endl;
+      return false;
+    }
+
+    return !parameter.IsAborted();
+  }
+
+  bool MapService::GetObjectsWays(const AreaSearchParameter& parameter,
+                                  const std::vector<TypeSet>& wayTypes,
+                                  const Magnification& magnification,
+                                  double lonMin, double latMin,
+                                  double lonMax, double latMax,
+                                  std::vector<WayView>& ways) const
+  {
+    ways.clear();
+
+    std::string             wayOptimizedTime;
+    std::string             wayIndexTime;
+    std::vector<WayRef>     optimizedWays;
+    std::vector<FileOffset> offsets;
+
+    if (!GetWayOffsets(parameter,
+                       wayTypes,
+                       magnification,
+                       lonMin,latMin,lonMax,latMax,
+                       wayOptimizedTime,
+                       wayIndexTime,
+                       optimizedWays,
+                       offsets)) {
+      return false;
+    }
+
+    ways.reserve(optimizedWays.size()+offsets.size());
+
+    for (std::vector<WayRef>::const_iterator way=optimizedWays.begin();
+        way!=optimizedWays.end();
+        ++way) {
+      ways.push_back(WayView(*way));
+    }
+
+    std::sort(offsets.begin(),offsets.end());
+
+    if (!database->GetWayViewsByOffset(offsets,
+                                       ways)) {
+      std::cout << "Error reading ways in area!" << std::endl;
+      return false;
+    }
+
+    return !parameter.IsAborted();
+  }
+
   /**
    * Returns all objects conforming to the given restrictions.
    *
@@ -640,6 +889,82 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Returns all objects conforming to the given restrictions as read-only
+   * views. In contrast to the other variants no objects get allocated for
+   * data read from disk, coordinates are decoded lazily on access. The views
+   * are only valid as long as the database is open.
+   *
+   * See the variant returning references for a description of the parameters.
+   *
+   * @return
+   *    False, if there was an error, else true.
+   */
+  bool MapService::GetObjects(const AreaSearchParameter& parameter,
+                              const Magnification& magnification,
+                              const TypeSet &nodeTypes,
+                              double nodeLonMin, double nodeLatMin,
+                              double nodeLonMax, double nodeLatMax,
+                              std::vector<NodeView>& nodes,
+                              const std::vector<TypeSet>& wayTypes,
+                              double wayLonMin, double wayLatMin,
+                              double wayLonMax, double wayLatMax,
+                              std::vector<WayView>& ways,
+                              const TypeSet& areaTypes,
+                              double areaLonMin, double areaLatMin,
+                              double areaLonMax, double areaLatMax,
+                              std::vector<AreaView>& areas) const
+  {
+    bool nodesSuccess=true;
+    bool waysSuccess=true;
+    bool areasSuccess=true;
+
+#pragma omp parallel if(parameter.GetUseMultithreading())
+#pragma omp sections
+    {
+#pragma omp section
+      nodesSuccess=GetObjectsNodes(parameter,
+                                   nodeTypes,
+                                   nodeLonMin,
+                                   nodeLatMin,
+                                   nodeLonMax,
+                                   nodeLatMax,
+                                   nodes);
+
+#pragma omp section
+      waysSuccess=GetObjectsWays(parameter,
+                                 wayTypes,
+                                 magnification,
+                                 wayLonMin,
+                                 wayLatMin,
+                                 wayLonMax,
+                                 wayLatMax,
+                                 ways);
+
+#pragma omp section
+      areasSuccess=GetObjectsAreas(parameter,
+                                   areaTypes,
+                                   magnification,
+                                   areaLonMin,
+                                   areaLatMin,
+                                   areaLonMax,
+                                   areaLatMax,
+                                   areas);
+    }
+
+    if (!nodesSuccess ||
+        !waysSuccess ||
+        !areasSuccess) {
+      nodes.clear();
+      areas.clear();
+      ways.clear();
+
+      return false;
+    }
+
+    return true;
+  }
+
   /**
    * Return all ground tiles for the given area and the given magnification.
    *
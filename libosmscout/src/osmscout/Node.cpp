@@ -36,6 +36,15 @@ namespace osmscout {
     featureValueBuffer.Set(buffer);
   }
 
+  /**
+   * Return the (approximate) number of bytes used by the node in memory.
+   */
+  size_t Node::GetMemoryUsage() const
+  {
+    return sizeof(Node)+
+           featureValueBuffer.GetAllocatedMemory();
+  }
+
   bool Node::Read(const TypeConfig& typeConfig,
                   FileScanner& scanner)
   {
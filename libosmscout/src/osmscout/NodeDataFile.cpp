@@ -21,9 +21,11 @@
 
 namespace osmscout {
 
-  NodeDataFile::NodeDataFile(unsigned long dataCacheSize)
+  NodeDataFile::NodeDataFile(unsigned long dataCacheSize,
+                             unsigned long dataCacheMemory)
   : DataFile<Node>("nodes.dat",
-                   dataCacheSize)
+                   dataCacheSize,
+                   dataCacheMemory)
   {
     // no code
   }
@@ -0,0 +1,374 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ObjectView.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace osmscout {
+
+  GeoCoordView::GeoCoordView()
+  : data(NULL),
+    coords(NULL),
+    count(0),
+    minLat(0.0),
+    minLon(0.0)
+  {
+    // no code
+  }
+
+  GeoCoordView::GeoCoordView(const std::vector<ObjectCoord>& coords)
+  : data(NULL),
+    coords(coords.empty() ? NULL : &coords[0]),
+    count(coords.size()),
+    minLat(0.0),
+    minLon(0.0)
+  {
+    // no code
+  }
+
+  /**
+   * Read the base coordinate and remember the position of the encoded
+   * coordinate deltas in the memory mapped file. The scanner is positioned
+   * after the encoded coordinates afterwards.
+   */
+  bool GeoCoordView::Read(FileScanner& scanner,
+                          const char* mappedData,
+                          size_t count)
+  {
+    GeoCoord   minCoord;
+    FileOffset pos;
+
+    if (!scanner.ReadCoord(minCoord) ||
+        !scanner.GetPos(pos)) {
+      return false;
+    }
+
+    this->data=mappedData+pos;
+    this->coords=NULL;
+    this->count=count;
+    this->minLat=minCoord.GetLat();
+    this->minLon=minCoord.GetLon();
+
+    // Skip the encoded latitude and longitude deltas, the last byte of each
+    // number does not have the continuation bit set
+    const char* current=data;
+    size_t      numbers=2*count;
+
+    while (numbers>0) {
+      if ((*current & 0x80)==0) {
+        numbers--;
+      }
+
+      current++;
+    }
+
+    return scanner.SetPos(pos+(current-data));
+  }
+
+  void GeoCoordView::CopyTo(std::vector<GeoCoord>& nodes) const
+  {
+    nodes.clear();
+    nodes.reserve(count);
+
+    for (const_iterator coord=begin();
+         coord!=end();
+         ++coord) {
+      nodes.push_back(*coord);
+    }
+  }
+
+  void GeoCoordView::GetBoundingBox(double& minLon,
+                                    double& maxLon,
+                                    double& minLat,
+                                    double& maxLat) const
+  {
+    assert(count>0);
+
+    minLon=std::numeric_limits<double>::max();
+    maxLon=-std::numeric_limits<double>::max();
+    minLat=std::numeric_limits<double>::max();
+    maxLat=-std::numeric_limits<double>::max();
+
+    for (const_iterator coord=begin();
+         coord!=end();
+         ++coord) {
+      minLon=std::min(minLon,coord->GetLon());
+      maxLon=std::max(maxLon,coord->GetLon());
+      minLat=std::min(minLat,coord->GetLat());
+      maxLat=std::max(maxLat,coord->GetLat());
+    }
+  }
+
+  NodeView::NodeView()
+  : fileOffset(0)
+  {
+    // no code
+  }
+
+  NodeView::NodeView(const NodeRef& node)
+  : node(node),
+    fileOffset(node->GetFileOffset()),
+    coords(node->GetCoords())
+  {
+    // no code
+  }
+
+  bool NodeView::Read(const TypeConfig& typeConfig,
+                      FileScanner& scanner,
+                      const char* /*mappedData*/)
+  {
+    if (!scanner.GetPos(fileOffset)) {
+      return false;
+    }
+
+    uint32_t tmpType;
+
+    scanner.ReadNumber(tmpType);
+
+    TypeInfoRef type=typeConfig.GetTypeInfo((TypeId)tmpType);
+
+    featureValueBuffer.SetType(type);
+
+    if (!featureValueBuffer.Read(scanner)) {
+      return false;
+    }
+
+    scanner.ReadCoord(coords);
+
+    return !scanner.HasError();
+  }
+
+  WayView::WayView()
+  : fileOffset(0)
+  {
+    // no code
+  }
+
+  WayView::WayView(const WayRef& way)
+  : way(way),
+    fileOffset(way->GetFileOffset()),
+    nodes(way->nodes)
+  {
+    // no code
+  }
+
+  bool WayView::Read(const TypeConfig& typeConfig,
+                     FileScanner& scanner,
+                     const char* mappedData)
+  {
+    if (!scanner.GetPos(fileOffset)) {
+      return false;
+    }
+
+    uint32_t tmpType;
+
+    scanner.ReadNumber(tmpType);
+
+    TypeInfoRef type=typeConfig.GetTypeInfo((TypeId)tmpType);
+
+    featureValueBuffer.SetType(type);
+
+    if (!featureValueBuffer.Read(scanner)) {
+      return false;
+    }
+
+    uint32_t nodeCount;
+
+    if (!scanner.ReadNumber(nodeCount)) {
+      return false;
+    }
+
+    // The node ids following the coordinates are not part of the view
+    // and thus are not read
+    return nodes.Read(scanner,
+                      mappedData,
+                      nodeCount);
+  }
+
+  AreaView::Ring::Ring()
+  : ring(NULL),
+    level(0)
+  {
+    // no code
+  }
+
+  AreaView::Ring::Ring(const Area::Ring& ring)
+  : ring(&ring),
+    level(ring.ring),
+    nodes(ring.nodes)
+  {
+    // no code
+  }
+
+  AreaView::AreaView()
+  : fileOffset(0)
+  {
+    // no code
+  }
+
+  AreaView::AreaView(const AreaRef& area)
+  : area(area),
+    fileOffset(area->GetFileOffset())
+  {
+    rings.reserve(area->rings.size());
+
+    for (std::vector<Area::Ring>::const_iterator ring=area->rings.begin();
+         ring!=area->rings.end();
+         ++ring) {
+      rings.push_back(Ring(*ring));
+    }
+  }
+
+  /**
+   * Skip the node ids of a ring, see Area::ReadIds() for the format.
+   */
+  bool AreaView::SkipIds(FileScanner& scanner,
+                         uint32_t nodesCount)
+  {
+    Id minId;
+
+    scanner.ReadNumber(minId);
+
+    if (minId>0) {
+      size_t idCurrent=0;
+
+      while (idCurrent<nodesCount) {
+        uint8_t bitset;
+        size_t  bitmask=1;
+
+        scanner.Read(bitset);
+
+        for (size_t i=0; i<8 && idCurrent<nodesCount; i++) {
+          if (bitset & bitmask) {
+            Id id;
+
+            scanner.ReadNumber(id);
+          }
+
+          bitmask*=2;
+          idCurrent++;
+        }
+      }
+    }
+
+    return !scanner.HasError();
+  }
+
+  bool AreaView::Read(const TypeConfig& typeConfig,
+                      FileScanner& scanner,
+                      const char* mappedData)
+  {
+    if (!scanner.GetPos(fileOffset)) {
+      return false;
+    }
+
+    TypeId   outerType;
+    uint32_t ringCount=1;
+    uint32_t nodesCount;
+
+    if (!scanner.ReadNumber(outerType)) {
+      return false;
+    }
+
+    if (outerType>typeConfig.GetMaxTypeId()) {
+      outerType=outerType-typeConfig.GetMaxTypeId()-1;
+
+      if (!scanner.ReadNumber(ringCount)) {
+        return false;
+      }
+
+      ringCount++;
+    }
+
+    rings.resize(ringCount);
+
+    TypeInfoRef type=typeConfig.GetTypeInfo((TypeId)outerType);
+
+    rings[0].featureValueBuffer.SetType(type);
+
+    if (!type->GetIgnore()) {
+      if (!rings[0].featureValueBuffer.Read(scanner)) {
+        return false;
+      }
+    }
+
+    if (ringCount>1) {
+      rings[0].level=Area::masterRingId;
+    }
+    else {
+      rings[0].level=Area::outerRingId;
+    }
+
+    scanner.ReadNumber(nodesCount);
+
+    if (nodesCount>0) {
+      if (!SkipIds(scanner,
+                   nodesCount)) {
+        return false;
+      }
+
+      if (!rings[0].nodes.Read(scanner,
+                               mappedData,
+                               nodesCount)) {
+        return false;
+      }
+    }
+
+    for (size_t i=1; i<ringCount; i++) {
+      TypeId ringType;
+
+      scanner.ReadNumber(ringType);
+
+      type=typeConfig.GetTypeInfo(ringType);
+
+      rings[i].featureValueBuffer.SetType(type);
+
+      if (!type->GetIgnore()) {
+        if (!rings[i].featureValueBuffer.Read(scanner)) {
+          return false;
+        }
+      }
+
+      scanner.Read(rings[i].level);
+
+      scanner.ReadNumber(nodesCount);
+
+      if (nodesCount>0 &&
+          !type->GetIgnore()) {
+        if (!SkipIds(scanner,
+                     nodesCount)) {
+          return false;
+        }
+      }
+
+      if (nodesCount>0) {
+        if (!rings[i].nodes.Read(scanner,
+                                 mappedData,
+                                 nodesCount)) {
+          return false;
+        }
+      }
+    }
+
+    return !scanner.HasError();
+  }
+}
@@ -130,6 +130,8 @@ namespace osmscout
 
   bool OptimizeAreasLowZoom::Close()
   {
+    MutexLocker locker(accessMutex);
+
     bool success=true;
 
     if (scanner.IsOpen()) {
@@ -269,6 +271,8 @@ namespace osmscout
                                       TypeSet& areaTypes,
                                       std::vector<AreaRef>& areas) const
   {
+    MutexLocker locker(accessMutex);
+
     std::vector<FileOffset> offsets;
 
     if (!scanner.IsOpen()) {
@@ -130,6 +130,8 @@ namespace osmscout
 
   bool OptimizeWaysLowZoom::Close()
   {
+    MutexLocker locker(accessMutex);
+
     bool success=true;
 
     if (scanner.IsOpen()) {
@@ -269,6 +271,8 @@ namespace osmscout
                                     std::vector<TypeSet>& wayTypes,
                                     std::vector<WayRef>& ways) const
   {
+    MutexLocker locker(accessMutex);
+
     std::vector<FileOffset> offsets;
 
     if (!scanner.IsOpen()) {
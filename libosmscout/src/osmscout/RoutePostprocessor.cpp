@@ -1280,8 +1280,8 @@ namespace osmscout {
     if (object.GetType()==refArea) {
       AreaRef area=GetArea(object.GetFileOffset());
 
-      lat=area->rings.front().nodes[nodeIndex].lat;
-      lon=area->rings.front().nodes[nodeIndex].lon;
+      lat=area->rings.front().nodes[nodeIndex].GetLat();
+      lon=area->rings.front().nodes[nodeIndex].GetLon();
     }
     else if (object.GetType()==refWay) {
       WayRef way=GetWay(object.GetFileOffset());
@@ -0,0 +1,291 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/RouteSegmentIndex.h>
+
+#include <iostream>
+#include <queue>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  /**
+   * Length of one degree of latitude in meter (using the average radius of
+   * the earth)
+   */
+  static const double metersPerDegree=2*M_PI*6371010.0/360.0;
+
+  /**
+   * Entry of the queue of GetClosestSegments(), either an index node to
+   * visit or a segment found
+   */
+  struct RouteSegmentQueueEntry
+  {
+    double     distance;  //! Minimum distance of the node or distance of the segment
+    bool       isSegment; //! The entry is a segment, not a node
+    FileOffset offset;    //! Offset of the node
+    size_t     index;     //! Index of the segment in the list of candidates
+
+    inline bool operator<(const RouteSegmentQueueEntry& other) const
+    {
+      return distance>other.distance;
+    }
+  };
+
+  RouteSegmentIndex::RouteSegmentIndex()
+  : rootOffset(0),
+    segmentCount(0)
+  {
+    // no code
+  }
+
+  RouteSegmentIndex::~RouteSegmentIndex()
+  {
+    Close();
+  }
+
+  bool RouteSegmentIndex::Load(const std::string& filename)
+  {
+    MutexLocker locker(accessMutex);
+
+    this->filename=filename;
+
+    if (!scanner.Open(filename,FileScanner::LowMemRandom,true)) {
+      std::cerr << "Cannot open file '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    if (!scanner.ReadFileOffset(rootOffset) ||
+        !scanner.Read(segmentCount)) {
+      std::cerr << "Error while reading header of file '" << filename << "'" << std::endl;
+      scanner.Close();
+      return false;
+    }
+
+    return true;
+  }
+
+  void RouteSegmentIndex::Close()
+  {
+    MutexLocker locker(accessMutex);
+
+    if (scanner.IsOpen()) {
+      scanner.Close();
+    }
+  }
+
+  /**
+   * Return the segments closest to the given coordinate, ordered by
+   * distance. Distances are calculated in a local planar approximation
+   * around the given coordinate, which is exact enough for the small
+   * distances relevant for snapping a coordinate to the routing network.
+   *
+   * @param coord
+   *    The search coordinate
+   * @param count
+   *    The maximum number of segments to return
+   * @param maxDistance
+   *    The maximum distance of a segment to the search coordinate in meter
+   * @param matches
+   *    The segments found, closest first
+   * @return
+   *    false on error, else true
+   */
+  bool RouteSegmentIndex::GetClosestSegments(const GeoCoord& coord,
+                                             size_t count,
+                                             double maxDistance,
+                                             std::vector<Match>& matches) const
+  {
+    MutexLocker locker(accessMutex);
+
+    matches.clear();
+
+    if (!scanner.IsOpen()) {
+      return false;
+    }
+
+    if (segmentCount==0 ||
+        count==0) {
+      return true;
+    }
+
+    double                                      latScale=metersPerDegree;
+    double                                      lonScale=metersPerDegree*cos(coord.GetLat()*M_PI/180.0);
+    std::vector<Match>                          candidates;
+    std::priority_queue<RouteSegmentQueueEntry> queue;
+    RouteSegmentQueueEntry                      rootEntry;
+
+    rootEntry.distance=0.0;
+    rootEntry.isSegment=false;
+    rootEntry.offset=rootOffset;
+    rootEntry.index=0;
+
+    queue.push(rootEntry);
+
+    while (!queue.empty()) {
+      RouteSegmentQueueEntry current=queue.top();
+
+      queue.pop();
+
+      if (current.distance>maxDistance) {
+        break;
+      }
+
+      if (current.isSegment) {
+        matches.push_back(candidates[current.index]);
+
+        if (matches.size()>=count) {
+          break;
+        }
+
+        continue;
+      }
+
+      uint8_t isLeaf;
+      uint8_t entryCount;
+
+      if (!scanner.SetPos(current.offset) ||
+          !scanner.Read(isLeaf) ||
+          !scanner.Read(entryCount)) {
+        std::cerr << "Error while reading index node from file '" << filename << "'" << std::endl;
+        return false;
+      }
+
+      for (size_t e=0; e<entryCount; e++) {
+        RouteSegmentQueueEntry entry;
+
+        if (isLeaf!=0) {
+          FileOffset wayOffset;
+          uint32_t   segmentIndex;
+          uint32_t   fromLatValue,fromLonValue;
+          uint32_t   toLatValue,toLonValue;
+
+          if (!scanner.ReadFileOffset(wayOffset) ||
+              !scanner.ReadNumber(segmentIndex) ||
+              !scanner.Read(fromLatValue) ||
+              !scanner.Read(fromLonValue) ||
+              !scanner.Read(toLatValue) ||
+              !scanner.Read(toLonValue)) {
+            std::cerr << "Error while reading index node from file '" << filename << "'" << std::endl;
+            return false;
+          }
+
+          double fromLat=fromLatValue/latConversionFactor-90.0;
+          double fromLon=fromLonValue/lonConversionFactor-180.0;
+          double toLat=toLatValue/latConversionFactor-90.0;
+          double toLon=toLonValue/lonConversionFactor-180.0;
+
+          // Project the search coordinate onto the segment, using a local
+          // coordinate system in meter with the search coordinate as origin
+          double ax=(fromLon-coord.GetLon())*lonScale;
+          double ay=(fromLat-coord.GetLat())*latScale;
+          double dx=(toLon-fromLon)*lonScale;
+          double dy=(toLat-fromLat)*latScale;
+          double length=dx*dx+dy*dy;
+          double t=0.0;
+
+          if (length>0.0) {
+            t=-(ax*dx+ay*dy)/length;
+
+            if (t<0.0) {
+              t=0.0;
+            }
+            else if (t>1.0) {
+              t=1.0;
+            }
+          }
+
+          double px=ax+t*dx;
+          double py=ay+t*dy;
+
+          entry.distance=sqrt(px*px+py*py);
+
+          if (entry.distance>maxDistance) {
+            continue;
+          }
+
+          Match match;
+
+          match.object.Set(wayOffset,refWay);
+          match.segmentIndex=segmentIndex;
+          match.nodeIndex=t<=0.5 ? segmentIndex : segmentIndex+1;
+          match.projection.Set(fromLat+t*(toLat-fromLat),
+                               fromLon+t*(toLon-fromLon));
+          match.distance=entry.distance;
+
+          entry.isSegment=true;
+          entry.offset=0;
+          entry.index=candidates.size();
+
+          candidates.push_back(match);
+        }
+        else {
+          uint32_t   minLatValue,minLonValue;
+          uint32_t   maxLatValue,maxLonValue;
+          FileOffset childOffset;
+
+          if (!scanner.Read(minLatValue) ||
+              !scanner.Read(minLonValue) ||
+              !scanner.Read(maxLatValue) ||
+              !scanner.Read(maxLonValue) ||
+              !scanner.ReadFileOffset(childOffset)) {
+            std::cerr << "Error while reading index node from file '" << filename << "'" << std::endl;
+            return false;
+          }
+
+          double minLat=minLatValue/latConversionFactor-90.0;
+          double minLon=minLonValue/lonConversionFactor-180.0;
+          double maxLat=maxLatValue/latConversionFactor-90.0;
+          double maxLon=maxLonValue/lonConversionFactor-180.0;
+          double dLat=0.0;
+          double dLon=0.0;
+
+          if (coord.GetLat()<minLat) {
+            dLat=(minLat-coord.GetLat())*latScale;
+          }
+          else if (coord.GetLat()>maxLat) {
+            dLat=(coord.GetLat()-maxLat)*latScale;
+          }
+
+          if (coord.GetLon()<minLon) {
+            dLon=(minLon-coord.GetLon())*lonScale;
+          }
+          else if (coord.GetLon()>maxLon) {
+            dLon=(coord.GetLon()-maxLon)*lonScale;
+          }
+
+          entry.distance=sqrt(dLat*dLat+dLon*dLon);
+
+          if (entry.distance>maxDistance) {
+            continue;
+          }
+
+          entry.isSegment=false;
+          entry.offset=childOffset;
+          entry.index=0;
+        }
+
+        queue.push(entry);
+      }
+    }
+
+    return true;
+  }
+}
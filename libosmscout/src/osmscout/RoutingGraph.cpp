@@ -0,0 +1,246 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/RoutingGraph.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+#include <osmscout/util/FileScanner.h>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  const uint32_t RoutingGraph::noNode;
+
+  RoutingGraph::RoutingGraph()
+  {
+    // no code
+  }
+
+  RoutingGraph::~RoutingGraph()
+  {
+    // no code
+  }
+
+  /**
+   * Load the complete routing graph from the given route node data file.
+   */
+  bool RoutingGraph::Load(const std::string& filename)
+  {
+    FileScanner                       scanner;
+    uint32_t                          nodeCount;
+    std::vector<FileOffset>           targetOffsets;
+    std::map<ObjectFileRef,uint32_t>  objectIndexes;
+
+    nodeOffsets.clear();
+    nodeLats.clear();
+    nodeLons.clear();
+    edgeStart.clear();
+    edges.clear();
+    objects.clear();
+    excludeStart.clear();
+    excludes.clear();
+
+    if (!scanner.Open(filename,
+                      FileScanner::Sequential,
+                      true)) {
+      std::cerr << "Cannot open '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      std::cerr << "Error while reading number of route nodes from '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    nodeOffsets.reserve(nodeCount);
+    nodeLats.reserve(nodeCount);
+    nodeLons.reserve(nodeCount);
+    edgeStart.reserve(nodeCount+1);
+    excludeStart.reserve(nodeCount+1);
+
+    for (uint32_t n=0; n<nodeCount; n++) {
+      RouteNode node;
+
+      if (!node.Read(scanner)) {
+        std::cerr << "Error while reading route node " << n << " from '" << filename << "'" << std::endl;
+        return false;
+      }
+
+      // The minimum of the path coordinates is the minimum coordinate stored in
+      // the route node (at least one path has an offset of 0 to it), so we can
+      // restore the fixed point values of the data file
+      double minLat=0.0;
+      double minLon=0.0;
+
+      for (size_t p=0; p<node.paths.size(); p++) {
+        if (p==0 ||
+            node.paths[p].lat<minLat) {
+          minLat=node.paths[p].lat;
+        }
+
+        if (p==0 ||
+            node.paths[p].lon<minLon) {
+          minLon=node.paths[p].lon;
+        }
+      }
+
+      nodeOffsets.push_back(node.GetFileOffset());
+      nodeLats.push_back(node.paths.empty() ? 0 : (uint32_t)round((minLat+90.0)*latConversionFactor));
+      nodeLons.push_back(node.paths.empty() ? 0 : (uint32_t)round((minLon+180.0)*lonConversionFactor));
+      edgeStart.push_back((uint32_t)edges.size());
+      excludeStart.push_back((uint32_t)excludes.size());
+
+      for (std::vector<RouteNode::Path>::const_iterator path=node.paths.begin();
+           path!=node.paths.end();
+           ++path) {
+        const ObjectFileRef&                       object=node.objects[path->objectIndex];
+        std::map<ObjectFileRef,uint32_t>::iterator objectIndex=objectIndexes.find(object);
+        Edge                                       edge;
+
+        if (objectIndex==objectIndexes.end()) {
+          objectIndex=objectIndexes.insert(std::make_pair(object,(uint32_t)objects.size())).first;
+          objects.push_back(object);
+        }
+
+        edge.target=noNode;
+        edge.object=objectIndex->second;
+        edge.distance=(uint32_t)floor(path->distance*(1000.0*100.0)+0.5);
+        edge.latValue=(uint32_t)round((path->lat-minLat)*latConversionFactor);
+        edge.lonValue=(uint32_t)round((path->lon-minLon)*lonConversionFactor);
+        edge.type=path->type;
+        edge.maxSpeed=path->maxSpeed;
+        edge.grade=path->grade;
+        edge.flags=path->flags;
+
+        edges.push_back(edge);
+
+        targetOffsets.push_back(path->offset);
+      }
+
+      excludes.insert(excludes.end(),
+                      node.excludes.begin(),
+                      node.excludes.end());
+    }
+
+    edgeStart.push_back((uint32_t)edges.size());
+    excludeStart.push_back((uint32_t)excludes.size());
+
+    if (!scanner.Close()) {
+      std::cerr << "Cannot close '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    for (size_t e=0; e<edges.size(); e++) {
+      uint32_t target=GetNodeIndex(targetOffsets[e]);
+
+      if (target==noNode) {
+        std::cerr << "Cannot resolve route node at offset " << targetOffsets[e] << " in '" << filename << "'" << std::endl;
+        return false;
+      }
+
+      edges[e].target=target;
+    }
+
+    // Release the memory over-allocated while growing
+    std::vector<Edge>(edges).swap(edges);
+    std::vector<ObjectFileRef>(objects).swap(objects);
+    std::vector<RouteNode::Exclude>(excludes).swap(excludes);
+
+    return true;
+  }
+
+  /**
+   * Return the index of the node with the given file offset or noNode,
+   * if there is no such node.
+   */
+  uint32_t RoutingGraph::GetNodeIndex(FileOffset offset) const
+  {
+    std::vector<FileOffset>::const_iterator node=std::lower_bound(nodeOffsets.begin(),
+                                                                  nodeOffsets.end(),
+                                                                  offset);
+
+    if (node==nodeOffsets.end() ||
+        *node!=offset) {
+      return noNode;
+    }
+
+    return (uint32_t)(node-nodeOffsets.begin());
+  }
+
+  /**
+   * Return true, if the path with the given index (relative to the first
+   * edge of the node) must not be used coming from the given object.
+   */
+  bool RoutingGraph::IsExcluded(uint32_t node,
+                                const ObjectFileRef& source,
+                                uint32_t pathIndex) const
+  {
+    for (uint32_t e=excludeStart[node]; e<excludeStart[node+1]; e++) {
+      if (excludes[e].source==source &&
+          excludes[e].targetIndex==pathIndex) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Fill the given path with the information of the given edge of the given
+   * node, so that it can be evaluated by a RoutingProfile. The object index of
+   * the path references the object table of the graph.
+   */
+  void RoutingGraph::GetPath(uint32_t node,
+                             uint32_t edge,
+                             RouteNode::Path& path) const
+  {
+    const Edge& e=edges[edge];
+
+    path.offset=nodeOffsets[e.target];
+    path.objectIndex=e.object;
+    path.type=e.type;
+    path.maxSpeed=e.maxSpeed;
+    path.grade=e.grade;
+    path.flags=e.flags;
+    path.distance=e.distance/(1000.0*100.0);
+    // Same calculation as in RouteNode::Read()
+    path.lat=(nodeLats[node]/latConversionFactor-90.0)+e.latValue/latConversionFactor;
+    path.lon=(nodeLons[node]/lonConversionFactor-180.0)+e.lonValue/lonConversionFactor;
+  }
+
+  /**
+   * Return the number of bytes allocated for the graph
+   */
+  size_t RoutingGraph::GetMemoryUsage() const
+  {
+    return sizeof(RoutingGraph)+
+           nodeOffsets.capacity()*sizeof(FileOffset)+
+           nodeLats.capacity()*sizeof(uint32_t)+
+           nodeLons.capacity()*sizeof(uint32_t)+
+           edgeStart.capacity()*sizeof(uint32_t)+
+           edges.capacity()*sizeof(Edge)+
+           objects.capacity()*sizeof(ObjectFileRef)+
+           excludeStart.capacity()*sizeof(uint32_t)+
+           excludes.capacity()*sizeof(RouteNode::Exclude);
+  }
+}
@@ -150,11 +150,16 @@ namespace osmscout {
   bool AbstractRoutingProfile::CanUse(const RouteNode& currentNode,
                                       size_t pathIndex) const
   {
-    if (!(currentNode.paths[pathIndex].flags & vehicleRouteNodeBit)) {
+    return CanUse(currentNode.paths[pathIndex]);
+  }
+
+  bool AbstractRoutingProfile::CanUse(const RouteNode::Path& path) const
+  {
+    if (!(path.flags & vehicleRouteNodeBit)) {
       return false;
     }
 
-    TypeId type=currentNode.paths[pathIndex].type;
+    TypeId type=path.type;
 
     return type<speeds.size() && speeds[type]>0.0;
   }
@@ -21,20 +21,34 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
 
 #include <osmscout/RoutingProfile.h>
 
 #include <osmscout/system/Assert.h>
 
+#include <osmscout/util/File.h>
+
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
 
 //#define DEBUG_ROUTING
 
 namespace osmscout {
 
   RouterParameter::RouterParameter()
-  : debugPerformance(false)
+  : debugPerformance(false),
+    useIndexedHeap(true),
+    useContractionHierarchy(true),
+    useInMemoryGraph(false),
+    matrixThreadCount(1)
   {
     // no code
   }
@@ -44,11 +58,75 @@ namespace osmscout {
     debugPerformance=debug;
   }
 
+  /**
+   * If set to true (the default) the route calculation uses an indexed heap as
+   * open list and holds the search state in one contiguous vector, else a
+   * std::set and individually allocated nodes are used. Both deliver the
+   * same routes.
+   */
+  void RouterParameter::SetUseIndexedHeap(bool useIndexedHeap)
+  {
+    this->useIndexedHeap=useIndexedHeap;
+  }
+
+  /**
+   * If set to true (the default) the route calculation uses the contraction
+   * hierarchy generated by the import, if it is available for the vehicle
+   * and was generated for the routing profile used. Else the routing graph
+   * is searched using A*.
+   */
+  void RouterParameter::SetUseContractionHierarchy(bool useContractionHierarchy)
+  {
+    this->useContractionHierarchy=useContractionHierarchy;
+  }
+
+  /**
+   * If set to true, the routing service loads the complete routing graph
+   * of its vehicle into memory on Open() (see RoutingGraph) and searches it
+   * instead of reading route nodes from the data file for each route.
+   * This trades memory for speed and is useful if one routing service
+   * instance answers many queries. Default is false.
+   */
+  void RouterParameter::SetUseInMemoryGraph(bool useInMemoryGraph)
+  {
+    this->useInMemoryGraph=useInMemoryGraph;
+  }
+
+  /**
+   * Set the number of threads used by RoutingService::CalculateRouteMatrix().
+   * The searches for the different sources are distributed over the
+   * threads. Default is 1, values smaller than 1 are treated as 1.
+   */
+  void RouterParameter::SetMatrixThreadCount(size_t matrixThreadCount)
+  {
+    this->matrixThreadCount=std::max((size_t)1,matrixThreadCount);
+  }
+
   bool RouterParameter::IsDebugPerformance() const
   {
     return debugPerformance;
   }
 
+  bool RouterParameter::GetUseIndexedHeap() const
+  {
+    return useIndexedHeap;
+  }
+
+  bool RouterParameter::GetUseContractionHierarchy() const
+  {
+    return useContractionHierarchy;
+  }
+
+  bool RouterParameter::GetUseInMemoryGraph() const
+  {
+    return useInMemoryGraph;
+  }
+
+  size_t RouterParameter::GetMatrixThreadCount() const
+  {
+    return matrixThreadCount;
+  }
+
   const char* const RoutingService::FILENAME_INTERSECTIONS_DAT = "intersections.dat";
   const char* const RoutingService::FILENAME_INTERSECTIONS_IDX = "intersections.idx";
 
@@ -60,6 +138,11 @@ namespace osmscout {
 
   const char* const RoutingService::FILENAME_CAR_DAT           = "routecar.dat";
   const char* const RoutingService::FILENAME_CAR_IDX           = "routecar.idx";
+  const char* const RoutingService::FILENAME_CAR_CH_DAT        = "routecarch.dat";
+
+  const char* const RoutingService::FILENAME_FOOT_SEGMENTS_IDX    = "routefootseg.idx";
+  const char* const RoutingService::FILENAME_BICYCLE_SEGMENTS_IDX = "routebicycleseg.idx";
+  const char* const RoutingService::FILENAME_CAR_SEGMENTS_IDX     = "routecarseg.idx";
 
   /**
    * Create a new instance of the routing service.
@@ -80,6 +163,10 @@ namespace osmscout {
      accessReader(database->GetTypeConfig()),
      isOpen(false),
      debugPerformance(parameter.IsDebugPerformance()),
+     useIndexedHeap(parameter.GetUseIndexedHeap()),
+     useContractionHierarchy(parameter.GetUseContractionHierarchy()),
+     useInMemoryGraph(parameter.GetUseInMemoryGraph()),
+     matrixThreadCount(parameter.GetMatrixThreadCount()),
      routeNodeDataFile(GetDataFilename(vehicle),
                        GetIndexFilename(vehicle),
                        0,
@@ -131,6 +218,22 @@ namespace osmscout {
     return ""; // make the compiler happy
   }
 
+  std::string RoutingService::GetSegmentIndexFilename(Vehicle vehicle)
+  {
+    switch (vehicle) {
+    case vehicleFoot:
+      return FILENAME_FOOT_SEGMENTS_IDX;
+    case vehicleBicycle:
+      return FILENAME_BICYCLE_SEGMENTS_IDX;
+    case vehicleCar:
+      return FILENAME_CAR_SEGMENTS_IDX;
+    default:
+      assert(false);
+    }
+
+    return ""; // make the compiler happy
+  }
+
   /**
    * Returns the vehicle this routing service instance was created for
    *
@@ -162,11 +265,86 @@ namespace osmscout {
       return false;
     }
 
+    if (useContractionHierarchy &&
+        vehicle==vehicleCar) {
+      std::string filename=AppendFileToDir(path,
+                                           FILENAME_CAR_CH_DAT);
+      FileOffset  fileSize;
+
+      // The contraction hierarchy is optional
+      if (GetFileSize(filename,
+                      fileSize)) {
+        ContractionHierarchyRef hierarchy=new ContractionHierarchy();
+
+        if (hierarchy->Load(filename)) {
+          contractionHierarchy=hierarchy;
+        }
+        else {
+          std::cerr << "Cannot load '" << FILENAME_CAR_CH_DAT << "', using A* only!" << std::endl;
+        }
+      }
+    }
+
+    std::string segmentIndexFilename=AppendFileToDir(path,
+                                                     GetSegmentIndexFilename(vehicle));
+    FileOffset  segmentIndexFileSize;
+
+    // The index of routable segments is optional
+    if (GetFileSize(segmentIndexFilename,
+                    segmentIndexFileSize)) {
+      RouteSegmentIndexRef index=new RouteSegmentIndex();
+
+      if (index->Load(segmentIndexFilename)) {
+        segmentIndex=index;
+      }
+      else {
+        std::cerr << "Cannot load '" << GetSegmentIndexFilename(vehicle) << "', searching for routable nodes without index!" << std::endl;
+      }
+    }
+
+    if (useInMemoryGraph &&
+        !LoadRoutingGraph()) {
+      routeNodeDataFile.Close();
+      contractionHierarchy=NULL;
+      segmentIndex=NULL;
+      return false;
+    }
+
     isOpen=true;
 
     return true;
   }
 
+  /**
+   * Load the routing graph of the vehicle into memory
+   */
+  bool RoutingService::LoadRoutingGraph()
+  {
+    StopClock       clock;
+    RoutingGraphRef graph=new RoutingGraph();
+
+    if (!graph->Load(AppendFileToDir(path,
+                                     GetDataFilename(vehicle)))) {
+      std::cerr << "Cannot load routing graph into memory!" << std::endl;
+      return false;
+    }
+
+    clock.Stop();
+
+    routingGraph=graph;
+
+    if (debugPerformance) {
+      std::cout << "Routing graph '" << GetDataFilename(vehicle) << "': ";
+      std::cout << routingGraph->GetNodeCount() << " nodes, ";
+      std::cout << routingGraph->GetEdgeCount() << " edges, ";
+      std::cout << routingGraph->GetObjectCount() << " objects, ";
+      std::cout << ByteSizeToString(routingGraph->GetMemoryUsage()) << ", ";
+      std::cout << "loaded in " << clock << std::endl;
+    }
+
+    return true;
+  }
+
   /**
    * Returns true, if the routing service has been successfully opened, else false.
    *
@@ -185,6 +363,14 @@ namespace osmscout {
   {
     routeNodeDataFile.Close();
 
+    contractionHierarchy=NULL;
+    routingGraph=NULL;
+
+    if (segmentIndex.Valid()) {
+      segmentIndex->Close();
+      segmentIndex=NULL;
+    }
+
     isOpen=false;
   }
 
@@ -330,6 +516,96 @@ namespace osmscout {
     std::reverse(nodes.begin(),nodes.end());
   }
 
+  void RoutingService::ResolveHNodeChainToList(size_t end,
+                                               const std::vector<HNode>& hnodes,
+                                               std::list<RNodeRef>& nodes)
+  {
+    size_t current=end;
+
+    while (current!=noPrevIndex) {
+      const HNode& hnode=hnodes[current];
+      RNodeRef     node=new RNode(hnode.nodeOffset,
+                                  hnode.object,
+                                  hnode.prev);
+
+      node->currentCost=hnode.currentCost;
+      node->estimateCost=hnode.estimateCost;
+      node->overallCost=hnode.overallCost;
+      node->access=hnode.access;
+
+      nodes.push_front(node);
+
+      current=hnode.prevIndex;
+    }
+  }
+
+  /**
+   * Build the list of route nodes from the start to the target from the
+   * forward search node chain ending at the meeting node and the backward
+   * search node chain starting at the meeting node. Shortcuts are unpacked
+   * into the original paths of the routing graph.
+   */
+  void RoutingService::ResolveCNodeChainsToList(size_t forwardEnd,
+                                                const std::vector<CNode>& forwardNodes,
+                                                size_t backwardEnd,
+                                                const std::vector<CNode>& backwardNodes,
+                                                std::list<RNodeRef>& nodes)
+  {
+    std::vector<uint32_t> edges;
+    std::vector<uint32_t> originalEdges;
+    size_t                current=forwardEnd;
+
+    while (forwardNodes[current].prevIndex!=noPrevIndex) {
+      edges.push_back(forwardNodes[current].edge);
+      current=forwardNodes[current].prevIndex;
+    }
+
+    const CNode& start=forwardNodes[current];
+
+    std::reverse(edges.begin(),edges.end());
+
+    current=backwardEnd;
+
+    while (backwardNodes[current].prevIndex!=noPrevIndex) {
+      edges.push_back(backwardNodes[current].edge);
+      current=backwardNodes[current].prevIndex;
+    }
+
+    for (std::vector<uint32_t>::const_iterator edge=edges.begin();
+         edge!=edges.end();
+         ++edge) {
+      contractionHierarchy->UnpackEdge(*edge,
+                                       originalEdges);
+    }
+
+    RNodeRef node=new RNode(contractionHierarchy->GetNode(start.node).offset,
+                            start.object);
+
+    node->currentCost=start.costs/3600000.0;
+    node->overallCost=node->currentCost;
+
+    nodes.push_back(node);
+
+    double costs=start.costs;
+
+    for (std::vector<uint32_t>::const_iterator e=originalEdges.begin();
+         e!=originalEdges.end();
+         ++e) {
+      const ContractionHierarchy::Edge& edge=contractionHierarchy->GetEdge(*e);
+
+      costs+=edge.costs;
+
+      node=new RNode(contractionHierarchy->GetNode(edge.target).offset,
+                     edge.object,
+                     contractionHierarchy->GetNode(edge.source).offset);
+
+      node->currentCost=costs/3600000.0;
+      node->overallCost=node->currentCost;
+
+      nodes.push_back(node);
+    }
+  }
+
   void RoutingService::AddNodes(RouteData& route,
                                 Id startNodeId,
                                 size_t startNodeIndex,
@@ -968,6 +1244,250 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Search the contraction hierarchy using a bidirectional search, that only
+   * follows edges to nodes of higher rank (and between core nodes).
+   * Forward search and backward search are alternated, the search stops as
+   * soon as the smallest costs in both open lists are not smaller than the
+   * costs of the best route found.
+   *
+   * Turn restrictions are evaluated at core nodes (the only nodes having
+   * turn restrictions) using the object of the path used to reach a node
+   * in the forward search and the path taken at a node in the backward
+   * search.
+   *
+   * @return
+   *    False, if there was an error, else true. If no route was found, nodes
+   *    is empty.
+   */
+  bool RoutingService::SearchRouteContractionHierarchy(const RNodeRef& startForwardNode,
+                                                       const RNodeRef& startBackwardNode,
+                                                       const RouteNodeRef& targetForwardRouteNode,
+                                                       const RouteNodeRef& targetBackwardRouteNode,
+                                                       std::list<RNodeRef>& nodes)
+  {
+    const ContractionHierarchy& hierarchy=*contractionHierarchy;
+
+    std::vector<CNode> cnodes[2];
+    // Map contraction hierarchy nodes to their index in cnodes
+    CNodeMap           nodeMaps[2];
+    CHOpenList         openLists[2]={CHOpenList(CNodeCostCompare(&cnodes[0])),
+                                     CHOpenList(CNodeCostCompare(&cnodes[1]))};
+
+    RNodeRef           startNodes[2]={startForwardNode,startBackwardNode};
+    RouteNodeRef       targetNodes[2]={targetForwardRouteNode,targetBackwardRouteNode};
+
+    for (size_t s=0; s<2; s++) {
+      if (startNodes[s].Invalid()) {
+        continue;
+      }
+
+      uint32_t node=hierarchy.GetNodeIndex(startNodes[s]->nodeOffset);
+
+      if (node==ContractionHierarchy::noNode) {
+        continue;
+      }
+
+      double                   costs=startNodes[s]->currentCost*3600000.0;
+      CNodeMap::const_iterator entry=nodeMaps[0].find(node);
+
+      if (entry!=nodeMaps[0].end()) {
+        if (cnodes[0][entry->second].costs>costs) {
+          cnodes[0][entry->second].costs=costs;
+          cnodes[0][entry->second].object=startNodes[s]->object;
+          openLists[0].Update(entry->second);
+        }
+
+        continue;
+      }
+
+      CNode cnode;
+
+      cnode.node=node;
+      cnode.edge=ContractionHierarchy::noEdge;
+      cnode.prevIndex=noPrevIndex;
+      cnode.object=startNodes[s]->object;
+      cnode.pathIndex=noPathIndex;
+      cnode.costs=costs;
+      cnode.closed=false;
+
+      nodeMaps[0][node]=cnodes[0].size();
+      cnodes[0].push_back(cnode);
+      openLists[0].Push(cnodes[0].size()-1);
+    }
+
+    for (size_t t=0; t<2; t++) {
+      if (targetNodes[t].Invalid()) {
+        continue;
+      }
+
+      uint32_t node=hierarchy.GetNodeIndex(targetNodes[t]->GetFileOffset());
+
+      if (node==ContractionHierarchy::noNode ||
+          nodeMaps[1].find(node)!=nodeMaps[1].end()) {
+        continue;
+      }
+
+      CNode cnode;
+
+      cnode.node=node;
+      cnode.edge=ContractionHierarchy::noEdge;
+      cnode.prevIndex=noPrevIndex;
+      cnode.pathIndex=noPathIndex;
+      cnode.costs=0.0;
+      cnode.closed=false;
+
+      nodeMaps[1][node]=cnodes[1].size();
+      cnodes[1].push_back(cnode);
+      openLists[1].Push(cnodes[1].size()-1);
+    }
+
+    double bestCosts=std::numeric_limits<double>::max();
+    size_t bestForward=noPrevIndex;
+    size_t bestBackward=noPrevIndex;
+
+    while (!openLists[0].empty() ||
+           !openLists[1].empty()) {
+      //
+      // Take the entry with the lowest cost of both open lists
+      //
+
+      size_t direction;
+
+      if (openLists[1].empty()) {
+        direction=0;
+      }
+      else if (openLists[0].empty()) {
+        direction=1;
+      }
+      else {
+        direction=cnodes[0][openLists[0].Top()].costs<=cnodes[1][openLists[1].Top()].costs ? 0 : 1;
+      }
+
+      size_t current=openLists[direction].Top();
+
+      if (cnodes[direction][current].costs>=bestCosts) {
+        break;
+      }
+
+      openLists[direction].Pop();
+
+      cnodes[direction][current].closed=true;
+
+      // cnodes may get reallocated while adding new nodes
+      CNode currentNode=cnodes[direction][current];
+
+      statistics.nodesLoaded++;
+
+      //
+      // Check, if we meet the search of the other direction
+      //
+
+      CNodeMap::const_iterator meeting=nodeMaps[1-direction].find(currentNode.node);
+
+      if (meeting!=nodeMaps[1-direction].end()) {
+        const CNode& forwardNode=direction==0 ? currentNode : cnodes[0][meeting->second];
+        const CNode& backwardNode=direction==0 ? cnodes[1][meeting->second] : currentNode;
+
+        if (forwardNode.costs+backwardNode.costs<bestCosts &&
+            (backwardNode.pathIndex==noPathIndex ||
+             !hierarchy.HasExcludes(currentNode.node) ||
+             !hierarchy.IsExcluded(currentNode.node,
+                                   forwardNode.object,
+                                   backwardNode.pathIndex))) {
+          bestCosts=forwardNode.costs+backwardNode.costs;
+          bestForward=direction==0 ? current : meeting->second;
+          bestBackward=direction==0 ? meeting->second : current;
+        }
+      }
+
+      //
+      // Follow the edges leading upwards
+      //
+
+      uint32_t begin=direction==0 ? hierarchy.GetForwardEdgesBegin(currentNode.node) : hierarchy.GetBackwardEdgesBegin(currentNode.node);
+      uint32_t end=direction==0 ? hierarchy.GetForwardEdgesEnd(currentNode.node) : hierarchy.GetBackwardEdgesEnd(currentNode.node);
+
+      for (uint32_t i=begin; i<end; i++) {
+        uint32_t                          edgeIndex=direction==0 ? hierarchy.GetForwardEdge(i) : hierarchy.GetBackwardEdge(i);
+        const ContractionHierarchy::Edge& edge=hierarchy.GetEdge(edgeIndex);
+        uint32_t                          next=direction==0 ? edge.target : edge.source;
+
+        if (hierarchy.HasExcludes(currentNode.node)) {
+          bool excluded;
+
+          if (direction==0) {
+            excluded=hierarchy.IsExcluded(currentNode.node,
+                                          currentNode.object,
+                                          edge.pathIndex);
+          }
+          else {
+            excluded=currentNode.pathIndex!=noPathIndex &&
+                     hierarchy.IsExcluded(currentNode.node,
+                                          edge.object,
+                                          currentNode.pathIndex);
+          }
+
+          if (excluded) {
+            statistics.nodesIgnored++;
+            continue;
+          }
+        }
+
+        double                   costs=currentNode.costs+edge.costs;
+        CNodeMap::const_iterator entry=nodeMaps[direction].find(next);
+
+        if (entry!=nodeMaps[direction].end()) {
+          CNode& cnode=cnodes[direction][entry->second];
+
+          if (cnode.closed ||
+              cnode.costs<=costs) {
+            continue;
+          }
+
+          cnode.edge=edgeIndex;
+          cnode.prevIndex=current;
+          cnode.object=edge.object;
+          cnode.pathIndex=edge.pathIndex;
+          cnode.costs=costs;
+
+          openLists[direction].Update(entry->second);
+        }
+        else {
+          CNode cnode;
+
+          cnode.node=next;
+          cnode.edge=edgeIndex;
+          cnode.prevIndex=current;
+          cnode.object=edge.object;
+          cnode.pathIndex=edge.pathIndex;
+          cnode.costs=costs;
+          cnode.closed=false;
+
+          nodeMaps[direction][next]=cnodes[direction].size();
+          cnodes[direction].push_back(cnode);
+          openLists[direction].Push(cnodes[direction].size()-1);
+        }
+      }
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openLists[0].size()+openLists[1].size());
+    }
+
+    statistics.maxCloseMap=statistics.nodesLoaded;
+
+    if (bestForward==noPrevIndex) {
+      return true;
+    }
+
+    ResolveCNodeChainsToList(bestForward,
+                             cnodes[0],
+                             bestBackward,
+                             cnodes[1],
+                             nodes);
+
+    return true;
+  }
+
   /**
    * Calculate a route
    *
@@ -1026,83 +1546,36 @@ namespace osmscout {
   }
 
   /**
-   * Calculate a route
+   * Search the routing graph using a std::set as open list and individually
+   * allocated nodes.
    *
-   * @param profile
-   *    Profile to use
-   * @param startObject
-   *    Start object
-   * @param startNodeIndex
-   *    Index of the node within the start object used as starting point
-   * @param targetObject
-   *    Target object
-   * @param targetNodeIndex
-   *    Index of the node within the target object used as target point
-   * @param route
-   *    The route object holding the resulting route on success
    * @return
-   *    True, if the engine was able to find a route, else false
+   *    False, if there was an error, else true. If no route was found, nodes
+   *    is empty.
    */
-  bool RoutingService::CalculateRoute(const RoutingProfile& profile,
-                                      const ObjectFileRef& startObject,
-                                      size_t startNodeIndex,
-                                      const ObjectFileRef& targetObject,
-                                      size_t targetNodeIndex,
-                                      RouteData& route)
+  bool RoutingService::SearchRouteOpenList(const RoutingProfile& profile,
+                                           double targetLon,
+                                           double targetLat,
+                                           const RNodeRef& startForwardNode,
+                                           const RNodeRef& startBackwardNode,
+                                           const RouteNodeRef& targetForwardRouteNode,
+                                           const RouteNodeRef& targetBackwardRouteNode,
+                                           std::list<RNodeRef>& nodes)
   {
-    RouteNodeRef             startForwardRouteNode;
-    RouteNodeRef             startBackwardRouteNode;
-    RNodeRef                 startForwardNode;
-    RNodeRef                 startBackwardNode;
-
-    double                   targetLon=0.0L,targetLat=0.0L;
-
-    RouteNodeRef             targetForwardRouteNode;
-    RouteNodeRef             targetBackwardRouteNode;
-
     // Sorted list (smallest cost first) of ways to check (we are using a std::set)
     OpenList                 openList;
     // Map routing nodes by id
     OpenMap                  openMap;
     CloseMap                 closeMap;
 
-    size_t                   nodesLoadedCount=0;
-    size_t                   nodesIgnoredCount=0;
-    size_t                   maxOpenList=0;
-    size_t                   maxCloseMap=0;
-
-    route.Clear();
-
 #if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
     openMap.reserve(10000);
     closeMap.reserve(300000);
 #endif
 
-    if (!GetTargetNodes(profile,
-                        targetObject,
-                        targetNodeIndex,
-                        targetLon,
-                        targetLat,
-                        targetForwardRouteNode,
-                        targetBackwardRouteNode)) {
-      return false;
-    }
-
-    if (!GetStartNodes(profile,
-                       startObject,
-                       startNodeIndex,
-                       targetLon,
-                       targetLat,
-                       startForwardRouteNode,
-                       startBackwardRouteNode,
-                       startForwardNode,
-                       startBackwardNode)) {
-      return false;
-    }
-
-    if (startForwardNode.Valid()) {
-      std::pair<OpenListRef,bool> result=openList.insert(startForwardNode);
-      openMap[startForwardNode->nodeOffset]=result.first;
+    if (startForwardNode.Valid()) {
+      std::pair<OpenListRef,bool> result=openList.insert(startForwardNode);
+      openMap[startForwardNode->nodeOffset]=result.first;
     }
 
     if (startBackwardNode.Valid()) {
@@ -1110,7 +1583,6 @@ namespace osmscout {
       openMap[startBackwardNode->nodeOffset]=result.first;
     }
 
-    StopClock    clock;
     RNodeRef     current;
     RouteNodeRef currentRouteNode;
 
@@ -1130,7 +1602,7 @@ namespace osmscout {
         return false;
       }
 
-      nodesLoadedCount++;
+      statistics.nodesLoaded++;
 
       // Get potential follower in the current way
 
@@ -1151,221 +1623,1362 @@ namespace osmscout {
           std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
           std::cout << " => back to the last node visited" << std::endl;
 #endif
-          nodesIgnoredCount++;
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        if (!current->access &&
+            path->HasAccess()) {
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Skipping route";
+          std::cout << " to " << path->offset;
+          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
+          std::cout << " => moving from non-accessible way back to accessible way" << std::endl;
+#endif
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        if (!profile.CanUse(*currentRouteNode,i)) {
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Skipping route";
+          std::cout << " to " << path->offset;
+          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
+          std::cout << " => Cannot be used"<< std::endl;
+#endif
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        if (closeMap.find(path->offset)!=closeMap.end()) {
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Skipping route";
+          std::cout << " to " << path->offset;
+          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
+          std::cout << " => already calculated" << std::endl;
+#endif
+          continue;
+        }
+
+        if (!currentRouteNode->excludes.empty()) {
+          bool canTurnedInto=true;
+          for (size_t e=0; e<currentRouteNode->excludes.size(); e++) {
+            if (currentRouteNode->excludes[e].source==current->object &&
+                currentRouteNode->excludes[e].targetIndex==i) {
+#if defined(DEBUG_ROUTING)
+              std::cout << "  Skipping route";
+              std::cout << " to " << path->offset;
+              std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
+              std::cout << " => turn not allowed" << std::endl;
+#endif
+              canTurnedInto=false;
+              break;
+            }
+          }
+
+          if (!canTurnedInto) {
+            statistics.nodesIgnored++;
+            continue;
+          }
+        }
+
+        double currentCost=current->currentCost+
+                           profile.GetCosts(*currentRouteNode,i);
+
+        OpenMap::iterator openEntry=openMap.find(path->offset);
+
+        // Check, if we already have a cheaper path to the new node. If yes, do not put the new path
+        // into the open list
+        if (openEntry!=openMap.end() &&
+            (*openEntry->second)->currentCost<=currentCost) {
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Skipping route";
+          std::cout << " to " << path->offset;
+          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
+          std::cout << "  => cheaper route exists " << currentCost << "<=>" << (*openEntry->second)->currentCost << std::endl;
+#endif
+          continue;
+        }
+
+        double distanceToTarget=GetSphericalDistance(path->lon,
+                                                     path->lat,
+                                                     targetLon,
+                                                     targetLat);
+        // Estimate costs for the rest of the distance to the target
+        double estimateCost=profile.GetCosts(distanceToTarget);
+        double overallCost=currentCost+estimateCost;
+
+        // If we already have the node in the open list, but the new path is cheaper,
+        // update the existing entry
+        if (openEntry!=openMap.end()) {
+          RNodeRef node=*openEntry->second;
+
+          node->prev=current->nodeOffset;
+          node->object=currentRouteNode->objects[path->objectIndex];
+
+          node->currentCost=currentCost;
+          node->estimateCost=estimateCost;
+          node->overallCost=overallCost;
+          node->access=currentRouteNode->paths[i].HasAccess();
+
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Updating route " << current->nodeOffset << " via " << node->object.GetTypeName() << " " << node->object.GetFileOffset() << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
+#endif
+
+          openList.erase(openEntry->second);
+
+          std::pair<OpenListRef,bool> result=openList.insert(node);
+          openEntry->second=result.first;
+        }
+        else {
+          RNodeRef node=new RNode(path->offset,
+                                  currentRouteNode->objects[path->objectIndex],
+                                  current->nodeOffset);
+
+          node->currentCost=currentCost;
+          node->estimateCost=estimateCost;
+          node->overallCost=overallCost;
+          node->access=path->HasAccess();
+
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Inserting route to " << path->offset;
+          std::cout <<  " (" << node->object.GetTypeName() << " " << node->object.GetFileOffset() << ")";
+          std::cout << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
+#endif
+
+          std::pair<OpenListRef,bool> result=openList.insert(node);
+          openMap[node->nodeOffset]=result.first;
+        }
+      }
+
+      //
+      // Added current node to close map
+      //
+
+      closeMap[current->nodeOffset]=current;
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openMap.size());
+      statistics.maxCloseMap=std::max(statistics.maxCloseMap,closeMap.size());
+
+#if defined(DEBUG_ROUTING)
+      if (openList.empty()) {
+        std::cout << "No more alternatives, stopping" << std::endl;
+      }
+
+      if ((targetForwardRouteNode.Valid() && current->nodeOffset==targetForwardRouteNode->fileOffset)) {
+        std::cout << "Reached target: " << current->nodeOffset << " == " << targetForwardRouteNode->fileOffset << " (forward)" << std::endl;
+      }
+
+      if (targetBackwardRouteNode.Valid() && current->nodeOffset==targetBackwardRouteNode->fileOffset) {
+        std::cout << "Reached target: " << current->nodeOffset << " == " << targetBackwardRouteNode->fileOffset << " (backward)" << std::endl;
+      }
+#endif
+    } while (!openList.empty() &&
+             (targetForwardRouteNode.Invalid() || current->nodeOffset!=targetForwardRouteNode->fileOffset) &&
+             (targetBackwardRouteNode.Invalid() || current->nodeOffset!=targetBackwardRouteNode->fileOffset));
+
+    if (!((targetForwardRouteNode.Valid() && current->nodeOffset==targetForwardRouteNode->fileOffset) ||
+          (targetBackwardRouteNode.Valid() && current->nodeOffset==targetBackwardRouteNode->fileOffset))) {
+      return true;
+    }
+
+    ResolveRNodeChainToList(current,
+                            closeMap,
+                            nodes);
+
+    return true;
+  }
+
+  /**
+   * Search the routing graph using an indexed d-ary heap as open list. The
+   * search state of all visited route nodes is held in one vector, nodes
+   * reference each other by index. The result is the same as for
+   * SearchRouteOpenList().
+   *
+   * @return
+   *    False, if there was an error, else true. If no route was found, nodes
+   *    is empty.
+   */
+  bool RoutingService::SearchRouteIndexedHeap(const RoutingProfile& profile,
+                                              double targetLon,
+                                              double targetLat,
+                                              const RNodeRef& startForwardNode,
+                                              const RNodeRef& startBackwardNode,
+                                              const RouteNodeRef& targetForwardRouteNode,
+                                              const RouteNodeRef& targetBackwardRouteNode,
+                                              std::list<RNodeRef>& nodes)
+  {
+    std::vector<HNode> hnodes;
+    // Map routing nodes by file offset to their index in hnodes
+    HNodeMap           nodeMap;
+    // Open nodes by cost (smallest cost first)
+    HeapOpenList       openList((HNodeCostCompare(&hnodes)));
+
+    hnodes.reserve(10000);
+    openList.Reserve(10000);
+
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    nodeMap.reserve(10000);
+#endif
+
+    RNodeRef startNodes[2]={startForwardNode,startBackwardNode};
+
+    for (size_t s=0; s<2; s++) {
+      if (startNodes[s].Invalid()) {
+        continue;
+      }
+
+      HNodeMap::const_iterator entry=nodeMap.find(startNodes[s]->nodeOffset);
+
+      if (entry!=nodeMap.end()) {
+        if (hnodes[entry->second].overallCost<=startNodes[s]->overallCost) {
+          continue;
+        }
+      }
+
+      HNode node;
+
+      node.nodeOffset=startNodes[s]->nodeOffset;
+      node.prev=startNodes[s]->prev;
+      node.prevIndex=noPrevIndex;
+      node.object=startNodes[s]->object;
+      node.currentCost=startNodes[s]->currentCost;
+      node.estimateCost=startNodes[s]->estimateCost;
+      node.overallCost=startNodes[s]->overallCost;
+      node.access=startNodes[s]->access;
+      node.closed=false;
+
+      if (entry!=nodeMap.end()) {
+        hnodes[entry->second]=node;
+        openList.Update(entry->second);
+      }
+      else {
+        nodeMap[node.nodeOffset]=hnodes.size();
+        hnodes.push_back(node);
+        openList.Push(hnodes.size()-1);
+      }
+    }
+
+    size_t       current;
+    RouteNodeRef currentRouteNode;
+
+    do {
+      //
+      // Take entry from open list with lowest cost and close it
+      //
+
+      current=openList.Top();
+      openList.Pop();
+
+      hnodes[current].closed=true;
+
+      // hnodes may get reallocated while adding new nodes
+      FileOffset    currentOffset=hnodes[current].nodeOffset;
+      FileOffset    currentPrev=hnodes[current].prev;
+      ObjectFileRef currentObject=hnodes[current].object;
+      double        currentCurrentCost=hnodes[current].currentCost;
+      bool          currentAccess=hnodes[current].access;
+
+      if (!routeNodeDataFile.GetByOffset(currentOffset,
+                                         currentRouteNode)) {
+        std::cerr << "Cannot load route node with id " << currentOffset << std::endl;
+        return false;
+      }
+
+      statistics.nodesLoaded++;
+
+      size_t i=0;
+      for (std::vector<osmscout::RouteNode::Path>::const_iterator path=currentRouteNode->paths.begin();
+           path!=currentRouteNode->paths.end();
+           ++path,
+           ++i) {
+        if (path->offset==currentPrev) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        if (!currentAccess &&
+            path->HasAccess()) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        if (!profile.CanUse(*currentRouteNode,i)) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        HNodeMap::const_iterator entry=nodeMap.find(path->offset);
+
+        if (entry!=nodeMap.end() &&
+            hnodes[entry->second].closed) {
+          continue;
+        }
+
+        if (!currentRouteNode->excludes.empty()) {
+          bool canTurnedInto=true;
+          for (size_t e=0; e<currentRouteNode->excludes.size(); e++) {
+            if (currentRouteNode->excludes[e].source==currentObject &&
+                currentRouteNode->excludes[e].targetIndex==i) {
+              canTurnedInto=false;
+              break;
+            }
+          }
+
+          if (!canTurnedInto) {
+            statistics.nodesIgnored++;
+            continue;
+          }
+        }
+
+        double currentCost=currentCurrentCost+
+                           profile.GetCosts(*currentRouteNode,i);
+
+        // Check, if we already have a cheaper path to the new node. If yes, do not put the new path
+        // into the open list
+        if (entry!=nodeMap.end() &&
+            hnodes[entry->second].currentCost<=currentCost) {
           continue;
         }
 
-        if (!current->access &&
-            path->HasAccess()) {
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << " => moving from non-accessible way back to accessible way" << std::endl;
-#endif
-          nodesIgnoredCount++;
+        double distanceToTarget=GetSphericalDistance(path->lon,
+                                                     path->lat,
+                                                     targetLon,
+                                                     targetLat);
+        // Estimate costs for the rest of the distance to the target
+        double estimateCost=profile.GetCosts(distanceToTarget);
+        double overallCost=currentCost+estimateCost;
+
+        // If we already have the node in the open list, but the new path is cheaper,
+        // update the existing entry, else add a new node
+        if (entry!=nodeMap.end()) {
+          HNode& node=hnodes[entry->second];
+
+          node.prev=currentOffset;
+          node.prevIndex=current;
+          node.object=currentRouteNode->objects[path->objectIndex];
+
+          node.currentCost=currentCost;
+          node.estimateCost=estimateCost;
+          node.overallCost=overallCost;
+          node.access=path->HasAccess();
+
+          openList.Update(entry->second);
+        }
+        else {
+          HNode node;
+
+          node.nodeOffset=path->offset;
+          node.prev=currentOffset;
+          node.prevIndex=current;
+          node.object=currentRouteNode->objects[path->objectIndex];
+
+          node.currentCost=currentCost;
+          node.estimateCost=estimateCost;
+          node.overallCost=overallCost;
+          node.access=path->HasAccess();
+          node.closed=false;
+
+          nodeMap[node.nodeOffset]=hnodes.size();
+          hnodes.push_back(node);
+          openList.Push(hnodes.size()-1);
+        }
+      }
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openList.size());
+      statistics.maxCloseMap=statistics.nodesLoaded;
+    } while (!openList.empty() &&
+             (targetForwardRouteNode.Invalid() || hnodes[current].nodeOffset!=targetForwardRouteNode->fileOffset) &&
+             (targetBackwardRouteNode.Invalid() || hnodes[current].nodeOffset!=targetBackwardRouteNode->fileOffset));
+
+    if (!((targetForwardRouteNode.Valid() && hnodes[current].nodeOffset==targetForwardRouteNode->fileOffset) ||
+          (targetBackwardRouteNode.Valid() && hnodes[current].nodeOffset==targetBackwardRouteNode->fileOffset))) {
+      return true;
+    }
+
+    ResolveHNodeChainToList(current,
+                            hnodes,
+                            nodes);
+
+    return true;
+  }
+
+  /**
+   * A* search like SearchRouteIndexedHeap(), but on the routing graph held in
+   * memory. Search nodes are identified by their index in the graph instead
+   * of their file offset and route nodes never have to be read or decoded.
+   */
+  bool RoutingService::SearchRouteInMemoryGraph(const RoutingProfile& profile,
+                                                double targetLon,
+                                                double targetLat,
+                                                const RNodeRef& startForwardNode,
+                                                const RNodeRef& startBackwardNode,
+                                                const RouteNodeRef& targetForwardRouteNode,
+                                                const RouteNodeRef& targetBackwardRouteNode,
+                                                std::list<RNodeRef>& nodes)
+  {
+    const RoutingGraph&   graph=*routingGraph;
+
+    // All search nodes
+    std::vector<HNode>    hnodes;
+    // The graph node index of each search node
+    std::vector<uint32_t> graphNodes;
+    // Map graph node index to search node index
+    HNodeIndexMap         nodeMap;
+    // Open nodes by cost (smallest cost first)
+    HeapOpenList          openList((HNodeCostCompare(&hnodes)));
+
+    hnodes.reserve(10000);
+    graphNodes.reserve(10000);
+    openList.Reserve(10000);
+
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    nodeMap.reserve(10000);
+#endif
+
+    RNodeRef startNodes[2]={startForwardNode,startBackwardNode};
+
+    for (size_t s=0; s<2; s++) {
+      if (startNodes[s].Invalid()) {
+        continue;
+      }
+
+      uint32_t graphNode=graph.GetNodeIndex(startNodes[s]->nodeOffset);
+
+      if (graphNode==RoutingGraph::noNode) {
+        continue;
+      }
+
+      HNodeIndexMap::const_iterator entry=nodeMap.find(graphNode);
+
+      if (entry!=nodeMap.end()) {
+        if (hnodes[entry->second].overallCost<=startNodes[s]->overallCost) {
+          continue;
+        }
+      }
+
+      HNode node;
+
+      node.nodeOffset=startNodes[s]->nodeOffset;
+      node.prev=startNodes[s]->prev;
+      node.prevIndex=noPrevIndex;
+      node.object=startNodes[s]->object;
+      node.currentCost=startNodes[s]->currentCost;
+      node.estimateCost=startNodes[s]->estimateCost;
+      node.overallCost=startNodes[s]->overallCost;
+      node.access=startNodes[s]->access;
+      node.closed=false;
+
+      if (entry!=nodeMap.end()) {
+        hnodes[entry->second]=node;
+        openList.Update(entry->second);
+      }
+      else {
+        nodeMap[graphNode]=hnodes.size();
+        hnodes.push_back(node);
+        graphNodes.push_back(graphNode);
+        openList.Push(hnodes.size()-1);
+      }
+    }
+
+    if (openList.empty()) {
+      return true;
+    }
+
+    size_t          current;
+    RouteNode::Path path;
+
+    do {
+      //
+      // Take entry from open list with lowest cost and close it
+      //
+
+      current=openList.Top();
+      openList.Pop();
+
+      hnodes[current].closed=true;
+
+      // hnodes may get reallocated while adding new nodes
+      uint32_t      currentNode=graphNodes[current];
+      FileOffset    currentOffset=hnodes[current].nodeOffset;
+      FileOffset    currentPrev=hnodes[current].prev;
+      ObjectFileRef currentObject=hnodes[current].object;
+      double        currentCurrentCost=hnodes[current].currentCost;
+      bool          currentAccess=hnodes[current].access;
+      bool          hasExcludes=graph.HasExcludes(currentNode);
+      uint32_t      edgesBegin=graph.GetEdgesBegin(currentNode);
+      uint32_t      edgesEnd=graph.GetEdgesEnd(currentNode);
+
+      statistics.nodesLoaded++;
+
+      for (uint32_t e=edgesBegin; e<edgesEnd; e++) {
+        const RoutingGraph::Edge& edge=graph.GetEdge(e);
+
+        graph.GetPath(currentNode,e,path);
+
+        if (path.offset==currentPrev) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        if (!currentAccess &&
+            path.HasAccess()) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        if (!profile.CanUse(path)) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        HNodeIndexMap::const_iterator entry=nodeMap.find(edge.target);
+
+        if (entry!=nodeMap.end() &&
+            hnodes[entry->second].closed) {
+          continue;
+        }
+
+        if (hasExcludes &&
+            graph.IsExcluded(currentNode,
+                             currentObject,
+                             e-edgesBegin)) {
+          statistics.nodesIgnored++;
+          continue;
+        }
+
+        double currentCost=currentCurrentCost+
+                           profile.GetCosts(path);
+
+        // Check, if we already have a cheaper path to the new node. If yes, do not put the new path
+        // into the open list
+        if (entry!=nodeMap.end() &&
+            hnodes[entry->second].currentCost<=currentCost) {
+          continue;
+        }
+
+        double distanceToTarget=GetSphericalDistance(path.lon,
+                                                     path.lat,
+                                                     targetLon,
+                                                     targetLat);
+        // Estimate costs for the rest of the distance to the target
+        double estimateCost=profile.GetCosts(distanceToTarget);
+        double overallCost=currentCost+estimateCost;
+
+        // If we already have the node in the open list, but the new path is cheaper,
+        // update the existing entry, else add a new node
+        if (entry!=nodeMap.end()) {
+          HNode& node=hnodes[entry->second];
+
+          node.prev=currentOffset;
+          node.prevIndex=current;
+          node.object=graph.GetObject(edge.object);
+
+          node.currentCost=currentCost;
+          node.estimateCost=estimateCost;
+          node.overallCost=overallCost;
+          node.access=path.HasAccess();
+
+          openList.Update(entry->second);
+        }
+        else {
+          HNode node;
+
+          node.nodeOffset=path.offset;
+          node.prev=currentOffset;
+          node.prevIndex=current;
+          node.object=graph.GetObject(edge.object);
+
+          node.currentCost=currentCost;
+          node.estimateCost=estimateCost;
+          node.overallCost=overallCost;
+          node.access=path.HasAccess();
+          node.closed=false;
+
+          nodeMap[edge.target]=hnodes.size();
+          hnodes.push_back(node);
+          graphNodes.push_back(edge.target);
+          openList.Push(hnodes.size()-1);
+        }
+      }
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openList.size());
+      statistics.maxCloseMap=statistics.nodesLoaded;
+    } while (!openList.empty() &&
+             (targetForwardRouteNode.Invalid() || hnodes[current].nodeOffset!=targetForwardRouteNode->fileOffset) &&
+             (targetBackwardRouteNode.Invalid() || hnodes[current].nodeOffset!=targetBackwardRouteNode->fileOffset));
+
+    if (!((targetForwardRouteNode.Valid() && hnodes[current].nodeOffset==targetForwardRouteNode->fileOffset) ||
+          (targetBackwardRouteNode.Valid() && hnodes[current].nodeOffset==targetBackwardRouteNode->fileOffset))) {
+      return true;
+    }
+
+    ResolveHNodeChainToList(current,
+                            hnodes,
+                            nodes);
+
+    return true;
+  }
+
+  /**
+   * Calculate a route
+   *
+   * @param profile
+   *    Profile to use
+   * @param startObject
+   *    Start object
+   * @param startNodeIndex
+   *    Index of the node within the start object used as starting point
+   * @param targetObject
+   *    Target object
+   * @param targetNodeIndex
+   *    Index of the node within the target object used as target point
+   * @param route
+   *    The route object holding the resulting route on success
+   * @return
+   *    True, if the engine was able to find a route, else false
+   */
+  bool RoutingService::CalculateRoute(const RoutingProfile& profile,
+                                      const ObjectFileRef& startObject,
+                                      size_t startNodeIndex,
+                                      const ObjectFileRef& targetObject,
+                                      size_t targetNodeIndex,
+                                      RouteData& route)
+  {
+    RouteNodeRef             startForwardRouteNode;
+    RouteNodeRef             startBackwardRouteNode;
+    RNodeRef                 startForwardNode;
+    RNodeRef                 startBackwardNode;
+
+    double                   targetLon=0.0L,targetLat=0.0L;
+
+    RouteNodeRef             targetForwardRouteNode;
+    RouteNodeRef             targetBackwardRouteNode;
+
+    route.Clear();
+
+    statistics=Statistics();
+
+    if (!GetTargetNodes(profile,
+                        targetObject,
+                        targetNodeIndex,
+                        targetLon,
+                        targetLat,
+                        targetForwardRouteNode,
+                        targetBackwardRouteNode)) {
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       startObject,
+                       startNodeIndex,
+                       targetLon,
+                       targetLat,
+                       startForwardRouteNode,
+                       startBackwardRouteNode,
+                       startForwardNode,
+                       startBackwardNode)) {
+      return false;
+    }
+
+    StopClock           clock;
+    std::list<RNodeRef> nodes;
+    bool                success=true;
+
+    if (contractionHierarchy.Valid() &&
+        contractionHierarchy->IsCompatible(profile)) {
+      success=SearchRouteContractionHierarchy(startForwardNode,
+                                              startBackwardNode,
+                                              targetForwardRouteNode,
+                                              targetBackwardRouteNode,
+                                              nodes);
+
+      statistics.contractionHierarchy=!nodes.empty();
+    }
+
+    if (!success) {
+      return false;
+    }
+
+    if (nodes.empty()) {
+      // There either is no usable contraction hierarchy or it did not deliver
+      // a route, search the routing graph using A*
+      statistics=Statistics();
+
+      if (routingGraph.Valid()) {
+        success=SearchRouteInMemoryGraph(profile,
+                                         targetLon,
+                                         targetLat,
+                                         startForwardNode,
+                                         startBackwardNode,
+                                         targetForwardRouteNode,
+                                         targetBackwardRouteNode,
+                                         nodes);
+
+        statistics.inMemoryGraph=true;
+      }
+      else if (useIndexedHeap) {
+        success=SearchRouteIndexedHeap(profile,
+                                       targetLon,
+                                       targetLat,
+                                       startForwardNode,
+                                       startBackwardNode,
+                                       targetForwardRouteNode,
+                                       targetBackwardRouteNode,
+                                       nodes);
+      }
+      else {
+        success=SearchRouteOpenList(profile,
+                                    targetLon,
+                                    targetLat,
+                                    startForwardNode,
+                                    startBackwardNode,
+                                    targetForwardRouteNode,
+                                    targetBackwardRouteNode,
+                                    nodes);
+      }
+    }
+
+    clock.Stop();
+
+    statistics.searchTime=clock.GetMilliseconds();
+
+    if (!success) {
+      return false;
+    }
+
+    if (debugPerformance) {
+      std::cout << "Search:              ";
+      if (statistics.contractionHierarchy) {
+        std::cout << "Contraction hierarchy" << std::endl;
+      }
+      else if (statistics.inMemoryGraph) {
+        std::cout << "A* (in-memory graph)" << std::endl;
+      }
+      else {
+        std::cout << "A*" << std::endl;
+      }
+      std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
+      std::cout << "[";
+      if (startBackwardRouteNode.Valid()) {
+        std::cout << startBackwardRouteNode->GetId() << " >* ";
+      }
+      std::cout << startNodeIndex;
+      if (startForwardRouteNode.Valid()) {
+        std::cout << " *> " << startForwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+      std::cout << "To:                  " << targetObject.GetTypeName() <<  " " << targetObject.GetFileOffset();
+      std::cout << "[";
+      if (targetForwardRouteNode.Valid()) {
+        std::cout << targetForwardRouteNode->GetId() << " >* ";
+      }
+      std::cout << targetNodeIndex;
+      if (targetBackwardRouteNode.Valid()) {
+        std::cout << " *> " << targetBackwardRouteNode->GetId();
+      }
+      std::cout << "]" << std::endl;
+
+      std::cout << "Time:                " << clock << std::endl;
+
+      std::cout << "Route nodes loaded:  " << statistics.nodesLoaded << std::endl;
+      std::cout << "Route nodes ignored: " << statistics.nodesIgnored << std::endl;
+      std::cout << "Max. OpenList size:  " << statistics.maxOpenList << std::endl;
+      std::cout << "Max. CloseMap size:  " << statistics.maxCloseMap << std::endl;
+    }
+
+    if (nodes.empty()) {
+      std::cout << "No route found!" << std::endl;
+      route.Clear();
+
+      return true;
+    }
+
+    if (!ResolveRNodesToRouteData(profile,
+                                  nodes,
+                                  startObject,
+                                  startNodeIndex,
+                                  targetObject,
+                                  targetNodeIndex,
+                                  route)) {
+      //std::cerr << "Cannot convert routing result to route data" << std::endl;
+      return false;
+    }
+
+    ResolveRouteDataJunctions(route);
+
+    return true;
+  }
+
+  /**
+   * Return the distance in km between the two given nodes of the way
+   * measured along the way
+   */
+  static double GetDistanceOnWay(const Way& way,
+                                 size_t from,
+                                 size_t to)
+  {
+    double distance=0.0;
+
+    if (from>to) {
+      std::swap(from,to);
+    }
+
+    for (size_t i=from+1; i<=to; i++) {
+      distance+=GetSphericalDistance(way.nodes[i-1].GetLon(),
+                                     way.nodes[i-1].GetLat(),
+                                     way.nodes[i].GetLon(),
+                                     way.nodes[i].GetLat());
+    }
+
+    return distance;
+  }
+
+  /**
+   * Resolve the route nodes of the routing graph a route matrix search
+   * starts at (if the position is a source) or ends at (if the position is
+   * a target). If the node of the position is not a route node, the closest
+   * route nodes before and after the node on the way are used, as far as
+   * the way can be used in the resulting direction.
+   *
+   * Positions on areas are not supported and result in no route nodes.
+   */
+  bool RoutingService::GetMatrixPosition(const RoutingProfile& profile,
+                                         const RouteMatrix::Position& position,
+                                         bool isSource,
+                                         MatrixPosition& matrixPosition)
+  {
+    const RoutingGraph& graph=*routingGraph;
+    WayDataFileRef      wayDataFile(database->GetWayDataFile());
+
+    matrixPosition.object=position.object;
+    matrixPosition.nodeIndex=position.nodeIndex;
+    matrixPosition.way=NULL;
+    matrixPosition.nodes.clear();
+
+    if (position.object.GetType()!=refWay) {
+      return true;
+    }
+
+    if (wayDataFile.Invalid()) {
+      return false;
+    }
+
+    WayRef way;
+
+    if (!wayDataFile->GetByOffset(position.object.GetFileOffset(),
+                                  way)) {
+      std::cerr << "Cannot get way " << position.object.GetFileOffset() << "!" << std::endl;
+      return false;
+    }
+
+    if (position.nodeIndex>=way->nodes.size()) {
+      std::cerr << "Given node index " << position.nodeIndex << " is not within valid range [0," << way->nodes.size()-1 << std::endl;
+      return false;
+    }
+
+    matrixPosition.way=way;
+
+    FileOffset offset;
+    MatrixNode node;
+
+    // Check, if the current node is already a route node
+    if (routeNodeDataFile.GetOffset(way->ids[position.nodeIndex],
+                                    offset)) {
+      node.node=graph.GetNodeIndex(offset);
+
+      if (node.node!=RoutingGraph::noNode) {
+        node.costs=0.0;
+        node.distance=0.0;
+        node.time=0.0;
+
+        matrixPosition.nodes.push_back(node);
+
+        return true;
+      }
+    }
+
+    // Leaving the source (or reaching the target) in the direction of the way
+    // means using the next route node after (or the route node before) the node
+    bool useNext=isSource ? profile.CanUseForward(*way) : profile.CanUseBackward(*way);
+    bool usePrevious=isSource ? profile.CanUseBackward(*way) : profile.CanUseForward(*way);
+
+    for (size_t i=position.nodeIndex+1; useNext && i<way->nodes.size(); i++) {
+      if (routeNodeDataFile.GetOffset(way->ids[i],
+                                      offset)) {
+        node.node=graph.GetNodeIndex(offset);
+
+        if (node.node!=RoutingGraph::noNode) {
+          node.distance=GetDistanceOnWay(*way,position.nodeIndex,i);
+          node.costs=profile.GetCosts(*way,node.distance);
+          node.time=profile.GetTime(*way,node.distance);
+
+          matrixPosition.nodes.push_back(node);
+          break;
+        }
+      }
+    }
+
+    for (size_t i=position.nodeIndex; usePrevious && i>0; i--) {
+      if (routeNodeDataFile.GetOffset(way->ids[i-1],
+                                      offset)) {
+        node.node=graph.GetNodeIndex(offset);
+
+        if (node.node!=RoutingGraph::noNode) {
+          node.distance=GetDistanceOnWay(*way,i-1,position.nodeIndex);
+          node.costs=profile.GetCosts(*way,node.distance);
+          node.time=profile.GetTime(*way,node.distance);
+
+          matrixPosition.nodes.push_back(node);
+          break;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Calculate the routes from the given source to all targets using one
+   * Dijkstra search on the routing graph held in memory. The search stops
+   * as soon as all route nodes of all targets are settled.
+   *
+   * Paths are evaluated the same way as by SearchRouteInMemoryGraph()
+   * (access restrictions, turn restrictions, no immediate return to the
+   * previous route node).
+   */
+  void RoutingService::SearchRouteMatrixRow(const RoutingProfile& profile,
+                                            const MatrixPosition& source,
+                                            const std::vector<MatrixPosition>& targets,
+                                            const OSMSCOUT_HASHSET<uint32_t>& targetNodes,
+                                            RouteMatrix::Entry* entries) const
+  {
+    const RoutingGraph&   graph=*routingGraph;
+
+    // All search nodes
+    std::vector<HNode>    hnodes;
+    // The graph node index, the distance and the time of each search node
+    std::vector<uint32_t> graphNodes;
+    std::vector<double>   distances;
+    std::vector<double>   times;
+    // Map graph node index to search node index
+    HNodeIndexMap         nodeMap;
+    // Open nodes by cost (smallest cost first)
+    HeapOpenList          openList((HNodeCostCompare(&hnodes)));
+
+    hnodes.reserve(10000);
+    graphNodes.reserve(10000);
+    distances.reserve(10000);
+    times.reserve(10000);
+    openList.Reserve(10000);
+
+#if defined(OSMSCOUT_HASHMAP_HAS_RESERVE)
+    nodeMap.reserve(10000);
+#endif
+
+    for (std::vector<MatrixNode>::const_iterator start=source.nodes.begin();
+         start!=source.nodes.end();
+         ++start) {
+      HNodeIndexMap::const_iterator entry=nodeMap.find(start->node);
+
+      if (entry!=nodeMap.end()) {
+        if (hnodes[entry->second].currentCost<=start->costs) {
+          continue;
+        }
+      }
+
+      HNode node;
+
+      node.nodeOffset=graph.GetNodeOffset(start->node);
+      node.prev=0;
+      node.prevIndex=noPrevIndex;
+      node.object=source.object;
+      node.currentCost=start->costs;
+      node.estimateCost=0.0;
+      node.overallCost=start->costs;
+      node.access=true;
+      node.closed=false;
+
+      if (entry!=nodeMap.end()) {
+        hnodes[entry->second]=node;
+        distances[entry->second]=start->distance;
+        times[entry->second]=start->time;
+        openList.Update(entry->second);
+      }
+      else {
+        nodeMap[start->node]=hnodes.size();
+        hnodes.push_back(node);
+        graphNodes.push_back(start->node);
+        distances.push_back(start->distance);
+        times.push_back(start->time);
+        openList.Push(hnodes.size()-1);
+      }
+    }
+
+    size_t          remainingTargetNodes=targetNodes.size();
+    RouteNode::Path path;
+
+    while (!openList.empty() &&
+           remainingTargetNodes>0) {
+      size_t current=openList.Top();
+
+      openList.Pop();
+
+      hnodes[current].closed=true;
+
+      // hnodes may get reallocated while adding new nodes
+      uint32_t      currentNode=graphNodes[current];
+      FileOffset    currentOffset=hnodes[current].nodeOffset;
+      FileOffset    currentPrev=hnodes[current].prev;
+      ObjectFileRef currentObject=hnodes[current].object;
+      double        currentCurrentCost=hnodes[current].currentCost;
+      double        currentDistance=distances[current];
+      double        currentTime=times[current];
+      bool          currentAccess=hnodes[current].access;
+      bool          hasExcludes=graph.HasExcludes(currentNode);
+      uint32_t      edgesBegin=graph.GetEdgesBegin(currentNode);
+      uint32_t      edgesEnd=graph.GetEdgesEnd(currentNode);
+
+      if (targetNodes.find(currentNode)!=targetNodes.end()) {
+        remainingTargetNodes--;
+      }
+
+      for (uint32_t e=edgesBegin; e<edgesEnd; e++) {
+        const RoutingGraph::Edge& edge=graph.GetEdge(e);
+
+        graph.GetPath(currentNode,e,path);
+
+        if (path.offset==currentPrev) {
           continue;
         }
 
-        if (!profile.CanUse(*currentRouteNode,i)) {
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << " => Cannot be used"<< std::endl;
-#endif
-          nodesIgnoredCount++;
+        if (!currentAccess &&
+            path.HasAccess()) {
           continue;
         }
 
-        if (closeMap.find(path->offset)!=closeMap.end()) {
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << " => already calculated" << std::endl;
-#endif
+        if (!profile.CanUse(path)) {
           continue;
         }
 
-        if (!currentRouteNode->excludes.empty()) {
-          bool canTurnedInto=true;
-          for (size_t e=0; e<currentRouteNode->excludes.size(); e++) {
-            if (currentRouteNode->excludes[e].source==current->object &&
-                currentRouteNode->excludes[e].targetIndex==i) {
-#if defined(DEBUG_ROUTING)
-              std::cout << "  Skipping route";
-              std::cout << " to " << path->offset;
-              std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-              std::cout << " => turn not allowed" << std::endl;
-#endif
-              canTurnedInto=false;
-              break;
-            }
-          }
+        HNodeIndexMap::const_iterator entry=nodeMap.find(edge.target);
 
-          if (!canTurnedInto) {
-            nodesIgnoredCount++;
-            continue;
-          }
+        if (entry!=nodeMap.end() &&
+            hnodes[entry->second].closed) {
+          continue;
         }
 
-        double currentCost=current->currentCost+
-                           profile.GetCosts(*currentRouteNode,i);
+        if (hasExcludes &&
+            graph.IsExcluded(currentNode,
+                             currentObject,
+                             e-edgesBegin)) {
+          continue;
+        }
 
-        OpenMap::iterator openEntry=openMap.find(path->offset);
+        double currentCost=currentCurrentCost+
+                           profile.GetCosts(path);
 
-        // Check, if we already have a cheaper path to the new node. If yes, do not put the new path
-        // into the open list
-        if (openEntry!=openMap.end() &&
-            (*openEntry->second)->currentCost<=currentCost) {
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << "  => cheaper route exists " << currentCost << "<=>" << (*openEntry->second)->currentCost << std::endl;
-#endif
+        // Check, if we already have a cheaper path to the new node
+        if (entry!=nodeMap.end() &&
+            hnodes[entry->second].currentCost<=currentCost) {
           continue;
         }
 
-        double distanceToTarget=GetSphericalDistance(path->lon,
-                                                     path->lat,
-                                                     targetLon,
-                                                     targetLat);
-        // Estimate costs for the rest of the distance to the target
-        double estimateCost=profile.GetCosts(distanceToTarget);
-        double overallCost=currentCost+estimateCost;
-
-        // If we already have the node in the open list, but the new path is cheaper,
-        // update the existing entry
-        if (openEntry!=openMap.end()) {
-          RNodeRef node=*openEntry->second;
+        HNode node;
+
+        node.nodeOffset=path.offset;
+        node.prev=currentOffset;
+        node.prevIndex=current;
+        node.object=graph.GetObject(edge.object);
+        node.currentCost=currentCost;
+        node.estimateCost=0.0;
+        node.overallCost=currentCost;
+        node.access=path.HasAccess();
+        node.closed=false;
+
+        if (entry!=nodeMap.end()) {
+          hnodes[entry->second]=node;
+          distances[entry->second]=currentDistance+path.distance;
+          times[entry->second]=currentTime+profile.GetTime(path);
+          openList.Update(entry->second);
+        }
+        else {
+          nodeMap[edge.target]=hnodes.size();
+          hnodes.push_back(node);
+          graphNodes.push_back(edge.target);
+          distances.push_back(currentDistance+path.distance);
+          times.push_back(currentTime+profile.GetTime(path));
+          openList.Push(hnodes.size()-1);
+        }
+      }
+    }
 
-          node->prev=current->nodeOffset;
-          node->object=currentRouteNode->objects[path->objectIndex];
+    for (size_t t=0; t<targets.size(); t++) {
+      const MatrixPosition& target=targets[t];
+      RouteMatrix::Entry&   result=entries[t];
 
-          node->currentCost=currentCost;
-          node->estimateCost=estimateCost;
-          node->overallCost=overallCost;
-          node->access=currentRouteNode->paths[i].HasAccess();
+      for (std::vector<MatrixNode>::const_iterator end=target.nodes.begin();
+           end!=target.nodes.end();
+           ++end) {
+        HNodeIndexMap::const_iterator entry=nodeMap.find(end->node);
 
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Updating route " << current->nodeOffset << " via " << node->object.GetTypeName() << " " << node->object.GetFileOffset() << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
-#endif
+        if (entry==nodeMap.end() ||
+            !hnodes[entry->second].closed) {
+          continue;
+        }
 
-          openList.erase(openEntry->second);
+        double costs=hnodes[entry->second].currentCost+end->costs;
 
-          std::pair<OpenListRef,bool> result=openList.insert(node);
-          openEntry->second=result.first;
+        if (!result.found ||
+            costs<result.costs) {
+          result.found=true;
+          result.costs=costs;
+          result.distance=distances[entry->second]+end->distance;
+          result.time=times[entry->second]+end->time;
         }
-        else {
-          RNodeRef node=new RNode(path->offset,
-                                  currentRouteNode->objects[path->objectIndex],
-                                  current->nodeOffset);
+      }
 
-          node->currentCost=currentCost;
-          node->estimateCost=estimateCost;
-          node->overallCost=overallCost;
-          node->access=path->HasAccess();
+      // Source and target on the same way, the route may not pass any route node
+      if (source.way.Valid() &&
+          target.way.Valid() &&
+          source.object==target.object) {
+        const Way& way=*source.way;
+        bool       usable;
 
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Inserting route to " << path->offset;
-          std::cout <<  " (" << node->object.GetTypeName() << " " << node->object.GetFileOffset() << ")";
-          std::cout << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
-#endif
+        if (target.nodeIndex>source.nodeIndex) {
+          usable=profile.CanUseForward(way);
+        }
+        else if (target.nodeIndex<source.nodeIndex) {
+          usable=profile.CanUseBackward(way);
+        }
+        else {
+          usable=true;
+        }
 
-          std::pair<OpenListRef,bool> result=openList.insert(node);
-          openMap[node->nodeOffset]=result.first;
+        if (usable) {
+          double distance=GetDistanceOnWay(way,
+                                           source.nodeIndex,
+                                           target.nodeIndex);
+          double costs=profile.GetCosts(way,distance);
+
+          if (!result.found ||
+              costs<result.costs) {
+            result.found=true;
+            result.costs=costs;
+            result.distance=distance;
+            result.time=profile.GetTime(way,distance);
+          }
         }
       }
+    }
+  }
 
-      //
-      // Added current node to close map
-      //
+  /**
+   * Worker of CalculateRouteMatrix(), calculates the rows of the sources
+   * not yet handled by another worker
+   */
+  void RoutingService::CalculateRouteMatrixRows(const RoutingProfile* profile,
+                                                const std::vector<MatrixPosition>* sources,
+                                                const std::vector<MatrixPosition>* targets,
+                                                const OSMSCOUT_HASHSET<uint32_t>* targetNodes,
+                                                Mutex* mutex,
+                                                size_t* nextSource,
+                                                RouteMatrix* matrix) const
+  {
+    while (true) {
+      size_t source;
 
-      closeMap[current->nodeOffset]=current;
+      {
+        MutexLocker locker(*mutex);
 
-      maxOpenList=std::max(maxOpenList,openMap.size());
-      maxCloseMap=std::max(maxCloseMap,closeMap.size());
+        if (*nextSource>=sources->size()) {
+          return;
+        }
 
-#if defined(DEBUG_ROUTING)
-      if (openList.empty()) {
-        std::cout << "No more alternatives, stopping" << std::endl;
+        source=(*nextSource)++;
       }
 
-      if ((targetForwardRouteNode.Valid() && current->nodeOffset==targetForwardRouteNode->fileOffset)) {
-        std::cout << "Reached target: " << current->nodeOffset << " == " << targetForwardRouteNode->fileOffset << " (forward)" << std::endl;
-      }
+      SearchRouteMatrixRow(*profile,
+                           (*sources)[source],
+                           *targets,
+                           *targetNodes,
+                           &matrix->Get(source,0));
+    }
+  }
 
-      if (targetBackwardRouteNode.Valid() && current->nodeOffset==targetBackwardRouteNode->fileOffset) {
-        std::cout << "Reached target: " << current->nodeOffset << " == " << targetBackwardRouteNode->fileOffset << " (backward)" << std::endl;
-      }
-#endif
-    } while (!openList.empty() &&
-             (targetForwardRouteNode.Invalid() || current->nodeOffset!=targetForwardRouteNode->fileOffset) &&
-             (targetBackwardRouteNode.Invalid() || current->nodeOffset!=targetBackwardRouteNode->fileOffset));
+  /**
+   * Calculate the costs, distances and travel times of the routes from each
+   * source to each target. In contrast to calling CalculateRoute() for each
+   * pair, only one search per source is done and the routes are not
+   * resolved to RouteData.
+   *
+   * The searches use the routing graph held in memory, it is loaded on the
+   * first call if it was not already loaded by Open() (see
+   * RouterParameter::SetUseInMemoryGraph()). The sources are distributed
+   * over the number of threads given by
+   * RouterParameter::SetMatrixThreadCount().
+   *
+   * @param profile
+   *    Profile to use
+   * @param sources
+   *    The sources (rows of the matrix)
+   * @param targets
+   *    The targets (columns of the matrix)
+   * @param matrix
+   *    The resulting matrix. Entries for pairs without a route (including
+   *    sources or targets on areas) are marked as not found.
+   * @return
+   *    False, if there was an error, else true
+   */
+  bool RoutingService::CalculateRouteMatrix(const RoutingProfile& profile,
+                                            const std::vector<RouteMatrix::Position>& sources,
+                                            const std::vector<RouteMatrix::Position>& targets,
+                                            RouteMatrix& matrix)
+  {
+    matrix.Initialize(sources.size(),
+                      targets.size());
 
-    clock.Stop();
+    if (sources.empty() ||
+        targets.empty()) {
+      return true;
+    }
 
-    if (debugPerformance) {
-      std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
-      std::cout << "[";
-      if (startBackwardRouteNode.Valid()) {
-        std::cout << startBackwardRouteNode->GetId() << " >* ";
-      }
-      std::cout << startNodeIndex;
-      if (startForwardRouteNode.Valid()) {
-        std::cout << " *> " << startForwardRouteNode->GetId();
+    if (routingGraph.Invalid() &&
+        !LoadRoutingGraph()) {
+      return false;
+    }
+
+    StopClock                    clock;
+    std::vector<MatrixPosition>  sourcePositions(sources.size());
+    std::vector<MatrixPosition>  targetPositions(targets.size());
+    OSMSCOUT_HASHSET<uint32_t>   targetNodes;
+
+    for (size_t s=0; s<sources.size(); s++) {
+      if (!GetMatrixPosition(profile,
+                             sources[s],
+                             true,
+                             sourcePositions[s])) {
+        return false;
       }
-      std::cout << "]" << std::endl;
+    }
 
-      std::cout << "To:                  " << targetObject.GetTypeName() <<  " " << targetObject.GetFileOffset();
-      std::cout << "[";
-      if (targetForwardRouteNode.Valid()) {
-        std::cout << targetForwardRouteNode->GetId() << " >* ";
+    for (size_t t=0; t<targets.size(); t++) {
+      if (!GetMatrixPosition(profile,
+                             targets[t],
+                             false,
+                             targetPositions[t])) {
+        return false;
       }
-      std::cout << targetNodeIndex;
-      if (targetBackwardRouteNode.Valid()) {
-        std::cout << " *> " << targetBackwardRouteNode->GetId();
+
+      for (std::vector<MatrixNode>::const_iterator node=targetPositions[t].nodes.begin();
+           node!=targetPositions[t].nodes.end();
+           ++node) {
+        targetNodes.insert(node->node);
       }
-      std::cout << "]" << std::endl;
+    }
 
-      std::cout << "Time:                " << clock << std::endl;
+    size_t workerCount=std::min(matrixThreadCount,sources.size());
+    Mutex  mutex;
+    size_t nextSource=0;
 
-      std::cout << "Route nodes loaded:  " << nodesLoadedCount << std::endl;
-      std::cout << "Route nodes ignored: " << nodesIgnoredCount << std::endl;
-      std::cout << "Max. OpenList size:  " << maxOpenList << std::endl;
-      std::cout << "Max. CloseMap size:  " << maxCloseMap << std::endl;
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::vector<std::thread> threads;
+
+    // The first worker runs in the current thread
+    for (size_t w=1; w<workerCount; w++) {
+      threads.push_back(std::thread(&RoutingService::CalculateRouteMatrixRows,
+                                    this,
+                                    &profile,
+                                    &sourcePositions,
+                                    &targetPositions,
+                                    &targetNodes,
+                                    &mutex,
+                                    &nextSource,
+                                    &matrix));
     }
+#endif
 
-    if (!((targetForwardRouteNode.Valid() && currentRouteNode->GetId()==targetForwardRouteNode->id) ||
-          (targetBackwardRouteNode.Valid() && currentRouteNode->GetId()==targetBackwardRouteNode->id))) {
-      std::cout << "No route found!" << std::endl;
-      route.Clear();
+    CalculateRouteMatrixRows(&profile,
+                             &sourcePositions,
+                             &targetPositions,
+                             &targetNodes,
+                             &mutex,
+                             &nextSource,
+                             &matrix);
 
-      return true;
+#if defined(OSMSCOUT_HAVE_THREAD)
+    for (size_t t=0; t<threads.size(); t++) {
+      threads[t].join();
     }
+#endif
 
-    std::list<RNodeRef> nodes;
+    clock.Stop();
 
-    ResolveRNodeChainToList(current,
-                            closeMap,
-                            nodes);
+    if (debugPerformance) {
+      std::cout << "Route matrix:        " << sources.size() << "x" << targets.size();
+      std::cout << " (" << workerCount << " threads) " << clock << std::endl;
+    }
 
-    if (!ResolveRNodesToRouteData(profile,
-                                  nodes,
-                                  startObject,
-                                  startNodeIndex,
-                                  targetObject,
-                                  targetNodeIndex,
-                                  route)) {
-      //std::cerr << "Cannot convert routing result to route data" << std::endl;
-      return false;
+    return true;
+  }
+
+  /**
+   * Calculate the costs, distances and travel times of the routes from each
+   * source to each target. Each coordinate is assigned to the closest
+   * routable node (see GetClosestRoutableNode()) once, then the matrix is
+   * calculated as described for the variant taking positions.
+   *
+   * @param profile
+   *    Profile to use
+   * @param radius
+   *    The maximum radius to search in for a routable node around each
+   *    coordinate in meter
+   * @param sources
+   *    The sources (rows of the matrix)
+   * @param targets
+   *    The targets (columns of the matrix)
+   * @param matrix
+   *    The resulting matrix. Entries for coordinates without a routable
+   *    node within the radius are marked as not found.
+   * @return
+   *    False, if there was an error, else true
+   */
+  bool RoutingService::CalculateRouteMatrix(const RoutingProfile& profile,
+                                            double radius,
+                                            const std::vector<GeoCoord>& sources,
+                                            const std::vector<GeoCoord>& targets,
+                                            RouteMatrix& matrix)
+  {
+    std::vector<RouteMatrix::Position> sourcePositions(sources.size());
+    std::vector<RouteMatrix::Position> targetPositions(targets.size());
+
+    for (size_t s=0; s<sources.size(); s++) {
+      if (!GetClosestRoutableNode(sources[s].GetLat(),
+                                  sources[s].GetLon(),
+                                  vehicle,
+                                  radius,
+                                  sourcePositions[s].object,
+                                  sourcePositions[s].nodeIndex)) {
+        return false;
+      }
     }
 
-    ResolveRouteDataJunctions(route);
+    for (size_t t=0; t<targets.size(); t++) {
+      if (!GetClosestRoutableNode(targets[t].GetLat(),
+                                  targets[t].GetLon(),
+                                  vehicle,
+                                  radius,
+                                  targetPositions[t].object,
+                                  targetPositions[t].nodeIndex)) {
+        return false;
+      }
+    }
 
-    return true;
+    return CalculateRouteMatrix(profile,
+                                sourcePositions,
+                                targetPositions,
+                                matrix);
   }
 
   /**
@@ -1576,6 +3189,23 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Return statistics about the last route calculation.
+   */
+  const RoutingService::Statistics& RoutingService::GetStatistics() const
+  {
+    return statistics;
+  }
+
+  /**
+   * Return the routing graph held in memory, if the routing service was
+   * opened with RouterParameter::SetUseInMemoryGraph(true).
+   */
+  RoutingGraphRef RoutingService::GetRoutingGraph() const
+  {
+    return routingGraph;
+  }
+
   void RoutingService::DumpStatistics()
   {
     if (database.Valid()) {
@@ -1583,12 +3213,26 @@ namespace osmscout {
     }
 
     routeNodeDataFile.DumpStatistics();
+
+    if (routingGraph.Valid()) {
+      std::cout << "Routing graph: ";
+      std::cout << routingGraph->GetNodeCount() << " nodes, ";
+      std::cout << routingGraph->GetEdgeCount() << " edges, ";
+      std::cout << routingGraph->GetObjectCount() << " objects, ";
+      std::cout << ByteSizeToString(routingGraph->GetMemoryUsage()) << std::endl;
+    }
   }
 
   /**
    * Returns the closed routeable object (area or way) relative
    * to the given coordinate.
    *
+   * If the index of routable segments is available for the given vehicle,
+   * the closest segment is searched and the node of the segment closest to
+   * the projection of the coordinate onto the segment is returned.
+   * Otherwise the closest node of all routable objects in the area is
+   * returned.
+   *
    * @note The actual object may not be within the given radius
    * due to internal search index resolution.
    *
@@ -1614,6 +3258,83 @@ namespace osmscout {
                                               double radius,
                                               osmscout::ObjectFileRef& object,
                                               size_t& nodeIndex) const
+  {
+    if (segmentIndex.Invalid() ||
+        vehicle!=this->vehicle) {
+      return GetClosestRoutableNodeByScan(lat,
+                                          lon,
+                                          vehicle,
+                                          radius,
+                                          object,
+                                          nodeIndex);
+    }
+
+    std::vector<RouteSegmentIndex::Match> matches;
+
+    object.Invalidate();
+
+    if (!segmentIndex->GetClosestSegments(GeoCoord(lat,lon),
+                                          1,
+                                          radius,
+                                          matches)) {
+      return false;
+    }
+
+    if (!matches.empty()) {
+      object=matches.front().object;
+      nodeIndex=matches.front().nodeIndex;
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the routable segments closest to the given coordinate. In
+   * contrast to GetClosestRoutableNode() the projection of the coordinate
+   * onto the segment is returned, too.
+   *
+   * The index of routable segments is generated by the import. If it is not
+   * available for the vehicle of the routing service, false is returned.
+   *
+   * @param coord
+   *    The search center
+   * @param count
+   *    The maximum number of segments to return
+   * @param radius
+   *    The maximum distance of a segment to the search center in meter
+   * @param matches
+   *    The segments found, closest first
+   * @return
+   *    false on error or if the index is not available, else true
+   */
+  bool RoutingService::GetClosestRoutableSegments(const GeoCoord& coord,
+                                                  size_t count,
+                                                  double radius,
+                                                  std::vector<RouteSegmentIndex::Match>& matches) const
+  {
+    matches.clear();
+
+    if (segmentIndex.Invalid()) {
+      return false;
+    }
+
+    return segmentIndex->GetClosestSegments(coord,
+                                            count,
+                                            radius,
+                                            matches);
+  }
+
+  /**
+   * Returns the closest routable node by scanning all routable ways and
+   * areas in the area around the given coordinate. Used if no index of
+   * routable segments is available.
+   */
+  bool RoutingService::GetClosestRoutableNodeByScan(double lat,
+                                                    double lon,
+                                                    const osmscout::Vehicle& vehicle,
+                                                    double radius,
+                                                    osmscout::ObjectFileRef& object,
+                                                    size_t& nodeIndex) const
   {
     object.Invalidate();
 
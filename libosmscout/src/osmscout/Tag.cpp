@@ -36,7 +36,7 @@ namespace osmscout {
     // no code
   }
 
-  bool TagNotCondition::Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const
+  bool TagNotCondition::Evaluate(const TagMap& tagMap) const
   {
     return !condition->Evaluate(tagMap);
   }
@@ -52,7 +52,7 @@ namespace osmscout {
     conditions.push_back(condition);
   }
 
-  bool TagBoolCondition::Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const
+  bool TagBoolCondition::Evaluate(const TagMap& tagMap) const
   {
     switch (type) {
     case boolAnd:
@@ -84,7 +84,7 @@ namespace osmscout {
     // no code
   }
 
-  bool TagExistsCondition::Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const
+  bool TagExistsCondition::Evaluate(const TagMap& tagMap) const
   {
     return tagMap.find(tag)!=tagMap.end();
   }
@@ -112,7 +112,7 @@ namespace osmscout {
     // no code
   }
 
-  bool TagBinaryCondition::Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const
+  bool TagBinaryCondition::Evaluate(const TagMap& tagMap) const
   {
     auto t=tagMap.find(tag);
 
@@ -123,17 +123,17 @@ namespace osmscout {
     if (valueType==string) {
       switch (binaryOperator) {
       case  operatorLess:
-        return t->second<tagStringValue;
+        return t->second.Compare(tagStringValue)<0;
       case  operatorLessEqual:
-        return t->second<=tagStringValue;
+        return t->second.Compare(tagStringValue)<=0;
       case  operatorEqual:
-        return t->second==tagStringValue;
+        return t->second.Compare(tagStringValue)==0;
       case operatorNotEqual:
-        return t->second!=tagStringValue;
+        return t->second.Compare(tagStringValue)!=0;
       case operatorGreaterEqual:
-        return t->second>=tagStringValue;
+        return t->second.Compare(tagStringValue)>=0;
       case  operatorGreater:
-        return t->second>tagStringValue;
+        return t->second.Compare(tagStringValue)>0;
       default:
         assert(false);
 
@@ -143,7 +143,7 @@ namespace osmscout {
     else if (valueType==sizet) {
       size_t value;
 
-      if (!StringToNumber(t->second,
+      if (!StringToNumber(t->second.ToString(),
                           value)) {
         return false;
       }
@@ -185,7 +185,7 @@ namespace osmscout {
     tagValues.insert(tagValue);
   }
 
-  bool TagIsInCondition::Evaluate(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const
+  bool TagIsInCondition::Evaluate(const TagMap& tagMap) const
   {
     auto t=tagMap.find(tag);
 
@@ -193,7 +193,7 @@ namespace osmscout {
       return false;
     }
 
-    return tagValues.find(t->second)!=tagValues.end();
+    return tagValues.find(t->second.ToString())!=tagValues.end();
   }
 
   TagInfo::TagInfo()
@@ -0,0 +1,576 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TagClassifier.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <osmscout/util/String.h>
+
+#include <osmscout/system/Assert.h>
+
+namespace osmscout {
+
+  /**
+   * Size of the buffers on the stack used by Match(), only
+   * objects with more (referenced) tags or classifiers with more rules
+   * need a heap allocation.
+   */
+  static const size_t localBufferSize=32;
+
+  /**
+   * Weight of a trigger that accepts any tag value, compared to a trigger
+   * for one specific tag value, when selecting the most selective operand
+   * of an "and" condition.
+   */
+  static const size_t anyValueTriggerWeight=1000;
+
+  static inline size_t GetLowestBit(uint64_t bits)
+  {
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(bits);
+#else
+    size_t bit=0;
+
+    while ((bits & 1)==0) {
+      bits>>=1;
+      bit++;
+    }
+
+    return bit;
+#endif
+  }
+
+  static inline void SetBits(uint64_t* bits,
+                             const std::vector<size_t>& rules)
+  {
+    for (std::vector<size_t>::const_iterator rule=rules.begin();
+         rule!=rules.end();
+         ++rule) {
+      bits[*rule/64]|=((uint64_t)1) << (*rule%64);
+    }
+  }
+
+  TagClassifier::TagClassifier()
+  {
+    // no code
+  }
+
+  void TagClassifier::Clear()
+  {
+    instructions.clear();
+    operands.clear();
+    rules.clear();
+    keys.clear();
+    keyIndex.clear();
+    unconditionalRules.clear();
+  }
+
+  TagClassifier::Key& TagClassifier::GetKey(TagId tag)
+  {
+    if (tag>=keyIndex.size()) {
+      keyIndex.resize(tag+1,0);
+    }
+
+    if (keyIndex[tag]==0) {
+      keys.push_back(Key());
+      keyIndex[tag]=keys.size();
+    }
+
+    return keys[keyIndex[tag]-1];
+  }
+
+  uint32_t TagClassifier::GetValueId(TagId tag,
+                                     const std::string& value)
+  {
+    Key&  key=GetKey(tag);
+    Value entry;
+
+    entry.value=value;
+
+    std::vector<Value>::iterator existing=std::lower_bound(key.values.begin(),
+                                                           key.values.end(),
+                                                           entry,
+                                                           ValueLess());
+
+    if (existing!=key.values.end() &&
+        existing->value==value) {
+      return existing->id;
+    }
+
+    key.valueRules.push_back(std::vector<size_t>());
+
+    entry.id=(uint32_t)key.valueRules.size();
+
+    key.values.insert(existing,entry);
+
+    return entry.id;
+  }
+
+  /**
+   * Compile the given condition (and its children) into the list
+   * of instructions and return the index of its instruction.
+   */
+  size_t TagClassifier::Compile(const TagCondition& condition)
+  {
+    Instruction         instruction;
+    std::vector<size_t> children;
+
+    instruction.binaryOperator=operatorEqual;
+    instruction.tag=tagIgnore;
+    instruction.valueId=0;
+    instruction.sizeValue=0;
+    instruction.first=0;
+    instruction.count=0;
+
+    if (const TagNotCondition* notCondition=dynamic_cast<const TagNotCondition*>(&condition)) {
+      instruction.operation=opNot;
+      children.push_back(Compile(*notCondition->GetCondition()));
+    }
+    else if (const TagBoolCondition* boolCondition=dynamic_cast<const TagBoolCondition*>(&condition)) {
+      instruction.operation=boolCondition->GetType()==TagBoolCondition::boolAnd ? opAnd : opOr;
+
+      for (std::list<TagConditionRef>::const_iterator child=boolCondition->GetConditions().begin();
+           child!=boolCondition->GetConditions().end();
+           ++child) {
+        children.push_back(Compile(**child));
+      }
+    }
+    else if (const TagExistsCondition* existsCondition=dynamic_cast<const TagExistsCondition*>(&condition)) {
+      instruction.operation=opExists;
+      instruction.tag=existsCondition->GetTag();
+
+      GetKey(instruction.tag);
+    }
+    else if (const TagBinaryCondition* binaryCondition=dynamic_cast<const TagBinaryCondition*>(&condition)) {
+      instruction.tag=binaryCondition->GetTag();
+      instruction.binaryOperator=binaryCondition->GetOperator();
+
+      GetKey(instruction.tag);
+
+      if (binaryCondition->HasSizeValue()) {
+        instruction.operation=opCompareSize;
+        instruction.sizeValue=binaryCondition->GetSizeValue();
+      }
+      else if (instruction.binaryOperator==operatorEqual) {
+        instruction.operation=opEqual;
+        instruction.valueId=GetValueId(instruction.tag,
+                                       binaryCondition->GetStringValue());
+      }
+      else if (instruction.binaryOperator==operatorNotEqual) {
+        instruction.operation=opNotEqual;
+        instruction.valueId=GetValueId(instruction.tag,
+                                       binaryCondition->GetStringValue());
+      }
+      else {
+        instruction.operation=opCompareString;
+        instruction.stringValue=binaryCondition->GetStringValue();
+      }
+    }
+    else if (const TagIsInCondition* isInCondition=dynamic_cast<const TagIsInCondition*>(&condition)) {
+      instruction.operation=opIsIn;
+      instruction.tag=isInCondition->GetTag();
+
+      GetKey(instruction.tag);
+
+      for (std::set<std::string>::const_iterator value=isInCondition->GetTagValues().begin();
+           value!=isInCondition->GetTagValues().end();
+           ++value) {
+        children.push_back(GetValueId(instruction.tag,
+                                      *value));
+      }
+
+      std::sort(children.begin(),
+                children.end());
+    }
+    else {
+      // Unknown condition types are not supported
+      assert(false);
+      instruction.operation=opOr;
+    }
+
+    instruction.first=operands.size();
+    instruction.count=children.size();
+
+    operands.insert(operands.end(),
+                    children.begin(),
+                    children.end());
+
+    instructions.push_back(instruction);
+
+    return instructions.size()-1;
+  }
+
+  /**
+   * Collect the tags (and tag values) of which at least one must be present
+   * for the given instruction to evaluate to true. Returns false, if no such
+   * set exists (the instruction may evaluate to true for any object).
+   */
+  bool TagClassifier::GetTriggers(size_t instruction,
+                                  std::vector<Trigger>& triggers) const
+  {
+    const Instruction& current=instructions[instruction];
+    Trigger            trigger;
+
+    trigger.tag=current.tag;
+    trigger.valueId=0;
+
+    switch (current.operation) {
+    case opNot:
+      return false;
+    case opOr:
+      for (size_t i=current.first; i<current.first+current.count; i++) {
+        if (!GetTriggers(operands[i],
+                         triggers)) {
+          return false;
+        }
+      }
+
+      return true;
+    case opAnd:
+      {
+        std::vector<Trigger> best;
+        size_t               bestWeight=std::numeric_limits<size_t>::max();
+
+        // Any operand must be true, so the triggers of the most selective
+        // operand are sufficient
+        for (size_t i=current.first; i<current.first+current.count; i++) {
+          std::vector<Trigger> operandTriggers;
+          size_t               weight=0;
+
+          if (!GetTriggers(operands[i],
+                           operandTriggers)) {
+            continue;
+          }
+
+          for (std::vector<Trigger>::const_iterator t=operandTriggers.begin();
+               t!=operandTriggers.end();
+               ++t) {
+            weight+=t->valueId==0 ? anyValueTriggerWeight : 1;
+          }
+
+          if (weight<bestWeight) {
+            best.swap(operandTriggers);
+            bestWeight=weight;
+          }
+        }
+
+        if (bestWeight==std::numeric_limits<size_t>::max()) {
+          return false;
+        }
+
+        triggers.insert(triggers.end(),
+                        best.begin(),
+                        best.end());
+      }
+
+      return true;
+    case opEqual:
+      trigger.valueId=current.valueId;
+      triggers.push_back(trigger);
+
+      return true;
+    case opIsIn:
+      if (current.count==0) {
+        triggers.push_back(trigger);
+      }
+
+      for (size_t i=current.first; i<current.first+current.count; i++) {
+        trigger.valueId=(uint32_t)operands[i];
+        triggers.push_back(trigger);
+      }
+
+      return true;
+    case opExists:
+    case opNotEqual:
+    case opCompareString:
+    case opCompareSize:
+      triggers.push_back(trigger);
+
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * Add a rule. Rules are matched in the order they are added.
+   *
+   * @param condition
+   *    The condition that must be fulfilled
+   * @param types
+   *    Bitset of the types of objects the rule applies to
+   * @param value
+   *    Value returned by Match() if the rule is the first that matches
+   */
+  void TagClassifier::AddRule(const TagCondition& condition,
+                              unsigned char types,
+                              size_t value)
+  {
+    Rule                 rule;
+    std::vector<Trigger> triggers;
+    size_t               ruleIndex=rules.size();
+
+    rule.instruction=Compile(condition);
+    rule.types=types;
+    rule.value=value;
+
+    rules.push_back(rule);
+
+    unconditionalRules.resize((rules.size()+63)/64,0);
+
+    if (!GetTriggers(rule.instruction,
+                     triggers)) {
+      unconditionalRules[ruleIndex/64]|=((uint64_t)1) << (ruleIndex%64);
+
+      return;
+    }
+
+    for (std::vector<Trigger>::const_iterator trigger=triggers.begin();
+         trigger!=triggers.end();
+         ++trigger) {
+      Key& key=GetKey(trigger->tag);
+
+      if (trigger->valueId==0) {
+        key.anyValueRules.push_back(ruleIndex);
+      }
+      else {
+        key.valueRules[trigger->valueId-1].push_back(ruleIndex);
+      }
+    }
+  }
+
+  bool TagClassifier::Evaluate(size_t instruction,
+                               const ObjectTag* values,
+                               size_t valueCount) const
+  {
+    const Instruction& current=instructions[instruction];
+
+    switch (current.operation) {
+    case opNot:
+      return !Evaluate(operands[current.first],
+                       values,
+                       valueCount);
+    case opAnd:
+      for (size_t i=current.first; i<current.first+current.count; i++) {
+        if (!Evaluate(operands[i],
+                      values,
+                      valueCount)) {
+          return false;
+        }
+      }
+
+      return true;
+    case opOr:
+      for (size_t i=current.first; i<current.first+current.count; i++) {
+        if (Evaluate(operands[i],
+                     values,
+                     valueCount)) {
+          return true;
+        }
+      }
+
+      return false;
+    default:
+      break;
+    }
+
+    const ObjectTag* value=NULL;
+
+    for (size_t i=0; i<valueCount; i++) {
+      if (values[i].tag==current.tag) {
+        value=&values[i];
+        break;
+      }
+    }
+
+    if (value==NULL) {
+      return false;
+    }
+
+    switch (current.operation) {
+    case opExists:
+      return true;
+    case opEqual:
+      return value->valueId==current.valueId;
+    case opNotEqual:
+      return value->valueId!=current.valueId;
+    case opIsIn:
+      return std::binary_search(operands.begin()+current.first,
+                                operands.begin()+current.first+current.count,
+                                (size_t)value->valueId);
+    case opCompareString:
+      switch (current.binaryOperator) {
+      case operatorLess:
+        return value->value->Compare(current.stringValue)<0;
+      case operatorLessEqual:
+        return value->value->Compare(current.stringValue)<=0;
+      case operatorGreaterEqual:
+        return value->value->Compare(current.stringValue)>=0;
+      case operatorGreater:
+        return value->value->Compare(current.stringValue)>0;
+      default:
+        assert(false);
+
+        return false;
+      }
+    case opCompareSize:
+      {
+        size_t number;
+
+        if (!StringToNumber(value->value->ToString(),
+                            number)) {
+          return false;
+        }
+
+        switch (current.binaryOperator) {
+        case operatorLess:
+          return number<current.sizeValue;
+        case operatorLessEqual:
+          return number<=current.sizeValue;
+        case operatorEqual:
+          return number==current.sizeValue;
+        case operatorNotEqual:
+          return number!=current.sizeValue;
+        case operatorGreaterEqual:
+          return number>=current.sizeValue;
+        case operatorGreater:
+          return number>current.sizeValue;
+        default:
+          assert(false);
+
+          return false;
+        }
+      }
+    default:
+      assert(false);
+
+      return false;
+    }
+  }
+
+  /**
+   * Return the value of the first rule (in the order of AddRule()) that
+   * applies to one of the given types and whose condition is fulfilled
+   * by the given tags.
+   *
+   * @param tagMap
+   *    Tags of the object
+   * @param types
+   *    Bitset of types, the rule must apply to at least one of them
+   * @param value
+   *    Value of the matching rule
+   * @param ruleTypes
+   *    Types of the matching rule
+   * @return
+   *    true, if a rule matched, else false
+   */
+  bool TagClassifier::Match(const TagMap& tagMap,
+                            unsigned char types,
+                            size_t& value,
+                            unsigned char& ruleTypes) const
+  {
+    size_t                 wordCount=unconditionalRules.size();
+    uint64_t               localCandidates[localBufferSize];
+    std::vector<uint64_t>  heapCandidates;
+    uint64_t*              candidates=localCandidates;
+    ObjectTag              localValues[localBufferSize];
+    std::vector<ObjectTag> heapValues;
+    ObjectTag*             values=localValues;
+    size_t                 valueCount=0;
+
+    if (wordCount==0) {
+      return false;
+    }
+
+    if (wordCount>localBufferSize) {
+      heapCandidates.resize(wordCount);
+      candidates=&heapCandidates[0];
+    }
+
+    if (tagMap.size()>localBufferSize) {
+      heapValues.resize(tagMap.size());
+      values=&heapValues[0];
+    }
+
+    std::copy(unconditionalRules.begin(),
+              unconditionalRules.end(),
+              candidates);
+
+    for (TagMap::const_iterator tag=tagMap.begin();
+         tag!=tagMap.end();
+         ++tag) {
+      if (tag->first>=keyIndex.size() ||
+          keyIndex[tag->first]==0) {
+        continue;
+      }
+
+      const Key& key=keys[keyIndex[tag->first]-1];
+      ObjectTag& tagValue=values[valueCount];
+
+      tagValue.tag=tag->first;
+      tagValue.valueId=0;
+      tagValue.value=&tag->second;
+
+      valueCount++;
+
+      SetBits(candidates,
+              key.anyValueRules);
+
+      if (!key.values.empty()) {
+        std::vector<Value>::const_iterator value=std::lower_bound(key.values.begin(),
+                                                                  key.values.end(),
+                                                                  tag->second,
+                                                                  ValueLess());
+
+        if (value!=key.values.end() &&
+            tag->second==value->value) {
+          tagValue.valueId=value->id;
+
+          SetBits(candidates,
+                  key.valueRules[value->id-1]);
+        }
+      }
+    }
+
+    for (size_t word=0; word<wordCount; word++) {
+      uint64_t bits=candidates[word];
+
+      while (bits!=0) {
+        size_t      ruleIndex=word*64+GetLowestBit(bits);
+        const Rule& rule=rules[ruleIndex];
+
+        bits&=bits-1;
+
+        if ((rule.types & types)!=0 &&
+            Evaluate(rule.instruction,
+                     values,
+                     valueCount)) {
+          value=rule.value;
+          ruleTypes=rule.types;
+
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+}
@@ -0,0 +1,131 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/TagMap.h>
+
+#include <algorithm>
+
+namespace osmscout {
+
+  /**
+   * Minimum size of a chunk of memory for copied tag values
+   */
+  static const size_t chunkSize=4096;
+
+  TagMap::TagMap()
+  : chunkIndex(0),
+    chunkUsed(0)
+  {
+    // no code
+  }
+
+  /**
+   * Copy the given value (plus a terminating zero) to the chunks. Chunks
+   * are never resized, so previously returned values stay valid.
+   */
+  const char* TagMap::Allocate(const char* value,
+                               size_t length)
+  {
+    while (chunkIndex<chunks.size() &&
+           chunkUsed+length+1>chunks[chunkIndex].size()) {
+      chunkIndex++;
+      chunkUsed=0;
+    }
+
+    if (chunkIndex>=chunks.size()) {
+      chunks.push_back(std::vector<char>(std::max(chunkSize,length+1)));
+      chunkIndex=chunks.size()-1;
+      chunkUsed=0;
+    }
+
+    char* copy=&chunks[chunkIndex][chunkUsed];
+
+    memcpy(copy,value,length);
+    copy[length]='\0';
+
+    chunkUsed+=length+1;
+
+    return copy;
+  }
+
+  void TagMap::Set(TagId tag,
+                   const TagValue& value)
+  {
+    for (std::vector<Entry>::iterator entry=entries.begin();
+         entry!=entries.end();
+         ++entry) {
+      if (entry->first==tag) {
+        entry->second=value;
+        return;
+      }
+    }
+
+    Entry entry;
+
+    entry.first=tag;
+    entry.second=value;
+
+    entries.push_back(entry);
+  }
+
+  /**
+   * Remove all tags. Allocated memory is kept for the next object.
+   */
+  void TagMap::Clear()
+  {
+    entries.clear();
+    chunkIndex=0;
+    chunkUsed=0;
+  }
+
+  /**
+   * Set the value of the given tag to the given string, without copying it.
+   * The string must not change until the TagMap is cleared.
+   */
+  void TagMap::Reference(TagId tag,
+                         const std::string& value)
+  {
+    Set(tag,
+        TagValue(value));
+  }
+
+  /**
+   * Set the value of the given tag to a copy of the given string
+   */
+  void TagMap::Copy(TagId tag,
+                    const char* value)
+  {
+    size_t length=strlen(value);
+
+    Set(tag,
+        TagValue(Allocate(value,length),
+                 length));
+  }
+
+  /**
+   * Set the value of the given tag to a copy of the given string
+   */
+  void TagMap::Copy(TagId tag,
+                    const std::string& value)
+  {
+    Set(tag,
+        TagValue(Allocate(value.c_str(),value.length()),
+                 value.length()));
+  }
+}
@@ -176,6 +176,20 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Return the (approximate) number of bytes allocated on the heap for the
+   * feature values.
+   */
+  size_t FeatureValueBuffer::GetAllocatedMemory() const
+  {
+    if (featureValueBuffer==NULL) {
+      return 0;
+    }
+
+    return type->GetFeatureBytes()+
+           type->GetFeatureValueBufferSize();
+  }
+
   FeatureValue* FeatureValueBuffer::AllocateValue(size_t idx)
   {
     size_t byteIdx=idx/8;
@@ -208,7 +222,7 @@ namespace osmscout {
   void FeatureValueBuffer::Parse(Progress& progress,
                                  const TypeConfig& typeConfig,
                                  const ObjectOSMRef& object,
-                                 const OSMSCOUT_HASHMAP<TagId,std::string>& tags)
+                                 const TagMap& tags)
   {
     for (const auto &feature : type->GetFeatures()) {
       feature.GetFeature()->Parse(progress,
@@ -338,6 +352,7 @@ namespace osmscout {
    * @param other
    */
   TypeInfo::TypeInfo(const TypeInfo& /*other*/)
+  : Referencable()
   {
     // no code
   }
@@ -494,7 +509,8 @@ namespace osmscout {
 
   TypeConfig::TypeConfig()
    : nextTagId(0),
-     nextTypeId(1)
+     nextTypeId(1),
+     conditionsCompiled(false)
   {
     // Make sure, that this is always registered first.
     // It assures that id 0 is always reserved for tagIgnore
@@ -784,6 +800,9 @@ namespace osmscout {
 
     idToTypeMap[typeInfo->GetId()]=typeInfo;
 
+    // The compiled conditions do not know about the new type
+    conditionsCompiled=false;
+
     return typeInfo;
   }
 
@@ -808,6 +827,17 @@ namespace osmscout {
       return tagIgnore;
     }
   }
+  TagId TypeConfig::GetTagId(const std::string& name) const
+  {
+    auto iter=stringToTagMap.find(name);
+
+    if (iter!=stringToTagMap.end()) {
+      return iter->second;
+    }
+    else {
+      return tagIgnore;
+    }
+  }
 
   const TypeInfoRef TypeConfig::GetTypeInfo(const std::string& name) const
   {
@@ -854,12 +884,26 @@ namespace osmscout {
     return true;
   }
 
-  TypeInfoRef TypeConfig::GetNodeType(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const
+  TypeInfoRef TypeConfig::GetNodeType(const TagMap& tagMap) const
   {
     if (tagMap.empty()) {
       return typeInfoIgnore;
     }
 
+    if (conditionsCompiled) {
+      size_t        index;
+      unsigned char ruleTypes;
+
+      if (tagClassifier.Match(tagMap,
+                              TypeInfo::typeNode,
+                              index,
+                              ruleTypes)) {
+        return types[index];
+      }
+
+      return typeInfoIgnore;
+    }
+
     for (const auto &type : types) {
       if (!type->HasConditions() ||
           !type->CanBeNode()) {
@@ -880,7 +924,7 @@ namespace osmscout {
     return typeInfoIgnore;
   }
 
-  bool TypeConfig::GetWayAreaType(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap,
+  bool TypeConfig::GetWayAreaType(const TagMap& tagMap,
                                   TypeInfoRef& wayType,
                                   TypeInfoRef& areaType) const
   {
@@ -891,6 +935,28 @@ namespace osmscout {
       return false;
     }
 
+    if (conditionsCompiled) {
+      size_t        index;
+      unsigned char ruleTypes;
+
+      if (!tagClassifier.Match(tagMap,
+                               TypeInfo::typeWay | TypeInfo::typeArea,
+                               index,
+                               ruleTypes)) {
+        return false;
+      }
+
+      if (ruleTypes & TypeInfo::typeWay) {
+        wayType=types[index];
+      }
+
+      if (ruleTypes & TypeInfo::typeArea) {
+        areaType=types[index];
+      }
+
+      return true;
+    }
+
     for (const auto &type : types) {
       if (!((type->CanBeWay() ||
              type->CanBeArea()) &&
@@ -926,7 +992,7 @@ namespace osmscout {
     return false;
   }
 
-  TypeInfoRef TypeConfig::GetRelationType(const OSMSCOUT_HASHMAP<TagId,std::string>& tagMap) const
+  TypeInfoRef TypeConfig::GetRelationType(const TagMap& tagMap) const
   {
     if (tagMap.empty()) {
       return typeInfoIgnore;
@@ -934,6 +1000,21 @@ namespace osmscout {
 
     auto relationType=tagMap.find(tagType);
 
+    if (conditionsCompiled) {
+      size_t        index;
+      unsigned char ruleTypes;
+
+      if (tagClassifier.Match(tagMap,
+                              relationType!=tagMap.end() &&
+                              relationType->second=="multipolygon" ? typeMultipolygon : TypeInfo::typeRelation,
+                              index,
+                              ruleTypes)) {
+        return types[index];
+      }
+
+      return typeInfoIgnore;
+    }
+
     if (relationType!=tagMap.end() &&
         relationType->second=="multipolygon") {
       for (size_t i=0; i<types.size(); i++) {
@@ -975,6 +1056,60 @@ namespace osmscout {
     return typeInfoIgnore;
   }
 
+  /**
+   * Compiles the conditions of all currently registered types into
+   * a TagClassifier, which is then used by GetNodeType(), GetWayAreaType()
+   * and GetRelationType() instead of evaluating the conditions of all types
+   * one after another. The result of these methods does not change.
+   *
+   * LoadFromOSTFile() calls this method after successfully loading all types.
+   * Registering another type discards the compiled conditions.
+   */
+  void TypeConfig::CompileConditions()
+  {
+    tagClassifier.Clear();
+
+    for (size_t i=0; i<types.size(); i++) {
+      const TypeInfoRef& type=types[i];
+
+      if (!type->HasConditions()) {
+        continue;
+      }
+
+      for (const auto &cond : type->GetConditions()) {
+        unsigned char ruleTypes=0;
+
+        if ((cond.types & TypeInfo::typeNode) &&
+            type->CanBeNode()) {
+          ruleTypes|=TypeInfo::typeNode;
+        }
+
+        if (type->CanBeWay() ||
+            type->CanBeArea()) {
+          ruleTypes|=cond.types & (TypeInfo::typeWay | TypeInfo::typeArea);
+        }
+
+        if ((cond.types & TypeInfo::typeArea) &&
+            type->CanBeArea()) {
+          ruleTypes|=typeMultipolygon;
+        }
+
+        if ((cond.types & TypeInfo::typeRelation) &&
+            type->CanBeRelation()) {
+          ruleTypes|=TypeInfo::typeRelation;
+        }
+
+        if (ruleTypes!=0) {
+          tagClassifier.AddRule(*cond.condition,
+                                ruleTypes,
+                                i);
+        }
+      }
+    }
+
+    conditionsCompiled=true;
+  }
+
   TypeId TypeConfig::GetTypeId(const std::string& name) const
   {
     auto typeEntry=nameToTypeMap.find(name);
@@ -1161,6 +1296,10 @@ namespace osmscout {
     delete parser;
     delete scanner;
 
+    if (success) {
+      CompileConditions();
+    }
+
     return success;
   }
 
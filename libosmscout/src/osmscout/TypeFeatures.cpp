@@ -80,11 +80,11 @@ namespace osmscout {
                           const TypeConfig& typeConfig,
                           const FeatureInstance& feature,
                           const ObjectOSMRef& /*object*/,
-                          const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                          const TagMap& tags,
                           FeatureValueBuffer& buffer) const
   {
-    std::string name;
-    uint32_t    namePriority=0;
+    TagValue name;
+    uint32_t namePriority=0;
 
     for (const auto &tag : tags) {
       uint32_t ntPrio;
@@ -100,7 +100,7 @@ namespace osmscout {
     if (!name.empty()) {
       NameFeatureValue* value=static_cast<NameFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
-      value->SetName(name);
+      value->SetName(name.ToString());
     }
   }
 
@@ -158,11 +158,11 @@ namespace osmscout {
                              const TypeConfig& typeConfig,
                              const FeatureInstance& feature,
                              const ObjectOSMRef& /*object*/,
-                             const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                             const TagMap& tags,
                              FeatureValueBuffer& buffer) const
   {
-    std::string nameAlt;
-    uint32_t    nameAltPriority=0;
+    TagValue nameAlt;
+    uint32_t nameAltPriority=0;
 
     for (const auto &tag : tags) {
       uint32_t natPrio;
@@ -178,7 +178,7 @@ namespace osmscout {
     if (!nameAlt.empty()) {
       NameAltFeatureValue* value=static_cast<NameAltFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
-      value->SetNameAlt(nameAlt);
+      value->SetNameAlt(nameAlt.ToString());
     }
   }
 
@@ -236,7 +236,7 @@ namespace osmscout {
                          const TypeConfig& /*typeConfig*/,
                          const FeatureInstance& feature,
                          const ObjectOSMRef& /*object*/,
-                         const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                         const TagMap& tags,
                          FeatureValueBuffer& buffer) const
   {
     auto ref=tags.find(tagRef);
@@ -245,7 +245,7 @@ namespace osmscout {
         !ref->second.empty()) {
       RefFeatureValue* value=static_cast<RefFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
-      value->SetRef(ref->second);
+      value->SetRef(ref->second.ToString());
     }
   }
 
@@ -304,7 +304,7 @@ namespace osmscout {
                               const TypeConfig& /*typeConfig*/,
                               const FeatureInstance& feature,
                               const ObjectOSMRef& /*object*/,
-                              const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                              const TagMap& tags,
                               FeatureValueBuffer& buffer) const
   {
     auto street=tags.find(tagAddrStreet);
@@ -323,7 +323,7 @@ namespace osmscout {
         !houseNr->second.empty()) {
       LocationFeatureValue* value=static_cast<LocationFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
-      value->SetLocation(street->second);
+      value->SetLocation(street->second.ToString());
     }
   }
 
@@ -382,7 +382,7 @@ namespace osmscout {
                              const TypeConfig& /*typeConfig*/,
                              const FeatureInstance& feature,
                              const ObjectOSMRef& /*object*/,
-                             const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                             const TagMap& tags,
                              FeatureValueBuffer& buffer) const
   {
     auto street=tags.find(tagAddrStreet);
@@ -401,7 +401,7 @@ namespace osmscout {
         !houseNr->second.empty()) {
       AddressFeatureValue* value=static_cast<AddressFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
-      value->SetAddress(houseNr->second);
+      value->SetAddress(houseNr->second.ToString());
     }
   }
 
@@ -480,7 +480,7 @@ namespace osmscout {
                             const TypeConfig& /*typeConfig*/,
                             const FeatureInstance& feature,
                             const ObjectOSMRef& /*object*/,
-                            const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                            const TagMap& tags,
                             FeatureValueBuffer& buffer) const
   {
     uint8_t access=0;
@@ -739,7 +739,7 @@ namespace osmscout {
                            const TypeConfig& /*typeConfig*/,
                            const FeatureInstance& feature,
                            const ObjectOSMRef& object,
-                           const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                           const TagMap& tags,
                            FeatureValueBuffer& buffer) const
   {
     auto layer=tags.find(tagLayer);
@@ -747,7 +747,7 @@ namespace osmscout {
     if (layer!=tags.end()) {
       int8_t layerValue;
 
-      if (StringToNumber(layer->second,layerValue)) {
+      if (StringToNumber(layer->second.ToString(),layerValue)) {
         if (layerValue!=0) {
           LayerFeatureValue* value=static_cast<LayerFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
@@ -755,7 +755,7 @@ namespace osmscout {
         }
       }
       else {
-        progress.Warning(std::string("Layer tag value '")+layer->second+"' for "+object.GetName()+" is not numeric!");
+        progress.Warning(std::string("Layer tag value '")+layer->second.c_str()+"' for "+object.GetName()+" is not numeric!");
       }
     }
   }
@@ -814,7 +814,7 @@ namespace osmscout {
                            const TypeConfig& /*typeConfig*/,
                            const FeatureInstance& feature,
                            const ObjectOSMRef& object,
-                           const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                           const TagMap& tags,
                            FeatureValueBuffer& buffer) const
   {
     auto width=tags.find(tagWidth);
@@ -823,7 +823,7 @@ namespace osmscout {
       return;
     }
 
-    std::string widthString=width->second;
+    std::string widthString=width->second.ToString();
     double      w;
     size_t      pos=0;
     size_t      count=0;
@@ -858,10 +858,10 @@ namespace osmscout {
     }
 
     if (!StringToNumber(widthString,w)) {
-      progress.Warning(std::string("Width tag value '")+width->second+"' for "+object.GetName()+" is no double!");
+      progress.Warning(std::string("Width tag value '")+width->second.c_str()+"' for "+object.GetName()+" is no double!");
     }
     else if (w<0 && w>255.5) {
-      progress.Warning(std::string("Width tag value '")+width->second+"' for "+object.GetName()+" value is too small or too big!");
+      progress.Warning(std::string("Width tag value '")+width->second.c_str()+"' for "+object.GetName()+" value is too small or too big!");
     }
     else {
       WidthFeatureValue* value=static_cast<WidthFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
@@ -925,7 +925,7 @@ namespace osmscout {
                               const TypeConfig& typeConfig,
                               const FeatureInstance& feature,
                               const ObjectOSMRef& object,
-                              const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                              const TagMap& tags,
                               FeatureValueBuffer& buffer) const
   {
     auto maxSpeed=tags.find(tagMaxSpeed);
@@ -934,7 +934,7 @@ namespace osmscout {
       return;
     }
 
-    std::string valueString=maxSpeed->second;
+    std::string valueString=maxSpeed->second.ToString();
     size_t      valueNumeric;
     bool        isMph=false;
 
@@ -984,7 +984,7 @@ namespace osmscout {
         valueNumeric=maxSpeedValue;
       }
       else {
-        progress.Warning(std::string("Max speed tag value '")+maxSpeed->second+"' for "+object.GetName()+" is not numeric!");
+        progress.Warning(std::string("Max speed tag value '")+maxSpeed->second.c_str()+"' for "+object.GetName()+" is not numeric!");
         return;
       }
     }
@@ -1065,7 +1065,7 @@ namespace osmscout {
                            const TypeConfig& typeConfig,
                            const FeatureInstance& feature,
                            const ObjectOSMRef& object,
-                           const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                           const TagMap& tags,
                            FeatureValueBuffer& buffer) const
   {
     auto tracktype=tags.find(tagTrackType);
@@ -1107,7 +1107,7 @@ namespace osmscout {
         return;
       }
       else {
-        progress.Warning(std::string("Unsupported tracktype value '")+tracktype->second+"' for "+object.GetName());
+        progress.Warning(std::string("Unsupported tracktype value '")+tracktype->second.c_str()+"' for "+object.GetName());
       }
     }
 
@@ -1116,14 +1116,14 @@ namespace osmscout {
     if (surface!=tags.end()) {
       size_t grade;
 
-      if (typeConfig.GetGradeForSurface(surface->second,
+      if (typeConfig.GetGradeForSurface(surface->second.ToString(),
                                         grade)) {
         GradeFeatureValue* value=static_cast<GradeFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
         value->SetGrade((uint8_t)grade);
       }
       else {
-        progress.Warning(std::string("Unknown surface type '")+surface->second+"' for "+object.GetName()+"!");
+        progress.Warning(std::string("Unknown surface type '")+surface->second.c_str()+"' for "+object.GetName()+"!");
       }
     }
   }
@@ -1182,7 +1182,7 @@ namespace osmscout {
                                 const TypeConfig& /*typeConfig*/,
                                 const FeatureInstance& feature,
                                 const ObjectOSMRef& object,
-                                const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                                const TagMap& tags,
                                 FeatureValueBuffer& buffer) const
   {
     auto adminLevel=tags.find(tagAdminLevel);
@@ -1190,14 +1190,14 @@ namespace osmscout {
     if (adminLevel!=tags.end()) {
       uint8_t adminLevelValue;
 
-      if (StringToNumber(adminLevel->second,
+      if (StringToNumber(adminLevel->second.ToString(),
                          adminLevelValue)) {
         AdminLevelFeatureValue* value=static_cast<AdminLevelFeatureValue*>(buffer.AllocateValue(feature.GetIndex()));
 
         value->SetAdminLevel(adminLevelValue);
       }
       else {
-        progress.Warning(std::string("Admin level is not numeric '")+adminLevel->second+"' for "+object.GetName()+"!");
+        progress.Warning(std::string("Admin level is not numeric '")+adminLevel->second.c_str()+"' for "+object.GetName()+"!");
       }
     }
   }
@@ -1223,7 +1223,7 @@ namespace osmscout {
                             const TypeConfig& /*typeConfig*/,
                             const FeatureInstance& feature,
                             const ObjectOSMRef& /*object*/,
-                            const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                            const TagMap& tags,
                             FeatureValueBuffer& buffer) const
   {
     auto bridge=tags.find(tagBridge);
@@ -1257,7 +1257,7 @@ namespace osmscout {
                             const TypeConfig& /*typeConfig*/,
                             const FeatureInstance& feature,
                             const ObjectOSMRef& /*object*/,
-                            const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                            const TagMap& tags,
                             FeatureValueBuffer& buffer) const
   {
     auto tunnel=tags.find(tagTunnel);
@@ -1291,7 +1291,7 @@ namespace osmscout {
                                 const TypeConfig& /*typeConfig*/,
                                 const FeatureInstance& feature,
                                 const ObjectOSMRef& /*object*/,
-                                const OSMSCOUT_HASHMAP<TagId,std::string>& tags,
+                                const TagMap& tags,
                                 FeatureValueBuffer& buffer) const
   {
     auto junction=tags.find(tagJunction);
@@ -98,6 +98,8 @@ namespace osmscout {
                               const Magnification& magnification,
                               std::list<GroundTile>& tiles) const
   {
+    MutexLocker locker(accessMutex);
+
     uint32_t cx1,cx2,cy1,cy2;
     uint32_t idx=magnification.GetLevel();
 
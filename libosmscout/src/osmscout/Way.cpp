@@ -58,6 +58,17 @@ namespace osmscout {
     // attributes.SetLayer(std::numeric_limits<int8_t>::max());
   }
 
+  /**
+   * Return the (approximate) number of bytes used by the way in memory.
+   */
+  size_t Way::GetMemoryUsage() const
+  {
+    return sizeof(Way)+
+           featureValueBuffer.GetAllocatedMemory()+
+           ids.capacity()*sizeof(Id)+
+           nodes.capacity()*sizeof(ObjectCoord);
+  }
+
   void Way::GetCoordinates(size_t nodeIndex,
                            double& lat,
                            double& lon) const
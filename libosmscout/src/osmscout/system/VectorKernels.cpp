@@ -0,0 +1,475 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2014  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/system/VectorKernels.h>
+
+#include <osmscout/system/Math.h>
+
+#if defined(OSMSCOUT_HAVE_SSE2)
+#include <osmscout/system/SSEMath.h>
+#endif
+
+// AVX2 code is compiled using function attributes and only called if the
+// processor supports it, so the library itself does not require AVX2.
+#if defined(OSMSCOUT_HAVE_SSE2) && \
+    (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__>4 || (__GNUC__==4 && __GNUC_MINOR__>=9))))
+  #define OSMSCOUT_VECTOR_KERNELS_AVX2
+  #define OSMSCOUT_TARGET_AVX2 __attribute__((target("avx2")))
+  #include <immintrin.h>
+#endif
+
+namespace osmscout {
+
+  static const double gradtorad=2*M_PI/360;
+
+  static VectorExtension vectorExtension=GetSupportedVectorExtension();
+
+  /**
+   * Return the best extension supported by the library and the processor.
+   */
+  VectorExtension GetSupportedVectorExtension()
+  {
+#if defined(OSMSCOUT_VECTOR_KERNELS_AVX2)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+      return vectorExtensionAVX2;
+    }
+#endif
+
+#if defined(OSMSCOUT_HAVE_SSE2)
+    return vectorExtensionSSE2;
+#else
+    return vectorExtensionNone;
+#endif
+  }
+
+  /**
+   * Return the extension currently used by the kernels.
+   */
+  VectorExtension GetVectorExtension()
+  {
+    return vectorExtension;
+  }
+
+  /**
+   * Limit the kernels to the given extension (for testing and benchmarking).
+   * Extensions not supported are replaced by the best supported extension.
+   * Must not be called while kernels are running.
+   */
+  void SetVectorExtension(VectorExtension extension)
+  {
+    VectorExtension supported=GetSupportedVectorExtension();
+
+    vectorExtension=extension<=supported ? extension : supported;
+  }
+
+  const char* GetVectorExtensionName(VectorExtension extension)
+  {
+    switch (extension) {
+    case vectorExtensionNone:
+      return "scalar";
+    case vectorExtensionSSE2:
+      return "SSE2";
+    case vectorExtensionAVX2:
+      return "AVX2";
+    }
+
+    return "???";
+  }
+
+  //
+  // Mercator projection
+  //
+
+  static void TransformMercatorScalar(const MercatorKernelParameter& parameter,
+                                      const GeoCoord* coords,
+                                      size_t count,
+                                      double* pixels,
+                                      size_t stride)
+  {
+    for (size_t i=0; i<count; i++) {
+#if defined(OSMSCOUT_HAVE_SSE2)
+      double y=parameter.scale*atanh_sin_pd(coords[i].GetLat()*gradtorad)-parameter.latOffset;
+#else
+      double y=parameter.scale*atanh(sin(coords[i].GetLat()*gradtorad))-parameter.latOffset;
+#endif
+
+      pixels[0]=coords[i].GetLon()*parameter.scaleGradtorad-parameter.lonOffset;
+      pixels[1]=parameter.invertY ? parameter.height-y : y;
+
+      pixels+=stride;
+    }
+  }
+
+#if defined(OSMSCOUT_HAVE_SSE2)
+  static void TransformMercatorSSE2(const MercatorKernelParameter& parameter,
+                                    const GeoCoord* coords,
+                                    size_t count,
+                                    double* pixels,
+                                    size_t stride)
+  {
+    v2df   scale=_mm_set1_pd(parameter.scale);
+    v2df   scaleGradtorad=_mm_set1_pd(parameter.scaleGradtorad);
+    v2df   lonOffset=_mm_set1_pd(parameter.lonOffset);
+    v2df   latOffset=_mm_set1_pd(parameter.latOffset);
+    v2df   height=_mm_set1_pd(parameter.height);
+    v2df   toRad=_mm_set1_pd(gradtorad);
+    size_t i=0;
+
+    for (; i+2<=count; i+=2) {
+      v2df c0=_mm_loadu_pd(&coords[i].lat);   // lat0 lon0
+      v2df c1=_mm_loadu_pd(&coords[i+1].lat); // lat1 lon1
+      v2df lat=_mm_unpacklo_pd(c0,c1);
+      v2df lon=_mm_unpackhi_pd(c0,c1);
+
+      v2df x=_mm_sub_pd(_mm_mul_pd(lon,scaleGradtorad),lonOffset);
+      v2df y=_mm_sub_pd(_mm_mul_pd(scale,atanh_sin_pd(_mm_mul_pd(lat,toRad))),latOffset);
+
+      if (parameter.invertY) {
+        y=_mm_sub_pd(height,y);
+      }
+
+      _mm_storeu_pd(pixels,_mm_unpacklo_pd(x,y));
+      _mm_storeu_pd(pixels+stride,_mm_unpackhi_pd(x,y));
+
+      pixels+=2*stride;
+    }
+
+    TransformMercatorScalar(parameter,
+                            coords+i,
+                            count-i,
+                            pixels,
+                            stride);
+  }
+#endif
+
+#if defined(OSMSCOUT_VECTOR_KERNELS_AVX2)
+  // 4 wide versions of the SSE2 math approximations in SSEMath.h. Operations
+  // and their order are exactly the same, so are the results.
+
+  OSMSCOUT_TARGET_AVX2 static inline __m256d Broadcast(const double* value)
+  {
+    return _mm256_set1_pd(*value);
+  }
+
+  OSMSCOUT_TARGET_AVX2 static inline __m256d Broadcast(const uint64_t* value)
+  {
+    return _mm256_castsi256_pd(_mm256_set1_epi64x(static_cast<long long>(*value)));
+  }
+
+  OSMSCOUT_TARGET_AVX2 static inline __m256d PolyEval3AVX2(__m256d x,
+                                                           const double* coeff)
+  {
+    __m256d y=Broadcast(&coeff[0]);
+
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[2]));
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[4]));
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[6]));
+
+    return y;
+  }
+
+  OSMSCOUT_TARGET_AVX2 static inline __m256d PolyEval6AVX2(__m256d x,
+                                                           const double* coeff)
+  {
+#ifdef _SSE_SLOW_
+    __m256d y=Broadcast(&coeff[0]);
+
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[2]));
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[4]));
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[6]));
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[8]));
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[10]));
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),Broadcast(&coeff[12]));
+
+    return y;
+#else
+    __m256d pt0=_mm256_add_pd(Broadcast(&coeff[0]),_mm256_mul_pd(Broadcast(&coeff[2]),x));
+    __m256d pt1=_mm256_add_pd(Broadcast(&coeff[4]),_mm256_mul_pd(Broadcast(&coeff[6]),x));
+    __m256d pt2=_mm256_add_pd(Broadcast(&coeff[8]),_mm256_mul_pd(Broadcast(&coeff[10]),x));
+    __m256d pt3=Broadcast(&coeff[12]);
+    __m256d ptx2=_mm256_mul_pd(x,x);
+
+    pt0=_mm256_add_pd(pt0,_mm256_mul_pd(pt1,ptx2));
+    pt2=_mm256_add_pd(pt2,_mm256_mul_pd(pt3,ptx2));
+
+    __m256d ptx4=_mm256_mul_pd(ptx2,ptx2);
+
+    return _mm256_add_pd(pt0,_mm256_mul_pd(pt2,ptx4));
+#endif
+  }
+
+  OSMSCOUT_TARGET_AVX2 static inline __m256d DangerousSinAVX2(__m256d x)
+  {
+    __m256d xx=_mm256_mul_pd(x,x);
+    __m256d y=PolyEval6AVX2(xx,SINECOEFF_SSE);
+
+    y=_mm256_mul_pd(y,xx);
+    y=_mm256_add_pd(_mm256_mul_pd(y,x),x);
+
+    return y;
+  }
+
+  OSMSCOUT_TARGET_AVX2 static inline __m256d LogAVX2(__m256d x)
+  {
+    // Collect the 4 exponents as 32 bit integers
+    __m256i eInt=_mm256_and_si256(_mm256_castpd_si256(x),_mm256_castpd_si256(Broadcast(_pd_f_exp_mask)));
+
+    eInt=_mm256_srli_epi64(eInt,52);
+
+    __m128i e32=_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(eInt,_mm256_setr_epi32(0,2,4,6,0,2,4,6)));
+
+    e32=_mm_sub_epi32(e32,_mm_set1_epi32(static_cast<int>(_pd_1022[0])));
+
+    __m256d e=_mm256_cvtepi32_pd(e32);
+
+    x=_mm256_or_pd(_mm256_and_pd(x,Broadcast(_pd_f_fraction_mask)),Broadcast(_pd_f_one_mask));
+
+    __m256d mask=_mm256_cmp_pd(x,Broadcast(_pd_0_87),_CMP_LT_OS);
+    __m256d ex=_mm256_and_pd(mask,Broadcast(_pd_log_inv_1_32));
+    __m256d mulx=_mm256_mul_pd(x,Broadcast(_pd_1_32));
+    __m256d v=_mm256_or_pd(_mm256_and_pd(mask,mulx),_mm256_andnot_pd(mask,x));
+
+    mask=_mm256_cmp_pd(x,Broadcast(_pd_0_66),_CMP_LT_OS);
+    ex=_mm256_or_pd(_mm256_and_pd(mask,Broadcast(_pd_log_inv_1_74)),_mm256_andnot_pd(mask,ex));
+    mulx=_mm256_mul_pd(x,Broadcast(_pd_1_74));
+    v=_mm256_or_pd(_mm256_and_pd(mask,mulx),_mm256_andnot_pd(mask,v));
+
+    __m256d ones=Broadcast(_pd_1);
+    __m256d term=_mm256_div_pd(_mm256_sub_pd(v,ones),_mm256_add_pd(v,ones));
+    __m256d termSquared=_mm256_mul_pd(term,term);
+    __m256d res=PolyEval3AVX2(termSquared,LOGCOEFF);
+
+    res=_mm256_mul_pd(_mm256_mul_pd(res,term),termSquared);
+    res=_mm256_add_pd(res,term);
+
+    __m256d r1=_mm256_mul_pd(e,Broadcast(_pd_LOG_C_2));
+    __m256d r2=_mm256_mul_pd(_mm256_add_pd(ones,ones),res);
+
+    return _mm256_add_pd(r1,_mm256_add_pd(r2,ex));
+  }
+
+  OSMSCOUT_TARGET_AVX2 static inline __m256d AtanhSinAVX2(__m256d x)
+  {
+    __m256d ones=Broadcast(_pd_1);
+
+    x=DangerousSinAVX2(x);
+
+    __m256d param=_mm256_div_pd(_mm256_add_pd(ones,x),_mm256_sub_pd(ones,x));
+
+    return _mm256_mul_pd(Broadcast(_pd_0_5),LogAVX2(param));
+  }
+
+  OSMSCOUT_TARGET_AVX2 static void TransformMercatorAVX2(const MercatorKernelParameter& parameter,
+                                                         const GeoCoord* coords,
+                                                         size_t count,
+                                                         double* pixels,
+                                                         size_t stride)
+  {
+    __m256d scale=_mm256_set1_pd(parameter.scale);
+    __m256d scaleGradtorad=_mm256_set1_pd(parameter.scaleGradtorad);
+    __m256d lonOffset=_mm256_set1_pd(parameter.lonOffset);
+    __m256d latOffset=_mm256_set1_pd(parameter.latOffset);
+    __m256d height=_mm256_set1_pd(parameter.height);
+    __m256d toRad=_mm256_set1_pd(gradtorad);
+    size_t  i=0;
+
+    for (; i+4<=count; i+=4) {
+      __m256d c0=_mm256_loadu_pd(&coords[i].lat);   // lat0 lon0 lat1 lon1
+      __m256d c1=_mm256_loadu_pd(&coords[i+2].lat); // lat2 lon2 lat3 lon3
+      __m256d lat=_mm256_unpacklo_pd(c0,c1);        // lat0 lat2 lat1 lat3
+      __m256d lon=_mm256_unpackhi_pd(c0,c1);        // lon0 lon2 lon1 lon3
+
+      __m256d x=_mm256_sub_pd(_mm256_mul_pd(lon,scaleGradtorad),lonOffset);
+      __m256d y=_mm256_sub_pd(_mm256_mul_pd(scale,AtanhSinAVX2(_mm256_mul_pd(lat,toRad))),latOffset);
+
+      if (parameter.invertY) {
+        y=_mm256_sub_pd(height,y);
+      }
+
+      __m256d xy01=_mm256_unpacklo_pd(x,y);          // x0 y0 x1 y1
+      __m256d xy23=_mm256_unpackhi_pd(x,y);          // x2 y2 x3 y3
+
+      _mm_storeu_pd(pixels,_mm256_castpd256_pd128(xy01));
+      _mm_storeu_pd(pixels+stride,_mm256_extractf128_pd(xy01,1));
+      _mm_storeu_pd(pixels+2*stride,_mm256_castpd256_pd128(xy23));
+      _mm_storeu_pd(pixels+3*stride,_mm256_extractf128_pd(xy23,1));
+
+      pixels+=4*stride;
+    }
+
+    TransformMercatorSSE2(parameter,
+                          coords+i,
+                          count-i,
+                          pixels,
+                          stride);
+  }
+#endif
+
+  /**
+   * Transform count geo coordinates to pixel coordinates using the given
+   * mercator projection. The x and y coordinate of the first point are
+   * written to pixels[0] and pixels[1], the following points start
+   * stride doubles (at least 2) later.
+   */
+  void TransformMercator(const MercatorKernelParameter& parameter,
+                         const GeoCoord* coords,
+                         size_t count,
+                         double* pixels,
+                         size_t stride)
+  {
+    // The vector variants load lat/lon pairs directly from the coordinates
+    if (sizeof(GeoCoord)==2*sizeof(double)) {
+      switch (vectorExtension) {
+#if defined(OSMSCOUT_VECTOR_KERNELS_AVX2)
+      case vectorExtensionAVX2:
+        TransformMercatorAVX2(parameter,coords,count,pixels,stride);
+        return;
+#endif
+#if defined(OSMSCOUT_HAVE_SSE2)
+      case vectorExtensionSSE2:
+        TransformMercatorSSE2(parameter,coords,count,pixels,stride);
+        return;
+#endif
+      default:
+        break;
+      }
+    }
+
+    TransformMercatorScalar(parameter,coords,count,pixels,stride);
+  }
+
+  //
+  // Coordinate decoding
+  //
+
+  static void DecodeCoordsScalar(const GeoCoord& minCoord,
+                                 double latConversionFactor,
+                                 double lonConversionFactor,
+                                 const uint32_t* values,
+                                 size_t count,
+                                 GeoCoord* coords)
+  {
+    for (size_t i=0; i<count; i++) {
+      coords[i].Set(minCoord.GetLat()+values[2*i]/latConversionFactor,
+                    minCoord.GetLon()+values[2*i+1]/lonConversionFactor);
+    }
+  }
+
+#if defined(OSMSCOUT_HAVE_SSE2)
+  static void DecodeCoordsSSE2(const GeoCoord& minCoord,
+                               double latConversionFactor,
+                               double lonConversionFactor,
+                               const uint32_t* values,
+                               size_t count,
+                               GeoCoord* coords)
+  {
+    // Unsigned to double: convert value-2^31 as signed value and add 2^31
+    v2di   signFlip=_mm_set1_epi32(static_cast<int>(0x80000000u));
+    v2df   unsignedOffset=_mm_set1_pd(2147483648.0);
+    v2df   base=_mm_setr_pd(minCoord.GetLat(),minCoord.GetLon());
+    v2df   factor=_mm_setr_pd(latConversionFactor,lonConversionFactor);
+    size_t i=0;
+
+    for (; i+2<=count; i+=2) {
+      v2di v=_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const v2di*>(values+2*i)),signFlip);
+      v2df c0=_mm_add_pd(_mm_cvtepi32_pd(v),unsignedOffset);
+      v2df c1=_mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(v,8)),unsignedOffset);
+
+      _mm_storeu_pd(&coords[i].lat,_mm_add_pd(base,_mm_div_pd(c0,factor)));
+      _mm_storeu_pd(&coords[i+1].lat,_mm_add_pd(base,_mm_div_pd(c1,factor)));
+    }
+
+    DecodeCoordsScalar(minCoord,
+                       latConversionFactor,
+                       lonConversionFactor,
+                       values+2*i,
+                       count-i,
+                       coords+i);
+  }
+#endif
+
+#if defined(OSMSCOUT_VECTOR_KERNELS_AVX2)
+  OSMSCOUT_TARGET_AVX2 static void DecodeCoordsAVX2(const GeoCoord& minCoord,
+                                                    double latConversionFactor,
+                                                    double lonConversionFactor,
+                                                    const uint32_t* values,
+                                                    size_t count,
+                                                    GeoCoord* coords)
+  {
+    __m128i signFlip=_mm_set1_epi32(static_cast<int>(0x80000000u));
+    __m256d unsignedOffset=_mm256_set1_pd(2147483648.0);
+    __m256d base=_mm256_setr_pd(minCoord.GetLat(),minCoord.GetLon(),minCoord.GetLat(),minCoord.GetLon());
+    __m256d factor=_mm256_setr_pd(latConversionFactor,lonConversionFactor,latConversionFactor,lonConversionFactor);
+    size_t  i=0;
+
+    for (; i+4<=count; i+=4) {
+      __m128i v0=_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values+2*i)),signFlip);
+      __m128i v1=_mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values+2*i+4)),signFlip);
+      __m256d c0=_mm256_add_pd(_mm256_cvtepi32_pd(v0),unsignedOffset);
+      __m256d c1=_mm256_add_pd(_mm256_cvtepi32_pd(v1),unsignedOffset);
+
+      _mm256_storeu_pd(&coords[i].lat,_mm256_add_pd(base,_mm256_div_pd(c0,factor)));
+      _mm256_storeu_pd(&coords[i+2].lat,_mm256_add_pd(base,_mm256_div_pd(c1,factor)));
+    }
+
+    DecodeCoordsSSE2(minCoord,
+                     latConversionFactor,
+                     lonConversionFactor,
+                     values+2*i,
+                     count-i,
+                     coords+i);
+  }
+#endif
+
+  /**
+   * Decode count coordinates stored as offsets to minCoord. values holds
+   * the latitude and longitude offset of each coordinate (2*count values),
+   * see FileScanner::Read(std::vector<GeoCoord>&).
+   */
+  void DecodeCoords(const GeoCoord& minCoord,
+                    double latConversionFactor,
+                    double lonConversionFactor,
+                    const uint32_t* values,
+                    size_t count,
+                    GeoCoord* coords)
+  {
+    // The vector variants store lat/lon pairs directly into the coordinates
+    if (sizeof(GeoCoord)==2*sizeof(double)) {
+      switch (vectorExtension) {
+#if defined(OSMSCOUT_VECTOR_KERNELS_AVX2)
+      case vectorExtensionAVX2:
+        DecodeCoordsAVX2(minCoord,latConversionFactor,lonConversionFactor,values,count,coords);
+        return;
+#endif
+#if defined(OSMSCOUT_HAVE_SSE2)
+      case vectorExtensionSSE2:
+        DecodeCoordsSSE2(minCoord,latConversionFactor,lonConversionFactor,values,count,coords);
+        return;
+#endif
+      default:
+        break;
+      }
+    }
+
+    DecodeCoordsScalar(minCoord,latConversionFactor,lonConversionFactor,values,count,coords);
+  }
+}
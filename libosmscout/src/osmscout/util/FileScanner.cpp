@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
 
@@ -46,6 +47,7 @@
 #endif
 
 #include <osmscout/system/Assert.h>
+#include <osmscout/system/VectorKernels.h>
 
 #include <osmscout/util/Number.h>
 
@@ -303,7 +305,8 @@ namespace osmscout {
 
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
-      if (pos>=size) {
+      // Positioning directly behind the last byte is valid, like for fseek()
+      if (pos>size) {
         return false;
       }
 
@@ -368,6 +371,47 @@ namespace osmscout {
     return !hasError;
   }
 
+  /**
+   * Advise the operating system, that the given range of the file will be
+   * read soon, so that it can start reading it in the background. Returns
+   * false, if no advice could be given. This is not an error, the data can
+   * be read anyway.
+   */
+  bool FileScanner::Prefetch(FileOffset pos,
+                             FileOffset bytes)
+  {
+    if (HasError() ||
+        pos>=size ||
+        bytes==0) {
+      return false;
+    }
+
+    bytes=std::min(bytes,size-pos);
+
+#if defined(HAVE_MMAP) && defined(HAVE_POSIX_MADVISE)
+    if (buffer!=NULL) {
+      // madvise requires a page aligned start address
+      FileOffset pageSize=(FileOffset)sysconf(_SC_PAGESIZE);
+      FileOffset start=pos/pageSize*pageSize;
+
+      return posix_madvise(buffer+start,
+                           (size_t)(bytes+pos-start),
+                           POSIX_MADV_WILLNEED)==0;
+    }
+#endif
+
+#if defined(HAVE_POSIX_FADVISE)
+    if (buffer==NULL) {
+      return posix_fadvise(fileno(file),
+                           (off_t)pos,
+                           (off_t)bytes,
+                           POSIX_FADV_WILLNEED)==0;
+    }
+#endif
+
+    return false;
+  }
+
   bool FileScanner::Read(char* buffer, size_t bytes)
   {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
@@ -1831,15 +1875,16 @@ namespace osmscout {
   }
 #endif
 
-  bool FileScanner::ReadCoord(GeoCoord& coord)
+  /**
+   * Read the raw (fixed point) values of a coordinate
+   */
+  bool FileScanner::ReadCoordValues(uint32_t& latDat,
+                                    uint32_t& lonDat)
   {
     if (HasError()) {
       return false;
     }
 
-    uint32_t latDat;
-    uint32_t lonDat;
-
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+coordByteSize-1>=size) {
@@ -1862,9 +1907,6 @@ namespace osmscout {
 
       offset+=coordByteSize;
 
-      coord.Set(latDat/latConversionFactor-90.0,
-                lonDat/lonConversionFactor-180.0);
-
       return true;
     }
 #endif
@@ -1888,12 +1930,38 @@ namespace osmscout {
            | (buffer[5] << 16)
            | ((buffer[6] & 0xf0) << 20);
 
+    return true;
+  }
+
+  bool FileScanner::ReadCoord(GeoCoord& coord)
+  {
+    uint32_t latDat;
+    uint32_t lonDat;
+
+    if (!ReadCoordValues(latDat,lonDat)) {
+      return false;
+    }
+
     coord.Set(latDat/latConversionFactor-90.0,
               lonDat/lonConversionFactor-180.0);
 
     return true;
   }
 
+  bool FileScanner::ReadCoord(CompactGeoCoord& coord)
+  {
+    uint32_t latDat;
+    uint32_t lonDat;
+
+    if (!ReadCoordValues(latDat,lonDat)) {
+      return false;
+    }
+
+    coord.SetValues(latDat,lonDat);
+
+    return true;
+  }
+
   bool FileScanner::ReadConditionalCoord(GeoCoord& coord,
                                          bool& isSet)
   {
@@ -1972,6 +2040,40 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Read count coordinates stored as offsets to minCoord. The numbers are
+   * read in blocks, each block is converted to coordinates at once.
+   */
+  bool FileScanner::ReadCoords(const GeoCoord& minCoord,
+                               size_t count,
+                               std::vector<GeoCoord>& nodes)
+  {
+    const size_t blockSize=64;
+    uint32_t     values[2*blockSize];
+    size_t       i=0;
+
+    while (i<count) {
+      size_t blockCount=std::min(blockSize,count-i);
+
+      for (size_t j=0; j<2*blockCount; j++) {
+        if (!ReadNumber(values[j])) {
+          return false;
+        }
+      }
+
+      DecodeCoords(minCoord,
+                   latConversionFactor,
+                   lonConversionFactor,
+                   values,
+                   blockCount,
+                   &nodes[i]);
+
+      i+=blockCount;
+    }
+
+    return !HasError();
+  }
+
   bool FileScanner::Read(std::vector<GeoCoord>& nodes)
   {
     uint32_t nodeCount;
@@ -1987,20 +2089,10 @@ namespace osmscout {
     }
 
     nodes.resize(nodeCount);
-    for (size_t i=0; i<nodeCount; i++) {
-      uint32_t latValue;
-      uint32_t lonValue;
 
-      if (!ReadNumber(latValue) ||
-          !ReadNumber(lonValue)) {
-        return false;
-      }
-
-      nodes[i].Set(minCoord.GetLat()+latValue/latConversionFactor,
-                   minCoord.GetLon()+lonValue/lonConversionFactor);
-    }
-
-    return !HasError();
+    return ReadCoords(minCoord,
+                      nodeCount,
+                      nodes);
   }
 
   bool FileScanner::Read(std::vector<GeoCoord>& nodes,
@@ -2013,6 +2105,16 @@ namespace osmscout {
     }
 
     nodes.resize(count);
+
+    return ReadCoords(minCoord,
+                      count,
+                      nodes);
+  }
+
+  bool FileScanner::ReadCoords(const CompactGeoCoord& minCoord,
+                               size_t count,
+                               std::vector<CompactGeoCoord>& nodes)
+  {
     for (size_t i=0; i<count; i++) {
       uint32_t latValue;
       uint32_t lonValue;
@@ -2022,11 +2124,48 @@ namespace osmscout {
         return false;
       }
 
-      nodes[i].Set(minCoord.GetLat()+latValue/latConversionFactor,
-                   minCoord.GetLon()+lonValue/lonConversionFactor);
+      nodes[i].SetValues(minCoord.latValue+latValue,
+                         minCoord.lonValue+lonValue);
     }
 
     return !HasError();
   }
+
+  bool FileScanner::Read(std::vector<CompactGeoCoord>& nodes)
+  {
+    uint32_t nodeCount;
+
+    if (!ReadNumber(nodeCount)) {
+      return false;
+    }
+
+    CompactGeoCoord minCoord;
+
+    if (!ReadCoord(minCoord)) {
+      return false;
+    }
+
+    nodes.resize(nodeCount);
+
+    return ReadCoords(minCoord,
+                      nodeCount,
+                      nodes);
+  }
+
+  bool FileScanner::Read(std::vector<CompactGeoCoord>& nodes,
+                         size_t count)
+  {
+    CompactGeoCoord minCoord;
+
+    if (!ReadCoord(minCoord)) {
+      return false;
+    }
+
+    nodes.resize(count);
+
+    return ReadCoords(minCoord,
+                      count,
+                      nodes);
+  }
 }
 
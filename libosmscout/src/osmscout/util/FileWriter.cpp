@@ -472,15 +472,16 @@ namespace osmscout {
   }
 #endif
 
-  bool FileWriter::WriteCoord(const GeoCoord& coord)
+  /**
+   * Write the raw (fixed point) values of a coordinate
+   */
+  bool FileWriter::WriteCoordValues(uint32_t latValue,
+                                    uint32_t lonValue)
   {
     if (HasError()) {
       return false;
     }
 
-    uint32_t latValue=(uint32_t)round((coord.GetLat()+90.0)*latConversionFactor);
-    uint32_t lonValue=(uint32_t)round((coord.GetLon()+180.0)*lonConversionFactor);
-
     char buffer[coordByteSize];
 
     buffer[0]=((latValue >>  0) & 0xff);
@@ -493,13 +494,26 @@ namespace osmscout {
 
     buffer[6]=((latValue >> 24) & 0x07) | ((lonValue >> 20) & 0x70);
 
-    //std::cout << coord.GetLat() << "," << coord.GetLon() << " " << latValue << " " << lonValue << std::endl;
-
     hasError=fwrite(buffer,1,coordByteSize,file)!=coordByteSize;
 
     return !hasError;
   }
 
+  bool FileWriter::WriteCoord(const GeoCoord& coord)
+  {
+    uint32_t latValue=(uint32_t)round((coord.GetLat()+90.0)*latConversionFactor);
+    uint32_t lonValue=(uint32_t)round((coord.GetLon()+180.0)*lonConversionFactor);
+
+    return WriteCoordValues(latValue,
+                            lonValue);
+  }
+
+  bool FileWriter::WriteCoord(const CompactGeoCoord& coord)
+  {
+    return WriteCoordValues(coord.latValue,
+                            coord.lonValue);
+  }
+
   bool FileWriter::WriteInvalidCoord()
   {
     if (HasError()) {
@@ -583,6 +597,43 @@ namespace osmscout {
     return true;
   }
 
+  bool FileWriter::Write(const std::vector<CompactGeoCoord>& nodes)
+  {
+    if (!WriteNumber((uint32_t)nodes.size())) {
+      return false;
+    }
+
+    return Write(nodes,
+                 nodes.size());
+  }
+
+  bool FileWriter::Write(const std::vector<CompactGeoCoord>& nodes,
+                         size_t count)
+  {
+    CompactGeoCoord minCoord=nodes[0];
+
+    for (size_t i=1; i<count; i++) {
+      minCoord.SetValues(std::min(minCoord.latValue,nodes[i].latValue),
+                         std::min(minCoord.lonValue,nodes[i].lonValue));
+    }
+
+    if (!WriteCoord(minCoord)) {
+      return false;
+    }
+
+    for (size_t i=0; i<count; i++) {
+      if (!WriteNumber(nodes[i].latValue-minCoord.latValue)) {
+        return false;
+      }
+
+      if (!WriteNumber(nodes[i].lonValue-minCoord.lonValue)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
   bool FileWriter::Flush()
   {
     if (HasError()) {
@@ -133,5 +133,88 @@ namespace osmscout {
   {
     std::cout << "   !! " << text << std::endl;
   }
+
+  BufferedProgress::BufferedProgress(bool outputDebug)
+  {
+    SetOutputDebug(outputDebug);
+  }
+
+  void BufferedProgress::Add(MessageType type,
+                             const std::string& text)
+  {
+    Message message;
+
+    message.type=type;
+    message.text=text;
+
+    messages.push_back(message);
+  }
+
+  void BufferedProgress::SetAction(const std::string& action)
+  {
+    Add(BufferedProgress::action,action);
+  }
+
+  void BufferedProgress::SetProgress(double /*current*/,
+                                     double /*total*/)
+  {
+    // no code
+  }
+
+  void BufferedProgress::Debug(const std::string& text)
+  {
+    Add(debug,text);
+  }
+
+  void BufferedProgress::Info(const std::string& text)
+  {
+    Add(info,text);
+  }
+
+  void BufferedProgress::Warning(const std::string& text)
+  {
+    Add(warning,text);
+  }
+
+  void BufferedProgress::Error(const std::string& text)
+  {
+    Add(error,text);
+  }
+
+  /**
+    Drop all recorded messages
+    */
+  void BufferedProgress::Clear()
+  {
+    messages.clear();
+  }
+
+  /**
+    Pass all recorded messages to the given progress instance
+    */
+  void BufferedProgress::Replay(Progress& progress) const
+  {
+    for (std::list<Message>::const_iterator message=messages.begin();
+         message!=messages.end();
+         ++message) {
+      switch (message->type) {
+      case action:
+        progress.SetAction(message->text);
+        break;
+      case debug:
+        progress.Debug(message->text);
+        break;
+      case info:
+        progress.Info(message->text);
+        break;
+      case warning:
+        progress.Warning(message->text);
+        break;
+      case error:
+        progress.Error(message->text);
+        break;
+      }
+    }
+  }
 }
 
@@ -39,6 +39,25 @@ namespace osmscout {
     // no code
   }
 
+  bool Projection::GeoToPixel(const GeoCoord* coords,
+                              size_t count,
+                              double* pixels,
+                              size_t stride) const
+  {
+    for (size_t i=0; i<count; i++) {
+      if (!GeoToPixel(coords[i].GetLon(),
+                      coords[i].GetLat(),
+                      pixels[0],
+                      pixels[1])) {
+        return false;
+      }
+
+      pixels+=stride;
+    }
+
+    return true;
+  }
+
   MercatorProjection::MercatorProjection()
   : valid(false),
     lon(0),
@@ -267,6 +286,36 @@ namespace osmscout {
 
 #endif
 
+  void MercatorProjection::GetKernelParameter(MercatorKernelParameter& parameter) const
+  {
+    parameter.scale=scale;
+    parameter.scaleGradtorad=scaleGradtorad;
+    parameter.lonOffset=lonOffset;
+    parameter.latOffset=latOffset;
+    parameter.height=height;
+    parameter.invertY=true;
+  }
+
+  bool MercatorProjection::GeoToPixel(const GeoCoord* coords,
+                                      size_t count,
+                                      double* pixels,
+                                      size_t stride) const
+  {
+    assert(valid);
+
+    MercatorKernelParameter parameter;
+
+    GetKernelParameter(parameter);
+
+    TransformMercator(parameter,
+                      coords,
+                      count,
+                      pixels,
+                      stride);
+
+    return true;
+  }
+
   bool MercatorProjection::GetDimensions(double& lonMin, double& latMin,
                                          double& lonMax, double& latMax) const
   {
@@ -352,4 +401,25 @@ namespace osmscout {
 
 #endif
 
+    bool ReversedYAxisMercatorProjection::GeoToPixel(const GeoCoord* coords,
+                                                     size_t count,
+                                                     double* pixels,
+                                                     size_t stride) const
+    {
+        assert(valid);
+
+        MercatorKernelParameter parameter;
+
+        GetKernelParameter(parameter);
+
+        parameter.invertY=false;
+
+        TransformMercator(parameter,
+                          coords,
+                          count,
+                          pixels,
+                          stride);
+
+        return true;
+    }
 }
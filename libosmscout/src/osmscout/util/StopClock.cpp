@@ -92,13 +92,10 @@ namespace osmscout {
 	return (pimpl->stop.QuadPart-pimpl->start.QuadPart) / (pimpl->freq.QuadPart/1000.0);
 #elif defined(HAVE_SYS_TIME_H)
     timeval diff;
-    size_t  result;
 
     timersub(&pimpl->stop,&pimpl->start,&diff);
 
-    result=diff.tv_sec*1000.0+diff.tv_usec/1000;
-
-    return result;
+    return diff.tv_sec*1000.0+diff.tv_usec/1000.0;
 #else
     return 0.0;
 #endif
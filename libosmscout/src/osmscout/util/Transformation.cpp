@@ -19,6 +19,7 @@
 
 #include <osmscout/util/Transformation.h>
 
+#include <algorithm>
 #include <limits>
 
 namespace osmscout {
@@ -185,18 +186,89 @@ namespace osmscout {
   void TransPolygon::TransformGeoToPixel(const Projection& projection,
                                          const std::vector<GeoCoord>& nodes)
   {
-    Projection::BatchTransformer batchTransformer(projection);
+    if (pointsSize<nodes.size()) {
+      delete [] points;
+
+      points=new TransPoint[nodes.size()];
+      pointsSize=nodes.size();
+    }
 
     if (!nodes.empty()) {
       start=0;
       length=nodes.size();
       end=length-1;
 
+      // Transform all points at once, if x and y of the points can be
+      // addressed as one array of doubles
+      if (sizeof(TransPoint)%sizeof(double)==0) {
+        projection.GeoToPixel(&nodes[0],
+                              length,
+                              &points[0].x,
+                              sizeof(TransPoint)/sizeof(double));
+      }
+      else {
+        for (size_t i=start; i<=end; i++) {
+          projection.GeoToPixel(nodes[i].GetLon(),
+                                nodes[i].GetLat(),
+                                points[i].x,
+                                points[i].y);
+        }
+      }
+
+      for (size_t i=start; i<=end; i++) {
+        points[i].draw=true;
+      }
+    }
+    else {
+      start=0;
+      end=0;
+      length=0;
+    }
+  }
+
+  void TransPolygon::TransformGeoToPixel(const Projection& projection,
+                                         const std::vector<CompactGeoCoord>& nodes)
+  {
+    if (pointsSize<nodes.size()) {
+      delete [] points;
+
+      points=new TransPoint[nodes.size()];
+      pointsSize=nodes.size();
+    }
+
+    if (!nodes.empty()) {
+      start=0;
+      length=nodes.size();
+      end=length-1;
+
+      if (sizeof(TransPoint)%sizeof(double)==0) {
+        // Expand the compact coordinates block by block and transform
+        // each block at once
+        GeoCoord block[64];
+
+        for (size_t offset=0; offset<length; offset+=64) {
+          size_t count=std::min(length-offset,(size_t)64);
+
+          for (size_t i=0; i<count; i++) {
+            block[i]=nodes[offset+i].GetCoord();
+          }
+
+          projection.GeoToPixel(block,
+                                count,
+                                &points[offset].x,
+                                sizeof(TransPoint)/sizeof(double));
+        }
+      }
+      else {
+        for (size_t i=start; i<=end; i++) {
+          projection.GeoToPixel(nodes[i].GetLon(),
+                                nodes[i].GetLat(),
+                                points[i].x,
+                                points[i].y);
+        }
+      }
+
       for (size_t i=start; i<=end; i++) {
-         batchTransformer.GeoToPixel(nodes[i].GetLon(),
-                                     nodes[i].GetLat(),
-                                     points[i].x,
-                                     points[i].y);
         points[i].draw=true;
       }
     }
@@ -349,58 +421,108 @@ namespace osmscout {
     }
   }
 
-  void TransPolygon::TransformArea(const Projection& projection,
-                                   OptimizeMethod optimize,
-                                   const std::vector<GeoCoord>& nodes,
-                                   double optimizeErrorTolerance)
+  void TransPolygon::OptimizeArea(OptimizeMethod optimize,
+                                  double optimizeErrorTolerance)
   {
-    if (nodes.size()<2) {
-      length=0;
-
+    if (optimize==none) {
       return;
     }
 
-    if (pointsSize<nodes.size()) {
-      delete [] points;
-
-      points=new TransPoint[nodes.size()];
-      pointsSize=nodes.size();
+    if (optimize==fast) {
+      DropSimilarPoints(optimizeErrorTolerance);
+      DropRedundantPointsFast(optimizeErrorTolerance);
+    }
+    else {
+      DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,true);
     }
 
-    if (optimize!=none) {
-      TransformGeoToPixel(projection,
-                          nodes);
+    size_t nodeCount=length;
 
+    length=0;
+    start=nodeCount;
+    end=0;
 
-      if (optimize==fast) {
-        DropSimilarPoints(optimizeErrorTolerance);
-        DropRedundantPointsFast(optimizeErrorTolerance);
-      }
-      else {
-        DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,true);
+    // Calculate start, end and length
+    for (size_t i=0; i<nodeCount; i++) {
+      if (points[i].draw) {
+        length++;
+
+        if (i<start) {
+          start=i;
+        }
+
+        end=i;
       }
+    }
+  }
 
-      length=0;
-      start=nodes.size();
-      end=0;
+  void TransPolygon::OptimizeWay(OptimizeMethod optimize,
+                                 double optimizeErrorTolerance)
+  {
+    if (optimize==none) {
+      return;
+    }
 
-      // Calculate start, end and length
-      for (size_t i=0; i<nodes.size(); i++) {
-        if (points[i].draw) {
-          length++;
+    DropSimilarPoints(optimizeErrorTolerance);
 
-          if (i<start) {
-            start=i;
-          }
+    if (optimize==fast) {
+      DropRedundantPointsFast(optimizeErrorTolerance);
+    }
+    else {
+      DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,false);
+    }
+
+    size_t nodeCount=length;
+
+    length=0;
+    start=nodeCount;
+    end=0;
 
-          end=i;
+    // Calculate start & end
+    for (size_t i=0; i<nodeCount; i++) {
+      if (points[i].draw) {
+        length++;
+
+        if (i<start) {
+          start=i;
         }
+        end=i;
       }
     }
-    else {
-      TransformGeoToPixel(projection,
-                          nodes);
+  }
+
+  void TransPolygon::TransformArea(const Projection& projection,
+                                   OptimizeMethod optimize,
+                                   const std::vector<GeoCoord>& nodes,
+                                   double optimizeErrorTolerance)
+  {
+    if (nodes.size()<2) {
+      length=0;
+
+      return;
     }
+
+    TransformGeoToPixel(projection,
+                        nodes);
+    OptimizeArea(optimize,
+                 optimizeErrorTolerance);
+  }
+
+  void TransPolygon::TransformArea(const Projection& projection,
+                                   OptimizeMethod optimize,
+                                   const std::vector<CompactGeoCoord>& nodes,
+                                   double optimizeErrorTolerance)
+  {
+    if (nodes.size()<2) {
+      length=0;
+
+      return;
+    }
+
+    TransformGeoToPixel(projection,
+                        nodes);
+    OptimizeArea(optimize,
+                 optimizeErrorTolerance);
   }
 
   void TransPolygon::TransformWay(const Projection& projection,
@@ -414,46 +536,27 @@ namespace osmscout {
       return;
     }
 
-    if (pointsSize<nodes.size()) {
-      delete [] points;
-
-      points=new TransPoint[nodes.size()];
-      pointsSize=nodes.size();
-    }
-
-    if (optimize!=none) {
-      TransformGeoToPixel(projection,
-                          nodes);
-
-      DropSimilarPoints(optimizeErrorTolerance);
-
-      if (optimize==fast) {
-        DropRedundantPointsFast(optimizeErrorTolerance);
-      }
-      else {
-        DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,false);
-      }
+    TransformGeoToPixel(projection,
+                        nodes);
+    OptimizeWay(optimize,
+                optimizeErrorTolerance);
+  }
 
+  void TransPolygon::TransformWay(const Projection& projection,
+                                  OptimizeMethod optimize,
+                                  const std::vector<CompactGeoCoord>& nodes,
+                                  double optimizeErrorTolerance)
+  {
+    if (nodes.empty()) {
       length=0;
-      start=nodes.size();
-      end=0;
 
-      // Calculate start & end
-      for (size_t i=0; i<nodes.size(); i++) {
-        if (points[i].draw) {
-          length++;
-
-          if (i<start) {
-            start=i;
-          }
-          end=i;
-        }
-      }
-    }
-    else {
-      TransformGeoToPixel(projection,
-                          nodes);
+      return;
     }
+
+    TransformGeoToPixel(projection,
+                        nodes);
+    OptimizeWay(optimize,
+                optimizeErrorTolerance);
   }
 
   bool TransPolygon::GetBoundingBox(double& xmin, double& ymin,
@@ -527,6 +630,22 @@ namespace osmscout {
     buffer->Reset();
   }
 
+  void TransBuffer::PushPolygon(size_t& start, size_t &end)
+  {
+    bool isStart=true;
+    for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
+      if (transPolygon.points[i].draw) {
+        end=buffer->PushCoord(transPolygon.points[i].x,
+                              transPolygon.points[i].y);
+
+        if (isStart) {
+          start=end;
+          isStart=false;
+        }
+      }
+    }
+  }
+
   void TransBuffer::TransformArea(const Projection& projection,
                                   TransPolygon::OptimizeMethod optimize,
                                   const std::vector<GeoCoord>& nodes,
@@ -540,18 +659,23 @@ namespace osmscout {
 
     assert(!transPolygon.IsEmpty());
 
-    bool isStart=true;
-    for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
-      if (transPolygon.points[i].draw) {
-        end=buffer->PushCoord(transPolygon.points[i].x,
-                              transPolygon.points[i].y);
+    PushPolygon(start,end);
+  }
 
-        if (isStart) {
-          start=end;
-          isStart=false;
-        }
-      }
-    }
+  void TransBuffer::TransformArea(const Projection& projection,
+                                  TransPolygon::OptimizeMethod optimize,
+                                  const std::vector<CompactGeoCoord>& nodes,
+                                  size_t& start, size_t &end,
+                                  double optimizeErrorTolerance)
+  {
+    transPolygon.TransformArea(projection,
+                               optimize,
+                               nodes,
+                               optimizeErrorTolerance);
+
+    assert(!transPolygon.IsEmpty());
+
+    PushPolygon(start,end);
   }
 
   bool TransBuffer::TransformWay(const Projection& projection,
@@ -566,19 +690,25 @@ namespace osmscout {
       return false;
     }
 
-    bool isStart=true;
-    for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
-      if (transPolygon.points[i].draw) {
-        end=buffer->PushCoord(transPolygon.points[i].x,
-                              transPolygon.points[i].y);
+    PushPolygon(start,end);
 
-        if (isStart) {
-          start=end;
-          isStart=false;
-        }
-      }
+    return true;
+  }
+
+  bool TransBuffer::TransformWay(const Projection& projection,
+                                 TransPolygon::OptimizeMethod optimize,
+                                 const std::vector<CompactGeoCoord>& nodes,
+                                 size_t& start, size_t &end,
+                                 double optimizeErrorTolerance)
+  {
+    transPolygon.TransformWay(projection, optimize, nodes, optimizeErrorTolerance);
+
+    if (transPolygon.IsEmpty()) {
+      return false;
     }
 
+    PushPolygon(start,end);
+
     return true;
   }
 }
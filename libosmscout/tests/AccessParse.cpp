@@ -98,17 +98,17 @@ bool CheckParseSuccess(bool canFoot,
                        uint8_t expectedAccessValue,
                        const OSMSCOUT_HASHMAP<std::string,std::string>& stringTags)
 {
-  osmscout::SilentProgress                      progress;
-  osmscout::TypeConfig                          typeConfig;
-  osmscout::TypeInfoRef                         testType=new osmscout::TypeInfo();
-  osmscout::FeatureRef                          accessFeature;
-  size_t                                        featureInstanceIndex;
-  OSMSCOUT_HASHMAP<osmscout::TagId,std::string> tags;
+  osmscout::SilentProgress progress;
+  osmscout::TypeConfig     typeConfig;
+  osmscout::TypeInfoRef    testType=new osmscout::TypeInfo();
+  osmscout::FeatureRef     accessFeature;
+  size_t                   featureInstanceIndex;
+  osmscout::TagMap         tags;
 
   for (const auto &entry : stringTags) {
     osmscout::TagId tagId=typeConfig.RegisterTag(entry.first);
 
-    tags[tagId]=entry.second;
+    tags.Copy(tagId,entry.second);
   }
 
   accessFeature=typeConfig.GetFeature(osmscout::AccessFeature::NAME);
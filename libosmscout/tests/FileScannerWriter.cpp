@@ -1,5 +1,7 @@
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/FileWriter.h>
@@ -43,6 +45,21 @@ int main()
 
   osmscout::FileOffset  info;
 
+  std::vector<osmscout::GeoCoord>        outCoords;
+  std::vector<osmscout::CompactGeoCoord> outCompactCoords;
+  std::vector<osmscout::GeoCoord>        inCoords;
+  std::vector<osmscout::CompactGeoCoord> inCompactCoords;
+
+  outCoords.push_back(osmscout::GeoCoord(51.5000558,7.3998100));
+  outCoords.push_back(osmscout::GeoCoord(51.4999100,7.4013893));
+  outCoords.push_back(osmscout::GeoCoord(-33.8674869,151.2069902));
+  outCoords.push_back(osmscout::GeoCoord(-90.0,-180.0));
+  outCoords.push_back(osmscout::GeoCoord(90.0,180.0));
+
+  for (size_t i=0; i<outCoords.size(); i++) {
+    outCompactCoords.push_back(osmscout::CompactGeoCoord(outCoords[i]));
+  }
+
   if (writer.Open("test.dat")) {
     writer.Write(outBool1);
     writer.Write(outBool2);
@@ -77,6 +94,11 @@ int main()
     writer.WriteFileOffset(outfo2);
     writer.WriteFileOffset(outfo3);
 
+    writer.Write(outCoords);
+    writer.Write(outCoords);
+    writer.Write(outCompactCoords);
+    writer.Write(outCompactCoords);
+
     writer.Close();
 
     if (scanner.Open("test.dat",osmscout::FileScanner::Normal,false)) {
@@ -228,6 +250,34 @@ int main()
         std::cerr << "Read/WriteFileOffset(FileOffset): Expected " << outfo3 << ", got " << info << std::endl;
         errors++;
       }
+
+      // Read/Write(std::vector<GeoCoord>) and Read/Write(std::vector<CompactGeoCoord>),
+      // both use the same format, so each can be read as the other
+
+      for (size_t run=0; run<2; run++) {
+        scanner.Read(inCoords);
+
+        if (inCoords.size()!=outCoords.size()) {
+          std::cerr << "Read/Write(std::vector<GeoCoord>): Expected " << outCoords.size() << " coordinates, got " << inCoords.size() << std::endl;
+          errors++;
+        }
+        else {
+          for (size_t i=0; i<inCoords.size(); i++) {
+            if (fabs(inCoords[i].GetLat()-outCoords[i].GetLat())>1/osmscout::latConversionFactor ||
+                fabs(inCoords[i].GetLon()-outCoords[i].GetLon())>1/osmscout::lonConversionFactor) {
+              std::cerr << "Read/Write(std::vector<GeoCoord>): Expected " << outCoords[i].GetDisplayText() << ", got " << inCoords[i].GetDisplayText() << std::endl;
+              errors++;
+            }
+          }
+        }
+
+        scanner.Read(inCompactCoords);
+
+        if (inCompactCoords!=outCompactCoords) {
+          std::cerr << "Read/Write(std::vector<CompactGeoCoord>): Coordinates differ" << std::endl;
+          errors++;
+        }
+      }
     }
     else {
       std::cerr << "Cannot open file for reading" << std::endl;
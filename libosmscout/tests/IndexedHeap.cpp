@@ -0,0 +1,106 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/IndexedHeap.h>
+
+struct CostCompare
+{
+  const std::vector<double>* costs;
+
+  CostCompare(const std::vector<double>* costs)
+  : costs(costs)
+  {
+    // no code
+  }
+
+  bool operator()(size_t a, size_t b) const
+  {
+    if ((*costs)[a]==(*costs)[b]) {
+      return a<b;
+    }
+
+    return (*costs)[a]<(*costs)[b];
+  }
+};
+
+typedef osmscout::IndexedHeap<CostCompare> TestHeap;
+
+int errors=0;
+
+int main()
+{
+  std::vector<double> costs;
+  TestHeap            heap((CostCompare(&costs)));
+
+  srand(42);
+
+  for (size_t i=0; i<1000; i++) {
+    costs.push_back(rand()%500);
+    heap.Push(i);
+  }
+
+  if (heap.size()!=1000) {
+    std::cerr << "Expected 1000 entries, found " << heap.size() << "!" << std::endl;
+    errors++;
+  }
+
+  // Decrease and increase some priorities
+  for (size_t i=0; i<1000; i+=7) {
+    costs[i]=costs[i]/2;
+    heap.Update(i);
+  }
+
+  for (size_t i=3; i<1000; i+=11) {
+    costs[i]=costs[i]+250;
+    heap.Update(i);
+  }
+
+  // Remove the first half and check the order
+  size_t last=heap.Top();
+
+  heap.Pop();
+
+  for (size_t i=1; i<500; i++) {
+    size_t current=heap.Top();
+
+    if (CostCompare(&costs)(current,last)) {
+      std::cerr << "Entry " << current << " taken after entry " << last << "!" << std::endl;
+      errors++;
+    }
+
+    if (heap.Contains(last)) {
+      std::cerr << "Entry " << last << " still in heap!" << std::endl;
+      errors++;
+    }
+
+    heap.Pop();
+    last=current;
+  }
+
+  // Reinsert popped entries with the lowest cost
+  costs[last]=-1.0;
+  heap.Push(last);
+
+  if (heap.Top()!=last) {
+    std::cerr << "Reinserted entry " << last << " not on top!" << std::endl;
+    errors++;
+  }
+
+  while (!heap.empty()) {
+    heap.Pop();
+  }
+
+  if (heap.Contains(0) ||
+      heap.Contains(999)) {
+    std::cerr << "Heap not empty!" << std::endl;
+    errors++;
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,165 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/RouteNode.h>
+#include <osmscout/RoutingGraph.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+static const char* filename="routegraph.dat";
+static const size_t nodeCount=500;
+
+int errors=0;
+
+static double RandomValue(double min,
+                          double max)
+{
+  return min+(max-min)*rand()/(double)RAND_MAX;
+}
+
+/**
+ * Write the given route nodes, return the file offsets of the nodes
+ */
+static bool WriteNodes(const std::vector<osmscout::RouteNode>& nodes,
+                       std::vector<osmscout::FileOffset>& offsets)
+{
+  osmscout::FileWriter writer;
+
+  if (!writer.Open(filename)) {
+    std::cerr << "Cannot create '" << filename << "'" << std::endl;
+    return false;
+  }
+
+  writer.Write((uint32_t)nodes.size());
+
+  offsets.clear();
+
+  for (size_t n=0; n<nodes.size(); n++) {
+    osmscout::FileOffset offset;
+
+    writer.GetPos(offset);
+    offsets.push_back(offset);
+
+    nodes[n].Write(writer);
+  }
+
+  return writer.Close();
+}
+
+/**
+ * The routing graph must return exactly the paths RouteNode decodes from the
+ * data file, including the (not quantized) coordinates of the targets
+ */
+int main()
+{
+  std::vector<osmscout::RouteNode>  nodes(nodeCount);
+  std::vector<osmscout::FileOffset> offsets;
+
+  srand(42);
+
+  for (size_t n=0; n<nodes.size(); n++) {
+    osmscout::RouteNode& node=nodes[n];
+    size_t               pathCount=rand()%5;
+
+    node.id=n+1;
+
+    for (size_t p=0; p<pathCount; p++) {
+      osmscout::RouteNode::Path path;
+
+      path.offset=0;
+      path.objectIndex=node.AddObject(osmscout::ObjectFileRef(rand()%1000,osmscout::refWay));
+      path.type=1;
+      path.maxSpeed=50;
+      path.grade=1;
+      path.flags=osmscout::RouteNode::hasAccess;
+      path.distance=RandomValue(0.0,10.0);
+      path.lat=RandomValue(-89.0,89.0);
+      path.lon=RandomValue(-179.0,179.0);
+
+      node.paths.push_back(path);
+    }
+  }
+
+  // File offsets are written with a fixed size, so the offsets of the nodes
+  // do not change after filling in the targets of the paths
+  if (!WriteNodes(nodes,offsets)) {
+    return 1;
+  }
+
+  for (size_t n=0; n<nodes.size(); n++) {
+    for (size_t p=0; p<nodes[n].paths.size(); p++) {
+      nodes[n].paths[p].offset=offsets[rand()%offsets.size()];
+    }
+  }
+
+  if (!WriteNodes(nodes,offsets)) {
+    return 1;
+  }
+
+  osmscout::RoutingGraph graph;
+
+  if (!graph.Load(filename)) {
+    std::cerr << "Cannot load routing graph" << std::endl;
+    return 1;
+  }
+
+  if (graph.GetNodeCount()!=nodes.size()) {
+    std::cerr << "Expected " << nodes.size() << " nodes, got " << graph.GetNodeCount() << std::endl;
+    return 1;
+  }
+
+  osmscout::FileScanner scanner;
+  uint32_t              count;
+
+  if (!scanner.Open(filename,osmscout::FileScanner::Sequential,false) ||
+      !scanner.Read(count)) {
+    std::cerr << "Cannot read '" << filename << "'" << std::endl;
+    return 1;
+  }
+
+  for (uint32_t n=0; n<count; n++) {
+    osmscout::RouteNode node;
+
+    if (!node.Read(scanner)) {
+      std::cerr << "Cannot read route node " << n << std::endl;
+      return 1;
+    }
+
+    uint32_t graphNode=graph.GetNodeIndex(node.GetFileOffset());
+
+    if (graphNode==osmscout::RoutingGraph::noNode ||
+        graph.GetEdgesEnd(graphNode)-graph.GetEdgesBegin(graphNode)!=node.paths.size()) {
+      std::cerr << "Route node " << n << " does not match graph node" << std::endl;
+      errors++;
+      continue;
+    }
+
+    for (size_t p=0; p<node.paths.size(); p++) {
+      osmscout::RouteNode::Path path;
+
+      graph.GetPath(graphNode,
+                    graph.GetEdgesBegin(graphNode)+(uint32_t)p,
+                    path);
+
+      if (path.offset!=node.paths[p].offset ||
+          path.distance!=node.paths[p].distance ||
+          path.lat!=node.paths[p].lat ||
+          path.lon!=node.paths[p].lon ||
+          graph.GetObject(path.objectIndex)!=node.objects[node.paths[p].objectIndex]) {
+        std::cerr << "Path " << p << " of route node " << n << " differs" << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  scanner.Close();
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+
+#include <osmscout/util/ShardedCache.h>
+
+typedef osmscout::ShardedCache<unsigned long,unsigned long> TestCache;
+
+int errors=0;
+
+int main()
+{
+  TestCache cache(100);
+
+  for (unsigned long i=0; i<100; i++) {
+    cache.SetEntry(i,i*2,1);
+  }
+
+  if (cache.GetSize()!=100) {
+    std::cerr << "Expected 100 entries, found " << cache.GetSize() << "!" << std::endl;
+    errors++;
+  }
+
+  for (unsigned long i=0; i<100; i++) {
+    unsigned long value=0;
+
+    if (!cache.GetEntry(i,value) || value!=i*2) {
+      std::cerr << i << " not found in cache!" << std::endl;
+      errors++;
+    }
+  }
+
+  // All entries were hit, a scan of new entries should
+  // only replace a part of them
+  for (unsigned long i=1000; i<1000+100; i++) {
+    cache.SetEntry(i,i,1);
+  }
+
+  if (cache.GetSize()!=100) {
+    std::cerr << "Expected 100 entries after scan, found " << cache.GetSize() << "!" << std::endl;
+    errors++;
+  }
+
+  TestCache::Statistics statistics=cache.GetStatistics();
+
+  if (statistics.hits!=100 ||
+      statistics.insertions!=200 ||
+      statistics.evictions!=100) {
+    std::cerr << "Unexpected statistics: hits " << statistics.hits << ", insertions " << statistics.insertions << ", evictions " << statistics.evictions << "!" << std::endl;
+    errors++;
+  }
+
+  unsigned long value;
+  size_t        survivors=0;
+
+  for (unsigned long i=0; i<100; i++) {
+    if (cache.GetEntry(i,value)) {
+      survivors++;
+    }
+  }
+
+  if (survivors<50) {
+    std::cerr << "Only " << survivors << " entries survived the scan!" << std::endl;
+    errors++;
+  }
+
+  if (cache.GetEntry(5000,value)) {
+    std::cerr << "5000 found in cache!" << std::endl;
+    errors++;
+  }
+
+  // Memory limit
+  TestCache memoryCache(100,1000);
+
+  for (unsigned long i=0; i<100; i++) {
+    memoryCache.SetEntry(i,i,100);
+  }
+
+  if (memoryCache.GetSize()!=10) {
+    std::cerr << "Expected 10 entries in memory limited cache, found " << memoryCache.GetSize() << "!" << std::endl;
+    errors++;
+  }
+
+  if (!memoryCache.GetEntry(99,value)) {
+    std::cerr << "99 not found in memory limited cache!" << std::endl;
+    errors++;
+  }
+
+  memoryCache.Flush();
+
+  if (memoryCache.GetSize()!=0 ||
+      memoryCache.GetEntry(99,value)) {
+    std::cerr << "Cache not empty after flush!" << std::endl;
+    errors++;
+  }
+
+  // Inactive cache
+  TestCache inactiveCache(0);
+
+  inactiveCache.SetEntry(1,1,1);
+
+  if (inactiveCache.GetEntry(1,value)) {
+    std::cerr << "1 found in inactive cache!" << std::endl;
+    errors++;
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
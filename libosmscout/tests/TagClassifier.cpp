@@ -0,0 +1,151 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/TagClassifier.h>
+
+static const osmscout::TagId tagHighway=1;
+static const osmscout::TagId tagArea=2;
+static const osmscout::TagId tagLanes=3;
+static const osmscout::TagId tagName=4;
+static const osmscout::TagId tagBuilding=5;
+
+int errors=0;
+
+/**
+ * Evaluate the rules one after another and compare the result with the classifier
+ */
+static void Check(const osmscout::TagClassifier& classifier,
+                  const std::vector<osmscout::TagConditionRef>& conditions,
+                  const std::vector<unsigned char>& types,
+                  const osmscout::TagMap& tags,
+                  unsigned char type)
+{
+  size_t        expected=conditions.size();
+  size_t        value;
+  unsigned char ruleTypes;
+
+  for (size_t i=0; i<conditions.size(); i++) {
+    if ((types[i] & type)!=0 &&
+        conditions[i]->Evaluate(tags)) {
+      expected=i;
+      break;
+    }
+  }
+
+  if (!classifier.Match(tags,type,value,ruleTypes)) {
+    value=conditions.size();
+  }
+
+  if (value!=expected) {
+    std::cerr << "Expected rule " << expected << ", got " << value << " for";
+
+    for (osmscout::TagMap::const_iterator tag=tags.begin(); tag!=tags.end(); ++tag) {
+      std::cerr << " " << tag->first << "=" << tag->second.c_str();
+    }
+
+    std::cerr << " (type " << (int)type << ")" << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  std::vector<osmscout::TagConditionRef> conditions;
+  std::vector<unsigned char>             types;
+
+  // 0: highway=motorway
+  conditions.push_back(new osmscout::TagBinaryCondition(tagHighway,osmscout::operatorEqual,std::string("motorway")));
+  types.push_back(1);
+
+  // 1: highway=pedestrian AND area=yes
+  osmscout::TagBoolCondition* andCondition=new osmscout::TagBoolCondition(osmscout::TagBoolCondition::boolAnd);
+  andCondition->AddCondition(new osmscout::TagBinaryCondition(tagHighway,osmscout::operatorEqual,std::string("pedestrian")));
+  andCondition->AddCondition(new osmscout::TagBinaryCondition(tagArea,osmscout::operatorEqual,std::string("yes")));
+  conditions.push_back(andCondition);
+  types.push_back(2);
+
+  // 2: highway IN [pedestrian,footway] AND NOT area=yes
+  osmscout::TagIsInCondition* isInCondition=new osmscout::TagIsInCondition(tagHighway);
+  isInCondition->AddTagValue("pedestrian");
+  isInCondition->AddTagValue("footway");
+  andCondition=new osmscout::TagBoolCondition(osmscout::TagBoolCondition::boolAnd);
+  andCondition->AddCondition(isInCondition);
+  andCondition->AddCondition(new osmscout::TagNotCondition(new osmscout::TagBinaryCondition(tagArea,osmscout::operatorEqual,std::string("yes"))));
+  conditions.push_back(andCondition);
+  types.push_back(1);
+
+  // 3: lanes>=3 (numeric)
+  conditions.push_back(new osmscout::TagBinaryCondition(tagLanes,osmscout::operatorGreaterEqual,(size_t)3));
+  types.push_back(3);
+
+  // 4: building!=no OR name<"m"
+  osmscout::TagBoolCondition* orCondition=new osmscout::TagBoolCondition(osmscout::TagBoolCondition::boolOr);
+  orCondition->AddCondition(new osmscout::TagBinaryCondition(tagBuilding,osmscout::operatorNotEqual,std::string("no")));
+  orCondition->AddCondition(new osmscout::TagBinaryCondition(tagName,osmscout::operatorLess,std::string("m")));
+  conditions.push_back(orCondition);
+  types.push_back(3);
+
+  // 5: NOT highway exists
+  conditions.push_back(new osmscout::TagNotCondition(new osmscout::TagExistsCondition(tagHighway)));
+  types.push_back(2);
+
+  // 6: highway exists
+  conditions.push_back(new osmscout::TagExistsCondition(tagHighway));
+  types.push_back(3);
+
+  osmscout::TagClassifier classifier;
+
+  for (size_t i=0; i<conditions.size(); i++) {
+    classifier.AddRule(*conditions[i],types[i],i);
+  }
+
+  const char* highways[]={NULL,"motorway","pedestrian","footway","primary"};
+  const char* areas[]={NULL,"yes","no"};
+  const char* lanes[]={NULL,"2","3","03","x"};
+  const char* buildings[]={NULL,"no","yes"};
+  const char* names[]={NULL,"a","m","z"};
+
+  for (size_t h=0; h<sizeof(highways)/sizeof(highways[0]); h++) {
+    for (size_t a=0; a<sizeof(areas)/sizeof(areas[0]); a++) {
+      for (size_t l=0; l<sizeof(lanes)/sizeof(lanes[0]); l++) {
+        for (size_t b=0; b<sizeof(buildings)/sizeof(buildings[0]); b++) {
+          for (size_t n=0; n<sizeof(names)/sizeof(names[0]); n++) {
+            osmscout::TagMap tags;
+
+            if (highways[h]!=NULL) {
+              tags.Copy(tagHighway,highways[h]);
+            }
+            if (areas[a]!=NULL) {
+              tags.Copy(tagArea,areas[a]);
+            }
+            if (lanes[l]!=NULL) {
+              tags.Copy(tagLanes,lanes[l]);
+            }
+            if (buildings[b]!=NULL) {
+              tags.Copy(tagBuilding,buildings[b]);
+            }
+            if (names[n]!=NULL) {
+              tags.Copy(tagName,names[n]);
+            }
+
+            for (unsigned char type=1; type<=3; type++) {
+              Check(classifier,
+                    conditions,
+                    types,
+                    tags,
+                    type);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}